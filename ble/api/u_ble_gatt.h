@@ -39,6 +39,35 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_BLE_GATT_VALUE_MAX_LENGTH_BYTES
+/** The maximum length of a value that may be passed to the queued
+ * write/notify functions, uBleGattWriteValueQueued() and
+ * uBleGattWriteNotifyValueQueued(); this is the largest
+ * attribute value that fits into a single ATT PDU with the
+ * maximum LE data length.
+ */
+# define U_BLE_GATT_VALUE_MAX_LENGTH_BYTES 244
+#endif
+
+#ifndef U_BLE_GATT_QUEUE_MAX_LENGTH
+/** The maximum number of queued GATT operations that may be
+ * outstanding on any one connection; further calls to
+ * uBleGattWriteValueQueued() or uBleGattWriteNotifyValueQueued()
+ * will return #U_ERROR_COMMON_BUSY until there is room.
+ */
+# define U_BLE_GATT_QUEUE_MAX_LENGTH 16
+#endif
+
+#ifndef U_BLE_GATT_QUEUE_WINDOW_DEFAULT
+/** The default number of queued writes-without-response or
+ * notifications that are sent to the module before their
+ * responses are collected, see uBleGattQueueWindowSet(): 1,
+ * i.e. each command waits for its "OK" or "ERROR" before the
+ * next is sent.
+ */
+# define U_BLE_GATT_QUEUE_WINDOW_DEFAULT 1
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -89,6 +118,38 @@ typedef void (*uBleGattWriteCallback_t)(uint8_t connHandle,
                                         uint8_t *pValue,
                                         uint8_t valueLength);
 
+/** Callback when a queued GATT operation, see uBleGattWriteValueQueued()
+ * and uBleGattWriteNotifyValueQueued(), has completed.
+ * @param[in]  connHandle  corresponding connection handle.
+ * @param[in]  valueHandle characteristic value handle.
+ * @param      errorCode   zero if the operation was successful, else
+ *                         negative error code.
+ * @param[in]  pParameter  the parameter that was passed when the
+ *                         operation was queued.
+ */
+typedef void (*uBleGattQueueCallback_t)(int32_t connHandle,
+                                        uint16_t valueHandle,
+                                        int32_t errorCode,
+                                        void *pParameter);
+
+/** Callback when a queued GATT read, see uBleGattReadValueQueued(),
+ * has completed.
+ * @param[in]  connHandle        corresponding connection handle.
+ * @param[in]  valueHandle       characteristic value handle.
+ * @param[in]  pValue            the value that was read, only valid
+ *                               for the duration of the callback.
+ * @param      errorCodeOrLength the number of bytes at pValue if
+ *                               the read was successful, else
+ *                               negative error code.
+ * @param[in]  pParameter        the parameter that was passed when
+ *                               the read was queued.
+ */
+typedef void (*uBleGattQueueReadCallback_t)(int32_t connHandle,
+                                            uint16_t valueHandle,
+                                            const uint8_t *pValue,
+                                            int32_t errorCodeOrLength,
+                                            void *pParameter);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -241,6 +302,128 @@ int32_t uBleGattWriteNotifyValue(uDeviceHandle_t devHandle,
                                  int32_t connHandle, uint16_t valueHandle,
                                  const void *pValue, uint8_t valueLength);
 
+/* Queued GATT functions */
+
+/** Set the pipelining window for queued GATT operations on a
+ * connection: this is the number of writes-without-response or
+ * notifications that are sent to the module back to back before
+ * their responses are collected.  With the default window of 1
+ * each command is sent only once the module has responded to the
+ * one before, as uBleGattWriteValue() and uBleGattWriteNotifyValue()
+ * do.  A larger window hides the round trip to the module behind
+ * the transfer of the next commands and so increases throughput,
+ * BUT the AT interface of a u-connectXpress module is not specified
+ * to accept a command before it has responded to the previous one:
+ * only open the window for a module/firmware combination which has
+ * been shown to cope.  If this is not called
+ * #U_BLE_GATT_QUEUE_WINDOW_DEFAULT is used.
+ *
+ * @param[in] devHandle   the handle of the u-blox BLE device.
+ * @param[in] connHandle  the connection handle.
+ * @param[in] window      the window, 1 to #U_BLE_GATT_QUEUE_MAX_LENGTH.
+ * @return                zero on success, on failure negative error code.
+ */
+int32_t uBleGattQueueWindowSet(uDeviceHandle_t devHandle,
+                               int32_t connHandle, size_t window);
+
+/** Queue a write of data to a supplied characteristics value handle;
+ * this is the non-blocking version of uBleGattWriteValue().  The data
+ * is copied and so need not remain valid after this function has
+ * returned.  Operations on a connection are carried out in the order
+ * they were queued.  Writes-without-response are pipelined with
+ * other queued operations, up to the window set with
+ * uBleGattQueueWindowSet(); a write with response is sent on its
+ * own and completes when the module has received the write
+ * confirmation from the peer.  If the connection goes away, the
+ * operations not yet sent are called back with
+ * #U_ERROR_COMMON_CANCELLED and the window of the connection goes
+ * back to #U_BLE_GATT_QUEUE_WINDOW_DEFAULT.
+ *
+ * @param[in] devHandle     the handle of the u-blox BLE device.
+ * @param[in] connHandle    the connection handle retrieved from uBleGapConnect().
+ * @param[in] valueHandle   value handle.
+ * @param[in] pValue        pointer to data to be written.
+ * @param[in] valueLength   size of the data, up to
+ *                          #U_BLE_GATT_VALUE_MAX_LENGTH_BYTES.
+ * @param[in] waitResponse  wait for write confirmation from the peer.
+ * @param[in] pCallback     callback to be called when the operation has
+ *                          completed, may be NULL.
+ * @param[in] pCallbackParameter parameter that will be passed to pCallback,
+ *                          may be NULL.
+ * @return                  zero on success, #U_ERROR_COMMON_BUSY if
+ *                          #U_BLE_GATT_QUEUE_MAX_LENGTH operations are
+ *                          already queued on the connection, else negative
+ *                          error code.
+ */
+int32_t uBleGattWriteValueQueued(uDeviceHandle_t devHandle,
+                                 int32_t connHandle, uint16_t valueHandle,
+                                 const void *pValue, size_t valueLength,
+                                 bool waitResponse,
+                                 uBleGattQueueCallback_t pCallback,
+                                 void *pCallbackParameter);
+
+/** Queue a notification of data to a supplied characteristics value
+ * handle; this is the non-blocking version of uBleGattWriteNotifyValue(),
+ * see uBleGattWriteValueQueued() for how queued operations behave.
+ *
+ * Note: not all modules support this (e.g. ODIN-W2 does not).
+ *
+ * @param[in] devHandle     the handle of the u-blox BLE device.
+ * @param[in] connHandle    the connection handle retrieved from uBleGapConnect().
+ * @param[in] valueHandle   value handle.
+ * @param[in] pValue        pointer to data to be written.
+ * @param[in] valueLength   size of the data, up to
+ *                          #U_BLE_GATT_VALUE_MAX_LENGTH_BYTES.
+ * @param[in] pCallback     callback to be called when the operation has
+ *                          completed, may be NULL.
+ * @param[in] pCallbackParameter parameter that will be passed to pCallback,
+ *                          may be NULL.
+ * @return                  zero on success, #U_ERROR_COMMON_BUSY if
+ *                          #U_BLE_GATT_QUEUE_MAX_LENGTH operations are
+ *                          already queued on the connection, else negative
+ *                          error code.
+ */
+int32_t uBleGattWriteNotifyValueQueued(uDeviceHandle_t devHandle,
+                                       int32_t connHandle, uint16_t valueHandle,
+                                       const void *pValue, size_t valueLength,
+                                       uBleGattQueueCallback_t pCallback,
+                                       void *pCallbackParameter);
+
+/** Queue a read of a supplied characteristics value handle; this is
+ * the non-blocking version of uBleGattReadValue().  The read is
+ * carried out in order with the other operations queued on the
+ * connection and, like a write with response, is never pipelined.
+ *
+ * @param[in] devHandle     the handle of the u-blox BLE device.
+ * @param[in] connHandle    the connection handle retrieved from uBleGapConnect().
+ * @param[in] valueHandle   value handle.
+ * @param[in] pCallback     callback to be called with the value, or
+ *                          with an error, when the read has completed;
+ *                          cannot be NULL.
+ * @param[in] pCallbackParameter parameter that will be passed to pCallback,
+ *                          may be NULL.
+ * @return                  zero on success, #U_ERROR_COMMON_BUSY if
+ *                          #U_BLE_GATT_QUEUE_MAX_LENGTH operations are
+ *                          already queued on the connection, else negative
+ *                          error code.
+ */
+int32_t uBleGattReadValueQueued(uDeviceHandle_t devHandle,
+                                int32_t connHandle, uint16_t valueHandle,
+                                uBleGattQueueReadCallback_t pCallback,
+                                void *pCallbackParameter);
+
+/** Wait for all of the operations queued on a connection to complete.
+ *
+ * @param[in] devHandle   the handle of the u-blox BLE device.
+ * @param[in] connHandle  the connection handle.
+ * @param timeoutMs       the maximum time to wait in milliseconds.
+ * @return                zero if the queue is empty, #U_ERROR_COMMON_TIMEOUT
+ *                        if it did not empty in time, else negative error
+ *                        code.
+ */
+int32_t uBleGattQueueFlush(uDeviceHandle_t devHandle, int32_t connHandle,
+                           int32_t timeoutMs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -28,8 +28,12 @@
 
 /** @file
  * @brief This header file defines interface to the Nordic Uart Service (NUS)
- * client and server. Minimal point to point implementation, only one connection
- * at the time is supported.
+ * client and server.  There are two flavours: uBleNusInit()/uBleNusWrite()/
+ * uBleNusDeInit() are a minimal point to point implementation where only one
+ * connection at the time is supported, while the handle-based functions,
+ * uBleNusOpen() etc., support several concurrent connections per device,
+ * each with its own transmit queue and receive callback.  The two flavours
+ * must not be used at the same time.
  *
  */
 
@@ -40,10 +44,64 @@ extern "C" {
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
+
+#ifndef U_BLE_NUS_TX_BUFFER_LENGTH_BYTES
+/** The size of the transmit buffer of each connection opened
+ * through the handle-based NUS API.
+ */
+# define U_BLE_NUS_TX_BUFFER_LENGTH_BYTES 1024
+#endif
+
+#ifndef U_BLE_NUS_TX_IN_FLIGHT_MAX
+/** The maximum number of notifications/writes that may be
+ * outstanding with the module on each connection; while this
+ * many are outstanding further data is held back in the transmit
+ * buffer, where it is packed into full ATT payloads.
+ */
+# define U_BLE_NUS_TX_IN_FLIGHT_MAX 4
+#endif
+
+#ifndef U_BLE_NUS_MTU_DEFAULT
+/** The ATT MTU assumed for a connection until uBleNusMtuSet()
+ * is called: the Bluetooth LE minimum.
+ */
+# define U_BLE_NUS_MTU_DEFAULT 23
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Handle of a NUS instance opened with uBleNusOpen().
+ */
+typedef void *uBleNusHandle_t;
+
+/** Connection callback for the handle-based NUS API.
+ *  @param nusHandle       the NUS instance.
+ *  @param connHandle      the connection handle.
+ *  @param connected       true if the peer has connected, false
+ *                         if it has disconnected.
+ *  @param[in] pParameter  the parameter given to uBleNusOpen().
+ */
+typedef void (*uBleNusConnectCallback_t)(uBleNusHandle_t nusHandle,
+                                         int32_t connHandle,
+                                         bool connected,
+                                         void *pParameter);
+
+/** Peer write detection callback for the handle-based NUS API.
+ *  @param nusHandle       the NUS instance.
+ *  @param connHandle      the connection the data arrived on.
+ *  @param[in] pData       pointer to the data written by the peer.
+ *  @param length          size of the data.
+ *  @param[in] pParameter  the parameter given to uBleNusOpen() or
+ *                         uBleNusDataCallbackSet().
+ */
+typedef void (*uBleNusDataCallback_t)(uBleNusHandle_t nusHandle,
+                                      int32_t connHandle,
+                                      const uint8_t *pData,
+                                      size_t length,
+                                      void *pParameter);
+
 /** Peer write detection callback
  *  @param[in]  pValue      pointer to the data written by the peer.
  *  @param[in]  valueLength size of the data.
@@ -111,6 +169,130 @@ int32_t uBleNusSetAdvData(uint8_t *pAdvData, uint8_t advDataSize);
  */
 int32_t uBleNusDeInit();
 
+/* Handle-based, multi-connection, NUS functions */
+
+/** Open a NUS instance on a device, as either server or client; only
+ * one instance may be open on a device.  The BLE interface of the device
+ * must have been brought up, in peripheral mode for a server and in
+ * central mode for a client.
+ *
+ * A server creates the NUS service and characteristics and then accepts
+ * connections from any number of peers, each of which is reported to
+ * pConnectCallback.  A client connects to peers with uBleNusConnect().
+ *
+ * Note: the GAP and GATT callbacks of a u-blox module do not identify
+ * the device, hence the handle-based NUS API sets them and they must
+ * not be set by the application while a NUS instance is open.
+ *
+ * @param[in] devHandle          the handle of the u-blox BLE device.
+ * @param server                 true for a NUS server, false for a
+ *                               NUS client.
+ * @param[in] pConnectCallback   callback for connection events, may be
+ *                               NULL.
+ * @param[in] pDataCallback      callback for data received on a
+ *                               connection; this may be overridden per
+ *                               connection with uBleNusDataCallbackSet().
+ * @param[in] pCallbackParameter parameter passed to the callbacks.
+ * @param[out] pNusHandle        a place to put the handle of the
+ *                               instance, cannot be NULL.
+ * @return                       zero on success, on failure negative
+ *                               error code.
+ */
+int32_t uBleNusOpen(uDeviceHandle_t devHandle, bool server,
+                    uBleNusConnectCallback_t pConnectCallback,
+                    uBleNusDataCallback_t pDataCallback,
+                    void *pCallbackParameter,
+                    uBleNusHandle_t *pNusHandle);
+
+/** Close a NUS instance, disconnecting all of its connections; any
+ * data not yet sent is discarded.  If uBleNusConnect() is in
+ * progress on the instance it is woken up and this function waits
+ * for it to return before the instance is freed.
+ *
+ * @param nusHandle  the handle of the NUS instance.
+ */
+void uBleNusClose(uBleNusHandle_t nusHandle);
+
+/** Connect a NUS client to a NUS server; this blocks until the
+ * connection is established and the NUS characteristics of the peer
+ * have been found.  Only one connection may be in progress on an
+ * instance at a time; if the instance is closed while this function
+ * is waiting it returns #U_ERROR_COMMON_CANCELLED.
+ *
+ * @param nusHandle        the handle of a NUS client instance.
+ * @param[in] pAddress     the address of the peer.
+ * @param[out] pConnHandle a place to put the connection handle,
+ *                         cannot be NULL.
+ * @return                 zero on success, on failure negative error code.
+ */
+int32_t uBleNusConnect(uBleNusHandle_t nusHandle, const char *pAddress,
+                       int32_t *pConnHandle);
+
+/** Disconnect a NUS connection.
+ *
+ * @param nusHandle   the handle of the NUS instance.
+ * @param connHandle  the connection handle.
+ * @return            zero on success, on failure negative error code.
+ */
+int32_t uBleNusDisconnect(uBleNusHandle_t nusHandle, int32_t connHandle);
+
+/** Set the callback for data received on a given connection,
+ * overriding the one passed to uBleNusOpen().
+ *
+ * @param nusHandle               the handle of the NUS instance.
+ * @param connHandle              the connection handle.
+ * @param[in] pDataCallback       the callback, NULL to stop receiving.
+ * @param[in] pCallbackParameter  parameter passed to the callback.
+ * @return                        zero on success, on failure negative
+ *                                error code.
+ */
+int32_t uBleNusDataCallbackSet(uBleNusHandle_t nusHandle, int32_t connHandle,
+                               uBleNusDataCallback_t pDataCallback,
+                               void *pCallbackParameter);
+
+/** Set the ATT MTU negotiated on a connection: data is packed into
+ * notifications/writes of MTU - 3 bytes, up to
+ * #U_BLE_GATT_VALUE_MAX_LENGTH_BYTES.  Until this is called
+ * #U_BLE_NUS_MTU_DEFAULT is assumed.
+ *
+ * @param nusHandle   the handle of the NUS instance.
+ * @param connHandle  the connection handle.
+ * @param mtu         the ATT MTU, at least 23.
+ * @return            zero on success, on failure negative error code.
+ */
+int32_t uBleNusMtuSet(uBleNusHandle_t nusHandle, int32_t connHandle,
+                      size_t mtu);
+
+/** Send data to the peer of a connection; this does not block: the
+ * data is copied into the transmit buffer of the connection and sent
+ * in the background, as notifications for a server or as writes
+ * without response for a client, packed into full ATT payloads
+ * where possible.
+ *
+ * @param nusHandle   the handle of the NUS instance.
+ * @param connHandle  the connection handle.
+ * @param[in] pData   the data to send.
+ * @param length      the number of bytes to send.
+ * @return            the number of bytes accepted, which may be less
+ *                    than length if the transmit buffer is full, else
+ *                    negative error code.
+ */
+int32_t uBleNusSend(uBleNusHandle_t nusHandle, int32_t connHandle,
+                    const void *pData, size_t length);
+
+/** Wait for all of the data sent on a connection to be passed to
+ * the module.
+ *
+ * @param nusHandle   the handle of the NUS instance.
+ * @param connHandle  the connection handle.
+ * @param timeoutMs   the maximum time to wait in milliseconds.
+ * @return            zero on success, #U_ERROR_COMMON_TIMEOUT if the
+ *                    data was not sent in time, else negative error
+ *                    code, e.g. if sending failed.
+ */
+int32_t uBleNusFlush(uBleNusHandle_t nusHandle, int32_t connHandle,
+                     int32_t timeoutMs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -279,6 +279,103 @@ int32_t uBleGattWriteNotifyValue(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
+// The ucx client is synchronous so, for the second generation
+// u-connectXpress, queued operations are carried out immediately
+// and their callback is called before the function returns.
+
+void uBleGattPrivateInit(void)
+{
+}
+
+void uBleGattPrivateDeinit(void)
+{
+}
+
+int32_t uBleGattQueueWindowSet(uDeviceHandle_t devHandle,
+                               int32_t connHandle, size_t window)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    (void)connHandle;
+    if ((pShortRangePrivateGetUcxHandle(devHandle) != NULL) &&
+        (window > 0) && (window <= U_BLE_GATT_QUEUE_MAX_LENGTH)) {
+        errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+    }
+    return errorCode;
+}
+
+int32_t uBleGattWriteValueQueued(uDeviceHandle_t devHandle,
+                                 int32_t connHandle, uint16_t valueHandle,
+                                 const void *pValue, size_t valueLength,
+                                 bool waitResponse,
+                                 uBleGattQueueCallback_t pCallback,
+                                 void *pCallbackParameter)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    if (valueLength <= U_BLE_GATT_VALUE_MAX_LENGTH_BYTES) {
+        errorCode = uBleGattWriteValue(devHandle, connHandle, valueHandle,
+                                       pValue, (uint8_t)valueLength, waitResponse);
+        if (pCallback != NULL) {
+            pCallback(connHandle, valueHandle, errorCode, pCallbackParameter);
+        }
+    }
+    return errorCode;
+}
+
+int32_t uBleGattWriteNotifyValueQueued(uDeviceHandle_t devHandle,
+                                       int32_t connHandle, uint16_t valueHandle,
+                                       const void *pValue, size_t valueLength,
+                                       uBleGattQueueCallback_t pCallback,
+                                       void *pCallbackParameter)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    if (valueLength <= U_BLE_GATT_VALUE_MAX_LENGTH_BYTES) {
+        errorCode = uBleGattWriteNotifyValue(devHandle, connHandle, valueHandle,
+                                             pValue, (uint8_t)valueLength);
+        if (pCallback != NULL) {
+            pCallback(connHandle, valueHandle, errorCode, pCallbackParameter);
+        }
+    }
+    return errorCode;
+}
+
+int32_t uBleGattReadValueQueued(uDeviceHandle_t devHandle,
+                                int32_t connHandle, uint16_t valueHandle,
+                                uBleGattQueueReadCallback_t pCallback,
+                                void *pCallbackParameter)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    uCxHandle_t *pUcxHandle = pShortRangePrivateGetUcxHandle(devHandle);
+    uint8_t value[U_BLE_GATT_VALUE_MAX_LENGTH_BYTES];
+    int32_t len = 0;
+    if ((pUcxHandle != NULL) && (pCallback != NULL)) {
+        uCxGattClientRead_t resp;
+        errorCode = uCxBeginGattClientRead(pUcxHandle, connHandle, valueHandle, &resp);
+        if (errorCode == 0) {
+            len = resp.hex_data.length;
+            if (len > (int32_t)sizeof(value)) {
+                len = sizeof(value);
+            }
+            memcpy(value, resp.hex_data.pData, len);
+        }
+        errorCode = uCxEnd(pUcxHandle);
+        pCallback(connHandle, valueHandle, value,
+                  (errorCode == 0) ? len : errorCode, pCallbackParameter);
+    }
+    return errorCode;
+}
+
+int32_t uBleGattQueueFlush(uDeviceHandle_t devHandle, int32_t connHandle,
+                           int32_t timeoutMs)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    (void)connHandle;
+    (void)timeoutMs;
+    if (pShortRangePrivateGetUcxHandle(devHandle) != NULL) {
+        errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+    }
+    return errorCode;
+}
+
 int32_t uBleGattBeginAddService(uDeviceHandle_t devHandle,
                                 const char *pUuid)
 {
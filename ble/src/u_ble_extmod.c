@@ -68,12 +68,16 @@
 int32_t uBleInit(void)
 {
     uBleSpsPrivateInit();
+    uBleGattPrivateInit();
+    uBleNusPrivateInit();
     return uShortRangeInit();
 }
 
 // Shut-down the ble driver.
 void uBleDeinit(void)
 {
+    uBleNusPrivateDeinit();
+    uBleGattPrivateDeinit();
     uBleSpsPrivateDeinit();
     uShortRangeDeinit();
 }
@@ -42,6 +42,18 @@ extern "C" {
  */
 int32_t uBlePrivateGetRole(uDeviceHandle_t devHandle);
 
+/** Tell the GATT operation queues that a connection has gone away:
+ * operations not yet sent are called back with
+ * #U_ERROR_COMMON_CANCELLED and the queue of the connection is
+ * emptied and its window returned to the default.  Called from
+ * the disconnect URC handler and so must not block on the AT
+ * client.
+ *
+ * @param atHandle    the AT client on which the URC arrived.
+ * @param connHandle  the connection handle.
+ */
+void uBleGattPrivateDisconnected(uAtClientHandle_t atHandle, int32_t connHandle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -125,7 +125,10 @@ static void disconnectUrc(uAtClientHandle_t atHandle, void *pParameter)
 {
     uBleGapConnectCallback_t cb = (uBleGapConnectCallback_t)pParameter;
     int32_t connHandle = uAtClientReadInt(atHandle);
-    cb(connHandle, NULL, false);
+    uBleGattPrivateDisconnected(atHandle, connHandle);
+    if (cb != NULL) {
+        cb(connHandle, NULL, false);
+    }
 }
 
 // Use common connect urc callback using the provided application callback as parameter
@@ -138,10 +141,12 @@ static int32_t setConnectUrc(uAtClientHandle_t atHandle, uBleGapConnectCallback_
     if (cb) {
         errorCode = uAtClientSetUrcHandler(atHandle, "+UUBTACLC:",
                                            connectUrc, cb);
-        if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
-            errorCode = uAtClientSetUrcHandler(atHandle, "+UUBTACLD:",
-                                               disconnectUrc, cb);
-        }
+    }
+    if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+        // Always handled so that the GATT operation queues
+        // hear about disconnects
+        errorCode = uAtClientSetUrcHandler(atHandle, "+UUBTACLD:",
+                                           disconnectUrc, cb);
     }
     return errorCode;
 }
@@ -47,6 +47,9 @@
 #include "u_port.h"
 #include "u_port_os.h"
 #include "u_port_heap.h"
+#include "u_port_event_queue.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_hex_bin_convert.h"
 #include "u_short_range.h"
 #include "u_short_range_module_type.h"
 #include "u_short_range_pbuf.h"
@@ -61,14 +64,104 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_BLE_GATT_QUEUE_EVENT_STACK_SIZE
+/** The stack size of the task that sends queued GATT operations
+ * to the module; callbacks are called from this task.
+ */
+# define U_BLE_GATT_QUEUE_EVENT_STACK_SIZE 2048
+#endif
+
+#ifndef U_BLE_GATT_QUEUE_EVENT_PRIORITY
+/** The priority of the task that sends queued GATT operations
+ * to the module.
+ */
+# define U_BLE_GATT_QUEUE_EVENT_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
+#ifndef U_BLE_GATT_QUEUE_EVENT_QUEUE_LENGTH
+/** The length of the event queue that schedules the sending of
+ * queued GATT operations: there is at most one event outstanding
+ * per connection.
+ */
+# define U_BLE_GATT_QUEUE_EVENT_QUEUE_LENGTH 8
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The kinds of queued GATT operation.
+ */
+typedef enum {
+    U_BLE_GATT_QUEUE_OP_WRITE_NO_RESPONSE,
+    U_BLE_GATT_QUEUE_OP_WRITE,
+    U_BLE_GATT_QUEUE_OP_NOTIFY,
+    U_BLE_GATT_QUEUE_OP_READ
+} uBleGattQueueOpType_t;
+
+/** A queued GATT operation; the value, or room for the value
+ * to be read into, is allocated with the structure.
+ */
+typedef struct uBleGattQueueOp_t {
+    uBleGattQueueOpType_t type;
+    uint16_t valueHandle;
+    uBleGattQueueCallback_t pCallback;
+    uBleGattQueueReadCallback_t pReadCallback; /**< used instead of pCallback for a read. */
+    void *pCallbackParameter;
+    int32_t errorCode;  /**< filled in by the worker; the length read for a read. */
+    size_t valueLength;
+    struct uBleGattQueueOp_t *pNext;
+    uint8_t value[1];   /**< actually valueLength bytes long. */
+} uBleGattQueueOp_t;
+
+/** The queue of GATT operations for one connection.
+ */
+typedef struct uBleGattQueue_t {
+    uDeviceHandle_t devHandle;
+    uAtClientHandle_t atHandle; /**< so that a disconnect URC can find the queue. */
+    int32_t connHandle;
+    size_t window;
+    size_t count;       /**< the number of operations not yet completed. */
+    bool scheduled;     /**< true if the worker has been told about this queue. */
+    uint32_t generation; /**< incremented when the connection goes away, so
+                              that the worker does not count a batch it
+                              took before then against the new count. */
+    uPortSemaphoreHandle_t emptySemaphore; /**< given when count reaches zero. */
+    uBleGattQueueOp_t *pHead;
+    uBleGattQueueOp_t *pTail;
+    uBleGattQueueOp_t *pDropped; /**< operations dropped by a disconnect,
+                                      for the worker to call back. */
+    struct uBleGattQueue_t *pNext;
+} uBleGattQueue_t;
+
+/** The event sent to the worker: which queue to service.
+ */
+typedef struct {
+    uDeviceHandle_t devHandle;
+    int32_t connHandle;
+} uBleGattQueueEvent_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** Mutex protecting the queue list below.
+ */
+static uPortMutexHandle_t gBleGattMutex = NULL;
+
+/** The event queue of the worker that sends queued operations.
+ */
+static int32_t gBleGattEventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+
+/** Root of the list of per-connection operation queues.
+ */
+static uBleGattQueue_t *gpBleGattQueueList = NULL;
+
+/** Hex-encoding buffer for a value: only used by the worker
+ * so that no allocation is required per operation.
+ */
+static char gBleGattHexBuffer[(U_BLE_GATT_VALUE_MAX_LENGTH_BYTES * 2) + 1];
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -83,7 +176,7 @@ static void notifyUrc(uAtClientHandle_t atHandle,
     x = uAtClientReadInt(atHandle);
     ok = ok && (x >= 0);
     uint16_t valueHandle = (uint16_t) x;
-    uint8_t value[25];
+    uint8_t value[U_BLE_GATT_VALUE_MAX_LENGTH_BYTES];
     x = uAtClientReadHexData(atHandle, value, sizeof(value));
     ok = ok && (x >= 0);
     uint16_t valueSize = (uint16_t) x;
@@ -102,7 +195,7 @@ static void writeUrc(uAtClientHandle_t atHandle,
     x = uAtClientReadInt(atHandle);
     ok = ok && (x >= 0);
     uint16_t valueHandle = (uint16_t) x;
-    uint8_t value[25];
+    uint8_t value[U_BLE_GATT_VALUE_MAX_LENGTH_BYTES];
     x = uAtClientReadHexData(atHandle, value, sizeof(value));
     ok = ok && (x >= 0);
     uint16_t valueSize = (uint16_t) x;
@@ -133,10 +226,493 @@ static int32_t writeValue(uDeviceHandle_t devHandle, const char *pAtCom,
     return errorCode;
 }
 
+// Find the operation queue for a connection, optionally creating
+// it; gBleGattMutex must be locked.
+static uBleGattQueue_t *pQueueGet(uDeviceHandle_t devHandle,
+                                  int32_t connHandle, bool create)
+{
+    uBleGattQueue_t *pQueue = gpBleGattQueueList;
+
+    while ((pQueue != NULL) &&
+           ((pQueue->devHandle != devHandle) || (pQueue->connHandle != connHandle))) {
+        pQueue = pQueue->pNext;
+    }
+    if ((pQueue == NULL) && create) {
+        pQueue = (uBleGattQueue_t *)pUPortMalloc(sizeof(uBleGattQueue_t));
+        if (pQueue != NULL) {
+            memset(pQueue, 0, sizeof(*pQueue));
+            pQueue->devHandle = devHandle;
+            pQueue->connHandle = connHandle;
+            pQueue->window = U_BLE_GATT_QUEUE_WINDOW_DEFAULT;
+            if (uPortSemaphoreCreate(&pQueue->emptySemaphore, 0, 1) == 0) {
+                pQueue->pNext = gpBleGattQueueList;
+                gpBleGattQueueList = pQueue;
+            } else {
+                uPortFree(pQueue);
+                pQueue = NULL;
+            }
+        }
+    }
+
+    return pQueue;
+}
+
+// Free a list of operations.
+static void freeOps(uBleGattQueueOp_t *pOp)
+{
+    uBleGattQueueOp_t *pNext;
+
+    while (pOp != NULL) {
+        pNext = pOp->pNext;
+        uPortFree(pOp);
+        pOp = pNext;
+    }
+}
+
+// Call the callbacks of a list of completed operations, returning
+// the number of operations; must be called with no locks held so
+// that the callbacks may queue further operations.
+static size_t callbacksCall(int32_t connHandle, const uBleGattQueueOp_t *pOp)
+{
+    size_t count = 0;
+
+    while (pOp != NULL) {
+        if (pOp->pReadCallback != NULL) {
+            pOp->pReadCallback(connHandle, pOp->valueHandle,
+                               pOp->value, pOp->errorCode,
+                               pOp->pCallbackParameter);
+        } else if (pOp->pCallback != NULL) {
+            pOp->pCallback(connHandle, pOp->valueHandle,
+                           pOp->errorCode, pOp->pCallbackParameter);
+        }
+        count++;
+        pOp = pOp->pNext;
+    }
+
+    return count;
+}
+
+// Return true if an operation must be sent on its own, i.e. it
+// is a write with response or a read.
+static bool isBarrier(const uBleGattQueueOp_t *pOp)
+{
+    return (pOp->type == U_BLE_GATT_QUEUE_OP_WRITE) ||
+           (pOp->type == U_BLE_GATT_QUEUE_OP_READ);
+}
+
+// Remove the next batch of operations from the head of a queue:
+// up to window writes-without-response/notifications or a single
+// write with response or read, which acts as a barrier;
+// gBleGattMutex must be locked.
+static uBleGattQueueOp_t *pBatchTake(uBleGattQueue_t *pQueue)
+{
+    uBleGattQueueOp_t *pBatch = pQueue->pHead;
+    uBleGattQueueOp_t *pLast = pBatch;
+    size_t count = 1;
+
+    if (pBatch != NULL) {
+        if (!isBarrier(pBatch)) {
+            while ((count < pQueue->window) && (pLast->pNext != NULL) &&
+                   !isBarrier(pLast->pNext)) {
+                pLast = pLast->pNext;
+                count++;
+            }
+        }
+        pQueue->pHead = pLast->pNext;
+        if (pQueue->pHead == NULL) {
+            pQueue->pTail = NULL;
+        }
+        pLast->pNext = NULL;
+    }
+
+    return pBatch;
+}
+
+// Send the AT command for an operation; the AT client must be
+// locked.
+static void commandSend(uAtClientHandle_t atHandle, int32_t connHandle,
+                        const uBleGattQueueOp_t *pOp)
+{
+    const char *pAtCom;
+
+    switch (pOp->type) {
+        case U_BLE_GATT_QUEUE_OP_READ:
+            pAtCom = "AT+UBTGR=";
+            break;
+        case U_BLE_GATT_QUEUE_OP_WRITE:
+            pAtCom = "AT+UBTGW=";
+            break;
+        case U_BLE_GATT_QUEUE_OP_NOTIFY:
+            pAtCom = "AT+UBTGSN=";
+            break;
+        default:
+            pAtCom = "AT+UBTGWN=";
+            break;
+    }
+    uAtClientCommandStart(atHandle, pAtCom);
+    uAtClientWriteInt(atHandle, connHandle);
+    uAtClientWriteInt(atHandle, pOp->valueHandle);
+    if (pOp->type != U_BLE_GATT_QUEUE_OP_READ) {
+        gBleGattHexBuffer[uBinToHex((const char *)pOp->value, pOp->valueLength,
+                                    gBleGattHexBuffer)] = 0;
+        uAtClientWriteString(atHandle, gBleGattHexBuffer, false);
+    }
+    uAtClientCommandStop(atHandle);
+}
+
+// Collect the response to the AT command for an operation; the
+// AT client must be locked.  An ERROR from the module fails only
+// the operation concerned but, since the AT client error is
+// otherwise sticky, a timeout fails everything after it.
+static void responseGet(uAtClientHandle_t atHandle, uBleGattQueueOp_t *pOp)
+{
+    uAtClientDeviceError_t deviceError;
+    int32_t length = 0;
+
+    if (pOp->type == U_BLE_GATT_QUEUE_OP_READ) {
+        if (uAtClientResponseStart(atHandle, "+UBTGR:") == 0) {
+            uAtClientReadInt(atHandle);
+            uAtClientReadInt(atHandle);
+            length = uAtClientReadHexData(atHandle, pOp->value,
+                                          U_BLE_GATT_VALUE_MAX_LENGTH_BYTES);
+        }
+    } else {
+        uAtClientResponseStart(atHandle, NULL);
+    }
+    uAtClientResponseStop(atHandle);
+    pOp->errorCode = uAtClientErrorGet(atHandle);
+    if ((pOp->errorCode == 0) && (pOp->type == U_BLE_GATT_QUEUE_OP_READ)) {
+        pOp->errorCode = length;
+    }
+    uAtClientDeviceErrorGet(atHandle, &deviceError);
+    if (deviceError.type != U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR) {
+        // The module rejected this one: carry on with the rest
+        uAtClientClearError(atHandle);
+    }
+}
+
+// Send a batch of operations to the module and collect the
+// responses.  Unless pipeline is set each command is sent only
+// once the response to the one before it has arrived; with
+// pipeline set, which is only the case if the application has
+// opened the window with uBleGattQueueWindowSet(), all of the
+// commands are written before the first response is read, so
+// that the module can be working on one while the next is on
+// the wire.
+static void batchSend(uDeviceHandle_t devHandle, int32_t connHandle,
+                      uBleGattQueueOp_t *pBatch, bool pipeline)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    uShortRangePrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    uBleGattQueueOp_t *pOp;
+
+    if (uShortRangeLock() == (int32_t)U_ERROR_COMMON_SUCCESS) {
+        errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUShortRangePrivateGetInstance(devHandle);
+        if (pInstance != NULL) {
+            atHandle = pInstance->atHandle;
+            uAtClientLock(atHandle);
+            for (pOp = pBatch; pOp != NULL; pOp = pOp->pNext) {
+                commandSend(atHandle, connHandle, pOp);
+                if (!pipeline) {
+                    responseGet(atHandle, pOp);
+                }
+            }
+            if (pipeline) {
+                for (pOp = pBatch; pOp != NULL; pOp = pOp->pNext) {
+                    responseGet(atHandle, pOp);
+                }
+            }
+            uAtClientUnlock(atHandle);
+            errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+        }
+        uShortRangeUnlock();
+    }
+    if (errorCode != (int32_t)U_ERROR_COMMON_SUCCESS) {
+        for (pOp = pBatch; pOp != NULL; pOp = pOp->pNext) {
+            pOp->errorCode = errorCode;
+        }
+    }
+}
+
+// Event handler of the worker: keep sending batches from the
+// given queue until it is empty.
+static void onBleGattQueueEvent(void *pParam, size_t eventSize)
+{
+    uBleGattQueueEvent_t *pEvent = (uBleGattQueueEvent_t *)pParam;
+    uBleGattQueue_t *pQueue;
+    uBleGattQueueOp_t *pBatch;
+    uBleGattQueueOp_t *pDropped;
+    uint32_t generation = 0;
+    size_t count;
+    bool pipeline = false;
+
+    (void)eventSize;
+
+    do {
+        pBatch = NULL;
+        pDropped = NULL;
+        U_PORT_MUTEX_LOCK(gBleGattMutex);
+        pQueue = pQueueGet(pEvent->devHandle, pEvent->connHandle, false);
+        if (pQueue != NULL) {
+            pDropped = pQueue->pDropped;
+            pQueue->pDropped = NULL;
+            pipeline = (pQueue->window > 1);
+            generation = pQueue->generation;
+            pBatch = pBatchTake(pQueue);
+            if ((pBatch == NULL) && (pDropped == NULL)) {
+                pQueue->scheduled = false;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gBleGattMutex);
+
+        // Operations dropped by a disconnect are not counted
+        (void)callbacksCall(pEvent->connHandle, pDropped);
+        freeOps(pDropped);
+        if (pBatch != NULL) {
+            batchSend(pEvent->devHandle, pEvent->connHandle, pBatch, pipeline);
+            count = callbacksCall(pEvent->connHandle, pBatch);
+            freeOps(pBatch);
+            U_PORT_MUTEX_LOCK(gBleGattMutex);
+            pQueue = pQueueGet(pEvent->devHandle, pEvent->connHandle, false);
+            if ((pQueue != NULL) && (pQueue->generation == generation)) {
+                pQueue->count -= count;
+                if (pQueue->count == 0) {
+                    uPortSemaphoreGive(pQueue->emptySemaphore);
+                }
+            }
+            U_PORT_MUTEX_UNLOCK(gBleGattMutex);
+        }
+    } while ((pBatch != NULL) || (pDropped != NULL));
+}
+
+// Send the worker an event for a queue that has just been marked
+// as scheduled, un-marking it if that fails.
+static void schedule(uDeviceHandle_t devHandle, int32_t connHandle)
+{
+    uBleGattQueueEvent_t event = {0};
+    uBleGattQueue_t *pQueue;
+
+    event.devHandle = devHandle;
+    event.connHandle = connHandle;
+    if (uPortEventQueueSend(gBleGattEventQueue, &event, sizeof(event)) < 0) {
+        U_PORT_MUTEX_LOCK(gBleGattMutex);
+        pQueue = pQueueGet(devHandle, connHandle, false);
+        if (pQueue != NULL) {
+            pQueue->scheduled = false;
+        }
+        U_PORT_MUTEX_UNLOCK(gBleGattMutex);
+    }
+}
+
+// Handler for the GAP disconnect URC, installed when a queue is
+// first created if nothing else is handling that URC.
+static void disconnectUrc(uAtClientHandle_t atHandle, void *pParameter)
+{
+    (void)pParameter;
+    uBleGattPrivateDisconnected(atHandle, uAtClientReadInt(atHandle));
+}
+
+// Make sure that a GATT queue hears about the connection going
+// away: if there is no queue for the connection yet, and nothing
+// else (e.g. the GAP API) has installed a handler for the
+// disconnect URC, install one; must be called with the short
+// range lock held but NOT gBleGattMutex, since the URC handler
+// locks gBleGattMutex.
+static void disconnectUrcSet(uDeviceHandle_t devHandle, int32_t connHandle,
+                             uAtClientHandle_t atHandle)
+{
+    bool exists;
+
+    U_PORT_MUTEX_LOCK(gBleGattMutex);
+    exists = (pQueueGet(devHandle, connHandle, false) != NULL);
+    U_PORT_MUTEX_UNLOCK(gBleGattMutex);
+    if (!exists) {
+        // Does nothing if there is a handler already
+        uAtClientSetUrcHandler(atHandle, "+UUBTACLD:", disconnectUrc, NULL);
+    }
+}
+
+// Add an operation to the queue of a connection and make sure
+// that the worker knows about it.
+static int32_t queueOp(uDeviceHandle_t devHandle, int32_t connHandle,
+                       uBleGattQueueOpType_t type, uint16_t valueHandle,
+                       const void *pValue, size_t valueLength,
+                       uBleGattQueueCallback_t pCallback,
+                       uBleGattQueueReadCallback_t pReadCallback,
+                       void *pCallbackParameter)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    uShortRangePrivateInstance_t *pInstance;
+    uBleGattQueue_t *pQueue;
+    uBleGattQueueOp_t *pOp;
+    uAtClientHandle_t atHandle = NULL;
+    size_t allocLength = valueLength;
+    bool doSchedule = false;
+
+    if (type == U_BLE_GATT_QUEUE_OP_READ) {
+        // Room for the value to be read into
+        allocLength = U_BLE_GATT_VALUE_MAX_LENGTH_BYTES;
+    }
+    if ((gBleGattMutex != NULL) &&
+        (uShortRangeLock() == (int32_t)U_ERROR_COMMON_SUCCESS)) {
+        errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUShortRangePrivateGetInstance(devHandle);
+        if ((pInstance != NULL) && ((pValue != NULL) || (valueLength == 0)) &&
+            (valueLength <= U_BLE_GATT_VALUE_MAX_LENGTH_BYTES)) {
+            errorCode = (int32_t)U_ERROR_COMMON_NOT_SUPPORTED;
+            if ((type != U_BLE_GATT_QUEUE_OP_NOTIFY) ||
+                U_SHORT_RANGE_PRIVATE_HAS(pInstance->pModule,
+                                          U_SHORT_RANGE_PRIVATE_FEATURE_GATT_SERVER)) {
+                atHandle = pInstance->atHandle;
+                disconnectUrcSet(devHandle, connHandle, atHandle);
+                errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+            }
+        }
+        uShortRangeUnlock();
+    }
+
+    if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+        U_PORT_MUTEX_LOCK(gBleGattMutex);
+        errorCode = (int32_t)U_ERROR_COMMON_NO_MEMORY;
+        if (gBleGattEventQueue == (int32_t)U_ERROR_COMMON_NOT_INITIALISED) {
+            gBleGattEventQueue = uPortEventQueueOpen(onBleGattQueueEvent,
+                                                     "uBleGattQueue",
+                                                     sizeof(uBleGattQueueEvent_t),
+                                                     U_BLE_GATT_QUEUE_EVENT_STACK_SIZE,
+                                                     U_BLE_GATT_QUEUE_EVENT_PRIORITY,
+                                                     U_BLE_GATT_QUEUE_EVENT_QUEUE_LENGTH);
+            if (gBleGattEventQueue < 0) {
+                errorCode = gBleGattEventQueue;
+                gBleGattEventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+            }
+        }
+        pQueue = NULL;
+        if (gBleGattEventQueue >= 0) {
+            pQueue = pQueueGet(devHandle, connHandle, true);
+        }
+        if (pQueue != NULL) {
+            pQueue->atHandle = atHandle;
+            errorCode = (int32_t)U_ERROR_COMMON_BUSY;
+            if (pQueue->count < U_BLE_GATT_QUEUE_MAX_LENGTH) {
+                errorCode = (int32_t)U_ERROR_COMMON_NO_MEMORY;
+                pOp = (uBleGattQueueOp_t *)pUPortMalloc(sizeof(uBleGattQueueOp_t) + allocLength);
+                if (pOp != NULL) {
+                    memset(pOp, 0, sizeof(*pOp));
+                    pOp->type = type;
+                    pOp->valueHandle = valueHandle;
+                    pOp->pCallback = pCallback;
+                    pOp->pReadCallback = pReadCallback;
+                    pOp->pCallbackParameter = pCallbackParameter;
+                    pOp->valueLength = valueLength;
+                    if (valueLength > 0) {
+                        memcpy(pOp->value, pValue, valueLength);
+                    }
+                    if (pQueue->pTail != NULL) {
+                        pQueue->pTail->pNext = pOp;
+                    } else {
+                        pQueue->pHead = pOp;
+                    }
+                    pQueue->pTail = pOp;
+                    pQueue->count++;
+                    if (!pQueue->scheduled) {
+                        pQueue->scheduled = true;
+                        doSchedule = true;
+                    }
+                    errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+                }
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gBleGattMutex);
+        if (doSchedule) {
+            // Sent outside the mutex as this may block
+            // until the worker has room
+            schedule(devHandle, connHandle);
+        }
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+void uBleGattPrivateInit(void)
+{
+    if (gBleGattMutex == NULL) {
+        uPortMutexCreate(&gBleGattMutex);
+    }
+}
+
+void uBleGattPrivateDeinit(void)
+{
+    uBleGattQueue_t *pQueue;
+
+    if (gBleGattEventQueue != (int32_t)U_ERROR_COMMON_NOT_INITIALISED) {
+        uPortEventQueueClose(gBleGattEventQueue);
+        gBleGattEventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    }
+    if (gBleGattMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gBleGattMutex);
+        // Anything still queued is dropped without a callback
+        while (gpBleGattQueueList != NULL) {
+            pQueue = gpBleGattQueueList;
+            gpBleGattQueueList = pQueue->pNext;
+            freeOps(pQueue->pHead);
+            freeOps(pQueue->pDropped);
+            uPortSemaphoreDelete(pQueue->emptySemaphore);
+            uPortFree(pQueue);
+        }
+        U_PORT_MUTEX_UNLOCK(gBleGattMutex);
+        uPortMutexDelete(gBleGattMutex);
+        gBleGattMutex = NULL;
+    }
+}
+
+void uBleGattPrivateDisconnected(uAtClientHandle_t atHandle, int32_t connHandle)
+{
+    uBleGattQueue_t *pQueue;
+    uBleGattQueueOp_t *pOp;
+    uDeviceHandle_t devHandle = NULL;
+    bool doSchedule = false;
+
+    if (gBleGattMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gBleGattMutex);
+        for (pQueue = gpBleGattQueueList; pQueue != NULL; pQueue = pQueue->pNext) {
+            if ((pQueue->atHandle == atHandle) && (pQueue->connHandle == connHandle)) {
+                // Anything not yet sent is handed to the worker to
+                // call back with an error, while a batch the worker
+                // is sending now is no longer counted
+                for (pOp = pQueue->pHead; pOp != NULL; pOp = pOp->pNext) {
+                    pOp->errorCode = (int32_t)U_ERROR_COMMON_CANCELLED;
+                }
+                if (pQueue->pHead != NULL) {
+                    pQueue->pTail->pNext = pQueue->pDropped;
+                    pQueue->pDropped = pQueue->pHead;
+                    pQueue->pHead = NULL;
+                    pQueue->pTail = NULL;
+                    if (!pQueue->scheduled) {
+                        pQueue->scheduled = true;
+                        devHandle = pQueue->devHandle;
+                        doSchedule = true;
+                    }
+                }
+                pQueue->count = 0;
+                pQueue->window = U_BLE_GATT_QUEUE_WINDOW_DEFAULT;
+                pQueue->generation++;
+                uPortSemaphoreGive(pQueue->emptySemaphore);
+                break;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gBleGattMutex);
+        if (doSchedule) {
+            schedule(devHandle, connHandle);
+        }
+    }
+}
+
 int32_t uBleGattDiscoverServices(uDeviceHandle_t devHandle,
                                  int32_t connHandle,
                                  uBleGattDiscoverServiceCallback_t cb)
@@ -367,6 +943,122 @@ int32_t uBleGattWriteNotifyValue(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
+int32_t uBleGattQueueWindowSet(uDeviceHandle_t devHandle,
+                               int32_t connHandle, size_t window)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    uShortRangePrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle = NULL;
+    uBleGattQueue_t *pQueue;
+
+    if ((gBleGattMutex != NULL) &&
+        (uShortRangeLock() == (int32_t)U_ERROR_COMMON_SUCCESS)) {
+        errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUShortRangePrivateGetInstance(devHandle);
+        if ((pInstance != NULL) && (window > 0) &&
+            (window <= U_BLE_GATT_QUEUE_MAX_LENGTH)) {
+            atHandle = pInstance->atHandle;
+            disconnectUrcSet(devHandle, connHandle, atHandle);
+            errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+        }
+        uShortRangeUnlock();
+    }
+
+    if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+        U_PORT_MUTEX_LOCK(gBleGattMutex);
+        errorCode = (int32_t)U_ERROR_COMMON_NO_MEMORY;
+        pQueue = pQueueGet(devHandle, connHandle, true);
+        if (pQueue != NULL) {
+            pQueue->atHandle = atHandle;
+            pQueue->window = window;
+            errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+        }
+        U_PORT_MUTEX_UNLOCK(gBleGattMutex);
+    }
+
+    return errorCode;
+}
+
+int32_t uBleGattWriteValueQueued(uDeviceHandle_t devHandle,
+                                 int32_t connHandle, uint16_t valueHandle,
+                                 const void *pValue, size_t valueLength,
+                                 bool waitResponse,
+                                 uBleGattQueueCallback_t pCallback,
+                                 void *pCallbackParameter)
+{
+    return queueOp(devHandle, connHandle,
+                   waitResponse ? U_BLE_GATT_QUEUE_OP_WRITE : U_BLE_GATT_QUEUE_OP_WRITE_NO_RESPONSE,
+                   valueHandle, pValue, valueLength, pCallback, NULL,
+                   pCallbackParameter);
+}
+
+int32_t uBleGattWriteNotifyValueQueued(uDeviceHandle_t devHandle,
+                                       int32_t connHandle, uint16_t valueHandle,
+                                       const void *pValue, size_t valueLength,
+                                       uBleGattQueueCallback_t pCallback,
+                                       void *pCallbackParameter)
+{
+    return queueOp(devHandle, connHandle, U_BLE_GATT_QUEUE_OP_NOTIFY,
+                   valueHandle, pValue, valueLength, pCallback, NULL,
+                   pCallbackParameter);
+}
+
+int32_t uBleGattReadValueQueued(uDeviceHandle_t devHandle,
+                                int32_t connHandle, uint16_t valueHandle,
+                                uBleGattQueueReadCallback_t pCallback,
+                                void *pCallbackParameter)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pCallback != NULL) {
+        errorCode = queueOp(devHandle, connHandle, U_BLE_GATT_QUEUE_OP_READ,
+                            valueHandle, NULL, 0, NULL, pCallback,
+                            pCallbackParameter);
+    }
+
+    return errorCode;
+}
+
+int32_t uBleGattQueueFlush(uDeviceHandle_t devHandle, int32_t connHandle,
+                           int32_t timeoutMs)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+    int32_t waitMs;
+    uBleGattQueue_t *pQueue;
+    uPortSemaphoreHandle_t emptySemaphore = NULL;
+    bool empty = false;
+
+    if (gBleGattMutex != NULL) {
+        errorCode = (int32_t)U_ERROR_COMMON_TIMEOUT;
+        do {
+            U_PORT_MUTEX_LOCK(gBleGattMutex);
+            pQueue = pQueueGet(devHandle, connHandle, false);
+            empty = (pQueue == NULL) || (pQueue->count == 0);
+            if (pQueue != NULL) {
+                // Queues are only freed by uBleGattPrivateDeinit()
+                emptySemaphore = pQueue->emptySemaphore;
+            }
+            U_PORT_MUTEX_UNLOCK(gBleGattMutex);
+            waitMs = timeoutMs - (uPortGetTickTimeMs() - startTimeMs);
+            if (!empty && (waitMs > 0)) {
+                // The semaphore may have been given for an earlier
+                // emptying, hence the loop
+                (void)uPortSemaphoreTryTake(emptySemaphore, waitMs);
+            }
+        } while (!empty && (waitMs > 0));
+        if (empty) {
+            if (emptySemaphore != NULL) {
+                // Pass it on to anyone else waiting
+                uPortSemaphoreGive(emptySemaphore);
+            }
+            errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
 int32_t uBleGattBeginAddService(uDeviceHandle_t devHandle,
                                 const char *pUuid)
 {
@@ -48,6 +48,9 @@
 #include "u_port.h"
 #include "u_port_os.h"
 #include "u_port_heap.h"
+#include "u_port_event_queue.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_ringbuffer.h"
 #include "u_short_range.h"
 #include "u_short_range_module_type.h"
 #include "u_short_range_pbuf.h"
@@ -69,10 +72,95 @@
 
 #define VALIDATE(f) if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) { errorCode = f; }
 
+#ifndef U_BLE_NUS_EVENT_STACK_SIZE
+/** The stack size of the task that feeds the transmit buffers
+ * of the handle-based NUS API to GATT.
+ */
+# define U_BLE_NUS_EVENT_STACK_SIZE 2048
+#endif
+
+#ifndef U_BLE_NUS_EVENT_PRIORITY
+/** The priority of the task that feeds the transmit buffers
+ * of the handle-based NUS API to GATT.
+ */
+# define U_BLE_NUS_EVENT_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
+#ifndef U_BLE_NUS_EVENT_QUEUE_LENGTH
+/** The length of the event queue of the NUS task; at most one
+ * event per connection is ever queued so this should be no less
+ * than the number of concurrent connections.
+ */
+# define U_BLE_NUS_EVENT_QUEUE_LENGTH 16
+#endif
+
+#ifndef U_BLE_NUS_CONNECT_TIMEOUT_MS
+/** How long uBleNusConnect() waits for a connection to be
+ * established.
+ */
+# define U_BLE_NUS_CONNECT_TIMEOUT_MS 30000
+#endif
+
+#ifndef U_BLE_NUS_CLOSE_FLUSH_TIMEOUT_MS
+/** How long uBleNusClose() waits, per connection, for operations
+ * already passed to GATT to complete.
+ */
+# define U_BLE_NUS_CLOSE_FLUSH_TIMEOUT_MS 5000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A connection of a handle-based NUS instance.
+ */
+typedef struct uBleNusConnection_t {
+    int32_t connHandle;
+    uint16_t rxHandle;      /**< the value handle the client writes to. */
+    uint16_t txHandle;      /**< the value handle the server notifies on. */
+    size_t payloadMax;      /**< the largest notification/write, from the MTU. */
+    uBleNusDataCallback_t pDataCallback;
+    void *pDataCallbackParameter;
+    uRingBuffer_t txRingBuffer;
+    char txBuffer[U_BLE_NUS_TX_BUFFER_LENGTH_BYTES];
+    size_t inFlight;        /**< operations passed to GATT and not yet completed. */
+    int32_t txErrorCode;    /**< the first transmit error, reported by uBleNusFlush(). */
+    bool scheduled;         /**< true if the NUS task has been told about this connection. */
+    bool disconnected;      /**< true once the peer has gone, freed when inFlight is zero. */
+    struct uBleNusConnection_t *pNext;
+} uBleNusConnection_t;
+
+/** A handle-based NUS instance.
+ */
+typedef struct uBleNusInstance_t {
+    uDeviceHandle_t devHandle;
+    bool server;
+    uint16_t rxHandle;      /**< server only: the RX characteristic value handle. */
+    uint16_t txHandle;      /**< server only: the TX characteristic value handle. */
+    uBleNusConnectCallback_t pConnectCallback;
+    uBleNusDataCallback_t pDataCallback;
+    void *pCallbackParameter;
+    uBleNusConnection_t *pConnectionList;
+    bool opening;           /**< true while uBleNusOpen() is still setting up GATT. */
+    bool connecting;        /**< client only: uBleNusConnect() is running. */
+    bool closing;           /**< client only: uBleNusClose() is waiting for
+                                 uBleNusConnect() to return. */
+    int32_t connectState;   /**< client only: 0 waiting, 1 connected, -1 failed. */
+    int32_t connectConnHandle;
+    uPortSemaphoreHandle_t connectSemaphore; /**< client only: given when connectState
+                                                  changes or when closing. */
+    uPortSemaphoreHandle_t closeSemaphore;   /**< client only: given by uBleNusConnect()
+                                                  as it returns if closing. */
+    struct uBleNusInstance_t *pNext;
+} uBleNusInstance_t;
+
+/** The event sent to the NUS task: which connection to service.
+ */
+typedef struct {
+    uBleNusInstance_t *pInstance;
+    int32_t connHandle;
+} uBleNusEvent_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -85,6 +173,29 @@ static int32_t gConnHandle;
 static uint16_t gRxHandle, gTxHandle;
 static uBleNusReceiveCallback_t gReceiveCallback;
 
+/** Mutex protecting the handle-based NUS instance list below.
+ */
+static uPortMutexHandle_t gNusMutex = NULL;
+
+/** The event queue of the task that feeds the transmit buffers
+ * of the handle-based NUS API to GATT.
+ */
+static int32_t gNusEventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+
+/** Root of the list of handle-based NUS instances.
+ */
+static uBleNusInstance_t *gpNusInstanceList = NULL;
+
+/** The connection whose characteristics uBleNusConnect() is
+ * currently discovering.
+ */
+static uBleNusConnection_t *gpNusDiscovering = NULL;
+
+/** Buffer for the payload being passed to GATT: only used by the
+ * NUS task, GATT takes a copy.
+ */
+static uint8_t gNusPacket[U_BLE_GATT_VALUE_MAX_LENGTH_BYTES];
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -127,6 +238,428 @@ static void receiveCallback(uint8_t connHandle,
     }
 }
 
+// Check that an instance is in the list and open: gNusMutex must
+// be locked.
+static bool nusInstanceIsValid(const uBleNusInstance_t *pInstance)
+{
+    const uBleNusInstance_t *pTmp = gpNusInstanceList;
+    while ((pTmp != NULL) && (pTmp != pInstance)) {
+        pTmp = pTmp->pNext;
+    }
+    return (pTmp != NULL) && (pInstance != NULL) && !pInstance->opening;
+}
+
+// Remove an instance from the list, returning true if it was
+// there; if it was the last one the event queue handle is moved
+// to *pEventQueue, for the caller to close once gNusMutex has
+// been unlocked (the NUS task may be waiting for it), else
+// *pEventQueue is set to U_ERROR_COMMON_NOT_INITIALISED.
+// gNusMutex must be locked.
+static bool nusInstanceRemove(uBleNusInstance_t *pInstance,
+                              int32_t *pEventQueue)
+{
+    uBleNusInstance_t **ppTmp = &gpNusInstanceList;
+    bool found = false;
+
+    *pEventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    while ((*ppTmp != NULL) && (*ppTmp != pInstance)) {
+        ppTmp = &((*ppTmp)->pNext);
+    }
+    if (*ppTmp != NULL) {
+        *ppTmp = pInstance->pNext;
+        found = true;
+        if (gpNusInstanceList == NULL) {
+            *pEventQueue = gNusEventQueue;
+            gNusEventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+        }
+    }
+
+    return found;
+}
+
+// Find a connection of an instance, including one that has
+// disconnected if includeDisconnected is true: gNusMutex
+// must be locked.
+static uBleNusConnection_t *pNusConnectionFind(const uBleNusInstance_t *pInstance,
+                                               int32_t connHandle,
+                                               bool includeDisconnected)
+{
+    uBleNusConnection_t *pConnection = pInstance->pConnectionList;
+    while ((pConnection != NULL) &&
+           ((pConnection->connHandle != connHandle) ||
+            (pConnection->disconnected && !includeDisconnected))) {
+        pConnection = pConnection->pNext;
+    }
+    return pConnection;
+}
+
+// Add a connection to an instance: gNusMutex must be locked.
+static uBleNusConnection_t *pNusConnectionAdd(uBleNusInstance_t *pInstance,
+                                              int32_t connHandle)
+{
+    uBleNusConnection_t *pConnection;
+
+    pConnection = (uBleNusConnection_t *)pUPortMalloc(sizeof(uBleNusConnection_t));
+    if (pConnection != NULL) {
+        memset(pConnection, 0, sizeof(*pConnection));
+        if (uRingBufferCreate(&pConnection->txRingBuffer, pConnection->txBuffer,
+                              sizeof(pConnection->txBuffer)) == 0) {
+            pConnection->connHandle = connHandle;
+            pConnection->rxHandle = pInstance->rxHandle;
+            pConnection->txHandle = pInstance->txHandle;
+            pConnection->payloadMax = U_BLE_NUS_MTU_DEFAULT - 3;
+            pConnection->pDataCallback = pInstance->pDataCallback;
+            pConnection->pDataCallbackParameter = pInstance->pCallbackParameter;
+            pConnection->pNext = pInstance->pConnectionList;
+            pInstance->pConnectionList = pConnection;
+        } else {
+            uPortFree(pConnection);
+            pConnection = NULL;
+        }
+    }
+    return pConnection;
+}
+
+// Remove a connection from an instance and free it: gNusMutex
+// must be locked.
+static void nusConnectionFree(uBleNusInstance_t *pInstance,
+                              uBleNusConnection_t *pConnection)
+{
+    uBleNusConnection_t **ppTmp = &pInstance->pConnectionList;
+    while ((*ppTmp != NULL) && (*ppTmp != pConnection)) {
+        ppTmp = &((*ppTmp)->pNext);
+    }
+    if (*ppTmp != NULL) {
+        *ppTmp = pConnection->pNext;
+        uRingBufferDelete(&pConnection->txRingBuffer);
+        uPortFree(pConnection);
+    }
+}
+
+// Free an instance that is not, or is no longer, in the list,
+// along with its connections: gNusMutex must be locked.
+static void nusInstanceFree(uBleNusInstance_t *pInstance)
+{
+    while (pInstance->pConnectionList != NULL) {
+        nusConnectionFree(pInstance, pInstance->pConnectionList);
+    }
+    if (pInstance->connectSemaphore != NULL) {
+        uPortSemaphoreDelete(pInstance->connectSemaphore);
+    }
+    if (pInstance->closeSemaphore != NULL) {
+        uPortSemaphoreDelete(pInstance->closeSemaphore);
+    }
+    uPortFree(pInstance);
+}
+
+// Mark a connection as needing the attention of the NUS task,
+// returning true if an event must be sent: gNusMutex must be
+// locked, the event must be sent (with nusSchedule()) after
+// unlocking it since the send may block.
+static bool nusScheduleRequired(uBleNusConnection_t *pConnection)
+{
+    bool required = !pConnection->scheduled;
+    pConnection->scheduled = true;
+    return required;
+}
+
+// Send an event to the NUS task: gNusMutex must NOT be locked.
+static void nusSchedule(uBleNusInstance_t *pInstance, int32_t connHandle)
+{
+    uBleNusEvent_t event;
+    uBleNusConnection_t *pConnection;
+
+    event.pInstance = pInstance;
+    event.connHandle = connHandle;
+    if (uPortEventQueueSend(gNusEventQueue, &event, sizeof(event)) < 0) {
+        uPortMutexLock(gNusMutex);
+        if (nusInstanceIsValid(pInstance)) {
+            pConnection = pNusConnectionFind(pInstance, connHandle, true);
+            if (pConnection != NULL) {
+                pConnection->scheduled = false;
+            }
+        }
+        uPortMutexUnlock(gNusMutex);
+    }
+}
+
+// Called by GATT when a notification/write has been sent.
+static void nusTxCallback(int32_t connHandle, uint16_t valueHandle,
+                          int32_t errorCode, void *pParameter)
+{
+    uBleNusInstance_t *pInstance = (uBleNusInstance_t *)pParameter;
+    uBleNusConnection_t *pConnection;
+    bool schedule = false;
+
+    (void)valueHandle;
+    uPortMutexLock(gNusMutex);
+    if (nusInstanceIsValid(pInstance)) {
+        pConnection = pNusConnectionFind(pInstance, connHandle, true);
+        if (pConnection != NULL) {
+            if (pConnection->inFlight > 0) {
+                pConnection->inFlight--;
+            }
+            if ((errorCode < 0) && (pConnection->txErrorCode == 0)) {
+                pConnection->txErrorCode = errorCode;
+            }
+            schedule = nusScheduleRequired(pConnection);
+        }
+    }
+    uPortMutexUnlock(gNusMutex);
+    if (schedule) {
+        nusSchedule(pInstance, connHandle);
+    }
+}
+
+// The NUS task: move data from the transmit buffer of a connection
+// into GATT, packing it into full payloads; a short payload is only
+// sent when nothing is in flight so that data arriving in small
+// pieces accumulates while the module is busy.  gNusMutex is not
+// held while calling GATT since GATT may be processing a URC
+// that needs it.
+static void onNusEvent(void *pParam, size_t paramLength)
+{
+    uBleNusEvent_t *pEvent = (uBleNusEvent_t *)pParam;
+    uBleNusInstance_t *pInstance = pEvent->pInstance;
+    uBleNusConnection_t *pConnection = NULL;
+    uDeviceHandle_t devHandle;
+    bool server;
+    uint16_t valueHandle;
+    size_t length;
+    int32_t errorCode;
+    bool keepGoing = true;
+
+    (void)paramLength;
+    uPortMutexLock(gNusMutex);
+    if (nusInstanceIsValid(pInstance)) {
+        pConnection = pNusConnectionFind(pInstance, pEvent->connHandle, true);
+    }
+    if (pConnection != NULL) {
+        pConnection->scheduled = false;
+        while (keepGoing && (pConnection != NULL) && !pConnection->disconnected &&
+               (pConnection->inFlight < U_BLE_NUS_TX_IN_FLIGHT_MAX)) {
+            keepGoing = false;
+            length = uRingBufferDataSize(&pConnection->txRingBuffer);
+            if ((length >= pConnection->payloadMax) ||
+                ((length > 0) && (pConnection->inFlight == 0))) {
+                if (length > pConnection->payloadMax) {
+                    length = pConnection->payloadMax;
+                }
+                length = uRingBufferPeek(&pConnection->txRingBuffer,
+                                         (char *)gNusPacket, length, 0);
+                devHandle = pInstance->devHandle;
+                server = pInstance->server;
+                valueHandle = server ? pConnection->txHandle : pConnection->rxHandle;
+                pConnection->inFlight++;
+                uPortMutexUnlock(gNusMutex);
+                if (server) {
+                    errorCode = uBleGattWriteNotifyValueQueued(devHandle,
+                                                               pEvent->connHandle,
+                                                               valueHandle,
+                                                               gNusPacket, length,
+                                                               nusTxCallback,
+                                                               pInstance);
+                } else {
+                    errorCode = uBleGattWriteValueQueued(devHandle,
+                                                         pEvent->connHandle,
+                                                         valueHandle,
+                                                         gNusPacket, length,
+                                                         false, nusTxCallback,
+                                                         pInstance);
+                }
+                uPortMutexLock(gNusMutex);
+                // The instance may have been closed meanwhile
+                pConnection = NULL;
+                if (nusInstanceIsValid(pInstance)) {
+                    pConnection = pNusConnectionFind(pInstance, pEvent->connHandle, true);
+                }
+                if (pConnection != NULL) {
+                    if (errorCode == 0) {
+                        uRingBufferRead(&pConnection->txRingBuffer, NULL, length);
+                        keepGoing = true;
+                    } else {
+                        pConnection->inFlight--;
+                        if (errorCode != (int32_t)U_ERROR_COMMON_BUSY) {
+                            // Not going to get any better, throw the data away
+                            if (pConnection->txErrorCode == 0) {
+                                pConnection->txErrorCode = errorCode;
+                            }
+                            uRingBufferRead(&pConnection->txRingBuffer, NULL, length);
+                            keepGoing = true;
+                        }
+                        // If GATT is busy a completion will reschedule us
+                    }
+                }
+            }
+        }
+        if ((pConnection != NULL) && pConnection->disconnected &&
+            (pConnection->inFlight == 0)) {
+            nusConnectionFree(pInstance, pConnection);
+        }
+    }
+    uPortMutexUnlock(gNusMutex);
+}
+
+// GAP connection callback for the handle-based API: a connection
+// goes to a client waiting in uBleNusConnect(), else to the first
+// server instance.
+static void nusConnectCallback(int32_t connHandle, char *pAddress, bool connected)
+{
+    uBleNusInstance_t *pInstance;
+    uBleNusConnection_t *pConnection = NULL;
+    uBleNusConnectCallback_t pCallback = NULL;
+    void *pCallbackParameter = NULL;
+    bool schedule = false;
+
+    (void)pAddress;
+    uPortMutexLock(gNusMutex);
+    pInstance = gpNusInstanceList;
+    if (connected) {
+        while ((pInstance != NULL) &&
+               (!pInstance->connecting || (pInstance->connectState != 0))) {
+            pInstance = pInstance->pNext;
+        }
+        if (pInstance != NULL) {
+            pInstance->connectConnHandle = connHandle;
+            pInstance->connectState = 1;
+            uPortSemaphoreGive(pInstance->connectSemaphore);
+        } else {
+            pInstance = gpNusInstanceList;
+            while ((pInstance != NULL) && (!pInstance->server || pInstance->opening)) {
+                pInstance = pInstance->pNext;
+            }
+            if ((pInstance != NULL) &&
+                (pNusConnectionAdd(pInstance, connHandle) != NULL)) {
+                pCallback = pInstance->pConnectCallback;
+                pCallbackParameter = pInstance->pCallbackParameter;
+            }
+        }
+    } else {
+        while ((pInstance != NULL) && (pConnection == NULL)) {
+            pConnection = pNusConnectionFind(pInstance, connHandle, false);
+            if (pConnection == NULL) {
+                pInstance = pInstance->pNext;
+            }
+        }
+        if (pConnection != NULL) {
+            pConnection->disconnected = true;
+            schedule = nusScheduleRequired(pConnection);
+            pCallback = pInstance->pConnectCallback;
+            pCallbackParameter = pInstance->pCallbackParameter;
+        } else {
+            // May be a connection attempt that failed
+            pInstance = gpNusInstanceList;
+            while ((pInstance != NULL) &&
+                   (!pInstance->connecting || (pInstance->connectState != 0))) {
+                pInstance = pInstance->pNext;
+            }
+            if (pInstance != NULL) {
+                pInstance->connectState = -1;
+                uPortSemaphoreGive(pInstance->connectSemaphore);
+            }
+        }
+    }
+    uPortMutexUnlock(gNusMutex);
+    if (schedule) {
+        // Frees the connection once nothing is in flight
+        nusSchedule(pInstance, connHandle);
+    }
+    if (pCallback != NULL) {
+        pCallback(pInstance, connHandle, connected, pCallbackParameter);
+    }
+}
+
+// Route data received from a peer to the data callback of its
+// connection: the server receives writes to its RX characteristic,
+// the client notifications of the TX characteristic of the peer.
+static void nusReceive(bool server, uint8_t connHandle, uint16_t valueHandle,
+                       uint8_t *pValue, uint8_t valueSize)
+{
+    uBleNusInstance_t *pInstance;
+    uBleNusConnection_t *pConnection = NULL;
+    uBleNusDataCallback_t pCallback = NULL;
+    void *pCallbackParameter = NULL;
+
+    uPortMutexLock(gNusMutex);
+    pInstance = gpNusInstanceList;
+    while ((pInstance != NULL) && (pConnection == NULL)) {
+        if (pInstance->server == server) {
+            pConnection = pNusConnectionFind(pInstance, connHandle, false);
+        }
+        if ((pConnection != NULL) &&
+            (valueHandle == (server ? pConnection->rxHandle : pConnection->txHandle))) {
+            pCallback = pConnection->pDataCallback;
+            pCallbackParameter = pConnection->pDataCallbackParameter;
+        } else {
+            pConnection = NULL;
+            pInstance = pInstance->pNext;
+        }
+    }
+    uPortMutexUnlock(gNusMutex);
+    if (pCallback != NULL) {
+        pCallback(pInstance, connHandle, pValue, valueSize, pCallbackParameter);
+    }
+}
+
+// GATT write callback for the handle-based API (server).
+static void nusWriteCallback(uint8_t connHandle, uint16_t valueHandle,
+                             uint8_t *pValue, uint8_t valueSize)
+{
+    nusReceive(true, connHandle, valueHandle, pValue, valueSize);
+}
+
+// GATT notification callback for the handle-based API (client).
+static void nusNotificationCallback(uint8_t connHandle, uint16_t valueHandle,
+                                    uint8_t *pValue, uint8_t valueSize)
+{
+    nusReceive(false, connHandle, valueHandle, pValue, valueSize);
+}
+
+// GATT characteristic discovery callback for uBleNusConnect().
+static void nusDiscoverCallback(uint8_t connHandle, uint16_t attrHandle,
+                                uint8_t properties, uint16_t valueHandle,
+                                char *pUuid)
+{
+    (void)attrHandle;
+    (void)properties;
+    uPortMutexLock(gNusMutex);
+    if ((gpNusDiscovering != NULL) &&
+        (gpNusDiscovering->connHandle == connHandle)) {
+        if (strncmp(pUuid, NUS_RX_CHAR_UUID, strlen(NUS_RX_CHAR_UUID)) == 0) {
+            gpNusDiscovering->rxHandle = valueHandle;
+        }
+        if (strncmp(pUuid, NUS_TX_CHAR_UUID, strlen(NUS_TX_CHAR_UUID)) == 0) {
+            gpNusDiscovering->txHandle = valueHandle;
+        }
+    }
+    uPortMutexUnlock(gNusMutex);
+}
+
+// Check a NUS handle and find one of its connections, locking
+// gNusMutex: on success the caller must unlock gNusMutex.
+static int32_t nusLockConnection(uBleNusHandle_t nusHandle, int32_t connHandle,
+                                 uBleNusConnection_t **ppConnection)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    uBleNusInstance_t *pInstance = (uBleNusInstance_t *)nusHandle;
+
+    if (gNusMutex != NULL) {
+        uPortMutexLock(gNusMutex);
+        errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+        if (nusInstanceIsValid(pInstance)) {
+            errorCode = (int32_t)U_BLE_ERROR_NOT_FOUND;
+            *ppConnection = pNusConnectionFind(pInstance, connHandle, false);
+            if (*ppConnection != NULL) {
+                errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+            }
+        }
+        if (errorCode != (int32_t)U_ERROR_COMMON_SUCCESS) {
+            uPortMutexUnlock(gNusMutex);
+        }
+    }
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -226,4 +759,434 @@ int32_t uBleNusSetAdvData(uint8_t *pAdvData, uint8_t advDataSize)
     return size + 2;
 }
 
+void uBleNusPrivateInit(void)
+{
+    if (gNusMutex == NULL) {
+        uPortMutexCreate(&gNusMutex);
+    }
+}
+
+void uBleNusPrivateDeinit(void)
+{
+    uBleNusInstance_t *pInstance;
+
+    if (gNusEventQueue != (int32_t)U_ERROR_COMMON_NOT_INITIALISED) {
+        uPortEventQueueClose(gNusEventQueue);
+        gNusEventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    }
+    // Anything left open is freed without talking to the module
+    while (gpNusInstanceList != NULL) {
+        pInstance = gpNusInstanceList;
+        gpNusInstanceList = pInstance->pNext;
+        nusInstanceFree(pInstance);
+    }
+    if (gNusMutex != NULL) {
+        uPortMutexDelete(gNusMutex);
+        gNusMutex = NULL;
+    }
+}
+
+int32_t uBleNusOpen(uDeviceHandle_t devHandle, bool server,
+                    uBleNusConnectCallback_t pConnectCallback,
+                    uBleNusDataCallback_t pDataCallback,
+                    void *pCallbackParameter,
+                    uBleNusHandle_t *pNusHandle)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    uBleNusInstance_t *pInstance = NULL;
+    int32_t eventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gNusMutex != NULL) {
+        errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pNusHandle != NULL) {
+            // The check for an existing instance and the insertion
+            // of the new one are done under the same lock; the new
+            // instance is marked as opening so that nothing else
+            // uses it while GATT is set up, which can't be done
+            // under the lock as GATT callbacks take it
+            uPortMutexLock(gNusMutex);
+            pInstance = gpNusInstanceList;
+            while ((pInstance != NULL) && (pInstance->devHandle != devHandle)) {
+                pInstance = pInstance->pNext;
+            }
+            if (pInstance == NULL) {
+                errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+                if (gNusEventQueue == (int32_t)U_ERROR_COMMON_NOT_INITIALISED) {
+                    gNusEventQueue = uPortEventQueueOpen(onNusEvent, "uBleNus",
+                                                         sizeof(uBleNusEvent_t),
+                                                         U_BLE_NUS_EVENT_STACK_SIZE,
+                                                         U_BLE_NUS_EVENT_PRIORITY,
+                                                         U_BLE_NUS_EVENT_QUEUE_LENGTH);
+                    if (gNusEventQueue < 0) {
+                        errorCode = gNusEventQueue;
+                        gNusEventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+                    }
+                }
+                if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+                    errorCode = (int32_t)U_ERROR_COMMON_NO_MEMORY;
+                    pInstance = (uBleNusInstance_t *)pUPortMalloc(sizeof(uBleNusInstance_t));
+                    if (pInstance != NULL) {
+                        memset(pInstance, 0, sizeof(*pInstance));
+                        pInstance->devHandle = devHandle;
+                        pInstance->server = server;
+                        pInstance->pConnectCallback = pConnectCallback;
+                        pInstance->pDataCallback = pDataCallback;
+                        pInstance->pCallbackParameter = pCallbackParameter;
+                        pInstance->opening = true;
+                        if (server ||
+                            ((uPortSemaphoreCreate(&pInstance->connectSemaphore, 0, 1) == 0) &&
+                             (uPortSemaphoreCreate(&pInstance->closeSemaphore, 0, 1) == 0))) {
+                            pInstance->pNext = gpNusInstanceList;
+                            gpNusInstanceList = pInstance;
+                            errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+                        } else {
+                            nusInstanceFree(pInstance);
+                            pInstance = NULL;
+                        }
+                    }
+                    if ((pInstance == NULL) && (gpNusInstanceList == NULL)) {
+                        // Don't leave an event queue open with nothing to use it
+                        eventQueue = gNusEventQueue;
+                        gNusEventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+                    }
+                }
+            } else {
+                pInstance = NULL;
+            }
+            uPortMutexUnlock(gNusMutex);
+            if (eventQueue >= 0) {
+                uPortEventQueueClose(eventQueue);
+            }
+        }
+    }
+
+    if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+        if (server) {
+            // Define the NUS service and characteristics
+            VALIDATE(uBleGattBeginAddService(devHandle, NUS_SERVICE_UUID));
+            VALIDATE(uBleGattAddCharacteristic(devHandle, NUS_RX_CHAR_UUID, 0x0C,
+                                               &pInstance->rxHandle));
+            VALIDATE(uBleGattAddCharacteristic(devHandle, NUS_TX_CHAR_UUID, 0x10,
+                                               &pInstance->txHandle));
+            VALIDATE(uBleGattEndAddService(devHandle));
+            VALIDATE(uBleGattSetWriteCallback(devHandle, nusWriteCallback));
+        } else {
+            VALIDATE(uBleGattSetNotificationCallback(devHandle, nusNotificationCallback));
+        }
+        VALIDATE(uBleGapSetConnectCallback(devHandle, nusConnectCallback));
+        uPortMutexLock(gNusMutex);
+        if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            pInstance->opening = false;
+            *pNusHandle = (uBleNusHandle_t)pInstance;
+        } else {
+            nusInstanceRemove(pInstance, &eventQueue);
+            nusInstanceFree(pInstance);
+        }
+        uPortMutexUnlock(gNusMutex);
+        if (errorCode != (int32_t)U_ERROR_COMMON_SUCCESS) {
+            if (server) {
+                uBleGattSetWriteCallback(devHandle, NULL);
+            } else {
+                uBleGattSetNotificationCallback(devHandle, NULL);
+            }
+            if (eventQueue >= 0) {
+                uPortEventQueueClose(eventQueue);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+void uBleNusClose(uBleNusHandle_t nusHandle)
+{
+    uBleNusInstance_t *pInstance = (uBleNusInstance_t *)nusHandle;
+    uBleNusConnection_t *pConnection;
+    int32_t eventQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    bool waitForConnect = false;
+    bool found = false;
+
+    if (gNusMutex != NULL) {
+        // Once out of the list nothing else will touch the instance
+        uPortMutexLock(gNusMutex);
+        if (nusInstanceIsValid(pInstance) && !pInstance->closing) {
+            if (pInstance->connecting) {
+                // uBleNusConnect() is using the instance: wake it
+                // up and let it return before removing the instance
+                pInstance->closing = true;
+                uPortSemaphoreGive(pInstance->connectSemaphore);
+                waitForConnect = true;
+            } else {
+                found = nusInstanceRemove(pInstance, &eventQueue);
+            }
+        }
+        uPortMutexUnlock(gNusMutex);
+
+        if (waitForConnect) {
+            // Nothing else frees the instance while closing is set
+            uPortSemaphoreTake(pInstance->closeSemaphore);
+            uPortMutexLock(gNusMutex);
+            found = nusInstanceRemove(pInstance, &eventQueue);
+            uPortMutexUnlock(gNusMutex);
+        }
+
+        if (found) {
+            uBleGapSetConnectCallback(pInstance->devHandle, NULL);
+            if (pInstance->server) {
+                uBleGattSetWriteCallback(pInstance->devHandle, NULL);
+            } else {
+                uBleGattSetNotificationCallback(pInstance->devHandle, NULL);
+            }
+            for (pConnection = pInstance->pConnectionList; pConnection != NULL;
+                 pConnection = pConnection->pNext) {
+                if (!pConnection->disconnected) {
+                    uBleGapDisconnect(pInstance->devHandle, pConnection->connHandle);
+                }
+                // Make sure that GATT is done with the instance
+                uBleGattQueueFlush(pInstance->devHandle, pConnection->connHandle,
+                                   U_BLE_NUS_CLOSE_FLUSH_TIMEOUT_MS);
+            }
+            uPortMutexLock(gNusMutex);
+            nusInstanceFree(pInstance);
+            uPortMutexUnlock(gNusMutex);
+            if (eventQueue >= 0) {
+                // Not under the mutex as the NUS task may be waiting for it
+                uPortEventQueueClose(eventQueue);
+            }
+        }
+    }
+}
+
+int32_t uBleNusConnect(uBleNusHandle_t nusHandle, const char *pAddress,
+                       int32_t *pConnHandle)
+{
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
+    uBleNusInstance_t *pInstance = (uBleNusInstance_t *)nusHandle;
+    uBleNusConnection_t *pConnection = NULL;
+    uBleNusConnectCallback_t pCallback = NULL;
+    void *pCallbackParameter = NULL;
+    uPortSemaphoreHandle_t connectSemaphore = NULL;
+    uDeviceHandle_t devHandle = NULL;
+    uint16_t txHandle = 0;
+    int32_t connHandle = -1;
+    int32_t connectState = 0;
+    int32_t startTimeMs;
+    int32_t waitMs = U_BLE_NUS_CONNECT_TIMEOUT_MS;
+
+    if (gNusMutex != NULL) {
+        errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+        uPortMutexLock(gNusMutex);
+        if (nusInstanceIsValid(pInstance) && !pInstance->server &&
+            (pAddress != NULL) && (pConnHandle != NULL)) {
+            errorCode = (int32_t)U_ERROR_COMMON_BUSY;
+            if (!pInstance->connecting && !pInstance->closing) {
+                // While connecting is set uBleNusClose() will not
+                // free the instance, it waits for us to return
+                devHandle = pInstance->devHandle;
+                connectSemaphore = pInstance->connectSemaphore;
+                pInstance->connecting = true;
+                pInstance->connectState = 0;
+                // Lose any give left over from an earlier attempt
+                uPortSemaphoreTryTake(connectSemaphore, 0);
+                errorCode = (int32_t)U_ERROR_COMMON_SUCCESS;
+            }
+        }
+        uPortMutexUnlock(gNusMutex);
+    }
+
+    if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+        errorCode = uBleGapConnect(devHandle, pAddress);
+        if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            // Wait for nusConnectCallback(), or uBleNusClose(),
+            // to give the semaphore
+            startTimeMs = uPortGetTickTimeMs();
+            while ((connectState == 0) && (waitMs > 0)) {
+                uPortSemaphoreTryTake(connectSemaphore, waitMs);
+                connectState = -1;
+                uPortMutexLock(gNusMutex);
+                if (nusInstanceIsValid(pInstance)) {
+                    if (pInstance->connectState == 1) {
+                        // Keep this even if closing, to disconnect it
+                        connHandle = pInstance->connectConnHandle;
+                    }
+                    if (!pInstance->closing) {
+                        connectState = pInstance->connectState;
+                    }
+                }
+                uPortMutexUnlock(gNusMutex);
+                waitMs = U_BLE_NUS_CONNECT_TIMEOUT_MS - (uPortGetTickTimeMs() - startTimeMs);
+            }
+            errorCode = (int32_t)U_BLE_ERROR_NOT_FOUND;
+            if (connectState == 1) {
+                errorCode = (int32_t)U_ERROR_COMMON_NO_MEMORY;
+                uPortMutexLock(gNusMutex);
+                if (nusInstanceIsValid(pInstance) && !pInstance->closing) {
+                    pConnection = pNusConnectionAdd(pInstance, connHandle);
+                    gpNusDiscovering = pConnection;
+                }
+                uPortMutexUnlock(gNusMutex);
+            }
+            if (pConnection != NULL) {
+                uBleGattDiscoverChar(devHandle, connHandle, nusDiscoverCallback);
+                errorCode = (int32_t)U_BLE_ERROR_NOT_FOUND;
+                uPortMutexLock(gNusMutex);
+                gpNusDiscovering = NULL;
+                // The peer may have disconnected, or the instance
+                // be closing, meanwhile
+                pConnection = NULL;
+                if (nusInstanceIsValid(pInstance) && !pInstance->closing) {
+                    pConnection = pNusConnectionFind(pInstance, connHandle, false);
+                }
+                if ((pConnection != NULL) &&
+                    (pConnection->rxHandle != 0) && (pConnection->txHandle != 0)) {
+                    txHandle = pConnection->txHandle;
+                }
+                uPortMutexUnlock(gNusMutex);
+                if (txHandle != 0) {
+                    errorCode = uBleGattEnableNotification(devHandle, connHandle,
+                                                           txHandle);
+                }
+            }
+            if ((errorCode != (int32_t)U_ERROR_COMMON_SUCCESS) && (connHandle >= 0)) {
+                // The disconnect event will free the connection
+                uBleGapDisconnect(devHandle, connHandle);
+            }
+        }
+        uPortMutexLock(gNusMutex);
+        pInstance->connecting = false;
+        if (pInstance->closing) {
+            // uBleNusClose() disconnects anything we have connected
+            errorCode = (int32_t)U_ERROR_COMMON_CANCELLED;
+            // Given under the lock, which uBleNusClose() takes
+            // before it frees the instance
+            uPortSemaphoreGive(pInstance->closeSemaphore);
+        } else if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            pCallback = pInstance->pConnectCallback;
+            pCallbackParameter = pInstance->pCallbackParameter;
+        }
+        uPortMutexUnlock(gNusMutex);
+        if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            *pConnHandle = connHandle;
+            if (pCallback != NULL) {
+                pCallback(pInstance, connHandle, true, pCallbackParameter);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+int32_t uBleNusDisconnect(uBleNusHandle_t nusHandle, int32_t connHandle)
+{
+    uBleNusConnection_t *pConnection;
+    uDeviceHandle_t devHandle;
+    int32_t errorCode = nusLockConnection(nusHandle, connHandle, &pConnection);
+
+    if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+        devHandle = ((uBleNusInstance_t *)nusHandle)->devHandle;
+        uPortMutexUnlock(gNusMutex);
+        // The disconnect event will free the connection
+        errorCode = uBleGapDisconnect(devHandle, connHandle);
+    }
+
+    return errorCode;
+}
+
+int32_t uBleNusDataCallbackSet(uBleNusHandle_t nusHandle, int32_t connHandle,
+                               uBleNusDataCallback_t pDataCallback,
+                               void *pCallbackParameter)
+{
+    uBleNusConnection_t *pConnection;
+    int32_t errorCode = nusLockConnection(nusHandle, connHandle, &pConnection);
+
+    if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+        pConnection->pDataCallback = pDataCallback;
+        pConnection->pDataCallbackParameter = pCallbackParameter;
+        uPortMutexUnlock(gNusMutex);
+    }
+
+    return errorCode;
+}
+
+int32_t uBleNusMtuSet(uBleNusHandle_t nusHandle, int32_t connHandle,
+                      size_t mtu)
+{
+    uBleNusConnection_t *pConnection;
+    int32_t errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (mtu >= U_BLE_NUS_MTU_DEFAULT) {
+        errorCode = nusLockConnection(nusHandle, connHandle, &pConnection);
+        if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            // Three bytes of ATT header
+            pConnection->payloadMax = mtu - 3;
+            if (pConnection->payloadMax > U_BLE_GATT_VALUE_MAX_LENGTH_BYTES) {
+                pConnection->payloadMax = U_BLE_GATT_VALUE_MAX_LENGTH_BYTES;
+            }
+            uPortMutexUnlock(gNusMutex);
+        }
+    }
+
+    return errorCode;
+}
+
+int32_t uBleNusSend(uBleNusHandle_t nusHandle, int32_t connHandle,
+                    const void *pData, size_t length)
+{
+    uBleNusConnection_t *pConnection;
+    int32_t errorCodeOrLength = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t room;
+    bool schedule = false;
+
+    if ((pData != NULL) || (length == 0)) {
+        errorCodeOrLength = nusLockConnection(nusHandle, connHandle, &pConnection);
+        if (errorCodeOrLength == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            room = uRingBufferAvailableSize(&pConnection->txRingBuffer);
+            if (length > room) {
+                length = room;
+            }
+            if ((length > 0) &&
+                uRingBufferAdd(&pConnection->txRingBuffer, (const char *)pData, length)) {
+                errorCodeOrLength = (int32_t)length;
+                schedule = nusScheduleRequired(pConnection);
+            }
+            uPortMutexUnlock(gNusMutex);
+            if (schedule) {
+                nusSchedule((uBleNusInstance_t *)nusHandle, connHandle);
+            }
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+int32_t uBleNusFlush(uBleNusHandle_t nusHandle, int32_t connHandle,
+                     int32_t timeoutMs)
+{
+    uBleNusConnection_t *pConnection;
+    int32_t errorCode;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+    bool done = false;
+
+    do {
+        errorCode = nusLockConnection(nusHandle, connHandle, &pConnection);
+        if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            done = (uRingBufferDataSize(&pConnection->txRingBuffer) == 0) &&
+                   (pConnection->inFlight == 0);
+            if (done) {
+                // Report, and clear, any error that occurred on the way
+                errorCode = pConnection->txErrorCode;
+                pConnection->txErrorCode = 0;
+            } else if (uPortGetTickTimeMs() - startTimeMs >= timeoutMs) {
+                errorCode = (int32_t)U_ERROR_COMMON_TIMEOUT;
+            }
+            uPortMutexUnlock(gNusMutex);
+            if (!done && (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS)) {
+                uPortTaskBlock(10);
+            }
+        }
+    } while (!done && (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS));
+
+    return errorCode;
+}
+
 #endif
\ No newline at end of file
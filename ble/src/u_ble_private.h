@@ -52,6 +52,24 @@ void uBleSpsPrivateInit(void);
  */
 void uBleSpsPrivateDeinit(void);
 
+/** Initialize the GATT operation queues of BLE
+ */
+void uBleGattPrivateInit(void);
+
+/** De-Initialize the GATT operation queues of BLE; anything
+ * still queued is dropped
+ */
+void uBleGattPrivateDeinit(void);
+
+/** Initialize the handle-based NUS API of BLE
+ */
+void uBleNusPrivateInit(void);
+
+/** De-Initialize the handle-based NUS API of BLE; anything still
+ * open is freed without talking to the module
+ */
+void uBleNusPrivateDeinit(void);
+
 /** Translate MAC address in byte array to string
  *
  * @param[in] pAddrIn   pointer to byte array
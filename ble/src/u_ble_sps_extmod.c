@@ -48,6 +48,7 @@
 #include "u_at_client.h"
 #include "u_ble_sps.h"
 #include "u_ble_private.h"
+#include "u_ble_extmod_private.h"
 #include "u_short_range_module_type.h"
 #include "u_short_range_pbuf.h"
 #include "u_short_range.h"
@@ -171,8 +172,8 @@ static void UUBTACLD_urc(uAtClientHandle_t atHandle,
 {
     (void)pParameter;
     // We only need to read out to clean up for the at client, all data we need
-    // will arrive in later events.
-    (void)uAtClientReadInt(atHandle); // Connection handle
+    // will arrive in later events, but the GATT operation queues need to know
+    uBleGattPrivateDisconnected(atHandle, uAtClientReadInt(atHandle));
 }
 
 // Allocate and add SPS channel info to linked list
@@ -0,0 +1,608 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the queued GATT operations of the ble API: these
+ * should pass on all platforms that have two UARTs connected
+ * back to back, no short range module is required; instead a
+ * simulated module, which speaks EDM, is run on UART B.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), memchr(), strstr()
+#include "stdlib.h"    // atoi()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_at_client.h"
+
+#include "u_device.h"
+#include "u_short_range_module_type.h"
+#include "u_short_range.h"
+#include "u_ble_module_type.h"
+#include "u_ble.h"
+#include "u_ble_gatt.h"
+
+#include "u_short_range_test_private.h"
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && \
+    !defined(U_CFG_BLE_MODULE_INTERNAL) && !defined(U_UCONNECT_GEN2)
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_BLE_GATT_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_BLE_GATT_TEST_SIM_ERROR_VALUE_HANDLE
+/** A value handle which the simulated module responds to
+ * with "ERROR".
+ */
+# define U_BLE_GATT_TEST_SIM_ERROR_VALUE_HANDLE 99
+#endif
+
+#ifndef U_BLE_GATT_TEST_VALUE_HANDLE
+/** The value handle to notify/write.
+ */
+# define U_BLE_GATT_TEST_VALUE_HANDLE 32
+#endif
+
+#ifndef U_BLE_GATT_TEST_CONN_HANDLE
+/** The connection handle to use.
+ */
+# define U_BLE_GATT_TEST_CONN_HANDLE 0
+#endif
+
+#ifndef U_BLE_GATT_TEST_NUM_OPERATIONS
+/** The number of notifications sent for each measurement.
+ */
+# define U_BLE_GATT_TEST_NUM_OPERATIONS 50
+#endif
+
+#ifndef U_BLE_GATT_TEST_FLUSH_TIMEOUT_MS
+/** How long to wait for a queue to empty.
+ */
+# define U_BLE_GATT_TEST_FLUSH_TIMEOUT_MS 30000
+#endif
+
+#ifndef U_BLE_GATT_TEST_WINDOW
+/** The pipelining window to compare with the default.
+ */
+# define U_BLE_GATT_TEST_WINDOW 4
+#endif
+
+#ifndef U_BLE_GATT_TEST_READ_LENGTH
+/** The length of the value that the simulated module returns
+ * when read.
+ */
+# define U_BLE_GATT_TEST_READ_LENGTH 100
+#endif
+
+#ifndef U_BLE_GATT_TEST_HOLD_MS
+/** How long the simulated module stops reading from the UART
+ * for when testing that a full queue is reported; must be
+ * well within the AT timeout of the module.
+ */
+# define U_BLE_GATT_TEST_HOLD_MS 500
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** What the simulated module has seen.
+ */
+typedef struct {
+    volatile size_t numNotify;     /**< number of AT+UBTGSN received. */
+    volatile size_t numWrite;      /**< number of AT+UBTGW received. */
+    volatile size_t numWriteNoRsp; /**< number of AT+UBTGWN received. */
+    volatile size_t numRead;       /**< number of AT+UBTGR received. */
+    volatile size_t numBytes;      /**< value bytes received. */
+    volatile size_t numBadValues;  /**< values that were not as expected. */
+} uBleGattTestSimCount_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The simulated module.
+ */
+static uShortRangeTestPrivateSim_t *gpSim = NULL;
+
+/** What the simulated module has seen.
+ */
+static uBleGattTestSimCount_t gSimCount = {0};
+
+/** Handle of the short range device.
+ */
+static uDeviceHandle_t gDevHandle = NULL;
+
+/** The value that is notified/written: byte n is n.
+ */
+static uint8_t gValue[U_BLE_GATT_VALUE_MAX_LENGTH_BYTES];
+
+/** The number of queued operations that have completed.
+ */
+static volatile size_t gNumCompleted = 0;
+
+/** The number of queued operations that completed out of order.
+ */
+static volatile size_t gNumOutOfOrder = 0;
+
+/** The number of queued operations that completed with an error.
+ */
+static volatile size_t gNumErrors = 0;
+
+/** The index of the queued operation that completed with an error.
+ */
+static volatile size_t gErrorIndex = 0;
+
+/** The number of queued reads that returned the expected value.
+ */
+static volatile size_t gNumReadGood = 0;
+
+/** Buffer for the response of the simulated module to a read.
+ */
+static char gReadResponse[(U_BLE_GATT_TEST_READ_LENGTH * 2) + 32];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Check that a hex-encoded value is the start of gValue.
+static bool simValueGood(const char *pHex, size_t *pLength)
+{
+    bool good = true;
+    size_t length = 0;
+    char byteStr[3] = {0};
+
+    while ((pHex[0] != 0) && (pHex[1] != 0) && good) {
+        byteStr[0] = pHex[0];
+        byteStr[1] = pHex[1];
+        good = (length < sizeof(gValue)) &&
+               ((uint8_t) strtol(byteStr, NULL, 16) == gValue[length]);
+        length++;
+        pHex += 2;
+    }
+    *pLength = length;
+
+    return good && (pHex[0] == 0);
+}
+
+// Handle an AT command received by the simulated module.
+static const char *simCommand(const char *pCommand, void *pParameter)
+{
+    uBleGattTestSimCount_t *pCount = (uBleGattTestSimCount_t *) pParameter;
+    const char *pResponse = NULL;
+    const char *pParams;
+    const char *pHex;
+    size_t length = 0;
+    int32_t valueHandle = -1;
+
+    pParams = strchr(pCommand, '=');
+    if (pParams != NULL) {
+        pParams++;
+        // Parameters are connection handle, value handle, hex value
+        pHex = strchr(pParams, ',');
+        if (pHex != NULL) {
+            valueHandle = atoi(pHex + 1);
+            pHex = strchr(pHex + 1, ',');
+        }
+        if ((strstr(pCommand, "AT+UBTGSN=") != NULL) ||
+            (strstr(pCommand, "AT+UBTGW") != NULL)) {
+            if ((pHex == NULL) || !simValueGood(pHex + 1, &length)) {
+                pCount->numBadValues++;
+            }
+            pCount->numBytes += length;
+            if (strstr(pCommand, "AT+UBTGSN=") != NULL) {
+                pCount->numNotify++;
+            } else if (strstr(pCommand, "AT+UBTGWN=") != NULL) {
+                pCount->numWriteNoRsp++;
+            } else {
+                pCount->numWrite++;
+            }
+            if (valueHandle == U_BLE_GATT_TEST_SIM_ERROR_VALUE_HANDLE) {
+                pResponse = "\r\nERROR\r\n";
+            }
+        } else if (strstr(pCommand, "AT+UBTGR=") != NULL) {
+            pCount->numRead++;
+            if (valueHandle == U_BLE_GATT_TEST_SIM_ERROR_VALUE_HANDLE) {
+                pResponse = "\r\nERROR\r\n";
+            } else {
+                // Respond with the start of gValue
+                length = snprintf(gReadResponse, sizeof(gReadResponse),
+                                  "\r\n+UBTGR:%d,%d,", atoi(pParams), (int) valueHandle);
+                for (size_t x = 0; x < U_BLE_GATT_TEST_READ_LENGTH; x++) {
+                    length += snprintf(gReadResponse + length, sizeof(gReadResponse) - length,
+                                       "%02X", gValue[x]);
+                }
+                snprintf(gReadResponse + length, sizeof(gReadResponse) - length,
+                         "\r\nOK\r\n");
+                pResponse = gReadResponse;
+            }
+        }
+    }
+
+    return pResponse;
+}
+
+// Callback for queued operations: pParameter is the index
+// of the operation, which should complete in order.
+static void queueCallback(int32_t connHandle, uint16_t valueHandle,
+                          int32_t errorCode, void *pParameter)
+{
+    (void) connHandle;
+    (void) valueHandle;
+
+    if ((size_t) pParameter != gNumCompleted) {
+        gNumOutOfOrder++;
+    }
+    if (errorCode != 0) {
+        gNumErrors++;
+        gErrorIndex = (size_t) pParameter;
+    }
+    gNumCompleted++;
+}
+
+// Callback for queued reads: as queueCallback() but also
+// checks the value.
+static void queueReadCallback(int32_t connHandle, uint16_t valueHandle,
+                              const uint8_t *pValue, int32_t errorCodeOrLength,
+                              void *pParameter)
+{
+    if ((errorCodeOrLength == U_BLE_GATT_TEST_READ_LENGTH) &&
+        (memcmp(pValue, gValue, U_BLE_GATT_TEST_READ_LENGTH) == 0)) {
+        gNumReadGood++;
+    }
+    queueCallback(connHandle, valueHandle,
+                  (errorCodeOrLength < 0) ? errorCodeOrLength : 0, pParameter);
+}
+
+// Send U_BLE_GATT_TEST_NUM_OPERATIONS notifications of the
+// given length, queued if window is non-zero, returning the
+// time taken in milliseconds.
+static int32_t timeNotifications(size_t length, size_t window)
+{
+    int32_t startTimeMs;
+    int32_t x;
+
+    gNumCompleted = 0;
+    gNumOutOfOrder = 0;
+    gNumErrors = 0;
+    if (window > 0) {
+        U_PORT_TEST_ASSERT(uBleGattQueueWindowSet(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                                  window) == 0);
+    }
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t y = 0; y < U_BLE_GATT_TEST_NUM_OPERATIONS; y++) {
+        if (window > 0) {
+            do {
+                x = uBleGattWriteNotifyValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                                   U_BLE_GATT_TEST_VALUE_HANDLE,
+                                                   gValue, length, queueCallback,
+                                                   (void *) y);
+                if (x == (int32_t) U_ERROR_COMMON_BUSY) {
+                    uPortTaskBlock(1);
+                }
+            } while (x == (int32_t) U_ERROR_COMMON_BUSY);
+        } else {
+            x = uBleGattWriteNotifyValue(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                         U_BLE_GATT_TEST_VALUE_HANDLE,
+                                         gValue, (uint8_t) length);
+        }
+        U_PORT_TEST_ASSERT(x == 0);
+    }
+    if (window > 0) {
+        U_PORT_TEST_ASSERT(uBleGattQueueFlush(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                              U_BLE_GATT_TEST_FLUSH_TIMEOUT_MS) == 0);
+        U_PORT_TEST_ASSERT(gNumCompleted == U_BLE_GATT_TEST_NUM_OPERATIONS);
+        U_PORT_TEST_ASSERT(gNumOutOfOrder == 0);
+        U_PORT_TEST_ASSERT(gNumErrors == 0);
+    }
+
+    return uPortGetTickTimeMs() - startTimeMs;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test queued GATT operations against a simulated module,
+ * measuring the notification rate for a range of value sizes
+ * with the blocking API, with the queued API at the default
+ * window, where each command waits for its response, and with
+ * the queued API and pipelining switched on.
+ */
+U_PORT_TEST_FUNCTION("[bleGatt]", "bleGattQueue")
+{
+    int32_t resourceCount;
+    uShortRangeUartConfig_t uart = {.uartPort = U_CFG_TEST_UART_A,
+                                    .baudRate = U_CFG_TEST_BAUD_RATE,
+                                    .pinTx = U_CFG_TEST_PIN_UART_A_TXD,
+                                    .pinRx = U_CFG_TEST_PIN_UART_A_RXD,
+                                    .pinCts = U_CFG_TEST_PIN_UART_A_CTS,
+                                    .pinRts = U_CFG_TEST_PIN_UART_A_RTS,
+#ifdef U_CFG_TEST_UART_PREFIX
+                                    .pPrefix = U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)
+#else
+                                    .pPrefix = NULL
+#endif
+                                   };
+    const size_t lengths[] = {20, 100, U_BLE_GATT_VALUE_MAX_LENGTH_BYTES};
+    int32_t timeBlockingMs;
+    int32_t timeDefaultMs;
+    int32_t timeWindowMs;
+    size_t numNotify;
+    char urc[32];
+    size_t x;
+    int32_t y;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    for (x = 0; x < sizeof(gValue); x++) {
+        gValue[x] = (uint8_t) x;
+    }
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    memset(&gSimCount, 0, sizeof(gSimCount));
+    gpSim = pUShortRangeTestPrivateSimStart(simCommand, &gSimCount);
+    U_PORT_TEST_ASSERT(gpSim != NULL);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uBleInit() == 0);
+    U_TEST_PRINT_LINE("opening a simulated NINA-B3...");
+    U_PORT_TEST_ASSERT(uShortRangeOpenUart(U_SHORT_RANGE_MODULE_TYPE_NINA_B3, &uart,
+                                           false, &gDevHandle) == 0);
+
+    // Parameter checking
+    U_PORT_TEST_ASSERT(uBleGattQueueWindowSet(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE, 0) < 0);
+    U_PORT_TEST_ASSERT(uBleGattQueueWindowSet(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                              U_BLE_GATT_QUEUE_MAX_LENGTH + 1) < 0);
+    U_PORT_TEST_ASSERT(uBleGattWriteNotifyValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                                      U_BLE_GATT_TEST_VALUE_HANDLE, gValue,
+                                                      sizeof(gValue) + 1, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uBleGattWriteNotifyValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                                      U_BLE_GATT_TEST_VALUE_HANDLE, NULL,
+                                                      1, NULL, NULL) < 0);
+
+    // Measure the notification rate; unless pipelining is
+    // switched on the host must never send a command before
+    // the module has responded to the one before
+    for (x = 0; x < sizeof(lengths) / sizeof(lengths[0]); x++) {
+        numNotify = gSimCount.numNotify;
+        timeBlockingMs = timeNotifications(lengths[x], 0);
+        timeDefaultMs = timeNotifications(lengths[x], U_BLE_GATT_QUEUE_WINDOW_DEFAULT);
+        U_PORT_TEST_ASSERT(gpSim->numCommandsAhead == 0);
+        timeWindowMs = timeNotifications(lengths[x], U_BLE_GATT_TEST_WINDOW);
+        U_TEST_PRINT_LINE("%d byte notifications/second: blocking %d, queued %d,"
+                          " queued with window %d %d.", lengths[x],
+                          (U_BLE_GATT_TEST_NUM_OPERATIONS * 1000) / (timeBlockingMs + 1),
+                          (U_BLE_GATT_TEST_NUM_OPERATIONS * 1000) / (timeDefaultMs + 1),
+                          U_BLE_GATT_TEST_WINDOW,
+                          (U_BLE_GATT_TEST_NUM_OPERATIONS * 1000) / (timeWindowMs + 1));
+        U_TEST_PRINT_LINE("%d command(s) were sent ahead of a response.",
+                          (int) gpSim->numCommandsAhead);
+        gpSim->numCommandsAhead = 0;
+        U_PORT_TEST_ASSERT(gSimCount.numNotify - numNotify == U_BLE_GATT_TEST_NUM_OPERATIONS * 3);
+        U_PORT_TEST_ASSERT(gSimCount.numBadValues == 0);
+    }
+
+    // Reads are queued in order with everything else, with the
+    // default window
+    U_TEST_PRINT_LINE("checking queued reads...");
+    gNumCompleted = 0;
+    gNumOutOfOrder = 0;
+    gNumErrors = 0;
+    gNumReadGood = 0;
+    U_PORT_TEST_ASSERT(uBleGattQueueWindowSet(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                              U_BLE_GATT_QUEUE_WINDOW_DEFAULT) == 0);
+    U_PORT_TEST_ASSERT(uBleGattReadValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                               U_BLE_GATT_TEST_VALUE_HANDLE,
+                                               NULL, NULL) < 0);
+    for (x = 0; x < 5; x++) {
+        if (x == 3) {
+            y = uBleGattReadValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                        U_BLE_GATT_TEST_SIM_ERROR_VALUE_HANDLE,
+                                        queueReadCallback, (void *) x);
+        } else if ((x & 1) == 0) {
+            y = uBleGattReadValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                        U_BLE_GATT_TEST_VALUE_HANDLE,
+                                        queueReadCallback, (void *) x);
+        } else {
+            y = uBleGattWriteNotifyValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                               U_BLE_GATT_TEST_VALUE_HANDLE,
+                                               gValue, 8, queueCallback, (void *) x);
+        }
+        U_PORT_TEST_ASSERT(y == 0);
+    }
+    U_PORT_TEST_ASSERT(uBleGattQueueFlush(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                          U_BLE_GATT_TEST_FLUSH_TIMEOUT_MS) == 0);
+    U_PORT_TEST_ASSERT(gNumCompleted == 5);
+    U_PORT_TEST_ASSERT(gNumOutOfOrder == 0);
+    U_PORT_TEST_ASSERT(gNumReadGood == 3);
+    U_PORT_TEST_ASSERT(gNumErrors == 1);
+    U_PORT_TEST_ASSERT(gErrorIndex == 3);
+    U_PORT_TEST_ASSERT(gSimCount.numRead == 4);
+    U_PORT_TEST_ASSERT(gpSim->numCommandsAhead == 0);
+
+    // A write with response is a barrier between pipelined
+    // operations and a rejected operation fails on its own
+    U_TEST_PRINT_LINE("checking ordering and errors...");
+    gNumCompleted = 0;
+    gNumOutOfOrder = 0;
+    gNumErrors = 0;
+    U_PORT_TEST_ASSERT(uBleGattQueueWindowSet(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                              U_BLE_GATT_TEST_WINDOW) == 0);
+    for (x = 0; x < 7; x++) {
+        if (x == 3) {
+            y = uBleGattWriteValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                         U_BLE_GATT_TEST_VALUE_HANDLE, gValue, 8,
+                                         true, queueCallback, (void *) x);
+        } else if (x == 5) {
+            y = uBleGattWriteNotifyValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                               U_BLE_GATT_TEST_SIM_ERROR_VALUE_HANDLE,
+                                               gValue, 8, queueCallback, (void *) x);
+        } else {
+            y = uBleGattWriteValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                         U_BLE_GATT_TEST_VALUE_HANDLE, gValue, 8,
+                                         false, queueCallback, (void *) x);
+        }
+        U_PORT_TEST_ASSERT(y == 0);
+    }
+    U_PORT_TEST_ASSERT(uBleGattQueueFlush(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                          U_BLE_GATT_TEST_FLUSH_TIMEOUT_MS) == 0);
+    U_PORT_TEST_ASSERT(gNumCompleted == 7);
+    U_PORT_TEST_ASSERT(gNumOutOfOrder == 0);
+    U_PORT_TEST_ASSERT(gNumErrors == 1);
+    U_PORT_TEST_ASSERT(gErrorIndex == 5);
+    U_PORT_TEST_ASSERT(gSimCount.numWrite == 1);
+    U_PORT_TEST_ASSERT(gSimCount.numWriteNoRsp == 5);
+    U_PORT_TEST_ASSERT(gSimCount.numBadValues == 0);
+
+    // Stop the simulated module reading so that the queue fills up
+    U_TEST_PRINT_LINE("checking that a full queue is reported...");
+    gNumCompleted = 0;
+    gpSim->hold = true;
+    y = 0;
+    for (x = 0; (x < U_BLE_GATT_QUEUE_MAX_LENGTH * 2) && (y == 0); x++) {
+        y = uBleGattWriteNotifyValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                           U_BLE_GATT_TEST_VALUE_HANDLE, gValue, 8,
+                                           queueCallback, (void *) x);
+    }
+    U_PORT_TEST_ASSERT(y == (int32_t) U_ERROR_COMMON_BUSY);
+    U_PORT_TEST_ASSERT(x == U_BLE_GATT_QUEUE_MAX_LENGTH + 1);
+    U_PORT_TEST_ASSERT(uBleGattQueueFlush(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                          0) == (int32_t) U_ERROR_COMMON_TIMEOUT);
+    uPortTaskBlock(U_BLE_GATT_TEST_HOLD_MS);
+    gpSim->hold = false;
+    U_PORT_TEST_ASSERT(uBleGattQueueFlush(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                          U_BLE_GATT_TEST_FLUSH_TIMEOUT_MS) == 0);
+    U_PORT_TEST_ASSERT(gNumCompleted == U_BLE_GATT_QUEUE_MAX_LENGTH);
+    U_PORT_TEST_ASSERT(gNumOutOfOrder == 0);
+
+    // A disconnect empties the queue of the connection, without
+    // waiting for the module: what had not been sent is called
+    // back with an error and the window goes back to the default
+    U_TEST_PRINT_LINE("checking that a disconnect empties the queue...");
+    gNumCompleted = 0;
+    gNumOutOfOrder = 0;
+    gNumErrors = 0;
+    gpSim->hold = true;
+    for (x = 0; x < U_BLE_GATT_QUEUE_MAX_LENGTH; x++) {
+        U_PORT_TEST_ASSERT(uBleGattWriteNotifyValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                                          U_BLE_GATT_TEST_VALUE_HANDLE, gValue, 8,
+                                                          queueCallback, (void *) x) == 0);
+    }
+    snprintf(urc, sizeof(urc), "+UUBTACLD:%d", U_BLE_GATT_TEST_CONN_HANDLE);
+    uShortRangeTestPrivateSimSendEvent(gpSim, urc);
+    U_PORT_TEST_ASSERT(uBleGattQueueFlush(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                          U_BLE_GATT_TEST_HOLD_MS) == 0);
+    gpSim->hold = false;
+    for (y = 0; (gNumCompleted < U_BLE_GATT_QUEUE_MAX_LENGTH) &&
+         (y < U_BLE_GATT_TEST_FLUSH_TIMEOUT_MS); y += 10) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gNumCompleted == U_BLE_GATT_QUEUE_MAX_LENGTH);
+    U_PORT_TEST_ASSERT(gNumOutOfOrder == 0);
+    U_PORT_TEST_ASSERT(gNumErrors > 0);
+    U_PORT_TEST_ASSERT(gErrorIndex == U_BLE_GATT_QUEUE_MAX_LENGTH - 1);
+    gpSim->numCommandsAhead = 0;
+    gNumCompleted = 0;
+    for (x = 0; x < U_BLE_GATT_TEST_WINDOW * 2; x++) {
+        U_PORT_TEST_ASSERT(uBleGattWriteNotifyValueQueued(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                                          U_BLE_GATT_TEST_VALUE_HANDLE, gValue, 8,
+                                                          queueCallback, (void *) x) == 0);
+    }
+    U_PORT_TEST_ASSERT(uBleGattQueueFlush(gDevHandle, U_BLE_GATT_TEST_CONN_HANDLE,
+                                          U_BLE_GATT_TEST_FLUSH_TIMEOUT_MS) == 0);
+    U_PORT_TEST_ASSERT(gNumCompleted == U_BLE_GATT_TEST_WINDOW * 2);
+    U_PORT_TEST_ASSERT(gpSim->numCommandsAhead == 0);
+
+    uShortRangeClose(gDevHandle);
+    gDevHandle = NULL;
+    uBleDeinit();
+    uAtClientDeinit();
+
+    uShortRangeTestPrivateSimStop(gpSim);
+    gpSim = NULL;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[bleGatt]", "bleGattCleanUp")
+{
+    if (gDevHandle != NULL) {
+        uShortRangeClose(gDevHandle);
+        gDevHandle = NULL;
+    }
+    uBleDeinit();
+    uAtClientDeinit();
+    uShortRangeTestPrivateSimStop(gpSim);
+    gpSim = NULL;
+    uPortDeinit();
+}
+
+#endif // #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && ...
+
+// End of file
@@ -0,0 +1,744 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the handle-based, multi-connection, NUS API: these
+ * should pass on all platforms that have two UARTs connected back to
+ * back, no short range module is required; instead a simulated
+ * module, which speaks EDM and pretends to have several NUS clients
+ * connected to it, is run on UART B.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), strchr(), strstr()
+#include "stdlib.h"    // atoi(), strtol()
+#include "stdio.h"     // snprintf()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_event_queue.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_at_client.h"
+
+#include "u_device.h"
+#include "u_network.h"
+#include "u_network_config_ble.h"
+#include "u_short_range_module_type.h"
+#include "u_short_range.h"
+#include "u_ble_module_type.h"
+#include "u_ble.h"
+#include "u_ble_cfg.h"
+#include "u_ble_gatt.h"
+#include "u_ble_nus.h"
+
+#include "u_short_range_test_private.h"
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && \
+    !defined(U_CFG_BLE_MODULE_INTERNAL) && !defined(U_UCONNECT_GEN2)
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_BLE_NUS_MULTI_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_BLE_NUS_MULTI_TEST_NUM_PEERS
+/** The number of NUS clients the simulated module has connected.
+ */
+# define U_BLE_NUS_MULTI_TEST_NUM_PEERS 8
+#endif
+
+#ifndef U_BLE_NUS_MULTI_TEST_LENGTH_BYTES
+/** The amount of data to send to each peer.
+ */
+# define U_BLE_NUS_MULTI_TEST_LENGTH_BYTES 4096
+#endif
+
+#ifndef U_BLE_NUS_MULTI_TEST_CHUNK_LENGTH_BYTES
+/** The size of the pieces the data is handed to NUS in.
+ */
+# define U_BLE_NUS_MULTI_TEST_CHUNK_LENGTH_BYTES 100
+#endif
+
+#ifndef U_BLE_NUS_MULTI_TEST_BASELINE_NUM_CHUNKS
+/** The number of chunks sent as blocking notifications, one per
+ * chunk, to establish the baseline throughput.
+ */
+# define U_BLE_NUS_MULTI_TEST_BASELINE_NUM_CHUNKS 40
+#endif
+
+#ifndef U_BLE_NUS_MULTI_TEST_MTU
+/** The MTU to set on each connection.
+ */
+# define U_BLE_NUS_MULTI_TEST_MTU 247
+#endif
+
+#ifndef U_BLE_NUS_MULTI_TEST_TIMEOUT_MS
+/** How long to wait for things to happen.
+ */
+# define U_BLE_NUS_MULTI_TEST_TIMEOUT_MS 30000
+#endif
+
+#ifndef U_BLE_NUS_MULTI_TEST_CLOSE_MAX_MS
+/** The longest that closing a NUS client may take while a
+ * connection is in progress; much less than the time that
+ * uBleNusConnect() waits for the connection.
+ */
+# define U_BLE_NUS_MULTI_TEST_CLOSE_MAX_MS 5000
+#endif
+
+/** The value handles the simulated module gives to the RX and
+ * TX characteristics of the NUS service.
+ */
+#define U_BLE_NUS_MULTI_TEST_RX_VALUE_HANDLE 32
+#define U_BLE_NUS_MULTI_TEST_TX_VALUE_HANDLE 35
+
+/** The value handle used for the baseline notifications, which
+ * the simulated module does not check.
+ */
+#define U_BLE_NUS_MULTI_TEST_BASELINE_VALUE_HANDLE 40
+
+/** The NUS TX characteristic UUID, as the simulated module sees it.
+ */
+#define U_BLE_NUS_MULTI_TEST_TX_CHAR_UUID "6E400003B5A3F393E0A9E50E24DCCA9E"
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** What the simulated module has seen, per peer.
+ */
+typedef struct {
+    volatile size_t numNotify;     /**< notifications of the TX characteristic. */
+    volatile size_t numBytes;      /**< bytes in those notifications. */
+    volatile size_t numBadValues;  /**< bytes that were not as expected. */
+    volatile size_t maxLength;     /**< the largest notification. */
+} uBleNusMultiTestSimPeer_t;
+
+/** What a peer has had delivered to its data callback.
+ */
+typedef struct {
+    volatile size_t numBytes;
+    volatile size_t numBadValues;
+    volatile size_t numWrongConnection;
+} uBleNusMultiTestRx_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The simulated module.
+ */
+static uShortRangeTestPrivateSim_t *gpSim = NULL;
+
+/** What the simulated module has seen.
+ */
+static uBleNusMultiTestSimPeer_t gSimPeer[U_BLE_NUS_MULTI_TEST_NUM_PEERS];
+
+/** Handle of the device.
+ */
+static uDeviceHandle_t gDevHandle = NULL;
+
+/** Handle of the NUS instance.
+ */
+static uBleNusHandle_t gNusHandle = NULL;
+
+/** Which peers the connect callback says are connected.
+ */
+static volatile bool gConnected[U_BLE_NUS_MULTI_TEST_NUM_PEERS];
+
+/** The number of connect callbacks with a bad connection handle.
+ */
+static volatile size_t gNumBadConnectCallbacks = 0;
+
+/** Set this to make the simulated module reject the adding
+ * of a GATT service.
+ */
+static volatile bool gSimFailService = false;
+
+/** Set by the simulated module when it has been asked to
+ * connect to a peer.
+ */
+static volatile bool gSimConnecting = false;
+
+/** The response of the simulated module to a BLE role query,
+ * which must match the role in gNetworkCfg.
+ */
+static char gSimRoleResponse[32];
+
+/** Set by connectTask() when uBleNusConnect() has returned.
+ */
+static volatile bool gConnectReturned = false;
+
+/** What uBleNusConnect() returned in connectTask().
+ */
+static volatile int32_t gConnectErrorCode = 0;
+
+/** What each peer has received.
+ */
+static uBleNusMultiTestRx_t gRx[U_BLE_NUS_MULTI_TEST_NUM_PEERS];
+
+/** The data sent to one peer.
+ */
+static uint8_t gData[U_BLE_NUS_MULTI_TEST_LENGTH_BYTES];
+
+/** The configuration of the simulated device.
+ */
+static uDeviceCfg_t gDeviceCfg = {
+    .deviceType = U_DEVICE_TYPE_SHORT_RANGE,
+    .deviceCfg = {
+        .cfgSho = {
+            .moduleType = U_SHORT_RANGE_MODULE_TYPE_NINA_B3
+        }
+    },
+    .transportType = U_DEVICE_TRANSPORT_TYPE_UART,
+    .transportCfg = {
+        .cfgUart = {
+            .uart = U_CFG_TEST_UART_A,
+            .baudRate = U_CFG_TEST_BAUD_RATE,
+            .pinTxd = U_CFG_TEST_PIN_UART_A_TXD,
+            .pinRxd = U_CFG_TEST_PIN_UART_A_RXD,
+            .pinCts = U_CFG_TEST_PIN_UART_A_CTS,
+            .pinRts = U_CFG_TEST_PIN_UART_A_RTS,
+#ifdef U_CFG_TEST_UART_PREFIX
+            .pPrefix = U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)
+#else
+            .pPrefix = NULL
+#endif
+        }
+    }
+};
+
+/** The BLE network configuration: a NUS server is a peripheral.
+ */
+static uNetworkCfgBle_t gNetworkCfg = {
+    .type = U_NETWORK_TYPE_BLE,
+    .role = U_BLE_CFG_ROLE_PERIPHERAL,
+    .spsServer = false
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// The byte at a given offset in the data stream to/from a peer.
+static uint8_t dataByte(size_t peer, size_t offset)
+{
+    return (uint8_t) ((offset * 13) + (peer * 31));
+}
+
+// Check a hex-encoded notification to a peer against the data
+// stream of that peer.
+static void simCheckNotify(uBleNusMultiTestSimPeer_t *pPeer, size_t peer,
+                           const char *pHex)
+{
+    size_t length = 0;
+    char byteStr[3] = {0};
+
+    while ((pHex[0] != 0) && (pHex[1] != 0)) {
+        byteStr[0] = pHex[0];
+        byteStr[1] = pHex[1];
+        if ((uint8_t) strtol(byteStr, NULL, 16) != dataByte(peer, pPeer->numBytes + length)) {
+            pPeer->numBadValues++;
+        }
+        length++;
+        pHex += 2;
+    }
+    pPeer->numBytes += length;
+    if (length > pPeer->maxLength) {
+        pPeer->maxLength = length;
+    }
+    pPeer->numNotify++;
+}
+
+// Handle an AT command received by the simulated module.
+static const char *simCommand(const char *pCommand, void *pParameter)
+{
+    uBleNusMultiTestSimPeer_t *pPeers = (uBleNusMultiTestSimPeer_t *) pParameter;
+    const char *pResponse = NULL;
+    const char *pHex;
+    int32_t connHandle;
+
+    if (strstr(pCommand, "AT+UBTLE?") != NULL) {
+        snprintf(gSimRoleResponse, sizeof(gSimRoleResponse),
+                 "\r\n+UBTLE:%d\r\nOK\r\n", (int) gNetworkCfg.role);
+        pResponse = gSimRoleResponse;
+    } else if (strstr(pCommand, "AT+UBTACLC=") != NULL) {
+        // Accept the request but never report a connection
+        gSimConnecting = true;
+    } else if ((strstr(pCommand, "AT+UBTGSER=") != NULL) && gSimFailService) {
+        pResponse = "\r\nERROR\r\n";
+    } else if (strstr(pCommand, "AT+UMSM?") != NULL) {
+        pResponse = "\r\n+UMSM:2\r\nOK\r\n";
+    } else if (strstr(pCommand, "AT+UBTGCHA=") != NULL) {
+        if (strstr(pCommand, U_BLE_NUS_MULTI_TEST_TX_CHAR_UUID) != NULL) {
+            pResponse = "\r\n+UBTGCHA:35,36\r\nOK\r\n";
+        } else {
+            pResponse = "\r\n+UBTGCHA:32,33\r\nOK\r\n";
+        }
+    } else if (strstr(pCommand, "AT+UBTGSN=") != NULL) {
+        // Parameters are connection handle, value handle, hex value
+        connHandle = atoi(strchr(pCommand, '=') + 1);
+        pHex = strchr(pCommand, ',');
+        if ((connHandle >= 0) && (connHandle < U_BLE_NUS_MULTI_TEST_NUM_PEERS) &&
+            (pHex != NULL) &&
+            (atoi(pHex + 1) == U_BLE_NUS_MULTI_TEST_TX_VALUE_HANDLE)) {
+            pHex = strchr(pHex + 1, ',');
+            if (pHex != NULL) {
+                simCheckNotify(&pPeers[connHandle], connHandle, pHex + 1);
+            }
+        }
+    }
+
+    return pResponse;
+}
+
+// NUS connect callback.
+static void connectCallback(uBleNusHandle_t nusHandle, int32_t connHandle,
+                            bool connected, void *pParameter)
+{
+    (void) pParameter;
+
+    if ((nusHandle == gNusHandle) && (connHandle >= 0) &&
+        (connHandle < U_BLE_NUS_MULTI_TEST_NUM_PEERS)) {
+        gConnected[connHandle] = connected;
+    } else {
+        gNumBadConnectCallbacks++;
+    }
+}
+
+// NUS data callback: pParameter points to the entry in gRx
+// of the peer that the connection is expected to be for.
+static void dataCallback(uBleNusHandle_t nusHandle, int32_t connHandle,
+                         const uint8_t *pData, size_t length,
+                         void *pParameter)
+{
+    uBleNusMultiTestRx_t *pRx = (uBleNusMultiTestRx_t *) pParameter;
+    size_t peer;
+
+    if ((pRx != NULL) && (nusHandle == gNusHandle)) {
+        peer = pRx - gRx;
+        if ((size_t) connHandle != peer) {
+            pRx->numWrongConnection++;
+        }
+        for (size_t x = 0; x < length; x++) {
+            if (pData[x] != dataByte(peer, pRx->numBytes + x)) {
+                pRx->numBadValues++;
+            }
+        }
+        pRx->numBytes += length;
+    }
+}
+
+// Task to connect a NUS client, which the simulated module
+// will never let complete.
+static void connectTask(void *pParameter)
+{
+    int32_t connHandle = -1;
+
+    gConnectErrorCode = uBleNusConnect((uBleNusHandle_t) pParameter,
+                                       "0012F398DD01p", &connHandle);
+    gConnectReturned = true;
+    uPortTaskDelete(NULL);
+}
+
+// Wait for all of the given flags to have the given value.
+static bool waitFor(volatile bool *pFlags, size_t numFlags, bool value)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+    bool done = false;
+
+    while (!done && (uPortGetTickTimeMs() - startTimeMs < U_BLE_NUS_MULTI_TEST_TIMEOUT_MS)) {
+        done = true;
+        for (size_t x = 0; x < numFlags; x++) {
+            if (pFlags[x] != value) {
+                done = false;
+            }
+        }
+        if (!done) {
+            uPortTaskBlock(10);
+        }
+    }
+
+    return done;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test the handle-based NUS API as a server with several clients
+ * connected at once, comparing the aggregate throughput with that of
+ * sending each piece of data as a notification of its own.
+ */
+U_PORT_TEST_FUNCTION("[bleNusMulti]", "bleNusMultiConnection")
+{
+    int32_t resourceCount;
+    int32_t openResourceCount;
+    uBleNusHandle_t nusHandle = NULL;
+    char buffer[(U_BLE_NUS_MULTI_TEST_CHUNK_LENGTH_BYTES * 2) + 32];
+    size_t sent[U_BLE_NUS_MULTI_TEST_NUM_PEERS] = {0};
+    size_t total;
+    size_t length;
+    size_t numNotifyMax;
+    int32_t startTimeMs;
+    int32_t timeBaselineMs;
+    int32_t timeNusMs;
+    int32_t rateBaseline;
+    int32_t rateNus;
+    int32_t x;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    for (size_t y = 0; y < sizeof(gData); y++) {
+        gData[y] = (uint8_t) y;
+    }
+    memset(gSimPeer, 0, sizeof(gSimPeer));
+    memset(gRx, 0, sizeof(gRx));
+    for (size_t y = 0; y < U_BLE_NUS_MULTI_TEST_NUM_PEERS; y++) {
+        gConnected[y] = false;
+    }
+    gNumBadConnectCallbacks = 0;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    gpSim = pUShortRangeTestPrivateSimStart(simCommand, gSimPeer);
+    U_PORT_TEST_ASSERT(gpSim != NULL);
+    U_PORT_TEST_ASSERT(uDeviceInit() == 0);
+
+    U_TEST_PRINT_LINE("opening a simulated NINA-B3...");
+    U_PORT_TEST_ASSERT(uDeviceOpen(&gDeviceCfg, &gDevHandle) == 0);
+    U_PORT_TEST_ASSERT(uNetworkInterfaceUp(gDevHandle, U_NETWORK_TYPE_BLE,
+                                           &gNetworkCfg) == 0);
+
+    // Parameter checking
+    U_PORT_TEST_ASSERT(uBleNusOpen(gDevHandle, true, NULL, NULL, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uBleNusSend(NULL, 0, gData, 1) < 0);
+
+    // A failed open must not leave anything behind
+    openResourceCount = uTestUtilGetDynamicResourceCount();
+    gSimFailService = true;
+    U_PORT_TEST_ASSERT(uBleNusOpen(gDevHandle, true, connectCallback, dataCallback,
+                                   NULL, &nusHandle) < 0);
+    gSimFailService = false;
+    U_PORT_TEST_ASSERT(nusHandle == NULL);
+    // Closed event queues are only freed on clean-up
+    uPortEventQueueCleanUp();
+    U_PORT_TEST_ASSERT(uTestUtilGetDynamicResourceCount() == openResourceCount);
+
+    U_PORT_TEST_ASSERT(uBleNusOpen(gDevHandle, true, connectCallback, dataCallback,
+                                   NULL, &nusHandle) == 0);
+    gNusHandle = nusHandle;
+    // Only one instance per device
+    U_PORT_TEST_ASSERT(uBleNusOpen(gDevHandle, true, NULL, NULL, NULL, &nusHandle) < 0);
+    U_PORT_TEST_ASSERT(nusHandle == gNusHandle);
+
+    // Connect the peers
+    U_TEST_PRINT_LINE("connecting %d simulated NUS clients...", U_BLE_NUS_MULTI_TEST_NUM_PEERS);
+    for (size_t y = 0; y < U_BLE_NUS_MULTI_TEST_NUM_PEERS; y++) {
+        snprintf(buffer, sizeof(buffer), "+UUBTACLC:%d,0,0012F398DD0%dp", (int) y, (int) y);
+        uShortRangeTestPrivateSimSendEvent(gpSim, buffer);
+    }
+    U_PORT_TEST_ASSERT(waitFor(gConnected, U_BLE_NUS_MULTI_TEST_NUM_PEERS, true));
+    U_PORT_TEST_ASSERT(gNumBadConnectCallbacks == 0);
+    U_PORT_TEST_ASSERT(uBleNusSend(gNusHandle, U_BLE_NUS_MULTI_TEST_NUM_PEERS,
+                                   gData, 1) == (int32_t) U_BLE_ERROR_NOT_FOUND);
+
+    // Each connection gets its own receive callback
+    U_TEST_PRINT_LINE("receiving from each client...");
+    for (size_t y = 0; y < U_BLE_NUS_MULTI_TEST_NUM_PEERS; y++) {
+        U_PORT_TEST_ASSERT(uBleNusDataCallbackSet(gNusHandle, (int32_t) y, dataCallback,
+                                                  &gRx[y]) == 0);
+        U_PORT_TEST_ASSERT(uBleNusMtuSet(gNusHandle, (int32_t) y, 22) < 0);
+        U_PORT_TEST_ASSERT(uBleNusMtuSet(gNusHandle, (int32_t) y,
+                                         U_BLE_NUS_MULTI_TEST_MTU) == 0);
+    }
+    for (size_t z = 0; z < 4; z++) {
+        for (size_t y = 0; y < U_BLE_NUS_MULTI_TEST_NUM_PEERS; y++) {
+            x = snprintf(buffer, sizeof(buffer), "+UUBTGRW:%d,%d,", (int) y,
+                         U_BLE_NUS_MULTI_TEST_RX_VALUE_HANDLE);
+            for (size_t w = 0; w < 20; w++) {
+                x += snprintf(buffer + x, sizeof(buffer) - x, "%02X",
+                              dataByte(y, (z * 20) + w));
+            }
+            uShortRangeTestPrivateSimSendEvent(gpSim, buffer);
+        }
+    }
+    startTimeMs = uPortGetTickTimeMs();
+    do {
+        total = 0;
+        for (size_t y = 0; y < U_BLE_NUS_MULTI_TEST_NUM_PEERS; y++) {
+            total += gRx[y].numBytes;
+        }
+        uPortTaskBlock(10);
+    } while ((total < U_BLE_NUS_MULTI_TEST_NUM_PEERS * 4 * 20) &&
+             (uPortGetTickTimeMs() - startTimeMs < U_BLE_NUS_MULTI_TEST_TIMEOUT_MS));
+    for (size_t y = 0; y < U_BLE_NUS_MULTI_TEST_NUM_PEERS; y++) {
+        U_PORT_TEST_ASSERT(gRx[y].numBytes == 4 * 20);
+        U_PORT_TEST_ASSERT(gRx[y].numBadValues == 0);
+        U_PORT_TEST_ASSERT(gRx[y].numWrongConnection == 0);
+    }
+
+    // Baseline: a blocking notification per chunk
+    U_TEST_PRINT_LINE("sending %d byte chunks as one notification each...",
+                      U_BLE_NUS_MULTI_TEST_CHUNK_LENGTH_BYTES);
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t y = 0; y < U_BLE_NUS_MULTI_TEST_BASELINE_NUM_CHUNKS; y++) {
+        U_PORT_TEST_ASSERT(uBleGattWriteNotifyValue(gDevHandle,
+                                                    (int32_t) (y % U_BLE_NUS_MULTI_TEST_NUM_PEERS),
+                                                    U_BLE_NUS_MULTI_TEST_BASELINE_VALUE_HANDLE,
+                                                    gData,
+                                                    U_BLE_NUS_MULTI_TEST_CHUNK_LENGTH_BYTES) == 0);
+    }
+    timeBaselineMs = uPortGetTickTimeMs() - startTimeMs;
+    rateBaseline = (U_BLE_NUS_MULTI_TEST_BASELINE_NUM_CHUNKS *
+                    U_BLE_NUS_MULTI_TEST_CHUNK_LENGTH_BYTES * 1000) / (timeBaselineMs + 1);
+
+    // Now through NUS, round-robin across the peers
+    U_TEST_PRINT_LINE("sending %d bytes to each client through NUS...",
+                      U_BLE_NUS_MULTI_TEST_LENGTH_BYTES);
+    startTimeMs = uPortGetTickTimeMs();
+    do {
+        total = 0;
+        for (size_t y = 0; y < U_BLE_NUS_MULTI_TEST_NUM_PEERS; y++) {
+            length = sizeof(gData) - sent[y];
+            if (length > U_BLE_NUS_MULTI_TEST_CHUNK_LENGTH_BYTES) {
+                length = U_BLE_NUS_MULTI_TEST_CHUNK_LENGTH_BYTES;
+            }
+            for (size_t w = 0; w < length; w++) {
+                buffer[w] = (char) dataByte(y, sent[y] + w);
+            }
+            x = uBleNusSend(gNusHandle, (int32_t) y, buffer, length);
+            U_PORT_TEST_ASSERT(x >= 0);
+            sent[y] += x;
+            total += sent[y];
+        }
+        if (total < U_BLE_NUS_MULTI_TEST_NUM_PEERS * sizeof(gData)) {
+            uPortTaskBlock(1);
+        }
+    } while ((total < U_BLE_NUS_MULTI_TEST_NUM_PEERS * sizeof(gData)) &&
+             (uPortGetTickTimeMs() - startTimeMs < U_BLE_NUS_MULTI_TEST_TIMEOUT_MS));
+    for (size_t y = 0; y < U_BLE_NUS_MULTI_TEST_NUM_PEERS; y++) {
+        U_PORT_TEST_ASSERT(uBleNusFlush(gNusHandle, (int32_t) y,
+                                        U_BLE_NUS_MULTI_TEST_TIMEOUT_MS) == 0);
+    }
+    timeNusMs = uPortGetTickTimeMs() - startTimeMs;
+    rateNus = (int32_t) ((U_BLE_NUS_MULTI_TEST_NUM_PEERS * sizeof(gData) * 1000) /
+                         (timeNusMs + 1));
+    U_TEST_PRINT_LINE("aggregate bytes/second: one notification per chunk %d,"
+                      " NUS to %d clients %d.", rateBaseline,
+                      U_BLE_NUS_MULTI_TEST_NUM_PEERS, rateNus);
+
+    // Everything should have arrived, in order, packed into
+    // (nearly) full notifications
+    numNotifyMax = (sizeof(gData) + U_BLE_GATT_VALUE_MAX_LENGTH_BYTES - 1) /
+                   U_BLE_GATT_VALUE_MAX_LENGTH_BYTES;
+    for (size_t y = 0; y < U_BLE_NUS_MULTI_TEST_NUM_PEERS; y++) {
+        U_TEST_PRINT_LINE("client %d: %d notification(s), largest %d byte(s).",
+                          y, gSimPeer[y].numNotify, gSimPeer[y].maxLength);
+        U_PORT_TEST_ASSERT(gSimPeer[y].numBytes == sizeof(gData));
+        U_PORT_TEST_ASSERT(gSimPeer[y].numBadValues == 0);
+        U_PORT_TEST_ASSERT(gSimPeer[y].maxLength == U_BLE_GATT_VALUE_MAX_LENGTH_BYTES);
+        U_PORT_TEST_ASSERT(gSimPeer[y].numNotify <= numNotifyMax + U_BLE_NUS_TX_IN_FLIGHT_MAX);
+    }
+    U_PORT_TEST_ASSERT(rateNus > rateBaseline);
+
+    // A peer going away
+    U_TEST_PRINT_LINE("disconnecting...");
+    uShortRangeTestPrivateSimSendEvent(gpSim, "+UUBTACLD:0");
+    U_PORT_TEST_ASSERT(waitFor(gConnected, 1, false));
+    U_PORT_TEST_ASSERT(uBleNusSend(gNusHandle, 0, gData, 1) == (int32_t) U_BLE_ERROR_NOT_FOUND);
+    U_PORT_TEST_ASSERT(uBleNusSend(gNusHandle, 1, gData, 1) == 1);
+    // Disconnecting from this end
+    U_PORT_TEST_ASSERT(uBleNusDisconnect(gNusHandle, 1) == 0);
+    uShortRangeTestPrivateSimSendEvent(gpSim, "+UUBTACLD:1");
+    U_PORT_TEST_ASSERT(waitFor(gConnected, 2, false));
+    U_PORT_TEST_ASSERT(gNumBadConnectCallbacks == 0);
+
+    // Close with data still queued
+    U_PORT_TEST_ASSERT(uBleNusSend(gNusHandle, 2, gData, sizeof(gData)) > 0);
+    uBleNusClose(gNusHandle);
+    gNusHandle = NULL;
+    U_PORT_TEST_ASSERT(uBleNusSend(nusHandle, 2, gData, 1) < 0);
+
+    U_PORT_TEST_ASSERT(uNetworkInterfaceDown(gDevHandle, U_NETWORK_TYPE_BLE) == 0);
+    U_PORT_TEST_ASSERT(uDeviceClose(gDevHandle, false) == 0);
+    gDevHandle = NULL;
+    uDeviceDeinit();
+
+    uShortRangeTestPrivateSimStop(gpSim);
+    gpSim = NULL;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test closing a NUS client while uBleNusConnect() is waiting
+ * for a connection: the close must wake the connect up, wait for
+ * it to return and only then free the instance.
+ */
+U_PORT_TEST_FUNCTION("[bleNusMulti]", "bleNusMultiCloseConnecting")
+{
+    int32_t resourceCount;
+    uBleNusHandle_t nusHandle = NULL;
+    uPortTaskHandle_t taskHandle;
+    int32_t connHandle = -1;
+    int32_t startTimeMs;
+    int32_t timeMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    gSimConnecting = false;
+    gConnectReturned = false;
+    gConnectErrorCode = 0;
+    gNetworkCfg.role = U_BLE_CFG_ROLE_CENTRAL;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    gpSim = pUShortRangeTestPrivateSimStart(simCommand, gSimPeer);
+    U_PORT_TEST_ASSERT(gpSim != NULL);
+    U_PORT_TEST_ASSERT(uDeviceInit() == 0);
+
+    U_TEST_PRINT_LINE("opening a simulated NINA-B3 as a central...");
+    U_PORT_TEST_ASSERT(uDeviceOpen(&gDeviceCfg, &gDevHandle) == 0);
+    U_PORT_TEST_ASSERT(uNetworkInterfaceUp(gDevHandle, U_NETWORK_TYPE_BLE,
+                                           &gNetworkCfg) == 0);
+    U_PORT_TEST_ASSERT(uBleNusOpen(gDevHandle, false, NULL, NULL, NULL,
+                                   &nusHandle) == 0);
+    gNusHandle = nusHandle;
+
+    U_PORT_TEST_ASSERT(uPortTaskCreate(connectTask, "nusConnect",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       nusHandle, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    startTimeMs = uPortGetTickTimeMs();
+    while (!gSimConnecting && !gConnectReturned &&
+           (uPortGetTickTimeMs() - startTimeMs < U_BLE_NUS_MULTI_TEST_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gSimConnecting);
+    // Give uBleNusConnect() time to start waiting
+    uPortTaskBlock(100);
+    U_PORT_TEST_ASSERT(!gConnectReturned);
+    // Only one connection at a time
+    U_PORT_TEST_ASSERT(uBleNusConnect(nusHandle, "0012F398DD02p",
+                                      &connHandle) == (int32_t) U_ERROR_COMMON_BUSY);
+
+    U_TEST_PRINT_LINE("closing while connecting...");
+    startTimeMs = uPortGetTickTimeMs();
+    uBleNusClose(nusHandle);
+    gNusHandle = NULL;
+    timeMs = uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("close took %d ms, connect returned %d.", timeMs,
+                      gConnectErrorCode);
+    // The close must have waited for the connect to return
+    U_PORT_TEST_ASSERT(gConnectReturned);
+    U_PORT_TEST_ASSERT(gConnectErrorCode == (int32_t) U_ERROR_COMMON_CANCELLED);
+    U_PORT_TEST_ASSERT(timeMs < U_BLE_NUS_MULTI_TEST_CLOSE_MAX_MS);
+    U_PORT_TEST_ASSERT(uBleNusConnect(nusHandle, "0012F398DD01p", &connHandle) < 0);
+    // A connection turning up late must go nowhere
+    uShortRangeTestPrivateSimSendEvent(gpSim, "+UUBTACLC:0,0,0012F398DD01p");
+    uPortTaskBlock(100);
+    // Let connectTask() exit
+    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+
+    U_PORT_TEST_ASSERT(uNetworkInterfaceDown(gDevHandle, U_NETWORK_TYPE_BLE) == 0);
+    U_PORT_TEST_ASSERT(uDeviceClose(gDevHandle, false) == 0);
+    gDevHandle = NULL;
+    uDeviceDeinit();
+
+    uShortRangeTestPrivateSimStop(gpSim);
+    gpSim = NULL;
+    gNetworkCfg.role = U_BLE_CFG_ROLE_PERIPHERAL;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[bleNusMulti]", "bleNusMultiCleanUp")
+{
+    if (gNusHandle != NULL) {
+        uBleNusClose(gNusHandle);
+        gNusHandle = NULL;
+    }
+    if (gDevHandle != NULL) {
+        uNetworkInterfaceDown(gDevHandle, U_NETWORK_TYPE_BLE);
+        uDeviceClose(gDevHandle, false);
+        gDevHandle = NULL;
+    }
+    uDeviceDeinit();
+    uShortRangeTestPrivateSimStop(gpSim);
+    gpSim = NULL;
+    gNetworkCfg.role = U_BLE_CFG_ROLE_PERIPHERAL;
+    uPortDeinit();
+}
+
+#endif // #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && ...
+
+// End of file
@@ -52,6 +52,7 @@
 #include "u_error_common.h"
 
 #include "u_port.h"
+#include "u_port_os.h"
 #include "u_port_debug.h"
 
 #include "u_test_util_resource_check.h"
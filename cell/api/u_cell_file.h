@@ -48,10 +48,50 @@ extern "C" {
  */
 #define U_CELL_FILE_NAME_MAX_LENGTH 248
 
+#ifndef U_CELL_FILE_STREAM_CHUNK_SIZE_BYTES
+/** The default chunk size for uCellFileWriteStream(): each chunk
+ * is sent to the module as a separate AT+UDWNFILE transaction and
+ * this much heap is required for it (twice this if verification
+ * is switched on).
+ */
+# define U_CELL_FILE_STREAM_CHUNK_SIZE_BYTES 1024
+#endif
+
+#ifndef U_CELL_FILE_STREAM_MAX_RETRIES
+/** The default number of times uCellFileWriteStream() will
+ * try to resume after a failed chunk before giving up.
+ */
+# define U_CELL_FILE_STREAM_MAX_RETRIES 3
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Settings for uCellFileWriteStream().
+ */
+typedef struct {
+    size_t chunkSizeBytes; /**< the number of bytes to send in each
+                                AT+UDWNFILE transaction; zero means
+                                #U_CELL_FILE_STREAM_CHUNK_SIZE_BYTES. */
+    size_t maxRetries;     /**< the number of times in a row that a
+                                failed chunk may be resumed before
+                                giving up. */
+    bool resume;           /**< if true and the file already exists
+                                on the module with a size no larger
+                                than that being written, what is
+                                there is taken to be the start of
+                                this upload, left by a previous
+                                interrupted attempt, and the upload
+                                continues from its end; if false any
+                                existing file is deleted first. */
+    bool verify;           /**< if true then, once uploaded, the file
+                                is read back from the module in blocks
+                                and each block compared with the same
+                                block of source data; not supported if a
+                                tag has been set with uCellFileSetTag(). */
+} uCellFileStreamConfig_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS:  WORKAROUND FOR LINKER ISSUE
  * -------------------------------------------------------------- */
@@ -121,6 +161,60 @@ int32_t uCellFileWrite(uDeviceHandle_t cellHandle,
                        const char *pData,
                        size_t dataSize);
 
+/** Write a file to the file system in chunks, pulling the data
+ * from a callback, rather than from one contiguous buffer as
+ * uCellFileWrite() does; suitable for large files such as
+ * certificates or assistance databases.  Each chunk is appended
+ * to the file with its own AT+UDWNFILE transaction; should one
+ * fail, the size of the file on the module is read with
+ * AT+ULSTFILE and the upload continues from there, so a failure
+ * near the end only costs a chunk.  The same mechanism, with
+ * resume set in pConfig, allows an upload that was abandoned
+ * (e.g. because of a power cut) to be completed later.
+ *
+ * The instance is only locked for the duration of each chunk, so
+ * other calls to this cellular instance may be made while an
+ * upload is in progress and the callback may itself call the
+ * cellular API; however nothing else should write to the same
+ * file at the same time.
+ *
+ * In order to avoid character loss it is recommended that flow
+ * control lines are connected on the interface to the module.
+ *
+ * @param cellHandle      the handle of the cellular instance.
+ * @param[in] pFileName   the name of the file to write; the same
+ *                        rules as for uCellFileWrite() apply.
+ * @param fileSize        the total size of the file in bytes.
+ * @param[in] pCallback   the callback that supplies the data; it
+ *                        must copy the size bytes of the file that
+ *                        begin at offset into pBuffer and return
+ *                        the number of bytes copied, which must be
+ *                        size, or a negative error code to abort.
+ *                        It may be asked for the same part of the
+ *                        file more than once, e.g. when verifying.
+ *                        Cannot be NULL.
+ * @param[in] pCallbackParam  a parameter that will be passed to
+ *                        pCallback as its last parameter.
+ * @param[in] pConfig     the settings to use, NULL for a chunk size
+ *                        of #U_CELL_FILE_STREAM_CHUNK_SIZE_BYTES,
+ *                        #U_CELL_FILE_STREAM_MAX_RETRIES retries,
+ *                        no resume and no verification.
+ * @return                on success the size of the file, else
+ *                        negative error code; in particular
+ *                        #U_ERROR_COMMON_BAD_DATA if verification
+ *                        found that the contents do not match.
+ */
+int32_t uCellFileWriteStream(uDeviceHandle_t cellHandle,
+                             const char *pFileName,
+                             size_t fileSize,
+                             int32_t (*pCallback) (uDeviceHandle_t cellHandle,
+                                                   size_t offset,
+                                                   char *pBuffer,
+                                                   size_t size,
+                                                   void *pCallbackParam),
+                             void *pCallbackParam,
+                             const uCellFileStreamConfig_t *pConfig);
+
 /** Read the contents of a file from the file system. If the file does not exist
  * an error will be return. In order to avoid character loss it is recommended
  * that flow control lines are connected on the interface to the module.
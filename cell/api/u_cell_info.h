@@ -58,10 +58,56 @@ extern "C" {
  */
 #define U_CELL_INFO_ICCID_BUFFER_SIZE 21
 
+#ifndef U_CELL_INFO_IDENTITY_STR_BUFFER_SIZE
+/** The size of the buffers used for the manufacturer, model and
+ * firmware version strings in #uCellInfoIdentity_t, including
+ * room for a null terminator.  A string returned by the module
+ * that does not fit is still returned by
+ * uCellInfoGetManufacturerStr() etc. but is not cached.
+ */
+# define U_CELL_INFO_IDENTITY_STR_BUFFER_SIZE 64
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The fields of #uCellInfoIdentity_t, used as bit positions in
+ * its validBitMap.
+ */
+typedef enum {
+    U_CELL_INFO_IDENTITY_FIELD_IMEI = 0,
+    U_CELL_INFO_IDENTITY_FIELD_IMSI = 1,
+    U_CELL_INFO_IDENTITY_FIELD_ICCID = 2,
+    U_CELL_INFO_IDENTITY_FIELD_MANUFACTURER = 3,
+    U_CELL_INFO_IDENTITY_FIELD_MODEL = 4,
+    U_CELL_INFO_IDENTITY_FIELD_FIRMWARE_VERSION = 5,
+    U_CELL_INFO_IDENTITY_FIELD_MAX_NUM
+} uCellInfoIdentityField_t;
+
+/** A snapshot of the identity of a cellular module and of the SIM
+ * inside it, as returned by uCellInfoGetIdentity().  All strings
+ * are null terminated.  The structure contains no pointers and
+ * so may be stored as-is in non-volatile memory and handed back
+ * to uCellInfoIdentityRestore() after a warm boot.
+ */
+typedef struct {
+    char imei[U_CELL_INFO_IMEI_SIZE + 1]; /**< the IMEI of the module. */
+    char imsi[U_CELL_INFO_IMSI_SIZE + 1]; /**< the IMSI of the SIM. */
+    char iccid[U_CELL_INFO_ICCID_BUFFER_SIZE]; /**< the ICCID of the SIM. */
+    char manufacturer[U_CELL_INFO_IDENTITY_STR_BUFFER_SIZE]; /**< as returned
+                                                                  by uCellInfoGetManufacturerStr(). */
+    char model[U_CELL_INFO_IDENTITY_STR_BUFFER_SIZE]; /**< as returned by
+                                                           uCellInfoGetModelStr(). */
+    char firmwareVersion[U_CELL_INFO_IDENTITY_STR_BUFFER_SIZE]; /**< as returned by
+                                                                     uCellInfoGetFirmwareVersionStr(). */
+    uint32_t validBitMap; /**< a bit-map of the fields that are valid,
+                               bit positions as #uCellInfoIdentityField_t. */
+    uint32_t fingerprint; /**< a check-value over all of the above, used
+                               by uCellInfoIdentityRestore() to reject
+                               a corrupted copy. */
+} uCellInfoIdentity_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -309,6 +355,61 @@ int32_t uCellInfoGetModelStr(uDeviceHandle_t cellHandle,
 int32_t uCellInfoGetFirmwareVersionStr(uDeviceHandle_t cellHandle,
                                        char *pStr, size_t size);
 
+/** Get a snapshot of the identity of the cellular module and of its
+ * SIM: IMEI, IMSI, ICCID, manufacturer, model and firmware version.
+ *
+ * These values are read from the module once and then cached, so
+ * calling this function, or any of uCellInfoGetImei(),
+ * uCellInfoGetImsi(), uCellInfoGetIccidStr(),
+ * uCellInfoGetManufacturerStr(), uCellInfoGetModelStr() or
+ * uCellInfoGetFirmwareVersionStr(), repeatedly costs no AT
+ * traffic.  The cache is emptied when the module is powered off,
+ * rebooted or reset, when it is put into AT+CFUN=0 (which is when a
+ * SIM may be swapped), when a firmware update has been installed
+ * and when uCellInfoIdentityInvalidate() is called.
+ *
+ * @param cellHandle      the handle of the cellular instance.
+ * @param[out] pIdentity  a pointer to a place to put the snapshot;
+ *                        cannot be NULL.  The fields that could be
+ *                        read are indicated in validBitMap, the
+ *                        others are empty strings, and fingerprint
+ *                        is always populated.
+ * @return                zero if all fields were read, else negative
+ *                        error code, e.g. if there is no SIM then
+ *                        the IMSI and ICCID will be missing.
+ */
+int32_t uCellInfoGetIdentity(uDeviceHandle_t cellHandle,
+                             uCellInfoIdentity_t *pIdentity);
+
+/** Restore the identity cache from a snapshot previously obtained
+ * with uCellInfoGetIdentity(), e.g. one kept in non-volatile memory
+ * across a warm boot, avoiding the need to read all of the fields
+ * from the module again.  The fingerprint of the snapshot is checked
+ * and then the IMEI, the firmware version and, if present in the
+ * snapshot, the ICCID, are read from the module: only if these
+ * match is the snapshot adopted; the IMSI is only adopted if the
+ * ICCID matched.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param pIdentity   a pointer to the snapshot; cannot be NULL.
+ * @return            zero on success, #U_ERROR_COMMON_INVALID_PARAMETER
+ *                    if the fingerprint does not match the contents,
+ *                    #U_ERROR_COMMON_NOT_FOUND if the snapshot is not
+ *                    of this module/SIM, else negative error code.
+ */
+int32_t uCellInfoIdentityRestore(uDeviceHandle_t cellHandle,
+                                 const uCellInfoIdentity_t *pIdentity);
+
+/** Empty the identity cache, forcing the values to be read from
+ * the module again the next time they are requested; you only need
+ * to call this if you know of a change that this code does not,
+ * e.g. a SIM hot-swap while the module remains in AT+CFUN=1.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            zero on success else negative error code.
+ */
+int32_t uCellInfoIdentityInvalidate(uDeviceHandle_t cellHandle);
+
 /** Get the UTC time according to cellular.  This feature requires
  * a connection to have been activated and support for this feature
  * is optional in the cellular network.  To get the local time instead
@@ -80,10 +80,28 @@ extern "C" {
 # define U_CELL_SOCK_DNS_LOOKUP_TIME_SECONDS 332
 #endif
 
+#ifndef U_CELL_SOCK_DATA_COALESCE_WINDOW_MS
+/** The default coalescing window for data indications, see
+ * uCellSockSetDataCoalesceWindow(); zero means that indications
+ * are delivered as soon as the callback task is able, which will
+ * still merge any that arrive while a delivery is pending.
+ */
+# define U_CELL_SOCK_DATA_COALESCE_WINDOW_MS 0
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** An entry in the set of sockets passed to a callback registered
+ * with uCellSockRegisterCallbackDataReady().
+ */
+typedef struct {
+    int32_t sockHandle;   /**< the handle of a socket with data waiting. */
+    int32_t pendingBytes; /**< the number of bytes the module last
+                               indicated were waiting on that socket. */
+} uCellSockDataReady_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS:  WORKAROUND FOR LINKER ISSUE
  * -------------------------------------------------------------- */
@@ -469,6 +487,61 @@ void uCellSockRegisterCallbackData(uDeviceHandle_t cellHandle,
                                    void (*pCallback) (uDeviceHandle_t,
                                                       int32_t));
 
+/** Register a callback that is called, once, with the set of
+ * sockets of a cellular instance that have received data.  The
+ * module sends a +UUSORD/+UUSORF indication for each chunk of
+ * data that arrives; these indications are coalesced, per socket,
+ * so that a burst of them across many sockets results in one call
+ * of this callback (and one call of each socket's data callback,
+ * see uCellSockRegisterCallbackData()), rather than one per
+ * indication.  This callback is called before the per-socket
+ * data callbacks.  The callback is run from the AT client
+ * callback task, see uAtClientCallback(), so it should not block.
+ *
+ * @param cellHandle             the handle of the cellular instance.
+ * @param[in] pCallback          the callback to be called, or
+ *                               NULL to cancel a previous callback.
+ *                               The parameters passed to the callback
+ *                               will be cellHandle, an array of the
+ *                               sockets that have data waiting,
+ *                               the number of entries in that array
+ *                               (at least one) and pCallbackParameter.
+ *                               The array is only valid for the
+ *                               duration of the callback.
+ * @param[in] pCallbackParameter a parameter that will be passed to
+ *                               pCallback; may be NULL.
+ * @return                       zero on success else negative error
+ *                               code.
+ */
+int32_t uCellSockRegisterCallbackDataReady(uDeviceHandle_t cellHandle,
+                                           void (*pCallback) (uDeviceHandle_t,
+                                                              const uCellSockDataReady_t *,
+                                                              size_t,
+                                                              void *),
+                                           void *pCallbackParameter);
+
+/** Set the window over which data indications from the module
+ * are coalesced before the data callbacks are called.  Once the
+ * first indication of a batch has arrived, delivery is held off
+ * for this long so that further indications, for the same or
+ * other sockets, are delivered with it.  The hold-off is timed
+ * with a port timer, so other asynchronous callbacks of the AT
+ * client are not held up by it; a non-zero window therefore
+ * requires the timer API of the port (see uPortTimerCreate()).
+ * If this is not called #U_CELL_SOCK_DATA_COALESCE_WINDOW_MS
+ * applies.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param windowMs    the coalescing window in milliseconds; zero
+ *                    to deliver as soon as possible.
+ * @return            zero on success else negative error code,
+ *                    e.g. #U_ERROR_COMMON_NOT_IMPLEMENTED if
+ *                    windowMs is non-zero and the port has no
+ *                    timers, in which case the window is zero.
+ */
+int32_t uCellSockSetDataCoalesceWindow(uDeviceHandle_t cellHandle,
+                                       int32_t windowMs);
+
 /** Register a callback on a socket being closed.
  *
  * @param cellHandle    the handle of the cellular instance.
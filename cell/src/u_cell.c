@@ -116,11 +116,16 @@ static void addCellInstance(uCellPrivateInstance_t *pInstance)
 // THIS NOW FREES THE CONTENTS OF THE INSTANCE ALSO; got tired
 // of forgetting to do the freeing in both of the places this is
 // called from.
-// gUCellPrivateMutex should be locked before this is called.
+// The instance should be locked with pUCellPrivateInstanceLock()
+// before this is called and gUCellPrivateMutex should NOT be
+// locked; this function unlocks the instance.
 static void removeCellInstance(uCellPrivateInstance_t *pInstance)
 {
     uCellPrivateInstance_t *pCurrent;
     uCellPrivateInstance_t *pPrev = NULL;
+    size_t numWaiting;
+
+    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
 
     pCurrent = gpUCellPrivateInstanceList;
     while (pCurrent != NULL) {
@@ -130,37 +135,59 @@ static void removeCellInstance(uCellPrivateInstance_t *pInstance)
             } else {
                 gpUCellPrivateInstanceList = pCurrent->pNext;
             }
-            // Tell the AT client to ignore any asynchronous events from now on
-            uAtClientIgnoreAsync(pInstance->atHandle);
-            // Free the wake-up callback
-            uAtClientSetWakeUpHandler(pInstance->atHandle, NULL, NULL, 0);
-            // Free any scan results
-            uCellPrivateScanFree(&(pInstance->pScanResults));
-            // Free any location context and associated URC
-            uCellPrivateLocRemoveContext(pInstance);
-            // Free any sleep context
-            uCellPrivateSleepRemoveContext(pInstance);
-            // Free any FOTA context
-            uPortFree(pInstance->pFotaContext);
-            // Free any HTTP context
-            uCellPrivateHttpRemoveContext(pInstance);
-            // Free any PPP context
-            uCellPppPrivateRemoveContext(pInstance);
-            // Free any CMUX context
-            uCellMuxPrivateRemoveContext(pInstance);
-            // Free any CellTime context
-            uCellPrivateCellTimeRemoveContext(pInstance);
-            // Unlink any geofences and free the fence context
-            uGeofenceContextFree((uGeofenceContext_t **) &pInstance->pFenceContext);
-            uDeviceDestroyInstance(U_DEVICE_INSTANCE(pInstance->cellHandle));
-            uPortFree(pInstance);
             pCurrent = NULL;
         } else {
             pPrev = pCurrent;
             pCurrent = pPrev->pNext;
         }
     }
+    // Anyone waiting for the instance will now get
+    // it, see that it has been removed and give up;
+    // the last of them to do so gives apiGoneSemaphore
+    pInstance->apiRemoved = true;
+    numWaiting = pInstance->apiNumWaiting;
+    uPortMutexUnlock(pInstance->apiMutex);
+
+    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+    if (numWaiting > 0) {
+        uPortSemaphoreTake(pInstance->apiGoneSemaphore);
+    }
 
+    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+    // Tell the AT client to ignore any asynchronous events from now on
+    uAtClientIgnoreAsync(pInstance->atHandle);
+    // Free the wake-up callback
+    uAtClientSetWakeUpHandler(pInstance->atHandle, NULL, NULL, 0);
+    // Free any scan results
+    uCellPrivateScanFree(&(pInstance->pScanResults));
+    // Free any location context and associated URC
+    uCellPrivateLocRemoveContext(pInstance);
+    // Free any sleep context
+    uCellPrivateSleepRemoveContext(pInstance);
+    // Free any FOTA context
+    uPortFree(pInstance->pFotaContext);
+    // Free any identity cache
+    uPortFree(pInstance->pIdentityContext);
+    // Free any socket data indication context
+    uCellSockPrivateRemoveContext(pInstance);
+    // Free any HTTP context
+    uCellPrivateHttpRemoveContext(pInstance);
+    // Free any PPP context
+    uCellPppPrivateRemoveContext(pInstance);
+    // Free any CMUX context
+    uCellMuxPrivateRemoveContext(pInstance);
+    // Free any CellTime context
+    uCellPrivateCellTimeRemoveContext(pInstance);
+    // Unlink any geofences and free the fence context
+    uGeofenceContextFree((uGeofenceContext_t **) &pInstance->pFenceContext);
+    uDeviceDestroyInstance(U_DEVICE_INSTANCE(pInstance->cellHandle));
+    uPortSemaphoreDelete(pInstance->apiGoneSemaphore);
+    uPortMutexDelete(pInstance->apiMutex);
+    uPortFree(pInstance);
+
+    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
 }
 
 /* ----------------------------------------------------------------
@@ -200,19 +227,30 @@ int32_t uCellInit()
 // Shut-down the cellular driver.
 void uCellDeinit()
 {
-    uCellPrivateInstance_t *pInstance;
+    uDeviceHandle_t cellHandle;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+        // Remove all cell instances, one at a time, allowing
+        // any API call that is in progress on each to finish
+        do {
+            cellHandle = NULL;
 
-        // Remove all cell instances
-        while (gpUCellPrivateInstanceList != NULL) {
-            pInstance = gpUCellPrivateInstanceList;
-            removeCellInstance(pInstance);
-        }
+            U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+            if (gpUCellPrivateInstanceList != NULL) {
+                cellHandle = gpUCellPrivateInstanceList->cellHandle;
+            }
+
+            U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
 
-        // Unlock the mutex so that we can delete it
+            if (cellHandle != NULL) {
+                uCellRemove(cellHandle);
+            }
+        } while (cellHandle != NULL);
+
+        // Lock and unlock the mutex so that we can delete it
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
         uPortMutexDelete(gUCellPrivateMutex);
         gUCellPrivateMutex = NULL;
@@ -281,6 +319,13 @@ int32_t uCellAdd(uCellModuleType_t moduleType,
                     handleOrErrorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
                     // Fill the values in
                     memset(pInstance, 0, sizeof(*pInstance));
+                    // Create the mutex that serialises the
+                    // API calls for this instance
+                    platformError = uPortMutexCreate(&(pInstance->apiMutex));
+                    if (platformError == 0) {
+                        platformError = uPortSemaphoreCreate(&(pInstance->apiGoneSemaphore),
+                                                             0, 1);
+                    }
                     // Set the pin states so that we can use them elsewhere
                     if (pinEnablePowerOnState != 0) {
                         pInstance->pinStates |= 1 << U_CELL_PRIVATE_ENABLE_POWER_PIN_BIT_ON_STATE;
@@ -336,7 +381,7 @@ int32_t uCellAdd(uCellModuleType_t moduleType,
                         uPortLog("not connected.\n");
                     }
                     // Sort PWR_ON pin if there is one
-                    if (pinPwrOn >= 0) {
+                    if ((platformError == 0) && (pinPwrOn >= 0)) {
                         if (!leavePowerAlone) {
                             // Set PWR_ON to its steady state so that we can pull it
                             // the other way
@@ -422,6 +467,12 @@ int32_t uCellAdd(uCellModuleType_t moduleType,
                         *pCellHandle = pInstance->cellHandle;
                     } else {
                         // If we hit a platform error, free memory again
+                        if (pInstance->apiGoneSemaphore != NULL) {
+                            uPortSemaphoreDelete(pInstance->apiGoneSemaphore);
+                        }
+                        if (pInstance->apiMutex != NULL) {
+                            uPortMutexDelete(pInstance->apiMutex);
+                        }
                         uPortFree(pInstance);
                     }
                 }
@@ -445,14 +496,11 @@ void uCellRemove(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
+            // This also unlocks the instance
             removeCellInstance(pInstance);
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 }
 
@@ -465,16 +513,14 @@ int32_t uCellAtClientHandleGet(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if ((pInstance != NULL) && (pAtHandle != NULL)) {
             *pAtHandle = pInstance->atHandle;
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -488,15 +534,13 @@ int32_t uCellAtCommandDelayGet(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCodeOrDelayMs = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             errorCodeOrDelayMs = uAtClientDelayGet(pInstance->atHandle);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrDelayMs;
@@ -510,16 +554,14 @@ int32_t uCellAtCommandDelaySet(uDeviceHandle_t cellHandle, int32_t delayMs)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if ((pInstance != NULL) && (delayMs >= 0)) {
             uAtClientDelaySet(pInstance->atHandle, delayMs);
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -538,10 +580,8 @@ int32_t uCellAtCommandTimingGet(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
             if (pDelayMs != NULL) {
@@ -559,7 +599,7 @@ int32_t uCellAtCommandTimingGet(uDeviceHandle_t cellHandle,
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -578,10 +618,8 @@ int32_t uCellAtCommandTimingSet(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
             if (delayMs >= 0) {
@@ -600,7 +638,7 @@ int32_t uCellAtCommandTimingSet(uDeviceHandle_t cellHandle,
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -615,10 +653,8 @@ int32_t uCellAtCommandTimingSetDefault(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
             uAtClientDelaySet(atHandle,
@@ -630,7 +666,7 @@ int32_t uCellAtCommandTimingSetDefault(uDeviceHandle_t cellHandle)
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
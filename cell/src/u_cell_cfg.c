@@ -358,7 +358,8 @@ static int32_t setCops(uAtClientHandle_t atHandle, int32_t cops)
 
 // Get the radio access technology that is being used by
 // the cellular module at the given rank, SARA-U2 style.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+// before this is called.
 static uCellNetRat_t getRatSaraU2(uCellPrivateInstance_t *pInstance,
                                   int32_t rank)
 {
@@ -433,7 +434,8 @@ static uCellNetRat_t getRatSaraU2(uCellPrivateInstance_t *pInstance,
 }
 
 // Get the rank at which the given RAT is being used, SARA-U2 style.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+// before this is called.
 static int32_t getRatRankSaraU2(uCellPrivateInstance_t *pInstance,
                                 uCellNetRat_t rat)
 {
@@ -501,7 +503,8 @@ static int32_t getRatRankSaraU2(uCellPrivateInstance_t *pInstance,
 }
 
 // Set RAT SARA-U2 stylee.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+// before this is called.
 static int32_t setRatSaraU2(uCellPrivateInstance_t *pInstance,
                             uCellNetRat_t rat)
 {
@@ -537,7 +540,8 @@ static int32_t setRatSaraU2(uCellPrivateInstance_t *pInstance,
 }
 
 // Set RAT rank SARA-U2 stylee.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+// before this is called.
 static int32_t setRatRankSaraU2(uCellPrivateInstance_t *pInstance,
                                 uCellNetRat_t rat, int32_t rank)
 {
@@ -714,7 +718,8 @@ static int32_t setRatRankSaraU2(uCellPrivateInstance_t *pInstance,
 
 // Get the radio access technology that is being used by
 // the cellular module at the given rank, SARA-R4/R5/R6 style.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+// before this is called.
 static uCellNetRat_t getRatSaraRx(const uCellPrivateInstance_t *pInstance,
                                   int32_t rank)
 {
@@ -751,7 +756,8 @@ static uCellNetRat_t getRatSaraRx(const uCellPrivateInstance_t *pInstance,
 }
 
 // Get the rank at which the given RAT is being used, SARA-R4/R5/R6 style.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+// before this is called.
 static int32_t getRatRankSaraRx(const uCellPrivateInstance_t *pInstance,
                                 uCellNetRat_t rat)
 {
@@ -779,7 +785,8 @@ static int32_t getRatRankSaraRx(const uCellPrivateInstance_t *pInstance,
 }
 
 // Set RAT SARA-R4/R5/R6 stylee.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+// before this is called.
 static int32_t setRatSaraRx(uCellPrivateInstance_t *pInstance,
                             uCellNetRat_t rat)
 {
@@ -813,7 +820,8 @@ static int32_t setRatSaraRx(uCellPrivateInstance_t *pInstance,
 }
 
 // Set RAT rank SARA-R4/R5/R6 stylee.
-// Note: gUCellPrivateMutex should be locked before this is called.
+// Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+// before this is called.
 static int32_t setRatRankSaraRx(uCellPrivateInstance_t *pInstance,
                                 uCellNetRat_t rat, int32_t rank)
 {
@@ -1124,9 +1132,7 @@ int32_t uCellCfgSetBandMask(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             ((rat == U_CELL_NET_RAT_CATM1) || (rat == U_CELL_NET_RAT_NB1) ||
@@ -1213,7 +1219,7 @@ int32_t uCellCfgSetBandMask(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1237,9 +1243,7 @@ int32_t uCellCfgGetBandMask(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             ((rat == U_CELL_NET_RAT_CATM1) || (rat == U_CELL_NET_RAT_NB1) ||
@@ -1434,7 +1438,7 @@ int32_t uCellCfgGetBandMask(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1450,9 +1454,7 @@ int32_t uCellCfgSetRat(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             (rat > U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED) &&
@@ -1478,7 +1480,7 @@ int32_t uCellCfgSetRat(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1494,9 +1496,7 @@ int32_t uCellCfgSetRatRank(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             /* U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED is allowed here */
@@ -1524,7 +1524,7 @@ int32_t uCellCfgSetRatRank(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1540,9 +1540,7 @@ uCellNetRat_t uCellCfgGetRat(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrRat = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (rank >= 0) &&
             (rank < (int32_t) pInstance->pModule->maxNumSimultaneousRats)) {
@@ -1557,7 +1555,7 @@ uCellNetRat_t uCellCfgGetRat(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return (uCellNetRat_t) errorCodeOrRat;
@@ -1573,9 +1571,7 @@ int32_t uCellCfgGetRatRank(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrRank = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             (rat > U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED) &&
@@ -1600,7 +1596,7 @@ int32_t uCellCfgGetRatRank(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrRank;
@@ -1616,9 +1612,7 @@ int32_t uCellCfgSetMnoProfile(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (mnoProfile >= 0)) {
             errorCode = (int32_t) U_CELL_ERROR_CONNECTED;
@@ -1643,7 +1637,7 @@ int32_t uCellCfgSetMnoProfile(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1659,9 +1653,7 @@ int32_t uCellCfgGetMnoProfile(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrMnoProfile = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -1680,7 +1672,7 @@ int32_t uCellCfgGetMnoProfile(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrMnoProfile;
@@ -1695,9 +1687,7 @@ int32_t uCellCfgSetSerialInterface(uDeviceHandle_t cellHandle, int32_t requested
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
             // Lock mutex before using AT client.
@@ -1715,7 +1705,7 @@ int32_t uCellCfgSetSerialInterface(uDeviceHandle_t cellHandle, int32_t requested
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1729,15 +1719,13 @@ int32_t uCellCfgGetActiveSerialInterface(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrActiveVariant = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrActiveVariant = uCellPrivateGetActiveSerialInterface(pInstance);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrActiveVariant;
@@ -1753,9 +1741,7 @@ int32_t uCellCfgSetUdconf(uDeviceHandle_t cellHandle, int32_t param1,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (param1 >= 0) && (param2 >= 0)) {
             atHandle = pInstance->atHandle;
@@ -1773,7 +1759,7 @@ int32_t uCellCfgSetUdconf(uDeviceHandle_t cellHandle, int32_t param1,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1791,9 +1777,7 @@ int32_t uCellCfgGetUdconf(uDeviceHandle_t cellHandle, int32_t param1,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrUdconf = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (param1 >= 0)) {
             atHandle = pInstance->atHandle;
@@ -1820,7 +1804,7 @@ int32_t uCellCfgGetUdconf(uDeviceHandle_t cellHandle, int32_t param1,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrUdconf;
@@ -1838,9 +1822,7 @@ int32_t uCellCfgFactoryReset(uDeviceHandle_t cellHandle, int32_t fsRestoreType,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
             // Lock mutex before using AT client.
@@ -1861,7 +1843,7 @@ int32_t uCellCfgFactoryReset(uDeviceHandle_t cellHandle, int32_t fsRestoreType,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1879,9 +1861,7 @@ int32_t uCellCfgSetGreeting(uDeviceHandle_t cellHandle, const char *pStr)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
             if (pInstance->pGreetingCallback != NULL) {
@@ -1898,7 +1878,7 @@ int32_t uCellCfgSetGreeting(uDeviceHandle_t cellHandle, const char *pStr)
             errorCode = setGreeting(atHandle, pStr);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1911,7 +1891,7 @@ int32_t uCellCfgSetGreetingCallback(uDeviceHandle_t cellHandle,
                                     void *pCallbackParam)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
     size_t size;
     // +1 for terminator
@@ -1919,11 +1899,9 @@ int32_t uCellCfgSetGreetingCallback(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         if (((pStr != NULL) && (strlen(pStr) <= U_CELL_CFG_GREETING_CALLBACK_MAX_LEN_BYTES)) ||
             (pCallback == NULL)) {
-            pInstance = pUCellPrivateGetInstance(cellHandle);
+            pInstance = pUCellPrivateInstanceLock(cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 // Remove any existing callback
@@ -1949,7 +1927,7 @@ int32_t uCellCfgSetGreetingCallback(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1963,9 +1941,7 @@ int32_t uCellCfgGetGreeting(uDeviceHandle_t cellHandle, char *pStr, size_t size)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if ((pInstance != NULL) && (pStr != NULL)) {
             errorCodeOrSize = getGreeting(pInstance->atHandle, pStr, size);
             if (errorCodeOrSize > 0) {
@@ -1983,7 +1959,7 @@ int32_t uCellCfgGetGreeting(uDeviceHandle_t cellHandle, char *pStr, size_t size)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
@@ -1999,9 +1975,7 @@ int32_t uCellCfgSetAutoBaudOff(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -2023,7 +1997,7 @@ int32_t uCellCfgSetAutoBaudOff(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -2037,9 +2011,7 @@ int32_t uCellCfgSetAutoBaudOn(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -2050,7 +2022,7 @@ int32_t uCellCfgSetAutoBaudOn(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -2068,9 +2040,7 @@ bool uCellCfgAutoBaudIsOn(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if ((pInstance != NULL) &&
             U_CELL_PRIVATE_HAS(pInstance->pModule,
                                U_CELL_PRIVATE_FEATURE_AUTO_BAUDING)) {
@@ -2110,7 +2080,7 @@ bool uCellCfgAutoBaudIsOn(uDeviceHandle_t cellHandle)
             uAtClientUnlock(atHandle);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return autoBaudOn;
@@ -2125,15 +2095,13 @@ int32_t uCellCfgSetGnssProfile(uDeviceHandle_t cellHandle, int32_t profileBitMap
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             errorCode = uCellPrivateSetGnssProfile(pInstance, profileBitMap, pServerName);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -2148,15 +2116,13 @@ int32_t uCellCfgGetGnssProfile(uDeviceHandle_t cellHandle, char *pServerName,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCodeOrBitMap = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             errorCodeOrBitMap = uCellPrivateGetGnssProfile(pInstance, pServerName, sizeBytes);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrBitMap;
@@ -2174,10 +2140,8 @@ int64_t uCellCfgSetTime(uDeviceHandle_t cellHandle, int64_t timeLocal,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         // The format is "yy/MM/dd,hh:mm:ss+TZ" where +TZ is
         // in quarter hours.  First get the time in a struct
         if ((pInstance != NULL) && gmtime_r((const time_t *) &timeLocal, &tmStruct) != NULL) {
@@ -2199,7 +2163,7 @@ int64_t uCellCfgSetTime(uDeviceHandle_t cellHandle, int64_t timeLocal,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
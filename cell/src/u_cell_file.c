@@ -39,6 +39,8 @@
 #include "u_error_common.h"
 #include "u_port.h"
 #include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
 #include "u_at_client.h"
 #include "u_cell_module_type.h"
 #include "u_cell_net.h"
@@ -58,6 +60,204 @@ static uCellPrivateFileListContainer_t *gpFileList = NULL;
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Write (append) data to a file: the guts of uCellFileWrite().
+static int32_t fileWrite(const uCellPrivateInstance_t *pInstance,
+                         const char *pFileName,
+                         const char *pData, size_t dataSize)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    size_t bytesWritten = 0;
+
+    // Do the UDWNFILE thang with the AT interface
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT+UDWNFILE=");
+    // Write file name
+    uAtClientWriteString(atHandle, pFileName, true);
+    // Write size of data to be written into the file
+    uAtClientWriteInt(atHandle, (int32_t) dataSize);
+    if (pInstance->pFileSystemTag != NULL) {
+        // Write tag
+        uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
+    }
+    uAtClientCommandStop(atHandle);
+    // Wait for the prompt
+    if (uAtClientWaitCharacter(atHandle, '>') == 0) {
+        // Allow plenty of time for this to complete
+        uAtClientTimeoutSet(atHandle, 10000);
+        uPortTaskBlock(50);
+        bytesWritten = uAtClientWriteBytes(atHandle, (const char *) pData,
+                                           dataSize, true);
+        // Restore at client timeout to default
+        uAtClientTimeoutSet(atHandle, U_AT_CLIENT_DEFAULT_TIMEOUT_MS);
+        // Grab the response
+        uAtClientCommandStopReadResponse(atHandle);
+        if (uAtClientUnlock(atHandle) == 0) {
+            errorCode = (int32_t) bytesWritten;
+        }
+    } else {
+        // Best to tidy whatever might have arrived instead
+        // of the prompt before exiting
+        uAtClientResponseStop(atHandle);
+        errorCode = uAtClientUnlock(atHandle);
+    }
+
+    return errorCode;
+}
+
+// Read a block of a file: the guts of uCellFileBlockRead().
+static int32_t fileBlockRead(const uCellPrivateInstance_t *pInstance,
+                             const char *pFileName, char *pData,
+                             size_t offset, size_t dataSize)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t readSize = 0;
+    int32_t indicatedReadSize = 0;
+
+    // Do the URDBLOCK thang with the AT interface
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT+URDBLOCK=");
+    // Write file name
+    uAtClientWriteString(atHandle, pFileName, true);
+    // Write offset in bytes from the beginning of the file
+    uAtClientWriteInt(atHandle, (int32_t) offset);
+    // Write size of data to be read from file
+    uAtClientWriteInt(atHandle, (int32_t) dataSize);
+    uAtClientCommandStop(atHandle);
+    // Grab the response
+    if (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
+        // SARA-R4 only puts \n before the
+        // response, not \r\n as it should
+        uAtClientResponseStart(atHandle, "\n+URDBLOCK:");
+    } else {
+        uAtClientResponseStart(atHandle, "+URDBLOCK:");
+    }
+    // Skip the file name
+    uAtClientSkipParameters(atHandle, 1);
+    // Read the size
+    indicatedReadSize = uAtClientReadInt(atHandle);
+    readSize = indicatedReadSize;
+    if (readSize > (int32_t) dataSize) {
+        readSize = (int32_t) dataSize;
+    }
+    // Don't stop for anything!
+    uAtClientIgnoreStopTag(atHandle);
+    // Get the leading quote mark out of the way
+    uAtClientReadBytes(atHandle, NULL, 1, true);
+    // Now read out all the actual data,
+    // first the bit we want
+    readSize = uAtClientReadBytes(atHandle, pData,
+                                  // Cast in two stages to keep Lint happy
+                                  (size_t) (unsigned) readSize,
+                                  true);
+    if (indicatedReadSize > readSize) {
+        //...and then the rest poured away to NULL
+        uAtClientReadBytes(atHandle, NULL,
+                           // Cast in two stages to keep Lint happy
+                           (size_t) (unsigned) (indicatedReadSize - readSize),
+                           true);
+    }
+    // Make sure to wait for the stop tag before
+    // we finish
+    uAtClientRestoreStopTag(atHandle);
+    uAtClientResponseStop(atHandle);
+    if (uAtClientUnlock(atHandle) == 0) {
+        errorCode = readSize;
+    }
+
+    return errorCode;
+}
+
+// Read the size of a file: the guts of uCellFileSize().
+static int32_t fileSizeGet(const uCellPrivateInstance_t *pInstance,
+                           const char *pFileName)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t size;
+
+    // Do the ULSTFILE thang with the AT interface
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT+ULSTFILE=");
+    // Write get file size op_code
+    uAtClientWriteInt(atHandle, 2);
+    // Write file name
+    uAtClientWriteString(atHandle, pFileName, true);
+    if (pInstance->pFileSystemTag != NULL) {
+        // Write tag
+        uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
+    }
+    uAtClientCommandStop(atHandle);
+    // Grab the response
+    uAtClientResponseStart(atHandle, "+ULSTFILE:");
+    // Read file size
+    size = uAtClientReadInt(atHandle);
+    uAtClientResponseStop(atHandle);
+    if (uAtClientUnlock(atHandle) == 0) {
+        errorCode = size;
+    }
+
+    return errorCode;
+}
+
+// Read the file back from the module in blocks, comparing each
+// with the same block of data from pCallback; pBuffer holds the
+// data from pCallback, a second buffer of chunkSizeBytes is
+// allocated here for the data read back from the module.
+static int32_t fileStreamVerify(uDeviceHandle_t cellHandle,
+                                const char *pFileName, size_t size,
+                                int32_t (*pCallback) (uDeviceHandle_t,
+                                                      size_t, char *,
+                                                      size_t, void *),
+                                void *pCallbackParam,
+                                char *pBuffer, size_t chunkSizeBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uCellPrivateInstance_t *pInstance;
+    char *pReadBack;
+    size_t offset = 0;
+    size_t thisSize;
+    int32_t x;
+
+    pReadBack = (char *) pUPortMalloc(chunkSizeBytes);
+    if (pReadBack != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        while ((offset < size) && (errorCode == 0)) {
+            thisSize = size - offset;
+            if (thisSize > chunkSizeBytes) {
+                thisSize = chunkSizeBytes;
+            }
+            x = pCallback(cellHandle, offset, pBuffer, thisSize, pCallbackParam);
+            if (x == (int32_t) thisSize) {
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                pInstance = pUCellPrivateInstanceLock(cellHandle);
+                if (pInstance != NULL) {
+                    x = fileBlockRead(pInstance, pFileName, pReadBack, offset, thisSize);
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    if ((x == (int32_t) thisSize) &&
+                        (memcmp(pBuffer, pReadBack, thisSize) == 0)) {
+                        offset += thisSize;
+                    } else {
+                        if (x >= 0) {
+                            uPortLog("U_CELL_FILE: \"%s\" differs from the source"
+                                     " in the %d byte(s) from offset %d.\n",
+                                     pFileName, (int) thisSize, (int) offset);
+                        }
+                        errorCode = (x < 0) ? x : (int32_t) U_ERROR_COMMON_BAD_DATA;
+                    }
+                }
+                uCellPrivateInstanceUnlock(pInstance);
+            } else {
+                errorCode = (x < 0) ? x : (int32_t) U_ERROR_COMMON_TRUNCATED;
+            }
+        }
+        uPortFree(pReadBack);
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: WORKAROUND FOR LINKER ISSUE
  * -------------------------------------------------------------- */
@@ -79,9 +279,7 @@ int32_t uCellFileSetTag(uDeviceHandle_t cellHandle, const char *pTag)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -92,7 +290,7 @@ int32_t uCellFileSetTag(uDeviceHandle_t cellHandle, const char *pTag)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -106,14 +304,12 @@ const char *pUCellFileGetTag(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance !=  NULL) {
             pFileSystemTag = pInstance->pFileSystemTag;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return pFileSystemTag;
@@ -127,58 +323,139 @@ int32_t uCellFileWrite(uDeviceHandle_t cellHandle,
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
-    size_t bytesWritten = 0;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         // Check parameters
         if ((pInstance != NULL) && (pData !=  NULL) && (pFileName != NULL) &&
             (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH)) {
-            errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
-            atHandle = pInstance->atHandle;
-            // Do the UDWNFILE thang with the AT interface
-            uAtClientLock(atHandle);
-            uAtClientCommandStart(atHandle, "AT+UDWNFILE=");
-            // Write file name
-            uAtClientWriteString(atHandle, pFileName, true);
-            // Write size of data to be written into the file
-            uAtClientWriteInt(atHandle, (int32_t) dataSize);
-            if (pInstance->pFileSystemTag != NULL) {
-                // Write tag
-                uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
+            errorCode = fileWrite(pInstance, pFileName, pData, dataSize);
+        }
+
+        uCellPrivateInstanceUnlock(pInstance);
+    }
+
+    return errorCode;
+}
+
+// Write a file in chunks, pulling the data from a callback.
+int32_t uCellFileWriteStream(uDeviceHandle_t cellHandle,
+                             const char *pFileName,
+                             size_t fileSize,
+                             int32_t (*pCallback) (uDeviceHandle_t cellHandle,
+                                                   size_t offset,
+                                                   char *pBuffer,
+                                                   size_t size,
+                                                   void *pCallbackParam),
+                             void *pCallbackParam,
+                             const uCellFileStreamConfig_t *pConfig)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellFileStreamConfig_t config = {.chunkSizeBytes = U_CELL_FILE_STREAM_CHUNK_SIZE_BYTES,
+                                      .maxRetries = U_CELL_FILE_STREAM_MAX_RETRIES,
+                                      .resume = false,
+                                      .verify = false
+                                     };
+    char *pBuffer = NULL;
+    size_t offset = 0;
+    size_t thisSize;
+    size_t retries = 0;
+    int32_t x;
+    int32_t y;
+
+    if (pConfig != NULL) {
+        config = *pConfig;
+        if (config.chunkSizeBytes == 0) {
+            config.chunkSizeBytes = U_CELL_FILE_STREAM_CHUNK_SIZE_BYTES;
+        }
+    }
+
+    if (gUCellPrivateMutex != NULL) {
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pFileName != NULL) && (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH) &&
+            (pCallback != NULL) && (fileSize <= INT32_MAX)) {
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pBuffer = (char *) pUPortMalloc(config.chunkSizeBytes);
+        }
+        if (pBuffer != NULL) {
+            // Work out where to start from
+            pInstance = pUCellPrivateInstanceLock(cellHandle);
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            if (pInstance != NULL) {
+                errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+                // Block reads don't support tags
+                if (!config.verify || (pInstance->pFileSystemTag == NULL)) {
+                    errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    x = fileSizeGet(pInstance, pFileName);
+                    if (config.resume && (x >= 0) && (x <= (int32_t) fileSize)) {
+                        offset = (size_t) x;
+                        uPortLog("U_CELL_FILE: resuming upload of \"%s\" at byte %d"
+                                 " of %d.\n", pFileName, x, (int32_t) fileSize);
+                    } else if (x >= 0) {
+                        // Since AT+UDWNFILE appends, anything
+                        // that is there must go
+                        errorCodeOrSize = uCellPrivateFileDelete(pInstance, pFileName);
+                    }
+                }
             }
-            uAtClientCommandStop(atHandle);
-            // Wait for the prompt
-            if (uAtClientWaitCharacter(atHandle, '>') == 0) {
-                // Allow plenty of time for this to complete
-                uAtClientTimeoutSet(atHandle, 10000);
-                uPortTaskBlock(50);
-                bytesWritten = uAtClientWriteBytes(atHandle, (const char *) pData,
-                                                   dataSize, true);
-                // Restore at client timeout to default
-                uAtClientTimeoutSet(atHandle, U_AT_CLIENT_DEFAULT_TIMEOUT_MS);
-                // Grab the response
-                uAtClientCommandStopReadResponse(atHandle);
-                if (uAtClientUnlock(atHandle) == 0) {
-                    errorCode = (int32_t) bytesWritten;
+            uCellPrivateInstanceUnlock(pInstance);
+
+            while ((offset < fileSize) && (errorCodeOrSize == 0)) {
+                thisSize = fileSize - offset;
+                if (thisSize > config.chunkSizeBytes) {
+                    thisSize = config.chunkSizeBytes;
+                }
+                // Get the data without holding the instance lock
+                x = pCallback(cellHandle, offset, pBuffer, thisSize, pCallbackParam);
+                if (x == (int32_t) thisSize) {
+                    errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                    pInstance = pUCellPrivateInstanceLock(cellHandle);
+                    if (pInstance != NULL) {
+                        errorCodeOrSize = (int32_t) U_ERROR_COMMON_SUCCESS;
+                        x = fileWrite(pInstance, pFileName, pBuffer, thisSize);
+                        if (x != (int32_t) thisSize) {
+                            // Find out how much of it got there
+                            y = fileSizeGet(pInstance, pFileName);
+                            if ((retries < config.maxRetries) &&
+                                (y >= (int32_t) offset) &&
+                                (y <= (int32_t) (offset + thisSize))) {
+                                uPortLog("U_CELL_FILE: chunk at byte %d of \"%s\" failed"
+                                         " (%d), %d byte(s) of it arrived, resuming.\n",
+                                         (int32_t) offset, pFileName, x,
+                                         y - (int32_t) offset);
+                                offset = (size_t) y;
+                                retries++;
+                            } else {
+                                errorCodeOrSize = (x < 0) ? x : (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                            }
+                        } else {
+                            offset += thisSize;
+                            retries = 0;
+                        }
+                    }
+                    uCellPrivateInstanceUnlock(pInstance);
+                } else {
+                    errorCodeOrSize = (x < 0) ? x : (int32_t) U_ERROR_COMMON_TRUNCATED;
                 }
-            } else {
-                // Best to tidy whatever might have arrived instead
-                // of the prompt before exiting
-                uAtClientResponseStop(atHandle);
-                errorCode = uAtClientUnlock(atHandle);
             }
-        }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+            if ((errorCodeOrSize == 0) && config.verify) {
+                errorCodeOrSize = fileStreamVerify(cellHandle, pFileName, fileSize,
+                                                   pCallback, pCallbackParam,
+                                                   pBuffer, config.chunkSizeBytes);
+            }
+            if (errorCodeOrSize == 0) {
+                errorCodeOrSize = (int32_t) fileSize;
+            }
+
+            uPortFree(pBuffer);
+        }
     }
 
-    return errorCode;
+    return errorCodeOrSize;
 }
 
 // Read data from file.
@@ -195,9 +472,7 @@ int32_t uCellFileRead(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         // Check parameters
         if ((pInstance != NULL) && (pData !=  NULL) && (pFileName != NULL) &&
@@ -256,7 +531,7 @@ int32_t uCellFileRead(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -271,15 +546,10 @@ int32_t uCellFileBlockRead(uDeviceHandle_t cellHandle,
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
-    int32_t readSize = 0;
-    int32_t indicatedReadSize = 0;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         // Check parameters
         if ((pInstance != NULL) && (pData !=  NULL) && (pFileName != NULL) &&
@@ -288,62 +558,12 @@ int32_t uCellFileBlockRead(uDeviceHandle_t cellHandle,
             // Use of tags is not supported by any of the modules
             // we support for block reads
             if (pInstance->pFileSystemTag == NULL) {
-                errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
-                atHandle = pInstance->atHandle;
-                // Do the URDBLOCK thang with the AT interface
-                uAtClientLock(atHandle);
-                uAtClientCommandStart(atHandle, "AT+URDBLOCK=");
-                // Write file name
-                uAtClientWriteString(atHandle, pFileName, true);
-                // Write offset in bytes from the beginning of the file
-                uAtClientWriteInt(atHandle, (int32_t) offset);
-                // Write size of data to be read from file
-                uAtClientWriteInt(atHandle, (int32_t) dataSize);
-                uAtClientCommandStop(atHandle);
-                // Grab the response
-                if (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
-                    // SARA-R4 only puts \n before the
-                    // response, not \r\n as it should
-                    uAtClientResponseStart(atHandle, "\n+URDBLOCK:");
-                } else {
-                    uAtClientResponseStart(atHandle, "+URDBLOCK:");
-                }
-                // Skip the file name
-                uAtClientSkipParameters(atHandle, 1);
-                // Read the size
-                indicatedReadSize = uAtClientReadInt(atHandle);
-                readSize = indicatedReadSize;
-                if (readSize > (int32_t) dataSize) {
-                    readSize = (int32_t) dataSize;
-                }
-                // Don't stop for anything!
-                uAtClientIgnoreStopTag(atHandle);
-                // Get the leading quote mark out of the way
-                uAtClientReadBytes(atHandle, NULL, 1, true);
-                // Now read out all the actual data,
-                // first the bit we want
-                readSize = uAtClientReadBytes(atHandle, pData,
-                                              // Cast in two stages to keep Lint happy
-                                              (size_t) (unsigned) readSize,
-                                              true);
-                if (indicatedReadSize > readSize) {
-                    //...and then the rest poured away to NULL
-                    uAtClientReadBytes(atHandle, NULL,
-                                       // Cast in two stages to keep Lint happy
-                                       (size_t) (unsigned) (indicatedReadSize - readSize),
-                                       true);
-                }
-                // Make sure to wait for the stop tag before
-                // we finish
-                uAtClientRestoreStopTag(atHandle);
-                uAtClientResponseStop(atHandle);
-                if (uAtClientUnlock(atHandle) == 0) {
-                    errorCode = readSize;
-                }
+                errorCode = fileBlockRead(pInstance, pFileName, pData,
+                                          offset, dataSize);
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -355,43 +575,18 @@ int32_t uCellFileSize(uDeviceHandle_t cellHandle,
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
-    int32_t size = 0;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         // Check parameters
         if ((pInstance != NULL) && (pFileName != NULL) &&
             (strlen(pFileName) <= U_CELL_FILE_NAME_MAX_LENGTH)) {
-            errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
-            atHandle = pInstance->atHandle;
-            // Do the ULSTFILE thang with the AT interface
-            uAtClientLock(atHandle);
-            uAtClientCommandStart(atHandle, "AT+ULSTFILE=");
-            // Write get file size op_code
-            uAtClientWriteInt(atHandle, 2);
-            // Write file name
-            uAtClientWriteString(atHandle, pFileName, true);
-            if (pInstance->pFileSystemTag != NULL) {
-                // Write tag
-                uAtClientWriteString(atHandle, pInstance->pFileSystemTag, true);
-            }
-            uAtClientCommandStop(atHandle);
-            // Grab the response
-            uAtClientResponseStart(atHandle, "+ULSTFILE:");
-            // Read file size
-            size = uAtClientReadInt(atHandle);
-            uAtClientResponseStop(atHandle);
-            if (uAtClientUnlock(atHandle) == 0) {
-                errorCode = size;
-            }
+            errorCode = fileSizeGet(pInstance, pFileName);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -406,14 +601,12 @@ int32_t uCellFileDelete(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             errorCode = uCellPrivateFileDelete(pInstance, pFileName);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -450,10 +643,8 @@ int32_t uCellFileListFirst_r(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if ((pInstance != NULL) && (ppRentrant != NULL)) {
             *ppRentrant = NULL;
             errorCode = uCellPrivateFileListFirst(pInstance,
@@ -461,7 +652,7 @@ int32_t uCellFileListFirst_r(uDeviceHandle_t cellHandle,
                                                   pFileName);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
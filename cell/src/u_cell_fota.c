@@ -181,6 +181,12 @@ static void queueFotaStatus(uCellPrivateInstance_t *pInstance,
     uCellPrivateFotaContext_t *pContext = (uCellPrivateFotaContext_t *) pInstance->pFotaContext;
     uCellFotaStatusCallbackParameters_t *pCallback;
 
+    if ((pStatus->type == U_CELL_FOTA_STATUS_TYPE_INSTALL) &&
+        (pStatus->value.install == U_CELL_FOTA_STATUS_INSTALL_SUCCESS)) {
+        // New firmware, so the cached firmware version is no more
+        uCellPrivateIdentityInvalidate(pInstance);
+    }
+
     // Put all the data in a struct and pass a pointer to it to our
     // local callback via the AT client's callback mechanism to decouple
     // it from whatever might have called us.
@@ -317,9 +323,7 @@ int32_t uCellFotaSetStatusCallback(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -395,7 +399,7 @@ int32_t uCellFotaSetStatusCallback(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -66,6 +66,41 @@
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#ifdef U_CFG_GEOFENCE
+// Return the handle of the cellular instance that follows the
+// one with the given handle in the list, or the first one if
+// cellHandle is NULL; NULL is returned at the end of the list
+// or if cellHandle is no longer in the list.  This is used to
+// walk the instances one at a time without holding
+// gUCellPrivateMutex while each is locked.
+static uDeviceHandle_t nextCellHandle(uDeviceHandle_t cellHandle)
+{
+    uDeviceHandle_t nextCellHandle = NULL;
+    uCellPrivateInstance_t *pInstance;
+
+    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+    pInstance = gpUCellPrivateInstanceList;
+    if (cellHandle != NULL) {
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            pInstance = pInstance->pNext;
+        }
+    }
+    if (pInstance != NULL) {
+        nextCellHandle = pInstance->cellHandle;
+    }
+
+    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+    return nextCellHandle;
+}
+#endif
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -83,9 +118,7 @@ int32_t uCellGeofenceSetMaxSpeed(uDeviceHandle_t cellHandle,
     errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             ppFenceContext = (uGeofenceContext_t **) &pInstance->pFenceContext;
@@ -95,7 +128,7 @@ int32_t uCellGeofenceSetMaxSpeed(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 #else
     errorCode = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
@@ -118,9 +151,7 @@ int32_t uCellGeofenceApply(uDeviceHandle_t cellHandle, uGeofence_t *pFence)
     errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pFence != NULL) && (pInstance != NULL)) {
             ppFenceContext = (uGeofenceContext_t **) &pInstance->pFenceContext;
@@ -132,7 +163,7 @@ int32_t uCellGeofenceApply(uDeviceHandle_t cellHandle, uGeofence_t *pFence)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 #else
     errorCode = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
@@ -149,32 +180,33 @@ int32_t uCellGeofenceRemove(uDeviceHandle_t cellHandle, uGeofence_t *pFence)
     int32_t errorCode;
 
 #ifdef U_CFG_GEOFENCE
-    uCellPrivateInstance_t *pInstance = NULL;
+    uCellPrivateInstance_t *pInstance;
+    uDeviceHandle_t thisCellHandle = cellHandle;
 
     errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        if (cellHandle != NULL) {
-            pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (cellHandle == NULL) {
+            // Doing all of them, one at a time
+            thisCellHandle = nextCellHandle(NULL);
         }
-        if ((pInstance != NULL) || (gpUCellPrivateInstanceList == NULL)) {
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-            while (pInstance != NULL) {
+        while (thisCellHandle != NULL) {
+            pInstance = pUCellPrivateInstanceLock(thisCellHandle);
+            if (pInstance != NULL) {
                 errorCode = uGeofenceRemove((uGeofenceContext_t **) &pInstance->pFenceContext,
                                             pFence);
-                // Next instance
-                pInstance = pInstance->pNext;
-                if (cellHandle != NULL) {
-                    // Just doing the one, stop there
-                    pInstance = NULL;
-                }
+            } else if (cellHandle != NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            }
+            uCellPrivateInstanceUnlock(pInstance);
+            // Next instance, if we're doing all of them
+            if (cellHandle != NULL) {
+                thisCellHandle = NULL;
+            } else {
+                thisCellHandle = nextCellHandle(thisCellHandle);
             }
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 #else
     errorCode = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
@@ -200,21 +232,17 @@ int32_t uCellGeofenceSetCallback(uDeviceHandle_t cellHandle,
     errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        if (cellHandle != NULL) {
-            pInstance = pUCellPrivateGetInstance(cellHandle);
-            if (pInstance != NULL) {
-                errorCode = uGeofenceSetCallback((uGeofenceContext_t **) &pInstance->pFenceContext,
-                                                 testType,
-                                                 pessimisticNotOptimistic,
-                                                 pCallback,
-                                                 pCallbackParam);
-            }
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
+        if (pInstance != NULL) {
+            errorCode = uGeofenceSetCallback((uGeofenceContext_t **) &pInstance->pFenceContext,
+                                             testType,
+                                             pessimisticNotOptimistic,
+                                             pCallback,
+                                             pCallbackParam);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 #else
     errorCode = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
@@ -241,44 +269,46 @@ uGeofencePositionState_t uCellGeofencePosition(uDeviceHandle_t cellHandle,
     uGeofencePositionState_t positionState = U_GEOFENCE_POSITION_STATE_NONE;
 
 #ifdef U_CFG_GEOFENCE
-    uCellPrivateInstance_t *pInstance = gpUCellPrivateInstanceList;
+    uCellPrivateInstance_t *pInstance;
+    uDeviceHandle_t thisCellHandle = cellHandle;
     uGeofencePositionState_t instancePositionState;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        if (cellHandle != NULL) {
-            pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (cellHandle == NULL) {
+            // Doing all of them, one at a time
+            thisCellHandle = nextCellHandle(NULL);
         }
-        while (pInstance != NULL) {
-            instancePositionState = uGeofenceContextTest(cellHandle,
-                                                         (uGeofenceContext_t *) pInstance->pFenceContext,
-                                                         testType,
-                                                         pessimisticNotOptimistic,
-                                                         latitudeX1e9,
-                                                         longitudeX1e9,
-                                                         altitudeMillimetres,
-                                                         radiusMillimetres,
-                                                         altitudeUncertaintyMillimetres);
-            if (positionState == U_GEOFENCE_POSITION_STATE_NONE) {
-                // If we've never updated the over all position state, do it now
-                positionState = instancePositionState;
-            }
-            if (instancePositionState == U_GEOFENCE_POSITION_STATE_INSIDE) {
-                // For the over all state, any instance being inside a fence is
-                // "inside", make it stick
-                positionState = instancePositionState;
+        while (thisCellHandle != NULL) {
+            pInstance = pUCellPrivateInstanceLock(thisCellHandle);
+            if (pInstance != NULL) {
+                instancePositionState = uGeofenceContextTest(cellHandle,
+                                                             (uGeofenceContext_t *) pInstance->pFenceContext,
+                                                             testType,
+                                                             pessimisticNotOptimistic,
+                                                             latitudeX1e9,
+                                                             longitudeX1e9,
+                                                             altitudeMillimetres,
+                                                             radiusMillimetres,
+                                                             altitudeUncertaintyMillimetres);
+                if (positionState == U_GEOFENCE_POSITION_STATE_NONE) {
+                    // If we've never updated the over all position state, do it now
+                    positionState = instancePositionState;
+                }
+                if (instancePositionState == U_GEOFENCE_POSITION_STATE_INSIDE) {
+                    // For the over all state, any instance being inside a fence is
+                    // "inside", make it stick
+                    positionState = instancePositionState;
+                }
             }
-            // Next instance
-            pInstance = pInstance->pNext;
+            uCellPrivateInstanceUnlock(pInstance);
+            // Next instance, if we're doing all of them
             if (cellHandle != NULL) {
-                // Just doing the one, stop there
-                pInstance = NULL;
+                thisCellHandle = NULL;
+            } else {
+                thisCellHandle = nextCellHandle(thisCellHandle);
             }
         }
-
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
     }
 #else
     (void) cellHandle;
@@ -77,7 +77,8 @@
  */
 #define U_CELL_HTTP_ENTRY_FUNCTION(cellHandle, httpHandle, ppCellInstance, \
                                    ppHttpInstance, pErrorCode) \
-                                   { entryFunction(cellHandle, \
+                                   { const uCellPrivateInstance_t *pLockedInstance; \
+                                     pLockedInstance = entryFunction(cellHandle, \
                                                    httpHandle, \
                                                    ppCellInstance, \
                                                    ppHttpInstance, \
@@ -86,7 +87,7 @@
 /** Helper macro to make sure that the entry and exit functions
  * are always called.
  */
-#define U_CELL_HTTP_EXIT_FUNCTION() } exitFunction()
+#define U_CELL_HTTP_EXIT_FUNCTION() exitFunction(pLockedInstance); }
 
 #ifndef U_CELL_HTTP_SERVER_NAME_MAX_LEN_BYTES
 /** The maximum length of the HTTP server name on any module (not
@@ -192,8 +193,9 @@ static uCellHttpInstance_t *pFindHttpInstance(uCellPrivateInstance_t *pCellInsta
 // this function directly.  ppCellInstance and ppHttpInstance will
 // be populated if non-NULL; if they cannot be populated an error
 // will be returned. Set ppHttpInstance to NULL if this is being
-// called from uCellHttpOpen().
-static void entryFunction(uDeviceHandle_t cellHandle,
+// called from uCellHttpOpen().  Returns the instance that was
+// locked, which must be passed to exitFunction().
+static const uCellPrivateInstance_t *entryFunction(uDeviceHandle_t cellHandle,
                           int32_t httpHandle,
                           uCellPrivateInstance_t **ppCellInstance,
                           uCellHttpInstance_t **ppHttpInstance,
@@ -204,9 +206,7 @@ static void entryFunction(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        uPortMutexLock(gUCellPrivateMutex);
-
-        pCellInstance = pUCellPrivateGetInstance(cellHandle);
+        pCellInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pCellInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_CELL_PRIVATE_HAS(pCellInstance->pModule,
@@ -229,17 +229,17 @@ static void entryFunction(uDeviceHandle_t cellHandle,
     if (pErrorCode != NULL) {
         *pErrorCode = errorCode;
     }
+
+    return pCellInstance;
 }
 
 // MUST be called at the end of every API function to unlock
-// the cellular mutex; use the helper macro
+// the cellular instance; use the helper macro
 // U_CELL_HTTP_EXIT_FUNCTION to be sure of this, rather than calling
 // this function directly.
-static void exitFunction()
+static void exitFunction(const uCellPrivateInstance_t *pLockedInstance)
 {
-    if (gUCellPrivateMutex != NULL) {
-        uPortMutexUnlock(gUCellPrivateMutex);
-    }
+    uCellPrivateInstanceUnlock(pLockedInstance);
 }
 
 // Perform an AT+UHTTP operation that has a string parameter
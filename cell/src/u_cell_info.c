@@ -47,6 +47,7 @@
 #include "u_port_clib_mktime64.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_port_heap.h"
 #include "u_port_uart.h"
 
 #include "u_at_client.h"
@@ -68,10 +69,39 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The identity cache of an instance, hooked into pIdentityContext.
+ */
+typedef struct {
+    uCellInfoIdentity_t identity; /**< The cached values; fingerprint is
+                                       not used here. */
+    int32_t generation; /**< The identityGeneration of the instance
+                             that identity belongs to. */
+} uCellInfoIdentityContext_t;
+
+/** Where to find a field of uCellInfoIdentity_t.
+ */
+typedef struct {
+    size_t offset; /**< The offset of the field in uCellInfoIdentity_t. */
+    size_t size;   /**< The size of the field, including room for
+                        a null terminator. */
+} uCellInfoIdentityFieldLocation_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** The location of each of the fields of uCellInfoIdentity_t,
+ * indexed by uCellInfoIdentityField_t.
+ */
+static const uCellInfoIdentityFieldLocation_t gIdentityFieldLocation[] = {
+    {offsetof(uCellInfoIdentity_t, imei), U_CELL_INFO_IMEI_SIZE + 1},
+    {offsetof(uCellInfoIdentity_t, imsi), U_CELL_INFO_IMSI_SIZE + 1},
+    {offsetof(uCellInfoIdentity_t, iccid), U_CELL_INFO_ICCID_BUFFER_SIZE},
+    {offsetof(uCellInfoIdentity_t, manufacturer), U_CELL_INFO_IDENTITY_STR_BUFFER_SIZE},
+    {offsetof(uCellInfoIdentity_t, model), U_CELL_INFO_IDENTITY_STR_BUFFER_SIZE},
+    {offsetof(uCellInfoIdentity_t, firmwareVersion), U_CELL_INFO_IDENTITY_STR_BUFFER_SIZE}
+};
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -620,9 +650,7 @@ int32_t getCellId(uDeviceHandle_t cellHandle, bool logicalNotPhysical)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrValue = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             if (logicalNotPhysical) {
@@ -635,12 +663,209 @@ int32_t getCellId(uDeviceHandle_t cellHandle, bool logicalNotPhysical)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrValue;
 }
 
+// Return a pointer to a field of an identity structure.
+static char *pIdentityField(uCellInfoIdentity_t *pIdentity,
+                            uCellInfoIdentityField_t field)
+{
+    return ((char *) pIdentity) + gIdentityFieldLocation[field].offset;
+}
+
+// As pIdentityField() but const.
+static const char *pIdentityFieldConst(const uCellInfoIdentity_t *pIdentity,
+                                       uCellInfoIdentityField_t field)
+{
+    return ((const char *) pIdentity) + gIdentityFieldLocation[field].offset;
+}
+
+// Compute the fingerprint of an identity structure: FNV-1a over
+// the strings (which need not be terminated, hence strnlen-style
+// bounding) and the valid bit-map.
+static uint32_t identityFingerprint(const uCellInfoIdentity_t *pIdentity)
+{
+    uint32_t hash = 2166136261UL;
+    const char *pField;
+    size_t size;
+
+    for (size_t x = 0; x < U_CELL_INFO_IDENTITY_FIELD_MAX_NUM; x++) {
+        pField = pIdentityFieldConst(pIdentity, (uCellInfoIdentityField_t) x);
+        size = gIdentityFieldLocation[x].size;
+        // Include the terminator, or a zero if there isn't one,
+        // so that the field boundaries count
+        for (size_t y = 0; y < size; y++) {
+            hash = (hash ^ (uint8_t) pField[y]) * 16777619UL;
+            if (pField[y] == 0) {
+                break;
+            }
+        }
+        if ((size > 0) && (pField[size - 1] != 0)) {
+            hash = hash * 16777619UL;
+        }
+    }
+    for (size_t x = 0; x < sizeof(pIdentity->validBitMap); x++) {
+        hash = (hash ^ ((pIdentity->validBitMap >> (x * 8)) & 0xFF)) * 16777619UL;
+    }
+
+    return hash;
+}
+
+// Get the identity cache of an instance, allocating it if
+// necessary and emptying it if it has been invalidated since
+// it was filled.  May return NULL if there is no memory, in
+// which case the caller will just have to read the module.
+static uCellInfoIdentityContext_t *pIdentityContextGet(uCellPrivateInstance_t *pInstance)
+{
+    uCellInfoIdentityContext_t *pContext = (uCellInfoIdentityContext_t *) pInstance->pIdentityContext;
+
+    if (pContext == NULL) {
+        pContext = (uCellInfoIdentityContext_t *) pUPortMalloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            memset(pContext, 0, sizeof(*pContext));
+            pContext->generation = pInstance->identityGeneration;
+            pInstance->pIdentityContext = pContext;
+        }
+    } else if (pContext->generation != pInstance->identityGeneration) {
+        memset(&(pContext->identity), 0, sizeof(pContext->identity));
+        pContext->generation = pInstance->identityGeneration;
+    }
+
+    return pContext;
+}
+
+// Read one identity field from the module into pStr, which has
+// room for size bytes, always null-terminating it; returns the
+// length of the string or negative error code.
+static int32_t identityRead(const uCellPrivateInstance_t *pInstance,
+                            uCellInfoIdentityField_t field,
+                            char *pStr, size_t size)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    int32_t bytesRead;
+
+    switch (field) {
+        case U_CELL_INFO_IDENTITY_FIELD_IMEI:
+            // size is always U_CELL_INFO_IMEI_SIZE + 1 here
+            errorCodeOrSize = uCellPrivateGetImei(pInstance, pStr);
+            if (errorCodeOrSize == 0) {
+                *(pStr + U_CELL_INFO_IMEI_SIZE) = 0;
+                errorCodeOrSize = U_CELL_INFO_IMEI_SIZE;
+            }
+            break;
+        case U_CELL_INFO_IDENTITY_FIELD_IMSI:
+            // size is always U_CELL_INFO_IMSI_SIZE + 1 here
+            errorCodeOrSize = uCellPrivateGetImsi(pInstance, pStr);
+            if (errorCodeOrSize == 0) {
+                *(pStr + U_CELL_INFO_IMSI_SIZE) = 0;
+                errorCodeOrSize = U_CELL_INFO_IMSI_SIZE;
+            }
+            break;
+        case U_CELL_INFO_IDENTITY_FIELD_ICCID:
+            uAtClientLock(atHandle);
+            uAtClientCommandStart(atHandle, "AT+CCID");
+            uAtClientCommandStop(atHandle);
+            uAtClientResponseStart(atHandle, "+CCID:");
+            bytesRead = uAtClientReadString(atHandle, pStr, size, false);
+            uAtClientResponseStop(atHandle);
+            errorCodeOrSize = uAtClientUnlock(atHandle);
+            if ((bytesRead >= 0) && (errorCodeOrSize == 0)) {
+                errorCodeOrSize = bytesRead;
+            } else {
+                errorCodeOrSize = (int32_t) U_CELL_ERROR_AT;
+            }
+            break;
+        case U_CELL_INFO_IDENTITY_FIELD_MANUFACTURER:
+            errorCodeOrSize = uCellPrivateGetIdStr(atHandle, "AT+CGMI",
+                                                   pStr, size);
+            break;
+        case U_CELL_INFO_IDENTITY_FIELD_MODEL:
+            errorCodeOrSize = uCellPrivateGetIdStr(atHandle, "AT+CGMM",
+                                                   pStr, size);
+            break;
+        case U_CELL_INFO_IDENTITY_FIELD_FIRMWARE_VERSION:
+            // Use ATI9 instead of AT+CGMR as it contains more information
+            errorCodeOrSize = uCellPrivateGetIdStr(atHandle, "ATI9",
+                                                   pStr, size);
+            break;
+        default:
+            break;
+    }
+
+    return errorCodeOrSize;
+}
+
+// Get one identity field, from the cache if it is there, else
+// from the module, caching what was read.  pStr must have room
+// for the field as sized in gIdentityFieldLocation[]; the string
+// written there is always null-terminated.  Returns the length
+// of the string or negative error code.
+static int32_t identityGet(uCellPrivateInstance_t *pInstance,
+                           uCellInfoIdentityField_t field, char *pStr)
+{
+    int32_t errorCodeOrSize;
+    uCellInfoIdentityContext_t *pContext = pIdentityContextGet(pInstance);
+    size_t size = gIdentityFieldLocation[field].size;
+    int32_t generation = pInstance->identityGeneration;
+    char *pCached;
+
+    if ((pContext != NULL) && (pContext->identity.validBitMap & (1UL << field))) {
+        pCached = pIdentityField(&(pContext->identity), field);
+        errorCodeOrSize = (int32_t) strlen(pCached);
+        memcpy(pStr, pCached, errorCodeOrSize + 1);
+    } else {
+        errorCodeOrSize = identityRead(pInstance, field, pStr, size);
+        // Only cache what was read if nothing has happened in the
+        // meantime and, for the free-form strings, if it might not
+        // have been truncated
+        if ((errorCodeOrSize >= 0) && (pContext != NULL) &&
+            (pInstance->identityGeneration == generation) &&
+            ((field < U_CELL_INFO_IDENTITY_FIELD_MANUFACTURER) ||
+             (errorCodeOrSize < (int32_t) size - 1))) {
+            pCached = pIdentityField(&(pContext->identity), field);
+            memcpy(pCached, pStr, errorCodeOrSize + 1);
+            pContext->identity.validBitMap |= 1UL << field;
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
+// Get one identity field as a string into a user buffer of the
+// given size, in the same way as uCellPrivateGetIdStr(), i.e.
+// truncating to fit; returns the length copied or negative error
+// code.
+static int32_t identityGetStr(uCellPrivateInstance_t *pInstance,
+                              uCellInfoIdentityField_t field,
+                              char *pStr, size_t size)
+{
+    int32_t errorCodeOrSize;
+    char buffer[U_CELL_INFO_IDENTITY_STR_BUFFER_SIZE];
+    size_t fieldSize = gIdentityFieldLocation[field].size;
+
+    errorCodeOrSize = identityGet(pInstance, field, buffer);
+    if (errorCodeOrSize >= 0) {
+        if ((field >= U_CELL_INFO_IDENTITY_FIELD_MANUFACTURER) &&
+            (errorCodeOrSize >= (int32_t) fieldSize - 1) && (size > fieldSize)) {
+            // Might have been truncated and the caller has more
+            // room than we do: read it again directly
+            errorCodeOrSize = identityRead(pInstance, field, pStr, size);
+        } else {
+            if (errorCodeOrSize > (int32_t) size - 1) {
+                errorCodeOrSize = (int32_t) size - 1;
+            }
+            memcpy(pStr, buffer, errorCodeOrSize);
+            *(pStr + errorCodeOrSize) = 0;
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -656,9 +881,7 @@ int32_t uCellInfoRefreshRadioParameters(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
@@ -727,7 +950,7 @@ int32_t uCellInfoRefreshRadioParameters(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -742,14 +965,12 @@ int32_t uCellInfoGetRssiDbm(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             errorCodeOrValue = pInstance->radioParameters.rssiDbm;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrValue;
@@ -764,15 +985,13 @@ int32_t uCellInfoGetRsrpDbm(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if ((pInstance != NULL) &&
             (pInstance->pModule->moduleType != U_CELL_MODULE_TYPE_LENA_R8)) {
             errorCodeOrValue = pInstance->radioParameters.rsrpDbm;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrValue;
@@ -788,15 +1007,13 @@ int32_t uCellInfoGetRsrqDb(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if ((pInstance != NULL) &&
             (pInstance->pModule->moduleType != U_CELL_MODULE_TYPE_LENA_R8)) {
             errorCodeOrValue = pInstance->radioParameters.rsrqDb;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrValue;
@@ -810,15 +1027,13 @@ int32_t uCellInfoGetRxQual(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrValue = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrValue = pInstance->radioParameters.rxQual;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrValue;
@@ -886,9 +1101,7 @@ int32_t uCellInfoGetSnrDb(uDeviceHandle_t cellHandle, int32_t *pSnrDb)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pSnrDb != NULL)) {
             pRadioParameters = &(pInstance->radioParameters);
@@ -928,7 +1141,7 @@ int32_t uCellInfoGetSnrDb(uDeviceHandle_t cellHandle, int32_t *pSnrDb)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -942,9 +1155,7 @@ U_DEPRECATED int32_t uCellInfoGetCellId(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrValue = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             if ((pInstance->radioParameters.cellIdPhysical >= 0) &&
@@ -955,7 +1166,7 @@ U_DEPRECATED int32_t uCellInfoGetCellId(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrValue;
@@ -981,9 +1192,7 @@ int32_t uCellInfoGetEarfcn(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrValue = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrValue = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -992,7 +1201,7 @@ int32_t uCellInfoGetEarfcn(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrValue;
@@ -1004,16 +1213,18 @@ int32_t uCellInfoGetImei(uDeviceHandle_t cellHandle,
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
+    char buffer[U_CELL_INFO_IMEI_SIZE + 1];
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pImei != NULL)) {
-            errorCode = uCellPrivateGetImei(pInstance, pImei);
-            if (errorCode == 0) {
+            errorCode = identityGet(pInstance, U_CELL_INFO_IDENTITY_FIELD_IMEI,
+                                    buffer);
+            if (errorCode >= 0) {
+                errorCode = 0;
+                memcpy(pImei, buffer, U_CELL_INFO_IMEI_SIZE);
                 uPortLog("U_CELL_INFO: IMEI is %.*s.\n",
                          U_CELL_INFO_IMEI_SIZE, pImei);
             } else {
@@ -1021,7 +1232,7 @@ int32_t uCellInfoGetImei(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1033,16 +1244,18 @@ int32_t uCellInfoGetImsi(uDeviceHandle_t cellHandle,
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
+    char buffer[U_CELL_INFO_IMSI_SIZE + 1];
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pImsi != NULL)) {
-            errorCode = uCellPrivateGetImsi(pInstance, pImsi);
-            if (errorCode == 0) {
+            errorCode = identityGet(pInstance, U_CELL_INFO_IDENTITY_FIELD_IMSI,
+                                    buffer);
+            if (errorCode >= 0) {
+                errorCode = 0;
+                memcpy(pImsi, buffer, U_CELL_INFO_IMSI_SIZE);
                 uPortLog("U_CELL_INFO: IMSI is %.*s.\n",
                          U_CELL_INFO_IMSI_SIZE, pImsi);
             } else {
@@ -1050,7 +1263,7 @@ int32_t uCellInfoGetImsi(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1062,34 +1275,23 @@ int32_t uCellInfoGetIccidStr(uDeviceHandle_t cellHandle,
 {
     int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance;
-    uAtClientHandle_t atHandle;
-    int32_t bytesRead;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
-            atHandle = pInstance->atHandle;
-            uAtClientLock(atHandle);
-            uAtClientCommandStart(atHandle, "AT+CCID");
-            uAtClientCommandStop(atHandle);
-            uAtClientResponseStart(atHandle, "+CCID:");
-            bytesRead = uAtClientReadString(atHandle, pStr, size, false);
-            uAtClientResponseStop(atHandle);
-            errorCodeOrSize = uAtClientUnlock(atHandle);
-            if ((bytesRead >= 0) && (errorCodeOrSize == 0)) {
-                errorCodeOrSize = bytesRead;
+            errorCodeOrSize = identityGetStr(pInstance,
+                                             U_CELL_INFO_IDENTITY_FIELD_ICCID,
+                                             pStr, size);
+            if (errorCodeOrSize >= 0) {
                 uPortLog("U_CELL_INFO: ICCID is %s.\n", pStr);
             } else {
-                errorCodeOrSize = (int32_t) U_CELL_ERROR_AT;
                 uPortLog("U_CELL_INFO: unable to read ICCID.\n");
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
@@ -1104,16 +1306,15 @@ int32_t uCellInfoGetManufacturerStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
-            errorCodeOrSize = uCellPrivateGetIdStr(pInstance->atHandle, "AT+CGMI",
-                                                   pStr, size);
+            errorCodeOrSize = identityGetStr(pInstance,
+                                             U_CELL_INFO_IDENTITY_FIELD_MANUFACTURER,
+                                             pStr, size);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
@@ -1128,16 +1329,15 @@ int32_t uCellInfoGetModelStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
-            errorCodeOrSize = uCellPrivateGetIdStr(pInstance->atHandle, "AT+CGMM",
-                                                   pStr, size);
+            errorCodeOrSize = identityGetStr(pInstance,
+                                             U_CELL_INFO_IDENTITY_FIELD_MODEL,
+                                             pStr, size);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
@@ -1152,22 +1352,152 @@ int32_t uCellInfoGetFirmwareVersionStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
-            // Use ATI9 instead of AT+CGMR as it contains more information
-            errorCodeOrSize = uCellPrivateGetIdStr(pInstance->atHandle, "ATI9",
-                                                   pStr, size);
+            errorCodeOrSize = identityGetStr(pInstance,
+                                             U_CELL_INFO_IDENTITY_FIELD_FIRMWARE_VERSION,
+                                             pStr, size);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
 }
 
+// Get a snapshot of the identity of the module and its SIM.
+int32_t uCellInfoGetIdentity(uDeviceHandle_t cellHandle,
+                             uCellInfoIdentity_t *pIdentity)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    int32_t x;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pIdentity != NULL)) {
+            memset(pIdentity, 0, sizeof(*pIdentity));
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            for (size_t y = 0; y < U_CELL_INFO_IDENTITY_FIELD_MAX_NUM; y++) {
+                x = identityGet(pInstance, (uCellInfoIdentityField_t) y,
+                                pIdentityField(pIdentity, (uCellInfoIdentityField_t) y));
+                if (x >= 0) {
+                    pIdentity->validBitMap |= 1UL << y;
+                } else {
+                    // Keep going, report the first error
+                    memset(pIdentityField(pIdentity, (uCellInfoIdentityField_t) y), 0,
+                           gIdentityFieldLocation[y].size);
+                    if (errorCode == 0) {
+                        errorCode = x;
+                    }
+                }
+            }
+            pIdentity->fingerprint = identityFingerprint(pIdentity);
+        }
+
+        uCellPrivateInstanceUnlock(pInstance);
+    }
+
+    return errorCode;
+}
+
+// Restore the identity cache from a snapshot.
+int32_t uCellInfoIdentityRestore(uDeviceHandle_t cellHandle,
+                                 const uCellInfoIdentity_t *pIdentity)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellInfoIdentityContext_t *pContext;
+    uCellInfoIdentityField_t field;
+    uint32_t checkBitMap = (1UL << U_CELL_INFO_IDENTITY_FIELD_IMEI) |
+                           (1UL << U_CELL_INFO_IDENTITY_FIELD_FIRMWARE_VERSION);
+    uint32_t adoptBitMap;
+    int32_t generation;
+    char buffer[U_CELL_INFO_IDENTITY_STR_BUFFER_SIZE];
+    char *pField;
+    size_t size;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pIdentity != NULL) &&
+            ((pIdentity->validBitMap & checkBitMap) == checkBitMap) &&
+            (identityFingerprint(pIdentity) == pIdentity->fingerprint)) {
+            adoptBitMap = pIdentity->validBitMap &
+                          ((1UL << U_CELL_INFO_IDENTITY_FIELD_MAX_NUM) - 1);
+            if (adoptBitMap & (1UL << U_CELL_INFO_IDENTITY_FIELD_ICCID)) {
+                checkBitMap |= 1UL << U_CELL_INFO_IDENTITY_FIELD_ICCID;
+            } else {
+                // Can't tell if the IMSI is for the SIM that is present
+                adoptBitMap &= ~(1UL << U_CELL_INFO_IDENTITY_FIELD_IMSI);
+            }
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pContext = pIdentityContextGet(pInstance);
+            if (pContext != NULL) {
+                generation = pContext->generation;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                // Check against the module the fields that identify it
+                for (size_t x = 0; (x < U_CELL_INFO_IDENTITY_FIELD_MAX_NUM) &&
+                     (errorCode == 0); x++) {
+                    field = (uCellInfoIdentityField_t) x;
+                    if (checkBitMap & (1UL << x)) {
+                        errorCode = identityGet(pInstance, field, buffer);
+                        if ((errorCode >= 0) &&
+                            (strncmp(buffer, pIdentityFieldConst(pIdentity, field),
+                                     gIdentityFieldLocation[x].size) == 0)) {
+                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                        } else if (errorCode >= 0) {
+                            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+                        }
+                    }
+                }
+                if ((errorCode == 0) && (pInstance->identityGeneration == generation)) {
+                    for (size_t x = 0; x < U_CELL_INFO_IDENTITY_FIELD_MAX_NUM; x++) {
+                        field = (uCellInfoIdentityField_t) x;
+                        if (adoptBitMap & (1UL << x)) {
+                            pField = pIdentityField(&(pContext->identity), field);
+                            size = gIdentityFieldLocation[x].size;
+                            memcpy(pField, pIdentityFieldConst(pIdentity, field), size);
+                            *(pField + size - 1) = 0;
+                            pContext->identity.validBitMap |= 1UL << x;
+                        }
+                    }
+                    uPortLog("U_CELL_INFO: identity restored.\n");
+                }
+            }
+        }
+
+        uCellPrivateInstanceUnlock(pInstance);
+    }
+
+    return errorCode;
+}
+
+// Empty the identity cache.
+int32_t uCellInfoIdentityInvalidate(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            uCellPrivateIdentityInvalidate(pInstance);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        uCellPrivateInstanceUnlock(pInstance);
+    }
+
+    return errorCode;
+}
+
 // Get the UTC time according to cellular.
 int64_t uCellInfoGetTimeUtc(uDeviceHandle_t cellHandle)
 {
@@ -1177,9 +1507,7 @@ int64_t uCellInfoGetTimeUtc(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrUtcTime = (int64_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrUtcTime = getTimeAndTimeZone(pInstance->atHandle,
@@ -1189,7 +1517,7 @@ int64_t uCellInfoGetTimeUtc(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrUtcTime;
@@ -1211,9 +1539,7 @@ int32_t uCellInfoGetTimeUtcStr(uDeviceHandle_t cellHandle, char *pStr, size_t si
 
     if (gUCellPrivateMutex != NULL && sizeOrErrorCode == 0) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -1235,7 +1561,7 @@ int32_t uCellInfoGetTimeUtcStr(uDeviceHandle_t cellHandle, char *pStr, size_t si
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return sizeOrErrorCode;
@@ -1250,9 +1576,7 @@ int64_t uCellInfoGetTime(uDeviceHandle_t cellHandle, int32_t *pTimeZoneSeconds)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrTime = (int64_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrTime = getTimeAndTimeZone(pInstance->atHandle,
@@ -1262,7 +1586,7 @@ int64_t uCellInfoGetTime(uDeviceHandle_t cellHandle, int32_t *pTimeZoneSeconds)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrTime;
@@ -1278,9 +1602,7 @@ bool uCellInfoIsRtsFlowControlEnabled(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             uAtClientStreamGetExt(pInstance->atHandle, &stream);
             switch (stream.type) {
@@ -1296,7 +1618,7 @@ bool uCellInfoIsRtsFlowControlEnabled(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return isEnabled;
@@ -1312,9 +1634,7 @@ bool uCellInfoIsCtsFlowControlEnabled(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             uAtClientStreamGetExt(pInstance->atHandle, &stream);
             switch (stream.type) {
@@ -1330,7 +1650,7 @@ bool uCellInfoIsCtsFlowControlEnabled(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return isEnabled;
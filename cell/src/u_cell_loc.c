@@ -80,14 +80,15 @@
  * are always called.
  */
 #define U_CELL_LOC_ENTRY_FUNCTION(cellHandle, ppInstance, pErrorCode) \
-                                  { entryFunction(cellHandle, \
-                                                  ppInstance, \
-                                                  pErrorCode)
+                                  { const uCellPrivateInstance_t *pLockedInstance; \
+                                    pLockedInstance = entryFunction(cellHandle, \
+                                                                    ppInstance, \
+                                                                    pErrorCode)
 
 /** Helper macro to make sure that the entry and exit functions
  * are always called.
  */
-#define U_CELL_LOC_EXIT_FUNCTION() } exitFunction()
+#define U_CELL_LOC_EXIT_FUNCTION() exitFunction(pLockedInstance); }
 
 #ifndef U_CELL_LOC_MIN_UTC_TIME
 /** If cell locate is unable to establish a location it will
@@ -606,7 +607,8 @@ static void UULOCIND_urc(uAtClientHandle_t atHandle, void *pParam)
  * -------------------------------------------------------------- */
 
 // Ensure that there is a location context.
-// gUCellPrivateMutex should be locked before this is called.
+// The instance should be locked, see pUCellPrivateInstanceLock(),
+// before this is called.
 static int32_t ensureContext(uCellPrivateInstance_t *pInstance)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -641,20 +643,19 @@ static int32_t ensureContext(uCellPrivateInstance_t *pInstance)
 // Check all the basics and lock the mutex, MUST be called
 // at the start of every API function; use the helper macro
 // U_CELL_LOC_ENTRY_FUNCTION to be sure of this, rather than
-// calling this function directly.
-static void entryFunction(uDeviceHandle_t cellHandle,
-                          uCellPrivateInstance_t **ppInstance,
-                          int32_t *pErrorCode)
+// calling this function directly.  Returns the instance that
+// was locked, which must be passed to exitFunction().
+static const uCellPrivateInstance_t *entryFunction(uDeviceHandle_t cellHandle,
+                                                   uCellPrivateInstance_t **ppInstance,
+                                                   int32_t *pErrorCode)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uCellPrivateInstance_t *pInstance = NULL;
 
     if (gUCellPrivateMutex != NULL) {
 
-        uPortMutexLock(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             errorCode = ensureContext(pInstance);
         }
@@ -666,17 +667,17 @@ static void entryFunction(uDeviceHandle_t cellHandle,
     if (pErrorCode != NULL) {
         *pErrorCode = errorCode;
     }
+
+    return pInstance;
 }
 
 // MUST be called at the end of every API function to unlock
-// the cellular mutex; use the helper macro
+// the cellular instance; use the helper macro
 // U_CELL_LOC_EXIT_FUNCTION to be sure of this, rather than
 // calling this function directly.
-static void exitFunction()
+static void exitFunction(const uCellPrivateInstance_t *pLockedInstance)
 {
-    if (gUCellPrivateMutex != NULL) {
-        uPortMutexUnlock(gUCellPrivateMutex);
-    }
+    uCellPrivateInstanceUnlock(pLockedInstance);
 }
 
 // Set the pin of the module that is used for the
@@ -1290,14 +1291,12 @@ bool uCellLocGnssInsideCell(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             isInside = uCellPrivateGnssInsideCell(pInstance);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return isInside;
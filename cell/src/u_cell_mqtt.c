@@ -93,15 +93,16 @@
  * are always called.
  */
 #define U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, ppInstance, pErrorCode, mustBeInitialised) \
-                                   { entryFunction(cellHandle, \
-                                                   ppInstance, \
-                                                   pErrorCode, \
-                                                   mustBeInitialised)
+                                   { const uCellPrivateInstance_t *pLockedInstance; \
+                                     pLockedInstance = entryFunction(cellHandle, \
+                                                                     ppInstance, \
+                                                                     pErrorCode, \
+                                                                     mustBeInitialised)
 
 /** Helper macro to make sure that the entry and exit functions
  * are always called.
  */
-#define U_CELL_MQTT_EXIT_FUNCTION() } exitFunction()
+#define U_CELL_MQTT_EXIT_FUNCTION() exitFunction(pLockedInstance); }
 
 /** Flag bits for the flags field in uCellMqttUrcStatus_t.
  */
@@ -380,12 +381,12 @@ static void disconnectCallback(uAtClientHandle_t atHandle, void *pParam)
 
     (void) atHandle;
 
-    // Lock the mutex so that we are thread-safe
+    // Lock the instance so that we are thread-safe
     // while retrieving the last MQTT error code and
     // while we populate the parameters for the callback
-    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-    pInstance = (const uCellPrivateInstance_t *) pParam;
+    if (pParam != NULL) {
+        pInstance = pUCellPrivateInstanceLock(((const uCellPrivateInstance_t *) pParam)->cellHandle);
+    }
     if (pInstance != NULL) {
         pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
         if (pContext != NULL) {
@@ -395,7 +396,7 @@ static void disconnectCallback(uAtClientHandle_t atHandle, void *pParam)
         }
     }
 
-    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    uCellPrivateInstanceUnlock(pInstance);
 
     // Now call the callback outside the mutex lock
     if (pDisconnectCallback != NULL) {
@@ -848,21 +849,22 @@ static void UUMQTT_urc(uAtClientHandle_t atHandle,
 // may be NULL.  This latter case is only useful when this function
 // is called from uCellMqttInit(), normally you want to call this
 // function with mustBeInitialised set to true.  In all cases the
-// cellular mutex will be locked.
-static void entryFunction(uDeviceHandle_t cellHandle,
-                          uCellPrivateInstance_t **ppInstance,
-                          int32_t *pErrorCode,
-                          bool mustBeInitialised)
+// cellular instance, if found, will be locked and is returned so
+// that it can be passed to exitFunction().
+static const uCellPrivateInstance_t *entryFunction(uDeviceHandle_t cellHandle,
+                                                   uCellPrivateInstance_t **ppInstance,
+                                                   int32_t *pErrorCode,
+                                                   bool mustBeInitialised)
 {
     uCellPrivateInstance_t *pInstance = NULL;
+    const uCellPrivateInstance_t *pLockedInstance = NULL;
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
 
     if (gUCellPrivateMutex != NULL) {
 
-        uPortMutexLock(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
+        pLockedInstance = pInstance;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -891,17 +893,17 @@ static void entryFunction(uDeviceHandle_t cellHandle,
     if (pErrorCode != NULL) {
         *pErrorCode = errorCode;
     }
+
+    return pLockedInstance;
 }
 
 // MUST be called at the end of every API function to unlock
-// the cellular mutex; use the helper macro
+// the cellular instance; use the helper macro
 // U_CELL_MQTT_EXIT_FUNCTION to be sure of this, rather than calling
 // this function directly.
-static void exitFunction()
+static void exitFunction(const uCellPrivateInstance_t *pLockedInstance)
 {
-    if (gUCellPrivateMutex != NULL) {
-        uPortMutexUnlock(gUCellPrivateMutex);
-    }
+    uCellPrivateInstanceUnlock(pLockedInstance);
 }
 
 // Print the error state of MQTT.
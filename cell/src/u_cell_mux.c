@@ -36,16 +36,28 @@
  *     of the user data.
  * 4.  Then the ring-buffer is parsed for non-channel-0 [i.e. user]
  *     CMUX frames and the information fields of these frames are
- *     copied into the data buffers of the individual channels.  If
- *     there is no room for the information-field data in the buffers
- *     then, assuming that CTS flow control is NOT enabled (if it is
- *     enabled then any overflow-data is simply discarded), a "stall" is
- *     indicated; the data is left in the ring-buffer and the far end
- *     is sent a flow-control-off.
+ *     copied into the data buffers of the individual channels.  When
+ *     a channel's buffer is filling up the far end is sent a
+ *     flow-control-off for that channel.  If there is no room for the
+ *     information-field data in the buffers then, assuming that CTS
+ *     flow control is NOT enabled (if it is enabled then any
+ *     overflow-data is simply discarded), the information field is
+ *     moved to the "parking" buffer of that channel, so that the frames
+ *     of other channels behind it in the ring-buffer can still be
+ *     decoded.  Only if the parking buffer is also full is a "stall"
+ *     indicated; the data is left in the ring-buffer, holding up all
+ *     channels.
  * 5.  When user data is read from the virtual serial port, if we had
  *     flow-controlled-off the far end then it is flow-controlled-on
  *     again and decoding of any existing data in the buffers is
- *     re-triggered.
+ *     re-triggered; this also moves parked data into the receive
+ *     buffer.
+ * 6.  On transmit, user data is sent in frames of up to the
+ *     information-field length agreed with the module.  Each frame is
+ *     sent under a transmit lock which is handed out in order of
+ *     channel priority (control, then AT, then GNSS, then anything
+ *     else, e.g. PPP), so that a channel carrying bulk data cannot hold
+ *     up the AT channel for more than one frame.
  */
 
 #ifdef U_CFG_OVERRIDE
@@ -348,6 +360,101 @@ static int32_t serialReadInnards(volatile uCellMuxPrivateTraffic_t *pTraffic,
     return totalRead;
 }
 
+// Take the lock that permits a frame to be written to the underlying
+// stream, giving way to any writers of a higher priority.  This is
+// done per frame so that a channel with a lot of data to send cannot
+// hold up a higher priority channel by more than one frame.  If the
+// lock is busy the caller blocks on the semaphore for its priority
+// until txUnlock() hands the lock over.
+static void txLock(uCellMuxPrivateContext_t *pContext,
+                   uCellMuxPrivateTxPriority_t priority)
+{
+    bool mustWait = false;
+
+    U_PORT_MUTEX_LOCK(pContext->txWaitMutex);
+
+    if (pContext->txBusy) {
+        pContext->txWaitingCount[priority]++;
+        mustWait = true;
+    } else {
+        pContext->txBusy = true;
+    }
+
+    U_PORT_MUTEX_UNLOCK(pContext->txWaitMutex);
+
+    if (mustWait) {
+        // txBusy stays true: the lock is handed to us
+        uPortSemaphoreTake(pContext->txSemaphore[priority]);
+    }
+}
+
+// Release the lock taken with txLock(), handing it to the
+// waiter of highest priority, if there is one.
+static void txUnlock(uCellMuxPrivateContext_t *pContext)
+{
+    bool handedOver = false;
+
+    U_PORT_MUTEX_LOCK(pContext->txWaitMutex);
+
+    for (size_t x = 0; (x < U_CELL_MUX_PRIVATE_TX_PRIORITY_MAX_NUM) && !handedOver; x++) {
+        if (pContext->txWaitingCount[x] > 0) {
+            pContext->txWaitingCount[x]--;
+            uPortSemaphoreGive(pContext->txSemaphore[x]);
+            handedOver = true;
+        }
+    }
+    if (!handedOver) {
+        pContext->txBusy = false;
+    }
+
+    U_PORT_MUTEX_UNLOCK(pContext->txWaitMutex);
+}
+
+// Delete the mutex and semaphores behind txLock(), any of
+// which may not have been created.
+static void txLockDelete(uCellMuxPrivateContext_t *pContext)
+{
+    if (pContext->txWaitMutex != NULL) {
+        uPortMutexDelete(pContext->txWaitMutex);
+        pContext->txWaitMutex = NULL;
+    }
+    for (size_t x = 0; x < U_CELL_MUX_PRIVATE_TX_PRIORITY_MAX_NUM; x++) {
+        if (pContext->txSemaphore[x] != NULL) {
+            uPortSemaphoreDelete(pContext->txSemaphore[x]);
+            pContext->txSemaphore[x] = NULL;
+        }
+    }
+}
+
+// Write an encoded frame to the underlying stream, whole, under the
+// transmit lock, giving up if U_CELL_MUX_WRITE_TIMEOUT_MS from
+// startTimeMs passes; returns the number of bytes written or
+// negative error code.
+static int32_t txFrame(uCellMuxPrivateContext_t *pContext,
+                       uCellMuxPrivateTxPriority_t priority,
+                       const char *pFrame, size_t length,
+                       int32_t startTimeMs)
+{
+    int32_t lengthOrErrorCode = 0;
+    int32_t thisLengthWritten;
+
+    txLock(pContext, priority);
+    while ((lengthOrErrorCode >= 0) && (lengthOrErrorCode < (int32_t) length) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_CELL_MUX_WRITE_TIMEOUT_MS)) {
+        thisLengthWritten = uPortUartWrite(pContext->underlyingStreamHandle,
+                                           pFrame + lengthOrErrorCode,
+                                           length - lengthOrErrorCode);
+        if (thisLengthWritten >= 0) {
+            lengthOrErrorCode += thisLengthWritten;
+        } else {
+            lengthOrErrorCode = thisLengthWritten;
+        }
+    }
+    txUnlock(pContext);
+
+    return lengthOrErrorCode;
+}
+
 // The innards of serialWrite(), brough out separately here so that
 // controlChannelInformation() can respond to MSC commands.
 static int32_t serialWriteInnards(struct uDeviceSerial_t *pDeviceSerial,
@@ -356,18 +463,26 @@ static int32_t serialWriteInnards(struct uDeviceSerial_t *pDeviceSerial,
     int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
     uCellMuxPrivateChannelContext_t *pChannelContext = (uCellMuxPrivateChannelContext_t *)
                                                        pUInterfaceContext(pDeviceSerial);
-    uCellPrivateInstance_t *pInstance = pChannelContext->pContext->pInstance;
+    uCellMuxPrivateContext_t *pContext = pChannelContext->pContext;
+    uCellPrivateInstance_t *pInstance = pContext->pInstance;
     char *pBufferEncoded;
-    size_t chunkSize = U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES;
+    size_t informationLengthMax = pContext->informationLengthBytes;
+    size_t chunkSize;
     size_t thisChunkSize;
     size_t sizeWritten = 0;
     int32_t thisLengthWritten;
     size_t lengthWritten;
     int32_t startTimeMs;
+    int32_t waitTimeMs;
     bool activityPinIsSet = false;
 
-    // Encode the CMUX frame in chunks of the maximum information
+    if ((informationLengthMax == 0) ||
+        (informationLengthMax > U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES)) {
+        informationLengthMax = U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES;
+    }
+    // Encode the CMUX frame in chunks of the agreed information
     // length using a temporary buffer
+    chunkSize = informationLengthMax;
     if (chunkSize > sizeBytes) {
         chunkSize = sizeBytes;
     }
@@ -383,8 +498,8 @@ static int32_t serialWriteInnards(struct uDeviceSerial_t *pDeviceSerial,
                (uPortGetTickTimeMs() - startTimeMs < U_CELL_MUX_WRITE_TIMEOUT_MS)) {
             // Encode a chunk as UIH
             thisChunkSize = sizeBytes - sizeWritten;
-            if (thisChunkSize > U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES) {
-                thisChunkSize = U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES;
+            if (thisChunkSize > informationLengthMax) {
+                thisChunkSize = informationLengthMax;
             }
             sizeOrErrorCode = uCellMuxPrivateEncode(pChannelContext->channel,
                                                     U_CELL_MUX_PRIVATE_FRAME_TYPE_UIH,
@@ -392,20 +507,22 @@ static int32_t serialWriteInnards(struct uDeviceSerial_t *pDeviceSerial,
                                                     thisChunkSize, pBufferEncoded);
             if (sizeOrErrorCode >= 0) {
                 lengthWritten = 0;
-                while ((sizeOrErrorCode >= 0) && (lengthWritten < (size_t) sizeOrErrorCode) &&
-                       (uPortGetTickTimeMs() - startTimeMs < U_CELL_MUX_WRITE_TIMEOUT_MS)) {
-                    if (!pChannelContext->traffic.txIsFlowControlledOff) {
-                        // Send the data
-                        thisLengthWritten = uPortUartWrite(pChannelContext->pContext->underlyingStreamHandle,
-                                                           pBufferEncoded + lengthWritten,
-                                                           sizeOrErrorCode - lengthWritten);
-                        if (thisLengthWritten >= 0) {
-                            lengthWritten += thisLengthWritten;
-                        } else {
-                            sizeOrErrorCode = thisLengthWritten;
-                        }
+                // If the far end has flow controlled us off, wait for
+                // controlChannelInformation() to tell us it is back on
+                waitTimeMs = U_CELL_MUX_WRITE_TIMEOUT_MS - (uPortGetTickTimeMs() - startTimeMs);
+                while (pChannelContext->traffic.txIsFlowControlledOff && (waitTimeMs > 0)) {
+                    uPortSemaphoreTryTake(pChannelContext->semaphoreTxFlowOn, waitTimeMs);
+                    waitTimeMs = U_CELL_MUX_WRITE_TIMEOUT_MS - (uPortGetTickTimeMs() - startTimeMs);
+                }
+                if (!pChannelContext->traffic.txIsFlowControlledOff) {
+                    // Send the whole frame under the transmit lock
+                    thisLengthWritten = txFrame(pContext, pChannelContext->txPriority,
+                                                pBufferEncoded, sizeOrErrorCode,
+                                                startTimeMs);
+                    if (thisLengthWritten >= 0) {
+                        lengthWritten = thisLengthWritten;
                     } else {
-                        uPortTaskBlock(10);
+                        sizeOrErrorCode = thisLengthWritten;
                     }
                 }
 #ifdef U_CELL_MUX_ENABLE_USER_TX_DEBUG
@@ -431,7 +548,9 @@ static int32_t serialWriteInnards(struct uDeviceSerial_t *pDeviceSerial,
                 }
 #endif
                 // Keep track of the amount of user information written
-                sizeWritten += thisChunkSize;
+                if ((sizeOrErrorCode >= 0) && (lengthWritten == (size_t) sizeOrErrorCode)) {
+                    sizeWritten += thisChunkSize;
+                }
             }
         }
 
@@ -500,7 +619,8 @@ static int32_t sendCommandCheckResponse(uDeviceSerial_t *pDeviceSerial,
                                    buffer);
     if (length >= 0) {
         pTraffic->wantedResponseFrameType = pFrameCheck->type;
-        errorCode = uPortUartWrite(pChannelContext->pContext->underlyingStreamHandle, buffer, length);
+        errorCode = txFrame(pChannelContext->pContext, pChannelContext->txPriority,
+                            buffer, length, uPortGetTickTimeMs());
         if (errorCode == length) {
 #ifdef U_CELL_MUX_ENABLE_DEBUG
             uPortLog("U_CELL_CMUX_%d: tx %d byte(s): ", pChannelContext->channel, errorCode);
@@ -607,6 +727,16 @@ static int32_t serialOpen(struct uDeviceSerial_t *pDeviceSerial,
                     pTraffic->rxBufferIsMalloced = isMalloced;
                     pTraffic->pRxBufferWrite = pTraffic->pRxBufferStart;
                     pTraffic->pRxBufferRead = pTraffic->pRxBufferWrite;
+                    pTraffic->parkLengthBytes = 0;
+                    pTraffic->parkBufferSizeBytes = 0;
+                    if ((receiveBufferSizeBytes > 0) &&
+                        (U_CELL_MUX_PRIVATE_PARK_BUFFER_LENGTH_BYTES > 0)) {
+                        // If this fails we just do without parking
+                        pTraffic->pParkBuffer = (char *) pUPortMalloc(U_CELL_MUX_PRIVATE_PARK_BUFFER_LENGTH_BYTES);
+                        if (pTraffic->pParkBuffer != NULL) {
+                            pTraffic->parkBufferSizeBytes = U_CELL_MUX_PRIVATE_PARK_BUFFER_LENGTH_BYTES;
+                        }
+                    }
                     pChannelContext->state = U_CELL_MUX_PRIVATE_CHANNEL_STATE_OPEN;
                 } else if (isMalloced) {
                     // Clean up on error
@@ -667,6 +797,10 @@ static void serialClose(struct uDeviceSerial_t *pDeviceSerial)
             uPortFree(pTraffic->pRxBufferStart);
         }
         pTraffic->pRxBufferStart = NULL;
+        uPortFree(pTraffic->pParkBuffer);
+        pTraffic->pParkBuffer = NULL;
+        pTraffic->parkBufferSizeBytes = 0;
+        pTraffic->parkLengthBytes = 0;
         // Don't actually close channel to ensure thread-safety
         pChannelContext->markedForDeletion = true;
 
@@ -704,6 +838,7 @@ static int32_t serialRead(struct uDeviceSerial_t *pDeviceSerial,
     uCellMuxPrivateChannelContext_t *pChannelContext = (uCellMuxPrivateChannelContext_t *)
                                                        pUInterfaceContext(pDeviceSerial);
     uCellMuxPrivateTraffic_t *pTraffic;
+    bool retrigger = false;
     int32_t x;
 
     if ((pChannelContext != NULL) && !pChannelContext->markedForDeletion) {
@@ -749,6 +884,13 @@ static int32_t serialRead(struct uDeviceSerial_t *pDeviceSerial,
                     sendFlowControl(pChannelContext->pContext, pChannelContext->channel, false);
                     // The rxIsFlowControlledOff flag gets reset down in
                     // controlChannelInformation() when the acknowledgement arrives
+                    retrigger = true;
+                }
+                if ((sizeOrErrorCode > 0) && (pTraffic->parkLengthBytes > 0)) {
+                    // There is parked data which may now fit
+                    retrigger = true;
+                }
+                if (retrigger) {
                     // Re-trigger decoding of any received data we didn't previously
                     // have room to process.  We do a try send if we can so that we don't
                     // get stuck: if there are already events in the queue then they
@@ -1100,6 +1242,7 @@ static int32_t openChannel(uCellMuxPrivateContext_t *pContext,
                         uPortMutexDelete(pChannelContext->mutex);
                         uPortMutexDelete(pChannelContext->mutexUserDataWrite);
                         uPortMutexDelete(pChannelContext->mutexUserDataRead);
+                        uPortSemaphoreDelete(pChannelContext->semaphoreTxFlowOn);
                         uDeviceSerialDelete(pContext->pDeviceSerial[x]);
                         index = x;
                     }
@@ -1118,10 +1261,17 @@ static int32_t openChannel(uCellMuxPrivateContext_t *pContext,
                     if (errorCode == 0) {
                         errorCode = uPortMutexCreate(&(pChannelContext->mutexUserDataWrite));
                     }
+                    if (errorCode == 0) {
+                        errorCode = uPortSemaphoreCreate(&(pChannelContext->semaphoreTxFlowOn), 0, 1);
+                    }
                     if (errorCode == 0) {
                         pContext->pDeviceSerial[index] = pDeviceSerial;
                     }  else {
                         // Clean up on error
+                        if (pChannelContext->semaphoreTxFlowOn != NULL) {
+                            uPortSemaphoreDelete(pChannelContext->semaphoreTxFlowOn);
+                            pChannelContext->semaphoreTxFlowOn = NULL;
+                        }
                         if (pChannelContext->mutexUserDataWrite != NULL) {
                             uPortMutexDelete(pChannelContext->mutexUserDataWrite);
                             pChannelContext->mutexUserDataWrite = NULL;
@@ -1146,6 +1296,14 @@ static int32_t openChannel(uCellMuxPrivateContext_t *pContext,
                 pChannelContext = (uCellMuxPrivateChannelContext_t *) pUInterfaceContext(pDeviceSerial);
                 pChannelContext->pContext = pContext;
                 pChannelContext->channel = channel;
+                pChannelContext->txPriority = U_CELL_MUX_PRIVATE_TX_PRIORITY_OTHER;
+                if (channel == U_CELL_MUX_PRIVATE_CHANNEL_ID_CONTROL) {
+                    pChannelContext->txPriority = U_CELL_MUX_PRIVATE_TX_PRIORITY_CONTROL;
+                } else if (channel == U_CELL_MUX_PRIVATE_CHANNEL_ID_AT) {
+                    pChannelContext->txPriority = U_CELL_MUX_PRIVATE_TX_PRIORITY_AT;
+                } else if (channel == pContext->channelGnss) {
+                    pChannelContext->txPriority = U_CELL_MUX_PRIVATE_TX_PRIORITY_GNSS;
+                }
                 pChannelContext->markedForDeletion = false;
                 memset(&(pChannelContext->traffic), 0, sizeof(pChannelContext->traffic));
                 memset(&(pChannelContext->eventCallback), 0, sizeof(pChannelContext->eventCallback));
@@ -1208,7 +1366,14 @@ static void controlChannelInformation(uCellMuxPrivateContext_t *pContext,
         if ((pChannelContext != NULL) && !pChannelContext->markedForDeletion &&
             U_CELL_MUX_IS_OPEN(pChannelContext->state)) {
             if (isCommand) {
-                pChannelContext->traffic.txIsFlowControlledOff = ((*(pBuffer + 3) & 0x02) == 0x02);
+                if (pChannelContext->traffic.txIsFlowControlledOff &&
+                    ((*(pBuffer + 3) & 0x02) == 0)) {
+                    // Let any waiting writer know that it can continue
+                    pChannelContext->traffic.txIsFlowControlledOff = false;
+                    uPortSemaphoreGive(pChannelContext->semaphoreTxFlowOn);
+                } else {
+                    pChannelContext->traffic.txIsFlowControlledOff = ((*(pBuffer + 3) & 0x02) == 0x02);
+                }
             } else {
                 pChannelContext->traffic.rxIsFlowControlledOff = ((*(pBuffer + 3) & 0x02) == 0x02);
             }
@@ -1323,6 +1488,88 @@ static void cmuxDecodeControl(uCellMuxPrivateContext_t *pContext)
     }
 }
 
+// Write data into the receive buffer of a channel; the caller must
+// have checked that there is room for it.
+static void rxBufferWrite(uCellMuxPrivateTraffic_t *pTraffic,
+                          const char *pData, size_t length)
+{
+    const char *pRxBufferRead = pTraffic->pRxBufferRead;
+    size_t offset;
+    size_t x;
+
+    if (pTraffic->pRxBufferWrite >= pRxBufferRead) {
+        // Write pointer is equal to or ahead of read,
+        // start by adding up to the end of the buffer
+        offset = pTraffic->pRxBufferStart +
+                 pTraffic->rxBufferSizeBytes - pTraffic->pRxBufferWrite;
+        if (offset > length) {
+            offset = length;
+        }
+        memcpy(pTraffic->pRxBufferWrite, pData, offset);
+        length -= offset;
+        // Move the write pointer on, wrapping as necessary
+        pTraffic->pRxBufferWrite += offset;
+        if (pTraffic->pRxBufferWrite >= pTraffic->pRxBufferStart +
+            pTraffic->rxBufferSizeBytes) {
+            pTraffic->pRxBufferWrite = pTraffic->pRxBufferStart;
+        }
+        // If there is still stuff to write, continue writing
+        // up to just before the read pointer
+        if (length > 0) {
+            x = pRxBufferRead - pTraffic->pRxBufferWrite;
+            if (x > 0) {
+                x--;
+            }
+            if (x > length) {
+                x = length;
+            }
+            memcpy(pTraffic->pRxBufferWrite, pData + offset, x);
+            pTraffic->pRxBufferWrite += x;
+        }
+    } else {
+        // Write pointer is behind read, just write as much as we can
+        x = pRxBufferRead - pTraffic->pRxBufferWrite;
+        if (x > length) {
+            x = length;
+        }
+        memcpy(pTraffic->pRxBufferWrite, pData, x);
+        pTraffic->pRxBufferWrite += x;
+    }
+    // Wrap the write pointer if necessary
+    if (pTraffic->pRxBufferWrite >= pTraffic->pRxBufferStart +
+        pTraffic->rxBufferSizeBytes) {
+        pTraffic->pRxBufferWrite = pTraffic->pRxBufferStart;
+    }
+}
+
+// Move as much parked data as will fit into the receive buffer of
+// a channel.
+static void parkDrain(uDeviceSerial_t *pDeviceSerial)
+{
+    uCellMuxPrivateChannelContext_t *pChannelContext = (uCellMuxPrivateChannelContext_t *)
+                                                       pUInterfaceContext(pDeviceSerial);
+    uCellMuxPrivateTraffic_t *pTraffic = &(pChannelContext->traffic);
+    size_t length;
+
+    if ((pTraffic->parkLengthBytes > 0) && (pTraffic->rxBufferSizeBytes > 0)) {
+        // -1 below to avoid pointer wrap
+        length = pTraffic->rxBufferSizeBytes - serialGetReceiveSizeInnards(pDeviceSerial) - 1;
+        if (length > pTraffic->parkLengthBytes) {
+            length = pTraffic->parkLengthBytes;
+        }
+        if (length > 0) {
+            rxBufferWrite(pTraffic, pTraffic->pParkBuffer, length);
+            pTraffic->parkLengthBytes -= length;
+            memmove(pTraffic->pParkBuffer, pTraffic->pParkBuffer + length,
+                    pTraffic->parkLengthBytes);
+#ifdef U_CELL_MUX_ENABLE_DEBUG
+            uPortLog("U_CELL_CMUX_%d: moved %d parked byte(s) to buffer, %d left parked.\n",
+                     pChannelContext->channel, length, pTraffic->parkLengthBytes);
+#endif
+        }
+    }
+}
+
 // Decode received CMUX frames, just the non-control-channel ones, from
 // the ring buffer.
 static void cmuxDecode(uCellMuxPrivateContext_t *pContext, uint32_t eventBitMap)
@@ -1333,12 +1580,11 @@ static void cmuxDecode(uCellMuxPrivateContext_t *pContext, uint32_t eventBitMap)
     uCellMuxPrivateChannelContext_t *pChannelContext;
     uCellMuxPrivateTraffic_t *pTraffic;
     U_RING_BUFFER_PARSER_f parserList[] = {uCellMuxPrivateParseCmux, NULL};
-    size_t offset;
     bool stalled = false;
+    size_t informationLength;
     size_t bufferLength;
     size_t discardLength;
     size_t x;
-    const char *pRxBufferRead;
 
     if (pContext != NULL) {
         // Try to decode new CMUX messages from the ring buffer
@@ -1380,8 +1626,11 @@ static void cmuxDecode(uCellMuxPrivateContext_t *pContext, uint32_t eventBitMap)
                             //fall-through
                             case U_CELL_MUX_PRIVATE_FRAME_TYPE_UI:
                                 if (pTraffic->rxBufferSizeBytes > 0) {
+                                    // Anything parked must go before this frame
+                                    parkDrain(pDeviceSerial);
                                     // We have user information, work out how much we can cope with
                                     // -1 below to avoid pointer wrap
+                                    informationLength = parserContext.informationLengthBytes;
                                     bufferLength  = pTraffic->rxBufferSizeBytes - serialGetReceiveSizeInnards(pDeviceSerial) - 1;
                                     if (bufferLength > sizeof(pContext->scratch)) {
                                         bufferLength = sizeof(pContext->scratch);
@@ -1390,7 +1639,8 @@ static void cmuxDecode(uCellMuxPrivateContext_t *pContext, uint32_t eventBitMap)
                                         discardLength = parserContext.informationLengthBytes - bufferLength;
                                         parserContext.informationLengthBytes = bufferLength;
                                     }
-                                    if ((discardLength == 0) || pTraffic->discardOnOverflow) {
+                                    if ((pTraffic->parkLengthBytes == 0) &&
+                                        ((discardLength == 0) || pTraffic->discardOnOverflow)) {
                                         // Re-parse the buffer to actually get the information field
                                         parserContext.pInformation = pContext->scratch;
                                         uRingBufferParseHandle(&(pContext->ringBuffer),
@@ -1407,50 +1657,8 @@ static void cmuxDecode(uCellMuxPrivateContext_t *pContext, uint32_t eventBitMap)
                                                  pTraffic->rxBufferSizeBytes);
 #endif
                                         //  Move the user's information-field bytes into the main buffer
-                                        pRxBufferRead = pTraffic->pRxBufferRead;
-                                        if (pTraffic->pRxBufferWrite >= pRxBufferRead) {
-                                            // Write pointer is equal to or ahead of read,
-                                            // start by adding up to the end of the buffer
-                                            offset = pTraffic->pRxBufferStart +
-                                                     pTraffic->rxBufferSizeBytes - pTraffic->pRxBufferWrite;
-                                            if (offset > parserContext.informationLengthBytes) {
-                                                offset = parserContext.informationLengthBytes;
-                                            }
-                                            memcpy(pTraffic->pRxBufferWrite, pContext->scratch, offset);
-                                            parserContext.informationLengthBytes -= offset;
-                                            // Move the write pointer on, wrapping as necessary
-                                            pTraffic->pRxBufferWrite += offset;
-                                            if (pTraffic->pRxBufferWrite >= pTraffic->pRxBufferStart +
-                                                pTraffic->rxBufferSizeBytes) {
-                                                pTraffic->pRxBufferWrite = pTraffic->pRxBufferStart;
-                                            }
-                                            // If there is still stuff to write, continue writing
-                                            // up to just before the read pointer
-                                            if (parserContext.informationLengthBytes > 0) {
-                                                x = pRxBufferRead - pTraffic->pRxBufferWrite;
-                                                if (x > 0) {
-                                                    x--;
-                                                }
-                                                if (x > parserContext.informationLengthBytes) {
-                                                    x = parserContext.informationLengthBytes;
-                                                }
-                                                memcpy(pTraffic->pRxBufferWrite, pContext->scratch + offset, x);
-                                                pTraffic->pRxBufferWrite += x;
-                                            }
-                                        } else {
-                                            // Write pointer is behind read, just write as much as we can
-                                            x = pRxBufferRead - pTraffic->pRxBufferWrite;
-                                            if (x > parserContext.informationLengthBytes) {
-                                                x = parserContext.informationLengthBytes;
-                                            }
-                                            memcpy(pTraffic->pRxBufferWrite, pContext->scratch, x);
-                                            pTraffic->pRxBufferWrite += x;
-                                        }
-                                        // Wrap the write pointer if necessary
-                                        if (pTraffic->pRxBufferWrite >= pTraffic->pRxBufferStart +
-                                            pTraffic->rxBufferSizeBytes) {
-                                            pTraffic->pRxBufferWrite = pTraffic->pRxBufferStart;
-                                        }
+                                        rxBufferWrite(pTraffic, pContext->scratch,
+                                                      parserContext.informationLengthBytes);
                                         // Having decoded what we can, do any discarding
                                         if (discardLength > 0) {
                                             uRingBufferReadHandle(&(pContext->ringBuffer), pContext->readHandle,
@@ -1460,6 +1668,23 @@ static void cmuxDecode(uCellMuxPrivateContext_t *pContext, uint32_t eventBitMap)
                                                      pChannelContext->channel, discardLength);
 #endif
                                         }
+                                    } else if (informationLength <= pTraffic->parkBufferSizeBytes -
+                                               pTraffic->parkLengthBytes) {
+                                        // Not enough room in the receive buffer but there is
+                                        // room to park the information field, so that frames
+                                        // for other channels are not held up behind it
+                                        discardLength = 0;
+                                        parserContext.pInformation = pTraffic->pParkBuffer + pTraffic->parkLengthBytes;
+                                        parserContext.informationLengthBytes = informationLength;
+                                        uRingBufferParseHandle(&(pContext->ringBuffer),
+                                                               pContext->readHandle,
+                                                               parserList, &parserContext);
+                                        pTraffic->parkLengthBytes += informationLength;
+#ifdef U_CELL_MUX_ENABLE_DEBUG
+                                        uPortLog("U_CELL_CMUX_%d: parked %d byte(s) of I-field, %d/%d parked.\n",
+                                                 pChannelContext->channel, informationLength,
+                                                 pTraffic->parkLengthBytes, pTraffic->parkBufferSizeBytes);
+#endif
                                     } else {
                                         // Not enough room to decode more of the information field
                                         // on this channel, we are stalled
@@ -1513,8 +1738,12 @@ static void cmuxDecode(uCellMuxPrivateContext_t *pContext, uint32_t eventBitMap)
         // still stuff down here.
         for (x = 0; x < sizeof(pContext->pDeviceSerial) / sizeof (pContext->pDeviceSerial[0]); x++) {
             pDeviceSerial = pContext->pDeviceSerial[x];
+            pChannelContext = (uCellMuxPrivateChannelContext_t *) pUInterfaceContext(pDeviceSerial);
+            if ((pChannelContext != NULL) && !pChannelContext->markedForDeletion) {
+                // Move on anything that was parked
+                parkDrain(pDeviceSerial);
+            }
             if ((pDeviceSerial != NULL) && (serialGetReceiveSizeInnards(pDeviceSerial) > 0)) {
-                pChannelContext = (uCellMuxPrivateChannelContext_t *) pUInterfaceContext(pDeviceSerial);
                 if ((pChannelContext->eventCallback.pFunction != NULL) && !pChannelContext->markedForDeletion) {
                     sendEvent(pContext, pChannelContext, U_DEVICE_SERIAL_EVENT_BITMASK_DATA_RECEIVED, 0);
                 }
@@ -1594,6 +1823,27 @@ static void cmuxReceiveCallback(const uAtClientStreamHandle_t *pStream,
     }
 }
 
+// Send AT+CMUX with the given information field length; the AT
+// client must be locked and is left locked.
+static int32_t sendCmux(uAtClientHandle_t atHandle, size_t informationLengthBytes)
+{
+    uAtClientCommandStart(atHandle, "AT+CMUX=");
+    // Only basic mode and only UIH frames are supported by any
+    // of the cellular modules we support
+    uAtClientWriteInt(atHandle, 0);
+    uAtClientWriteInt(atHandle, 0);
+    // As advised in the u-blox multiplexer document, port
+    // speed is left empty for max compatibility
+    uAtClientWriteString(atHandle, "", false);
+    // Set the information field length
+    uAtClientWriteInt(atHandle, (int32_t) informationLengthBytes);
+    // Everything else is left at defaults for max compatibility
+    uAtClientCommandStopReadResponse(atHandle);
+
+    // Not unlocking here, just check for errors
+    return uAtClientErrorGet(atHandle);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS THAT ARE PRIVATE TO CELLULAR
  * -------------------------------------------------------------- */
@@ -1637,6 +1887,13 @@ int32_t uCellMuxPrivateEnable(uCellPrivateInstance_t *pInstance)
                                                                      U_CELL_MUX_CALLBACK_TASK_PRIORITY,
                                                                      U_CELL_MUX_CALLBACK_QUEUE_LENGTH);
                     if (pContext->eventQueueHandle >= 0) {
+                        errorCode = uPortMutexCreate(&(pContext->txWaitMutex));
+                    }
+                    for (size_t x = 0; (x < U_CELL_MUX_PRIVATE_TX_PRIORITY_MAX_NUM) &&
+                         (errorCode == 0); x++) {
+                        errorCode = uPortSemaphoreCreate(&(pContext->txSemaphore[x]), 0, 1);
+                    }
+                    if ((pContext->eventQueueHandle >= 0) && (errorCode == 0)) {
                         if (uRingBufferCreateWithReadHandle(&(pContext->ringBuffer),
                                                             pContext->linearBuffer,
                                                             sizeof(pContext->linearBuffer), 1) == 0) {
@@ -1644,12 +1901,17 @@ int32_t uCellMuxPrivateEnable(uCellPrivateInstance_t *pInstance)
                             pContext->readHandle = uRingBufferTakeReadHandle(&(pContext->ringBuffer));
                         } else {
                             // Clean up on error
+                            txLockDelete(pContext);
                             uPortEventQueueClose(pContext->eventQueueHandle);
                             uPortFree(pInstance->pMuxContext);
                             pInstance->pMuxContext = NULL;
                         }
                     } else {
                         // Clean up on error
+                        txLockDelete(pContext);
+                        if (pContext->eventQueueHandle >= 0) {
+                            uPortEventQueueClose(pContext->eventQueueHandle);
+                        }
                         uPortFree(pInstance->pMuxContext);
                         pInstance->pMuxContext = NULL;
                     }
@@ -1669,22 +1931,23 @@ int32_t uCellMuxPrivateEnable(uCellPrivateInstance_t *pInstance)
                     uAtClientStreamGetExt(atHandle, &stream);
                     uRingBufferFlushHandle(&(pContext->ringBuffer), pContext->readHandle);
                     pContext->underlyingStreamHandle = stream.handle.int32;
-                    uAtClientCommandStart(atHandle, "AT+CMUX=");
-                    // Only basic mode and only UIH frames are supported by any
-                    // of the cellular modules we support
-                    uAtClientWriteInt(atHandle, 0);
-                    uAtClientWriteInt(atHandle, 0);
-                    // As advised in the u-blox multiplexer document, port
-                    // speed is left empty for max compatibility
-                    uAtClientWriteString(atHandle, "", false);
-                    // Set the information field length
-                    uAtClientWriteInt(atHandle,
-                                      U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES);
-                    // Everything else is left at defaults for max compatibility
-                    uAtClientCommandStopReadResponse(atHandle);
-                    // Not unlocking here, just check for errors
-                    errorCode = uAtClientErrorGet(atHandle);
+                    // Ask for our maximum information field length
+                    pContext->informationLengthBytes = U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES;
+                    errorCode = sendCmux(atHandle, pContext->informationLengthBytes);
+                    if ((errorCode < 0) &&
+                        (U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES >
+                         U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_FALLBACK_BYTES)) {
+                        // The module may not support an information field
+                        // of that length, try the fall-back
+                        uAtClientClearError(atHandle);
+                        pContext->informationLengthBytes = U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_FALLBACK_BYTES;
+                        errorCode = sendCmux(atHandle, pContext->informationLengthBytes);
+                    }
                     if (errorCode == 0) {
+#ifdef U_CELL_MUX_ENABLE_DEBUG
+                        uPortLog("U_CELL_CMUX: information field length %d.\n",
+                                 pContext->informationLengthBytes);
+#endif
                         // Leave the AT client locked to stop it reacting to stuff coming
                         // back over the UART, which will shortly become the MUX
                         // control channel and not an AT interface at all.
@@ -1953,15 +2216,13 @@ int32_t uCellMuxEnable(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             errorCode = uCellMuxPrivateEnable(pInstance);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -1975,14 +2236,12 @@ bool uCellMuxIsEnabled(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             isEnabled = uCellMuxPrivateIsEnabled(pInstance);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return isEnabled;
@@ -1998,15 +2257,13 @@ int32_t uCellMuxAddChannel(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             errorCode = uCellMuxPrivateAddChannel(pInstance, channel, ppDeviceSerial);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -2022,9 +2279,7 @@ uDeviceSerial_t *pUCellMuxChannelGetDeviceSerial(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if ((pInstance != NULL) &&
             ((channel <= U_CELL_MUX_PRIVATE_ADDRESS_MAX) ||
              (channel == U_CELL_MUX_CHANNEL_ID_GNSS))) {
@@ -2040,7 +2295,7 @@ uDeviceSerial_t *pUCellMuxChannelGetDeviceSerial(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return pDeviceSerial;
@@ -2057,10 +2312,8 @@ int32_t uCellMuxRemoveChannel(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if ((pInstance != NULL) && (pDeviceSerial != NULL)) {
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
             if (pInstance->pMuxContext != NULL) {
@@ -2072,7 +2325,7 @@ int32_t uCellMuxRemoveChannel(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -2086,15 +2339,13 @@ int32_t uCellMuxDisable(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             errorCode = uCellMuxPrivateDisable(pInstance);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return (int32_t) errorCode;
@@ -2110,9 +2361,7 @@ void uCellMuxFree(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if ((pInstance != NULL) && (pInstance->pMuxContext != NULL)) {
             pContext = (uCellMuxPrivateContext_t *) pInstance->pMuxContext;
             for (size_t x = 0; x < (sizeof(pContext->pDeviceSerial) / sizeof(pContext->pDeviceSerial[0]));
@@ -2124,6 +2373,7 @@ void uCellMuxFree(uDeviceHandle_t cellHandle)
                         uPortMutexDelete(pChannelContext->mutexUserDataWrite);
                         uPortMutexDelete(pChannelContext->mutexUserDataRead);
                         uPortMutexDelete(pChannelContext->mutex);
+                        uPortSemaphoreDelete(pChannelContext->semaphoreTxFlowOn);
                         uDeviceSerialDelete(pContext->pDeviceSerial[x]);
                         pContext->pDeviceSerial[x] = NULL;
                     } else {
@@ -2136,7 +2386,7 @@ void uCellMuxFree(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
 }
@@ -2152,10 +2402,8 @@ int32_t uCellMuxModuleAbort(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             atHandle = pInstance->atHandle;
@@ -2185,7 +2433,7 @@ int32_t uCellMuxModuleAbort(uDeviceHandle_t cellHandle)
             uAtClientUnlock(atHandle);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -402,6 +402,8 @@ int32_t uCellMuxPrivateCopyAtClient(uAtClientHandle_t atHandleSource,
     int32_t b = 0;
     int32_t c = 0;
     bool d = false;
+    size_t y = 0;
+    size_t z = 0;
     uCellMuxStringList_t *pUrcPrefixRoot = NULL;
     uCellMuxStringList_t *pUrcPrefixTmp = NULL;
     uCellMuxStringList_t **ppUrcPrefix = &pUrcPrefixRoot;
@@ -457,6 +459,7 @@ int32_t uCellMuxPrivateCopyAtClient(uAtClientHandle_t atHandleSource,
         uAtClientReadRetryDelaySet(atHandleDestination, uAtClientReadRetryDelayGet(atHandleSource));
         uAtClientDelimiterSet(atHandleDestination, uAtClientDelimiterGet(atHandleSource));
         uAtClientDelaySet(atHandleDestination, uAtClientDelayGet(atHandleSource));
+        uAtClientTxBufferSet(atHandleDestination, uAtClientTxBufferGet(atHandleSource));
         a = uAtClientGetActivityPinSettings(atHandleSource, &b, &c, &d);
         uAtClientSetActivityPin(atHandleDestination, a, b, c, d);
 
@@ -465,6 +468,21 @@ int32_t uCellMuxPrivateCopyAtClient(uAtClientHandle_t atHandleSource,
         uAtClientTimeoutCallbackSet(atHandleDestination, pTimeoutCallback);
         uAtClientGetWakeUpHandler(atHandleSource, &pWakeUpHandler, &pHandlerParam, &a);
         uAtClientSetWakeUpHandler(atHandleDestination, pWakeUpHandler, pHandlerParam, a);
+
+        // Record AT command statistics if the source was
+        a = uAtClientCommandStatsMaxNumGet(atHandleSource);
+        if (a > 0) {
+            uAtClientCommandStatsStart(atHandleDestination, (size_t) a);
+        }
+
+        // Give the destination its own callback executors if the source had them
+        for (size_t x = 0; x < U_AT_CLIENT_CALLBACK_PRIORITY_MAX_NUM; x++) {
+            if (uAtClientCallbackExecutorGet(atHandleSource, (uAtClientCallbackPriority_t) x,
+                                             &y, &a, &z) == 0) {
+                uAtClientCallbackExecutorSet(atHandleDestination, (uAtClientCallbackPriority_t) x,
+                                             y, a, z);
+            }
+        }
     } else {
         // Clean-up on error
         while (pUrcPrefixRoot != NULL) {
@@ -496,12 +514,17 @@ void uCellMuxPrivateRemoveContext(uCellPrivateInstance_t *pInstance)
                     uPortMutexDelete(pChannelContext->mutex);
                     uPortMutexDelete(pChannelContext->mutexUserDataWrite);
                     uPortMutexDelete(pChannelContext->mutexUserDataRead);
+                    uPortSemaphoreDelete(pChannelContext->semaphoreTxFlowOn);
                     uDeviceSerialDelete(pContext->pDeviceSerial[x]);
                 }
             }
             uRingBufferGiveReadHandle(&(pContext->ringBuffer), pContext->readHandle);
             uRingBufferDelete(&(pContext->ringBuffer));
             uPortEventQueueClose(pContext->eventQueueHandle);
+            uPortMutexDelete(pContext->txWaitMutex);
+            for (size_t x = 0; x < sizeof(pContext->txSemaphore) / sizeof(pContext->txSemaphore[0]); x++) {
+                uPortSemaphoreDelete(pContext->txSemaphore[x]);
+            }
             uPortFree(pInstance->pMuxContext);
             pInstance->pMuxContext = NULL;
 #ifdef U_CELL_MUX_ENABLE_DEBUG
@@ -47,11 +47,38 @@ extern "C" {
  * should be small with respect to the buffer size of the thing it is
  * pouring received data into since the multiplexing protocol serialises
  * several things and, if one of them gets "stuck" because it has nowhere
- * to put its data, the ones that follow will be stuck also. So we use 128.
+ * to put its data, the ones that follow will be stuck also (see
+ * #U_CELL_MUX_PRIVATE_PARK_BUFFER_LENGTH_BYTES for how that is mitigated).
+ * So we use 128.  This is the N1 value offered to the module in AT+CMUX;
+ * should the module refuse it we fall back to
+ * #U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_FALLBACK_BYTES.
  */
 # define U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES 128
 #endif
 
+#ifndef U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_FALLBACK_BYTES
+/** The information field length to ask for in AT+CMUX if the module
+ * refuses #U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES; 31 is the
+ * 3GPP 27.010 default value of N1 for basic mode.
+ */
+# define U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_FALLBACK_BYTES 31
+#endif
+
+#ifndef U_CELL_MUX_PRIVATE_PARK_BUFFER_LENGTH_BYTES
+/** The size of the "parking" buffer of each CMUX channel that carries
+ * user data.  When we flow control a channel off the module may
+ * already have more frames for that channel in flight and, should
+ * those not fit into the channel's receive buffer, they would sit
+ * at the head of the ring buffer, holding up the frames of all the
+ * other channels behind them.  Instead, such frames are parked in
+ * this buffer until the application has read enough data from the
+ * channel for them to be moved into the receive buffer; only if
+ * the parking buffer is also full do the other channels stall.
+ * Set this to 0 to disable parking.
+ */
+# define U_CELL_MUX_PRIVATE_PARK_BUFFER_LENGTH_BYTES (U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES * 2)
+#endif
+
 #ifndef U_CELL_MUX_PRIVATE_VIRTUAL_SERIAL_BUFFER_LENGTH_BYTES
 /** A suggested length for the buffer which a virtual serial port
  * should use for receiving data from the cellular module, e.g.
@@ -184,6 +211,19 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The transmit priorities of CMUX channels: when more than one
+ * channel has a frame to send, frames from the channel with
+ * the numerically lowest priority go first, with lower priority
+ * channels giving way between frames.
+ */
+typedef enum {
+    U_CELL_MUX_PRIVATE_TX_PRIORITY_CONTROL = 0, /**< channel 0, MSC etc. */
+    U_CELL_MUX_PRIVATE_TX_PRIORITY_AT = 1,      /**< the AT channel. */
+    U_CELL_MUX_PRIVATE_TX_PRIORITY_GNSS = 2,    /**< the GNSS channel. */
+    U_CELL_MUX_PRIVATE_TX_PRIORITY_OTHER = 3,   /**< any other channel, e.g. PPP. */
+    U_CELL_MUX_PRIVATE_TX_PRIORITY_MAX_NUM
+} uCellMuxPrivateTxPriority_t;
+
 /** The types of CMUX frame, values chosen so that they can be
  * written directly to a control word in an encoded frame (with
  * poll/final bit not set).
@@ -270,6 +310,16 @@ typedef struct {
                                                                       a stack variable. */
     int32_t readHandle;
     int32_t eventQueueHandle; /** an event queue to carry callbacks from the channels. */
+    size_t informationLengthBytes; /**< the information field length (N1) agreed with the module. */
+    uPortMutexHandle_t txWaitMutex; /**< protects txBusy and txWaitingCount. */
+    bool txBusy; /**< true while a frame is being written to the underlying stream. */
+    size_t txWaitingCount[U_CELL_MUX_PRIVATE_TX_PRIORITY_MAX_NUM]; /**< the number of writers waiting
+                                                                        to send a frame at each
+                                                                        transmit priority. */
+    uPortSemaphoreHandle_t txSemaphore[U_CELL_MUX_PRIVATE_TX_PRIORITY_MAX_NUM]; /**< given to hand
+                                                                                     the transmit lock
+                                                                                     to a waiter of
+                                                                                     each priority. */
 } uCellMuxPrivateContext_t;
 
 /** Structure to hold the user event callback for a CMUX channel.
@@ -294,6 +344,10 @@ typedef struct {
     bool discardOnOverflow;
     bool txIsFlowControlledOff; /**< remote-end doesn't want us to send to it. */
     bool rxIsFlowControlledOff; /**< we don't want the remote-end to send stuff to us. */
+    char *pParkBuffer; /**< information fields that didn't fit into the receive buffer,
+                            see #U_CELL_MUX_PRIVATE_PARK_BUFFER_LENGTH_BYTES. */
+    size_t parkBufferSizeBytes;
+    size_t parkLengthBytes; /**< the amount of data at pParkBuffer. */
 } uCellMuxPrivateTraffic_t;
 
 /** The context data for a single CMUX channel.
@@ -306,6 +360,8 @@ typedef struct {
     uPortMutexHandle_t mutex;
     uPortMutexHandle_t mutexUserDataWrite;
     uPortMutexHandle_t mutexUserDataRead;
+    uPortSemaphoreHandle_t semaphoreTxFlowOn; /**< given when the remote-end flow controls us on. */
+    uCellMuxPrivateTxPriority_t txPriority;
     uCellMuxPrivateTraffic_t traffic;
     uCellMuxPrivateEventCallback_t eventCallback;
 } uCellMuxPrivateChannelContext_t;
@@ -350,7 +406,8 @@ typedef struct {
  * transport type #U_GNSS_TRANSPORT_VIRTUAL_SERIAL) and you will
  * have streamed position.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param[in] pInstance  a pointer to the cellular instance.
  * @return               zero on success or negative error code
@@ -360,7 +417,8 @@ int32_t uCellMuxPrivateEnable(uCellPrivateInstance_t *pInstance);
 
 /** Determine if the multiplexer is currently enabled.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param[in] pInstance  a pointer to the cellular instance.
  * @return               true if the multiplexer is enabled,
@@ -420,7 +478,8 @@ bool uCellMuxPrivateIsEnabled(uCellPrivateInstance_t *pInstance);
  * and #U_CELL_MUX_CALLBACK_TASK_STACK_SIZE_BYTES since a common
  * event queue is used for all serial devices.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param[in] pInstance       a pointer to the cellular instance.
  * @param channel             the channel number to open; channel
@@ -448,7 +507,8 @@ int32_t uCellMuxPrivateAddChannel(uCellPrivateInstance_t *pInstance,
  * change, so if you have a local copy of it you will need to refresh
  * it once this function returns.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param[in] pInstance a pointer to the cellular instance.
  */
@@ -466,7 +526,8 @@ uDeviceSerial_t *pUCellMuxPrivateGetDeviceSerial(uCellMuxPrivateContext_t *pCont
 /** Close a CMUX channel.  This does NOT free memory to ensure
  * thread safety; only uCellMuxPrivateRemoveContext() frees memory.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param[in] pContext the mux context.
  * @param channel      the channel number to close.
@@ -547,7 +608,8 @@ int32_t uCellMuxPrivateCopyAtClient(uAtClientHandle_t atHandleSource,
  * atHandle in pInstance to change, so if you have a local copy of it
  * you will need to refresh it once this function returns.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param[in] pInstance a pointer to the cellular instance.
  */
@@ -292,6 +292,7 @@ static void setNetworkStatus(uCellPrivateInstance_t *pInstance,
                              bool fromUrc)
 {
     uCellNetRegistationStatus_t *pStatus;
+    uAtClientCallbackPriority_t statusPriority = U_AT_CLIENT_CALLBACK_PRIORITY_HIGH;
     bool printAllowed = true;
 #if U_CFG_OS_CLIB_LEAKS
     // If we're in a URC and the C library leaks memory
@@ -416,9 +417,12 @@ static void setNetworkStatus(uCellPrivateInstance_t *pInstance,
             if (!U_CELL_PRIVATE_HAS(pInstance->pModule,
                                     U_CELL_PRIVATE_FEATURE_USE_UPSD_CONTEXT_ACTIVATION)) {
                 // Use the AT client's callback mechanism to do the operation
-                // out of the URC task
+                // out of the URC task; this does blocking AT work so it is
+                // normal priority, and the registration status callback
+                // below must then follow it on the same executor
                 uAtClientCallback(pInstance->atHandle,
                                   activateContextCallback, pInstance);
+                statusPriority = U_AT_CLIENT_CALLBACK_PRIORITY_NORMAL;
             }
             pInstance->profileState = U_CELL_PRIVATE_PROFILE_STATE_SHOULD_BE_UP;
         }
@@ -462,8 +466,8 @@ static void setNetworkStatus(uCellPrivateInstance_t *pInstance,
                 pStatus->networkStatus = status;
                 pStatus->pCallback = pInstance->pRegistrationStatusCallback;
                 pStatus->pCallbackParameter = pInstance->pRegistrationStatusCallbackParameter;
-                uAtClientCallback(pInstance->atHandle,
-                                  registrationStatusCallback, pStatus);
+                uAtClientCallbackPriority(pInstance->atHandle, statusPriority,
+                                          registrationStatusCallback, pStatus);
             }
         }
     }
@@ -705,7 +709,8 @@ static void CSCON_urc(uAtClientHandle_t atHandle, void *pParameter)
             pStatus->isConnected = isConnected;
             pStatus->pCallback = pInstance->pConnectionStatusCallback;
             pStatus->pCallbackParameter = pInstance->pConnectionStatusCallbackParameter;
-            uAtClientCallback(atHandle, connectionStatusCallback, pStatus);
+            uAtClientCallbackPriority(atHandle, U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                                      connectionStatusCallback, pStatus);
         }
     }
 }
@@ -2279,9 +2284,7 @@ int32_t uCellNetConnect(uDeviceHandle_t cellHandle,
         // locked, so we alays take the PPP connection down first
         uPortPppDisconnect(cellHandle);
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             ((pUsername == NULL) || (pPassword != NULL))) {
@@ -2484,7 +2487,7 @@ int32_t uCellNetConnect(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
 
         if ((errorCode == 0) && hasPpp) {
             // Any PPP connection the platform may have attached is now up
@@ -2506,9 +2509,7 @@ int32_t uCellNetRegister(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
 
@@ -2569,7 +2570,7 @@ int32_t uCellNetRegister(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -2600,9 +2601,7 @@ int32_t uCellNetActivate(uDeviceHandle_t cellHandle,
         // locked, so we alays take the PPP connection down first
         uPortPppDisconnect(cellHandle);
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             ((pUsername == NULL) || (pPassword != NULL))) {
@@ -2731,7 +2730,7 @@ int32_t uCellNetActivate(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
 
         if ((errorCode == 0) && hasPpp) {
             // Any PPP connection the platform may have attached is now up
@@ -2756,9 +2755,7 @@ int32_t uCellNetDeactivate(uDeviceHandle_t cellHandle,
         // is going down
         uPortPppDisconnect(cellHandle);
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             if (uCellPrivateIsRegistered(pInstance)) {
@@ -2784,7 +2781,7 @@ int32_t uCellNetDeactivate(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -2805,9 +2802,7 @@ int32_t uCellNetDisconnect(uDeviceHandle_t cellHandle,
         // is going down
         uPortPppDisconnect(cellHandle);
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -2835,7 +2830,7 @@ int32_t uCellNetDisconnect(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -2861,9 +2856,7 @@ int32_t uCellNetScanGetFirst(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrNumber = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) &&
             ((pName == NULL) || (nameSize > 0))) {
@@ -2979,7 +2972,7 @@ int32_t uCellNetScanGetFirst(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrNumber;
@@ -2995,9 +2988,7 @@ int32_t uCellNetScanGetNext(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = readNextScanItem(pInstance, pMccMnc, pName,
@@ -3008,7 +2999,7 @@ int32_t uCellNetScanGetNext(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -3021,15 +3012,13 @@ void uCellNetScanGetLast(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             // Free scan results
             uCellPrivateScanFree(&(pInstance->pScanResults));
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 }
 
@@ -3052,10 +3041,8 @@ int32_t uCellNetDeepScan(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCodeOrNumber = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             errorCodeOrNumber = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
             if (pInstance->pModule->moduleType == U_CELL_MODULE_TYPE_SARA_R5) {
@@ -3141,7 +3128,7 @@ int32_t uCellNetDeepScan(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrNumber;
@@ -3159,9 +3146,7 @@ int32_t uCellNetSetRegistrationStatusCallback(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             pInstance->pRegistrationStatusCallback = pCallback;
@@ -3169,7 +3154,7 @@ int32_t uCellNetSetRegistrationStatusCallback(uDeviceHandle_t cellHandle,
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -3188,9 +3173,7 @@ int32_t uCellNetSetBaseStationConnectionStatusCallback(uDeviceHandle_t cellHandl
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             atHandle = pInstance->atHandle;
@@ -3216,7 +3199,7 @@ int32_t uCellNetSetBaseStationConnectionStatusCallback(uDeviceHandle_t cellHandl
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -3231,9 +3214,7 @@ uCellNetStatus_t uCellNetGetNetworkStatus(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrStatus = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (domain < U_CELL_NET_REG_DOMAIN_MAX_NUM)) {
             // Assume circuit switched
@@ -3248,7 +3229,7 @@ uCellNetStatus_t uCellNetGetNetworkStatus(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return (uCellNetStatus_t) errorCodeOrStatus;
@@ -3262,14 +3243,12 @@ bool uCellNetIsRegistered(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             isRegistered = uCellPrivateIsRegistered(pInstance);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return isRegistered;
@@ -3283,15 +3262,13 @@ uCellNetRat_t uCellNetGetActiveRat(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrRat = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrRat = (int32_t) uCellPrivateGetActiveRat(pInstance);
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return (uCellNetRat_t) errorCodeOrRat;
@@ -3306,9 +3283,7 @@ int32_t uCellNetGetOperatorStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
             errorCodeOrSize = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
@@ -3326,7 +3301,7 @@ int32_t uCellNetGetOperatorStr(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
@@ -3344,9 +3319,7 @@ int32_t uCellNetGetMccMnc(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pMcc != NULL) && (pMnc != NULL)) {
             errorCode = (int32_t) U_CELL_ERROR_NOT_REGISTERED;
@@ -3387,7 +3360,7 @@ int32_t uCellNetGetMccMnc(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -3406,9 +3379,7 @@ int32_t uCellNetGetIpAddressStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrSize = (int32_t) U_CELL_ERROR_NOT_CONNECTED;
@@ -3480,7 +3451,7 @@ int32_t uCellNetGetIpAddressStr(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
@@ -3495,9 +3466,7 @@ int32_t uCellNetGetDnsStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -3512,7 +3481,7 @@ int32_t uCellNetGetDnsStr(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -3527,9 +3496,7 @@ int32_t uCellNetGetApnStr(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pStr != NULL) && (size > 0)) {
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
@@ -3546,7 +3513,7 @@ int32_t uCellNetGetApnStr(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
@@ -3568,9 +3535,7 @@ int32_t uCellNetGetDataCounterTx(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -3601,7 +3566,7 @@ int32_t uCellNetGetDataCounterTx(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrCount;
@@ -3619,9 +3584,7 @@ int32_t uCellNetGetDataCounterRx(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -3653,7 +3616,7 @@ int32_t uCellNetGetDataCounterRx(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrCount;
@@ -3668,9 +3631,7 @@ int32_t uCellNetResetDataCounters(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -3687,7 +3648,7 @@ int32_t uCellNetResetDataCounters(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -3705,15 +3666,13 @@ int32_t uCellNetGetAuthenticationMode(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrAuthenticationMode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrAuthenticationMode = (int32_t) pInstance->authenticationMode;
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrAuthenticationMode;
@@ -3728,9 +3687,7 @@ int32_t uCellNetSetAuthenticationMode(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (mode >= 0) &&
             (mode < U_CELL_NET_AUTHENTICATION_MODE_MAX_NUM)) {
@@ -3743,7 +3700,7 @@ int32_t uCellNetSetAuthenticationMode(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
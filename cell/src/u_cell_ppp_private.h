@@ -51,7 +51,8 @@ extern "C" {
  * This should be called _before_ uCellMuxPrivateRemoveContext(),
  * since it cleans up CMUX stuff of its own.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param[in] pInstance a pointer to the cellular instance.
  */
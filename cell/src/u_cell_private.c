@@ -719,6 +719,62 @@ uCellPrivateInstance_t *pUCellPrivateGetInstance(uDeviceHandle_t cellHandle)
     return pInstance;
 }
 
+// Find a cellular instance and lock its API mutex.
+uCellPrivateInstance_t *pUCellPrivateInstanceLock(uDeviceHandle_t cellHandle)
+{
+    uCellPrivateInstance_t *pInstance = NULL;
+    uPortMutexHandle_t apiMutex = NULL;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            // Count ourselves in so that the instance cannot
+            // be freed while we wait
+            pInstance->apiNumWaiting++;
+            apiMutex = pInstance->apiMutex;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+
+        if (pInstance != NULL) {
+            // Wait for the instance without holding the list
+            // mutex so that other instances remain usable
+            uPortMutexLock(apiMutex);
+
+            U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+            pInstance->apiNumWaiting--;
+            if (pInstance->apiRemoved) {
+                // The instance was removed while we waited:
+                // let go, while still holding the list mutex,
+                // as the remover may free everything as soon as
+                // apiNumWaiting has reached zero
+                uPortMutexUnlock(apiMutex);
+                if (pInstance->apiNumWaiting == 0) {
+                    // Last one out: let the remover know
+                    uPortSemaphoreGive(pInstance->apiGoneSemaphore);
+                }
+                pInstance = NULL;
+            }
+
+            U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        }
+    }
+
+    return pInstance;
+}
+
+// Unlock the API mutex of an instance.
+void uCellPrivateInstanceUnlock(const uCellPrivateInstance_t *pInstance)
+{
+    if (pInstance != NULL) {
+        uPortMutexUnlock(pInstance->apiMutex);
+    }
+}
+
 // Convert RSRP in 3GPP TS 36.133 format to dBm.
 int32_t uCellPrivateRsrpToDbm(int32_t rsrp)
 {
@@ -780,6 +836,8 @@ void uCellPrivateClearDynamicParameters(uCellPrivateInstance_t *pInstance)
         pInstance->rat[x] = U_CELL_NET_RAT_UNKNOWN_OR_NOT_USED;
     }
     uCellPrivateClearRadioParameters(&(pInstance->radioParameters), false);
+    // Whatever caused this may also have changed the SIM or firmware
+    uCellPrivateIdentityInvalidate(pInstance);
 }
 
 // Get the current CFUN mode.
@@ -862,6 +920,16 @@ void uCellPrivateCFunMode(uCellPrivateInstance_t *pInstance,
     if (uAtClientUnlock(atHandle) == 0) {
         pInstance->lastCfunFlipTimeMs = uPortGetTickTimeMs();
     }
+    if (mode == 0) {
+        // The SIM is deactivated in AT+CFUN=0 and so could be swapped
+        uCellPrivateIdentityInvalidate(pInstance);
+    }
+}
+
+// Mark any cached identity information as stale.
+void uCellPrivateIdentityInvalidate(uCellPrivateInstance_t *pInstance)
+{
+    pInstance->identityGeneration++;
 }
 
 // Get the IMSI of the SIM.
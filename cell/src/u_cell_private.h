@@ -487,6 +487,26 @@ typedef struct uCellPrivateInstance_t {
     void *pCellTimeCellSyncContext;   /**< Hook for CellTime cell synchronisation context. */
     void *pFenceContext; /**< Storage for a uGeofenceContext_t. */
     void *pPppContext; /**< Hook for a PPP connection context. */
+    void *pIdentityContext; /**< Cache of IMEI, IMSI etc., see u_cell_info.c. */
+    void *pSockContext; /**< Coalescing of socket data indications, see u_cell_sock.c. */
+    volatile int32_t identityGeneration; /**< Incremented, by
+                                              uCellPrivateIdentityInvalidate(),
+                                              when the contents of pIdentityContext
+                                              may no longer be true; volatile as
+                                              it can be changed by a URC. */
+    uPortMutexHandle_t apiMutex; /**< Serialises the API calls for this
+                                      instance, see pUCellPrivateInstanceLock(). */
+    size_t apiNumWaiting; /**< The number of tasks that have found this
+                               instance in the list and are waiting for
+                               apiMutex; protected by gUCellPrivateMutex. */
+    bool apiRemoved; /**< Set, under gUCellPrivateMutex, when the instance
+                          has been taken out of the list, so that anyone
+                          waiting for apiMutex knows to give up. */
+    uPortSemaphoreHandle_t apiGoneSemaphore; /**< Given by the last task
+                                                  to give up waiting for
+                                                  a removed instance, so
+                                                  that the remover can
+                                                  free it. */
     struct uCellPrivateInstance_t *pNext;
 } uCellPrivateInstance_t;
 
@@ -507,7 +527,17 @@ extern const size_t gUCellPrivateModuleListSize;
  */
 extern uCellPrivateInstance_t *gpUCellPrivateInstanceList;
 
-/** Mutex to protect the linked list.
+/** Mutex to protect the linked list.  This is only held for as long
+ * as it takes to manage the list (find, add or remove an instance):
+ * the API calls for an instance are serialised by the apiMutex of
+ * that instance, see pUCellPrivateInstanceLock(), so that a long
+ * operation on one cellular module (e.g. a file upload) does not
+ * hold up the others.
+ *
+ * The lock order is: the apiMutex of an instance, then
+ * gUCellPrivateMutex, then the AT client mutex (uAtClientLock()).
+ * Never wait for the apiMutex of an instance while holding
+ * gUCellPrivateMutex.
  */
 extern uPortMutexHandle_t gUCellPrivateMutex;
 
@@ -518,7 +548,8 @@ extern uPortMutexHandle_t gUCellPrivateMutex;
 /** Abort an AT command; only works if the AT command is actually
  * an abortable one according to the AT manual.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance a pointer to the instance.
  */
@@ -543,6 +574,30 @@ bool uCellPrivateIsNumeric(const char *pBuffer, size_t bufferSize);
  */
 uCellPrivateInstance_t *pUCellPrivateGetInstance(uDeviceHandle_t cellHandle);
 
+/** Find a cellular instance in the list by instance handle and
+ * lock its API mutex; gUCellPrivateMutex is only held while the
+ * instance is found, not while waiting for the API mutex, so
+ * calls on other instances may proceed meanwhile.  Must be
+ * followed by a call to uCellPrivateInstanceUnlock() with
+ * the returned pointer (which may be NULL).
+ *
+ * Note: gUCellPrivateMutex must NOT be locked when this is called.
+ *
+ * @param cellHandle  the instance handle.
+ * @return            a pointer to the instance, NULL if there
+ *                    is no such instance, in which case nothing
+ *                    is locked.
+ */
+uCellPrivateInstance_t *pUCellPrivateInstanceLock(uDeviceHandle_t cellHandle);
+
+/** Unlock the API mutex of an instance locked with
+ * pUCellPrivateInstanceLock().
+ *
+ * @param pInstance  a pointer to the instance; may be NULL,
+ *                   in which case this function does nothing.
+ */
+void uCellPrivateInstanceUnlock(const uCellPrivateInstance_t *pInstance);
+
 /** Convert RSRP in 3GPP TS 36.133 format to dBm.
  *
  * Returns 0 if the number is not known.
@@ -619,9 +674,19 @@ int32_t uCellPrivateCFunOne(uCellPrivateInstance_t *pInstance);
 void uCellPrivateCFunMode(uCellPrivateInstance_t *pInstance,
                           int32_t mode);
 
+/** Mark any cached identity information (IMEI, IMSI, ICCID,
+ * etc.) of an instance as stale, so that it is read from the
+ * module again the next time it is asked for.  This does not
+ * touch the AT interface and so may be called from a URC.
+ *
+ * @param pInstance  a pointer to the cellular instance.
+ */
+void uCellPrivateIdentityInvalidate(uCellPrivateInstance_t *pInstance);
+
 /** Get the IMSI of the SIM.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance  a pointer to the cellular instance.
  * @param pImsi      a pointer to 15 bytes in which the IMSI
@@ -633,7 +698,8 @@ int32_t uCellPrivateGetImsi(const uCellPrivateInstance_t *pInstance,
 
 /** Get the IMEI of the module.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance  a pointer to the cellular instance.
  * @param pImei      a pointer to 15 bytes in which the IMEI
@@ -645,7 +711,8 @@ int32_t uCellPrivateGetImei(const uCellPrivateInstance_t *pInstance,
 
 /** Get whether the given instance is registered with the network.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance  a pointer to the cellular instance.
  * @return           true if it is registered, else false.
@@ -664,7 +731,8 @@ uCellNetRat_t uCellPrivateModuleRatToCellRat(uCellModuleType_t moduleType,
 
 /** Get the active RAT.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance  a pointer to the cellular instance.
  * @return           the active RAT.
@@ -708,7 +776,8 @@ const uCellPrivateModule_t *pUCellPrivateGetModule(uDeviceHandle_t cellHandle);
 
 /** Remove the location context for the given instance.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance   a pointer to the cellular instance.
  */
@@ -716,7 +785,8 @@ void uCellPrivateLocRemoveContext(uCellPrivateInstance_t *pInstance);
 
 /** Remove the sleep context for the given instance.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance   a pointer to the cellular instance.
  */
@@ -793,7 +863,8 @@ int32_t uCellPrivateWakeUpCallback(uAtClientHandle_t atHandle,
  * power-on and after a RAT change; it doesn't talk to the module,
  * simply works on the current state of the module as known to this code.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance a pointer to the cellular instance.
  */
@@ -836,7 +907,8 @@ int32_t uCellPrivateResumeUartPowerSaving(const uCellPrivateInstance_t *pInstanc
 /** Delete a file from the file system. If the file does not exist an
  * error will be returned.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance      a pointer to the cellular instance.
  * @param[in] pFileName  a pointer to the file name to delete from the
@@ -851,7 +923,8 @@ int32_t uCellPrivateFileDelete(const uCellPrivateInstance_t *pInstance,
  * uCellPrivateFileListNext() should be called repeatedly to iterate
  * through subsequent entries in the list.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance           a pointer to the cellular instance.
  * @param ppFileListContainer a pointer to a place to store the pointer
@@ -911,7 +984,8 @@ void uCellPrivateHttpRemoveContext(uCellPrivateInstance_t *pInstance);
 /** Set the DTR pin in order to prevent power saving, or reset it to
  * allow power saving.
  *
- * Note:  gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance      a pointer to the cellular instance.
  * @param doNotPowerSave true to set the DTR pin such as to prevent
@@ -921,7 +995,8 @@ void uCellPrivateSetPinDtr(uCellPrivateInstance_t *pInstance, bool doNotPowerSav
 
 /** Get the cellular module's active serial interface configuration.
  *
- * Note:  gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance   a pointer to the cellular instance.
  * @return            active variant of serial interface or negative code
@@ -968,15 +1043,27 @@ bool uCellPrivateGnssInsideCell(const uCellPrivateInstance_t *pInstance);
 
 /** Remove the CellTime context for the given instance.
  *
- * Note:  gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance   a pointer to the cellular instance.
  */
 void uCellPrivateCellTimeRemoveContext(uCellPrivateInstance_t *pInstance);
 
+/** Remove the socket context, used for the coalescing of data
+ * indications, of the given instance; implemented in u_cell_sock.c.
+ *
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
+ *
+ * @param pInstance   a pointer to the cellular instance.
+ */
+void uCellSockPrivateRemoveContext(uCellPrivateInstance_t *pInstance);
+
 /** Get an ID string from the cellular module.
  *
- * Note:  gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param atHandle      the handle of the AT client that is talking
  *                      to the module.
@@ -996,7 +1083,8 @@ int32_t uCellPrivateGetIdStr(uAtClientHandle_t atHandle,
 
 /** Updates the module related settings for the given instance.
  *
- * Note:  gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance   a pointer to the cellular instance.
  */
@@ -41,7 +41,8 @@ extern "C" {
  * function returns success then the cellular module is ready to
  * receive configuration commands and register with the cellular network.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance          a pointer to the instance.
  * @param pKeepGoingCallback power on usually takes between 5 and
@@ -80,7 +81,8 @@ int32_t uCellPwrPrivateOn(uCellPrivateInstance_t *pInstance,
 
 /** Determine if the cellular module is alive.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance     a pointer to the instance.
  * @param attempts      the number of times to try poking it.
@@ -115,7 +117,8 @@ int32_t uCellPwrPrivatePeriodicWakeupStrToSeconds(const char *pStr,
 
 /** Get the 3GPP power saving settings.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance              a pointer to the cellular instance.
  * @param assignedNotRequested   if true then get the values assigned
@@ -144,7 +147,8 @@ int32_t uCellPwrPrivateGet3gppPowerSaving(uCellPrivateInstance_t *pInstance,
 
 /** Get the E-DRX settings for the given RAT.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance              a pointer to the cellular instance.
  * @param assignedNotRequested   true to get the assigned parameters,
@@ -176,7 +180,8 @@ int32_t uCellPwrPrivateGetEDrx(const uCellPrivateInstance_t *pInstance,
 
 /** Get the DTR power-saving pin.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance  a pointer to the cellular instance.
  * @return           the pin of this MCU that is connected to
@@ -190,7 +195,8 @@ int32_t uCellPwrPrivateGetDtrPowerSavingPin(const uCellPrivateInstance_t *pInsta
  * enabled where supported by the module; call this function
  * to disable 32 kHz sleep.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance   a pointer to the cellular instance.
  * @return            zero on success or negative error code on
@@ -202,7 +208,8 @@ int32_t uCellPwrPrivateDisableUartSleep(uCellPrivateInstance_t *pInstance);
  * where supported - you only need to call this if you have
  * previously called uCellPwrDisableUartSleep().
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance   a pointer to the cellular instance.
  * @return            zero on success or negative error code on
@@ -212,7 +219,8 @@ int32_t uCellPwrPrivateEnableUartSleep(uCellPrivateInstance_t *pInstance);
 
 /** Determine whether UART, AKA 32 kHz, sleep is enabled or not.
  *
- * Note: gUCellPrivateMutex should be locked before this is called.
+ * Note: the instance should be locked, see pUCellPrivateInstanceLock(),
+ * before this is called.
  *
  * @param pInstance   a pointer to the cellular instance.
  * @return            true if UART sleep is enabled, else false.
@@ -146,9 +146,7 @@ static int32_t ztpGet(uDeviceHandle_t cellHandle, int32_t type,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -180,7 +178,7 @@ static int32_t ztpGet(uDeviceHandle_t cellHandle, int32_t type,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
@@ -209,9 +207,7 @@ bool uCellSecIsSupported(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             isSupported = U_CELL_PRIVATE_HAS(pInstance->pModule,
                                              U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST);
@@ -235,7 +231,7 @@ bool uCellSecIsSupported(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return isSupported;
@@ -252,9 +248,7 @@ bool uCellSecIsBootstrapped(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
                                    U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)) {
@@ -287,7 +281,7 @@ bool uCellSecIsBootstrapped(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return isBootstrapped;
@@ -319,16 +313,14 @@ int32_t uCellSecGetRootOfTrustUid(uDeviceHandle_t cellHandle,
 {
     int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     int32_t sizeOutBytes;
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
     char buffer[(U_SECURITY_ROOT_OF_TRUST_UID_LENGTH_BYTES * 2) + 1]; // * 2 for hex,  +1 for terminator
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         if (pRootOfTrustUid != NULL) {
-            pInstance = pUCellPrivateGetInstance(cellHandle);
+            pInstance = pUCellPrivateInstanceLock(cellHandle);
             errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
             if (pInstance != NULL) {
                 errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -362,7 +354,7 @@ int32_t uCellSecGetRootOfTrustUid(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
@@ -384,9 +376,7 @@ int32_t uCellSecSealSet(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pDeviceProfileUid != NULL) &&
             (pDeviceSerialNumberStr != NULL)) {
@@ -417,7 +407,7 @@ int32_t uCellSecSealSet(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -431,9 +421,7 @@ bool uCellSecIsSealed(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             if (U_CELL_PRIVATE_HAS(pInstance->pModule,
                                    U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)) {
@@ -441,7 +429,7 @@ bool uCellSecIsSealed(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return isSealed;
@@ -493,9 +481,7 @@ int32_t uCellSecPskGenerate(uDeviceHandle_t cellHandle,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pInstance != NULL) && (pPsk != NULL) && (pPskId != NULL) &&
             ((pskSizeBytes == 16) || (pskSizeBytes == 32))) {
@@ -538,7 +524,7 @@ int32_t uCellSecPskGenerate(uDeviceHandle_t cellHandle,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
@@ -557,9 +543,7 @@ int32_t uCellSecHeartbeatTrigger(uDeviceHandle_t cellHandle)
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -575,7 +559,7 @@ int32_t uCellSecHeartbeatTrigger(uDeviceHandle_t cellHandle)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -150,6 +150,7 @@ static const uCellSecTlsIanaToLegacy_t gIanaToLegacyCipher[] = {
  * -------------------------------------------------------------- */
 
 // Get a new context.
+// gUCellPrivateMutex should be locked before this is called.
 static uCellSecTlsContext_t *pNewContext()
 {
     uCellSecTlsContext_t *pContext = NULL;
@@ -175,6 +176,7 @@ static uCellSecTlsContext_t *pNewContext()
 }
 
 // Free a security context.
+// gUCellPrivateMutex should be locked before this is called.
 static void freeContext(const uCellSecTlsContext_t *pContext)
 {
     uint8_t profileId = pContext->profileId;
@@ -193,16 +195,14 @@ static int32_t setString(const uCellSecTlsContext_t *pContext,
                          int32_t opCode)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 // Talk to the cellular module to set the string thing
@@ -219,7 +219,7 @@ static int32_t setString(const uCellSecTlsContext_t *pContext,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -231,17 +231,15 @@ static int32_t getString(const uCellSecTlsContext_t *pContext,
                          int32_t opCode)
 {
     int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
     int32_t readSize = 0;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 // Talk to the cellular module to get the string thing
@@ -267,7 +265,7 @@ static int32_t getString(const uCellSecTlsContext_t *pContext,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCodeOrSize;
@@ -280,7 +278,7 @@ static int32_t setSequence(const uCellSecTlsContext_t *pContext,
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     const uCellPrivateModule_t *pModule;
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
     char *pString = NULL;
     size_t y;
@@ -289,11 +287,9 @@ static int32_t setSequence(const uCellSecTlsContext_t *pContext,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 pModule = pUCellPrivateGetModule(pContext->cellHandle);
                 if (U_CELL_PRIVATE_HAS(pModule,
@@ -352,7 +348,7 @@ static int32_t setSequence(const uCellSecTlsContext_t *pContext,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -381,18 +377,16 @@ static int32_t cipherSuiteSet(const uCellSecTlsContext_t *pContext,
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     const uCellPrivateModule_t *pModule;
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
     int32_t y = 100;
     char buffer[3]; // Enough room for, e.g. "C0" and a null terminator
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
                 pModule = pUCellPrivateGetModule(pContext->cellHandle);
@@ -456,7 +450,7 @@ static int32_t cipherSuiteSet(const uCellSecTlsContext_t *pContext,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -528,19 +522,17 @@ static int32_t setGeneratePsk(const uCellSecTlsContext_t *pContext,
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     const uCellPrivateModule_t *pModule;
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
             pModule = pUCellPrivateGetModule(pContext->cellHandle);
             if (U_CELL_PRIVATE_HAS(pModule, U_CELL_PRIVATE_FEATURE_ROOT_OF_TRUST)) {
-                pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+                pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
                 if (pInstance != NULL) {
                     atHandle = pInstance->atHandle;
                     // Talk to the cellular module to set the PSK
@@ -565,7 +557,7 @@ static int32_t setGeneratePsk(const uCellSecTlsContext_t *pContext,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -594,13 +586,15 @@ uCellSecTlsContext_t *pUCellSecSecTlsAdd(uDeviceHandle_t cellHandle)
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pInstance = pUCellPrivateGetInstance(cellHandle);
+        pInstance = pUCellPrivateInstanceLock(cellHandle);
         if (pInstance != NULL) {
             gLastErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            // The context list is shared between instances so
+            // it is protected by the list mutex
+            U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
             pContext = pNewContext();
+            U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
             if (pContext != NULL) {
                 pContext->cellHandle = cellHandle;
                 atHandle = pInstance->atHandle;
@@ -614,13 +608,15 @@ uCellSecTlsContext_t *pUCellSecSecTlsAdd(uDeviceHandle_t cellHandle)
                 if (gLastErrorCode != 0) {
                     // If initialisation failed, free the
                     // context again
+                    U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
                     freeContext(pContext);
+                    U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
                     pContext = NULL;
                 }
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return pContext;
@@ -758,7 +754,7 @@ int32_t uCellSecTlsUseDeviceCertificateSet(const uCellSecTlsContext_t *pContext,
                                            bool includeCaCertificates)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
     int32_t parameter = 2; // Default is not to include CA certificates
 
@@ -768,11 +764,9 @@ int32_t uCellSecTlsUseDeviceCertificateSet(const uCellSecTlsContext_t *pContext,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 uAtClientLock(atHandle);
@@ -785,7 +779,7 @@ int32_t uCellSecTlsUseDeviceCertificateSet(const uCellSecTlsContext_t *pContext,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return errorCode;
@@ -796,7 +790,7 @@ int32_t uCellSecTlsUseDeviceCertificateSet(const uCellSecTlsContext_t *pContext,
 bool uCellSecTlsIsUsingDeviceCertificate(const uCellSecTlsContext_t *pContext,
                                          bool *pIncludeCaCertificates)
 {
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
     int32_t x;
     bool isUsingDeviceCertificate = false;
@@ -807,10 +801,8 @@ bool uCellSecTlsIsUsingDeviceCertificate(const uCellSecTlsContext_t *pContext,
 
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 uAtClientLock(atHandle);
@@ -834,7 +826,7 @@ bool uCellSecTlsIsUsingDeviceCertificate(const uCellSecTlsContext_t *pContext,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return isUsingDeviceCertificate;
@@ -864,7 +856,7 @@ int32_t uCellSecTlsCipherSuiteRemove(const uCellSecTlsContext_t *pContext,
 int32_t uCellSecTlsCipherSuiteListFirst(uCellSecTlsContext_t *pContext)
 {
     const uCellPrivateModule_t *pModule;
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
     uCellSecTlsCipherList_t *pCipherList;
     int32_t readSize = 0;
@@ -872,11 +864,9 @@ int32_t uCellSecTlsCipherSuiteListFirst(uCellSecTlsContext_t *pContext)
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
                 pModule = pUCellPrivateGetModule(pContext->cellHandle);
@@ -927,7 +917,7 @@ int32_t uCellSecTlsCipherSuiteListFirst(uCellSecTlsContext_t *pContext)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return gLastErrorCode;
@@ -982,18 +972,16 @@ void uCellSecTlsCipherSuiteListLast(uCellSecTlsContext_t *pContext)
 int32_t uCellSecTlsVersionSet(const uCellSecTlsContext_t *pContext,
                               int32_t tlsVersionMin)
 {
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
     int32_t x = 0;
 
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pContext != NULL) && (tlsVersionMin >= 0) && (tlsVersionMin <= 12)) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 // Convert to module version number
                 switch (tlsVersionMin) {
@@ -1028,7 +1016,7 @@ int32_t uCellSecTlsVersionSet(const uCellSecTlsContext_t *pContext,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return gLastErrorCode;
@@ -1037,18 +1025,16 @@ int32_t uCellSecTlsVersionSet(const uCellSecTlsContext_t *pContext,
 // Get the minimum [D]TLS version in use.
 int32_t uCellSecTlsVersionGet(const uCellSecTlsContext_t *pContext)
 {
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
     int32_t x;
 
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if (pContext != NULL) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 // Talk to the cellular module to get the minimum
@@ -1090,7 +1076,7 @@ int32_t uCellSecTlsVersionGet(const uCellSecTlsContext_t *pContext)
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return gLastErrorCode;
@@ -1101,19 +1087,17 @@ int32_t uCellSecTlsCertificateCheckSet(const uCellSecTlsContext_t *pContext,
                                        uCellSecTlsCertficateCheck_t check,
                                        const char *pUrl)
 {
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
 
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pContext != NULL) &&
             ((check < U_CELL_SEC_TLS_CERTIFICATE_CHECK_ROOT_CA_URL) || (pUrl != NULL)) &&
             (check < U_CELL_SEC_TLS_CERTIFICATE_CHECK_MAX_NUM)) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 gLastErrorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -1146,7 +1130,7 @@ int32_t uCellSecTlsCertificateCheckSet(const uCellSecTlsContext_t *pContext,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return gLastErrorCode;
@@ -1156,7 +1140,7 @@ int32_t uCellSecTlsCertificateCheckSet(const uCellSecTlsContext_t *pContext,
 int32_t uCellSecTlsCertificateCheckGet(const uCellSecTlsContext_t *pContext,
                                        char *pUrl, size_t size)
 {
-    uCellPrivateInstance_t *pInstance;
+    uCellPrivateInstance_t *pInstance = NULL;
     uAtClientHandle_t atHandle;
     int32_t x;
     int32_t readSize = 0;
@@ -1164,11 +1148,9 @@ int32_t uCellSecTlsCertificateCheckGet(const uCellSecTlsContext_t *pContext,
     gLastErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     if (gUCellPrivateMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
-
         gLastErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((pContext != NULL) && ((pUrl == NULL) || (size > 0))) {
-            pInstance = pUCellPrivateGetInstance(pContext->cellHandle);
+            pInstance = pUCellPrivateInstanceLock(pContext->cellHandle);
             if (pInstance != NULL) {
                 atHandle = pInstance->atHandle;
                 // Talk to the cellular module to get the certificate
@@ -1216,7 +1198,7 @@ int32_t uCellSecTlsCertificateCheckGet(const uCellSecTlsContext_t *pContext,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+        uCellPrivateInstanceUnlock(pInstance);
     }
 
     return gLastErrorCode;
@@ -36,6 +36,7 @@
 #include "limits.h"    // UINT16_MAX
 
 #include "u_cfg_sw.h"
+#include "u_error_common.h"
 
 #include "u_compiler.h"
 #include "u_port.h"
@@ -99,6 +100,14 @@
 #define U_CELL_SOCK_SARA_R422_DNS_DELAY_MILLISECONDS 500
 #endif
 
+#ifndef U_CELL_SOCK_DATA_COALESCE_RETRY_MS
+/** If the coalescing window timer expires at a moment when the
+ * delivery of a batch cannot be queued without waiting, it is
+ * restarted with this interval to try again.
+ */
+# define U_CELL_SOCK_DATA_COALESCE_RETRY_MS 5
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -118,6 +127,10 @@ typedef struct {
     uSockProtocol_t protocol; /**< the protocol type, ONLY required to work-around
                                    a peculiarity of LENA-R8. */
     volatile int32_t pendingBytes;
+    bool dataIndicated; /**< Set by the +UUSORD/+UUSORF URC handler,
+                             cleared when the indication has been
+                             delivered; protected by the mutex of
+                             the socket context of the instance. */
     void (*pAsyncClosedCallback) (uDeviceHandle_t, int32_t); /**< Set to NULL
                                                           if socket is
                                                           not in use. */
@@ -130,6 +143,27 @@ typedef struct {
     bool closedByRemote; /**< Will be set to true if +UUSOCL lands. */
 } uCellSockSocket_t;
 
+/** Context for the coalescing of data indications on the sockets
+ * of a cellular instance, hooked into pSockContext.  The mutex is
+ * only ever held while flags are read or written, never across an
+ * AT command or a user callback, so the URC handler may take it.
+ */
+typedef struct {
+    uPortMutexHandle_t mutex; /**< Protects batchScheduled and the
+                                   dataIndicated flags of the sockets
+                                   of the instance. */
+    uPortTimerHandle_t windowTimer; /**< One-shot timer for the coalescing
+                                         window, NULL if there isn't one. */
+    bool batchScheduled; /**< True if a delivery has been scheduled
+                              and has not yet started. */
+    int32_t windowMs; /**< The coalescing window, see
+                           uCellSockSetDataCoalesceWindow(). */
+    void (*pDataReadyCallback) (uDeviceHandle_t,
+                                const uCellSockDataReady_t *,
+                                size_t, void *);
+    void *pDataReadyCallbackParameter;
+} uCellSockContext_t;
+
 /** Definition of a URC handler.
  */
 typedef struct {
@@ -223,6 +257,7 @@ static uCellSockSocket_t *pSockCreate(int32_t sockHandle,
         pSock->atHandle = atHandle;
         pSock->sockHandleModule = -1;
         pSock->pendingBytes = 0;
+        pSock->dataIndicated = false;
         pSock->protocol = 0;
         pSock->pAsyncClosedCallback = NULL;
         pSock->pDataCallback = NULL;
@@ -247,6 +282,7 @@ static void sockFree(int32_t sockHandle)
             pSock->atHandle = NULL;
             pSock->sockHandleModule = -1;
             pSock->pendingBytes = 0;
+            pSock->dataIndicated = false;
             pSock->protocol = 0;
             pSock->pAsyncClosedCallback = NULL;
             pSock->pDataCallback = NULL;
@@ -260,28 +296,147 @@ static void sockFree(int32_t sockHandle)
  * STATIC FUNCTIONS: URC AND RELATED FUNCTIONS
  * -------------------------------------------------------------- */
 
-// Callback trampoline for pending data.
-static void dataCallback(const uAtClientHandle_t atHandle,
-                         void *pParameter)
+// Callback trampoline for pending data: delivers, in one go, all
+// of the sockets of an instance that the module has indicated
+// have data waiting since the last delivery.  pParameter is the
+// device handle, rather than the instance, since the instance may
+// have been removed by the time this runs.
+static void dataReadyCallback(const uAtClientHandle_t atHandle,
+                              void *pParameter)
 {
-    //lint -e(507) Suppress size incompatibility: the compiler
-    // we use for Lint checking is 64 bit so has 8 byte pointers
-    // and Lint doesn't like them being used to carry 4 byte integers
-    int32_t sockHandle = U_PTR_TO_INT32(pParameter);
+    uDeviceHandle_t cellHandle = (uDeviceHandle_t) pParameter;
+    uCellPrivateInstance_t *pInstance;
+    uCellSockContext_t *pContext = NULL;
+    uCellSockDataReady_t ready[U_CELL_SOCK_MAX_NUM_SOCKETS];
+    size_t numReady = 0;
     uCellSockSocket_t *pSocket;
+    void (*pDataReadyCallback) (uDeviceHandle_t, const uCellSockDataReady_t *,
+                                size_t, void *) = NULL;
+    void *pDataReadyCallbackParameter = NULL;
 
-    (void) atHandle;
+    if (gUCellPrivateMutex != NULL) {
 
-    if (sockHandle >= 0) {
-        // Find the entry
-        pSocket = pFindBySockHandle(sockHandle);
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            pContext = (uCellSockContext_t *) pInstance->pSockContext;
+        }
+        if (pContext != NULL) {
+
+            U_PORT_MUTEX_LOCK(pContext->mutex);
+
+            // From here on, a new indication must schedule a new batch
+            pContext->batchScheduled = false;
+            for (size_t x = 0; x < sizeof(gSockets) / sizeof(gSockets[0]); x++) {
+                pSocket = &(gSockets[x]);
+                if ((pSocket->atHandle == atHandle) && pSocket->dataIndicated) {
+                    pSocket->dataIndicated = false;
+                    if (pSocket->sockHandle >= 0) {
+                        ready[numReady].sockHandle = pSocket->sockHandle;
+                        ready[numReady].pendingBytes = pSocket->pendingBytes;
+                        numReady++;
+                    }
+                }
+            }
+            pDataReadyCallback = pContext->pDataReadyCallback;
+            pDataReadyCallbackParameter = pContext->pDataReadyCallbackParameter;
+
+            U_PORT_MUTEX_UNLOCK(pContext->mutex);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    // The user callbacks are called without any lock held
+    if ((numReady > 0) && (pDataReadyCallback != NULL)) {
+        pDataReadyCallback(cellHandle, ready, numReady,
+                           pDataReadyCallbackParameter);
+    }
+    for (size_t x = 0; x < numReady; x++) {
+        // Find the entry again, the callback above may have closed it
+        pSocket = pFindBySockHandle(ready[x].sockHandle);
         if ((pSocket != NULL) && (pSocket->pDataCallback != NULL)) {
             pSocket->pDataCallback(pSocket->cellHandle,
-                                   sockHandle);
+                                   ready[x].sockHandle);
         }
     }
 }
 
+// Callback for the coalescing window timer: queue the delivery of
+// the batch.  pParameter is the device handle, the instance being
+// looked up again, and this must not block the timer task so, if
+// the instance or the AT client callback queue can't be got at
+// right now, the timer is restarted to try again.
+static void windowTimerCallback(const uPortTimerHandle_t timerHandle,
+                                void *pParameter)
+{
+    uDeviceHandle_t cellHandle = (uDeviceHandle_t) pParameter;
+    uCellPrivateInstance_t *pInstance;
+    bool retry = true;
+
+    if ((gUCellPrivateMutex != NULL) &&
+        (uPortMutexTryLock(gUCellPrivateMutex, 0) == 0)) {
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        // Nothing to do if the instance has gone
+        retry = (pInstance != NULL) &&
+                (uAtClientCallbackNoWait(pInstance->atHandle, dataReadyCallback,
+                                         cellHandle) != 0);
+        uPortMutexUnlock(gUCellPrivateMutex);
+    }
+    if (retry &&
+        (uPortTimerChange(timerHandle, U_CELL_SOCK_DATA_COALESCE_RETRY_MS) == 0)) {
+        uPortTimerStart(timerHandle);
+    }
+}
+
+// Create the coalescing window timer of an instance if there
+// is a window and there is not yet a timer.
+static int32_t windowTimerCreate(uCellPrivateInstance_t *pInstance,
+                                 uCellSockContext_t *pContext)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uPortTimerHandle_t timerHandle;
+
+    if ((pContext->windowMs > 0) && (pContext->windowTimer == NULL)) {
+        errorCode = uPortTimerCreate(&timerHandle, "cellSockWindow",
+                                     windowTimerCallback,
+                                     (void *) pInstance->cellHandle,
+                                     pContext->windowMs, false);
+        if (errorCode == 0) {
+            pContext->windowTimer = timerHandle;
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the socket context of an instance, allocating it if
+// necessary; returns NULL if there is no memory.
+static uCellSockContext_t *pSockContextGet(uCellPrivateInstance_t *pInstance)
+{
+    uCellSockContext_t *pContext = (uCellSockContext_t *) pInstance->pSockContext;
+
+    if (pContext == NULL) {
+        pContext = (uCellSockContext_t *) pUPortMalloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            memset(pContext, 0, sizeof(*pContext));
+            if (uPortMutexCreate(&(pContext->mutex)) == 0) {
+                pContext->windowMs = U_CELL_SOCK_DATA_COALESCE_WINDOW_MS;
+                // If there is no timer the indications are
+                // simply delivered without a window
+                windowTimerCreate(pInstance, pContext);
+                pInstance->pSockContext = pContext;
+            } else {
+                uPortFree(pContext);
+                pContext = NULL;
+            }
+        }
+    }
+
+    return pContext;
+}
+
 // Callback trampoline for connection closed.
 static void closedCallback(const uAtClientHandle_t atHandle,
                            void *pParameter)
@@ -320,13 +475,21 @@ static void closedCallback(const uAtClientHandle_t atHandle,
 
 // Socket Read/Read-From URC.
 static void UUSORD_UUSORF_urc(const uAtClientHandle_t atHandle,
-                              void *pUnused)
+                              void *pParameter)
 {
+    uCellPrivateInstance_t *pInstance = (uCellPrivateInstance_t *) pParameter;
+    uCellSockContext_t *pContext = NULL;
     int32_t sockHandleModule;
     int32_t dataSizeBytes;
     uCellSockSocket_t *pSocket = NULL;
+    bool schedule;
+    int32_t windowMs;
+    uPortTimerHandle_t timerHandle;
+    int32_t errorCode;
 
-    (void) pUnused;
+    if (pInstance != NULL) {
+        pContext = (uCellSockContext_t *) pInstance->pSockContext;
+    }
 
     // +UUSORx: <socket>,<length>
     sockHandleModule = uAtClientReadInt(atHandle);
@@ -337,14 +500,48 @@ static void UUSORD_UUSORF_urc(const uAtClientHandle_t atHandle,
         pSocket = pFindBySockHandleModule(atHandle,
                                           sockHandleModule);
         if (pSocket != NULL) {
-            // Call the user call-back via the trampoline
-            if ((dataSizeBytes > 0) &&
-                (pSocket->pDataCallback != NULL)) {
-                uAtClientCallback(atHandle,
-                                  dataCallback,
-                                  U_INT32_TO_PTR(pSocket->sockHandle));
-            }
             pSocket->pendingBytes = dataSizeBytes;
+            // Call the user call-backs via the trampoline; only
+            // one call is queued for any number of indications
+            // that arrive before it has been run
+            if ((dataSizeBytes > 0) && (pContext != NULL) &&
+                ((pSocket->pDataCallback != NULL) ||
+                 (pContext->pDataReadyCallback != NULL))) {
+
+                U_PORT_MUTEX_LOCK(pContext->mutex);
+
+                pSocket->dataIndicated = true;
+                schedule = !pContext->batchScheduled;
+                pContext->batchScheduled = true;
+                windowMs = pContext->windowMs;
+                timerHandle = pContext->windowTimer;
+
+                U_PORT_MUTEX_UNLOCK(pContext->mutex);
+
+                // Schedule outside the lock, since queueing
+                // may have to wait for dataReadyCallback()
+                if (schedule) {
+                    errorCode = -1;
+                    if ((windowMs > 0) && (timerHandle != NULL) &&
+                        (uPortTimerChange(timerHandle, windowMs) == 0)) {
+                        // Hold off for the window with the timer,
+                        // rather than in the callback task
+                        errorCode = uPortTimerStart(timerHandle);
+                    }
+                    if (errorCode != 0) {
+                        errorCode = uAtClientCallback(atHandle, dataReadyCallback,
+                                                      (void *) pInstance->cellHandle);
+                    }
+                    if (errorCode != 0) {
+
+                        U_PORT_MUTEX_LOCK(pContext->mutex);
+
+                        pContext->batchScheduled = false;
+
+                        U_PORT_MUTEX_UNLOCK(pContext->mutex);
+                    }
+                }
+            }
         }
     }
 }
@@ -659,6 +856,26 @@ static int32_t doUsoctl(uDeviceHandle_t cellHandle, int32_t sockHandle,
     return negErrnoLocallOrValue;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO CELLULAR
+ * -------------------------------------------------------------- */
+
+// Remove the socket context of an instance.
+void uCellSockPrivateRemoveContext(uCellPrivateInstance_t *pInstance)
+{
+    uCellSockContext_t *pContext = (uCellSockContext_t *) pInstance->pSockContext;
+
+    if (pContext != NULL) {
+        if (pContext->windowTimer != NULL) {
+            uPortTimerStop(pContext->windowTimer);
+            uPortTimerDelete(pContext->windowTimer);
+        }
+        uPortMutexDelete(pContext->mutex);
+        uPortFree(pContext);
+        pInstance->pSockContext = NULL;
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: WORKAROUND FOR LINKER ISSUE
  * -------------------------------------------------------------- */
@@ -686,6 +903,7 @@ int32_t uCellSockInit()
             pSock->sockHandle = -1;
             pSock->sockHandleModule = -1;
             pSock->pendingBytes = 0;
+            pSock->dataIndicated = false;
             pSock->pDataCallback = NULL;
             pSock->pClosedCallback = NULL;
         }
@@ -705,7 +923,10 @@ int32_t uCellSockInitInstance(uDeviceHandle_t cellHandle)
     if (gInitialised) {
         pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
-            errnoLocal = U_SOCK_ENONE;
+            errnoLocal = U_SOCK_ENOMEM;
+            if (pSockContextGet(pInstance) != NULL) {
+                errnoLocal = U_SOCK_ENONE;
+            }
             // Set up the URCs
             for (size_t x = 0; (x < sizeof(gUrcHandlers) /
                                 sizeof(gUrcHandlers[0])) &&
@@ -713,7 +934,7 @@ int32_t uCellSockInitInstance(uDeviceHandle_t cellHandle)
                 if (uAtClientSetUrcHandler(pInstance->atHandle,
                                            gUrcHandlers[x].pPrefix,
                                            gUrcHandlers[x].pHandler,
-                                           NULL) != 0) {
+                                           pInstance) != 0) {
                     errnoLocal = U_SOCK_ENOMEM;
                 }
             }
@@ -1685,6 +1906,7 @@ int32_t uCellSockRead(uDeviceHandle_t cellHandle,
     int32_t totalReceivedSize = 0;
     int32_t readLength;
     char *pHexBuffer = NULL;
+    uAtClientView_t view;
 
     // Find the instance
     pInstance = pUCellPrivateGetInstance(cellHandle);
@@ -1764,11 +1986,23 @@ int32_t uCellSockRead(uDeviceHandle_t cellHandle,
                         }
                         if (thisActualReceiveSize > 0) {
                             if (pInstance->socketsHexMode) {
-                                // In hex mode we need a buffer to dump
-                                // the hex into and then we can decode it
-                                negErrnoLocalOrSize = -U_SOCK_ENOMEM;
-                                //lint -e{647} Suppress suspicious truncation
-                                pHexBuffer = (char *) pUPortMalloc(thisActualReceiveSize * 2 + 1);  // +1 for terminator
+                                // In hex mode, first try to decode the hex
+                                // straight out of the AT client's buffer
+                                readLength = uAtClientReadStringView(atHandle, &view, false);
+                                if (readLength > 0) {
+                                    x = ((int32_t) dataSizeBytes) * 2;
+                                    if (readLength > x) {
+                                        view.length = x;
+                                    }
+                                    uAtClientViewHexToBin(&view, (char *) pData + totalReceivedSize,
+                                                          dataSizeBytes);
+                                } else if (readLength == (int32_t) U_ERROR_COMMON_NO_MEMORY) {
+                                    // Too long for that: we need a buffer to
+                                    // dump the hex into and then we can decode it
+                                    negErrnoLocalOrSize = -U_SOCK_ENOMEM;
+                                    //lint -e{647} Suppress suspicious truncation
+                                    pHexBuffer = (char *) pUPortMalloc(thisActualReceiveSize * 2 + 1);  // +1 for terminator
+                                }
                             }
                             if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
                                 negErrnoLocalOrSize = U_SOCK_ENONE;
@@ -1788,6 +2022,7 @@ int32_t uCellSockRead(uDeviceHandle_t cellHandle,
                                     }
                                     // Free memory
                                     uPortFree(pHexBuffer);
+                                    pHexBuffer = NULL;
                                 } else {
                                     // Binary mode, don't stop for anything!
                                     uAtClientIgnoreStopTag(atHandle);
@@ -1870,6 +2105,65 @@ void uCellSockRegisterCallbackData(uDeviceHandle_t cellHandle,
     }
 }
 
+// Register a callback on the set of sockets that have data waiting.
+int32_t uCellSockRegisterCallbackDataReady(uDeviceHandle_t cellHandle,
+                                           void (*pCallback) (uDeviceHandle_t,
+                                                              const uCellSockDataReady_t *,
+                                                              size_t,
+                                                              void *),
+                                           void *pCallbackParameter)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uCellPrivateInstance_t *pInstance;
+    uCellSockContext_t *pContext;
+
+    // Find the instance
+    pInstance = pUCellPrivateGetInstance(cellHandle);
+    if (pInstance != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = pSockContextGet(pInstance);
+        if (pContext != NULL) {
+            // Set the parameter first as the URC handler
+            // only checks the callback
+            pContext->pDataReadyCallbackParameter = pCallbackParameter;
+            pContext->pDataReadyCallback = pCallback;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Set the window over which data indications are coalesced.
+int32_t uCellSockSetDataCoalesceWindow(uDeviceHandle_t cellHandle,
+                                       int32_t windowMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uCellPrivateInstance_t *pInstance;
+    uCellSockContext_t *pContext;
+
+    // Find the instance
+    pInstance = pUCellPrivateGetInstance(cellHandle);
+    if ((pInstance != NULL) && (windowMs >= 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pContext = pSockContextGet(pInstance);
+        if (pContext != NULL) {
+
+            U_PORT_MUTEX_LOCK(pContext->mutex);
+
+            pContext->windowMs = windowMs;
+            errorCode = windowTimerCreate(pInstance, pContext);
+            if (errorCode != 0) {
+                pContext->windowMs = 0;
+            }
+
+            U_PORT_MUTEX_UNLOCK(pContext->mutex);
+        }
+    }
+
+    return errorCode;
+}
+
 // Register a callback on a socket being closed.
 void uCellSockRegisterCallbackClosed(uDeviceHandle_t cellHandle,
                                      int32_t sockHandle,
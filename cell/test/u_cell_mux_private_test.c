@@ -35,7 +35,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memcmp()/memset()
+#include "string.h"    // memcmp()/memset()/strstr()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -56,6 +56,7 @@
 #include "u_port_os.h"
 #include "u_port_heap.h"
 #include "u_port_debug.h"
+#include "u_port_uart.h"
 
 #include "u_cell_module_type.h"
 #include "u_cell.h"
@@ -106,10 +107,98 @@
 # define U_CELL_MUX_PRIVATE_TEST_FILL_CHAR 0xFF
 #endif
 
+#ifndef U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS
+/** The number of CMUX channels that the simulated module in the
+ * cellMuxPrivateLatency test keeps track of.
+ */
+# define U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS 8
+#endif
+
+#ifndef U_CELL_MUX_PRIVATE_TEST_SIM_BUFFER_LENGTH_BYTES
+/** The size of the receive buffer of the simulated module.
+ */
+# define U_CELL_MUX_PRIVATE_TEST_SIM_BUFFER_LENGTH_BYTES 1024
+#endif
+
+#ifndef U_CELL_MUX_PRIVATE_TEST_SIM_FRAMES_IN_FLIGHT
+/** The number of frames that the simulated module continues
+ * to send on a channel after it has been flow controlled off,
+ * as a real module would with frames already in flight.
+ */
+# define U_CELL_MUX_PRIVATE_TEST_SIM_FRAMES_IN_FLIGHT 1
+#endif
+
+#ifndef U_CELL_MUX_PRIVATE_TEST_SIM_PERIOD_MS
+/** The period at which the simulated module sends a frame of
+ * data on each open user channel other than the AT channel:
+ * a full frame every 10 ms on two channels is more than the
+ * 115,200 bits/s UART of a real module could carry.
+ */
+# define U_CELL_MUX_PRIVATE_TEST_SIM_PERIOD_MS 10
+#endif
+
+#ifndef U_CELL_MUX_PRIVATE_TEST_PPP_CHANNEL
+/** The CMUX channel that the cellMuxPrivateLatency test uses
+ * for PPP-like bulk data.
+ */
+# define U_CELL_MUX_PRIVATE_TEST_PPP_CHANNEL U_CELL_MUX_PRIVATE_CHANNEL_ID_PPP
+#endif
+
+#ifndef U_CELL_MUX_PRIVATE_TEST_SLOW_READ_LENGTH_BYTES
+/** How much the deliberately slow consumer of the GNSS channel
+ * reads every #U_CELL_MUX_PRIVATE_TEST_SLOW_READ_PERIOD_MS.
+ */
+# define U_CELL_MUX_PRIVATE_TEST_SLOW_READ_LENGTH_BYTES 16
+#endif
+
+#ifndef U_CELL_MUX_PRIVATE_TEST_SLOW_READ_PERIOD_MS
+/** The read period of the deliberately slow consumer of the
+ * GNSS channel.
+ */
+# define U_CELL_MUX_PRIVATE_TEST_SLOW_READ_PERIOD_MS 100
+#endif
+
+#ifndef U_CELL_MUX_PRIVATE_TEST_AT_COMMANDS
+/** The number of AT commands to time in the cellMuxPrivateLatency
+ * test.
+ */
+# define U_CELL_MUX_PRIVATE_TEST_AT_COMMANDS 50
+#endif
+
+#ifndef U_CELL_MUX_PRIVATE_TEST_AT_MAX_LATENCY_MS
+/** The longest that an AT command may take on the AT channel
+ * while the other channels are saturated.
+ */
+# define U_CELL_MUX_PRIVATE_TEST_AT_MAX_LATENCY_MS 500
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** The state of the simulated module used by the
+ * cellMuxPrivateLatency test.
+ */
+typedef struct {
+    int32_t uartHandle;
+    volatile bool stop;        /**< set this to stop the simulator task. */
+    volatile bool stopped;     /**< set by the simulator task when it has stopped. */
+    bool cmuxMode;
+    char rxBuffer[U_CELL_MUX_PRIVATE_TEST_SIM_BUFFER_LENGTH_BYTES];
+    size_t rxLength;
+    char information[U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES]; /**< a decoded information field. */
+    char frame[U_CELL_MUX_PRIVATE_INFORMATION_LENGTH_MAX_BYTES +
+                                                               U_CELL_MUX_PRIVATE_FRAME_OVERHEAD_MAX_BYTES]; /**< an encoded frame. */
+    bool open[U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS];
+    bool flowControlledOff[U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS];
+    size_t framesInFlight[U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS];
+    size_t flowOffCount[U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS];
+    size_t bytesSent[U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS];
+    size_t bytesReceived[U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS];
+} uCellMuxPrivateTestSim_t;
+#endif
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -135,6 +224,32 @@ static bool gCommandResponse[] = {true,  // U_CELL_MUX_PRIVATE_FRAME_TYPE_SABM_C
                                   true   // U_CELL_MUX_PRIVATE_FRAME_TYPE_UI
                                  };
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Handle of UART A, used by the cellMuxPrivateLatency test.
+ */
+static int32_t gUartAHandle = -1;
+
+/** The simulated module, on UART B.
+ */
+static uCellMuxPrivateTestSim_t *gpSim = NULL;
+
+/** The PPP-like channel of the cellMuxPrivateLatency test.
+ */
+static uDeviceSerial_t *gpDeviceSerialPpp = NULL;
+
+/** Set this to stop pppTask().
+ */
+static volatile bool gPppStop = false;
+
+/** Set by pppTask() when it has stopped.
+ */
+static volatile bool gPppStopped = false;
+
+/** The number of bytes pppTask() has received.
+ */
+static volatile size_t gPppBytesReceived = 0;
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -145,6 +260,200 @@ const char *pBool(bool isTrue)
     return isTrue ? "true" : "false";
 }
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+// Encode and send a CMUX frame from the simulated module.
+static void simSend(uCellMuxPrivateTestSim_t *pSim, uint8_t channel,
+                    uCellMuxPrivateFrameType_t type,
+                    const char *pInformation, size_t length)
+{
+    int32_t x;
+
+    x = uCellMuxPrivateEncode(channel, type, type != U_CELL_MUX_PRIVATE_FRAME_TYPE_UIH,
+                              pInformation, length, pSim->frame);
+    if (x > 0) {
+        uPortUartWrite(pSim->uartHandle, pSim->frame, x);
+    }
+}
+
+// Handle a frame received by the simulated module.
+static void simHandleFrame(uCellMuxPrivateTestSim_t *pSim,
+                           const uCellMuxPrivateParserContext_t *pParserContext)
+{
+    uint8_t channel = pParserContext->address;
+    char *pInformation = pSim->information;
+    size_t length = pParserContext->informationLengthBytes;
+    uint8_t mscChannel;
+
+    if (length > sizeof(pSim->information)) {
+        length = sizeof(pSim->information);
+    }
+    if (channel < U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS) {
+        switch (pParserContext->type) {
+            case U_CELL_MUX_PRIVATE_FRAME_TYPE_SABM_COMMAND:
+                pSim->open[channel] = true;
+                pSim->flowControlledOff[channel] = false;
+                simSend(pSim, channel, U_CELL_MUX_PRIVATE_FRAME_TYPE_UA_RESPONSE, NULL, 0);
+                break;
+            case U_CELL_MUX_PRIVATE_FRAME_TYPE_DISC_COMMAND:
+                pSim->open[channel] = false;
+                simSend(pSim, channel, U_CELL_MUX_PRIVATE_FRAME_TYPE_UA_RESPONSE, NULL, 0);
+                break;
+            case U_CELL_MUX_PRIVATE_FRAME_TYPE_UIH:
+                if (channel == U_CELL_MUX_PRIVATE_CHANNEL_ID_CONTROL) {
+                    if ((length >= 4) && (*pInformation == (char) 0xe3)) {
+                        // MSC command: obey the flow control bit and respond
+                        mscChannel = ((uint8_t) * (pInformation + 2)) >> 2;
+                        if (mscChannel < U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS) {
+                            if ((*(pInformation + 3) & 0x02) != 0) {
+                                if (!pSim->flowControlledOff[mscChannel]) {
+                                    pSim->flowOffCount[mscChannel]++;
+                                }
+                                pSim->flowControlledOff[mscChannel] = true;
+                                pSim->framesInFlight[mscChannel] = 0;
+                            } else {
+                                pSim->flowControlledOff[mscChannel] = false;
+                            }
+                        }
+                        *pInformation &= ~0x02;
+                        simSend(pSim, channel, U_CELL_MUX_PRIVATE_FRAME_TYPE_UIH,
+                                pInformation, length);
+                    } else if ((length >= 2) && (*pInformation == (char) 0xc3)) {
+                        // CLD: respond and leave CMUX mode
+                        *pInformation = (char) 0xc1;
+                        simSend(pSim, channel, U_CELL_MUX_PRIVATE_FRAME_TYPE_UIH,
+                                pInformation, length);
+                        pSim->cmuxMode = false;
+                    }
+                } else if (channel == U_CELL_MUX_PRIVATE_CHANNEL_ID_AT) {
+                    // Any AT command gets "OK"
+                    if (memchr(pInformation, '\r', length) != NULL) {
+                        simSend(pSim, channel, U_CELL_MUX_PRIVATE_FRAME_TYPE_UIH,
+                                "\r\nOK\r\n", 6);
+                    }
+                } else {
+                    pSim->bytesReceived[channel] += pParserContext->informationLengthBytes;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Task that pretends to be a cellular module on the other end of
+// UART B: it responds "OK" to AT commands and, once "AT+CMUX" has
+// been received, speaks CMUX, sending a full frame of data every
+// U_CELL_MUX_PRIVATE_TEST_SIM_PERIOD_MS on every open channel
+// other than the control and AT channels.
+static void simTask(void *pParameter)
+{
+    uCellMuxPrivateTestSim_t *pSim = (uCellMuxPrivateTestSim_t *) pParameter;
+    uCellMuxPrivateParserContext_t parserContext;
+    int32_t x;
+    char *pEnd;
+    int32_t lastSendTimeMs = uPortGetTickTimeMs();
+
+    while (!pSim->stop) {
+        x = uPortUartRead(pSim->uartHandle, pSim->rxBuffer + pSim->rxLength,
+                          sizeof(pSim->rxBuffer) - pSim->rxLength);
+        if (x > 0) {
+            pSim->rxLength += x;
+        }
+        if (!pSim->cmuxMode) {
+            // Respond to whole AT command lines
+            while ((pEnd = (char *) memchr(pSim->rxBuffer, '\r', pSim->rxLength)) != NULL) {
+                *pEnd = 0;
+                if (strstr(pSim->rxBuffer, "AT+CMUX") != NULL) {
+                    pSim->cmuxMode = true;
+                }
+                uPortUartWrite(pSim->uartHandle, "\r\nOK\r\n", 6);
+                pSim->rxLength -= pEnd + 1 - pSim->rxBuffer;
+                memmove(pSim->rxBuffer, pEnd + 1, pSim->rxLength);
+            }
+            if (pSim->rxLength == sizeof(pSim->rxBuffer)) {
+                pSim->rxLength = 0;
+            }
+        } else {
+            // Decode CMUX frames
+            memset(&parserContext, 0, sizeof(parserContext));
+            parserContext.pBuffer = pSim->rxBuffer;
+            parserContext.bufferSize = pSim->rxLength;
+            x = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            while (pSim->cmuxMode && (parserContext.bufferIndex < parserContext.bufferSize) &&
+                   (x != (int32_t) U_ERROR_COMMON_TIMEOUT)) {
+                parserContext.address = U_CELL_MUX_PRIVATE_ADDRESS_ANY;
+                parserContext.type = U_CELL_MUX_PRIVATE_FRAME_TYPE_NONE;
+                parserContext.pInformation = pSim->information;
+                parserContext.informationLengthBytes = sizeof(pSim->information);
+                x = uCellMuxPrivateParseCmux(NULL, &parserContext);
+                if (x == 0) {
+                    simHandleFrame(pSim, &parserContext);
+                }
+                if (x != (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                    pSim->rxLength -= parserContext.bufferIndex;
+                    memmove(pSim->rxBuffer, pSim->rxBuffer + parserContext.bufferIndex,
+                            pSim->rxLength);
+                    parserContext.bufferSize = pSim->rxLength;
+                    parserContext.bufferIndex = 0;
+                }
+            }
+            if (pSim->rxLength == sizeof(pSim->rxBuffer)) {
+                pSim->rxLength = 0;
+            }
+            // Send data on the user channels, obeying flow control,
+            // give or take a few frames in flight
+            if (uPortGetTickTimeMs() - lastSendTimeMs >= U_CELL_MUX_PRIVATE_TEST_SIM_PERIOD_MS) {
+                lastSendTimeMs = uPortGetTickTimeMs();
+                memset(pSim->information, 'g', sizeof(pSim->information));
+                for (size_t y = U_CELL_MUX_PRIVATE_CHANNEL_ID_AT + 1;
+                     pSim->cmuxMode && (y < U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS); y++) {
+                    if (pSim->open[y] &&
+                        (!pSim->flowControlledOff[y] ||
+                         (pSim->framesInFlight[y] < U_CELL_MUX_PRIVATE_TEST_SIM_FRAMES_IN_FLIGHT))) {
+                        if (pSim->flowControlledOff[y]) {
+                            pSim->framesInFlight[y]++;
+                        }
+                        simSend(pSim, (uint8_t) y, U_CELL_MUX_PRIVATE_FRAME_TYPE_UIH,
+                                pSim->information, sizeof(pSim->information));
+                        pSim->bytesSent[y] += sizeof(pSim->information);
+                    }
+                }
+            }
+        }
+        uPortTaskBlock(1);
+    }
+
+    pSim->stopped = true;
+    uPortTaskDelete(NULL);
+}
+
+// Task that behaves like PPP on the PPP-like channel of the
+// cellMuxPrivateLatency test: it reads everything that arrives
+// and writes as fast as it can.
+static void pppTask(void *pParameter)
+{
+    char buffer[256];
+    int32_t x;
+
+    (void) pParameter;
+
+    memset(buffer, 'p', sizeof(buffer));
+    while (!gPppStop) {
+        do {
+            x = gpDeviceSerialPpp->read(gpDeviceSerialPpp, buffer, sizeof(buffer));
+            if (x > 0) {
+                gPppBytesReceived += x;
+            }
+        } while (x > 0);
+        gpDeviceSerialPpp->write(gpDeviceSerialPpp, buffer, sizeof(buffer));
+        uPortTaskBlock(U_CELL_MUX_PRIVATE_TEST_SIM_PERIOD_MS);
+    }
+
+    gPppStopped = true;
+    uPortTaskDelete(NULL);
+}
+#endif
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -291,4 +600,199 @@ U_PORT_TEST_FUNCTION("[cellMuxPrivate]", "cellMuxPrivateBackToBack")
     uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
 }
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Measure the latency of the AT channel while a PPP-like channel
+ * is saturated in both directions and the GNSS channel is saturated
+ * towards us but has a deliberately slow consumer, which will
+ * cause it to be flow controlled off.  The cellular module is
+ * simulated on UART B.
+ */
+U_PORT_TEST_FUNCTION("[cellMuxPrivate]", "cellMuxPrivateLatency")
+{
+    int32_t resourceCount;
+    uAtClientHandle_t atClientHandle;
+    uDeviceHandle_t devHandle = NULL;
+    uDeviceSerial_t *pDeviceSerialGnss = NULL;
+    uPortTaskHandle_t taskHandle;
+    char buffer[U_CELL_MUX_PRIVATE_TEST_SLOW_READ_LENGTH_BYTES];
+    int32_t x;
+    int32_t startTimeMs;
+    int32_t latencyMs;
+    int32_t maxLatencyMs = 0;
+    int32_t totalLatencyMs = 0;
+    size_t gnssBytesReceived = 0;
+    size_t numCommands = 0;
+    uint8_t gnssChannel = 0;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    gpSim = (uCellMuxPrivateTestSim_t *) pUPortMalloc(sizeof(*gpSim));
+    U_PORT_TEST_ASSERT(gpSim != NULL);
+    memset(gpSim, 0, sizeof(*gpSim));
+
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+    gpSim->uartHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                      U_CFG_TEST_BAUD_RATE,
+                                      NULL,
+                                      U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                      U_CFG_TEST_PIN_UART_B_TXD,
+                                      U_CFG_TEST_PIN_UART_B_RXD,
+                                      U_CFG_TEST_PIN_UART_B_CTS,
+                                      U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gpSim->uartHandle >= 0);
+    U_PORT_TEST_ASSERT(uPortTaskCreate(simTask, "simTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       gpSim, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uCellInit() == 0);
+    atClientHandle = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                  NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, atClientHandle,
+                                -1, -1, -1, false, &devHandle) == 0);
+
+    U_TEST_PRINT_LINE("enabling CMUX with a simulated module...");
+    U_PORT_TEST_ASSERT(uCellMuxEnable(devHandle) == 0);
+    U_PORT_TEST_ASSERT(uCellMuxAddChannel(devHandle, U_CELL_MUX_CHANNEL_ID_GNSS,
+                                          &pDeviceSerialGnss) == 0);
+    U_PORT_TEST_ASSERT(uCellMuxAddChannel(devHandle, U_CELL_MUX_PRIVATE_TEST_PPP_CHANNEL,
+                                          &gpDeviceSerialPpp) == 0);
+    for (size_t y = U_CELL_MUX_PRIVATE_CHANNEL_ID_AT + 1;
+         y < U_CELL_MUX_PRIVATE_TEST_SIM_MAX_CHANNELS; y++) {
+        if (gpSim->open[y] && (y != U_CELL_MUX_PRIVATE_TEST_PPP_CHANNEL)) {
+            gnssChannel = (uint8_t) y;
+        }
+    }
+    U_PORT_TEST_ASSERT(gnssChannel > 0);
+
+    gPppStop = false;
+    gPppStopped = false;
+    gPppBytesReceived = 0;
+    U_PORT_TEST_ASSERT(uPortTaskCreate(pppTask, "pppTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       NULL, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+
+    // Let the GNSS channel fill up
+    uPortTaskBlock(1000);
+
+    U_PORT_TEST_ASSERT(uCellAtClientHandleGet(devHandle, &atClientHandle) == 0);
+    U_TEST_PRINT_LINE("timing %d AT commands with the other channels saturated...",
+                      U_CELL_MUX_PRIVATE_TEST_AT_COMMANDS);
+    startTimeMs = uPortGetTickTimeMs();
+    while (numCommands < U_CELL_MUX_PRIVATE_TEST_AT_COMMANDS) {
+        // Read the GNSS channel, slowly
+        x = pDeviceSerialGnss->read(pDeviceSerialGnss, buffer, sizeof(buffer));
+        if (x > 0) {
+            gnssBytesReceived += x;
+        }
+        latencyMs = uPortGetTickTimeMs();
+        uAtClientLock(atClientHandle);
+        uAtClientCommandStart(atClientHandle, "AT");
+        uAtClientCommandStopReadResponse(atClientHandle);
+        x = uAtClientUnlock(atClientHandle);
+        latencyMs = uPortGetTickTimeMs() - latencyMs;
+        U_PORT_TEST_ASSERT(x == 0);
+        totalLatencyMs += latencyMs;
+        if (latencyMs > maxLatencyMs) {
+            maxLatencyMs = latencyMs;
+        }
+        numCommands++;
+        uPortTaskBlock(U_CELL_MUX_PRIVATE_TEST_SLOW_READ_PERIOD_MS);
+    }
+
+    U_TEST_PRINT_LINE("%d AT command(s) in %d ms, latency average %d ms, worst %d ms.",
+                      numCommands, uPortGetTickTimeMs() - startTimeMs,
+                      totalLatencyMs / numCommands, maxLatencyMs);
+    U_TEST_PRINT_LINE("PPP: %d byte(s) sent, %d byte(s) received.",
+                      gpSim->bytesReceived[U_CELL_MUX_PRIVATE_TEST_PPP_CHANNEL],
+                      gPppBytesReceived);
+    U_TEST_PRINT_LINE("GNSS: %d byte(s) read by the slow consumer, flow"
+                      " controlled off %d time(s).", gnssBytesReceived,
+                      gpSim->flowOffCount[gnssChannel]);
+    U_PORT_TEST_ASSERT(maxLatencyMs < U_CELL_MUX_PRIVATE_TEST_AT_MAX_LATENCY_MS);
+    U_PORT_TEST_ASSERT(gPppBytesReceived > 0);
+    U_PORT_TEST_ASSERT(gpSim->bytesReceived[U_CELL_MUX_PRIVATE_TEST_PPP_CHANNEL] > 0);
+    U_PORT_TEST_ASSERT(gnssBytesReceived > 0);
+    U_PORT_TEST_ASSERT(gpSim->flowOffCount[gnssChannel] > 0);
+
+    // Stop PPP and tidy up
+    gPppStop = true;
+    while (!gPppStopped) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(uCellMuxDisable(devHandle) == 0);
+    gpDeviceSerialPpp = NULL;
+
+    uCellDeinit();
+    uAtClientDeinit();
+
+    gpSim->stop = true;
+    while (!gpSim->stopped) {
+        uPortTaskBlock(10);
+    }
+    // Let the tasks go away
+    uPortTaskBlock(100);
+    uPortUartClose(gpSim->uartHandle);
+    uPortFree(gpSim);
+    gpSim = NULL;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[cellMuxPrivate]", "cellMuxPrivateCleanUp")
+{
+    gPppStop = true;
+    uCellDeinit();
+    uAtClientDeinit();
+    if (gpSim != NULL) {
+        gpSim->stop = true;
+        while (!gpSim->stopped) {
+            uPortTaskBlock(10);
+        }
+        uPortUartClose(gpSim->uartHandle);
+        uPortFree(gpSim);
+        gpSim = NULL;
+    }
+    if (gUartAHandle >= 0) {
+        uPortUartClose(gUartAHandle);
+        gUartAHandle = -1;
+    }
+    uPortDeinit();
+}
+#endif
+
 // End of file
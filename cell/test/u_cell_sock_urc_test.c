@@ -0,0 +1,555 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests of the coalescing of +UUSORD/+UUSORF data indications
+ * by the cellular sockets API.  No cellular module is required to run
+ * this set of tests, the module is simulated on the other end of
+ * a back to back UART.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memset()/memchr()/memmove()/strstr()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_at_client.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+
+#include "u_sock.h"
+
+#include "u_cell_module_type.h"
+#include "u_cell.h"
+#include "u_cell_sock.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The base string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX_BASE "U_CELL_SOCK_URC_TEST"
+
+/** The string to put at the start of all prints from this test
+ * that do not require an iteration on the end.
+ */
+#define U_TEST_PREFIX U_TEST_PREFIX_BASE ": "
+
+/** Print a whole line, with terminator, prefixed for this test
+ * file, no iteration version.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_CELL_SOCK_URC_TEST_NUM_URCS
+/** The number of +UUSORF indications the simulated module sends
+ * in each pass of the test.
+ */
+# define U_CELL_SOCK_URC_TEST_NUM_URCS 1000
+#endif
+
+#ifndef U_CELL_SOCK_URC_TEST_BURST
+/** The number of +UUSORF indications the simulated module sends
+ * back to back before pausing for #U_CELL_SOCK_URC_TEST_BURST_GAP_MS.
+ */
+# define U_CELL_SOCK_URC_TEST_BURST 50
+#endif
+
+#ifndef U_CELL_SOCK_URC_TEST_BURST_GAP_MS
+/** The gap between bursts of indications from the simulated module.
+ */
+# define U_CELL_SOCK_URC_TEST_BURST_GAP_MS 20
+#endif
+
+#ifndef U_CELL_SOCK_URC_TEST_WINDOW_MS
+/** The coalescing window to use for the second pass of the test.
+ */
+# define U_CELL_SOCK_URC_TEST_WINDOW_MS 10
+#endif
+
+#ifndef U_CELL_SOCK_URC_TEST_LONG_WINDOW_MS
+/** A coalescing window long enough that it is obvious if other
+ * callbacks of the AT client are held up while it is open.
+ */
+# define U_CELL_SOCK_URC_TEST_LONG_WINDOW_MS 500
+#endif
+
+#ifndef U_CELL_SOCK_URC_TEST_SIM_BUFFER_LENGTH_BYTES
+/** The size of the receive buffer of the simulated module.
+ */
+# define U_CELL_SOCK_URC_TEST_SIM_BUFFER_LENGTH_BYTES 256
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** The state of the simulated module.
+ */
+typedef struct {
+    int32_t uartHandle;
+    volatile bool stop;        /**< set this to stop the simulator task. */
+    volatile bool stopped;     /**< set by the simulator task when it has stopped. */
+    volatile size_t urcsToSend; /**< set this to have the simulator send
+                                     that many +UUSORF indications. */
+    int32_t nextSockHandleModule;
+    char rxBuffer[U_CELL_SOCK_URC_TEST_SIM_BUFFER_LENGTH_BYTES];
+    size_t rxLength;
+    /** The length last indicated for each module socket. */
+    volatile int32_t lastLength[U_CELL_SOCK_MAX_NUM_SOCKETS];
+    /** The time at which the oldest undelivered indication was sent
+     * for each module socket, -1 if there is none. */
+    volatile int32_t oldestUndeliveredMs[U_CELL_SOCK_MAX_NUM_SOCKETS];
+} uCellSockUrcTestSim_t;
+
+/** The results of one pass of the test.
+ */
+typedef struct {
+    size_t readyCallbacks;   /**< calls of the data-ready callback. */
+    size_t readySockets;     /**< total sockets passed to the data-ready callback. */
+    size_t dataCallbacks;    /**< calls of the per-socket data callbacks. */
+    int32_t totalLatencyMs;  /**< sum of the delivery latencies. */
+    int32_t maxLatencyMs;    /**< worst delivery latency. */
+    /** The pendingBytes last delivered for each socket. */
+    int32_t lastPendingBytes[U_CELL_SOCK_MAX_NUM_SOCKETS];
+} uCellSockUrcTestResults_t;
+#endif
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Handle of UART A.
+ */
+static int32_t gUartAHandle = -1;
+
+/** The simulated module, on UART B.
+ */
+static uCellSockUrcTestSim_t *gpSim = NULL;
+
+/** The results of the current pass.
+ */
+static uCellSockUrcTestResults_t gResults;
+
+/** The sockets, indexed by module socket handle.
+ */
+static int32_t gSockHandle[U_CELL_SOCK_MAX_NUM_SOCKETS];
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+// Task that pretends to be a cellular module on the other end of
+// UART B: it responds "OK" to AT commands, with a socket number
+// to AT+USOCR, and sends urcsToSend +UUSORF indications, spread
+// across the sockets, in bursts of U_CELL_SOCK_URC_TEST_BURST.
+static void simTask(void *pParameter)
+{
+    uCellSockUrcTestSim_t *pSim = (uCellSockUrcTestSim_t *) pParameter;
+    char buffer[32];
+    int32_t x;
+    char *pEnd;
+    size_t sent = 0;
+    size_t sockHandleModule;
+
+    while (!pSim->stop) {
+        x = uPortUartRead(pSim->uartHandle, pSim->rxBuffer + pSim->rxLength,
+                          sizeof(pSim->rxBuffer) - pSim->rxLength);
+        if (x > 0) {
+            pSim->rxLength += x;
+        }
+        // Respond to whole AT command lines
+        while ((pEnd = (char *) memchr(pSim->rxBuffer, '\r', pSim->rxLength)) != NULL) {
+            *pEnd = 0;
+            if (strstr(pSim->rxBuffer, "AT+USOCR") != NULL) {
+                x = snprintf(buffer, sizeof(buffer), "\r\n+USOCR: %d\r\n",
+                             (int) pSim->nextSockHandleModule);
+                uPortUartWrite(pSim->uartHandle, buffer, x);
+                pSim->nextSockHandleModule++;
+            }
+            uPortUartWrite(pSim->uartHandle, "\r\nOK\r\n", 6);
+            pSim->rxLength -= pEnd + 1 - pSim->rxBuffer;
+            memmove(pSim->rxBuffer, pEnd + 1, pSim->rxLength);
+        }
+        if (pSim->rxLength == sizeof(pSim->rxBuffer)) {
+            pSim->rxLength = 0;
+        }
+        // Send a burst of indications
+        for (size_t y = 0; (y < U_CELL_SOCK_URC_TEST_BURST) &&
+             (pSim->urcsToSend > 0); y++) {
+            sockHandleModule = sent % U_CELL_SOCK_MAX_NUM_SOCKETS;
+            // Indicate a different length each time so that
+            // we can tell if the last one was delivered
+            x = (int32_t) (sent % 1000) + 1;
+            pSim->lastLength[sockHandleModule] = x;
+            if (pSim->oldestUndeliveredMs[sockHandleModule] < 0) {
+                pSim->oldestUndeliveredMs[sockHandleModule] = uPortGetTickTimeMs();
+            }
+            x = snprintf(buffer, sizeof(buffer), "\r\n+UUSORF: %d,%d\r\n",
+                         (int) sockHandleModule, (int) x);
+            uPortUartWrite(pSim->uartHandle, buffer, x);
+            sent++;
+            pSim->urcsToSend--;
+        }
+        if (pSim->urcsToSend > 0) {
+            uPortTaskBlock(U_CELL_SOCK_URC_TEST_BURST_GAP_MS);
+        } else {
+            uPortTaskBlock(1);
+        }
+    }
+
+    pSim->stopped = true;
+    uPortTaskDelete(NULL);
+}
+
+// Find the module socket handle of a socket.
+static int32_t sockHandleModuleGet(int32_t sockHandle)
+{
+    int32_t sockHandleModule = -1;
+
+    for (size_t x = 0; (x < sizeof(gSockHandle) / sizeof(gSockHandle[0])) &&
+         (sockHandleModule < 0); x++) {
+        if (gSockHandle[x] == sockHandle) {
+            sockHandleModule = (int32_t) x;
+        }
+    }
+
+    return sockHandleModule;
+}
+
+// Callback for the set of sockets that have data waiting.
+static void dataReadyCallback(uDeviceHandle_t cellHandle,
+                              const uCellSockDataReady_t *pReady,
+                              size_t numReady, void *pParameter)
+{
+    uCellSockUrcTestResults_t *pResults = (uCellSockUrcTestResults_t *) pParameter;
+    int32_t nowMs = uPortGetTickTimeMs();
+    int32_t sockHandleModule;
+    int32_t latencyMs;
+
+    (void) cellHandle;
+
+    pResults->readyCallbacks++;
+    for (size_t x = 0; x < numReady; x++) {
+        sockHandleModule = sockHandleModuleGet(pReady[x].sockHandle);
+        if (sockHandleModule >= 0) {
+            pResults->readySockets++;
+            pResults->lastPendingBytes[sockHandleModule] = pReady[x].pendingBytes;
+            if (gpSim->oldestUndeliveredMs[sockHandleModule] >= 0) {
+                latencyMs = nowMs - gpSim->oldestUndeliveredMs[sockHandleModule];
+                gpSim->oldestUndeliveredMs[sockHandleModule] = -1;
+                pResults->totalLatencyMs += latencyMs;
+                if (latencyMs > pResults->maxLatencyMs) {
+                    pResults->maxLatencyMs = latencyMs;
+                }
+            }
+        }
+    }
+}
+
+// Per-socket data callback.
+static void dataCallback(uDeviceHandle_t cellHandle, int32_t sockHandle)
+{
+    (void) cellHandle;
+    (void) sockHandle;
+
+    gResults.dataCallbacks++;
+}
+
+// AT client callback that records when it was run.
+static void probeCallback(uAtClientHandle_t atHandle, void *pParameter)
+{
+    (void) atHandle;
+
+    *((volatile int32_t *) pParameter) = uPortGetTickTimeMs();
+}
+
+// Have the simulator send its indications, wait for them to
+// be delivered, print/check the results and return the number
+// of heap allocations made while doing so.
+static int32_t runPass(uDeviceHandle_t devHandle, int32_t windowMs)
+{
+    int32_t startTimeMs;
+    bool delivered = false;
+    int32_t heapAllocTotal;
+    int32_t heapAllocCount;
+
+    memset(&gResults, 0, sizeof(gResults));
+    for (size_t x = 0; x < U_CELL_SOCK_MAX_NUM_SOCKETS; x++) {
+        gpSim->lastLength[x] = 0;
+        gpSim->oldestUndeliveredMs[x] = -1;
+    }
+    U_PORT_TEST_ASSERT(uCellSockSetDataCoalesceWindow(devHandle, windowMs) == 0);
+
+    U_TEST_PRINT_LINE("sending %d +UUSORF indication(s) across %d socket(s),"
+                      " coalescing window %d ms...", U_CELL_SOCK_URC_TEST_NUM_URCS,
+                      U_CELL_SOCK_MAX_NUM_SOCKETS, windowMs);
+    heapAllocTotal = uPortHeapAllocTotal();
+    heapAllocCount = uPortHeapAllocCount();
+    startTimeMs = uPortGetTickTimeMs();
+    gpSim->urcsToSend = U_CELL_SOCK_URC_TEST_NUM_URCS;
+    while (!delivered && (uPortGetTickTimeMs() - startTimeMs < 30000)) {
+        uPortTaskBlock(100);
+        delivered = (gpSim->urcsToSend == 0);
+        for (size_t x = 0; delivered && (x < U_CELL_SOCK_MAX_NUM_SOCKETS); x++) {
+            delivered = (gResults.lastPendingBytes[x] == gpSim->lastLength[x]);
+        }
+    }
+    // Let any stragglers land
+    uPortTaskBlock(100);
+    heapAllocTotal = uPortHeapAllocTotal() - heapAllocTotal;
+    heapAllocCount = uPortHeapAllocCount() - heapAllocCount;
+
+    U_TEST_PRINT_LINE("%d indication(s) resulted in %d data-ready callback(s)"
+                      " (each one AT client callback/event queue message, where"
+                      " previously there would have been one per indication)"
+                      " carrying %d socket(s) and %d per-socket data callback(s).",
+                      U_CELL_SOCK_URC_TEST_NUM_URCS, gResults.readyCallbacks,
+                      gResults.readySockets, gResults.dataCallbacks);
+    if (gResults.readySockets > 0) {
+        U_TEST_PRINT_LINE("delivery latency average %d ms, worst %d ms.",
+                          gResults.totalLatencyMs / (int32_t) gResults.readySockets,
+                          gResults.maxLatencyMs);
+    }
+    U_TEST_PRINT_LINE("%d heap allocation(s) were made, %d still outstanding.",
+                      heapAllocTotal, heapAllocCount);
+    U_PORT_TEST_ASSERT(delivered);
+    U_PORT_TEST_ASSERT(gResults.readyCallbacks > 0);
+    U_PORT_TEST_ASSERT(gResults.readyCallbacks < U_CELL_SOCK_URC_TEST_NUM_URCS);
+    U_PORT_TEST_ASSERT(gResults.readySockets <= U_CELL_SOCK_URC_TEST_NUM_URCS);
+    U_PORT_TEST_ASSERT(gResults.dataCallbacks == gResults.readySockets);
+    U_PORT_TEST_ASSERT(heapAllocCount == 0);
+
+    return heapAllocTotal;
+}
+#endif
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Have a simulated module send a storm of +UUSORF indications
+ * across all of the sockets and check that they are coalesced,
+ * first with no coalescing window and then with one.
+ */
+U_PORT_TEST_FUNCTION("[cellSockUrc]", "cellSockUrcCoalesce")
+{
+    int32_t resourceCount;
+    uAtClientHandle_t atClientHandle;
+    uDeviceHandle_t devHandle = NULL;
+    uPortTaskHandle_t taskHandle;
+    size_t readyCallbacksNoWindow;
+    int32_t heapAllocs[2];
+    int32_t startTimeMs;
+    volatile int32_t probeTimeMs = -1;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    gpSim = (uCellSockUrcTestSim_t *) pUPortMalloc(sizeof(*gpSim));
+    U_PORT_TEST_ASSERT(gpSim != NULL);
+    memset(gpSim, 0, sizeof(*gpSim));
+
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+    gpSim->uartHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                      U_CFG_TEST_BAUD_RATE,
+                                      NULL,
+                                      U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                      U_CFG_TEST_PIN_UART_B_TXD,
+                                      U_CFG_TEST_PIN_UART_B_RXD,
+                                      U_CFG_TEST_PIN_UART_B_CTS,
+                                      U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gpSim->uartHandle >= 0);
+    U_PORT_TEST_ASSERT(uPortTaskCreate(simTask, "simTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       gpSim, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uCellInit() == 0);
+    atClientHandle = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                  NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, atClientHandle,
+                                -1, -1, -1, false, &devHandle) == 0);
+    U_PORT_TEST_ASSERT(uCellSockInit() == 0);
+    U_PORT_TEST_ASSERT(uCellSockInitInstance(devHandle) == 0);
+
+    // Open all of the sockets
+    for (size_t x = 0; x < U_CELL_SOCK_MAX_NUM_SOCKETS; x++) {
+        gSockHandle[x] = uCellSockCreate(devHandle, U_SOCK_TYPE_DGRAM,
+                                         U_SOCK_PROTOCOL_UDP);
+        U_PORT_TEST_ASSERT(gSockHandle[x] >= 0);
+        uCellSockRegisterCallbackData(devHandle, gSockHandle[x], dataCallback);
+    }
+    U_PORT_TEST_ASSERT(uCellSockRegisterCallbackDataReady(devHandle,
+                                                          dataReadyCallback,
+                                                          &gResults) == 0);
+
+    heapAllocs[0] = runPass(devHandle, 0);
+    readyCallbacksNoWindow = gResults.readyCallbacks;
+    heapAllocs[1] = runPass(devHandle, U_CELL_SOCK_URC_TEST_WINDOW_MS);
+    U_TEST_PRINT_LINE("a %d ms window changed the number of data-ready"
+                      " callbacks from %d to %d and the number of heap"
+                      " allocations from %d to %d.", U_CELL_SOCK_URC_TEST_WINDOW_MS,
+                      readyCallbacksNoWindow, gResults.readyCallbacks,
+                      heapAllocs[0], heapAllocs[1]);
+    // Each AT client callback costs an event queue allocation, so
+    // there must be fewer allocations than there were indications
+    // and fewer still with the window; no allocation count at all
+    // means that the platform doesn't count them
+    U_PORT_TEST_ASSERT(heapAllocs[0] < U_CELL_SOCK_URC_TEST_NUM_URCS);
+    if (heapAllocs[0] > 0) {
+        U_PORT_TEST_ASSERT(heapAllocs[1] < heapAllocs[0]);
+    }
+
+    // Open a long window with a single indication and check that
+    // other callbacks of the AT client are not held up by it
+    memset(&gResults, 0, sizeof(gResults));
+    U_PORT_TEST_ASSERT(uCellSockSetDataCoalesceWindow(devHandle,
+                                                      U_CELL_SOCK_URC_TEST_LONG_WINDOW_MS) == 0);
+    gpSim->urcsToSend = 1;
+    startTimeMs = uPortGetTickTimeMs();
+    while ((gpSim->urcsToSend > 0) && (uPortGetTickTimeMs() - startTimeMs < 1000)) {
+        uPortTaskBlock(10);
+    }
+    // Give the indication time to land and open the window
+    uPortTaskBlock(50);
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uAtClientCallback(atClientHandle, probeCallback,
+                                         (void *) &probeTimeMs) == 0);
+    while ((probeTimeMs < 0) && (uPortGetTickTimeMs() - startTimeMs < 1000)) {
+        uPortTaskBlock(10);
+    }
+    U_TEST_PRINT_LINE("with a %d ms window open another AT client callback"
+                      " ran after %d ms.", U_CELL_SOCK_URC_TEST_LONG_WINDOW_MS,
+                      probeTimeMs - startTimeMs);
+    U_PORT_TEST_ASSERT(probeTimeMs >= 0);
+    U_PORT_TEST_ASSERT(probeTimeMs - startTimeMs < U_CELL_SOCK_URC_TEST_LONG_WINDOW_MS / 2);
+    U_PORT_TEST_ASSERT(gResults.readyCallbacks == 0);
+    // The indication must still be delivered once the window closes
+    uPortTaskBlock(U_CELL_SOCK_URC_TEST_LONG_WINDOW_MS);
+    U_PORT_TEST_ASSERT(gResults.readyCallbacks == 1);
+
+    // Tidy up
+    U_PORT_TEST_ASSERT(uCellSockRegisterCallbackDataReady(devHandle, NULL, NULL) == 0);
+    for (size_t x = 0; x < U_CELL_SOCK_MAX_NUM_SOCKETS; x++) {
+        U_PORT_TEST_ASSERT(uCellSockClose(devHandle, gSockHandle[x], NULL) == 0);
+        gSockHandle[x] = -1;
+    }
+
+    uCellSockDeinit();
+    uCellDeinit();
+    uAtClientDeinit();
+
+    gpSim->stop = true;
+    while (!gpSim->stopped) {
+        uPortTaskBlock(10);
+    }
+    // Let the tasks go away
+    uPortTaskBlock(100);
+    uPortUartClose(gpSim->uartHandle);
+    uPortFree(gpSim);
+    gpSim = NULL;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[cellSockUrc]", "cellSockUrcCleanUp")
+{
+    uCellSockDeinit();
+    uCellDeinit();
+    uAtClientDeinit();
+    if (gpSim != NULL) {
+        gpSim->stop = true;
+        while (!gpSim->stopped) {
+            uPortTaskBlock(10);
+        }
+        uPortUartClose(gpSim->uartHandle);
+        uPortFree(gpSim);
+        gpSim = NULL;
+    }
+    if (gUartAHandle >= 0) {
+        uPortUartClose(gUartAHandle);
+        gUartAHandle = -1;
+    }
+    uPortDeinit();
+}
+#endif
+
+// End of file
@@ -33,11 +33,16 @@
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
+#include "errno.h"
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "stdio.h"     // snprintf()
+#include "stdlib.h"    // strtol()
+#include "string.h"    // memset(), strstr(), strlen()
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
 #include "u_cfg_app_platform_specific.h"
 #include "u_cfg_test_platform_specific.h"
 
@@ -46,6 +51,7 @@
 #include "u_port.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_port_heap.h"
 #include "u_port_uart.h"
 
 #include "u_test_util_resource_check.h"
@@ -54,6 +60,11 @@
 
 #include "u_cell_module_type.h"
 #include "u_cell.h"
+#include "u_cell_file.h"
+#include "u_cell_info.h"
+
+#include "u_sock_errno.h"
+#include "u_sock.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -67,6 +78,80 @@
  */
 #define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
 
+#ifndef U_CELL_TEST_INSTANCE_LOCK_UPLOAD_SIZE_BYTES
+/** The amount of data that the cellInstanceLock test uploads
+ * to one cellular instance while timing calls on another.
+ */
+# define U_CELL_TEST_INSTANCE_LOCK_UPLOAD_SIZE_BYTES (512 * 1024)
+#endif
+
+#ifndef U_CELL_TEST_INSTANCE_LOCK_CHUNK_SIZE_BYTES
+/** The simulated module in the cellInstanceLock test swallows
+ * uploaded data in chunks of this size, pausing for
+ * #U_CELL_TEST_INSTANCE_LOCK_CHUNK_DELAY_MS between each one,
+ * so that the upload takes a good while.
+ */
+# define U_CELL_TEST_INSTANCE_LOCK_CHUNK_SIZE_BYTES 4096
+#endif
+
+#ifndef U_CELL_TEST_INSTANCE_LOCK_CHUNK_DELAY_MS
+/** The pause between chunks of uploaded data, see
+ * #U_CELL_TEST_INSTANCE_LOCK_CHUNK_SIZE_BYTES.
+ */
+# define U_CELL_TEST_INSTANCE_LOCK_CHUNK_DELAY_MS 10
+#endif
+
+#ifndef U_CELL_TEST_INSTANCE_LOCK_MAX_LATENCY_MS
+/** The longest that an API call on one cellular instance may
+ * take while another cellular instance is busy uploading.
+ */
+# define U_CELL_TEST_INSTANCE_LOCK_MAX_LATENCY_MS 100
+#endif
+
+#ifndef U_CELL_TEST_DNS_LOOK_UP_DELAY_MS
+/** How long the simulated module in the cellDnsCache test
+ * takes to answer a DNS look-up.
+ */
+# define U_CELL_TEST_DNS_LOOK_UP_DELAY_MS 250
+#endif
+
+#ifndef U_CELL_TEST_DNS_NUM_RECONNECTS
+/** The number of "reconnects", each of which looks up the
+ * same host name, in the cellDnsCache test.
+ */
+# define U_CELL_TEST_DNS_NUM_RECONNECTS 10
+#endif
+
+/** The IP address that the simulated module in the cellDnsCache
+ * test returns for any host name that doesn't begin with "unknown".
+ */
+#define U_CELL_TEST_DNS_IP_ADDRESS "10.11.12.13"
+
+#ifndef U_CELL_TEST_IDENTITY_NUM_CYCLES
+/** The number of telemetry cycles, each of which reads the
+ * identity of the module, in the cellIdentityCache test.
+ */
+# define U_CELL_TEST_IDENTITY_NUM_CYCLES 1000
+#endif
+
+/** The number of AT commands it takes to read the whole identity
+ * of a module: one each for IMEI, IMSI and ICCID and two each
+ * (ATE0 and the command itself) for manufacturer, model and
+ * firmware version.
+ */
+#define U_CELL_TEST_IDENTITY_NUM_COMMANDS 9
+
+#ifndef U_CELL_TEST_FILE_STREAM_SIZE_BYTES
+/** The size of the file uploaded by the cellFileStream test;
+ * also the size of the simulated module's file system.
+ */
+# define U_CELL_TEST_FILE_STREAM_SIZE_BYTES (1024 * 16)
+#endif
+
+/** The name of the file uploaded by the cellFileStream test.
+ */
+#define U_CELL_TEST_FILE_STREAM_NAME "stream"
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -83,10 +168,397 @@ static int32_t gUartAHandle = -1;
  */
 static int32_t gUartBHandle = -1;
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** The cellular instance that the upload task of the
+ * cellInstanceLock test writes to.
+ */
+static uDeviceHandle_t gUploadDevHandle = NULL;
+
+/** The data uploaded by the upload task.
+ */
+static char *gpUploadData = NULL;
+
+/** The outcome of the upload, written by the upload task.
+ */
+static volatile int32_t gUploadResult = 0;
+
+/** Set by the upload task when it is done.
+ */
+static volatile bool gUploadDone = false;
+
+/** Set by udwnfileUrc() once the upload has started.
+ */
+static volatile bool gUploadStarted = false;
+
+/** The number of DNS look-ups the simulated module of the
+ * cellDnsCache test has been asked to do.
+ */
+static volatile int32_t gDnsNumLookUps = 0;
+
+/** The error code passed to dnsCallback().
+ */
+static volatile int32_t gDnsCallbackErrorCode = 0;
+
+/** The address passed to dnsCallback().
+ */
+static uSockIpAddress_t gDnsCallbackAddress;
+
+/** Set by dnsCallback().
+ */
+static volatile bool gDnsCallbackDone = false;
+
+/** The number of AT commands the simulated module of the
+ * cellIdentityCache test has received.
+ */
+static volatile int32_t gIdentityNumCommands = 0;
+
+/** The responses of the simulated module of the cellIdentityCache
+ * test; the IMEI response is a variable so that the test can
+ * swap the module.
+ */
+static const char *gpIdentityImeiResponse = "\r\n351234567890123\r\n\r\nOK\r\n";
+static const char *gpIdentityImsiResponse = "\r\n234150123456789\r\n\r\nOK\r\n";
+static const char *gpIdentityIccidResponse = "\r\n+CCID: 89441000300012345678\r\n\r\nOK\r\n";
+static const char *gpIdentityManufacturerResponse = "\r\nu-blox\r\n\r\nOK\r\n";
+static const char *gpIdentityModelResponse = "\r\nSARA-R510M8S\r\n\r\nOK\r\n";
+static const char *gpIdentityFirmwareResponse = "\r\n03.15,A00.01\r\n\r\nOK\r\n";
+static const char *gpIdentityOkResponse = "\r\nOK\r\n";
+
+/** The contents of the one file that the simulated file system
+ * of the cellFileStream test can hold.
+ */
+static char gSimFile[U_CELL_TEST_FILE_STREAM_SIZE_BYTES];
+
+/** The size of gSimFile, -1 if it does not exist.
+ */
+static volatile int32_t gSimFileSize = -1;
+
+/** The number of AT+UDWNFILE commands the simulated file system
+ * has received.
+ */
+static volatile int32_t gSimFileNumWrites = 0;
+
+/** The AT+UDWNFILE command, counting from one, that the simulated
+ * file system should fail, zero for none.
+ */
+static volatile int32_t gSimFileFailWrite = 0;
+
+/** How many bytes of the failed AT+UDWNFILE the simulated file
+ * system should keep.
+ */
+static volatile int32_t gSimFileFailKeepBytes = 0;
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+// Pretend to be the file system of a cellular module: this is
+// set as a URC handler on the AT client on UART B and so gets
+// the "AT+UDWNFILE=" sent by the cellular instance on UART A;
+// it sends the prompt, swallows the data, slowly, and then
+// sends "OK".
+static void udwnfileUrc(uAtClientHandle_t atHandle, void *pParameter)
+{
+    char c = 0;
+    size_t length = 0;
+    int32_t x = 0;
+
+    (void) pParameter;
+
+    // The command line ends in just '\r' and the data that
+    // follows is binary so don't look for a stop tag
+    uAtClientIgnoreStopTag(atHandle);
+    // Throw away the rest of the command line
+    while ((c != '\r') && (uAtClientReadBytes(atHandle, &c, 1, true) == 1)) {}
+
+    gUploadStarted = true;
+    uPortUartWrite(gUartBHandle, ">", 1);
+    while ((length < U_CELL_TEST_INSTANCE_LOCK_UPLOAD_SIZE_BYTES) && (x >= 0)) {
+        x = U_CELL_TEST_INSTANCE_LOCK_UPLOAD_SIZE_BYTES - length;
+        if (x > U_CELL_TEST_INSTANCE_LOCK_CHUNK_SIZE_BYTES) {
+            x = U_CELL_TEST_INSTANCE_LOCK_CHUNK_SIZE_BYTES;
+        }
+        x = uAtClientReadBytes(atHandle, NULL, x, true);
+        if (x > 0) {
+            length += x;
+            uPortTaskBlock(U_CELL_TEST_INSTANCE_LOCK_CHUNK_DELAY_MS);
+        } else {
+            x = -1;
+        }
+    }
+    if (length == U_CELL_TEST_INSTANCE_LOCK_UPLOAD_SIZE_BYTES) {
+        uPortUartWrite(gUartBHandle, "\r\nOK\r\n", 6);
+    }
+}
+
+// Read the rest of an AT command line, which ends in just '\r',
+// into pBuffer, for the simulated module.
+static void simReadCommandLine(uAtClientHandle_t atHandle,
+                               char *pBuffer, size_t bufferSize)
+{
+    char c = 0;
+    size_t length = 0;
+
+    uAtClientIgnoreStopTag(atHandle);
+    while ((c != '\r') && (uAtClientReadBytes(atHandle, &c, 1, true) == 1)) {
+        if ((c != '\r') && (length < bufferSize - 1)) {
+            *(pBuffer + length) = c;
+            length++;
+        }
+    }
+    *(pBuffer + length) = 0;
+}
+
+// Pretend to be the DNS of a cellular module: a URC handler on
+// the AT client on UART B for "AT+UDNSRN=" that, after a delay,
+// returns an IP address for any host name that doesn't begin
+// with "unknown", else ERROR.
+static void udnsrnUrc(uAtClientHandle_t atHandle, void *pParameter)
+{
+    char buffer[64];
+    const char *pResponse = "\r\n+UDNSRN: \"" U_CELL_TEST_DNS_IP_ADDRESS "\"\r\n\r\nOK\r\n";
+
+    (void) pParameter;
+
+    simReadCommandLine(atHandle, buffer, sizeof(buffer));
+    gDnsNumLookUps++;
+    uPortTaskBlock(U_CELL_TEST_DNS_LOOK_UP_DELAY_MS);
+    if (strstr(buffer, "\"unknown") != NULL) {
+        pResponse = "\r\nERROR\r\n";
+    }
+    uPortUartWrite(gUartBHandle, pResponse, strlen(pResponse));
+}
+
+// The simulated module's answer to the "AT+CGDCONT?" that precedes a
+// DNS look-up.
+static void cgdcontUrc(uAtClientHandle_t atHandle, void *pParameter)
+{
+    char buffer[8];
+
+    (void) pParameter;
+
+    simReadCommandLine(atHandle, buffer, sizeof(buffer));
+    uPortUartWrite(gUartBHandle, "\r\nOK\r\n", 6);
+}
+
+// The simulated module's answer to the "AT+USOER" that follows
+// a failed DNS look-up.
+static void usoerUrc(uAtClientHandle_t atHandle, void *pParameter)
+{
+    char buffer[8];
+    const char *pResponse = "\r\n+USOER: 0\r\n\r\nOK\r\n";
+
+    (void) pParameter;
+
+    simReadCommandLine(atHandle, buffer, sizeof(buffer));
+    uPortUartWrite(gUartBHandle, pResponse, strlen(pResponse));
+}
+
+// Pretend to be a cellular module answering the AT commands that
+// read its identity: a URC handler on the AT client on UART B where
+// pParameter points to the variable holding the response to send.
+static void identityUrc(uAtClientHandle_t atHandle, void *pParameter)
+{
+    char buffer[8];
+    const char *pResponse = *((const char **) pParameter);
+
+    simReadCommandLine(atHandle, buffer, sizeof(buffer));
+    gIdentityNumCommands++;
+    uPortUartWrite(gUartBHandle, pResponse, strlen(pResponse));
+}
+
+// Pretend to be the file system of a cellular module, holding one
+// file, for the cellFileStream test: a URC handler for
+// "AT+UDWNFILE=" that appends to the file or, if told to by
+// gSimFileFailWrite, keeps only some of the data and fails.
+static void simUdwnfileUrc(uAtClientHandle_t atHandle, void *pParameter)
+{
+    char buffer[64];
+    const char *pResponse = "\r\nOK\r\n";
+    const char *pSize;
+    int32_t size = 0;
+    int32_t keep;
+    int32_t x;
+
+    (void) pParameter;
+
+    simReadCommandLine(atHandle, buffer, sizeof(buffer));
+    gSimFileNumWrites++;
+    pSize = strchr(buffer, ',');
+    if (pSize != NULL) {
+        size = strtol(pSize + 1, NULL, 10);
+    }
+    if (gSimFileSize < 0) {
+        gSimFileSize = 0;
+    }
+    keep = size;
+    if (gSimFileNumWrites == gSimFileFailWrite) {
+        keep = gSimFileFailKeepBytes;
+        pResponse = "\r\nERROR\r\n";
+    }
+    if (keep > (int32_t) sizeof(gSimFile) - gSimFileSize) {
+        keep = (int32_t) sizeof(gSimFile) - gSimFileSize;
+    }
+    uPortUartWrite(gUartBHandle, ">", 1);
+    x = uAtClientReadBytes(atHandle, gSimFile + gSimFileSize, keep, true);
+    if (x > 0) {
+        gSimFileSize += x;
+    }
+    if (size > keep) {
+        uAtClientReadBytes(atHandle, NULL, size - keep, true);
+    }
+    uPortUartWrite(gUartBHandle, pResponse, strlen(pResponse));
+}
+
+// The simulated file system's answer to "AT+ULSTFILE=2,...", the
+// file size.
+static void simUlstfileUrc(uAtClientHandle_t atHandle, void *pParameter)
+{
+    char buffer[64];
+
+    (void) pParameter;
+
+    simReadCommandLine(atHandle, buffer, sizeof(buffer));
+    if (gSimFileSize >= 0) {
+        snprintf(buffer, sizeof(buffer), "\r\n+ULSTFILE: %d\r\n\r\nOK\r\n",
+                 (int) gSimFileSize);
+    } else {
+        snprintf(buffer, sizeof(buffer), "\r\nERROR\r\n");
+    }
+    uPortUartWrite(gUartBHandle, buffer, strlen(buffer));
+}
+
+// The simulated file system's answer to "AT+UDELFILE=".
+static void simUdelfileUrc(uAtClientHandle_t atHandle, void *pParameter)
+{
+    char buffer[64];
+
+    (void) pParameter;
+
+    simReadCommandLine(atHandle, buffer, sizeof(buffer));
+    gSimFileSize = -1;
+    uPortUartWrite(gUartBHandle, "\r\nOK\r\n", 6);
+}
+
+// The simulated file system's answer to
+// "AT+URDBLOCK=<name>,<offset>,<size>".
+static void simUrdblockUrc(uAtClientHandle_t atHandle, void *pParameter)
+{
+    char buffer[64];
+    const char *pParam;
+    int32_t offset = -1;
+    int32_t size = -1;
+
+    (void) pParameter;
+
+    simReadCommandLine(atHandle, buffer, sizeof(buffer));
+    pParam = strchr(buffer, ',');
+    if (pParam != NULL) {
+        offset = strtol(pParam + 1, NULL, 10);
+        pParam = strchr(pParam + 1, ',');
+        if (pParam != NULL) {
+            size = strtol(pParam + 1, NULL, 10);
+        }
+    }
+    if ((offset >= 0) && (size >= 0) && (offset <= gSimFileSize)) {
+        if (size > gSimFileSize - offset) {
+            size = gSimFileSize - offset;
+        }
+        snprintf(buffer, sizeof(buffer), "\r\n+URDBLOCK: \"%s\",%d,\"",
+                 U_CELL_TEST_FILE_STREAM_NAME, (int) size);
+        uPortUartWrite(gUartBHandle, buffer, strlen(buffer));
+        uPortUartWrite(gUartBHandle, gSimFile + offset, size);
+        uPortUartWrite(gUartBHandle, "\"\r\n\r\nOK\r\n", 9);
+    } else {
+        uPortUartWrite(gUartBHandle, "\r\nERROR\r\n", 9);
+    }
+}
+
+// The byte at a given offset of the file uploaded by the
+// cellFileStream test.
+static char fileStreamByte(size_t offset)
+{
+    return (char) ('A' + ((offset * 7) + (offset / 26)) % 58);
+}
+
+// Callback for uCellFileWriteStream(), supplying the file.
+static int32_t fileStreamCallback(uDeviceHandle_t cellHandle,
+                                  size_t offset, char *pBuffer,
+                                  size_t size, void *pCallbackParam)
+{
+    (void) cellHandle;
+    (void) pCallbackParam;
+
+    for (size_t x = 0; x < size; x++) {
+        *(pBuffer + x) = fileStreamByte(offset + x);
+    }
+
+    return (int32_t) size;
+}
+
+// Check that the simulated file system contains the whole file.
+static bool fileStreamCheck()
+{
+    bool isGood = (gSimFileSize == U_CELL_TEST_FILE_STREAM_SIZE_BYTES);
+
+    for (size_t x = 0; isGood && (x < U_CELL_TEST_FILE_STREAM_SIZE_BYTES); x++) {
+        isGood = (gSimFile[x] == fileStreamByte(x));
+    }
+
+    return isGood;
+}
+
+// Callback for uSockGetHostByNameAsync().
+static void dnsCallback(uDeviceHandle_t devHandle, const char *pHostName,
+                        int32_t errorCode, const uSockIpAddress_t *pHostIpAddress,
+                        void *pParameter)
+{
+    (void) devHandle;
+    (void) pHostName;
+    (void) pParameter;
+
+    gDnsCallbackErrorCode = errorCode;
+    if (pHostIpAddress != NULL) {
+        gDnsCallbackAddress = *pHostIpAddress;
+    }
+    gDnsCallbackDone = true;
+}
+
+// Time numTimes look-ups of pHostName, returning the time taken.
+static int32_t timeDnsLookUps(uDeviceHandle_t devHandle,
+                              const char *pHostName, size_t numTimes,
+                              const uSockIpAddress_t *pExpectedIpAddress)
+{
+    uSockIpAddress_t ipAddress;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    for (size_t x = 0; x < numTimes; x++) {
+        memset(&ipAddress, 0xff, sizeof(ipAddress));
+        U_PORT_TEST_ASSERT(uSockGetHostByName(devHandle, pHostName,
+                                              &ipAddress) == 0);
+        U_PORT_TEST_ASSERT(ipAddress.type == pExpectedIpAddress->type);
+        U_PORT_TEST_ASSERT(ipAddress.address.ipv4 == pExpectedIpAddress->address.ipv4);
+    }
+
+    return uPortGetTickTimeMs() - startTimeMs;
+}
+
+// Task that uploads gpUploadData to gUploadDevHandle.
+static void uploadTask(void *pParameter)
+{
+    (void) pParameter;
+
+    gUploadResult = uCellFileWrite(gUploadDevHandle, "cell_lock",
+                                   gpUploadData,
+                                   U_CELL_TEST_INSTANCE_LOCK_UPLOAD_SIZE_BYTES);
+    gUploadDone = true;
+
+    uPortTaskDelete(NULL);
+}
+#endif
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -343,13 +815,707 @@ U_PORT_TEST_FUNCTION("[cell]", "cellAdd")
 }
 #endif
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Check that a long upload on one cellular instance does not
+ * hold up API calls on another: the cellular instance on UART A
+ * uploads a file to a "module" simulated by a URC handler on the
+ * AT client of the cellular instance on UART B while calls are
+ * timed on the cellular instance on UART B.
+ */
+U_PORT_TEST_FUNCTION("[cell]", "cellInstanceLock")
+{
+    uAtClientHandle_t atClientHandleA;
+    uAtClientHandle_t atClientHandleB;
+    uDeviceHandle_t devHandleB;
+    uPortTaskHandle_t taskHandle;
+    int32_t resourceCount;
+    int32_t startTimeMs;
+    int32_t uploadTimeMs;
+    int32_t latencyMs;
+    int32_t maxLatencyMs = 0;
+    size_t numCalls = 0;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uCellInit() == 0);
+
+    atClientHandleA = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                   NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandleA != NULL);
+    atClientHandleB = uAtClientAdd(gUartBHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                   NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandleB != NULL);
+    // The simulated module reads the uploaded data in
+    // URC context so give it plenty of time
+    uAtClientTimeoutUrcSet(atClientHandleB, 10000);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+UDWNFILE=",
+                                              udwnfileUrc, NULL) == 0);
+
+    U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, atClientHandleA,
+                                -1, -1, -1, false, &gUploadDevHandle) == 0);
+    U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, atClientHandleB,
+                                -1, -1, -1, false, &devHandleB) == 0);
+
+    gpUploadData = (char *) pUPortMalloc(U_CELL_TEST_INSTANCE_LOCK_UPLOAD_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(gpUploadData != NULL);
+    memset(gpUploadData, 'x', U_CELL_TEST_INSTANCE_LOCK_UPLOAD_SIZE_BYTES);
+
+    U_TEST_PRINT_LINE("uploading %d byte(s) on one instance while"
+                      " timing calls on the other...",
+                      U_CELL_TEST_INSTANCE_LOCK_UPLOAD_SIZE_BYTES);
+    gUploadStarted = false;
+    gUploadDone = false;
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uPortTaskCreate(uploadTask, "uploadTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       NULL, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    while (!gUploadDone && (uPortGetTickTimeMs() - startTimeMs < 60000)) {
+        latencyMs = uPortGetTickTimeMs();
+        // Nothing has set a file system tag on this instance
+        U_PORT_TEST_ASSERT(pUCellFileGetTag(devHandleB) == NULL);
+        latencyMs = uPortGetTickTimeMs() - latencyMs;
+        if (gUploadStarted && !gUploadDone) {
+            if (latencyMs > maxLatencyMs) {
+                maxLatencyMs = latencyMs;
+            }
+            numCalls++;
+        }
+        uPortTaskBlock(10);
+    }
+    uploadTimeMs = uPortGetTickTimeMs() - startTimeMs;
+    // Let the upload task go away
+    uPortTaskBlock(100);
+
+    U_TEST_PRINT_LINE("upload took %d ms, result %d; %d call(s) on the"
+                      " other instance took at most %d ms.", uploadTimeMs,
+                      gUploadResult, numCalls, maxLatencyMs);
+    U_PORT_TEST_ASSERT(gUploadDone);
+    U_PORT_TEST_ASSERT(gUploadResult == U_CELL_TEST_INSTANCE_LOCK_UPLOAD_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(numCalls > 0);
+    U_PORT_TEST_ASSERT(maxLatencyMs < U_CELL_TEST_INSTANCE_LOCK_MAX_LATENCY_MS);
+
+    uPortFree(gpUploadData);
+    gpUploadData = NULL;
+
+    uCellDeinit();
+    uAtClientDeinit();
+
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+#endif
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Test the DNS cache of the sockets layer using a cellular
+ * instance on UART A talking to a module simulated by URC
+ * handlers on an AT client on UART B: check positive and
+ * negative caching, expiry and the coalescing of simultaneous
+ * look-ups, and time a "reconnect storm" of look-ups of the
+ * same host name with the cache off and on.
+ */
+U_PORT_TEST_FUNCTION("[cell]", "cellDnsCache")
+{
+    uAtClientHandle_t atClientHandleA;
+    uAtClientHandle_t atClientHandleB;
+    uDeviceHandle_t devHandleA;
+    uSockAddress_t expectedAddress;
+    uSockIpAddress_t ipAddress;
+    int32_t resourceCount;
+    int32_t numLookUps;
+    int32_t timeOffMs;
+    int32_t timeOnMs;
+    int32_t startTimeMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    // The sockets layer needs Wi-Fi to be initialised
+    // as well as cellular, so initialise everything
+    U_PORT_TEST_ASSERT(uDeviceInit() == 0);
+
+    atClientHandleA = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                   NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandleA != NULL);
+    atClientHandleB = uAtClientAdd(gUartBHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                   NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandleB != NULL);
+    // The simulated module answers in URC context
+    // after a delay so give it time
+    uAtClientTimeoutUrcSet(atClientHandleB, 5000);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+UDNSRN=",
+                                              udnsrnUrc, NULL) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+CGDCONT?",
+                                              cgdcontUrc, NULL) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+USOER",
+                                              usoerUrc, NULL) == 0);
+
+    U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, atClientHandleA,
+                                -1, -1, -1, false, &devHandleA) == 0);
+
+    U_PORT_TEST_ASSERT(uSockStringToAddress(U_CELL_TEST_DNS_IP_ADDRESS,
+                                            &expectedAddress) == 0);
+    gDnsNumLookUps = 0;
+
+    // A DNS cache can only be set up for a real device
+    U_PORT_TEST_ASSERT(uSockDnsCacheSet(NULL, 60, 10) < 0);
+
+    // A reconnect storm with the cache off, which is the
+    // default: every look-up goes to the module
+    timeOffMs = timeDnsLookUps(devHandleA, "ubxlib.com",
+                               U_CELL_TEST_DNS_NUM_RECONNECTS,
+                               &(expectedAddress.ipAddress));
+    U_TEST_PRINT_LINE("%d look-up(s) with the DNS cache off took %d ms,"
+                      " %d went to the module.", U_CELL_TEST_DNS_NUM_RECONNECTS,
+                      timeOffMs, gDnsNumLookUps);
+    U_PORT_TEST_ASSERT(gDnsNumLookUps == U_CELL_TEST_DNS_NUM_RECONNECTS);
+
+    // ...and with the cache on: only the first does
+    gDnsNumLookUps = 0;
+    U_PORT_TEST_ASSERT(uSockDnsCacheSet(devHandleA, 60, 10) == 0);
+    timeOnMs = timeDnsLookUps(devHandleA, "ubxlib.com",
+                              U_CELL_TEST_DNS_NUM_RECONNECTS,
+                              &(expectedAddress.ipAddress));
+    U_TEST_PRINT_LINE("%d look-up(s) with the DNS cache on took %d ms,"
+                      " %d went to the module.", U_CELL_TEST_DNS_NUM_RECONNECTS,
+                      timeOnMs, gDnsNumLookUps);
+    U_PORT_TEST_ASSERT(gDnsNumLookUps == 1);
+    U_PORT_TEST_ASSERT(timeOnMs < timeOffMs / 2);
+
+    // An IP address as a host name doesn't bother the module
+    U_PORT_TEST_ASSERT(timeDnsLookUps(devHandleA, U_CELL_TEST_DNS_IP_ADDRESS, 1,
+                                      &(expectedAddress.ipAddress)) >= 0);
+    U_PORT_TEST_ASSERT(gDnsNumLookUps == 1);
+
+    // A host that can't be found is remembered too
+    U_TEST_PRINT_LINE("looking up a host that doesn't exist...");
+    U_PORT_TEST_ASSERT(uSockGetHostByName(devHandleA, "unknown.com",
+                                          &ipAddress) < 0);
+    U_PORT_TEST_ASSERT(errno == U_SOCK_ENXIO);
+    numLookUps = gDnsNumLookUps;
+    U_PORT_TEST_ASSERT(numLookUps > 1);
+    errno = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uSockGetHostByName(devHandleA, "unknown.com",
+                                          &ipAddress) < 0);
+    U_PORT_TEST_ASSERT(errno == U_SOCK_ENXIO);
+    U_PORT_TEST_ASSERT(gDnsNumLookUps == numLookUps);
+    U_TEST_PRINT_LINE("second look-up of a host that doesn't exist took %d ms.",
+                      uPortGetTickTimeMs() - startTimeMs);
+
+    // Entries expire
+    U_PORT_TEST_ASSERT(uSockDnsCacheSet(devHandleA, 1, 1) == 0);
+    uPortTaskBlock(1100);
+    U_PORT_TEST_ASSERT(timeDnsLookUps(devHandleA, "ubxlib.com", 2,
+                                      &(expectedAddress.ipAddress)) >= 0);
+    U_PORT_TEST_ASSERT(gDnsNumLookUps == numLookUps + 1);
+
+    // Flushing forgets everything
+    uSockDnsCacheFlush(devHandleA);
+    U_PORT_TEST_ASSERT(timeDnsLookUps(devHandleA, "ubxlib.com", 1,
+                                      &(expectedAddress.ipAddress)) >= 0);
+    U_PORT_TEST_ASSERT(gDnsNumLookUps == numLookUps + 2);
+
+    // An asynchronous look-up and a blocking look-up of the same
+    // host name at the same time should cost one look-up
+    U_TEST_PRINT_LINE("looking up the same host asynchronously and"
+                      " synchronously at the same time...");
+    U_PORT_TEST_ASSERT(uSockDnsCacheSet(devHandleA, 60, 10) == 0);
+    gDnsCallbackDone = false;
+    gDnsCallbackErrorCode = -1;
+    memset(&gDnsCallbackAddress, 0xff, sizeof(gDnsCallbackAddress));
+    U_PORT_TEST_ASSERT(uSockGetHostByNameAsync(devHandleA, "u-blox.com",
+                                               dnsCallback, NULL) == 0);
+    U_PORT_TEST_ASSERT(timeDnsLookUps(devHandleA, "u-blox.com", 1,
+                                      &(expectedAddress.ipAddress)) >= 0);
+    startTimeMs = uPortGetTickTimeMs();
+    while (!gDnsCallbackDone && (uPortGetTickTimeMs() - startTimeMs < 10000)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gDnsCallbackDone);
+    U_PORT_TEST_ASSERT(gDnsCallbackErrorCode == 0);
+    U_PORT_TEST_ASSERT(gDnsCallbackAddress.type == expectedAddress.ipAddress.type);
+    U_PORT_TEST_ASSERT(gDnsCallbackAddress.address.ipv4 == expectedAddress.ipAddress.address.ipv4);
+    U_PORT_TEST_ASSERT(gDnsNumLookUps == numLookUps + 3);
+
+    // The asynchronous callback is told about failures
+    gDnsCallbackDone = false;
+    U_PORT_TEST_ASSERT(uSockGetHostByNameAsync(devHandleA, "unknown.com",
+                                               dnsCallback, NULL) == 0);
+    startTimeMs = uPortGetTickTimeMs();
+    while (!gDnsCallbackDone && (uPortGetTickTimeMs() - startTimeMs < 10000)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gDnsCallbackDone);
+    U_PORT_TEST_ASSERT(gDnsCallbackErrorCode == -U_SOCK_ENXIO);
+
+    // The cache still knows u-blox.com...
+    numLookUps = gDnsNumLookUps;
+    U_PORT_TEST_ASSERT(timeDnsLookUps(devHandleA, "u-blox.com", 1,
+                                      &(expectedAddress.ipAddress)) >= 0);
+    U_PORT_TEST_ASSERT(gDnsNumLookUps == numLookUps);
+    // ...until uSockCleanUp() frees it, after which there
+    // is no caching again
+    uSockCleanUp();
+    U_PORT_TEST_ASSERT(timeDnsLookUps(devHandleA, "u-blox.com", 2,
+                                      &(expectedAddress.ipAddress)) >= 0);
+    U_PORT_TEST_ASSERT(gDnsNumLookUps == numLookUps + 2);
+
+    uSockDeinit();
+
+    uCellDeinit();
+    uDeviceDeinit();
+    uAtClientDeinit();
+
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test that the identity of a cellular module (IMEI, IMSI, etc.)
+ * is read from the module only once, however often it is asked
+ * for, that it is read again when invalidated and that a snapshot
+ * of it can be restored across a warm boot.  Uses a simulated
+ * module on UART B.
+ */
+U_PORT_TEST_FUNCTION("[cell]", "cellIdentityCache")
+{
+    uAtClientHandle_t atClientHandleA;
+    uAtClientHandle_t atClientHandleB;
+    uDeviceHandle_t devHandleA;
+    uCellInfoIdentity_t identity;
+    uCellInfoIdentity_t snapshot;
+    char buffer[U_CELL_INFO_IDENTITY_STR_BUFFER_SIZE];
+    int32_t resourceCount;
+    int32_t startTimeMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uCellInit() == 0);
+
+    atClientHandleA = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                   NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandleA != NULL);
+    atClientHandleB = uAtClientAdd(gUartBHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                   NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandleB != NULL);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+CGSN",
+                                              identityUrc,
+                                              (void *) &gpIdentityImeiResponse) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+CIMI",
+                                              identityUrc,
+                                              (void *) &gpIdentityImsiResponse) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+CCID",
+                                              identityUrc,
+                                              (void *) &gpIdentityIccidResponse) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+CGMI",
+                                              identityUrc,
+                                              (void *) &gpIdentityManufacturerResponse) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+CGMM",
+                                              identityUrc,
+                                              (void *) &gpIdentityModelResponse) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "ATI9",
+                                              identityUrc,
+                                              (void *) &gpIdentityFirmwareResponse) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "ATE0",
+                                              identityUrc,
+                                              (void *) &gpIdentityOkResponse) == 0);
+
+    U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, atClientHandleA,
+                                -1, -1, -1, false, &devHandleA) == 0);
+
+    // The first telemetry cycle reads everything from the module...
+    gIdentityNumCommands = 0;
+    U_PORT_TEST_ASSERT(uCellInfoGetIdentity(devHandleA, &identity) == 0);
+    U_PORT_TEST_ASSERT(identity.validBitMap == (1UL << U_CELL_INFO_IDENTITY_FIELD_MAX_NUM) - 1);
+    U_PORT_TEST_ASSERT(strcmp(identity.imei, "351234567890123") == 0);
+    U_PORT_TEST_ASSERT(strcmp(identity.imsi, "234150123456789") == 0);
+    U_PORT_TEST_ASSERT(strcmp(identity.iccid, "89441000300012345678") == 0);
+    U_PORT_TEST_ASSERT(strcmp(identity.manufacturer, "u-blox") == 0);
+    U_PORT_TEST_ASSERT(strcmp(identity.model, "SARA-R510M8S") == 0);
+    U_PORT_TEST_ASSERT(strcmp(identity.firmwareVersion, "03.15,A00.01") == 0);
+    U_PORT_TEST_ASSERT(gIdentityNumCommands == U_CELL_TEST_IDENTITY_NUM_COMMANDS);
+
+    // ...and the rest read nothing
+    U_TEST_PRINT_LINE("running %d telemetry cycles...", U_CELL_TEST_IDENTITY_NUM_CYCLES);
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 1; x < U_CELL_TEST_IDENTITY_NUM_CYCLES; x++) {
+        U_PORT_TEST_ASSERT(uCellInfoGetIdentity(devHandleA, &snapshot) == 0);
+        U_PORT_TEST_ASSERT(memcmp(&snapshot, &identity, sizeof(identity)) == 0);
+    }
+    U_TEST_PRINT_LINE("%d telemetry cycles took %d ms and %d AT command(s),"
+                      " rather than %d.", U_CELL_TEST_IDENTITY_NUM_CYCLES,
+                      uPortGetTickTimeMs() - startTimeMs, gIdentityNumCommands,
+                      U_CELL_TEST_IDENTITY_NUM_CYCLES * U_CELL_TEST_IDENTITY_NUM_COMMANDS);
+    U_PORT_TEST_ASSERT(gIdentityNumCommands == U_CELL_TEST_IDENTITY_NUM_COMMANDS);
+
+    // The individual getters use the cache too, truncating as before
+    U_PORT_TEST_ASSERT(uCellInfoGetImei(devHandleA, buffer) == 0);
+    U_PORT_TEST_ASSERT(memcmp(buffer, identity.imei, U_CELL_INFO_IMEI_SIZE) == 0);
+    U_PORT_TEST_ASSERT(uCellInfoGetIccidStr(devHandleA, buffer, sizeof(buffer)) == 20);
+    U_PORT_TEST_ASSERT(strcmp(buffer, identity.iccid) == 0);
+    U_PORT_TEST_ASSERT(uCellInfoGetModelStr(devHandleA, buffer, 5) == 4);
+    U_PORT_TEST_ASSERT(strcmp(buffer, "SARA") == 0);
+    U_PORT_TEST_ASSERT(gIdentityNumCommands == U_CELL_TEST_IDENTITY_NUM_COMMANDS);
+
+    // Invalidating forces a re-read
+    gIdentityNumCommands = 0;
+    U_PORT_TEST_ASSERT(uCellInfoIdentityInvalidate(devHandleA) == 0);
+    U_PORT_TEST_ASSERT(uCellInfoGetIdentity(devHandleA, &snapshot) == 0);
+    U_PORT_TEST_ASSERT(memcmp(&snapshot, &identity, sizeof(identity)) == 0);
+    U_PORT_TEST_ASSERT(gIdentityNumCommands == U_CELL_TEST_IDENTITY_NUM_COMMANDS);
+
+    // "Warm boot": a new instance is primed from the snapshot,
+    // checking only IMEI, ICCID and firmware version with the module
+    U_TEST_PRINT_LINE("restoring the identity after a warm boot...");
+    uCellRemove(devHandleA);
+    U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, atClientHandleA,
+                                -1, -1, -1, false, &devHandleA) == 0);
+    gIdentityNumCommands = 0;
+    U_PORT_TEST_ASSERT(uCellInfoIdentityRestore(devHandleA, &identity) == 0);
+    U_PORT_TEST_ASSERT(gIdentityNumCommands == 4);
+    U_PORT_TEST_ASSERT(uCellInfoGetIdentity(devHandleA, &snapshot) == 0);
+    U_PORT_TEST_ASSERT(memcmp(&snapshot, &identity, sizeof(identity)) == 0);
+    U_PORT_TEST_ASSERT(gIdentityNumCommands == 4);
+
+    // A corrupted snapshot is rejected without troubling the module
+    snapshot.imsi[0]++;
+    U_PORT_TEST_ASSERT(uCellInfoIdentityRestore(devHandleA,
+                                                &snapshot) == (int32_t) U_ERROR_COMMON_INVALID_PARAMETER);
+    U_PORT_TEST_ASSERT(gIdentityNumCommands == 4);
+
+    // A snapshot of a different module is not adopted
+    gpIdentityImeiResponse = "\r\n351234567890999\r\n\r\nOK\r\n";
+    U_PORT_TEST_ASSERT(uCellInfoIdentityInvalidate(devHandleA) == 0);
+    U_PORT_TEST_ASSERT(uCellInfoIdentityRestore(devHandleA,
+                                                &identity) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+    U_PORT_TEST_ASSERT(uCellInfoGetImei(devHandleA, buffer) == 0);
+    U_PORT_TEST_ASSERT(memcmp(buffer, "351234567890999", U_CELL_INFO_IMEI_SIZE) == 0);
+    gpIdentityImeiResponse = "\r\n351234567890123\r\n\r\nOK\r\n";
+
+    uCellDeinit();
+    uAtClientDeinit();
+
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test uCellFileWriteStream() against a simulated module file
+ * system on UART B, injecting failures part way through, and
+ * measure the throughput for a few chunk sizes.
+ */
+U_PORT_TEST_FUNCTION("[cell]", "cellFileStream")
+{
+    uAtClientHandle_t atClientHandleA;
+    uAtClientHandle_t atClientHandleB;
+    uDeviceHandle_t devHandleA;
+    uCellFileStreamConfig_t config = {0};
+    // Chunks larger than the AT buffer of the simulated
+    // module would overwhelm it
+    size_t chunkSizes[] = {256, 512, 1024};
+    size_t numChunks;
+    int32_t resourceCount;
+    int32_t startTimeMs;
+    int32_t timeTakenMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uCellInit() == 0);
+
+    atClientHandleA = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                   NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandleA != NULL);
+    atClientHandleB = uAtClientAdd(gUartBHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                   NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandleB != NULL);
+    // The simulated module reads chunks in URC context
+    uAtClientTimeoutUrcSet(atClientHandleB, 5000);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+UDWNFILE=",
+                                              simUdwnfileUrc, NULL) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+ULSTFILE=",
+                                              simUlstfileUrc, NULL) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+UDELFILE=",
+                                              simUdelfileUrc, NULL) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "AT+URDBLOCK=",
+                                              simUrdblockUrc, NULL) == 0);
+
+    U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, atClientHandleA,
+                                -1, -1, -1, false, &devHandleA) == 0);
+
+    config.chunkSizeBytes = 1024;
+    config.maxRetries = 1;
+    config.verify = true;
+    numChunks = (U_CELL_TEST_FILE_STREAM_SIZE_BYTES + config.chunkSizeBytes - 1) /
+                config.chunkSizeBytes;
+
+    // A straight upload, replacing what is there
+    gSimFileSize = 100;
+    gSimFileNumWrites = 0;
+    gSimFileFailWrite = 0;
+    U_PORT_TEST_ASSERT(uCellFileWriteStream(devHandleA, U_CELL_TEST_FILE_STREAM_NAME,
+                                            U_CELL_TEST_FILE_STREAM_SIZE_BYTES,
+                                            fileStreamCallback, NULL,
+                                            &config) == U_CELL_TEST_FILE_STREAM_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(fileStreamCheck());
+    U_PORT_TEST_ASSERT(gSimFileNumWrites == (int32_t) numChunks);
+
+    // A chunk that fails with only some of it written
+    U_TEST_PRINT_LINE("failing chunk 3 part-way through...");
+    gSimFileNumWrites = 0;
+    gSimFileFailWrite = 3;
+    gSimFileFailKeepBytes = 100;
+    U_PORT_TEST_ASSERT(uCellFileWriteStream(devHandleA, U_CELL_TEST_FILE_STREAM_NAME,
+                                            U_CELL_TEST_FILE_STREAM_SIZE_BYTES,
+                                            fileStreamCallback, NULL,
+                                            &config) == U_CELL_TEST_FILE_STREAM_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(fileStreamCheck());
+    // One more write since the chunks after the failure
+    // are no longer aligned
+    U_PORT_TEST_ASSERT(gSimFileNumWrites == (int32_t) numChunks + 1);
+
+    // A chunk that is all written but fails anyway
+    gSimFileNumWrites = 0;
+    gSimFileFailWrite = 5;
+    gSimFileFailKeepBytes = (int32_t) config.chunkSizeBytes;
+    U_PORT_TEST_ASSERT(uCellFileWriteStream(devHandleA, U_CELL_TEST_FILE_STREAM_NAME,
+                                            U_CELL_TEST_FILE_STREAM_SIZE_BYTES,
+                                            fileStreamCallback, NULL,
+                                            &config) == U_CELL_TEST_FILE_STREAM_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(fileStreamCheck());
+    U_PORT_TEST_ASSERT(gSimFileNumWrites == (int32_t) numChunks);
+
+    // An upload that is abandoned, then resumed later
+    U_TEST_PRINT_LINE("abandoning an upload and then resuming it...");
+    config.maxRetries = 0;
+    gSimFileNumWrites = 0;
+    gSimFileFailWrite = 7;
+    gSimFileFailKeepBytes = 10;
+    U_PORT_TEST_ASSERT(uCellFileWriteStream(devHandleA, U_CELL_TEST_FILE_STREAM_NAME,
+                                            U_CELL_TEST_FILE_STREAM_SIZE_BYTES,
+                                            fileStreamCallback, NULL,
+                                            &config) < 0);
+    U_PORT_TEST_ASSERT(gSimFileSize == (int32_t) (config.chunkSizeBytes * 6) + 10);
+    U_PORT_TEST_ASSERT(gSimFileNumWrites == 7);
+    config.resume = true;
+    gSimFileNumWrites = 0;
+    gSimFileFailWrite = 0;
+    U_PORT_TEST_ASSERT(uCellFileWriteStream(devHandleA, U_CELL_TEST_FILE_STREAM_NAME,
+                                            U_CELL_TEST_FILE_STREAM_SIZE_BYTES,
+                                            fileStreamCallback, NULL,
+                                            &config) == U_CELL_TEST_FILE_STREAM_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(fileStreamCheck());
+    U_PORT_TEST_ASSERT(gSimFileNumWrites == (int32_t) numChunks - 6);
+
+    // Resuming a complete file writes nothing but verification
+    // catches a corrupted byte
+    gSimFile[U_CELL_TEST_FILE_STREAM_SIZE_BYTES / 2]++;
+    gSimFileNumWrites = 0;
+    U_PORT_TEST_ASSERT(uCellFileWriteStream(devHandleA, U_CELL_TEST_FILE_STREAM_NAME,
+                                            U_CELL_TEST_FILE_STREAM_SIZE_BYTES,
+                                            fileStreamCallback, NULL,
+                                            &config) == (int32_t) U_ERROR_COMMON_BAD_DATA);
+    U_PORT_TEST_ASSERT(gSimFileNumWrites == 0);
+
+    // Throughput by chunk size
+    config.resume = false;
+    config.verify = false;
+    for (size_t x = 0; x < sizeof(chunkSizes) / sizeof(chunkSizes[0]); x++) {
+        config.chunkSizeBytes = chunkSizes[x];
+        startTimeMs = uPortGetTickTimeMs();
+        U_PORT_TEST_ASSERT(uCellFileWriteStream(devHandleA, U_CELL_TEST_FILE_STREAM_NAME,
+                                                U_CELL_TEST_FILE_STREAM_SIZE_BYTES,
+                                                fileStreamCallback, NULL,
+                                                &config) == U_CELL_TEST_FILE_STREAM_SIZE_BYTES);
+        timeTakenMs = uPortGetTickTimeMs() - startTimeMs;
+        U_PORT_TEST_ASSERT(fileStreamCheck());
+        U_TEST_PRINT_LINE("%d byte(s) in %d byte chunks took %d ms (%d bytes/second).",
+                          U_CELL_TEST_FILE_STREAM_SIZE_BYTES, chunkSizes[x], timeTakenMs,
+                          timeTakenMs > 0 ? (U_CELL_TEST_FILE_STREAM_SIZE_BYTES * 1000) / timeTakenMs : 0);
+    }
+
+    uCellDeinit();
+    uAtClientDeinit();
+
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+#endif
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
  */
 U_PORT_TEST_FUNCTION("[cell]", "cellCleanUp")
 {
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+    uPortFree(gpUploadData);
+    gpUploadData = NULL;
+    uSockDeinit();
+#endif
     uCellDeinit();
+    uDeviceDeinit();
     uAtClientDeinit();
     if (gUartAHandle >= 0) {
         uPortUartClose(gUartAHandle);
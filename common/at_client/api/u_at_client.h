@@ -427,6 +427,42 @@ extern "C" {
 # define U_AT_CLIENT_ACTIVITY_PIN_HYSTERESIS_INTERVAL_MS 10
 #endif
 
+#ifndef U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES
+/** The size of the transmit assembly buffer of an AT client.
+ * The command, the parameters and the delimiters of an
+ * outgoing AT command are collected in this buffer and sent
+ * to the stream in one go when uAtClientCommandStop() is
+ * called (or when the buffer becomes full) rather than as
+ * many small writes, which is kinder to a UART driver and
+ * significantly reduces the number of frames sent when the
+ * stream is a CMUX or EDM virtual stream.  Writes that are
+ * longer than the buffer (e.g. a large binary payload sent
+ * with uAtClientWriteBytes()) bypass it.  Set this to 0 to
+ * not use a transmit assembly buffer at all.
+ */
+# define U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES 128
+#endif
+
+#ifndef U_AT_CLIENT_COMMAND_STATS_COMMAND_MAX_LENGTH_BYTES
+/** The maximum length of the command that AT command statistics
+ * are recorded against, see uAtClientCommandStatsStart(), not
+ * including the null terminator; commands which are longer
+ * are truncated.
+ */
+# define U_AT_CLIENT_COMMAND_STATS_COMMAND_MAX_LENGTH_BYTES 15
+#endif
+
+#ifndef U_AT_CLIENT_COMMAND_STATS_HISTOGRAM_NUM_BINS
+/** The number of bins in each of the latency histograms of the AT
+ * command statistics, see #uAtClientCommandStats_t: bin 0 counts
+ * latencies of less than 1 millisecond, bin n counts latencies
+ * from 2^(n - 1) up to 2^n milliseconds and the last bin counts
+ * everything beyond that; with 16 bins the last bin begins at
+ * 16.384 seconds.
+ */
+# define U_AT_CLIENT_COMMAND_STATS_HISTOGRAM_NUM_BINS 16
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -477,6 +513,100 @@ typedef struct {
     int32_t code;
 } uAtClientDeviceError_t;
 
+/** The priorities of callback that can be made with
+ * uAtClientCallbackPriority(); see uAtClientCallbackExecutorSet().
+ */
+typedef enum {
+    U_AT_CLIENT_CALLBACK_PRIORITY_NORMAL = 0, /**< what uAtClientCallback() uses. */
+    U_AT_CLIENT_CALLBACK_PRIORITY_HIGH = 1,   /**< for things that should not
+                                                   wait behind the normal
+                                                   callbacks, e.g. changes
+                                                   in link state. */
+    U_AT_CLIENT_CALLBACK_PRIORITY_MAX_NUM
+} uAtClientCallbackPriority_t;
+
+/** Statistics for a callback executor, the task and queue at
+ * the end of uAtClientCallback(), see uAtClientCallbackStatsGet().
+ */
+typedef struct {
+    size_t queueLength;         /**< the number of callbacks the queue
+                                     can hold. */
+    size_t queueHighWaterMark;  /**< the largest number of callbacks
+                                     that have been waiting in the queue
+                                     at any one time. */
+    int32_t numCallbacks;       /**< the number of callbacks that have
+                                     been run. */
+    int32_t durationMaxMs;      /**< the longest time any one callback
+                                     took to run, in milliseconds. */
+    int32_t durationTotalMs;    /**< the total time spent running
+                                     callbacks, in milliseconds. */
+    int32_t stackMinFreeBytes;  /**< the minimum free stack of the task
+                                     that runs the callbacks, negative
+                                     error code if not supported. */
+} uAtClientCallbackStats_t;
+
+/** The statistics recorded for an AT command, see
+ * uAtClientCommandStatsStart().  All times are measured from
+ * the end of uAtClientCommandStart().
+ */
+typedef struct {
+    /** the command, up to and including any '=' or '?', null terminated. */
+    char command[U_AT_CLIENT_COMMAND_STATS_COMMAND_MAX_LENGTH_BYTES + 1];
+    int32_t count;        /**< the number of times the command was sent. */
+    int32_t numErrors;    /**< the number of times the command ended in
+                               an error other than a time-out, e.g.
+                               "ERROR" or "+CME ERROR". */
+    int32_t numTimeouts;  /**< the number of times the command ended
+                               with a time-out. */
+    /** log2 histogram of the time until the first byte of the
+     * response arrived; only commands where something arrived
+     * are included. */
+    int32_t firstByteHistogram[U_AT_CLIENT_COMMAND_STATS_HISTOGRAM_NUM_BINS];
+    /** log2 histogram of the time until the response ended. */
+    int32_t totalHistogram[U_AT_CLIENT_COMMAND_STATS_HISTOGRAM_NUM_BINS];
+} uAtClientCommandStats_t;
+
+/** Wake-up and deferred callback statistics for an AT client,
+ * see uAtClientWakeUpStatsGet().
+ */
+typedef struct {
+    int32_t numWakeUps;             /**< the number of times the wake-up
+                                         handler has been called. */
+    int32_t numWakeUpFailures;      /**< the number of times the wake-up
+                                         handler returned an error. */
+    int32_t wakeUpDurationMaxMs;    /**< the longest time the wake-up
+                                         handler took, in milliseconds. */
+    int32_t wakeUpDurationTotalMs;  /**< the total time spent in the
+                                         wake-up handler, in milliseconds. */
+    int32_t awakeTotalMs;           /**< the total time, in milliseconds,
+                                         that the module was awake: from
+                                         each wake-up until the inactivity
+                                         timeout after the last transmit
+                                         that followed it. */
+    int32_t numDeferred;            /**< the number of deferred callbacks,
+                                         see uAtClientDeferredAdd(), that
+                                         have been run. */
+    int32_t numDeferredLate;        /**< the number of deferred callbacks
+                                         that were run after their
+                                         deadline. */
+    int32_t deferredLatencyMaxMs;   /**< the longest time a deferred
+                                         callback waited after it became
+                                         due before it was run, in
+                                         milliseconds. */
+    int32_t deferredLatencyTotalMs; /**< the total time deferred callbacks
+                                         waited after they became due
+                                         before they were run, in
+                                         milliseconds. */
+} uAtClientWakeUpStats_t;
+
+/** A view of a parameter in the receive buffer of an AT client,
+ * see uAtClientReadStringView(); the data is NOT null-terminated.
+ */
+typedef struct {
+    const char *pData; /**< the start of the parameter. */
+    size_t length;     /**< the length of the parameter. */
+} uAtClientView_t;
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: INITIALISATION AND CONFIGURATION
  * -------------------------------------------------------------- */
@@ -797,6 +927,30 @@ int32_t uAtClientDelayGet(const uAtClientHandle_t atHandle);
 void uAtClientDelaySet(uAtClientHandle_t atHandle,
                        int32_t delayMs);
 
+/** Get whether the transmit assembly buffer is in use or not.
+ *
+ * @param atHandle  the handle of the AT client.
+ * @return          true if outgoing AT commands are being
+ *                  assembled in the transmit buffer before
+ *                  being sent, else false.
+ */
+bool uAtClientTxBufferGet(const uAtClientHandle_t atHandle);
+
+/** Switch use of the transmit assembly buffer on or off; it
+ * is on by default if #U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES is
+ * non-zero.  When the buffer is off each element of an AT
+ * command (the command itself, each parameter and each
+ * delimiter) is written to the stream separately, as soon
+ * as it is provided.  Switching the buffer off sends anything
+ * that is already in it.
+ *
+ * @param atHandle  the handle of the AT client.
+ * @param onNotOff  true to use the transmit assembly buffer,
+ *                  false to write everything straight to the
+ *                  stream.
+ */
+void uAtClientTxBufferSet(uAtClientHandle_t atHandle, bool onNotOff);
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: SEND AN AT COMMAND
  * -------------------------------------------------------------- */
@@ -1148,6 +1302,79 @@ int32_t uAtClientReadHexData(uAtClientHandle_t atHandle,
                              uint8_t *pData,
                              uint8_t lengthBytes);
 
+/** Read a string parameter from the received AT response
+ * stream without copying it: on return pView points at the
+ * parameter where it sits in the receive buffer of the AT
+ * client.  The delimiter and stop tag are obeyed as for
+ * uAtClientReadString() and, if the parameter begins with
+ * a quotation mark, the view is of what lies between that and
+ * the closing quotation mark; any other quotation marks are
+ * included in the view.
+ *
+ * IMPORTANT: the view is only valid until the next call into
+ * the AT client for this atHandle (including uAtClientUnlock()),
+ * after which the receive buffer may be rearranged.
+ *
+ * If the parameter is too long to fit into the receive buffer
+ * of the AT client then nothing is consumed and
+ * #U_ERROR_COMMON_NO_MEMORY is returned: call
+ * uAtClientReadString() with a buffer of your own instead.
+ *
+ * @param atHandle       the handle of the AT client.
+ * @param[out] pView     a place to put the view; cannot be NULL.
+ * @param ignoreStopTag  if true then continue reading even
+ *                       if the stop tag is found, in which case
+ *                       only the delimiter can end the parameter;
+ *                       see uAtClientReadString().
+ * @return               the length of the parameter in the view
+ *                       or negative error code.
+ */
+int32_t uAtClientReadStringView(uAtClientHandle_t atHandle,
+                                uAtClientView_t *pView,
+                                bool ignoreStopTag);
+
+/** Convert a view, as returned by uAtClientReadStringView(),
+ * containing a decimal integer, with an optional leading sign,
+ * into an integer.  The whole view must be consumed by the
+ * conversion.  This function does not touch the AT client and
+ * may be called on any view.
+ *
+ * @param[in] pView  the view; cannot be NULL.
+ * @param[out] pInt  a place to put the integer; cannot be NULL.
+ * @return           zero on success, else negative error code.
+ */
+int32_t uAtClientViewToInt(const uAtClientView_t *pView,
+                           int32_t *pInt);
+
+/** Convert a view, as returned by uAtClientReadStringView(),
+ * containing ASCII hex into binary.  Conversion stops at the
+ * first character that is not valid ASCII hex or when pBuffer
+ * is full.  This function does not touch the AT client and may
+ * be called on any view.
+ *
+ * @param[in] pView      the view; cannot be NULL.
+ * @param[out] pBuffer   a place to put the binary; cannot be NULL.
+ * @param bufferLength   the amount of storage at pBuffer.
+ * @return               the number of bytes written to pBuffer.
+ */
+size_t uAtClientViewHexToBin(const uAtClientView_t *pView,
+                             char *pBuffer, size_t bufferLength);
+
+/** Convert a view, as returned by uAtClientReadStringView(),
+ * containing an IPV4 address in dotted-decimal form, e.g.
+ * "192.168.1.1", into a uint32_t, e.g. 0xc0a80101.  The whole
+ * view must be consumed by the conversion.  This function does
+ * not touch the AT client and may be called on any view.
+ *
+ * @param[in] pView       the view; cannot be NULL.
+ * @param[out] pAddress   a place to put the address; cannot
+ *                        be NULL.
+ * @return                zero on success, else negative error
+ *                        code.
+ */
+int32_t uAtClientViewToIpV4(const uAtClientView_t *pView,
+                            uint32_t *pAddress);
+
 /** Marks the end of an AT response, should be called
  * after uAtClientResponseStart() when all of the
  * wanted parameters have been read.  The remainder of
@@ -1422,9 +1649,10 @@ int32_t uAtClientUrcHandlerStackMinFree(uAtClientHandle_t atHandle);
  * handler to avoid blocking the stream interface.  Callbacks
  * are queued and so are guaranteed to be run in the order
  * they are called.  A single callback queue is shared between
- * all AT client instances; you can determine which instance
- * has made the call by checking #uAtClientHandle_t, the first
- * parameter passed to the callback.
+ * all AT client instances, unless an AT client has been given
+ * its own with uAtClientCallbackExecutorSet(); you can determine
+ * which instance has made the call by checking #uAtClientHandle_t,
+ * the first parameter passed to the callback.
  *
  * @param atHandle            the handle of the AT client.
  * @param[in] pCallback       the callback function.
@@ -1448,6 +1676,113 @@ int32_t uAtClientCallback(uAtClientHandle_t atHandle,
  */
 int32_t uAtClientCallbackStackMinFree();
 
+/** Give an AT client its own callback executor, a task with its
+ * own queue, for callbacks of the given priority; without this
+ * the callbacks of all AT clients are run by one shared task,
+ * which means that a slow callback from one AT client will hold
+ * up the callbacks of all of the others.  The executor is
+ * released when the AT client is removed.  An executor may only
+ * be set once for each priority of each AT client.
+ *
+ * Callbacks of #U_AT_CLIENT_CALLBACK_PRIORITY_HIGH for an AT
+ * client that does not have an executor of that priority are
+ * run by the executor for #U_AT_CLIENT_CALLBACK_PRIORITY_NORMAL,
+ * i.e. the AT client's own, if it has one, else the shared one.
+ * Note that callbacks are only guaranteed to be run in the order
+ * they are called if they are run by the same executor.
+ *
+ * @param atHandle        the handle of the AT client.
+ * @param priority        the priority of callback that the
+ *                        executor is to run.
+ * @param stackSizeBytes  the stack size of the task that will run
+ *                        the callbacks, e.g.
+ *                        #U_AT_CLIENT_CALLBACK_TASK_STACK_SIZE_BYTES.
+ * @param taskPriority    the priority of the task that will run
+ *                        the callbacks, e.g.
+ *                        #U_AT_CLIENT_CALLBACK_TASK_PRIORITY.
+ * @param queueLength     the number of callbacks that can be
+ *                        waiting to be run, must be at least 1.
+ * @return                zero on success else negative error code.
+ */
+int32_t uAtClientCallbackExecutorSet(uAtClientHandle_t atHandle,
+                                     uAtClientCallbackPriority_t priority,
+                                     size_t stackSizeBytes,
+                                     int32_t taskPriority,
+                                     size_t queueLength);
+
+/** Get the settings of the callback executor of the given
+ * priority for an AT client, as set by uAtClientCallbackExecutorSet().
+ *
+ * @param atHandle              the handle of the AT client.
+ * @param priority              the priority of callback.
+ * @param[out] pStackSizeBytes  a place to put the stack size of the
+ *                              executor's task; may be NULL.
+ * @param[out] pTaskPriority    a place to put the priority of the
+ *                              executor's task; may be NULL.
+ * @param[out] pQueueLength     a place to put the length of the
+ *                              executor's queue; may be NULL.
+ * @return                      zero on success, #U_ERROR_COMMON_NOT_FOUND
+ *                              if the AT client has no executor of its
+ *                              own of the given priority, else negative
+ *                              error code.
+ */
+int32_t uAtClientCallbackExecutorGet(uAtClientHandle_t atHandle,
+                                     uAtClientCallbackPriority_t priority,
+                                     size_t *pStackSizeBytes,
+                                     int32_t *pTaskPriority,
+                                     size_t *pQueueLength);
+
+/** As uAtClientCallback() but with a priority; see
+ * uAtClientCallbackExecutorSet() for how the priority is
+ * used.  uAtClientCallback() is the same as calling this with
+ * #U_AT_CLIENT_CALLBACK_PRIORITY_NORMAL.
+ *
+ * @param atHandle            the handle of the AT client.
+ * @param priority            the priority of the callback.
+ * @param[in] pCallback       the callback function.
+ * @param[in] pCallbackParam  a parameter to pass to the callback,
+ *                            as the second parameter, may be NULL.
+ * @return                    zero on success else negative error code.
+ */
+int32_t uAtClientCallbackPriority(uAtClientHandle_t atHandle,
+                                  uAtClientCallbackPriority_t priority,
+                                  void (*pCallback) (uAtClientHandle_t, void *),
+                                  void *pCallbackParam);
+
+/** As uAtClientCallback() but this function never waits, either
+ * for a lock that is held elsewhere or for space in a full callback
+ * queue; it is intended for use from a timer callback, which must
+ * not block.  If the callback cannot be queued immediately
+ * #U_ERROR_COMMON_BUSY is returned and the caller should try
+ * again later, e.g. by restarting its timer.
+ *
+ * @param atHandle            the handle of the AT client.
+ * @param[in] pCallback       the callback function.
+ * @param[in] pCallbackParam  a parameter to pass to the callback,
+ *                            as the second parameter, may be NULL.
+ * @return                    zero on success, #U_ERROR_COMMON_BUSY
+ *                            if the callback could not be queued
+ *                            without waiting, else negative error
+ *                            code.
+ */
+int32_t uAtClientCallbackNoWait(uAtClientHandle_t atHandle,
+                                void (*pCallback) (uAtClientHandle_t, void *),
+                                void *pCallbackParam);
+
+/** Get the statistics of the executor that runs callbacks of the
+ * given priority for an AT client.
+ *
+ * @param atHandle    the handle of the AT client; use NULL to get
+ *                    the statistics of the shared executor.
+ * @param priority    the priority of callback, ignored if atHandle
+ *                    is NULL.
+ * @param[out] pStats a place to put the statistics; cannot be NULL.
+ * @return            zero on success else negative error code.
+ */
+int32_t uAtClientCallbackStatsGet(uAtClientHandle_t atHandle,
+                                  uAtClientCallbackPriority_t priority,
+                                  uAtClientCallbackStats_t *pStats);
+
 /** It should NOT normally be necessary to use this, URCs should
  * be handled with the uAtClientSetUrcHandler() function since they
  * arrive asynchronously.  However, there are cases (e.g. in
@@ -1713,6 +2048,10 @@ void uAtClientStreamInterceptRx(uAtClientHandle_t atHandle,
  * are required and return an integer; if the return value is zero
  * then the power-up is assumed to have succeeded and operations
  * will continue, else an error is assumed to have occurred.
+ * AT work that can tolerate some delay may be given to
+ * uAtClientDeferredAdd() so that it shares wake-ups with other
+ * work; uAtClientWakeUpStatsGet() reports how often wake-ups
+ * occur and how long they take.
  *
  * Note: if you have your own port, for this function to work
  * the port API functions uPortTaskGetHandle(),
@@ -1844,6 +2183,183 @@ int32_t uAtClientGetAti(uAtClientHandle_t atHandle,
                         char *pBuffer,
                         size_t lengthBytes);
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: AT COMMAND STATISTICS
+ * -------------------------------------------------------------- */
+
+/** Start recording statistics for the AT commands sent by an AT
+ * client: for each command, as passed to uAtClientCommandStart()
+ * up to and including any '=' or '?', the number of times it was
+ * sent, the number of errors and time-outs and log2 histograms of
+ * the time until the first byte of the response and the time until
+ * the response ended, i.e. uAtClientResponseStop(), the next
+ * uAtClientCommandStart() or uAtClientUnlock(), whichever comes first.
+ * Recording statistics costs a little time for each AT command
+ * and around 150 bytes of heap per command; it is off by default.
+ * If statistics are already being recorded this does nothing.
+ *
+ * @param atHandle        the handle of the AT client.
+ * @param maxNumCommands  the maximum number of different commands
+ *                        to record statistics for; commands that
+ *                        arrive when the table is full are not recorded.
+ * @return                zero on success else negative error code.
+ */
+int32_t uAtClientCommandStatsStart(uAtClientHandle_t atHandle,
+                                   size_t maxNumCommands);
+
+/** Get the maximum number of commands that statistics are
+ * being recorded for, as passed to uAtClientCommandStatsStart().
+ *
+ * @param atHandle the handle of the AT client.
+ * @return         the maximum number of commands, else negative
+ *                 error code; if statistics are not being recorded
+ *                 #U_ERROR_COMMON_NOT_INITIALISED is returned.
+ */
+int32_t uAtClientCommandStatsMaxNumGet(const uAtClientHandle_t atHandle);
+
+/** Stop recording AT command statistics, freeing the memory
+ * that was used to store them.
+ *
+ * @param atHandle the handle of the AT client.
+ */
+void uAtClientCommandStatsStop(uAtClientHandle_t atHandle);
+
+/** Reset the AT command statistics, forgetting all of the
+ * commands; recording continues.
+ *
+ * @param atHandle the handle of the AT client.
+ */
+void uAtClientCommandStatsReset(uAtClientHandle_t atHandle);
+
+/** Get a snapshot of the AT command statistics, one entry per
+ * command, in the order the commands were first sent.
+ *
+ * @param atHandle      the handle of the AT client.
+ * @param[out] pStats   a pointer to an array of maxNumStats
+ *                      entries in which to put the statistics;
+ *                      cannot be NULL.
+ * @param maxNumStats   the number of entries at pStats.
+ * @return              the number of entries written to pStats,
+ *                      else negative error code; if statistics are
+ *                      not being recorded #U_ERROR_COMMON_NOT_INITIALISED
+ *                      is returned.
+ */
+int32_t uAtClientCommandStatsGet(uAtClientHandle_t atHandle,
+                                 uAtClientCommandStats_t *pStats,
+                                 size_t maxNumStats);
+
+/** Write the AT command statistics as comma separated values: a
+ * header line followed by one line per command containing the
+ * command (in quotes), count, number of errors, number of time-outs,
+ * then the #U_AT_CLIENT_COMMAND_STATS_HISTOGRAM_NUM_BINS bins of the
+ * time-to-first-byte histogram followed by the same number of bins
+ * of the total time histogram.  Each line is terminated with "\n".
+ * As with snprintf(), the output is truncated (and always null
+ * terminated) if the buffer is too short, and the return value is
+ * the length that would have been written, so that this function
+ * can be called with a NULL pBuffer to find out how much room is
+ * needed.
+ *
+ * @param atHandle      the handle of the AT client.
+ * @param[out] pBuffer  a place to put the CSV text; may be NULL
+ *                      if bufferLength is zero.
+ * @param bufferLength  the number of bytes at pBuffer, including
+ *                      room for the null terminator.
+ * @return              the length of the CSV text, not including
+ *                      the null terminator, else negative error code;
+ *                      if statistics are not being recorded
+ *                      #U_ERROR_COMMON_NOT_INITIALISED is returned.
+ */
+int32_t uAtClientCommandStatsCsv(uAtClientHandle_t atHandle,
+                                 char *pBuffer, size_t bufferLength);
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: DEFERRED AT COMMANDS
+ * -------------------------------------------------------------- */
+
+/** Defer some AT work, e.g. a periodic signal strength or socket
+ * poll, so that it can share a wake-up of the module with other
+ * AT work.  Where a wake-up handler is set, see
+ * uAtClientSetWakeUpHandler(), every AT command that is sent
+ * after the inactivity timeout has expired pays for the
+ * wake-up; work that can tolerate some delay can instead be
+ * given to this function, which calls pCallback, in which the
+ * usual uAtClientLock() / uAtClientUnlock() sequences may be
+ * performed, from the AT callback task, see uAtClientCallback():
+ *
+ * - no sooner than notBeforeMs from now,
+ * - as soon as possible after that if the module is awake anyway,
+ *   i.e. when any uAtClientUnlock() occurs before the inactivity
+ *   timeout has expired,
+ * - at the latest, subject to the load on the AT callback task,
+ *   deadlineMs from now, at which point all of the other deferred
+ *   callbacks that are due are run with it, in the same wake-up.
+ *
+ * The callback is run once; a periodic callback should call this
+ * function again from within the callback.  If no wake-up handler
+ * is set the module is always considered to be awake.
+ *
+ * Note: if you have your own port, for this function to work the
+ * port API functions uPortTimerCreate(), uPortTimerStart(),
+ * uPortTimerStop() and uPortTimerChange() must be implemented.
+ *
+ * @param atHandle            the handle of the AT client.
+ * @param[in] pCallback       the callback function; cannot be NULL.
+ * @param[in] pCallbackParam  a parameter to pass to the callback,
+ *                            as the second parameter, may be NULL.
+ * @param notBeforeMs         the time from now, in milliseconds,
+ *                            before which the callback must not
+ *                            be run; use zero to allow it to be
+ *                            run immediately.
+ * @param deadlineMs          the time from now, in milliseconds,
+ *                            by which the callback should be run;
+ *                            must be at least notBeforeMs.
+ * @return                    zero on success else negative error code.
+ */
+int32_t uAtClientDeferredAdd(uAtClientHandle_t atHandle,
+                             void (*pCallback) (uAtClientHandle_t, void *),
+                             void *pCallbackParam,
+                             int32_t notBeforeMs, int32_t deadlineMs);
+
+/** Remove deferred callbacks that have not yet been run.  A
+ * callback that is already running cannot be stopped: if one
+ * matches, which may be because this is called from within that
+ * callback, the rest are still removed but #U_ERROR_COMMON_BUSY is
+ * returned, since the running callback may go on using
+ * pCallbackParam until it returns.
+ *
+ * @param atHandle            the handle of the AT client.
+ * @param[in] pCallback       the callback function, as passed to
+ *                            uAtClientDeferredAdd().
+ * @param[in] pCallbackParam  the callback parameter, as passed to
+ *                            uAtClientDeferredAdd().
+ * @return                    the number of deferred callbacks that
+ *                            were removed, #U_ERROR_COMMON_BUSY if
+ *                            a matching callback is running, else
+ *                            negative error code.
+ */
+int32_t uAtClientDeferredRemove(uAtClientHandle_t atHandle,
+                                void (*pCallback) (uAtClientHandle_t, void *),
+                                void *pCallbackParam);
+
+/** Get the wake-up and deferred callback statistics of an AT
+ * client; these are recorded from the time the AT client is
+ * added, whether a wake-up handler is set or not.
+ *
+ * @param atHandle    the handle of the AT client.
+ * @param[out] pStats a place to put the statistics; cannot be NULL.
+ * @return            zero on success else negative error code.
+ */
+int32_t uAtClientWakeUpStatsGet(uAtClientHandle_t atHandle,
+                                uAtClientWakeUpStats_t *pStats);
+
+/** Reset the wake-up and deferred callback statistics of an
+ * AT client.
+ *
+ * @param atHandle the handle of the AT client.
+ */
+void uAtClientWakeUpStatsReset(uAtClientHandle_t atHandle);
+
 #ifdef __cplusplus
 }
 #endif
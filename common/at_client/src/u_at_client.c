@@ -238,6 +238,14 @@
 # define U_AT_CLIENT_ACTIVITY_PIN_HYSTERESIS_INTERVAL_MS 10
 #endif
 
+#ifndef U_AT_CLIENT_DEFERRED_RETRY_MS
+/** If the deferred callback timer expires and deferredRun() cannot
+ * be queued without waiting, the interval after which to try again;
+ * value in milliseconds.
+ */
+# define U_AT_CLIENT_DEFERRED_RETRY_MS 10
+#endif
+
 /** The mutex stack, used when locking the stream mutex, required
  * because when the wake-up handler is active there will be two
  * stream mutexes that may be locked: the normal one and the
@@ -377,6 +385,22 @@ typedef enum {
     U_AT_CLIENT_BLOCK_STATE_DO_NOT_BLOCK
 } uAtClientBlockState_t;
 
+/** A callback executor: an event queue, and hence a task,
+ * that runs callbacks, plus its settings and statistics.
+ */
+typedef struct {
+    int32_t eventQueueHandle;
+    size_t stackSizeBytes;
+    int32_t taskPriority;
+    size_t queueLength;
+    uint32_t numSent; /** Only modified with gMutexEventQueue locked. */
+    uint32_t numReceived; /** Only modified by the executor task. */
+    size_t queueHighWaterMark; /** Only modified by the executor task. */
+    int32_t numCallbacks;
+    int32_t durationMaxMs;
+    int32_t durationTotalMs;
+} uAtClientCallbackExecutor_t;
+
 /** A struct defining a callback plus its optional parameter.
  */
 typedef struct {
@@ -384,6 +408,7 @@ typedef struct {
     uAtClientHandle_t atHandle;
     void *pParam;
     int32_t atClientMagicNumber;
+    uAtClientCallbackExecutor_t *pExecutor;
 } uAtClientCallback_t;
 
 /** Struct defining a wake-up handler.
@@ -409,6 +434,38 @@ typedef struct {
     int32_t hysteresisMs;
 } uAtClientActivityPin_t;
 
+/** Context for recording AT command statistics.
+ */
+typedef struct {
+    size_t maxNum; /** The number of entries at pEntries. */
+    size_t num; /** The number of entries at pEntries that are in use. */
+    uAtClientCommandStats_t *pEntries; /** The entries, which follow this structure in memory. */
+    uAtClientCommandStats_t *pCurrent; /** The entry of the command in progress, NULL if none. */
+    int32_t startTimeMs; /** The time the command in progress was started. */
+    int32_t firstByteTimeMs; /** The time the first byte of its response arrived, -1 if none yet. */
+    bool timedOut; /** Whether the command in progress has timed out. */
+} uAtClientCommandStatsContext_t;
+
+/** A deferred callback, see uAtClientDeferredAdd().
+ */
+typedef struct uAtClientDeferred_t {
+    void (*pCallback) (uAtClientHandle_t, void *);
+    void *pParam;
+    int32_t notBeforeTimeMs; /** The time before which the callback must not be run. */
+    int32_t deadlineTimeMs; /** The time by which the callback should be run. */
+    bool due; /** Set when deferredRun() has chosen the callback to be run. */
+    struct uAtClientDeferred_t *pNext;
+} uAtClientDeferred_t;
+
+/** Context for deferred callbacks.
+ */
+typedef struct {
+    uAtClientDeferred_t *pList; /** The deferred callbacks that have not yet been run. */
+    uAtClientDeferred_t *pRunning; /** The deferred callback that is running, if any. */
+    uPortTimerHandle_t timer; /** One-shot timer for the earliest deadline. */
+    bool runQueued; /** Whether deferredRun() is waiting in the callback queue. */
+} uAtClientDeferredContext_t;
+
 /** Struct defining a stack of mutexes.
  */
 typedef struct {
@@ -468,6 +525,18 @@ typedef struct uAtClientInstance_t {
                                    as its fourth parameter. */
     uAtClientWakeUp_t *pWakeUp; /** Pointer to a wake-up handler structure. */
     uAtClientActivityPin_t *pActivityPin; /** Pointer to an activity pin structure. */
+    uAtClientCommandStatsContext_t *pCommandStats; /** AT command statistics, NULL if
+                                                       they are not being recorded. */
+    uAtClientDeferredContext_t *pDeferred; /** Deferred callbacks, NULL if there have
+                                               never been any. */
+    uAtClientWakeUpStats_t wakeUpStats; /** Wake-up and deferred callback statistics. */
+    int32_t awakeStartTimeMs; /** The time of the last wake-up, -1 if there has been none. */
+    /** This AT client's own callback executors, NULL where there is none. */
+    uAtClientCallbackExecutor_t *pCallbackExecutor[U_AT_CLIENT_CALLBACK_PRIORITY_MAX_NUM];
+    char *pTxBuffer; /** The transmit assembly buffer, U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES
+                         long, NULL if there is none. */
+    size_t txBufferLength; /** The number of bytes waiting to be sent in pTxBuffer. */
+    bool txBufferOn; /** Whether pTxBuffer is to be used or not. */
     struct uAtClientInstance_t *pNext;
 } uAtClientInstance_t;
 
@@ -542,24 +611,41 @@ static const uAtClientTagDef_t gResponseStopTag = {U_AT_CLIENT_OK,
  */
 static const uAtClientTagDef_t gNoStopTag = {"", 0};
 
-/** The event queue for callbacks.
+/** The shared executor for callbacks, used by any AT client
+ * which does not have its own.
  */
-static int32_t gEventQueueHandle;
+static uAtClientCallbackExecutor_t gCallbackExecutor;
 
-/** Mutex to protect gEventQueueHandle.
+/** Mutex to protect gCallbackExecutor and the setting of
+ * the callback executors of each AT client.
  * Note: the reason for this being separate to gMutex is
  * because uAtClientCallback(), which needs to ensure that
- * gEventQueueHandle is good, can be called by a URC callback.
+ * gCallbackExecutor is good, can be called by a URC callback.
  * If a URC lands while we're in uAtClientResponseStart(),
  * the URC callback will be called directly from within
  * uAtClientResponseStart(), rather than by the separate
  * URC task.  Since uAtClientResponseStart() must lock
  * gMutex while it runs gMutex can't also be locked
  * by uAtClientCallback() so we need a separate
- * mutex for the protection of gEventQueueHandle.
+ * mutex for the protection of gCallbackExecutor.
  */
 static uPortMutexHandle_t gMutexEventQueue = NULL;
 
+/** Mutex to protect gpDeferredClient and the deferred callback
+ * timers of the AT clients.
+ * Note: this is only ever held while looking at gpDeferredClient
+ * or starting, stopping or deleting a timer, never while waiting
+ * for anything, so that the timer callback, deferredTimerCallback(),
+ * which must not be held up, can lock it.
+ */
+static uPortMutexHandle_t gMutexDeferred = NULL;
+
+/** The AT clients that have a deferred callback timer, see
+ * deferredTimerCallback(); an AT client is removed from here
+ * before its timer is deleted.
+ */
+static uAtClientInstance_t *gpDeferredClient[U_AT_CLIENT_MAX_NUM] = {0};
+
 /** The origin for timestamps on debug and AT prints
  * in seconds, set by uAtClientTimestampSet(), -1
  * for "not set, do not print timestamps".
@@ -833,6 +919,33 @@ static void removeAtClientInstance(const uAtClientInstance_t *pClient)
     }
 }
 
+// Free the deferred callbacks of an AT client and their timer.
+static void deferredFree(uAtClientInstance_t *pClient)
+{
+    uAtClientDeferredContext_t *pContext = pClient->pDeferred;
+    uAtClientDeferred_t *pDeferred;
+
+    if (pContext != NULL) {
+        U_PORT_MUTEX_LOCK(gMutexDeferred);
+        for (size_t x = 0; x < sizeof(gpDeferredClient) / sizeof(gpDeferredClient[0]); x++) {
+            if (gpDeferredClient[x] == pClient) {
+                gpDeferredClient[x] = NULL;
+            }
+        }
+        uPortTimerDelete(pContext->timer);
+        U_PORT_MUTEX_UNLOCK(gMutexDeferred);
+        // A deferred callback that is running was taken off
+        // the list already and is freed by deferredRun()
+        while (pContext->pList != NULL) {
+            pDeferred = pContext->pList;
+            pContext->pList = pDeferred->pNext;
+            uPortFree(pDeferred);
+        }
+        uPortFree(pContext);
+        pClient->pDeferred = NULL;
+    }
+}
+
 // Remove an AT client.
 // gMutex should be locked before this is called.
 static void removeClient(uAtClientInstance_t *pClient)
@@ -888,6 +1001,30 @@ static void removeClient(uAtClientInstance_t *pClient)
     // Remove any activity pin
     uPortFree(pClient->pActivityPin);
 
+    // Free any AT command statistics
+    uPortFree(pClient->pCommandStats);
+
+    // Free any deferred callbacks that were not run; a
+    // deferredRun() that is still queued will be ignored
+    // since we've called ignoreAsync() above
+    deferredFree(pClient);
+
+    // Close any callback executors of its own; any
+    // callbacks still queued will be ignored since
+    // we've called ignoreAsync() above
+    U_PORT_MUTEX_LOCK(gMutexEventQueue);
+    for (size_t x = 0; x < sizeof(pClient->pCallbackExecutor) /
+         sizeof(pClient->pCallbackExecutor[0]); x++) {
+        if (pClient->pCallbackExecutor[x] != NULL) {
+            uPortEventQueueClose(pClient->pCallbackExecutor[x]->eventQueueHandle);
+            uPortFree(pClient->pCallbackExecutor[x]);
+        }
+    }
+    U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
+
+    // Free the transmit assembly buffer
+    uPortFree(pClient->pTxBuffer);
+
     // Free the receive buffer if it was allocated.
     if (pClient->pReceiveBuffer->isMalloced) {
         uPortFree(pClient->pReceiveBuffer);
@@ -1143,13 +1280,18 @@ static void printAt(uAtClientInstance_t *pClient,
                     timestamp = true;
                     pClient->newSendNextTime = false;
                 }
-                if ((length == U_AT_CLIENT_COMMAND_DELIMITER_LENGTH_BYTES) &&
-                    (memcmp(pAt, U_AT_CLIENT_COMMAND_DELIMITER, length) == 0)) {
-                    // If we're just sending the delimiter, which happens at the
-                    // end of a sent line, don't print a timestamp before it,
-                    // that would be silly, but remember that the next send will
-                    // require a timestamp
-                    timestamp = false;
+                if ((length >= U_AT_CLIENT_COMMAND_DELIMITER_LENGTH_BYTES) &&
+                    (memcmp(pAt + length - U_AT_CLIENT_COMMAND_DELIMITER_LENGTH_BYTES,
+                            U_AT_CLIENT_COMMAND_DELIMITER,
+                            U_AT_CLIENT_COMMAND_DELIMITER_LENGTH_BYTES) == 0)) {
+                    // If we're sending the end of a line, remember that the
+                    // next send will require a timestamp; if we're _just_
+                    // sending the delimiter, which happens at the end of a
+                    // sent line when there is no transmit assembly buffer,
+                    // don't print a timestamp before it, that would be silly
+                    if (length == U_AT_CLIENT_COMMAND_DELIMITER_LENGTH_BYTES) {
+                        timestamp = false;
+                    }
                     pClient->newSendNextTime = true;
                 }
             }
@@ -1220,15 +1362,428 @@ static void clearError(uAtClientInstance_t *pClient)
     setError(pClient, U_ERROR_COMMON_SUCCESS);
 }
 
+// Get the callback executor that should run callbacks of the
+// given priority for the given AT client.
+static uAtClientCallbackExecutor_t *pCallbackExecutorGet(const uAtClientInstance_t *pClient,
+                                                         uAtClientCallbackPriority_t priority)
+{
+    uAtClientCallbackExecutor_t *pExecutor = pClient->pCallbackExecutor[priority];
+
+    if (pExecutor == NULL) {
+        // Fall back to the normal priority executor
+        // of this AT client, then the shared one
+        pExecutor = pClient->pCallbackExecutor[U_AT_CLIENT_CALLBACK_PRIORITY_NORMAL];
+        if (pExecutor == NULL) {
+            pExecutor = &gCallbackExecutor;
+        }
+    }
+
+    return pExecutor;
+}
+
+// Send a callback to the executor for the given priority.
+static int32_t callbackSend(const uAtClientInstance_t *pClient,
+                            uAtClientCallbackPriority_t priority,
+                            uAtClientCallback_t *pCb)
+{
+    int32_t errorCode = 0;
+    uAtClientCallbackExecutor_t *pExecutor;
+
+    U_PORT_MUTEX_LOCK(gMutexEventQueue);
+
+    pExecutor = pCallbackExecutorGet(pClient, priority);
+    pCb->pExecutor = pExecutor;
+    // Count it in before sending so that the executor
+    // task can never see more received than sent
+    pExecutor->numSent++;
+    if (pExecutor == &gCallbackExecutor) {
+        errorCode = uPortEventQueueSend(pExecutor->eventQueueHandle, pCb, sizeof(*pCb));
+        if (errorCode != 0) {
+            pExecutor->numSent--;
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
+
+    if (pExecutor != &gCallbackExecutor) {
+        // An AT client's own executor cannot be removed while
+        // the AT client is in use so there is no need to hold
+        // the mutex while sending: better not to in case the
+        // send blocks, which would hold up the other AT clients
+        errorCode = uPortEventQueueSend(pExecutor->eventQueueHandle, pCb, sizeof(*pCb));
+        if (errorCode != 0) {
+            U_PORT_MUTEX_LOCK(gMutexEventQueue);
+            pExecutor->numSent--;
+            U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
+        }
+    }
+
+    return errorCode;
+}
+
+// As callbackSend() but never waits: if the event queue mutex is
+// held elsewhere, or the executor's queue is full, give up with
+// U_ERROR_COMMON_BUSY; for use from timer callbacks.
+static int32_t callbackSendNoWait(const uAtClientInstance_t *pClient,
+                                  uAtClientCallbackPriority_t priority,
+                                  uAtClientCallback_t *pCb)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_BUSY;
+    uAtClientCallbackExecutor_t *pExecutor;
+
+    if (uPortMutexTryLock(gMutexEventQueue, 0) == 0) {
+        pExecutor = pCallbackExecutorGet(pClient, priority);
+        if (uPortEventQueueGetFree(pExecutor->eventQueueHandle) > 0) {
+            pCb->pExecutor = pExecutor;
+            pExecutor->numSent++;
+            errorCode = uPortEventQueueSend(pExecutor->eventQueueHandle, pCb, sizeof(*pCb));
+            if (errorCode != 0) {
+                pExecutor->numSent--;
+            }
+        }
+        uPortMutexUnlock(gMutexEventQueue);
+    }
+
+    return errorCode;
+}
+
+// Return the AT command statistics histogram bin for a time.
+static size_t commandStatsBin(int32_t timeMs)
+{
+    size_t bin = 0;
+
+    while ((timeMs > 0) && (bin < U_AT_CLIENT_COMMAND_STATS_HISTOGRAM_NUM_BINS - 1)) {
+        timeMs >>= 1;
+        bin++;
+    }
+
+    return bin;
+}
+
+// Record the end of the AT command in progress, if there is one,
+// in the AT command statistics.
+static void commandStatsEnd(uAtClientInstance_t *pClient)
+{
+    uAtClientCommandStatsContext_t *pContext = pClient->pCommandStats;
+    uAtClientCommandStats_t *pEntry;
+    int32_t nowMs;
+
+    if ((pContext != NULL) && (pContext->pCurrent != NULL)) {
+        nowMs = uPortGetTickTimeMs();
+        pEntry = pContext->pCurrent;
+        pEntry->count++;
+        if (pContext->timedOut) {
+            pEntry->numTimeouts++;
+        } else if (pClient->error != U_ERROR_COMMON_SUCCESS) {
+            pEntry->numErrors++;
+        }
+        if (pContext->firstByteTimeMs >= 0) {
+            pEntry->firstByteHistogram[commandStatsBin(pContext->firstByteTimeMs -
+                                                       pContext->startTimeMs)]++;
+        }
+        pEntry->totalHistogram[commandStatsBin(nowMs - pContext->startTimeMs)]++;
+        pContext->pCurrent = NULL;
+    }
+}
+
+// Record the start of an AT command in the AT command statistics.
+static void commandStatsBegin(uAtClientInstance_t *pClient,
+                              const char *pCommand)
+{
+    uAtClientCommandStatsContext_t *pContext = pClient->pCommandStats;
+    uAtClientCommandStats_t *pEntry = NULL;
+    size_t length = 0;
+
+    if (pContext != NULL) {
+        // Anything still in progress has ended
+        commandStatsEnd(pClient);
+        // The command is everything up to and including the
+        // first '=' or '?', so that the parameters don't count
+        while ((pCommand[length] != 0) &&
+               (length < U_AT_CLIENT_COMMAND_STATS_COMMAND_MAX_LENGTH_BYTES)) {
+            length++;
+            if ((pCommand[length - 1] == '=') || (pCommand[length - 1] == '?')) {
+                break;
+            }
+        }
+        for (size_t x = 0; (x < pContext->num) && (pEntry == NULL); x++) {
+            if ((strncmp(pContext->pEntries[x].command, pCommand, length) == 0) &&
+                (pContext->pEntries[x].command[length] == 0)) {
+                pEntry = &(pContext->pEntries[x]);
+            }
+        }
+        if ((pEntry == NULL) && (pContext->num < pContext->maxNum)) {
+            pEntry = &(pContext->pEntries[pContext->num]);
+            memset(pEntry, 0, sizeof(*pEntry));
+            memcpy(pEntry->command, pCommand, length);
+            pContext->num++;
+        }
+        if (pEntry != NULL) {
+            pContext->pCurrent = pEntry;
+            pContext->startTimeMs = uPortGetTickTimeMs();
+            pContext->firstByteTimeMs = -1;
+            pContext->timedOut = false;
+        }
+    }
+}
+
+// Append a string to a CSV buffer that is bufferLength bytes long
+// and already has length characters in it (or would have, had
+// it been long enough), returning the new length.
+static int32_t commandStatsCsvAppend(char *pBuffer, size_t bufferLength,
+                                     int32_t length, const char *pString)
+{
+    size_t stringLength = strlen(pString);
+    size_t x;
+
+    if ((pBuffer != NULL) && ((size_t) length + 1 < bufferLength)) {
+        x = bufferLength - 1 - length;
+        if (x > stringLength) {
+            x = stringLength;
+        }
+        memcpy(pBuffer + length, pString, x);
+        *(pBuffer + length + x) = 0;
+    }
+
+    return length + (int32_t) stringLength;
+}
+
+// Return true if the module at the other end of an AT client
+// is awake, i.e. if sending something now would not call the
+// wake-up handler.
+static bool isAwake(const uAtClientInstance_t *pClient)
+{
+    return (pClient->pWakeUp == NULL) ||
+           ((pClient->lastTxTimeMs >= 0) &&
+            (uPortGetTickTimeMs() - pClient->lastTxTimeMs <=
+             pClient->pWakeUp->inactivityTimeoutMs));
+}
+
+// Return how long the module has been awake since the last
+// wake-up: until the inactivity timeout after the last transmit
+// or, if that has not yet expired, until now.
+static int32_t awakeDurationMs(const uAtClientInstance_t *pClient)
+{
+    int32_t durationMs = 0;
+    int32_t endTimeMs;
+
+    if ((pClient->pWakeUp != NULL) && (pClient->awakeStartTimeMs >= 0)) {
+        endTimeMs = pClient->lastTxTimeMs + pClient->pWakeUp->inactivityTimeoutMs;
+        if (uPortGetTickTimeMs() - endTimeMs < 0) {
+            endTimeMs = uPortGetTickTimeMs();
+        }
+        durationMs = endTimeMs - pClient->awakeStartTimeMs;
+        if (durationMs < 0) {
+            durationMs = 0;
+        }
+    }
+
+    return durationMs;
+}
+
+// Start the deferred callback timer for the earliest deadline,
+// or to expire straight away if that has already passed;
+// pClient->mutex must be locked.
+static void deferredTimerSet(uAtClientInstance_t *pClient)
+{
+    uAtClientDeferredContext_t *pContext = pClient->pDeferred;
+    const uAtClientDeferred_t *pDeferred;
+    int32_t nowMs = uPortGetTickTimeMs();
+    int32_t timeToDeadlineMs = INT_MAX;
+
+    if (pContext != NULL) {
+        for (pDeferred = pContext->pList; pDeferred != NULL; pDeferred = pDeferred->pNext) {
+            if (pDeferred->deadlineTimeMs - nowMs < timeToDeadlineMs) {
+                timeToDeadlineMs = pDeferred->deadlineTimeMs - nowMs;
+            }
+        }
+        U_PORT_MUTEX_LOCK(gMutexDeferred);
+        uPortTimerStop(pContext->timer);
+        if (timeToDeadlineMs < INT_MAX) {
+            if (timeToDeadlineMs <= 0) {
+                timeToDeadlineMs = 1;
+            }
+            uPortTimerChange(pContext->timer, (uint32_t) timeToDeadlineMs);
+            uPortTimerStart(pContext->timer);
+        }
+        U_PORT_MUTEX_UNLOCK(gMutexDeferred);
+    }
+}
+
+// Run the deferred callbacks of an AT client that are due; this
+// is called from the AT callback task.
+static void deferredRun(uAtClientHandle_t atHandle, void *pParam)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    int32_t magicNumber = pClient->magicNumber;
+    uAtClientDeferredContext_t *pContext;
+    uAtClientDeferred_t **ppDeferred;
+    uAtClientDeferred_t **ppNext;
+    uAtClientDeferred_t *pDeferred;
+    int32_t nowMs;
+    int32_t latencyMs;
+
+    (void) pParam;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    pContext = pClient->pDeferred;
+    if (pContext != NULL) {
+        pContext->runQueued = false;
+        // Mark everything that is due now; the callbacks stay
+        // on the list until they are run so that
+        // uAtClientDeferredRemove() can still find them
+        nowMs = uPortGetTickTimeMs();
+        for (pDeferred = pContext->pList; pDeferred != NULL; pDeferred = pDeferred->pNext) {
+            if (nowMs - pDeferred->notBeforeTimeMs >= 0) {
+                pDeferred->due = true;
+            }
+        }
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    // Run them all, one after the other, so that the first
+    // one wakes the module up (if required) and the rest find
+    // it awake; the AT client mutex must not be locked while
+    // doing this since the callbacks will do AT things
+    do {
+        pDeferred = NULL;
+        // Stop if the AT client has been removed in the meantime
+        if (processAsync(magicNumber)) {
+            U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+            pContext = pClient->pDeferred;
+            if (pContext != NULL) {
+                // Take the most urgent of those that are due, and
+                // otherwise the first added, off the list
+                ppNext = NULL;
+                for (ppDeferred = &(pContext->pList); *ppDeferred != NULL;
+                     ppDeferred = &((*ppDeferred)->pNext)) {
+                    if ((*ppDeferred)->due &&
+                        ((ppNext == NULL) ||
+                         ((*ppDeferred)->deadlineTimeMs - (*ppNext)->deadlineTimeMs < 0))) {
+                        ppNext = ppDeferred;
+                    }
+                }
+                if (ppNext != NULL) {
+                    pDeferred = *ppNext;
+                    *ppNext = pDeferred->pNext;
+                    pContext->pRunning = pDeferred;
+                    nowMs = uPortGetTickTimeMs();
+                    latencyMs = nowMs - pDeferred->notBeforeTimeMs;
+                    pClient->wakeUpStats.numDeferred++;
+                    if (nowMs - pDeferred->deadlineTimeMs > 0) {
+                        pClient->wakeUpStats.numDeferredLate++;
+                    }
+                    pClient->wakeUpStats.deferredLatencyTotalMs += latencyMs;
+                    if (latencyMs > pClient->wakeUpStats.deferredLatencyMaxMs) {
+                        pClient->wakeUpStats.deferredLatencyMaxMs = latencyMs;
+                    }
+                }
+            }
+            U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+        }
+        if (pDeferred != NULL) {
+            pDeferred->pCallback(atHandle, pDeferred->pParam);
+            if (processAsync(magicNumber)) {
+                U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+                if (pClient->pDeferred != NULL) {
+                    pClient->pDeferred->pRunning = NULL;
+                }
+                U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+            }
+            uPortFree(pDeferred);
+        }
+    } while (pDeferred != NULL);
+
+    if (processAsync(magicNumber)) {
+        // Set the timer for whatever is left, including
+        // anything the callbacks may have added
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+        deferredTimerSet(pClient);
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+    }
+}
+
+// Queue deferredRun() for an AT client, if it is not already
+// queued; pClient->mutex must be locked.
+static void deferredRunQueue(uAtClientInstance_t *pClient)
+{
+    if (!pClient->pDeferred->runQueued &&
+        (uAtClientCallback((uAtClientHandle_t) pClient, deferredRun, NULL) == 0)) {
+        pClient->pDeferred->runQueued = true;
+    }
+}
+
+// Queue deferredRun() if the module is awake anyway and there
+// are deferred callbacks that are due; pClient->mutex must
+// be locked.
+static void deferredKick(uAtClientInstance_t *pClient)
+{
+    const uAtClientDeferred_t *pDeferred;
+    int32_t nowMs;
+
+    if ((pClient->pDeferred != NULL) && !pClient->pDeferred->runQueued &&
+        isAwake(pClient)) {
+        nowMs = uPortGetTickTimeMs();
+        for (pDeferred = pClient->pDeferred->pList;
+             (pDeferred != NULL) && !pClient->pDeferred->runQueued;
+             pDeferred = pDeferred->pNext) {
+            if (nowMs - pDeferred->notBeforeTimeMs >= 0) {
+                deferredRunQueue(pClient);
+            }
+        }
+    }
+}
+
+// Callback for the deferred callback timer of an AT client: the
+// parameter is the magic number of the AT client rather than a
+// pointer to it since the AT client may have been removed by the
+// time the timer task gets here.  Neither gMutex nor the AT client
+// mutex is locked here, since either may be held for as long as an
+// AT timeout, and deferredRun() is queued without waiting: if that
+// is not possible right now the timer is restarted to try again
+// shortly.  Any duplicate deferredRun() will find nothing to do.
+static void deferredTimerCallback(const uPortTimerHandle_t timerHandle,
+                                  void *pParam)
+{
+    int32_t magicNumber = (int32_t) (intptr_t) pParam;
+    uAtClientInstance_t *pClient = NULL;
+
+    if (gMutexDeferred != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutexDeferred);
+
+        for (size_t x = 0; (pClient == NULL) &&
+             (x < sizeof(gpDeferredClient) / sizeof(gpDeferredClient[0])); x++) {
+            if ((gpDeferredClient[x] != NULL) &&
+                (gpDeferredClient[x]->magicNumber == magicNumber)) {
+                pClient = gpDeferredClient[x];
+            }
+        }
+        // Holding gMutexDeferred means that the timer cannot
+        // be deleted under our feet
+        if ((pClient != NULL) &&
+            (uAtClientCallbackNoWait((uAtClientHandle_t) pClient, deferredRun, NULL) != 0)) {
+            uPortTimerChange(timerHandle, U_AT_CLIENT_DEFERRED_RETRY_MS);
+            uPortTimerStart(timerHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutexDeferred);
+    }
+}
+
 // Increment the number of consecutive timeouts
 // and call the callback if there is one
 static void consecutiveTimeout(uAtClientInstance_t *pClient)
 {
     uAtClientCallback_t cb = {0}; // Keep Valgrind happy (otherwise the last four bytes will be uninitialised)
 
-    U_PORT_MUTEX_LOCK(gMutexEventQueue);
-
     pClient->numConsecutiveAtTimeouts++;
+    if ((pClient->pCommandStats != NULL) &&
+        (pClient->pCommandStats->pCurrent != NULL)) {
+        pClient->pCommandStats->timedOut = true;
+    }
     if (pClient->pConsecutiveTimeoutsCallback != NULL) {
         // pConsecutiveTimeoutsCallback second parameter
         // is an int32_t pointer but of course the generic
@@ -1238,10 +1793,8 @@ static void consecutiveTimeout(uAtClientInstance_t *pClient)
         cb.atHandle = (uAtClientHandle_t) pClient;
         cb.pParam = &(pClient->numConsecutiveAtTimeouts);
         cb.atClientMagicNumber = pClient->magicNumber;
-        uPortEventQueueSend(gEventQueueHandle, &cb, sizeof(cb));
+        callbackSend(pClient, U_AT_CLIENT_CALLBACK_PRIORITY_NORMAL, &cb);
     }
-
-    U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
 }
 
 // Calculate the remaining time for polling based on the start
@@ -1679,6 +2232,11 @@ static bool bufferFill(uAtClientInstance_t *pClient,
 
     LOG_BUFFER_FILL(15);
     if (readLength > 0) {
+        if ((pClient->pCommandStats != NULL) &&
+            (pClient->pCommandStats->pCurrent != NULL) &&
+            (pClient->pCommandStats->firstByteTimeMs < 0)) {
+            pClient->pCommandStats->firstByteTimeMs = uPortGetTickTimeMs();
+        }
         printAt(pClient, U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
                 pReceiveBuffer->length + pReceiveBuffer->readIndex,
                 readLength, false);
@@ -1740,6 +2298,49 @@ static int32_t bufferReadChar(uAtClientInstance_t *pClient)
     return character;
 }
 
+// Read a run of characters from the receive buffer, without
+// bringing more data into it, stopping at maxLength characters
+// or before any of the numCharacters characters at pCharacters
+// (e.g. a delimiter, a quote or the start of a stop tag), whichever
+// comes first; this lets whole runs of "uninteresting" characters
+// be copied out in one go rather than a character at a time.
+// The characters are copied to pBuffer, if it is not NULL, and
+// consumed.  Returns the number of characters read.
+static size_t bufferReadRun(const uAtClientInstance_t *pClient,
+                            char *pBuffer, size_t maxLength,
+                            const char *pCharacters,
+                            size_t numCharacters)
+{
+    uAtClientReceiveBuffer_t *pReceiveBuffer = pClient->pReceiveBuffer;
+    const char *pStart = U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
+                         pReceiveBuffer->readIndex;
+    const char *pFound;
+    size_t length = 0;
+
+    if (pReceiveBuffer->readIndex < pReceiveBuffer->length) {
+        length = pReceiveBuffer->length - pReceiveBuffer->readIndex;
+    }
+    if (length > maxLength) {
+        length = maxLength;
+    }
+    // Each search need only cover what is left
+    // before the nearest character found so far
+    for (size_t x = 0; (x < numCharacters) && (length > 0); x++) {
+        pFound = (const char *) memchr(pStart, *(pCharacters + x), length);
+        if (pFound != NULL) {
+            length = pFound - pStart;
+        }
+    }
+    if (length > 0) {
+        if (pBuffer != NULL) {
+            memcpy(pBuffer, pStart, length);
+        }
+        pReceiveBuffer->readIndex += length;
+    }
+
+    return length;
+}
+
 // Look for pString at the start of the current receive buffer
 // without bringing more data into it, and if the string
 // is there consume it.
@@ -1954,54 +2555,85 @@ static int32_t readString(uAtClientInstance_t *pClient,
     bool delimiterFound = false;
     bool inQuotes = false;
     int32_t c;
+    char characters[3];
+    size_t numCharacters;
+    size_t maxLength;
+    size_t runLength = 0;
 
     while (((lengthBytes == 0) || (lengthRead < ((int32_t) lengthBytes - 1) + matchPos)) &&
            (pClient->error == U_ERROR_COMMON_SUCCESS) &&
            !delimiterFound &&
            (ignoreStopTag || !pStopTag->found)) {
-        c = bufferReadChar(pClient);
-        if (c == -1) {
-            // Error
-            setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
-        } else if (!inQuotes && (c == pClient->delimiter)) {
-            // Reached delimiter
-            delimiterFound = true;
-        } else if (c == '\"') {
-            // Switch into or out of quotes
-            matchPos = 0;
-            inQuotes = !inQuotes;
-        } else {
-            if (!inQuotes && !ignoreStopTag &&
-                (pStopTag->pTagDef->length > 0)) {
-                // It could be a stop tag
-                if (c == *(pStopTag->pTagDef->pString + matchPos)) {
-                    matchPos++;
-                } else {
-                    // If it wasn't a stop tag, reset
-                    // the match position and check again
-                    // in case it is the start of a new stop tag
-                    matchPos = 0;
-                    if (c == *(pStopTag->pTagDef->pString)) {
+        if (matchPos == 0) {
+            // Not part-way through a stop tag: copy out any run
+            // of characters that contains nothing which the
+            // character-by-character processing below would
+            // need to act upon
+            characters[0] = '\"';
+            numCharacters = 1;
+            if (!inQuotes) {
+                characters[numCharacters] = pClient->delimiter;
+                numCharacters++;
+                if (!ignoreStopTag && (pStopTag->pTagDef->length > 0)) {
+                    characters[numCharacters] = *(pStopTag->pTagDef->pString);
+                    numCharacters++;
+                }
+            }
+            maxLength = SIZE_MAX;
+            if (lengthBytes > 0) {
+                maxLength = lengthBytes - 1 - lengthRead;
+            }
+            runLength = bufferReadRun(pClient,
+                                      (pString != NULL) ? pString + lengthRead : NULL,
+                                      maxLength, characters, numCharacters);
+            lengthRead += (int32_t) runLength;
+        }
+        if (runLength == 0) {
+            c = bufferReadChar(pClient);
+            if (c == -1) {
+                // Error
+                setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
+            } else if (!inQuotes && (c == pClient->delimiter)) {
+                // Reached delimiter
+                delimiterFound = true;
+            } else if (c == '\"') {
+                // Switch into or out of quotes
+                matchPos = 0;
+                inQuotes = !inQuotes;
+            } else {
+                if (!inQuotes && !ignoreStopTag &&
+                    (pStopTag->pTagDef->length > 0)) {
+                    // It could be a stop tag
+                    if (c == *(pStopTag->pTagDef->pString + matchPos)) {
                         matchPos++;
+                    } else {
+                        // If it wasn't a stop tag, reset
+                        // the match position and check again
+                        // in case it is the start of a new stop tag
+                        matchPos = 0;
+                        if (c == *(pStopTag->pTagDef->pString)) {
+                            matchPos++;
+                        }
                     }
+                    if (matchPos == (int32_t) pStopTag->pTagDef->length) {
+                        pStopTag->found = true;
+                        // Remove tag from string if it was matched
+                        lengthRead -= (int32_t) pStopTag->pTagDef->length - 1;
+                    }
+                } else {
+                    // Not anything
+                    matchPos = 0;
                 }
-                if (matchPos == (int32_t) pStopTag->pTagDef->length) {
-                    pStopTag->found = true;
-                    // Remove tag from string if it was matched
-                    lengthRead -= (int32_t) pStopTag->pTagDef->length - 1;
-                }
-            } else {
-                // Not anything
-                matchPos = 0;
-            }
-            if (!pStopTag->found) {
-                if (pString != NULL) {
-                    // Add the character to the string
-                    *(pString + lengthRead) = (char) c;
+                if (!pStopTag->found) {
+                    if (pString != NULL) {
+                        // Add the character to the string
+                        *(pString + lengthRead) = (char) c;
+                    }
+                    lengthRead++;
                 }
-                lengthRead++;
             }
         }
+        runLength = 0;
     }
 
     if ((pClient->error == U_ERROR_COMMON_SUCCESS) &&
@@ -2048,40 +2680,233 @@ static int32_t readString(uAtClientInstance_t *pClient,
     return lengthRead;
 }
 
-// Read an integer.
+// Read a string parameter as a view into the receive buffer,
+// i.e. without copying it anywhere.  The buffer is only
+// rewound if it becomes full while the end of the parameter
+// is being looked for, and then the indexes into the
+// parameter are moved down with it, so nothing under the
+// view moves once it has been returned.  If the end of the
+// parameter cannot be found even in a rewound buffer then
+// nothing is consumed and U_ERROR_COMMON_NO_MEMORY is
+// returned.
 // The mutex should be locked before this is called.
-static int32_t readInt(uAtClientInstance_t *pClient)
-{
-    char buffer[32]; // Enough for an integer
-    int32_t integerRead = -1;
-
-    if ((pClient->error == U_ERROR_COMMON_SUCCESS) &&
-        !pClient->stopTag.found &&
-        (readString(pClient, buffer,
-                    sizeof(buffer), false) > 0)) {
-        integerRead = strtol(buffer, NULL, 10);
-    }
-
-    return integerRead;
-}
-
-// Record an error sent from the AT server, i.e. ERROR
-// or CMS ERROR or CME ERROR.
-static void setDeviceError(uAtClientInstance_t *pClient,
-                           uAtClientDeviceErrorType_t errorType)
+static int32_t readStringView(uAtClientInstance_t *pClient,
+                              uAtClientView_t *pView,
+                              bool ignoreStopTag)
 {
-    int32_t errorCode;
+    uAtClientReceiveBuffer_t *pReceiveBuffer = pClient->pReceiveBuffer;
+    uAtClientTag_t *pStopTag = &(pClient->stopTag);
+    const uAtClientTagDef_t *pTagDef = NULL;
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_SUCCESS;
+    size_t readIndex;
+    size_t startIndex;
+    size_t endIndex = 0;
+    size_t matchPos = 0;
+    size_t shift;
+    bool quoted = false;
+    bool inQuotes = false;
+    bool endFound = false;
+    bool finished = false;
+    char c;
 #if U_CFG_ENABLE_LOGGING
     char timestampBuffer[U_AT_CLIENT_PRINT_TIMESTAMP_BUFFER_SIZE_BYTES];
 #endif
 
-    pClient->deviceError.type = errorType;
-    pClient->deviceError.code = 0;
-
-    if ((errorType == U_AT_CLIENT_DEVICE_ERROR_TYPE_CMS) ||
-        (errorType == U_AT_CLIENT_DEVICE_ERROR_TYPE_CME)) {
+    pView->pData = NULL;
+    pView->length = 0;
 
-        setScope(pClient, U_AT_CLIENT_SCOPE_INFORMATION);
+    if (pClient->error != U_ERROR_COMMON_SUCCESS) {
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    } else if (ignoreStopTag || !pStopTag->found) {
+        if (!ignoreStopTag && (pStopTag->pTagDef->length > 0)) {
+            pTagDef = pStopTag->pTagDef;
+        }
+        readIndex = pReceiveBuffer->readIndex;
+        startIndex = readIndex;
+        while (!finished) {
+            if (pReceiveBuffer->readIndex >= pReceiveBuffer->length) {
+                // Need more; only bring it in if there is room
+                // as otherwise bufferFill() would reset the buffer
+                if ((pReceiveBuffer->lengthBuffered >= pReceiveBuffer->dataBufferSize) &&
+                    (readIndex > 0)) {
+                    // Make room by rewinding to the start of
+                    // this parameter and shift our indexes to match
+                    shift = readIndex;
+                    readIndex = pReceiveBuffer->readIndex - shift;
+                    pReceiveBuffer->readIndex = shift;
+                    bufferRewind(pClient);
+                    pReceiveBuffer->readIndex = readIndex;
+                    readIndex = 0;
+                    startIndex -= shift;
+                    if (endFound) {
+                        endIndex -= shift;
+                    }
+                } else if (pReceiveBuffer->lengthBuffered >= pReceiveBuffer->dataBufferSize) {
+                    errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    finished = true;
+                } else if (bufferFill(pClient, true)) {
+                    pClient->numConsecutiveAtTimeouts = 0;
+                } else {
+                    // Timeout
+                    if (pClient->debugOn) {
+                        uPortLog("U_AT_CLIENT_%d-%d%s: timeout.\n",
+                                 pClient->stream.type, U_AT_CLIENT_HANDLE_FOR_PRINT(pClient),
+                                 pPrintTimestamp(" ", NULL, timestampBuffer, sizeof(timestampBuffer)));
+                    }
+                    setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
+                    consecutiveTimeout(pClient);
+                    errorCodeOrLength = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                    finished = true;
+                }
+            } else {
+                c = *(U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) + pReceiveBuffer->readIndex);
+                pReceiveBuffer->readIndex++;
+                if ((c == '\"') && (pReceiveBuffer->readIndex == startIndex + 1)) {
+                    // A leading quote: the view starts after it
+                    quoted = true;
+                    inQuotes = true;
+                    startIndex = pReceiveBuffer->readIndex;
+                } else if (inQuotes) {
+                    if (c == '\"') {
+                        inQuotes = false;
+                        if (quoted && !endFound) {
+                            // The closing quote ends a quoted parameter,
+                            // anything after it is just consumed
+                            endIndex = pReceiveBuffer->readIndex - 1;
+                            endFound = true;
+                        }
+                    }
+                } else if (c == pClient->delimiter) {
+                    if (!endFound) {
+                        endIndex = pReceiveBuffer->readIndex - 1;
+                        endFound = true;
+                    }
+                    finished = true;
+                } else if (c == '\"') {
+                    inQuotes = true;
+                    matchPos = 0;
+                } else if (pTagDef != NULL) {
+                    // It could be a stop tag
+                    if (c == *(pTagDef->pString + matchPos)) {
+                        matchPos++;
+                    } else {
+                        matchPos = 0;
+                        if (c == *(pTagDef->pString)) {
+                            matchPos++;
+                        }
+                    }
+                    if (matchPos == pTagDef->length) {
+                        pStopTag->found = true;
+                        if (!endFound) {
+                            endIndex = pReceiveBuffer->readIndex - pTagDef->length;
+                            endFound = true;
+                        }
+                        finished = true;
+                    }
+                }
+            }
+        }
+        if (errorCodeOrLength == (int32_t) U_ERROR_COMMON_NO_MEMORY) {
+            // Put everything back for a copying read
+            pReceiveBuffer->readIndex = readIndex;
+        } else if (errorCodeOrLength == 0) {
+            pView->pData = U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) + startIndex;
+            pView->length = endIndex - startIndex;
+            errorCodeOrLength = (int32_t) pView->length;
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Parse a decimal integer, with optional leading sign, from
+// the start of the given characters, clamping it to the range
+// of an int32_t.  Returns the number of characters used,
+// zero if there is no integer there.
+static size_t parseInt(const char *pData, size_t length,
+                       int32_t *pInt)
+{
+    size_t x = 0;
+    size_t numDigits = 0;
+    bool negative = false;
+    int64_t value = 0;
+
+    if ((length > 0) && ((*pData == '-') || (*pData == '+'))) {
+        negative = (*pData == '-');
+        x++;
+    }
+    for (; (x < length) && (*(pData + x) >= '0') && (*(pData + x) <= '9'); x++) {
+        if (value <= INT32_MAX) {
+            value = (value * 10) + (*(pData + x) - '0');
+        }
+        numDigits++;
+    }
+    if (negative) {
+        value = -value;
+    }
+    if (value > INT32_MAX) {
+        value = INT32_MAX;
+    } else if (value < INT32_MIN) {
+        value = INT32_MIN;
+    }
+    *pInt = (int32_t) value;
+
+    if (numDigits == 0) {
+        x = 0;
+    }
+
+    return x;
+}
+
+// Read an integer.
+// The mutex should be locked before this is called.
+static int32_t readInt(uAtClientInstance_t *pClient)
+{
+    char buffer[32]; // Enough for an integer
+    int32_t integerRead = -1;
+    uAtClientView_t view;
+    int32_t length;
+
+    if ((pClient->error == U_ERROR_COMMON_SUCCESS) &&
+        !pClient->stopTag.found) {
+        length = readStringView(pClient, &view, false);
+        if (length > 0) {
+            // Behave as strtol() would: skip leading
+            // white space and ignore anything after
+            // the number
+            while ((view.length > 0) && isspace((unsigned char) *view.pData)) {
+                view.pData++;
+                view.length--;
+            }
+            integerRead = 0;
+            parseInt(view.pData, view.length, &integerRead);
+        } else if ((length == (int32_t) U_ERROR_COMMON_NO_MEMORY) &&
+                   (readString(pClient, buffer,
+                               sizeof(buffer), false) > 0)) {
+            integerRead = strtol(buffer, NULL, 10);
+        }
+    }
+
+    return integerRead;
+}
+
+// Record an error sent from the AT server, i.e. ERROR
+// or CMS ERROR or CME ERROR.
+static void setDeviceError(uAtClientInstance_t *pClient,
+                           uAtClientDeviceErrorType_t errorType)
+{
+    int32_t errorCode;
+#if U_CFG_ENABLE_LOGGING
+    char timestampBuffer[U_AT_CLIENT_PRINT_TIMESTAMP_BUFFER_SIZE_BYTES];
+#endif
+
+    pClient->deviceError.type = errorType;
+    pClient->deviceError.code = 0;
+
+    if ((errorType == U_AT_CLIENT_DEVICE_ERROR_TYPE_CMS) ||
+        (errorType == U_AT_CLIENT_DEVICE_ERROR_TYPE_CME)) {
+
+        setScope(pClient, U_AT_CLIENT_SCOPE_INFORMATION);
         errorCode = readInt(pClient);
 
         if (errorCode >= 0) {
@@ -2209,7 +3034,8 @@ static bool processResponse(uAtClientInstance_t *pClient,
     return prefixMatched;
 }
 
-// Write data to the stream.
+// Call the wake-up handler, if there is one and if the
+// inactivity timeout has expired.
 //
 // Design note concerning the wake-up handler
 // process below; first the needs:
@@ -2233,9 +3059,94 @@ static bool processResponse(uAtClientInstance_t *pClient,
 // not match then it _also_ blocks on inWakeUpHandlerMutex
 // before proceeding, hence holding off processing until
 // the wake-up process has completed.
-static size_t write(uAtClientInstance_t *pClient,
-                    const char *pData, size_t length,
-                    bool andFlush)
+static void wakeUpIfRequired(uAtClientInstance_t *pClient)
+{
+    int32_t savedLockTimeMs;
+    int32_t wakeUpDurationMs = 0;
+    uAtClientScope_t savedScope;
+    uAtClientTag_t savedStopTag;
+    bool savedDelimiterRequired;
+    uAtClientDeviceError_t savedDeviceError;
+
+    if ((pClient->pWakeUp != NULL) && (pClient->lastTxTimeMs >= 0) &&
+        (uPortGetTickTimeMs() - pClient->lastTxTimeMs > pClient->pWakeUp->inactivityTimeoutMs) &&
+        (uPortMutexTryLock(pClient->pWakeUp->inWakeUpHandlerMutex, 0) == 0)) {
+        // We have a wake-up handler, the inactivity timeout
+        // has expired and we've managed to lock the wake-up
+        // handler mutex (if we aren't able to lock the wake-up
+        // handler mutex  then we must already be in the wake-up
+        // handler, having recursed, so can just continue); now
+        // we need to call the wake-up handler function.
+        // Set wakeUpTask to the current task handle so
+        // that any future calls can be locked against the
+        // separate pWakeUp->mutex if they come from the task
+        // we're in at the moment, the one dealing with the wake-up
+        uPortTaskGetHandle(&(pClient->pWakeUp->wakeUpTask));
+        // The pClient->mutex will have been locked on the way
+        // into here by U_AT_CLIENT_LOCK_CLIENT_MUTEX.
+        // Remember the lock time and measure how long
+        // waking-up takes in order to correct for it
+        savedLockTimeMs = pClient->lockTimeMs;
+        wakeUpDurationMs = uPortGetTickTimeMs();
+        // For the statistics, the previous awake period
+        // has ended and a new one is starting
+        pClient->wakeUpStats.awakeTotalMs += awakeDurationMs(pClient);
+        pClient->awakeStartTimeMs = wakeUpDurationMs;
+        pClient->wakeUpStats.numWakeUps++;
+        // Remember the dynamic things that the
+        // wake-up handler might overwrite
+        savedScope = pClient->scope;
+        savedStopTag = pClient->stopTag;
+        savedDelimiterRequired = pClient->delimiterRequired;
+        savedDeviceError = pClient->deviceError;
+        // Reset the scope, stopTag and delimiterRequired
+        pClient->scope = U_AT_CLIENT_SCOPE_NONE;
+        pClient->stopTag.pTagDef = &gNoStopTag;
+        pClient->stopTag.found = false;
+        pClient->delimiterRequired = false;
+        // Now actually call the wake-up callback which may recurse
+        // back into here
+        if (pClient->pWakeUp->pHandler((uAtClientHandle_t) pClient,
+                                       pClient->pWakeUp->pParam) != 0) {
+            setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
+            pClient->wakeUpStats.numWakeUpFailures++;
+        }
+        // At this point all of the calls back into here
+        // performed as part of the wake-up process will have
+        // been completed; there may have been calls from other
+        // tasks but they will have been blocked on the normal
+        // mutex before reaching here.
+        // We can now set the wakeUpTask back to NULL and all
+        // blocking will be on the normal mutex again
+        pClient->pWakeUp->wakeUpTask = NULL;
+        // Put all the saved things back
+        pClient->scope = savedScope;
+        pClient->stopTag = savedStopTag;
+        pClient->delimiterRequired = savedDelimiterRequired;
+        pClient->deviceError = savedDeviceError;
+        // Set the adjusted lock time, allowing for potential
+        // wrap in uPortGetTickTimeMs()
+        wakeUpDurationMs = uPortGetTickTimeMs() - wakeUpDurationMs;
+        if (wakeUpDurationMs > 0) {
+            pClient->lockTimeMs = savedLockTimeMs + wakeUpDurationMs;
+            pClient->wakeUpStats.wakeUpDurationTotalMs += wakeUpDurationMs;
+            if (wakeUpDurationMs > pClient->wakeUpStats.wakeUpDurationMaxMs) {
+                pClient->wakeUpStats.wakeUpDurationMaxMs = wakeUpDurationMs;
+            }
+        } else {
+            pClient->lockTimeMs = uPortGetTickTimeMs();
+        }
+        // We are no longer in the wake-up handler
+        uPortMutexUnlock(pClient->pWakeUp->inWakeUpHandlerMutex);
+    }
+}
+
+// Write data directly to the stream (or to the intercept
+// function, if there is one), bypassing the transmit
+// assembly buffer.
+static size_t writeStream(uAtClientInstance_t *pClient,
+                          const char *pData, size_t length,
+                          bool andFlush)
 {
     int32_t thisLengthWritten = 0;
     size_t lengthToWrite;
@@ -2249,79 +3160,11 @@ static size_t write(uAtClientInstance_t *pClient,
     // the ORing with andFlush below is confusing it?
     // codechecker_suppress [cppcheck-pointerOutOfBoundsCond] "pDataStart + length is not out of bounds"
     const char *pDataEnd = pDataStart + length;
-    int32_t savedLockTimeMs;
-    int32_t wakeUpDurationMs = 0;
-    uAtClientScope_t savedScope;
-    uAtClientTag_t savedStopTag;
-    bool savedDelimiterRequired;
-    uAtClientDeviceError_t savedDeviceError;
     uDeviceSerial_t *pDeviceSerial;
 
     while (((pData < pDataEnd) || andFlush) &&
            (pClient->error == U_ERROR_COMMON_SUCCESS)) {
         lengthToWrite = length - (pData - pDataStart);
-        if ((pClient->pWakeUp != NULL) && (pClient->lastTxTimeMs >= 0) &&
-            (uPortGetTickTimeMs() - pClient->lastTxTimeMs > pClient->pWakeUp->inactivityTimeoutMs) &&
-            (uPortMutexTryLock(pClient->pWakeUp->inWakeUpHandlerMutex, 0) == 0)) {
-            // We have a wake-up handler, the inactivity timeout
-            // has expired and we've managed to lock the wake-up
-            // handler mutex (if we aren't able to lock the wake-up
-            // handler mutex  then we must already be in the wake-up
-            // handler, having recursed, so can just continue); now
-            // we need to call the wake-up handler function.
-            // Set wakeUpTask to the current task handle so
-            // that any future calls can be locked against the
-            // separate pWakeUp->mutex if they come from the task
-            // we're in at the moment, the one dealing with the wake-up
-            uPortTaskGetHandle(&(pClient->pWakeUp->wakeUpTask));
-            // The pClient->mutex will have been locked on the way
-            // into here by U_AT_CLIENT_LOCK_CLIENT_MUTEX.
-            // Remember the lock time and measure how long
-            // waking-up takes in order to correct for it
-            savedLockTimeMs = pClient->lockTimeMs;
-            wakeUpDurationMs = uPortGetTickTimeMs();
-            // Remember the dynamic things that the
-            // wake-up handler might overwrite
-            savedScope = pClient->scope;
-            savedStopTag = pClient->stopTag;
-            savedDelimiterRequired = pClient->delimiterRequired;
-            savedDeviceError = pClient->deviceError;
-            // Reset the scope, stopTag and delimiterRequired
-            pClient->scope = U_AT_CLIENT_SCOPE_NONE;
-            pClient->stopTag.pTagDef = &gNoStopTag;
-            pClient->stopTag.found = false;
-            pClient->delimiterRequired = false;
-            // Now actually call the wake-up callback which may recurse
-            // back into here
-            if (pClient->pWakeUp->pHandler((uAtClientHandle_t) pClient,
-                                           pClient->pWakeUp->pParam) != 0) {
-                setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
-            }
-            // At this point all of the calls back into here
-            // performed as part of the wake-up process will have
-            // been completed; there may have been calls from other
-            // tasks but they will have been blocked on the normal
-            // mutex before reaching here.
-            // We can now set the wakeUpTask back to NULL and all
-            // blocking will be on the normal mutex again
-            pClient->pWakeUp->wakeUpTask = NULL;
-            // Put all the saved things back
-            pClient->scope = savedScope;
-            pClient->stopTag = savedStopTag;
-            pClient->delimiterRequired = savedDelimiterRequired;
-            pClient->deviceError = savedDeviceError;
-            // Set the adjusted lock time, allowing for potential
-            // wrap in uPortGetTickTimeMs()
-            wakeUpDurationMs = uPortGetTickTimeMs() - wakeUpDurationMs;
-            if (wakeUpDurationMs > 0) {
-                pClient->lockTimeMs = savedLockTimeMs + wakeUpDurationMs;
-            } else {
-                pClient->lockTimeMs = uPortGetTickTimeMs();
-            }
-            // We are no longer in the wake-up handler
-            uPortMutexUnlock(pClient->pWakeUp->inWakeUpHandlerMutex);
-        }
-
         if (pClient->error == U_ERROR_COMMON_SUCCESS) {
             if (pClient->pInterceptTx != NULL) {
                 if (pData < pDataEnd) {
@@ -2391,6 +3234,63 @@ static size_t write(uAtClientInstance_t *pClient,
     return length;
 }
 
+// Send anything in the transmit assembly buffer to the stream,
+// flushing any intercept function also if andFlush is true.
+static void txBufferFlush(uAtClientInstance_t *pClient, bool andFlush)
+{
+    if ((pClient->txBufferLength > 0) || andFlush) {
+        writeStream(pClient, pClient->pTxBuffer,
+                    pClient->txBufferLength, andFlush);
+    }
+    pClient->txBufferLength = 0;
+}
+
+// Write data to the stream, via the transmit assembly
+// buffer if there is one; if andFlush is true the
+// buffer will be sent to the stream after the data
+// has been added to it.  Data that does not fit in the
+// transmit assembly buffer, even when it is empty, is
+// written directly to the stream.  Returns the number
+// of bytes written (or buffered), zero on error.
+static size_t write(uAtClientInstance_t *pClient,
+                    const char *pData, size_t length,
+                    bool andFlush)
+{
+    if (pClient->error == U_ERROR_COMMON_SUCCESS) {
+        if (pClient->txBufferLength == 0) {
+            // Only need to check for wake-up at the start
+            // of what is to be sent: anything that is already
+            // in the transmit buffer will have been preceded
+            // by a wake-up check
+            wakeUpIfRequired(pClient);
+        }
+        if ((pClient->pTxBuffer != NULL) && pClient->txBufferOn) {
+            if (pClient->txBufferLength + length > U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES) {
+                // Won't fit, send what we have to make room
+                txBufferFlush(pClient, false);
+            }
+            if (length <= U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES) {
+                memcpy(pClient->pTxBuffer + pClient->txBufferLength, pData, length);
+                pClient->txBufferLength += length;
+                if (andFlush) {
+                    txBufferFlush(pClient, true);
+                }
+            } else {
+                // Too big for the buffer, bypass it
+                writeStream(pClient, pData, length, andFlush);
+            }
+        } else {
+            writeStream(pClient, pData, length, andFlush);
+        }
+    }
+
+    if (pClient->error != U_ERROR_COMMON_SUCCESS) {
+        length = 0;
+    }
+
+    return length;
+}
+
 // Do common checks before sending parameters
 // and also deal with the need for a delimiter.
 static bool writeCheckAndDelimit(uAtClientInstance_t *pClient)
@@ -2602,6 +3502,7 @@ static void urcCallback(const uAtClientStreamHandle_t *pStream,
     uPortMutexHandle_t streamMutex;
     int32_t sizeOrError;
     int32_t x;
+    const uAtClientCallbackExecutor_t *pExecutor;
 #if U_CFG_ENABLE_LOGGING
     char timestampBuffer[U_AT_CLIENT_PRINT_TIMESTAMP_BUFFER_SIZE_BYTES];
 #endif
@@ -2692,12 +3593,17 @@ static void urcCallback(const uAtClientStreamHandle_t *pStream,
                         // sure that's safe
                         unlockNoDataCheck(pClient, streamMutex);
 
-                        x = uPortEventQueueGetFree(gEventQueueHandle);
-                        if ((x >= 0) && (x < U_AT_CLIENT_CALLBACK_QUEUE_FREE_THRESHOLD)) {
-                            // If the AT client callback queue is getting full, give the
-                            // task at the end of it time to execute or we may fill up
-                            // the queue and get stuck
-                            uPortTaskBlock(U_AT_CLIENT_CALLBACK_QUEUE_YIELD_MS);
+                        for (size_t y = 0; y < U_AT_CLIENT_CALLBACK_PRIORITY_MAX_NUM; y++) {
+                            pExecutor = pCallbackExecutorGet(pClient, (uAtClientCallbackPriority_t) y);
+                            x = uPortEventQueueGetFree(pExecutor->eventQueueHandle);
+                            if ((x >= 0) && (x < U_AT_CLIENT_CALLBACK_QUEUE_FREE_THRESHOLD) &&
+                                (x < (int32_t) pExecutor->queueLength)) {
+                                // If an AT client callback queue that this AT client
+                                // uses is getting full, give the task at the end of it
+                                // time to execute or we may fill up the queue and get stuck
+                                uPortTaskBlock(U_AT_CLIENT_CALLBACK_QUEUE_YIELD_MS);
+                                break;
+                            }
                         }
                     }
                 }
@@ -2752,12 +3658,42 @@ static void urcCallbackDeviceSerial(uDeviceSerial_t *pDeviceSerial, uint32_t eve
 static void eventQueueCallback(void *pParameters, size_t paramLength)
 {
     uAtClientCallback_t *pCb = (uAtClientCallback_t *) pParameters;
+    uAtClientCallbackExecutor_t *pExecutor;
+    bool doCallback;
+    int32_t durationMs;
 
     (void) paramLength;
 
-    if ((pCb != NULL) && (pCb->pFunction != NULL) &&
-        processAsync(pCb->atClientMagicNumber)) {
-        pCb->pFunction(pCb->atHandle, pCb->pParam);
+    if ((pCb != NULL) && (pCb->pFunction != NULL)) {
+        pExecutor = pCb->pExecutor;
+        doCallback = processAsync(pCb->atClientMagicNumber);
+        // An AT client's own executor is gone if the AT
+        // client is gone but the shared one always exists
+        if ((pExecutor != NULL) && (doCallback || (pExecutor == &gCallbackExecutor))) {
+            // The queue can only have grown since the last
+            // callback was received, so the number outstanding
+            // now, including this one, is its high water mark
+            if (pExecutor->numSent - pExecutor->numReceived > pExecutor->queueHighWaterMark) {
+                pExecutor->queueHighWaterMark = pExecutor->numSent - pExecutor->numReceived;
+            }
+            pExecutor->numReceived++;
+        }
+        if (doCallback) {
+            durationMs = uPortGetTickTimeMs();
+            pCb->pFunction(pCb->atHandle, pCb->pParam);
+            durationMs = uPortGetTickTimeMs() - durationMs;
+            // Check again in case the AT client, and hence
+            // its executor, was removed during the callback
+            if ((pExecutor != NULL) && processAsync(pCb->atClientMagicNumber)) {
+                pExecutor->numCallbacks++;
+                if (durationMs > 0) {
+                    pExecutor->durationTotalMs += durationMs;
+                    if (durationMs > pExecutor->durationMaxMs) {
+                        pExecutor->durationMaxMs = durationMs;
+                    }
+                }
+            }
+        }
     }
 }
 
@@ -2814,6 +3750,13 @@ static uAtClientHandle_t clientAdd(const uAtClientStreamHandle_t *pStream,
                         // This will also set stopTag
                         setScope(pClient, U_AT_CLIENT_SCOPE_NONE);
                         pClient->lastTxTimeMs = -1;
+                        pClient->awakeStartTimeMs = -1;
+                        // No transmit assembly buffer is not a
+                        // failure, writes will just go direct
+                        if (U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES > 0) {
+                            pClient->pTxBuffer = (char *) pUPortMalloc(U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES);
+                            pClient->txBufferOn = true;
+                        }
                         pClient->urcMaxStringLength = U_AT_CLIENT_INITIAL_URC_LENGTH;
                         pClient->maxRespLength = U_AT_CLIENT_MAX_LENGTH_INFORMATION_RESPONSE_PREFIX;
                         // Set up the buffer and its protection markers
@@ -2872,6 +3815,7 @@ static uAtClientHandle_t clientAdd(const uAtClientStreamHandle_t *pStream,
                     if (receiveBufferIsMalloced) {
                         uPortFree(pClient->pReceiveBuffer);
                     }
+                    uPortFree(pClient->pTxBuffer);
                     uPortFree(pClient);
                     pClient = NULL;
                 }
@@ -2930,9 +3874,17 @@ int32_t uAtClientInit()
                                                 U_AT_CLIENT_CALLBACK_TASK_PRIORITY,
                                                 U_AT_CLIENT_CALLBACK_QUEUE_LENGTH);
         if (errorCodeOrHandle >= 0) {
-            gEventQueueHandle = errorCodeOrHandle;
-            // Create the mutex that protects gEventQueueHandle
+            memset(&gCallbackExecutor, 0, sizeof(gCallbackExecutor));
+            gCallbackExecutor.eventQueueHandle = errorCodeOrHandle;
+            gCallbackExecutor.stackSizeBytes = U_AT_CLIENT_CALLBACK_TASK_STACK_SIZE_BYTES;
+            gCallbackExecutor.taskPriority = U_AT_CLIENT_CALLBACK_TASK_PRIORITY;
+            gCallbackExecutor.queueLength = U_AT_CLIENT_CALLBACK_QUEUE_LENGTH;
+            // Create the mutex that protects gCallbackExecutor
             errorCodeOrHandle = uPortMutexCreate(&gMutexEventQueue);
+            if (errorCodeOrHandle == 0) {
+                // Create the mutex that protects the deferred callback timers
+                errorCodeOrHandle = uPortMutexCreate(&gMutexDeferred);
+            }
             if (errorCodeOrHandle == 0) {
                 // Create the mutex that protects the linked list
                 errorCodeOrHandle = uPortMutexCreate(&gMutex);
@@ -2946,13 +3898,21 @@ int32_t uAtClientInit()
 #endif
                 } else {
                     // Failed, release the callbacks event queue again
-                    // and its mutex
-                    uPortEventQueueClose(gEventQueueHandle);
+                    // and its mutexes
+                    uPortEventQueueClose(gCallbackExecutor.eventQueueHandle);
+                    uPortMutexDelete(gMutexDeferred);
+                    gMutexDeferred = NULL;
                     uPortMutexDelete(gMutexEventQueue);
+                    gMutexEventQueue = NULL;
                 }
             } else {
                 // Failed, release the callbacks event queue again
-                uPortEventQueueClose(gEventQueueHandle);
+                // and any mutex
+                uPortEventQueueClose(gCallbackExecutor.eventQueueHandle);
+                if (gMutexEventQueue != NULL) {
+                    uPortMutexDelete(gMutexEventQueue);
+                    gMutexEventQueue = NULL;
+                }
             }
         }
     }
@@ -2974,12 +3934,14 @@ void uAtClientDeinit()
 
         U_PORT_MUTEX_LOCK(gMutexEventQueue);
         // Release the callbacks event queue
-        uPortEventQueueClose(gEventQueueHandle);
+        uPortEventQueueClose(gCallbackExecutor.eventQueueHandle);
 
         // Delete the mutexes
         U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
         uPortMutexDelete(gMutexEventQueue);
         gMutexEventQueue = NULL;
+        uPortMutexDelete(gMutexDeferred);
+        gMutexDeferred = NULL;
         U_PORT_MUTEX_UNLOCK(gMutex);
         uPortMutexDelete(gMutex);
         gMutex = NULL;
@@ -3238,6 +4200,29 @@ void uAtClientDelaySet(uAtClientHandle_t atHandle,
     }
 }
 
+// Return whether the transmit assembly buffer is in use.
+//lint -e{818} suppress "could be declared as pointing to const": it is!
+bool uAtClientTxBufferGet(const uAtClientHandle_t atHandle)
+{
+    return ((uAtClientInstance_t *) atHandle)->txBufferOn;
+}
+
+// Switch the transmit assembly buffer on or off.
+void uAtClientTxBufferSet(uAtClientHandle_t atHandle, bool onNotOff)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (!onNotOff) {
+        // Send anything that is left over
+        txBufferFlush(pClient, false);
+    }
+    pClient->txBufferOn = onNotOff && (pClient->pTxBuffer != NULL);
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: SEND AN AT COMMAND
  * -------------------------------------------------------------- */
@@ -3310,6 +4295,14 @@ int32_t uAtClientUnlock(uAtClientHandle_t atHandle)
 
     U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
 
+    // Don't leave anything behind in the transmit
+    // assembly buffer (e.g. if uAtClientCommandStop()
+    // was not called)
+    txBufferFlush(pClient, false);
+
+    // Any AT command in progress has now ended
+    commandStatsEnd(pClient);
+
     streamMutex = mutexStackPop(&(pClient->lockedStreamMutexStack));
     if (streamMutex != NULL) {
         unlockNoDataCheck(pClient, streamMutex);
@@ -3368,6 +4361,13 @@ int32_t uAtClientUnlock(uAtClientHandle_t atHandle)
         }
 
         U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pClient->pReceiveBuffer));
+
+        // If the module is awake, this being the end of an
+        // exchange that went well, get on with any deferred
+        // callbacks that are due while it stays that way
+        if (pClient->error == U_ERROR_COMMON_SUCCESS) {
+            deferredKick(pClient);
+        }
     }
 
     U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
@@ -3398,6 +4398,9 @@ void uAtClientCommandStart(uAtClientHandle_t atHandle,
         // because that is useful during testing
         if (pCommand != NULL) {
             write(pClient, pCommand, strlen(pCommand), false);
+            // Do this after the write so that the time any
+            // wake-up handler might take is not included
+            commandStatsBegin(pClient, pCommand);
         }
     }
 
@@ -3566,6 +4569,13 @@ int32_t uAtClientResponseStart(uAtClientHandle_t atHandle,
     // handler which will also need the lock.
 
     if (pClient->error == U_ERROR_COMMON_SUCCESS) {
+        // Make sure that everything has been sent; the
+        // lock is only held for this, see note above
+        if (pClient->txBufferLength > 0) {
+            U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+            txBufferFlush(pClient, false);
+            U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+        }
         // Stop any previous information response
         if (pClient->scope == U_AT_CLIENT_SCOPE_INFORMATION) {
             informationResponseStop(pClient);
@@ -3664,47 +4674,61 @@ int32_t uAtClientReadBytes(uAtClientHandle_t atHandle,
     int32_t lengthRead = 0;
     int32_t matchPos = 0;
     int32_t c;
+    size_t runLength = 0;
 
     U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
 
     while ((lengthRead < ((int32_t) lengthBytes + matchPos)) &&
            (pClient->error == U_ERROR_COMMON_SUCCESS) &&
            !pStopTag->found) {
-        c = bufferReadChar(pClient);
-        if (c == -1) {
-            // Error
-            setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
-        } else {
-            if (pStopTag->pTagDef->length > 0) {
-                // It could be a stop tag
-                if (c == *(pStopTag->pTagDef->pString + matchPos)) {
-                    matchPos++;
-                } else {
-                    // If it wasn't a stop tag, reset
-                    // the match position and check again
-                    // in case it is the start of a new stop tag
-                    matchPos = 0;
-                    if (c == *(pStopTag->pTagDef->pString)) {
+        if (matchPos == 0) {
+            // Not part-way through a stop tag: copy out any
+            // run of bytes up to the start of a possible stop tag
+            runLength = bufferReadRun(pClient,
+                                      (pBuffer != NULL) ? pBuffer + lengthRead : NULL,
+                                      lengthBytes - lengthRead,
+                                      pStopTag->pTagDef->pString,
+                                      (pStopTag->pTagDef->length > 0) ? 1 : 0);
+            lengthRead += (int32_t) runLength;
+        }
+        if (runLength == 0) {
+            c = bufferReadChar(pClient);
+            if (c == -1) {
+                // Error
+                setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
+            } else {
+                if (pStopTag->pTagDef->length > 0) {
+                    // It could be a stop tag
+                    if (c == *(pStopTag->pTagDef->pString + matchPos)) {
                         matchPos++;
+                    } else {
+                        // If it wasn't a stop tag, reset
+                        // the match position and check again
+                        // in case it is the start of a new stop tag
+                        matchPos = 0;
+                        if (c == *(pStopTag->pTagDef->pString)) {
+                            matchPos++;
+                        }
                     }
+                    if (matchPos == (int32_t) pStopTag->pTagDef->length) {
+                        pStopTag->found = true;
+                        // Remove tag from string if it was matched
+                        lengthRead -= (int32_t) pStopTag->pTagDef->length - 1;
+                    }
+                } else {
+                    // Not anything
+                    matchPos = 0;
                 }
-                if (matchPos == (int32_t) pStopTag->pTagDef->length) {
-                    pStopTag->found = true;
-                    // Remove tag from string if it was matched
-                    lengthRead -= (int32_t) pStopTag->pTagDef->length - 1;
-                }
-            } else {
-                // Not anything
-                matchPos = 0;
-            }
-            if (!pStopTag->found) {
-                if (pBuffer != NULL) {
-                    // Add the byte to the buffer
-                    *(pBuffer + lengthRead) = (char) c;
+                if (!pStopTag->found) {
+                    if (pBuffer != NULL) {
+                        // Add the byte to the buffer
+                        *(pBuffer + lengthRead) = (char) c;
+                    }
+                    lengthRead++;
                 }
-                lengthRead++;
             }
         }
+        runLength = 0;
     }
 
     if (!standalone) {
@@ -3754,22 +4778,137 @@ int32_t uAtClientReadHexData(uAtClientHandle_t atHandle,
 {
     int32_t errorOrLength;
     size_t strSize = lengthBytes * 2 + 1;
-    char *pHexStr = (char *)pUPortMalloc(strSize);
-    if (pHexStr) {
-        errorOrLength = uAtClientReadString(atHandle,
-                                            pHexStr,
-                                            strSize,
-                                            false);
-        if (errorOrLength > 0) {
-            errorOrLength = uHexToBin(pHexStr, strlen(pHexStr), (char *)pData);
+    char *pHexStr;
+    uAtClientView_t view;
+
+    // Decode straight out of the receive buffer if possible
+    errorOrLength = uAtClientReadStringView(atHandle, &view, false);
+    if (errorOrLength > 0) {
+        errorOrLength = (int32_t) uAtClientViewHexToBin(&view, (char *) pData,
+                                                        lengthBytes);
+    } else if (errorOrLength == (int32_t) U_ERROR_COMMON_NO_MEMORY) {
+        pHexStr = (char *)pUPortMalloc(strSize);
+        if (pHexStr) {
+            errorOrLength = uAtClientReadString(atHandle,
+                                                pHexStr,
+                                                strSize,
+                                                false);
+            if (errorOrLength > 0) {
+                errorOrLength = uHexToBin(pHexStr, strlen(pHexStr), (char *)pData);
+            }
+            uPortFree(pHexStr);
         }
-        uPortFree(pHexStr);
-    } else {
-        errorOrLength = U_ERROR_COMMON_NO_MEMORY;
     }
     return errorOrLength;
 }
 
+// Read a string parameter as a view into the receive buffer.
+int32_t uAtClientReadStringView(uAtClientHandle_t atHandle,
+                                uAtClientView_t *pView,
+                                bool ignoreStopTag)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    int32_t errorCodeOrLength;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    errorCodeOrLength = readStringView(pClient, pView, ignoreStopTag);
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return errorCodeOrLength;
+}
+
+// Convert a view into an integer.
+int32_t uAtClientViewToInt(const uAtClientView_t *pView,
+                           int32_t *pInt)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pView != NULL) && (pView->pData != NULL) && (pInt != NULL) &&
+        (pView->length > 0) &&
+        (parseInt(pView->pData, pView->length, pInt) == pView->length)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Convert a view of ASCII hex into binary.
+size_t uAtClientViewHexToBin(const uAtClientView_t *pView,
+                             char *pBuffer, size_t bufferLength)
+{
+    size_t length = 0;
+    int32_t nibble[2];
+    char c;
+
+    if ((pView != NULL) && (pView->pData != NULL) && (pBuffer != NULL)) {
+        for (size_t x = 0; (x + 1 < pView->length) && (length < bufferLength); x += 2) {
+            for (size_t y = 0; y < 2; y++) {
+                c = *(pView->pData + x + y);
+                nibble[y] = -1;
+                if ((c >= '0') && (c <= '9')) {
+                    nibble[y] = c - '0';
+                } else if ((c >= 'A') && (c <= 'F')) {
+                    nibble[y] = c - 'A' + 10;
+                } else if ((c >= 'a') && (c <= 'f')) {
+                    nibble[y] = c - 'a' + 10;
+                }
+            }
+            if ((nibble[0] < 0) || (nibble[1] < 0)) {
+                break;
+            }
+            *(pBuffer + length) = (char) ((nibble[0] << 4) | nibble[1]);
+            length++;
+        }
+    }
+
+    return length;
+}
+
+// Convert a view of a dotted-decimal IPV4 address into a uint32_t.
+int32_t uAtClientViewToIpV4(const uAtClientView_t *pView,
+                            uint32_t *pAddress)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uint32_t address = 0;
+    size_t numOctets = 0;
+    size_t numDigits = 0;
+    int32_t octet = 0;
+    char c;
+
+    if ((pView != NULL) && (pView->pData != NULL) && (pAddress != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        for (size_t x = 0; (x <= pView->length) &&
+             (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS); x++) {
+            c = '.';
+            if (x < pView->length) {
+                c = *(pView->pData + x);
+            }
+            if ((c >= '0') && (c <= '9') && (numDigits < 3)) {
+                octet = (octet * 10) + (c - '0');
+                numDigits++;
+            } else if ((c == '.') && (numDigits > 0) &&
+                       (octet <= 255) && (numOctets < 4)) {
+                // The end of the view counts as a final '.'
+                address = (address << 8) | (uint32_t) octet;
+                numOctets++;
+                numDigits = 0;
+                octet = 0;
+            } else {
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            }
+        }
+        if ((errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) && (numOctets == 4)) {
+            *pAddress = address;
+        } else {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
+    }
+
+    return errorCode;
+}
+
 // Stop the response part of an AT sequence.
 void uAtClientResponseStop(uAtClientHandle_t atHandle)
 {
@@ -3788,6 +4927,8 @@ void uAtClientResponseStop(uAtClientHandle_t atHandle)
 
     pClient->lastResponseStopMs = uPortGetTickTimeMs();
 
+    commandStatsEnd(pClient);
+
     U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
 }
 
@@ -3915,6 +5056,13 @@ int32_t uAtClientWaitCharacter(uAtClientHandle_t atHandle,
     // stream as part of looking for URCs
     if ((character != 0x0d) && (character != 0x0a)) {
         errorCode = U_ERROR_COMMON_NOT_FOUND;
+        // Make sure that everything has been sent; the
+        // lock is only held for this, see note above
+        if (pClient->txBufferLength > 0) {
+            U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+            txBufferFlush(pClient, false);
+            U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+        }
         if (!pClient->stopTag.found) {
             // While there is a timeout inside the call to bufferFill()
             // below, it might be that the length in the buffer never
@@ -4183,37 +5331,169 @@ int32_t uAtClientUrcHandlerStackMinFree(uAtClientHandle_t atHandle)
 int32_t uAtClientCallback(uAtClientHandle_t atHandle,
                           void (*pCallback) (uAtClientHandle_t, void *),
                           void *pCallbackParam)
+{
+    return uAtClientCallbackPriority(atHandle, U_AT_CLIENT_CALLBACK_PRIORITY_NORMAL,
+                                     pCallback, pCallbackParam);
+}
+
+// Get the stack high watermark for the AT callback task.
+int32_t uAtClientCallbackStackMinFree()
+{
+    int32_t sizeOrErrorCode;
+
+    U_PORT_MUTEX_LOCK(gMutexEventQueue);
+
+    sizeOrErrorCode = uPortEventQueueStackMinFree(gCallbackExecutor.eventQueueHandle);
+
+    U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
+
+    return sizeOrErrorCode;
+}
+
+// Give an AT client its own callback executor.
+int32_t uAtClientCallbackExecutorSet(uAtClientHandle_t atHandle,
+                                     uAtClientCallbackPriority_t priority,
+                                     size_t stackSizeBytes,
+                                     int32_t taskPriority,
+                                     size_t queueLength)
+{
+    int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uAtClientCallbackExecutor_t *pExecutor;
+
+    U_PORT_MUTEX_LOCK(gMutexEventQueue);
+
+    if ((pClient != NULL) && ((size_t) priority < U_AT_CLIENT_CALLBACK_PRIORITY_MAX_NUM) &&
+        (pClient->pCallbackExecutor[priority] == NULL) && (queueLength > 0)) {
+        errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pExecutor = (uAtClientCallbackExecutor_t *) pUPortMalloc(sizeof(*pExecutor));
+        if (pExecutor != NULL) {
+            memset(pExecutor, 0, sizeof(*pExecutor));
+            errorCodeOrHandle = uPortEventQueueOpen(eventQueueCallback,
+                                                    "atCallbacksClient",
+                                                    sizeof(uAtClientCallback_t),
+                                                    stackSizeBytes, taskPriority,
+                                                    queueLength);
+            if (errorCodeOrHandle >= 0) {
+                pExecutor->eventQueueHandle = errorCodeOrHandle;
+                pExecutor->stackSizeBytes = stackSizeBytes;
+                pExecutor->taskPriority = taskPriority;
+                pExecutor->queueLength = queueLength;
+                pClient->pCallbackExecutor[priority] = pExecutor;
+                errorCodeOrHandle = (int32_t) U_ERROR_COMMON_SUCCESS;
+            } else {
+                uPortFree(pExecutor);
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
+
+    return errorCodeOrHandle;
+}
+
+// Get the settings of an AT client's own callback executor.
+int32_t uAtClientCallbackExecutorGet(uAtClientHandle_t atHandle,
+                                     uAtClientCallbackPriority_t priority,
+                                     size_t *pStackSizeBytes,
+                                     int32_t *pTaskPriority,
+                                     size_t *pQueueLength)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-    uAtClientCallback_t cb = {0}; // Keep Valgrind happy (otherwise the last four bytes will be uninitialised)
+    const uAtClientInstance_t *pClient = (const uAtClientInstance_t *) atHandle;
+    const uAtClientCallbackExecutor_t *pExecutor;
 
     U_PORT_MUTEX_LOCK(gMutexEventQueue);
 
-    if (pCallback != NULL) {
+    if ((pClient != NULL) && ((size_t) priority < U_AT_CLIENT_CALLBACK_PRIORITY_MAX_NUM)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        pExecutor = pClient->pCallbackExecutor[priority];
+        if (pExecutor != NULL) {
+            if (pStackSizeBytes != NULL) {
+                *pStackSizeBytes = pExecutor->stackSizeBytes;
+            }
+            if (pTaskPriority != NULL) {
+                *pTaskPriority = pExecutor->taskPriority;
+            }
+            if (pQueueLength != NULL) {
+                *pQueueLength = pExecutor->queueLength;
+            }
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
+
+    return errorCode;
+}
+
+// Make a callback resulting from a URC, with a priority.
+int32_t uAtClientCallbackPriority(uAtClientHandle_t atHandle,
+                                  uAtClientCallbackPriority_t priority,
+                                  void (*pCallback) (uAtClientHandle_t, void *),
+                                  void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientCallback_t cb = {0}; // Keep Valgrind happy (otherwise the last four bytes will be uninitialised)
+
+    if ((pCallback != NULL) && ((size_t) priority < U_AT_CLIENT_CALLBACK_PRIORITY_MAX_NUM)) {
         cb.pFunction = pCallback;
         cb.atHandle = atHandle;
         cb.pParam = pCallbackParam;
         cb.atClientMagicNumber = ((uAtClientInstance_t *) atHandle)->magicNumber;
-        errorCode = uPortEventQueueSend(gEventQueueHandle, &cb, sizeof(cb));
+        errorCode = callbackSend((uAtClientInstance_t *) atHandle, priority, &cb);
     }
 
-    U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
+    return errorCode;
+}
+
+// Make a callback resulting from a URC without waiting.
+int32_t uAtClientCallbackNoWait(uAtClientHandle_t atHandle,
+                                void (*pCallback) (uAtClientHandle_t, void *),
+                                void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientCallback_t cb = {0}; // Keep Valgrind happy (otherwise the last four bytes will be uninitialised)
+
+    if (pCallback != NULL) {
+        cb.pFunction = pCallback;
+        cb.atHandle = atHandle;
+        cb.pParam = pCallbackParam;
+        cb.atClientMagicNumber = ((uAtClientInstance_t *) atHandle)->magicNumber;
+        errorCode = callbackSendNoWait((uAtClientInstance_t *) atHandle,
+                                       U_AT_CLIENT_CALLBACK_PRIORITY_NORMAL, &cb);
+    }
 
     return errorCode;
 }
 
-// Get the stack high watermark for the AT callback task.
-int32_t uAtClientCallbackStackMinFree()
+// Get the statistics of a callback executor.
+int32_t uAtClientCallbackStatsGet(uAtClientHandle_t atHandle,
+                                  uAtClientCallbackPriority_t priority,
+                                  uAtClientCallbackStats_t *pStats)
 {
-    int32_t sizeOrErrorCode;
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uAtClientCallbackExecutor_t *pExecutor = &gCallbackExecutor;
 
     U_PORT_MUTEX_LOCK(gMutexEventQueue);
 
-    sizeOrErrorCode = uPortEventQueueStackMinFree(gEventQueueHandle);
+    if ((pStats != NULL) &&
+        ((atHandle == NULL) || ((size_t) priority < U_AT_CLIENT_CALLBACK_PRIORITY_MAX_NUM))) {
+        if (atHandle != NULL) {
+            pExecutor = pCallbackExecutorGet((const uAtClientInstance_t *) atHandle, priority);
+        }
+        pStats->queueLength = pExecutor->queueLength;
+        pStats->queueHighWaterMark = pExecutor->queueHighWaterMark;
+        pStats->numCallbacks = pExecutor->numCallbacks;
+        pStats->durationMaxMs = pExecutor->durationMaxMs;
+        pStats->durationTotalMs = pExecutor->durationTotalMs;
+        pStats->stackMinFreeBytes = uPortEventQueueStackMinFree(pExecutor->eventQueueHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
 
     U_PORT_MUTEX_UNLOCK(gMutexEventQueue);
 
-    return sizeOrErrorCode;
+    return errorCode;
 }
 
 // Handle a URC "in-line".
@@ -4441,6 +5721,9 @@ int32_t uAtClientSetWakeUpHandler(uAtClientHandle_t atHandle,
         if (pHandler == NULL) {
             // Switching the wake-up handler off
             if (pClient->pWakeUp != NULL) {
+                // End any awake period for the statistics
+                pClient->wakeUpStats.awakeTotalMs += awakeDurationMs(pClient);
+                pClient->awakeStartTimeMs = -1;
                 // Mustn't be in the wake-up handler
                 U_ASSERT(uPortMutexTryLock(pClient->pWakeUp->inWakeUpHandlerMutex, 0) == 0);
                 // Delete all the mutexes
@@ -4647,4 +5930,338 @@ int32_t uAtClientGetAti(uAtClientHandle_t atHandle,
     return errorCodeOrLength;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: AT COMMAND STATISTICS
+ * -------------------------------------------------------------- */
+
+// Start recording AT command statistics.
+int32_t uAtClientCommandStatsStart(uAtClientHandle_t atHandle,
+                                   size_t maxNumCommands)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uAtClientCommandStatsContext_t *pContext;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (maxNumCommands > 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (pClient->pCommandStats == NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pContext = (uAtClientCommandStatsContext_t *) pUPortMalloc(sizeof(*pContext) +
+                                                                       (sizeof(uAtClientCommandStats_t) *
+                                                                        maxNumCommands));
+            if (pContext != NULL) {
+                memset(pContext, 0, sizeof(*pContext));
+                pContext->maxNum = maxNumCommands;
+                pContext->pEntries = (uAtClientCommandStats_t *) (pContext + 1);
+                pContext->firstByteTimeMs = -1;
+                pClient->pCommandStats = pContext;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return errorCode;
+}
+
+// Get the maximum number of commands statistics are recorded for.
+int32_t uAtClientCommandStatsMaxNumGet(const uAtClientHandle_t atHandle)
+{
+    int32_t errorCodeOrMaxNum = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    const uAtClientInstance_t *pClient = (const uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (pClient->pCommandStats != NULL) {
+        errorCodeOrMaxNum = (int32_t) pClient->pCommandStats->maxNum;
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return errorCodeOrMaxNum;
+}
+
+// Stop recording AT command statistics.
+void uAtClientCommandStatsStop(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    uPortFree(pClient->pCommandStats);
+    pClient->pCommandStats = NULL;
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
+// Reset the AT command statistics.
+void uAtClientCommandStatsReset(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (pClient->pCommandStats != NULL) {
+        pClient->pCommandStats->num = 0;
+        pClient->pCommandStats->pCurrent = NULL;
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
+// Get a snapshot of the AT command statistics.
+int32_t uAtClientCommandStatsGet(uAtClientHandle_t atHandle,
+                                 uAtClientCommandStats_t *pStats,
+                                 size_t maxNumStats)
+{
+    int32_t errorCodeOrNum = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    size_t num;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (pStats != NULL) {
+        errorCodeOrNum = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+        if (pClient->pCommandStats != NULL) {
+            num = pClient->pCommandStats->num;
+            if (num > maxNumStats) {
+                num = maxNumStats;
+            }
+            memcpy(pStats, pClient->pCommandStats->pEntries, num * sizeof(*pStats));
+            errorCodeOrNum = (int32_t) num;
+        }
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return errorCodeOrNum;
+}
+
+// Write the AT command statistics as CSV.
+int32_t uAtClientCommandStatsCsv(uAtClientHandle_t atHandle,
+                                 char *pBuffer, size_t bufferLength)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    const uAtClientCommandStats_t *pEntry;
+    char field[U_AT_CLIENT_COMMAND_STATS_COMMAND_MAX_LENGTH_BYTES + 4];
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if ((pBuffer != NULL) || (bufferLength == 0)) {
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+        if (pClient->pCommandStats != NULL) {
+            if ((pBuffer != NULL) && (bufferLength > 0)) {
+                *pBuffer = 0;
+            }
+            // The header line
+            errorCodeOrLength = commandStatsCsvAppend(pBuffer, bufferLength, 0,
+                                                      "command,count,errors,timeouts");
+            for (size_t x = 0; x < U_AT_CLIENT_COMMAND_STATS_HISTOGRAM_NUM_BINS; x++) {
+                snprintf(field, sizeof(field), ",ttfb%d", (int) x);
+                errorCodeOrLength = commandStatsCsvAppend(pBuffer, bufferLength,
+                                                          errorCodeOrLength, field);
+            }
+            for (size_t x = 0; x < U_AT_CLIENT_COMMAND_STATS_HISTOGRAM_NUM_BINS; x++) {
+                snprintf(field, sizeof(field), ",total%d", (int) x);
+                errorCodeOrLength = commandStatsCsvAppend(pBuffer, bufferLength,
+                                                          errorCodeOrLength, field);
+            }
+            errorCodeOrLength = commandStatsCsvAppend(pBuffer, bufferLength,
+                                                      errorCodeOrLength, "\n");
+            // A line for each command
+            for (size_t x = 0; x < pClient->pCommandStats->num; x++) {
+                pEntry = &(pClient->pCommandStats->pEntries[x]);
+                snprintf(field, sizeof(field), "\"%s\"", pEntry->command);
+                errorCodeOrLength = commandStatsCsvAppend(pBuffer, bufferLength,
+                                                          errorCodeOrLength, field);
+                snprintf(field, sizeof(field), ",%d", (int) pEntry->count);
+                errorCodeOrLength = commandStatsCsvAppend(pBuffer, bufferLength,
+                                                          errorCodeOrLength, field);
+                snprintf(field, sizeof(field), ",%d", (int) pEntry->numErrors);
+                errorCodeOrLength = commandStatsCsvAppend(pBuffer, bufferLength,
+                                                          errorCodeOrLength, field);
+                snprintf(field, sizeof(field), ",%d", (int) pEntry->numTimeouts);
+                errorCodeOrLength = commandStatsCsvAppend(pBuffer, bufferLength,
+                                                          errorCodeOrLength, field);
+                for (size_t y = 0; y < U_AT_CLIENT_COMMAND_STATS_HISTOGRAM_NUM_BINS; y++) {
+                    snprintf(field, sizeof(field), ",%d", (int) pEntry->firstByteHistogram[y]);
+                    errorCodeOrLength = commandStatsCsvAppend(pBuffer, bufferLength,
+                                                              errorCodeOrLength, field);
+                }
+                for (size_t y = 0; y < U_AT_CLIENT_COMMAND_STATS_HISTOGRAM_NUM_BINS; y++) {
+                    snprintf(field, sizeof(field), ",%d", (int) pEntry->totalHistogram[y]);
+                    errorCodeOrLength = commandStatsCsvAppend(pBuffer, bufferLength,
+                                                              errorCodeOrLength, field);
+                }
+                errorCodeOrLength = commandStatsCsvAppend(pBuffer, bufferLength,
+                                                          errorCodeOrLength, "\n");
+            }
+        }
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return errorCodeOrLength;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: DEFERRED AT COMMANDS
+ * -------------------------------------------------------------- */
+
+// Add a deferred callback.
+int32_t uAtClientDeferredAdd(uAtClientHandle_t atHandle,
+                             void (*pCallback) (uAtClientHandle_t, void *),
+                             void *pCallbackParam,
+                             int32_t notBeforeMs, int32_t deadlineMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uAtClientDeferredContext_t *pContext;
+    uAtClientDeferred_t *pDeferred;
+    uAtClientDeferred_t **ppDeferred;
+    bool registered = false;
+    int32_t nowMs;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if ((pCallback != NULL) && (notBeforeMs >= 0) && (deadlineMs >= notBeforeMs)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        if (pClient->pDeferred == NULL) {
+            pContext = (uAtClientDeferredContext_t *) pUPortMalloc(sizeof(*pContext));
+            if (pContext != NULL) {
+                memset(pContext, 0, sizeof(*pContext));
+                // The timer is given the magic number of the AT
+                // client, see deferredTimerCallback()
+                errorCode = uPortTimerCreate(&(pContext->timer), "atDeferred",
+                                             deferredTimerCallback,
+                                             (void *) (intptr_t) pClient->magicNumber,
+                                             1, false);
+                if (errorCode == 0) {
+                    pClient->pDeferred = pContext;
+                    // Let deferredTimerCallback() find the AT client
+                    U_PORT_MUTEX_LOCK(gMutexDeferred);
+                    for (size_t x = 0; !registered &&
+                         (x < sizeof(gpDeferredClient) / sizeof(gpDeferredClient[0])); x++) {
+                        if (gpDeferredClient[x] == NULL) {
+                            gpDeferredClient[x] = pClient;
+                            registered = true;
+                        }
+                    }
+                    U_PORT_MUTEX_UNLOCK(gMutexDeferred);
+                } else {
+                    uPortFree(pContext);
+                }
+            }
+        }
+        if (pClient->pDeferred != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pDeferred = (uAtClientDeferred_t *) pUPortMalloc(sizeof(*pDeferred));
+            if (pDeferred != NULL) {
+                nowMs = uPortGetTickTimeMs();
+                pDeferred->pCallback = pCallback;
+                pDeferred->pParam = pCallbackParam;
+                pDeferred->notBeforeTimeMs = nowMs + notBeforeMs;
+                pDeferred->deadlineTimeMs = nowMs + deadlineMs;
+                pDeferred->due = false;
+                pDeferred->pNext = NULL;
+                // Add it to the end of the list so that
+                // callbacks that are due together are run
+                // in the order they were added
+                ppDeferred = &(pClient->pDeferred->pList);
+                while (*ppDeferred != NULL) {
+                    ppDeferred = &((*ppDeferred)->pNext);
+                }
+                *ppDeferred = pDeferred;
+                deferredTimerSet(pClient);
+                deferredKick(pClient);
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return errorCode;
+}
+
+// Remove deferred callbacks.
+int32_t uAtClientDeferredRemove(uAtClientHandle_t atHandle,
+                                void (*pCallback) (uAtClientHandle_t, void *),
+                                void *pCallbackParam)
+{
+    int32_t errorCodeOrNum = 0;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uAtClientDeferred_t *pDeferred;
+    uAtClientDeferred_t **ppDeferred;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (pClient->pDeferred != NULL) {
+        ppDeferred = &(pClient->pDeferred->pList);
+        while (*ppDeferred != NULL) {
+            pDeferred = *ppDeferred;
+            if ((pDeferred->pCallback == pCallback) &&
+                (pDeferred->pParam == pCallbackParam)) {
+                *ppDeferred = pDeferred->pNext;
+                uPortFree(pDeferred);
+                errorCodeOrNum++;
+            } else {
+                ppDeferred = &(pDeferred->pNext);
+            }
+        }
+        if ((pClient->pDeferred->pRunning != NULL) &&
+            (pClient->pDeferred->pRunning->pCallback == pCallback) &&
+            (pClient->pDeferred->pRunning->pParam == pCallbackParam)) {
+            // Can't stop that one
+            errorCodeOrNum = (int32_t) U_ERROR_COMMON_BUSY;
+        }
+        deferredTimerSet(pClient);
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return errorCodeOrNum;
+}
+
+// Get the wake-up and deferred callback statistics.
+int32_t uAtClientWakeUpStatsGet(uAtClientHandle_t atHandle,
+                                uAtClientWakeUpStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    if (pStats != NULL) {
+        *pStats = pClient->wakeUpStats;
+        // Include the awake period that is in progress
+        pStats->awakeTotalMs += awakeDurationMs(pClient);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+
+    return errorCode;
+}
+
+// Reset the wake-up and deferred callback statistics.
+void uAtClientWakeUpStatsReset(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+    memset(&(pClient->wakeUpStats), 0, sizeof(pClient->wakeUpStats));
+    if (pClient->awakeStartTimeMs >= 0) {
+        // Only count what is left of any awake period in progress
+        pClient->awakeStartTimeMs = uPortGetTickTimeMs();
+    }
+
+    U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+}
+
 // End of file
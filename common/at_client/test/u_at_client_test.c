@@ -136,10 +136,177 @@
  * we need room for initial and trailing line endings. */
 #define U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES (256 + 4 + U_AT_CLIENT_BUFFER_OVERHEAD_BYTES)
 
+#ifndef U_AT_CLIENT_TEST_TX_BUFFER_ITERATIONS
+/** The number of AT commands to send when timing the transmit
+ * path with and without the transmit assembly buffer.
+ */
+# define U_AT_CLIENT_TEST_TX_BUFFER_ITERATIONS 100
+#endif
+
+/** The AT command that is sent when testing the transmit
+ * assembly buffer, as it should arrive at the far end.
+ */
+#define U_AT_CLIENT_TEST_TX_BUFFER_COMMAND "AT+USOST=0,\"123.456.789.012\",5000,10,\"0123456789\"\r"
+
+/** The number of separate writes that the AT client makes for
+ * #U_AT_CLIENT_TEST_TX_BUFFER_COMMAND if there is no transmit
+ * assembly buffer: the command, the first integer parameter
+ * (which needs no delimiter), then a delimiter, opening quote,
+ * string and closing quote for the first string parameter, a
+ * delimiter and the number for each of the next two integer
+ * parameters, the same as for the first string again for the
+ * second string and, finally, the command delimiter.
+ */
+#define U_AT_CLIENT_TEST_TX_BUFFER_NUM_WRITES_UNBUFFERED 15
+
+#ifndef U_AT_CLIENT_TEST_READ_ITERATIONS
+/** The number of random responses to read when checking
+ * uAtClientReadString() and uAtClientReadBytes() against
+ * the character-by-character model.
+ */
+# define U_AT_CLIENT_TEST_READ_ITERATIONS 100
+#endif
+
+/** The maximum length of a random response parameter when
+ * checking uAtClientReadString() and uAtClientReadBytes().
+ */
+#define U_AT_CLIENT_TEST_READ_MAX_LENGTH_BYTES 200
+
+/** The maximum number of bytes to ask for in any one read when
+ * checking uAtClientReadString() and uAtClientReadBytes().
+ */
+#define U_AT_CLIENT_TEST_READ_MAX_READ_BYTES 64
+
+/** The length of the response parameter used when timing
+ * uAtClientReadString() and uAtClientReadBytes(); must fit,
+ * with its prefix and terminators, into
+ * U_CFG_TEST_UART_BUFFER_LENGTH_BYTES.
+ */
+#define U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES 512
+
+#ifndef U_AT_CLIENT_TEST_READ_TIMING_ITERATIONS
+/** The number of times to read the response when timing
+ * uAtClientReadString() and uAtClientReadBytes().
+ */
+# define U_AT_CLIENT_TEST_READ_TIMING_ITERATIONS 100
+#endif
+
+/** The AT client buffer length to use when timing reads. */
+#define U_AT_CLIENT_TEST_READ_TIMING_AT_BUFFER_LENGTH_BYTES (U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES + 64 + \
+                                                             U_AT_CLIENT_BUFFER_OVERHEAD_BYTES)
+
+/** How long the deliberately slow callback of the
+ * atClientCallbackExecutor test blocks for.
+ */
+#define U_AT_CLIENT_TEST_SLOW_CALLBACK_MS 500
+
+/** The number of slow URCs sent by the atClientCallbackExecutor test.
+ */
+#define U_AT_CLIENT_TEST_SLOW_URC_NUM 3
+
+/** The maximum time the fast callback of the atClientCallbackExecutor
+ * test may take to arrive, which must be less than
+ * U_AT_CLIENT_TEST_SLOW_CALLBACK_MS.
+ */
+#define U_AT_CLIENT_TEST_FAST_CALLBACK_MAX_MS 250
+
+/** The queue length of the callback executor created by the
+ * atClientCallbackExecutor test.
+ */
+#define U_AT_CLIENT_TEST_CALLBACK_QUEUE_LENGTH 5
+
+/** The AT timeout used by the atClientCommandStats test; the
+ * time-out case should land in histogram bin 10 (512 to 1023 ms).
+ */
+#define U_AT_CLIENT_TEST_COMMAND_STATS_TIMEOUT_MS 700
+
+/** The number of integer parameters in the response used by the
+ * atClientView test to compare uAtClientReadStringView() with
+ * uAtClientReadString().
+ */
+#define U_AT_CLIENT_TEST_VIEW_NUM_INTS 20
+
+#ifndef U_AT_CLIENT_TEST_VIEW_ITERATIONS
+/** The number of times to read the response when comparing
+ * uAtClientReadStringView() with uAtClientReadString().
+ */
+# define U_AT_CLIENT_TEST_VIEW_ITERATIONS 100
+#endif
+
+/** The time scale of the atClientDeferred test: each millisecond
+ * of test time stands for this many milliseconds of real time.
+ */
+#define U_AT_CLIENT_TEST_DEFERRED_TIME_SCALE 50
+
+/** How long the simulated module of the atClientDeferred test
+ * stays awake after it last received something, in test time
+ * (5 seconds real time).
+ */
+#define U_AT_CLIENT_TEST_DEFERRED_SLEEP_AFTER_MS 100
+
+/** The inactivity timeout given to uAtClientSetWakeUpHandler()
+ * by the atClientDeferred test, in test time: must be less than
+ * U_AT_CLIENT_TEST_DEFERRED_SLEEP_AFTER_MS.
+ */
+#define U_AT_CLIENT_TEST_DEFERRED_INACTIVITY_TIMEOUT_MS 80
+
+/** How long the simulated module of the atClientDeferred test
+ * takes to wake up, in test time (1 second real time).
+ */
+#define U_AT_CLIENT_TEST_DEFERRED_WAKE_UP_MS 20
+
+#ifndef U_AT_CLIENT_TEST_DEFERRED_RUN_MS
+/** How long the atClientDeferred test runs each telemetry schedule
+ * for, in test time (400 seconds real time).
+ */
+# define U_AT_CLIENT_TEST_DEFERRED_RUN_MS 8000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** How delayServerCallback() should respond to an AT command.
+ */
+typedef struct {
+    int32_t firstByteDelayMs; /**< how long to wait before the first
+                                   byte of the response, -1 for no
+                                   response at all. */
+    int32_t totalDelayMs;     /**< how long to wait before the end
+                                   of the response. */
+    bool isError;             /**< true to respond with "ERROR". */
+} uAtClientTestDelayServer_t;
+
+/** The state of the simulated module of the atClientDeferred test,
+ * which ignores everything it receives while it is asleep.
+ */
+typedef struct {
+    bool sleeps; /**< false if the module never goes to sleep. */
+    bool wakesOnRx; /**< true if the module wakes up when it receives
+                         something, rather than being woken by
+                         sleepyModuleWakeUp(). */
+    volatile bool awake;
+    volatile int32_t lastRxTimeMs;
+    int32_t numWakeUps;
+    int32_t numCommands;
+    int32_t numCommandsLost; /**< commands received while asleep. */
+} uAtClientTestSleepyModule_t;
+
+/** An item of the telemetry schedule of the atClientDeferred test.
+ */
+typedef struct {
+    const char *pCommand;
+    int32_t periodMs;
+    int32_t phaseMs;
+    int32_t slackMs; /**< how late the command may be, zero to
+                          send it as soon as it is due. */
+    int32_t dueTimeMs;
+    int32_t count;
+    int32_t latencyTotalMs;
+    int32_t latencyMaxMs;
+    int32_t errorCode;
+} uAtClientTestTelemetry_t;
+
 /** Data structure to keep track of checking the
  * commands and response.
  */
@@ -152,6 +319,18 @@ typedef struct {
     int32_t responseLastError;
 } uAtClientTestCheckCommandResponse_t;
 
+/** A character-by-character model of the way the AT client
+ * reads an information response, used to check the AT client
+ * against.
+ */
+typedef struct {
+    const char *pData; /**< the response parameters, which must be
+                            terminated with the stop tag "\r\n". */
+    size_t length; /**< the number of characters at pData. */
+    size_t index;
+    bool stopTagFound;
+} uAtClientTestReadModel_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -180,6 +359,53 @@ static char gAtServerBuffer[1024];
  */
 static const char *gpInterceptTxDataLast = NULL;
 
+/** The number of writes counted by pInterceptTxCount().
+ */
+static size_t gInterceptTxCount = 0;
+
+/** The number of bytes received by sinkServerCallback().
+ */
+static size_t gSinkLength = 0;
+
+/** The number of times slowCallback() has been called.
+ */
+static volatile int32_t gSlowCallbackCount = 0;
+
+/** The time at which fastCallback() was called.
+ */
+static volatile int32_t gFastCallbackTimeMs = -1;
+
+/** How delayServerCallback() should respond.
+ */
+static uAtClientTestDelayServer_t gDelayServer = {0};
+
+/** The simulated module of the atClientDeferred test.
+ */
+static uAtClientTestSleepyModule_t gSleepyModule = {0};
+
+/** The telemetry schedule of the atClientDeferred test, in test
+ * time: signal strength every minute, a socket poll every 15
+ * seconds and a GNSS position every 30 seconds, real time.
+ */
+static uAtClientTestTelemetry_t gTelemetry[] = {
+    {"AT+CSQ", 1200, 410, 0, 0, 0, 0, 0, 0},
+    {"AT+USORD=0,0", 300, 0, 0, 0, 0, 0, 0, 0},
+    {"AT+UGGGA?", 600, 170, 0, 0, 0, 0, 0, 0}
+};
+
+/** Set to true while telemetryCallback() should keep
+ * rescheduling itself.
+ */
+static volatile bool gTelemetryOn = false;
+
+/** Incremented by deferredCountCallback() each time it is called.
+ */
+static volatile int32_t gDeferredCount = 0;
+
+/** Set to true by deferredSlowCallback() when it starts.
+ */
+static volatile bool gDeferredSlowRunning = false;
+
 # endif
 #endif
 
@@ -855,6 +1081,537 @@ static char *pInterceptRx(uAtClientHandle_t atHandle,
     return pData;
 }
 
+// A transmit intercept function that counts the writes the
+// AT client makes to the stream while passing the data on
+// unchanged.
+static const char *pInterceptTxCount(uAtClientHandle_t atHandle,
+                                     const char **ppData,
+                                     size_t *pLength,
+                                     void *pContext)
+{
+    const char *pData = NULL;
+
+    (void) atHandle;
+    (void) pContext;
+
+    if ((ppData != NULL) && (*pLength > 0)) {
+        gInterceptTxCount++;
+        pData = *ppData;
+        *ppData += *pLength;
+    }
+
+    return pData;
+}
+
+// An AT server that just receives and keeps what it can in
+// gAtServerBuffer, counting all of the bytes in gSinkLength.
+static void sinkServerCallback(int32_t uartHandle, uint32_t eventBitmask,
+                               void *pParameters)
+{
+    char buffer[64];
+    int32_t sizeOrError;
+    size_t length;
+
+    (void) pParameters;
+
+    if (eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) {
+        do {
+            sizeOrError = uPortUartRead(uartHandle, buffer, sizeof(buffer));
+            if (sizeOrError > 0) {
+                if (gSinkLength < sizeof(gAtServerBuffer)) {
+                    length = sizeof(gAtServerBuffer) - gSinkLength;
+                    if (length > (size_t) sizeOrError) {
+                        length = (size_t) sizeOrError;
+                    }
+                    memcpy(gAtServerBuffer + gSinkLength, buffer, length);
+                }
+                gSinkLength += sizeOrError;
+            }
+        } while (sizeOrError > 0);
+    }
+}
+
+// Wait for sinkServerCallback() to have received the given
+// number of bytes, returning true if it did.
+static bool sinkWait(size_t length)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((gSinkLength < length) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_AT_CLIENT_TEST_AT_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+
+    return (gSinkLength == length);
+}
+
+// Get the next character from the read model, -1 if there
+// are none left.
+static int32_t modelReadChar(uAtClientTestReadModel_t *pModel)
+{
+    int32_t c = -1;
+
+    if (pModel->index < pModel->length) {
+        c = (unsigned char) * (pModel->pData + pModel->index);
+        pModel->index++;
+    }
+
+    return c;
+}
+
+// Update a stop tag match position with the character c,
+// returning true if the "\r\n" stop tag has been found.
+static bool modelStopTag(int32_t c, int32_t *pMatchPos)
+{
+    const char *pStopTag = "\r\n";
+
+    if (c == *(pStopTag + *pMatchPos)) {
+        (*pMatchPos)++;
+    } else {
+        *pMatchPos = 0;
+        if (c == *pStopTag) {
+            (*pMatchPos)++;
+        }
+    }
+
+    return (*pMatchPos == 2);
+}
+
+// Model of uAtClientReadString(), without ignoring the stop
+// tag, as it behaves one character at a time.  Returns -1 if
+// the read would go beyond the stop tag at the end of the
+// model's data (which can happen if the read starts part-way
+// through a quoted string and hence misses the stop tag).
+static int32_t modelReadString(uAtClientTestReadModel_t *pModel,
+                               char *pString, size_t lengthBytes)
+{
+    int32_t lengthRead = 0;
+    int32_t matchPos = 0;
+    bool delimiterFound = false;
+    bool inQuotes = false;
+    int32_t c = 0;
+
+    while ((lengthRead < ((int32_t) lengthBytes - 1) + matchPos) &&
+           !delimiterFound && !pModel->stopTagFound && (c >= 0)) {
+        c = modelReadChar(pModel);
+        if (c < 0) {
+            // Gone off the end
+        } else if (!inQuotes && (c == ',')) {
+            delimiterFound = true;
+        } else if (c == '\"') {
+            matchPos = 0;
+            inQuotes = !inQuotes;
+        } else {
+            if (!inQuotes) {
+                if (modelStopTag(c, &matchPos)) {
+                    pModel->stopTagFound = true;
+                    lengthRead--;
+                }
+            } else {
+                matchPos = 0;
+            }
+            if (!pModel->stopTagFound) {
+                *(pString + lengthRead) = (char) c;
+                lengthRead++;
+            }
+        }
+    }
+    *(pString + lengthRead) = '\0';
+
+    // Consume to delimiter or stop tag
+    if (!delimiterFound && (c >= 0)) {
+        c = 0;
+        while ((c >= 0) && (c != ',') && !pModel->stopTagFound) {
+            c = modelReadChar(pModel);
+            pModel->stopTagFound = modelStopTag(c, &matchPos);
+        }
+    }
+
+    if (c < 0) {
+        lengthRead = -1;
+    }
+
+    return lengthRead;
+}
+
+// Model of uAtClientReadBytes() as it behaves one character
+// at a time.  Returns -1 if the read would go beyond the
+// stop tag at the end of the model's data.
+static int32_t modelReadBytes(uAtClientTestReadModel_t *pModel,
+                              char *pBuffer, size_t lengthBytes,
+                              bool standalone)
+{
+    int32_t lengthRead = 0;
+    int32_t matchPos = 0;
+    int32_t c = 0;
+
+    while ((lengthRead < ((int32_t) lengthBytes + matchPos)) &&
+           !pModel->stopTagFound && (c >= 0)) {
+        c = modelReadChar(pModel);
+        if (c >= 0) {
+            if (modelStopTag(c, &matchPos)) {
+                pModel->stopTagFound = true;
+                lengthRead--;
+            }
+            if (!pModel->stopTagFound) {
+                *(pBuffer + lengthRead) = (char) c;
+                lengthRead++;
+            }
+        }
+    }
+
+    if (!standalone && (c >= 0)) {
+        c = 0;
+        while ((c >= 0) && (c != ',') && !pModel->stopTagFound) {
+            c = modelReadChar(pModel);
+            pModel->stopTagFound = modelStopTag(c, &matchPos);
+        }
+    }
+
+    if (c < 0) {
+        lengthRead = -1;
+    }
+
+    return lengthRead;
+}
+
+// Fill pBuffer with random characters for a response parameter,
+// mostly letters but with a good sprinkling of delimiters,
+// quotes and line-ending characters; "\r\n" is never included
+// since that would end the information response.
+static void randomParameter(char *pBuffer, size_t length)
+{
+    const char *pSpecial = ",\"\r\n";
+    char c;
+
+    for (size_t x = 0; x < length; x++) {
+        do {
+            if (rand() % 4 == 0) {
+                c = *(pSpecial + (rand() % 4));
+            } else {
+                c = (char) ('a' + (rand() % 26));
+            }
+        } while ((x > 0) && (*(pBuffer + x - 1) == '\r') && (c == '\n'));
+        *(pBuffer + x) = c;
+    }
+}
+
+// Send "+TEST:", the given parameter, and then the
+// rest of a response from the AT server end.
+static void sendTestResponse(const char *pParameter, size_t length)
+{
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, "+TEST:", 6) == 6);
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, pParameter,
+                                      length) == (int32_t) length);
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, "\r\nOK\r\n", 6) == 6);
+}
+
+// Send U_AT_CLIENT_TEST_TX_BUFFER_COMMAND, returning the
+// number of writes that were made to the stream.
+static size_t sendTxBufferCommand(uAtClientHandle_t atClientHandle)
+{
+    gInterceptTxCount = 0;
+    uAtClientLock(atClientHandle);
+    uAtClientCommandStart(atClientHandle, "AT+USOST=");
+    uAtClientWriteInt(atClientHandle, 0);
+    uAtClientWriteString(atClientHandle, "123.456.789.012", true);
+    uAtClientWriteInt(atClientHandle, 5000);
+    uAtClientWriteInt(atClientHandle, 10);
+    uAtClientWriteString(atClientHandle, "0123456789", true);
+    uAtClientCommandStop(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+
+    return gInterceptTxCount;
+}
+
+// An AT server which responds to each AT command with an
+// information response and "OK", or with "ERROR", as set in
+// gDelayServer, after the given delays.
+static void delayServerCallback(int32_t uartHandle, uint32_t eventBitmask,
+                                void *pParameters)
+{
+    char c;
+
+    (void) pParameters;
+
+    if (eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) {
+        while (uPortUartRead(uartHandle, &c, 1) > 0) {
+            if ((c == '\r') && (gDelayServer.firstByteDelayMs >= 0)) {
+                // End of a command, respond to it
+                uPortTaskBlock(gDelayServer.firstByteDelayMs);
+                if (gDelayServer.isError) {
+                    uPortUartWrite(uartHandle, "\r\n", 2);
+                    uPortTaskBlock(gDelayServer.totalDelayMs - gDelayServer.firstByteDelayMs);
+                    uPortUartWrite(uartHandle, "ERROR\r\n", 7);
+                } else {
+                    uPortUartWrite(uartHandle, "\r\n+TEST: ", 9);
+                    uPortTaskBlock(gDelayServer.totalDelayMs - gDelayServer.firstByteDelayMs);
+                    uPortUartWrite(uartHandle, "1\r\nOK\r\n", 7);
+                }
+            }
+        }
+    }
+}
+
+// Send an AT command to delayServerCallback(), which should
+// respond as set by the other parameters.
+static void sendDelayServerCommand(uAtClientHandle_t atClientHandle,
+                                   const char *pCommand,
+                                   int32_t firstByteDelayMs,
+                                   int32_t totalDelayMs, bool isError)
+{
+    gDelayServer.firstByteDelayMs = firstByteDelayMs;
+    gDelayServer.totalDelayMs = totalDelayMs;
+    gDelayServer.isError = isError;
+    uAtClientLock(atClientHandle);
+    uAtClientCommandStart(atClientHandle, pCommand);
+    uAtClientCommandStop(atClientHandle);
+    uAtClientResponseStart(atClientHandle, "+TEST:");
+    uAtClientReadInt(atClientHandle);
+    uAtClientResponseStop(atClientHandle);
+    uAtClientUnlock(atClientHandle);
+}
+
+// A deliberately slow AT client callback.
+static void slowCallback(uAtClientHandle_t atHandle, void *pParameter)
+{
+    (void) atHandle;
+    (void) pParameter;
+
+    uPortTaskBlock(U_AT_CLIENT_TEST_SLOW_CALLBACK_MS);
+    gSlowCallbackCount++;
+}
+
+// URC handler that queues slowCallback().
+static void slowUrcHandler(uAtClientHandle_t atHandle, void *pParameter)
+{
+    (void) pParameter;
+
+    uAtClientCallback(atHandle, slowCallback, NULL);
+}
+
+// An AT client callback that records when it was called.
+static void fastCallback(uAtClientHandle_t atHandle, void *pParameter)
+{
+    (void) atHandle;
+    (void) pParameter;
+
+    gFastCallbackTimeMs = uPortGetTickTimeMs();
+}
+
+// URC handler that queues fastCallback() at high priority.
+static void fastUrcHandler(uAtClientHandle_t atHandle, void *pParameter)
+{
+    (void) pParameter;
+
+    uAtClientCallbackPriority(atHandle, U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                              fastCallback, NULL);
+}
+
+// A simulated module that goes to sleep when it has received
+// nothing for U_AT_CLIENT_TEST_DEFERRED_SLEEP_AFTER_MS, after which
+// it ignores everything until woken by sleepyModuleWakeUp() or,
+// if wakesOnRx is set, it wakes up when it receives something,
+// taking U_AT_CLIENT_TEST_DEFERRED_WAKE_UP_MS to do so; while
+// awake it responds "OK" to every AT command.
+static void sleepyModuleCallback(int32_t uartHandle, uint32_t eventBitmask,
+                                 void *pParameters)
+{
+    char c;
+
+    (void) pParameters;
+
+    if (eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) {
+        while (uPortUartRead(uartHandle, &c, 1) > 0) {
+            if (gSleepyModule.sleeps && gSleepyModule.awake &&
+                (uPortGetTickTimeMs() - gSleepyModule.lastRxTimeMs >
+                 U_AT_CLIENT_TEST_DEFERRED_SLEEP_AFTER_MS)) {
+                gSleepyModule.awake = false;
+            }
+            if (!gSleepyModule.awake && gSleepyModule.wakesOnRx) {
+                uPortTaskBlock(U_AT_CLIENT_TEST_DEFERRED_WAKE_UP_MS);
+                gSleepyModule.awake = true;
+                gSleepyModule.numWakeUps++;
+            }
+            if (gSleepyModule.awake) {
+                gSleepyModule.lastRxTimeMs = uPortGetTickTimeMs();
+                if (c == '\r') {
+                    gSleepyModule.numCommands++;
+                    uPortUartWrite(uartHandle, "\r\nOK\r\n", 6);
+                }
+            } else if (c == '\r') {
+                gSleepyModule.numCommandsLost++;
+            }
+        }
+    }
+}
+
+// Wake-up handler for the simulated module: "toggle the pin",
+// wait for the module to wake up and check that it responds.
+static int32_t sleepyModuleWakeUp(uAtClientHandle_t atHandle, void *pParameter)
+{
+    (void) pParameter;
+
+    uPortTaskBlock(U_AT_CLIENT_TEST_DEFERRED_WAKE_UP_MS);
+    gSleepyModule.lastRxTimeMs = uPortGetTickTimeMs();
+    gSleepyModule.awake = true;
+    gSleepyModule.numWakeUps++;
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT");
+    uAtClientCommandStopReadResponse(atHandle);
+    return uAtClientUnlock(atHandle);
+}
+
+// Deferred callback that takes a while to finish.
+static void deferredSlowCallback(uAtClientHandle_t atHandle, void *pParameter)
+{
+    (void) atHandle;
+    (void) pParameter;
+    gDeferredSlowRunning = true;
+    uPortTaskBlock(500);
+    gDeferredSlowRunning = false;
+}
+
+// Deferred callback that counts how often it is called.
+static void deferredCountCallback(uAtClientHandle_t atHandle, void *pParameter)
+{
+    (void) atHandle;
+    (void) pParameter;
+    gDeferredCount++;
+}
+
+// Send the command of an item of the telemetry schedule and
+// defer the next one.
+static void telemetryCallback(uAtClientHandle_t atHandle, void *pParameter)
+{
+    uAtClientTestTelemetry_t *pTelemetry = (uAtClientTestTelemetry_t *) pParameter;
+    int32_t latencyMs = uPortGetTickTimeMs() - pTelemetry->dueTimeMs;
+    int32_t notBeforeMs;
+
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, pTelemetry->pCommand);
+    uAtClientCommandStopReadResponse(atHandle);
+    if (uAtClientUnlock(atHandle) != 0) {
+        pTelemetry->errorCode = uAtClientErrorGet(atHandle);
+        if (pTelemetry->errorCode == 0) {
+            pTelemetry->errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+        }
+    }
+    pTelemetry->count++;
+    pTelemetry->latencyTotalMs += latencyMs;
+    if (latencyMs > pTelemetry->latencyMaxMs) {
+        pTelemetry->latencyMaxMs = latencyMs;
+    }
+    pTelemetry->dueTimeMs += pTelemetry->periodMs;
+    if (gTelemetryOn) {
+        notBeforeMs = pTelemetry->dueTimeMs - uPortGetTickTimeMs();
+        if (notBeforeMs < 0) {
+            notBeforeMs = 0;
+        }
+        uAtClientDeferredAdd(atHandle, telemetryCallback, pTelemetry,
+                             notBeforeMs, notBeforeMs + pTelemetry->slackMs);
+    }
+}
+
+// Run the telemetry schedule for U_AT_CLIENT_TEST_DEFERRED_RUN_MS
+// with the given slack, as a fraction of the period of each item
+// (zero to send each command as soon as it is due), print the
+// results and return the number of wake-ups of the module.
+static int32_t telemetryRun(uAtClientHandle_t atHandle, int32_t slackDivisor)
+{
+    bool sleeps = gSleepyModule.sleeps;
+    bool wakesOnRx = gSleepyModule.wakesOnRx;
+    uAtClientWakeUpStats_t stats;
+    int32_t startTimeMs;
+    int32_t latencyTotalMs = 0;
+    int32_t latencyMaxMs = 0;
+    int32_t numCommands = 0;
+    int32_t numWakeUpsPerHour;
+
+    // Let the module go to sleep from any previous run
+    uPortTaskBlock(U_AT_CLIENT_TEST_DEFERRED_SLEEP_AFTER_MS * 2);
+    memset(&gSleepyModule, 0, sizeof(gSleepyModule));
+    gSleepyModule.sleeps = sleeps;
+    gSleepyModule.wakesOnRx = wakesOnRx;
+    gSleepyModule.awake = !sleeps;
+    uAtClientWakeUpStatsReset(atHandle);
+
+    gTelemetryOn = true;
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < sizeof(gTelemetry) / sizeof(gTelemetry[0]); x++) {
+        gTelemetry[x].slackMs = 0;
+        if (slackDivisor > 0) {
+            gTelemetry[x].slackMs = gTelemetry[x].periodMs / slackDivisor;
+        }
+        gTelemetry[x].dueTimeMs = startTimeMs + gTelemetry[x].phaseMs;
+        gTelemetry[x].count = 0;
+        gTelemetry[x].latencyTotalMs = 0;
+        gTelemetry[x].latencyMaxMs = 0;
+        gTelemetry[x].errorCode = 0;
+        U_PORT_TEST_ASSERT(uAtClientDeferredAdd(atHandle, telemetryCallback, &(gTelemetry[x]),
+                                                gTelemetry[x].phaseMs,
+                                                gTelemetry[x].phaseMs +
+                                                gTelemetry[x].slackMs) == 0);
+    }
+    uPortTaskBlock(U_AT_CLIENT_TEST_DEFERRED_RUN_MS);
+    gTelemetryOn = false;
+    for (size_t x = 0; x < sizeof(gTelemetry) / sizeof(gTelemetry[0]); x++) {
+        U_PORT_TEST_ASSERT(uAtClientDeferredRemove(atHandle, telemetryCallback,
+                                                   &(gTelemetry[x])) <= 1);
+    }
+    // Let anything that was already running finish
+    uPortTaskBlock(500);
+    U_PORT_TEST_ASSERT(uAtClientWakeUpStatsGet(atHandle, &stats) == 0);
+
+    for (size_t x = 0; x < sizeof(gTelemetry) / sizeof(gTelemetry[0]); x++) {
+        U_PORT_TEST_ASSERT(gTelemetry[x].count > 0);
+        U_TEST_PRINT_LINE("  %-14s every %4d ms, slack %4d ms: sent %3d, latency"
+                          " average %3d ms, max %3d ms.", gTelemetry[x].pCommand,
+                          gTelemetry[x].periodMs, gTelemetry[x].slackMs,
+                          gTelemetry[x].count,
+                          gTelemetry[x].latencyTotalMs / gTelemetry[x].count,
+                          gTelemetry[x].latencyMaxMs);
+        U_PORT_TEST_ASSERT(gTelemetry[x].errorCode == 0);
+        U_PORT_TEST_ASSERT(gTelemetry[x].count >= U_AT_CLIENT_TEST_DEFERRED_RUN_MS /
+                           gTelemetry[x].periodMs - 1);
+        numCommands += gTelemetry[x].count;
+        latencyTotalMs += gTelemetry[x].latencyTotalMs;
+        if (gTelemetry[x].latencyMaxMs > latencyMaxMs) {
+            latencyMaxMs = gTelemetry[x].latencyMaxMs;
+        }
+    }
+    numWakeUpsPerHour = (int32_t) (((int64_t) gSleepyModule.numWakeUps * 3600 * 1000) /
+                                   ((int64_t) U_AT_CLIENT_TEST_DEFERRED_RUN_MS *
+                                    U_AT_CLIENT_TEST_DEFERRED_TIME_SCALE));
+    U_TEST_PRINT_LINE("  %d command(s), %d wake-up(s) (%d per hour real time), wake-up"
+                      " taking %d ms on average, awake %d%% of the time, latency"
+                      " average %d ms (%d ms real time), max %d ms (%d ms real time).",
+                      numCommands, gSleepyModule.numWakeUps, numWakeUpsPerHour,
+                      stats.numWakeUps > 0 ? stats.wakeUpDurationTotalMs / stats.numWakeUps : 0,
+                      (stats.awakeTotalMs * 100) / U_AT_CLIENT_TEST_DEFERRED_RUN_MS,
+                      latencyTotalMs / numCommands,
+                      (latencyTotalMs / numCommands) * U_AT_CLIENT_TEST_DEFERRED_TIME_SCALE,
+                      latencyMaxMs, latencyMaxMs * U_AT_CLIENT_TEST_DEFERRED_TIME_SCALE);
+    U_TEST_PRINT_LINE("  the AT client ran %d deferred callback(s), %d late.",
+                      stats.numDeferred, stats.numDeferredLate);
+
+    // The module should never have been spoken to while asleep
+    // and, unless it wakes itself up, its count of wake-ups
+    // should match the AT client's
+    U_PORT_TEST_ASSERT(gSleepyModule.numCommandsLost == 0);
+    U_PORT_TEST_ASSERT(gSleepyModule.numWakeUps > 0);
+    U_PORT_TEST_ASSERT(stats.numWakeUpFailures == 0);
+    U_PORT_TEST_ASSERT(stats.numDeferred == numCommands);
+    if (wakesOnRx) {
+        U_PORT_TEST_ASSERT(stats.numWakeUps == 0);
+    } else {
+        U_PORT_TEST_ASSERT(gSleepyModule.numWakeUps == stats.numWakeUps);
+        U_PORT_TEST_ASSERT(stats.awakeTotalMs > 0);
+    }
+
+    return gSleepyModule.numWakeUps;
+}
+
 # endif
 #endif
 
@@ -1043,6 +1800,88 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientInitialisation")
     uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
 }
 
+/** Test the conversion functions for views, which need no UART.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientViewConvert")
+{
+    uAtClientView_t view;
+    int32_t x;
+    uint32_t address;
+    char buffer[4];
+
+    view.pData = "12345";
+    view.length = 5;
+    U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) == 0);
+    U_PORT_TEST_ASSERT(x == 12345);
+    // Only the first three characters
+    view.length = 3;
+    U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) == 0);
+    U_PORT_TEST_ASSERT(x == 123);
+    view.pData = "-42";
+    view.length = 3;
+    U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) == 0);
+    U_PORT_TEST_ASSERT(x == -42);
+    view.pData = "+7";
+    view.length = 2;
+    U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) == 0);
+    U_PORT_TEST_ASSERT(x == 7);
+    view.pData = "99999999999";
+    view.length = 11;
+    U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) == 0);
+    U_PORT_TEST_ASSERT(x == INT32_MAX);
+    view.pData = "-99999999999";
+    view.length = 12;
+    U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) == 0);
+    U_PORT_TEST_ASSERT(x == INT32_MIN);
+    view.pData = "12a";
+    view.length = 3;
+    U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) < 0);
+    view.pData = "-";
+    view.length = 1;
+    U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) < 0);
+    view.length = 0;
+    U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) < 0);
+
+    view.pData = "0aFf10";
+    view.length = 6;
+    U_PORT_TEST_ASSERT(uAtClientViewHexToBin(&view, buffer, sizeof(buffer)) == 3);
+    U_PORT_TEST_ASSERT(memcmp(buffer, "\x0a\xff\x10", 3) == 0);
+    // Stops when the buffer is full
+    U_PORT_TEST_ASSERT(uAtClientViewHexToBin(&view, buffer, 2) == 2);
+    // Stops at anything that isn't hex, ignores an odd character
+    view.pData = "01g2";
+    view.length = 4;
+    U_PORT_TEST_ASSERT(uAtClientViewHexToBin(&view, buffer, sizeof(buffer)) == 1);
+    view.pData = "123";
+    view.length = 3;
+    U_PORT_TEST_ASSERT(uAtClientViewHexToBin(&view, buffer, sizeof(buffer)) == 1);
+    U_PORT_TEST_ASSERT(buffer[0] == 0x12);
+
+    view.pData = "192.168.1.255";
+    view.length = 13;
+    U_PORT_TEST_ASSERT(uAtClientViewToIpV4(&view, &address) == 0);
+    U_PORT_TEST_ASSERT(address == 0xc0a801ff);
+    view.pData = "1.2.3.4,";
+    view.length = 7;
+    U_PORT_TEST_ASSERT(uAtClientViewToIpV4(&view, &address) == 0);
+    U_PORT_TEST_ASSERT(address == 0x01020304);
+    view.length = 8;
+    U_PORT_TEST_ASSERT(uAtClientViewToIpV4(&view, &address) < 0);
+    view.pData = "1.2.3";
+    view.length = 5;
+    U_PORT_TEST_ASSERT(uAtClientViewToIpV4(&view, &address) < 0);
+    view.pData = "1.2.3.4.5";
+    view.length = 9;
+    U_PORT_TEST_ASSERT(uAtClientViewToIpV4(&view, &address) < 0);
+    view.pData = "1.2.256.4";
+    view.length = 9;
+    U_PORT_TEST_ASSERT(uAtClientViewToIpV4(&view, &address) < 0);
+    view.pData = "1..3.4";
+    view.length = 6;
+    U_PORT_TEST_ASSERT(uAtClientViewToIpV4(&view, &address) < 0);
+    U_PORT_TEST_ASSERT(address == 0x01020304);
+}
+
 #if (U_CFG_TEST_UART_A >= 0)
 /** Add an AT client then try getting and setting all of the
  * configuration items.  Requires one UART with no
@@ -1725,6 +2564,927 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet2")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Test the transmit assembly buffer: check that a command with
+ * several parameters goes to the stream as a single write with
+ * the buffer on, as many writes with it off, that a long
+ * standalone write bypasses the buffer and, for information,
+ * time a run of short commands each way.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientTxBuffer")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientStreamHandle_t stream = U_AT_CLIENT_STREAM_HANDLE_DEFAULTS;
+    const size_t commandLength = strlen(U_AT_CLIENT_TEST_TX_BUFFER_COMMAND);
+    char *pBytes;
+    size_t numWrites;
+    int32_t startTimeMs;
+    int32_t durationMs[2];
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Set up everything with the two UARTs
+    twoUartsPreamble();
+
+    // The far end just soaks up whatever it is sent
+    gSinkLength = 0;
+    U_PORT_TEST_ASSERT(uPortUartEventCallbackSet(gUartBHandle,
+                                                 U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                 sinkServerCallback, NULL,
+                                                 U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                 U_AT_CLIENT_URC_TASK_PRIORITY) == 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    U_TEST_PRINT_LINE("adding an AT client on UART %d...", U_CFG_TEST_UART_A);
+    stream.handle.int32 = gUartAHandle;
+    stream.type = U_AT_CLIENT_STREAM_TYPE_UART;
+    atClientHandle = uAtClientAddExt(&stream, NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    // Use an intercept function to count the writes
+    uAtClientStreamInterceptTx(atClientHandle, pInterceptTxCount, NULL);
+
+    U_PORT_TEST_ASSERT(uAtClientTxBufferGet(atClientHandle) ==
+                       (U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES > 0));
+
+    if (U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES >= commandLength) {
+        U_TEST_PRINT_LINE("sending a command with the transmit buffer on...");
+        gSinkLength = 0;
+        numWrites = sendTxBufferCommand(atClientHandle);
+        U_TEST_PRINT_LINE("%d write(s) made.", (int) numWrites);
+        U_PORT_TEST_ASSERT(numWrites == 1);
+        U_PORT_TEST_ASSERT(sinkWait(commandLength));
+        U_PORT_TEST_ASSERT(memcmp(gAtServerBuffer, U_AT_CLIENT_TEST_TX_BUFFER_COMMAND,
+                                  commandLength) == 0);
+
+        U_TEST_PRINT_LINE("sending %d bytes standalone, which should bypass"
+                          " the transmit buffer...",
+                          (int) U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES + 1);
+        pBytes = (char *) pUPortMalloc(U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES + 1);
+        U_PORT_TEST_ASSERT(pBytes != NULL);
+        for (size_t x = 0; x < U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES + 1; x++) {
+            *(pBytes + x) = (char) x;
+        }
+        gSinkLength = 0;
+        gInterceptTxCount = 0;
+        uAtClientLock(atClientHandle);
+        U_PORT_TEST_ASSERT(uAtClientWriteBytes(atClientHandle, pBytes,
+                                               U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES + 1,
+                                               true) == U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES + 1);
+        U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+        U_PORT_TEST_ASSERT(gInterceptTxCount == 1);
+        U_PORT_TEST_ASSERT(sinkWait(U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES + 1));
+        U_PORT_TEST_ASSERT(memcmp(gAtServerBuffer, pBytes,
+                                  U_AT_CLIENT_TX_BUFFER_LENGTH_BYTES + 1) == 0);
+        uPortFree(pBytes);
+    }
+
+    U_TEST_PRINT_LINE("sending a command with the transmit buffer off...");
+    uAtClientTxBufferSet(atClientHandle, false);
+    U_PORT_TEST_ASSERT(!uAtClientTxBufferGet(atClientHandle));
+    gSinkLength = 0;
+    numWrites = sendTxBufferCommand(atClientHandle);
+    U_TEST_PRINT_LINE("%d write(s) made.", (int) numWrites);
+    U_PORT_TEST_ASSERT(numWrites == U_AT_CLIENT_TEST_TX_BUFFER_NUM_WRITES_UNBUFFERED);
+    U_PORT_TEST_ASSERT(sinkWait(commandLength));
+    U_PORT_TEST_ASSERT(memcmp(gAtServerBuffer, U_AT_CLIENT_TEST_TX_BUFFER_COMMAND,
+                              commandLength) == 0);
+
+    // Now time a run of commands each way; this is for
+    // information only, nothing is asserted as the timing
+    // depends very much on the platform
+    for (size_t x = 0; x < sizeof(durationMs) / sizeof(durationMs[0]); x++) {
+        uAtClientTxBufferSet(atClientHandle, x > 0);
+        gSinkLength = 0;
+        numWrites = 0;
+        startTimeMs = uPortGetTickTimeMs();
+        for (size_t y = 0; y < U_AT_CLIENT_TEST_TX_BUFFER_ITERATIONS; y++) {
+            numWrites += sendTxBufferCommand(atClientHandle);
+        }
+        U_PORT_TEST_ASSERT(sinkWait(commandLength * U_AT_CLIENT_TEST_TX_BUFFER_ITERATIONS));
+        durationMs[x] = uPortGetTickTimeMs() - startTimeMs;
+        U_TEST_PRINT_LINE("transmit buffer %s: %d commands, %d write(s),"
+                          " took %d ms.", uAtClientTxBufferGet(atClientHandle) ? "on" : "off",
+                          U_AT_CLIENT_TEST_TX_BUFFER_ITERATIONS, (int) numWrites, (int) durationMs[x]);
+    }
+
+    U_TEST_PRINT_LINE("removing AT client...");
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test reading strings and bytes: uAtClientReadString() and
+ * uAtClientReadBytes() copy whole runs of characters out of the
+ * receive buffer at a time, so check them against a model of
+ * the character-by-character behaviour using random responses
+ * and, for information, time reading longer binary and quoted
+ * string parameters.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientRead")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientStreamHandle_t stream = U_AT_CLIENT_STREAM_HANDLE_DEFAULTS;
+    uAtClientTestReadModel_t model;
+    uAtClientTestReadModel_t modelCopy;
+    char *pParameter;
+    char *pBuffer;
+    char *pBufferModel;
+    size_t length;
+    size_t lengthBytes;
+    int32_t readOperation;
+    int32_t lengthRead;
+    int32_t lengthExpected;
+    size_t numReads = 0;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Set up everything with the two UARTs; the
+    // AT server end is driven directly from here
+    twoUartsPreamble();
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    U_TEST_PRINT_LINE("adding an AT client on UART %d...", U_CFG_TEST_UART_A);
+    stream.handle.int32 = gUartAHandle;
+    stream.type = U_AT_CLIENT_STREAM_TYPE_UART;
+    atClientHandle = uAtClientAddExt(&stream, NULL,
+                                     U_AT_CLIENT_TEST_READ_TIMING_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    uAtClientTimeoutSet(atClientHandle, U_AT_CLIENT_TEST_AT_TIMEOUT_MS);
+
+    // Room for the parameter plus the stop tag, for the model
+    pParameter = (char *) pUPortMalloc(U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES + 2);
+    U_PORT_TEST_ASSERT(pParameter != NULL);
+    // Leave room for a terminator and an over-read
+    // of a partially-matched stop tag
+    pBuffer = (char *) pUPortMalloc(U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES + 4);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+    pBufferModel = (char *) pUPortMalloc(U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES + 4);
+    U_PORT_TEST_ASSERT(pBufferModel != NULL);
+
+    U_TEST_PRINT_LINE("checking %d random responses against the model...",
+                      U_AT_CLIENT_TEST_READ_ITERATIONS);
+    for (size_t x = 0; x < U_AT_CLIENT_TEST_READ_ITERATIONS; x++) {
+        length = 1 + (rand() % U_AT_CLIENT_TEST_READ_MAX_LENGTH_BYTES);
+        randomParameter(pParameter, length);
+        memcpy(pParameter + length, "\r\n", 2);
+        memset(&model, 0, sizeof(model));
+        model.pData = pParameter;
+        model.length = length + 2;
+        uAtClientLock(atClientHandle);
+        sendTestResponse(pParameter, length);
+        U_PORT_TEST_ASSERT(uAtClientResponseStart(atClientHandle, "+TEST:") == 0);
+        lengthExpected = 0;
+        while (!model.stopTagFound && (lengthExpected >= 0)) {
+            lengthBytes = 1 + (rand() % U_AT_CLIENT_TEST_READ_MAX_READ_BYTES);
+            readOperation = rand() % 3;
+            // Run the model first, on a copy, in order to avoid
+            // asking the AT client to read beyond the end of
+            // the response, which it would do if it started
+            // part-way through a quoted string
+            modelCopy = model;
+            if (readOperation == 0) {
+                lengthExpected = modelReadString(&modelCopy, pBufferModel, lengthBytes);
+            } else {
+                lengthExpected = modelReadBytes(&modelCopy, pBufferModel, lengthBytes,
+                                                readOperation == 1);
+            }
+            if (lengthExpected >= 0) {
+                model = modelCopy;
+                if (readOperation == 0) {
+                    lengthRead = uAtClientReadString(atClientHandle, pBuffer,
+                                                     lengthBytes, false);
+                    if (lengthRead >= 0) {
+                        // Include the terminator in the check
+                        lengthRead++;
+                        lengthExpected++;
+                    }
+                } else {
+                    lengthRead = uAtClientReadBytes(atClientHandle, pBuffer,
+                                                    lengthBytes, readOperation == 1);
+                }
+                numReads++;
+                if ((lengthRead != lengthExpected) ||
+                    (memcmp(pBuffer, pBufferModel, lengthRead) != 0)) {
+                    U_TEST_PRINT_LINE("response %d, read operation %d of %d"
+                                      " byte(s) returned %d, expected %d.",
+                                      x + 1, readOperation, lengthBytes,
+                                      lengthRead, lengthExpected);
+                    U_PORT_TEST_ASSERT(false);
+                }
+            }
+        }
+        uAtClientResponseStop(atClientHandle);
+        U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+    }
+    U_TEST_PRINT_LINE("%d read(s) matched the model.", numReads);
+
+    // Now time reading a long binary parameter and a long quoted
+    // string parameter, with the response already received in
+    // full so that it is the AT client that is being timed;
+    // this is for information only, nothing is asserted as the
+    // timing depends very much on the platform
+    for (size_t x = 0; x < 2; x++) {
+        if (x == 0) {
+            for (size_t y = 0; y < U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES; y++) {
+                *(pParameter + y) = (char) ('a' + (y % 26));
+            }
+        } else {
+            randomParameter(pParameter, U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES);
+            // Quote it, with no quotes inside
+            for (size_t y = 0; y < U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES; y++) {
+                if (*(pParameter + y) == '\"') {
+                    *(pParameter + y) = ',';
+                }
+            }
+            *pParameter = '\"';
+            *(pParameter + U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES - 1) = '\"';
+        }
+        durationMs = 0;
+        for (size_t y = 0; y < U_AT_CLIENT_TEST_READ_TIMING_ITERATIONS; y++) {
+            uAtClientLock(atClientHandle);
+            sendTestResponse(pParameter, U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES);
+            startTimeMs = uPortGetTickTimeMs();
+            while ((uPortUartGetReceiveSize(gUartAHandle) <
+                    U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES + 12) &&
+                   (uPortGetTickTimeMs() - startTimeMs < U_AT_CLIENT_TEST_AT_TIMEOUT_MS)) {
+                uPortTaskBlock(1);
+            }
+            U_PORT_TEST_ASSERT(uAtClientResponseStart(atClientHandle, "+TEST:") == 0);
+            startTimeMs = uPortGetTickTimeMs();
+            if (x == 0) {
+                lengthRead = uAtClientReadBytes(atClientHandle, pBuffer,
+                                                U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES,
+                                                true);
+                U_PORT_TEST_ASSERT(lengthRead == U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES);
+            } else {
+                lengthRead = uAtClientReadString(atClientHandle, pBuffer,
+                                                 U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES,
+                                                 false);
+                U_PORT_TEST_ASSERT(lengthRead == U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES - 2);
+            }
+            durationMs += uPortGetTickTimeMs() - startTimeMs;
+            uAtClientResponseStop(atClientHandle);
+            U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+        }
+        U_TEST_PRINT_LINE("reading %s: %d byte(s) took %d ms.",
+                          (x == 0) ? "binary" : "quoted strings",
+                          U_AT_CLIENT_TEST_READ_TIMING_LENGTH_BYTES *
+                          U_AT_CLIENT_TEST_READ_TIMING_ITERATIONS, durationMs);
+    }
+
+    uPortFree(pBufferModel);
+    uPortFree(pBuffer);
+    uPortFree(pParameter);
+
+    U_TEST_PRINT_LINE("removing AT client...");
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test that an AT client with a callback executor of its own
+ * is not held up by the slow callbacks of another AT client.
+ * The two ends of the UART loop-back are both AT clients, as if
+ * they were two modules.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientCallbackExecutor")
+{
+    uAtClientHandle_t atClientHandleA;
+    uAtClientHandle_t atClientHandleB;
+    uAtClientStreamHandle_t stream = U_AT_CLIENT_STREAM_HANDLE_DEFAULTS;
+    uAtClientCallbackStats_t stats;
+    uAtClientCallbackStats_t statsHigh;
+    size_t stackSizeBytes = 0;
+    int32_t taskPriority = 0;
+    size_t queueLength = 0;
+    int32_t startTimeMs;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Set up everything with the two UARTs
+    twoUartsPreamble();
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    U_TEST_PRINT_LINE("adding an AT client on UART %d...", U_CFG_TEST_UART_A);
+    stream.handle.int32 = gUartAHandle;
+    stream.type = U_AT_CLIENT_STREAM_TYPE_UART;
+    atClientHandleA = uAtClientAddExt(&stream, NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandleA != NULL);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleA, "+SLOW:",
+                                              slowUrcHandler, NULL) == 0);
+
+    U_TEST_PRINT_LINE("adding an AT client on UART %d...", U_CFG_TEST_UART_B);
+    stream.handle.int32 = gUartBHandle;
+    atClientHandleB = uAtClientAddExt(&stream, NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandleB != NULL);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandleB, "+FAST:",
+                                              fastUrcHandler, NULL) == 0);
+
+    // Neither AT client has an executor of its own yet
+    U_PORT_TEST_ASSERT(uAtClientCallbackExecutorGet(atClientHandleA,
+                                                    U_AT_CLIENT_CALLBACK_PRIORITY_NORMAL,
+                                                    NULL, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uAtClientCallbackExecutorGet(atClientHandleB,
+                                                    U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                                                    NULL, NULL, NULL) < 0);
+
+    U_TEST_PRINT_LINE("giving the AT client on UART %d its own executor...",
+                      U_CFG_TEST_UART_B);
+    U_PORT_TEST_ASSERT(uAtClientCallbackExecutorSet(atClientHandleB,
+                                                    U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                                                    U_AT_CLIENT_CALLBACK_TASK_STACK_SIZE_BYTES,
+                                                    U_AT_CLIENT_CALLBACK_TASK_PRIORITY,
+                                                    U_AT_CLIENT_TEST_CALLBACK_QUEUE_LENGTH) == 0);
+    // Can only be done once
+    U_PORT_TEST_ASSERT(uAtClientCallbackExecutorSet(atClientHandleB,
+                                                    U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                                                    U_AT_CLIENT_CALLBACK_TASK_STACK_SIZE_BYTES,
+                                                    U_AT_CLIENT_CALLBACK_TASK_PRIORITY,
+                                                    U_AT_CLIENT_TEST_CALLBACK_QUEUE_LENGTH) < 0);
+    U_PORT_TEST_ASSERT(uAtClientCallbackExecutorGet(atClientHandleB,
+                                                    U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                                                    &stackSizeBytes, &taskPriority,
+                                                    &queueLength) == 0);
+    U_PORT_TEST_ASSERT(stackSizeBytes == U_AT_CLIENT_CALLBACK_TASK_STACK_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(taskPriority == U_AT_CLIENT_CALLBACK_TASK_PRIORITY);
+    U_PORT_TEST_ASSERT(queueLength == U_AT_CLIENT_TEST_CALLBACK_QUEUE_LENGTH);
+    // The normal priority lane of B should still be the shared executor
+    U_PORT_TEST_ASSERT(uAtClientCallbackExecutorGet(atClientHandleB,
+                                                    U_AT_CLIENT_CALLBACK_PRIORITY_NORMAL,
+                                                    NULL, NULL, NULL) < 0);
+
+    U_TEST_PRINT_LINE("sending %d slow URC(s) to the AT client on UART %d...",
+                      U_AT_CLIENT_TEST_SLOW_URC_NUM, U_CFG_TEST_UART_A);
+    gSlowCallbackCount = 0;
+    gFastCallbackTimeMs = -1;
+    for (size_t x = 0; x < U_AT_CLIENT_TEST_SLOW_URC_NUM; x++) {
+        U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, "\r\n+SLOW:\r\n", 10) == 10);
+    }
+    // Give the slow callbacks time to get going
+    uPortTaskBlock(U_AT_CLIENT_TEST_SLOW_CALLBACK_MS / 5);
+
+    U_TEST_PRINT_LINE("sending a fast URC to the AT client on UART %d...",
+                      U_CFG_TEST_UART_B);
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartAHandle, "\r\n+FAST:\r\n", 10) == 10);
+    while ((gFastCallbackTimeMs < 0) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_AT_CLIENT_TEST_SLOW_CALLBACK_MS *
+            (U_AT_CLIENT_TEST_SLOW_URC_NUM + 1))) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gFastCallbackTimeMs >= 0);
+    U_TEST_PRINT_LINE("fast callback arrived after %d ms, %d slow callback(s)"
+                      " completed by then.", gFastCallbackTimeMs - startTimeMs,
+                      gSlowCallbackCount);
+    U_PORT_TEST_ASSERT(gFastCallbackTimeMs - startTimeMs < U_AT_CLIENT_TEST_FAST_CALLBACK_MAX_MS);
+    U_PORT_TEST_ASSERT(gSlowCallbackCount < U_AT_CLIENT_TEST_SLOW_URC_NUM);
+
+    // Wait for the slow callbacks to complete
+    startTimeMs = uPortGetTickTimeMs();
+    while ((gSlowCallbackCount < U_AT_CLIENT_TEST_SLOW_URC_NUM) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_AT_CLIENT_TEST_SLOW_CALLBACK_MS *
+            (U_AT_CLIENT_TEST_SLOW_URC_NUM + 1))) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gSlowCallbackCount == U_AT_CLIENT_TEST_SLOW_URC_NUM);
+    // Let the executor note the statistics of the last one
+    uPortTaskBlock(100);
+
+    // The normal priority lane of A is the shared executor
+    U_PORT_TEST_ASSERT(uAtClientCallbackStatsGet(atClientHandleA,
+                                                 U_AT_CLIENT_CALLBACK_PRIORITY_NORMAL,
+                                                 &stats) == 0);
+    U_TEST_PRINT_LINE("shared executor: %d callback(s), max %d ms, total %d ms,"
+                      " queue high water mark %d of %d.", stats.numCallbacks,
+                      stats.durationMaxMs, stats.durationTotalMs,
+                      (int) stats.queueHighWaterMark, (int) stats.queueLength);
+    U_PORT_TEST_ASSERT(stats.numCallbacks == U_AT_CLIENT_TEST_SLOW_URC_NUM);
+    U_PORT_TEST_ASSERT(stats.durationMaxMs >= U_AT_CLIENT_TEST_SLOW_CALLBACK_MS);
+    U_PORT_TEST_ASSERT(stats.durationTotalMs >= U_AT_CLIENT_TEST_SLOW_CALLBACK_MS *
+                       U_AT_CLIENT_TEST_SLOW_URC_NUM);
+    U_PORT_TEST_ASSERT(stats.queueHighWaterMark > 0);
+    U_PORT_TEST_ASSERT(stats.queueHighWaterMark <= stats.queueLength);
+    // A NULL AT handle should give the same
+    U_PORT_TEST_ASSERT(uAtClientCallbackStatsGet(NULL,
+                                                 U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                                                 &statsHigh) == 0);
+    U_PORT_TEST_ASSERT(statsHigh.numCallbacks == stats.numCallbacks);
+    if (stats.stackMinFreeBytes != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_PORT_TEST_ASSERT(stats.stackMinFreeBytes > 0);
+    }
+
+    // The high priority lane of B is its own
+    U_PORT_TEST_ASSERT(uAtClientCallbackStatsGet(atClientHandleB,
+                                                 U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                                                 &statsHigh) == 0);
+    U_TEST_PRINT_LINE("executor of the AT client on UART %d: %d callback(s),"
+                      " max %d ms, queue high water mark %d of %d.",
+                      U_CFG_TEST_UART_B, statsHigh.numCallbacks,
+                      statsHigh.durationMaxMs, (int) statsHigh.queueHighWaterMark,
+                      (int) statsHigh.queueLength);
+    U_PORT_TEST_ASSERT(statsHigh.numCallbacks == 1);
+    U_PORT_TEST_ASSERT(statsHigh.durationMaxMs < U_AT_CLIENT_TEST_FAST_CALLBACK_MAX_MS);
+    U_PORT_TEST_ASSERT(statsHigh.queueHighWaterMark == 1);
+    U_PORT_TEST_ASSERT(statsHigh.queueLength == U_AT_CLIENT_TEST_CALLBACK_QUEUE_LENGTH);
+    if (statsHigh.stackMinFreeBytes != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_PORT_TEST_ASSERT(statsHigh.stackMinFreeBytes > 0);
+    }
+
+    U_TEST_PRINT_LINE("removing AT clients...");
+    uAtClientRemove(atClientHandleB);
+    uAtClientRemove(atClientHandleA);
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test the AT command statistics: an AT server on the far end
+ * of the UART loop-back responds after known delays, which should
+ * appear in the right bins of the latency histograms.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandStats")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientStreamHandle_t stream = U_AT_CLIENT_STREAM_HANDLE_DEFAULTS;
+    uAtClientCommandStats_t *pStats;
+    char *pCsv;
+    int32_t length;
+    int32_t y;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Set up everything with the two UARTs
+    twoUartsPreamble();
+
+    // The far end is the AT server
+    U_PORT_TEST_ASSERT(uPortUartEventCallbackSet(gUartBHandle,
+                                                 U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                 delayServerCallback, NULL,
+                                                 U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                 U_AT_CLIENT_URC_TASK_PRIORITY) == 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    U_TEST_PRINT_LINE("adding an AT client on UART %d...", U_CFG_TEST_UART_A);
+    stream.handle.int32 = gUartAHandle;
+    stream.type = U_AT_CLIENT_STREAM_TYPE_UART;
+    atClientHandle = uAtClientAddExt(&stream, NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    uAtClientTimeoutSet(atClientHandle, U_AT_CLIENT_TEST_COMMAND_STATS_TIMEOUT_MS);
+
+    pStats = (uAtClientCommandStats_t *) pUPortMalloc(sizeof(*pStats) * 4);
+    U_PORT_TEST_ASSERT(pStats != NULL);
+
+    // Statistics are off by default
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsMaxNumGet(atClientHandle) ==
+                       (int32_t) U_ERROR_COMMON_NOT_INITIALISED);
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsGet(atClientHandle, pStats, 4) ==
+                       (int32_t) U_ERROR_COMMON_NOT_INITIALISED);
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsCsv(atClientHandle, NULL, 0) ==
+                       (int32_t) U_ERROR_COMMON_NOT_INITIALISED);
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsStart(atClientHandle, 0) < 0);
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsStart(atClientHandle, 3) == 0);
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsMaxNumGet(atClientHandle) == 3);
+
+    // The delays are chosen to leave some tens of milliseconds of
+    // margin for UART latency at either side of the expected bin.
+    // First byte in bin 7 (64 to 127 ms), total in bin 9 (256 to 511 ms)
+    U_TEST_PRINT_LINE("sending commands that succeed...");
+    sendDelayServerCommand(atClientHandle, "AT+TEST1=1", 75, 360, false);
+    sendDelayServerCommand(atClientHandle, "AT+TEST1=2,3", 75, 360, false);
+    // First byte in bin 8 (128 to 255 ms), total in bin 8
+    U_TEST_PRINT_LINE("sending a command that fails...");
+    sendDelayServerCommand(atClientHandle, "AT+TEST2?", 150, 190, true);
+    // Total in bin 10 (512 to 1023 ms)
+    U_TEST_PRINT_LINE("sending a command that times out...");
+    sendDelayServerCommand(atClientHandle, "AT+TEST3", -1, 0, false);
+    // The table is now full so this should not be recorded
+    sendDelayServerCommand(atClientHandle, "AT+TEST4", 0, 0, false);
+
+    length = uAtClientCommandStatsCsv(atClientHandle, NULL, 0);
+    U_TEST_PRINT_LINE("statistics are %d byte(s) of CSV.", length);
+    U_PORT_TEST_ASSERT(length > 0);
+    pCsv = (char *) pUPortMalloc(length + 1);
+    U_PORT_TEST_ASSERT(pCsv != NULL);
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsCsv(atClientHandle, pCsv, length + 1) == length);
+    U_PORT_TEST_ASSERT(strlen(pCsv) == (size_t) length);
+    uPortLog("%s", pCsv);
+    U_PORT_TEST_ASSERT(strstr(pCsv, "\"AT+TEST1=\",2,0,0,") != NULL);
+    U_PORT_TEST_ASSERT(strstr(pCsv, "\"AT+TEST2?\",1,1,0,") != NULL);
+    U_PORT_TEST_ASSERT(strstr(pCsv, "\"AT+TEST3\",1,0,1,") != NULL);
+    U_PORT_TEST_ASSERT(strstr(pCsv, "AT+TEST4") == NULL);
+    // Truncation
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsCsv(atClientHandle, pCsv, 10) == length);
+    U_PORT_TEST_ASSERT(strlen(pCsv) == 9);
+    uPortFree(pCsv);
+
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsGet(atClientHandle, pStats, 4) == 3);
+    U_PORT_TEST_ASSERT(strcmp(pStats[0].command, "AT+TEST1=") == 0);
+    U_PORT_TEST_ASSERT(pStats[0].count == 2);
+    U_PORT_TEST_ASSERT(pStats[0].numErrors == 0);
+    U_PORT_TEST_ASSERT(pStats[0].numTimeouts == 0);
+    U_PORT_TEST_ASSERT(pStats[0].firstByteHistogram[7] == 2);
+    U_PORT_TEST_ASSERT(pStats[0].totalHistogram[9] == 2);
+    U_PORT_TEST_ASSERT(strcmp(pStats[1].command, "AT+TEST2?") == 0);
+    U_PORT_TEST_ASSERT(pStats[1].count == 1);
+    U_PORT_TEST_ASSERT(pStats[1].numErrors == 1);
+    U_PORT_TEST_ASSERT(pStats[1].numTimeouts == 0);
+    U_PORT_TEST_ASSERT(pStats[1].firstByteHistogram[8] == 1);
+    U_PORT_TEST_ASSERT(pStats[1].totalHistogram[8] == 1);
+    U_PORT_TEST_ASSERT(strcmp(pStats[2].command, "AT+TEST3") == 0);
+    U_PORT_TEST_ASSERT(pStats[2].count == 1);
+    U_PORT_TEST_ASSERT(pStats[2].numErrors == 0);
+    U_PORT_TEST_ASSERT(pStats[2].numTimeouts == 1);
+    y = 0;
+    for (size_t x = 0; x < U_AT_CLIENT_COMMAND_STATS_HISTOGRAM_NUM_BINS; x++) {
+        y += pStats[2].firstByteHistogram[x];
+    }
+    U_PORT_TEST_ASSERT(y == 0);
+    U_PORT_TEST_ASSERT(pStats[2].totalHistogram[10] == 1);
+    // Snapshot of fewer entries
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsGet(atClientHandle, pStats, 1) == 1);
+
+    U_TEST_PRINT_LINE("resetting statistics...");
+    uAtClientCommandStatsReset(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsGet(atClientHandle, pStats, 4) == 0);
+    sendDelayServerCommand(atClientHandle, "AT+TEST4", 0, 0, false);
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsGet(atClientHandle, pStats, 4) == 1);
+    U_PORT_TEST_ASSERT(strcmp(pStats[0].command, "AT+TEST4") == 0);
+    U_PORT_TEST_ASSERT(pStats[0].count == 1);
+
+    uAtClientCommandStatsStop(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientCommandStatsGet(atClientHandle, pStats, 4) ==
+                       (int32_t) U_ERROR_COMMON_NOT_INITIALISED);
+    uPortFree(pStats);
+
+    U_TEST_PRINT_LINE("removing AT client...");
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test reading views of parameters in place in the receive
+ * buffer and compare, for information, the time taken and the
+ * number of bytes copied with reading the same parameters
+ * through uAtClientReadString().
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientView")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientStreamHandle_t stream = U_AT_CLIENT_STREAM_HANDLE_DEFAULTS;
+    uAtClientView_t view;
+    char *pParameter;
+    char buffer[16];
+    size_t length;
+    int32_t x;
+    uint32_t address;
+    int32_t startTimeMs;
+    int32_t durationMs[2] = {0};
+    size_t numBytesCopied[2] = {0};
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Set up everything with the two UARTs; the
+    // AT server end is driven directly from here
+    twoUartsPreamble();
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    U_TEST_PRINT_LINE("adding an AT client on UART %d...", U_CFG_TEST_UART_A);
+    stream.handle.int32 = gUartAHandle;
+    stream.type = U_AT_CLIENT_STREAM_TYPE_UART;
+    atClientHandle = uAtClientAddExt(&stream, NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    uAtClientTimeoutSet(atClientHandle, U_AT_CLIENT_TEST_AT_TIMEOUT_MS);
+
+    // Larger than the AT client's receive buffer
+    pParameter = (char *) pUPortMalloc(U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES + 16);
+    U_PORT_TEST_ASSERT(pParameter != NULL);
+
+    U_TEST_PRINT_LINE("reading views of parameters...");
+    uAtClientLock(atClientHandle);
+    length = snprintf(pParameter, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES,
+                      "12345,\"AB0f\",,\"1.2.3.4\"x,-7");
+    sendTestResponse(pParameter, length);
+    U_PORT_TEST_ASSERT(uAtClientResponseStart(atClientHandle, "+TEST:") == 0);
+    U_PORT_TEST_ASSERT(uAtClientReadStringView(atClientHandle, &view, false) == 5);
+    U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) == 0);
+    U_PORT_TEST_ASSERT(x == 12345);
+    U_PORT_TEST_ASSERT(uAtClientReadStringView(atClientHandle, &view, false) == 4);
+    U_PORT_TEST_ASSERT(uAtClientViewHexToBin(&view, buffer, sizeof(buffer)) == 2);
+    U_PORT_TEST_ASSERT(memcmp(buffer, "\xab\x0f", 2) == 0);
+    U_PORT_TEST_ASSERT(uAtClientReadStringView(atClientHandle, &view, false) == 0);
+    // Anything after the closing quote is consumed but not in the view
+    U_PORT_TEST_ASSERT(uAtClientReadStringView(atClientHandle, &view, false) == 7);
+    U_PORT_TEST_ASSERT(uAtClientViewToIpV4(&view, &address) == 0);
+    U_PORT_TEST_ASSERT(address == 0x01020304);
+    // The last parameter ends with the stop tag
+    U_PORT_TEST_ASSERT(uAtClientReadStringView(atClientHandle, &view, false) == 2);
+    U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) == 0);
+    U_PORT_TEST_ASSERT(x == -7);
+    U_PORT_TEST_ASSERT(uAtClientReadStringView(atClientHandle, &view, false) == 0);
+    uAtClientResponseStop(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+
+    U_TEST_PRINT_LINE("reading a parameter too long for a view...");
+    uAtClientLock(atClientHandle);
+    length = U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES;
+    memset(pParameter, 'a', length);
+    *pParameter = '\"';
+    *(pParameter + length - 1) = '\"';
+    memcpy(pParameter + length, ",42", 3);
+    sendTestResponse(pParameter, length + 3);
+    U_PORT_TEST_ASSERT(uAtClientResponseStart(atClientHandle, "+TEST:") == 0);
+    U_PORT_TEST_ASSERT(uAtClientReadStringView(atClientHandle, &view, false) ==
+                       (int32_t) U_ERROR_COMMON_NO_MEMORY);
+    // Nothing should have been consumed
+    U_PORT_TEST_ASSERT(uAtClientReadString(atClientHandle, NULL, length,
+                                           false) == (int32_t) length - 2);
+    U_PORT_TEST_ASSERT(uAtClientReadInt(atClientHandle) == 42);
+    uAtClientResponseStop(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+
+    // Now compare uAtClientReadString() plus strtol() with
+    // uAtClientReadStringView() plus uAtClientViewToInt(),
+    // with the response already received in full so that it
+    // is the AT client that is being timed; for information
+    // only, nothing is asserted about the timing as it depends
+    // very much on the platform
+    length = 0;
+    for (size_t y = 0; y < U_AT_CLIENT_TEST_VIEW_NUM_INTS; y++) {
+        length += snprintf(pParameter + length, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES - length,
+                           "%s%d", (y > 0) ? "," : "", (int) (y * 1001) - 5000);
+    }
+    for (size_t y = 0; y < U_AT_CLIENT_TEST_VIEW_ITERATIONS * 2; y++) {
+        uAtClientLock(atClientHandle);
+        sendTestResponse(pParameter, length);
+        startTimeMs = uPortGetTickTimeMs();
+        while ((uPortUartGetReceiveSize(gUartAHandle) < (int32_t) length + 12) &&
+               (uPortGetTickTimeMs() - startTimeMs < U_AT_CLIENT_TEST_AT_TIMEOUT_MS)) {
+            uPortTaskBlock(1);
+        }
+        U_PORT_TEST_ASSERT(uAtClientResponseStart(atClientHandle, "+TEST:") == 0);
+        startTimeMs = uPortGetTickTimeMs();
+        for (int32_t z = 0; z < U_AT_CLIENT_TEST_VIEW_NUM_INTS; z++) {
+            if (y % 2 == 0) {
+                x = uAtClientReadString(atClientHandle, buffer, sizeof(buffer), false);
+                U_PORT_TEST_ASSERT(x > 0);
+                // Plus one for the terminator
+                numBytesCopied[0] += x + 1;
+                x = strtol(buffer, NULL, 10);
+            } else {
+                U_PORT_TEST_ASSERT(uAtClientReadStringView(atClientHandle, &view, false) > 0);
+                U_PORT_TEST_ASSERT(uAtClientViewToInt(&view, &x) == 0);
+            }
+            U_PORT_TEST_ASSERT(x == (z * 1001) - 5000);
+        }
+        durationMs[y % 2] += uPortGetTickTimeMs() - startTimeMs;
+        uAtClientResponseStop(atClientHandle);
+        U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+    }
+    U_TEST_PRINT_LINE("reading %d integers with uAtClientReadString() copied %d"
+                      " byte(s) and took %d ms.",
+                      U_AT_CLIENT_TEST_VIEW_NUM_INTS * U_AT_CLIENT_TEST_VIEW_ITERATIONS,
+                      numBytesCopied[0], durationMs[0]);
+    U_TEST_PRINT_LINE("reading %d integers with uAtClientReadStringView() copied %d"
+                      " byte(s) and took %d ms.",
+                      U_AT_CLIENT_TEST_VIEW_NUM_INTS * U_AT_CLIENT_TEST_VIEW_ITERATIONS,
+                      numBytesCopied[1], durationMs[1]);
+
+    uPortFree(pParameter);
+
+    U_TEST_PRINT_LINE("removing AT client...");
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test deferred AT commands against a simulated module that goes
+ * to sleep: a typical telemetry schedule is run first with each
+ * command sent as soon as it is due and then with the commands
+ * allowed to be up to half a period late, which should need fewer
+ * wake-ups of the module.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientDeferred")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientStreamHandle_t stream = U_AT_CLIENT_STREAM_HANDLE_DEFAULTS;
+    uAtClientWakeUpStats_t stats;
+    int32_t numWakeUps[2];
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Set up everything with the two UARTs
+    twoUartsPreamble();
+
+    // The far end is the simulated module, awake to start with
+    memset(&gSleepyModule, 0, sizeof(gSleepyModule));
+    gSleepyModule.awake = true;
+    gSleepyModule.lastRxTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uPortUartEventCallbackSet(gUartBHandle,
+                                                 U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                 sleepyModuleCallback, NULL,
+                                                 U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                 U_AT_CLIENT_URC_TASK_PRIORITY) == 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    U_TEST_PRINT_LINE("adding an AT client on UART %d...", U_CFG_TEST_UART_A);
+    stream.handle.int32 = gUartAHandle;
+    stream.type = U_AT_CLIENT_STREAM_TYPE_UART;
+    atClientHandle = uAtClientAddExt(&stream, NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    uAtClientTimeoutSet(atClientHandle, 500);
+    uAtClientDelaySet(atClientHandle, 0);
+
+    // Nothing yet
+    U_PORT_TEST_ASSERT(uAtClientWakeUpStatsGet(atClientHandle, NULL) < 0);
+    U_PORT_TEST_ASSERT(uAtClientWakeUpStatsGet(atClientHandle, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.numWakeUps == 0);
+    U_PORT_TEST_ASSERT(stats.numDeferred == 0);
+    U_PORT_TEST_ASSERT(uAtClientDeferredAdd(atClientHandle, NULL, NULL, 0, 0) < 0);
+    U_PORT_TEST_ASSERT(uAtClientDeferredAdd(atClientHandle, telemetryCallback,
+                                            &(gTelemetry[0]), 10, 5) < 0);
+    U_PORT_TEST_ASSERT(uAtClientDeferredRemove(atClientHandle, telemetryCallback,
+                                               &(gTelemetry[0])) == 0);
+
+    // Talk to the module while it is awake so that the AT
+    // client knows when it last transmitted, then set the
+    // wake-up handler; not all platforms support one, in
+    // which case the module wakes itself up when it receives
+    // something and the AT client, which then considers the
+    // module to be always awake, runs deferred callbacks
+    // together only when one of them reaches its deadline
+    uAtClientLock(atClientHandle);
+    uAtClientCommandStart(atClientHandle, "AT");
+    uAtClientCommandStopReadResponse(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+    gSleepyModule.sleeps = true;
+    if (uAtClientSetWakeUpHandler(atClientHandle, sleepyModuleWakeUp, NULL,
+                                  U_AT_CLIENT_TEST_DEFERRED_INACTIVITY_TIMEOUT_MS) != 0) {
+        U_TEST_PRINT_LINE("wake-up handlers are not supported on this platform,"
+                          " the module will wake up when it receives something.");
+        gSleepyModule.wakesOnRx = true;
+    }
+
+    U_TEST_PRINT_LINE("running the telemetry schedule for %d ms (%d seconds real"
+                      " time) with each command sent when it is due...",
+                      U_AT_CLIENT_TEST_DEFERRED_RUN_MS,
+                      (U_AT_CLIENT_TEST_DEFERRED_RUN_MS *
+                       U_AT_CLIENT_TEST_DEFERRED_TIME_SCALE) / 1000);
+    numWakeUps[0] = telemetryRun(atClientHandle, 0);
+    U_TEST_PRINT_LINE("running it again with each command allowed to be up to half"
+                      " a period late...");
+    numWakeUps[1] = telemetryRun(atClientHandle, 2);
+    U_TEST_PRINT_LINE("deferring reduced the number of wake-ups from %d to %d.",
+                      numWakeUps[0], numWakeUps[1]);
+    U_PORT_TEST_ASSERT(numWakeUps[0] > 0);
+    U_PORT_TEST_ASSERT(numWakeUps[1] < numWakeUps[0]);
+
+    // A deferred callback that is due must still be removable
+    // while another is running, and one that is running must
+    // be reported as such
+    U_TEST_PRINT_LINE("removing deferred callbacks while one is running...");
+    gDeferredCount = 0;
+    U_PORT_TEST_ASSERT(uAtClientDeferredAdd(atClientHandle, deferredSlowCallback,
+                                            NULL, 0, 0) == 0);
+    U_PORT_TEST_ASSERT(uAtClientDeferredAdd(atClientHandle, deferredCountCallback,
+                                            NULL, 0, 0) == 0);
+    for (size_t x = 0; !gDeferredSlowRunning && (x < 100); x++) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gDeferredSlowRunning);
+    U_PORT_TEST_ASSERT(uAtClientDeferredRemove(atClientHandle, deferredCountCallback,
+                                               NULL) == 1);
+    U_PORT_TEST_ASSERT(uAtClientDeferredRemove(atClientHandle, deferredSlowCallback,
+                                               NULL) == (int32_t) U_ERROR_COMMON_BUSY);
+    uPortTaskBlock(1000);
+    U_PORT_TEST_ASSERT(!gDeferredSlowRunning);
+    U_PORT_TEST_ASSERT(uAtClientDeferredRemove(atClientHandle, deferredSlowCallback,
+                                               NULL) == 0);
+    U_PORT_TEST_ASSERT(gDeferredCount == 0);
+
+    // Make sure that nothing left queued is run when the
+    // AT client is removed
+    U_PORT_TEST_ASSERT(uAtClientDeferredAdd(atClientHandle, telemetryCallback,
+                                            &(gTelemetry[0]), 60000, 60000) == 0);
+    uAtClientWakeUpStatsReset(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientWakeUpStatsGet(atClientHandle, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.numWakeUps == 0);
+    U_PORT_TEST_ASSERT(stats.numDeferred == 0);
+    U_PORT_TEST_ASSERT(stats.awakeTotalMs == 0);
+
+    U_TEST_PRINT_LINE("removing AT client...");
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 # endif
 #endif
 
@@ -52,6 +52,7 @@
 #include "u_cell.h"
 #include "u_short_range.h"
 #include "u_gnss_type.h"
+#include "u_sock.h" // uSockDnsCacheFree()
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -159,6 +160,8 @@ int32_t uDeviceInit()
 
 int32_t uDeviceDeinit()
 {
+    // Stop any network bring-ups before the devices go away
+    uNetworkAsyncDeinit();
     uLocationSharedDeinit();
     uDevicePrivateShortRangeDeinit();
     uDevicePrivateGnssDeinit();
@@ -331,26 +334,31 @@ int32_t uDeviceClose(uDeviceHandle_t devHandle, bool powerOff)
     errorCode = uDeviceLock();
     if (errorCode == 0) {
         deviceType = uDeviceGetDeviceType(devHandle);
-        switch (deviceType) {
-            case U_DEVICE_TYPE_CELL:
-                errorCode = uDevicePrivateCellRemove(devHandle, powerOff);
-                break;
-            case U_DEVICE_TYPE_GNSS:
-                errorCode = uDevicePrivateGnssRemove(devHandle, powerOff);
-                break;
-            case U_DEVICE_TYPE_SHORT_RANGE:
-                if (!powerOff) {
-                    errorCode = uDevicePrivateShortRangeRemove(devHandle);
-                }
-                break;
-            case U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU:
-                if (!powerOff) {
-                    errorCode = uDevicePrivateShortRangeOpenCpuRemove(devHandle);
-                }
-                break;
-            default:
-                errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
-                break;
+        // Can't close the device while one of its networks is
+        // being brought up by uNetworkInterfaceUpStart()
+        errorCode = (int32_t) U_ERROR_COMMON_BUSY;
+        if (!uNetworkIsStarting(devHandle)) {
+            switch (deviceType) {
+                case U_DEVICE_TYPE_CELL:
+                    errorCode = uDevicePrivateCellRemove(devHandle, powerOff);
+                    break;
+                case U_DEVICE_TYPE_GNSS:
+                    errorCode = uDevicePrivateGnssRemove(devHandle, powerOff);
+                    break;
+                case U_DEVICE_TYPE_SHORT_RANGE:
+                    if (!powerOff) {
+                        errorCode = uDevicePrivateShortRangeRemove(devHandle);
+                    }
+                    break;
+                case U_DEVICE_TYPE_SHORT_RANGE_OPEN_CPU:
+                    if (!powerOff) {
+                        errorCode = uDevicePrivateShortRangeOpenCpuRemove(devHandle);
+                    }
+                    break;
+                default:
+                    errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+                    break;
+            }
         }
 
         if (errorCode == 0) {
@@ -359,6 +367,8 @@ int32_t uDeviceClose(uDeviceHandle_t devHandle, bool powerOff)
             errorCode = uDeviceCallback("close", pDeviceType, pPowerOff);
             // Free any storage allocated for network configuration data
             uNetworkCfgFree(devHandle);
+            // Free any DNS cache the sockets layer has for the device
+            uSockDnsCacheFree(devHandle);
         }
 
         // ...and done
@@ -72,6 +72,10 @@ typedef struct {
     void *pCfg; /**< network configuration provided by application. */
     void *pContext; /**< optional context data for this network interface. */
     void *pStatusCallbackData; /**< optional status callback for this network interface. */
+    int32_t state; /**< the state of this network, see #uNetworkState_t in u_network.h. */
+    volatile bool cancel; /**< set by uNetworkInterfaceDown() to abandon a bring-up
+                               in state #U_NETWORK_STATE_STARTING; only a hint
+                               outside the device API lock. */
 } uDeviceNetworkData_t;
 
 /** Internal data structure that uDeviceHandle_t points at.
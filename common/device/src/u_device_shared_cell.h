@@ -47,6 +47,7 @@ typedef struct {
     int32_t uart;
     uAtClientHandle_t at;
     int64_t stopTimeMs;
+    bool (*pKeepGoingCallback)(uDeviceHandle_t devHandle);
     int32_t pinPwrOn;
 } uDeviceCellContext_t;
 
@@ -28,8 +28,10 @@
 
 /** @file
  * @brief This header file defines the API for a DNS server
- * intended to be used for a captive portal, i.e. all lookup
- * requests will return the same ip address.
+ * intended to be used for a captive portal or a provisioning
+ * access point: lookups are answered from a table of names and
+ * addresses, where a wildcard entry may map any name, or any name
+ * in a domain, to one address.
  */
 
 #ifdef __cplusplus
@@ -40,6 +42,34 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_DNS_SERVER_MESSAGE_MAX_LENGTH_BYTES
+/** The largest DNS message, query or response, that the DNS
+ * server handles: 512 is the limit for DNS over UDP without
+ * EDNS; a response that would be longer is truncated and marked
+ * as such.
+ */
+# define U_DNS_SERVER_MESSAGE_MAX_LENGTH_BYTES 512
+#endif
+
+#ifndef U_DNS_SERVER_KEEP_GOING_CHECK_MS
+/** How long the DNS server waits for a query before calling its
+ * keep-going callback again; queries themselves are answered
+ * as soon as they arrive.
+ */
+# define U_DNS_SERVER_KEEP_GOING_CHECK_MS 100
+#endif
+
+#ifndef U_DNS_SERVER_SWEEP_INTERVAL_MS
+/** The DNS server only reads its socket when the socket has
+ * called back to say that data has arrived, since a read of a
+ * non-blocking socket which finds nothing waits for
+ * #U_SOCK_RECEIVE_POLL_INTERVAL_MS; if nothing has called back
+ * for this long it reads the socket anyway, in case the call-back
+ * for one query was merged with that of another.
+ */
+# define U_DNS_SERVER_SWEEP_INTERVAL_MS 1000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -52,12 +82,29 @@ extern "C" {
  */
 typedef bool (*uDnsKeepGoingCallback_t)(uDeviceHandle_t deviceHandle);
 
+/** An entry in the table of a DNS server, see uDnsServerTable().
+ * A name may appear twice, once with an IPv4 address, answering
+ * A queries, and once with an IPv6 address, answering AAAA queries.
+ */
+typedef struct {
+    const char *pName;      /**< the name, e.g. "setup.example.com",
+                                 matched without regard to case; a
+                                 name beginning "*." matches any name
+                                 in that domain which has no entry of
+                                 its own and "*" matches any name
+                                 with no other match. */
+    const char *pIpAddress; /**< the address as a string, IPv4 or
+                                 IPv6 (all eight fields, no "::"),
+                                 without a port number. */
+} uDnsServerEntry_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
 
 /** Create a DNS server on the supplied device. All requests
- * will then be directed to the specified ipv4 address.
+ * will then be directed to the specified ipv4 address; this is
+ * the same as calling uDnsServerTable() with a single "*" entry.
  * The server is intended to run in a separate process thread.
  *
  * @param deviceHandle the handle of the network device instance.
@@ -71,6 +118,29 @@ int32_t uDnsServer(uDeviceHandle_t deviceHandle,
                    const char *pIpAddr,
                    uDnsKeepGoingCallback_t cb);
 
+/** Create a DNS server on the supplied device which answers
+ * from a table of names and addresses.  A name which matches no
+ * entry, directly or through a wildcard, is answered with
+ * NXDOMAIN; a name which matches but has no address of the type
+ * asked for is answered with no records.  The server wakes up
+ * when a query arrives and answers all of the queries waiting
+ * before sleeping again.  Like uDnsServer() it is intended to run
+ * in a separate process thread and returns only when cb returns
+ * false.
+ *
+ * @param deviceHandle the handle of the network device instance.
+ * @param[in] pTable   the table; the strings it points to need
+ *                     not be kept once the server has started.
+ * @param numEntries   the number of entries in pTable.
+ * @param cb           callback that may be used to control when
+ *                     the DNS server exits; NULL to continue forever.
+ * @return             zero on exit else negative error code.
+ */
+int32_t uDnsServerTable(uDeviceHandle_t deviceHandle,
+                        const uDnsServerEntry_t *pTable,
+                        size_t numEntries,
+                        uDnsKeepGoingCallback_t cb);
+
 #ifdef __cplusplus
 }
 #endif
@@ -79,4 +149,4 @@ int32_t uDnsServer(uDeviceHandle_t deviceHandle,
 
 #endif // _U_DNS_SERVER_H_
 
-// End of file
\ No newline at end of file
+// End of file
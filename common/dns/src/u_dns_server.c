@@ -33,26 +33,24 @@
 #include "stdbool.h"
 #include "string.h"
 #include "stdio.h"
-#include "limits.h"
+#include "ctype.h"     // tolower()
 
 #include "u_error_common.h"
 
-#include "u_assert.h"
-
+#include "u_port.h"
 #include "u_port_os.h"
+#include "u_port_heap.h"
 #include "u_cfg_sw.h"
 #include "u_port_debug.h"
 #include "u_cfg_os_platform_specific.h"
 
-#include "u_short_range_module_type.h"
-#include "u_short_range.h"
-#include "u_short_range_cfg.h"
+#include "u_device.h"
 
-#include "u_network.h"
 #include "u_sock_errno.h"
 #include "u_sock.h"
 
 #include "u_dns_server.h"
+#include "u_dns_server_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -63,196 +61,588 @@
 # define U_DNS_TTL 600
 #endif
 
-#define DNS_QR_QUERY      0
-#define DNS_QR_RESPONSE   1
+// The length of a DNS header
+#define DNS_HEADER_LENGTH 12
+
+// The longest name in a DNS query, in its dotted form
+#define DNS_NAME_MAX_LENGTH 253
+
+// Flags in the second 16-bit word of a DNS header
+#define DNS_FLAG_QR 0x8000
+#define DNS_FLAG_AA 0x0400
+#define DNS_FLAG_TC 0x0200
+#define DNS_FLAG_RD 0x0100
+
+// Extract the opcode from the flags of a DNS header
+#define DNS_OPCODE(flags) (((flags) >> 11) & 0x0F)
+
 #define DNS_OPCODE_QUERY  0
-#define DNS_DEFAULT_TTL  60
 
-#define DNS_NO_ERROR      0
-#define DNS_FORM_ERROR    1
-#define DNS_NOTIMPL_ERROR 4
+#define DNS_NO_ERROR       0
+#define DNS_FORM_ERROR     1
+#define DNS_NXDOMAIN_ERROR 3
+#define DNS_NOTIMPL_ERROR  4
+
+#define DNS_TYPE_A    1
+#define DNS_TYPE_AAAA 28
+#define DNS_TYPE_ANY  255
+
+#define DNS_CLASS_IN  1
+#define DNS_CLASS_ANY 255
+
+// The length of an answer record, less the address: a pointer to
+// the name in the question, type, class, TTL and address length
+#define DNS_ANSWER_OVERHEAD_LENGTH 12
+
+// The maximum number of records in one answer: one A and one AAAA
+// for a name that has both and a query of type ANY, with room for
+// a name that appears more than once
+#define DNS_ANSWER_MAX_NUM_RECORDS 4
+
+// FNV-1a, 32-bit
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME        16777619UL
 
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
-// DNS request/response header
+// An entry of the table as the DNS server keeps it.
+typedef struct {
+    uint32_t hash;           // of the name, see hashName()
+    bool wildcard;           // the name began with "*." or was "*"
+    const char *pName;       // lower case, without "*." or a trailing '.'
+    size_t nameLength;
+    uint16_t type;           // DNS_TYPE_A or DNS_TYPE_AAAA
+    uint8_t address[16];     // network byte order
+} uDnsServerRecord_t;
+
+// The table of the DNS server, hashed: pIndex is an open-addressed
+// table of indexes into pRecords, -1 where empty.
+typedef struct {
+    uDnsServerRecord_t *pRecords;
+    size_t numRecords;
+    int32_t *pIndex;
+    size_t indexSize;        // a power of two
+    char *pNames;            // storage for the names of pRecords
+} uDnsServerLookup_t;
+
+// The uSock socket of uDnsServerTable(), the context of gSock.
 typedef struct {
-    uint16_t ID;               // identification number
-    unsigned char RD : 1;      // recursion desired
-    unsigned char TC : 1;      // truncated message
-    unsigned char AA : 1;      // authoritive answer
-    unsigned char OPCode : 4;  // message_type
-    unsigned char QR : 1;      // query/response flag
-    unsigned char RCode : 4;   // response code
-    unsigned char Z : 3;       // its z! reserved
-    unsigned char RA : 1;      // recursion available
-    uint16_t QDCount;          // number of question entries
-    uint16_t ANCount;          // number of answer entries
-    uint16_t NSCount;          // number of authority entries
-    uint16_t ARCount;          // number of resource entries
-} uDnsHeader_t;
+    uDeviceHandle_t deviceHandle;
+    volatile bool dataPending;    // set by the data callback of the socket
+    int32_t lastReceiveTimeMs;    // when uSockReceiveFrom() was last called
+    void (*pCallback)(void *);    // the data callback of uDnsServerPrivateRun()
+    void *pCallbackParam;         // the parameter for pCallback
+} uDnsServerSock_t;
 
 /* ----------------------------------------------------------------
- * STATIC FUNCTIONS
+ * STATIC FUNCTIONS: HELPERS
  * -------------------------------------------------------------- */
 
-/* Local implementation of endian conversion routines in order to
-   avoid possible compiler or os differences. */
-
-static bool isLe()
+// Read a 16-bit value in network byte order.
+static uint16_t get16(const uint8_t *pData)
 {
-    int32_t x = 1;
-    return (*((char *)(&x)) == 1);
+    return (uint16_t) ((((uint16_t) *pData) << 8) | *(pData + 1));
 }
 
-static uint16_t ntohs(uint16_t x)
+// Write a 16-bit value in network byte order.
+static uint8_t *pPut16(uint8_t *pData, uint16_t value)
 {
-    uint16_t retVal = x;
-    if (isLe()) {
-        retVal = (x & 0xFF00) >> 8;
-        retVal += (x & 0x00FF) << 8;
-    }
-    return retVal;
+    *pData++ = (uint8_t) (value >> 8);
+    *pData++ = (uint8_t) value;
+    return pData;
 }
 
-static uint32_t htonl(uint32_t x)
+// Hash a name, which must already be in lower case; a wildcard
+// hashes as though it began with "*.".
+static uint32_t hashName(bool wildcard, const char *pName, size_t length)
 {
-    uint32_t retVal = x;
-    if (isLe()) {
-        retVal = (x & 0xFF000000) >> 24;
-        retVal += (x & 0x00FF0000) >> 8;
-        retVal += (x & 0x0000FF00) << 8;
-        retVal += (x & 0x000000FF) << 24;
+    uint32_t hash = FNV_OFFSET_BASIS;
+
+    if (wildcard) {
+        hash = (hash ^ '*') * FNV_PRIME;
+        hash = (hash ^ '.') * FNV_PRIME;
     }
-    return retVal;
+    for (size_t x = 0; x < length; x++) {
+        hash = (hash ^ (uint8_t) pName[x]) * FNV_PRIME;
+    }
+
+    return hash;
 }
 
 /* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS
+ * STATIC FUNCTIONS: THE TABLE
  * -------------------------------------------------------------- */
 
-int32_t uDnsServer(uDeviceHandle_t deviceHandle,
-                   const char *pIpAddr,
-                   uDnsKeepGoingCallback_t cb)
+// Free a table made by lookupCreate().
+static void lookupFree(uDnsServerLookup_t *pLookup)
 {
-    uSockAddress_t lookupAddr;
-    uSockStringToAddress(pIpAddr, &lookupAddr);
-    // Address in network endian format
-    uint32_t netAddr = htonl(lookupAddr.ipAddress.address.ipv4);
-    uint8_t netAddrLen = sizeof(netAddr);
-    // Time to live for the response in seconds
-    uint32_t ttl = htonl(U_DNS_TTL);
-
-    int32_t sock = uSockCreate(deviceHandle,
-                               U_SOCK_TYPE_DGRAM,
-                               U_SOCK_PROTOCOL_UDP);
-    if (sock < 0) {
-        uPortLog("U_DNS: Failed to create DNS server socket: %d\n", sock);
-        return sock;
+    uPortFree(pLookup->pRecords);
+    uPortFree(pLookup->pIndex);
+    uPortFree(pLookup->pNames);
+    memset(pLookup, 0, sizeof(*pLookup));
+}
+
+// Build the hashed table of the DNS server from the entries
+// given by the application.
+static int32_t lookupCreate(const uDnsServerEntry_t *pTable,
+                            size_t numEntries,
+                            uDnsServerLookup_t *pLookup)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t namesLength = 0;
+    uSockAddress_t address;
+    uDnsServerRecord_t *pRecord;
+    const char *pName;
+    char *pNameCopy;
+    size_t length;
+    size_t y;
+
+    memset(pLookup, 0, sizeof(*pLookup));
+    if ((pTable != NULL) && (numEntries > 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        for (size_t x = 0; (x < numEntries) &&
+             (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS); x++) {
+            if ((pTable[x].pName == NULL) || (pTable[x].pIpAddress == NULL) ||
+                (strlen(pTable[x].pName) > DNS_NAME_MAX_LENGTH)) {
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            }
+            if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+                namesLength += strlen(pTable[x].pName) + 1;
+            }
+        }
     }
-    uSockBlockingSet(sock, false);
-    uSockAddress_t remoteAddr;
-    uint8_t buff[255];
-    remoteAddr.ipAddress.address.ipv4 = 0;
-    remoteAddr.port = 53;
-    uSockBind(sock, &remoteAddr);
-    memset(buff, 0, sizeof(buff));
-    uPortLog("U_DNS: server started\n");
-    while (true) {
-        int32_t errOrCnt = uSockReceiveFrom(sock,
-                                            &remoteAddr,
-                                            buff,
-                                            sizeof(buff));
-        if (errOrCnt > (int32_t)sizeof(uDnsHeader_t)) {
-            // Incoming request
-            uDnsHeader_t *pHeader = (uDnsHeader_t *)buff;
-            bool valid =
-                pHeader->QR == DNS_QR_QUERY &&
-                pHeader->OPCode == DNS_OPCODE_QUERY &&
-                ntohs(pHeader->QDCount) == 1 &&
-                pHeader->ANCount == 0 &&
-                pHeader->NSCount == 0 &&
-                pHeader->ARCount == 0;
-            if (valid) {
-                // Create a response which maps any requested name
-                // to the address specified by pIpAddr
-                pHeader->QR = DNS_QR_RESPONSE;
-                pHeader->ANCount = pHeader->QDCount;
-                uint8_t *pData = buff + sizeof(uDnsHeader_t);
-                // Need to parse the query name even if it is ignored
-                // in order to get the correct position for the response ip.
-                // Also print the name for debugging purposes.
-                char name[100];
-                memset(name, 0, sizeof(name));
-                int32_t remain = errOrCnt - sizeof(uDnsHeader_t);
-                while (remain > 0 && *pData != 0) {
-                    uint8_t len = *pData + 1;
-                    if (len > remain) {
-                        valid = false;
-                        break;
+    if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+        // An index at least twice the size of the table keeps
+        // the probe sequences short
+        pLookup->indexSize = 2;
+        while (pLookup->indexSize < numEntries * 2) {
+            pLookup->indexSize <<= 1;
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pLookup->pRecords = (uDnsServerRecord_t *) pUPortMalloc(numEntries *
+                                                                sizeof(uDnsServerRecord_t));
+        pLookup->pIndex = (int32_t *) pUPortMalloc(pLookup->indexSize * sizeof(int32_t));
+        pLookup->pNames = (char *) pUPortMalloc(namesLength);
+        if ((pLookup->pRecords != NULL) && (pLookup->pIndex != NULL) &&
+            (pLookup->pNames != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            memset(pLookup->pIndex, 0xFF, pLookup->indexSize * sizeof(int32_t));
+            pNameCopy = pLookup->pNames;
+            for (size_t x = 0; (x < numEntries) &&
+                 (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS); x++) {
+                pRecord = &(pLookup->pRecords[x]);
+                memset(pRecord, 0, sizeof(*pRecord));
+                errorCode = uSockStringToAddress(pTable[x].pIpAddress, &address);
+                if (errorCode == 0) {
+                    if (address.ipAddress.type == U_SOCK_ADDRESS_TYPE_V6) {
+                        pRecord->type = DNS_TYPE_AAAA;
+                        for (size_t z = 0; z < 4; z++) {
+                            // Most significant word is at the top
+                            uint32_t word = address.ipAddress.address.ipv6[3 - z];
+                            pPut16(pPut16(pRecord->address + (z * 4), (uint16_t) (word >> 16)),
+                                   (uint16_t) word);
+                        }
+                    } else {
+                        pRecord->type = DNS_TYPE_A;
+                        pPut16(pPut16(pRecord->address,
+                                      (uint16_t) (address.ipAddress.address.ipv4 >> 16)),
+                               (uint16_t) address.ipAddress.address.ipv4);
                     }
-                    if (sizeof(name) - strlen(name) > len) {
-                        strncat(name, (char *)(pData + 1), len - 1);
-                        strcat(name, ".");
+                    // Normalise the name: lower case, no "*."
+                    // and no trailing dot
+                    pName = pTable[x].pName;
+                    if ((pName[0] == '*') && ((pName[1] == '.') || (pName[1] == 0))) {
+                        pRecord->wildcard = true;
+                        pName += (pName[1] == 0) ? 1 : 2;
                     }
-                    remain -= len;
-                    pData += len;
+                    length = strlen(pName);
+                    if ((length > 0) && (pName[length - 1] == '.')) {
+                        length--;
+                    }
+                    for (y = 0; y < length; y++) {
+                        pNameCopy[y] = (char) tolower((unsigned char) pName[y]);
+                    }
+                    pNameCopy[y] = 0;
+                    pRecord->pName = pNameCopy;
+                    pRecord->nameLength = length;
+                    pRecord->hash = hashName(pRecord->wildcard, pNameCopy, length);
+                    pNameCopy += length + 1;
+                    // Add it to the index
+                    y = pRecord->hash & (pLookup->indexSize - 1);
+                    while (pLookup->pIndex[y] >= 0) {
+                        y = (y + 1) & (pLookup->indexSize - 1);
+                    }
+                    pLookup->pIndex[y] = (int32_t) x;
+                    pLookup->numRecords++;
+                } else {
+                    errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                }
+            }
+        }
+        if (errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) {
+            lookupFree(pLookup);
+        }
+    }
+
+    return errorCode;
+}
+
+// Look a name up in the table, returning the number of records
+// of the given type (DNS_TYPE_ANY for all types) that were found;
+// *pNameFound is set to true if the name is in the table at all.
+static size_t lookupFind(const uDnsServerLookup_t *pLookup,
+                         bool wildcard, const char *pName, size_t length,
+                         uint16_t type, const uDnsServerRecord_t **ppRecords,
+                         size_t maxNumRecords, bool *pNameFound)
+{
+    size_t numRecords = 0;
+    uint32_t hash = hashName(wildcard, pName, length);
+    size_t y = hash & (pLookup->indexSize - 1);
+    const uDnsServerRecord_t *pRecord;
+
+    while (pLookup->pIndex[y] >= 0) {
+        pRecord = &(pLookup->pRecords[pLookup->pIndex[y]]);
+        if ((pRecord->hash == hash) && (pRecord->wildcard == wildcard) &&
+            (pRecord->nameLength == length) &&
+            (memcmp(pRecord->pName, pName, length) == 0)) {
+            *pNameFound = true;
+            if (((type == DNS_TYPE_ANY) || (pRecord->type == type)) &&
+                (numRecords < maxNumRecords)) {
+                ppRecords[numRecords] = pRecord;
+                numRecords++;
+            }
+        }
+        y = (y + 1) & (pLookup->indexSize - 1);
+    }
+
+    return numRecords;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: ANSWERING
+ * -------------------------------------------------------------- */
+
+// Turn the query in pBuffer into the response to it, returning
+// the length of the response or zero if there should be none.
+static size_t answer(const uDnsServerLookup_t *pLookup, uint8_t *pBuffer,
+                     size_t length, size_t bufferSize)
+{
+    size_t responseLength = 0;
+    uint16_t flags;
+    uint16_t rcode = DNS_NO_ERROR;
+    char name[DNS_NAME_MAX_LENGTH + 1];
+    size_t nameLength = 0;
+    size_t offset = DNS_HEADER_LENGTH;
+    size_t labelLength;
+    uint16_t qType = 0;
+    uint16_t qClass = 0;
+    const uDnsServerRecord_t *pRecords[DNS_ANSWER_MAX_NUM_RECORDS];
+    size_t numRecords = 0;
+    bool nameFound = false;
+    uint8_t *pData;
+
+    if (length >= DNS_HEADER_LENGTH) {
+        flags = get16(pBuffer + 2);
+        if ((flags & DNS_FLAG_QR) != 0) {
+            // Never answer a response
+            return 0;
+        }
+        if (DNS_OPCODE(flags) != DNS_OPCODE_QUERY) {
+            rcode = DNS_NOTIMPL_ERROR;
+        } else if (get16(pBuffer + 4) != 1) {
+            rcode = DNS_FORM_ERROR;
+        } else {
+            // Copy the name out of the question in dotted form, in
+            // lower case, checking that it is complete
+            rcode = DNS_FORM_ERROR;
+            while ((offset < length) && (pBuffer[offset] != 0) &&
+                   (pBuffer[offset] <= 63)) {
+                labelLength = pBuffer[offset];
+                offset++;
+                if ((offset + labelLength > length) ||
+                    (nameLength + labelLength + 1 > DNS_NAME_MAX_LENGTH)) {
+                    break;
                 }
-                if (strlen(name)) {
-                    name[strlen(name) - 1] = 0;
+                if (nameLength > 0) {
+                    name[nameLength] = '.';
+                    nameLength++;
                 }
-                if (valid) {
-                    uPortLog("U_DNS lookup: %s\n", name);
+                for (size_t x = 0; x < labelLength; x++) {
+                    name[nameLength + x] = (char) tolower(pBuffer[offset + x]);
                 }
+                nameLength += labelLength;
+                offset += labelLength;
+            }
+            if ((offset < length) && (pBuffer[offset] == 0) &&
+                (offset + 5 <= length)) {
+                rcode = DNS_NO_ERROR;
+                offset++;
+                qType = get16(pBuffer + offset);
+                qClass = get16(pBuffer + offset + 2);
+                offset += 4;
+                name[nameLength] = 0;
+            }
+        }
 
-                // Make sure we have space for the address as well in the buffer
-                valid = valid && (((pData - buff) + 21) < sizeof(buff));
-
-                if (valid) {
-                    // Skip remaining
-                    pData += 5;
-                    // Answer name is a pointer
-                    *(pData++) = 0xC0;
-                    // Pointer is to the name at offset
-                    *(pData++) = 0x0C;
-                    // Answer is type A query (host address)
-                    *(pData++) = 0;
-                    *(pData++) = 1;
-                    // Answer is class IN (Internet address)
-                    *(pData++) = 0;
-                    *(pData++) = 1;
-                    // TTL
-                    memcpy(pData, (uint8_t *)&ttl, sizeof(ttl));
-                    pData += sizeof(ttl);
-                    // The fixed lookup address
-                    *(pData++) = 0;
-                    *(pData++) = netAddrLen;
-                    memcpy(pData, (uint8_t *)&netAddr, netAddrLen);
-                    pData += netAddrLen;
-                    uSockSendTo(sock, &remoteAddr, buff, pData - buff);
+        if (rcode == DNS_NO_ERROR) {
+            if ((qClass != DNS_CLASS_IN) && (qClass != DNS_CLASS_ANY)) {
+                rcode = DNS_NOTIMPL_ERROR;
+            } else {
+                if ((qType != DNS_TYPE_A) && (qType != DNS_TYPE_AAAA) &&
+                    (qType != DNS_TYPE_ANY)) {
+                    // Anything else (e.g. HTTPS records) finds the
+                    // name but has no records to answer with
+                    qType = 0;
+                }
+                // The name itself, then "*." each domain it is in,
+                // then "*"
+                numRecords = lookupFind(pLookup, false, name, nameLength, qType,
+                                        pRecords, DNS_ANSWER_MAX_NUM_RECORDS, &nameFound);
+                for (size_t x = 0; (x < nameLength) && !nameFound; x++) {
+                    if (name[x] == '.') {
+                        numRecords = lookupFind(pLookup, true, name + x + 1,
+                                                nameLength - x - 1, qType,
+                                                pRecords, DNS_ANSWER_MAX_NUM_RECORDS,
+                                                &nameFound);
+                    }
                 }
+                if (!nameFound) {
+                    numRecords = lookupFind(pLookup, true, "", 0, qType, pRecords,
+                                            DNS_ANSWER_MAX_NUM_RECORDS, &nameFound);
+                }
+                if (!nameFound) {
+                    rcode = DNS_NXDOMAIN_ERROR;
+                }
+#ifdef U_DNS_SERVER_DEBUG_PRINT
+                uPortLog("U_DNS lookup: %s type %d, %d record(s)%s.\n", name, qType,
+                         numRecords, nameFound ? "" : ", NXDOMAIN");
+#endif
             }
-            if (!valid) {
-                // Send an error response
-                int32_t dnsError =
-                    pHeader->OPCode != DNS_OPCODE_QUERY ?
-                    DNS_NOTIMPL_ERROR :
-                    DNS_FORM_ERROR;
-                pHeader->QR = DNS_QR_RESPONSE;
-                pHeader->RCode = (unsigned char)dnsError;
-                pHeader->QDCount = 0;
-                pHeader->ANCount = 0;
-                pHeader->NSCount = 0;
-                pHeader->ARCount = 0;
-                uPortLog("U_DNS: Unhandled request: %d\n", dnsError);
-                uSockSendTo(sock, &remoteAddr, pHeader, sizeof(uDnsHeader_t));
+        }
+
+        // Write the response over the query: the header, the
+        // question (if it could be understood) and the answers
+        flags = (uint16_t) (DNS_FLAG_QR | (flags & 0x7800) | DNS_FLAG_AA |
+                            (flags & DNS_FLAG_RD) | rcode);
+        if ((rcode != DNS_NO_ERROR) && (rcode != DNS_NXDOMAIN_ERROR)) {
+            // Just the header
+            uPortLog("U_DNS: Unhandled request: %d\n", rcode);
+            offset = DNS_HEADER_LENGTH;
+            pPut16(pBuffer + 4, 0);
+        }
+        pData = pBuffer + offset;
+        for (size_t x = 0; x < numRecords; x++) {
+            size_t addressLength = (pRecords[x]->type == DNS_TYPE_AAAA) ? 16 : 4;
+            if ((pData - pBuffer) + DNS_ANSWER_OVERHEAD_LENGTH +
+                addressLength > bufferSize) {
+                flags |= DNS_FLAG_TC;
+                numRecords = x;
+                break;
             }
+            // The name is a pointer to the one in the question
+            pData = pPut16(pData, 0xC000 | DNS_HEADER_LENGTH);
+            pData = pPut16(pData, pRecords[x]->type);
+            pData = pPut16(pData, DNS_CLASS_IN);
+            pData = pPut16(pData, (uint16_t) (U_DNS_TTL >> 16));
+            pData = pPut16(pData, (uint16_t) U_DNS_TTL);
+            pData = pPut16(pData, (uint16_t) addressLength);
+            memcpy(pData, pRecords[x]->address, addressLength);
+            pData += addressLength;
         }
-        uPortTaskBlock(100);
-        if (cb != NULL && !cb(deviceHandle)) {
-            break;
+        pPut16(pBuffer + 2, flags);
+        pPut16(pBuffer + 6, (uint16_t) numRecords);
+        // No authority or additional records: anything additional
+        // in the query, e.g. an EDNS OPT record, is dropped
+        pPut16(pBuffer + 8, 0);
+        pPut16(pBuffer + 10, 0);
+        responseLength = pData - pBuffer;
+    }
+
+    return responseLength;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE SOCKET
+ * -------------------------------------------------------------- */
+
+// Called when data arrives on the socket of the DNS server.
+static void dataCallback(void *pParameter)
+{
+    uPortSemaphoreGive((uPortSemaphoreHandle_t) pParameter);
+}
+
+// Called by uSock when data arrives on the socket.
+static void sockDataCallback(void *pParameter)
+{
+    uDnsServerSock_t *pSock = (uDnsServerSock_t *) pParameter;
+
+    pSock->dataPending = true;
+    pSock->pCallback(pSock->pCallbackParam);
+}
+
+// Open a uSock socket for the DNS server; pContext is a pointer
+// to a uDnsServerSock_t.
+static int32_t sockOpen(void *pContext, uint16_t port,
+                        void (*pCallback)(void *), void *pCallbackParam)
+{
+    uDnsServerSock_t *pSock = (uDnsServerSock_t *) pContext;
+    uSockAddress_t localAddr;
+    int32_t sock = uSockCreate(pSock->deviceHandle,
+                               U_SOCK_TYPE_DGRAM,
+                               U_SOCK_PROTOCOL_UDP);
+    if (sock >= 0) {
+        pSock->pCallback = pCallback;
+        pSock->pCallbackParam = pCallbackParam;
+        // Read once to begin with, in case something is already there
+        pSock->dataPending = true;
+        pSock->lastReceiveTimeMs = uPortGetTickTimeMs();
+        uSockBlockingSet(sock, false);
+        memset(&localAddr, 0, sizeof(localAddr));
+        localAddr.port = port;
+        uSockBind(sock, &localAddr);
+        uSockRegisterCallbackData(sock, sockDataCallback, pSock);
+    }
+    return sock;
+}
+
+// Receive from a uSock socket: only done if the socket has called
+// back since the last read, or nothing has called back for
+// U_DNS_SERVER_SWEEP_INTERVAL_MS, since a read that finds
+// nothing waits for U_SOCK_RECEIVE_POLL_INTERVAL_MS.
+static int32_t sockReceiveFrom(void *pContext, int32_t handle,
+                               uSockAddress_t *pRemoteAddress,
+                               void *pData, size_t dataSizeBytes)
+{
+    uDnsServerSock_t *pSock = (uDnsServerSock_t *) pContext;
+    int32_t size = -U_SOCK_EWOULDBLOCK;
+
+    if (pSock->dataPending ||
+        (uPortGetTickTimeMs() - pSock->lastReceiveTimeMs >= U_DNS_SERVER_SWEEP_INTERVAL_MS)) {
+        // Clear before reading so that a callback during the read counts
+        pSock->dataPending = false;
+        pSock->lastReceiveTimeMs = uPortGetTickTimeMs();
+        size = uSockReceiveFrom(handle, pRemoteAddress, pData, dataSizeBytes);
+    }
+    return size;
+}
+
+// Send on a uSock socket.
+static int32_t sockSendTo(void *pContext, int32_t handle,
+                          const uSockAddress_t *pRemoteAddress,
+                          const void *pData, size_t dataSizeBytes)
+{
+    (void) pContext;
+    return uSockSendTo(handle, pRemoteAddress, pData, dataSizeBytes);
+}
+
+// Close a uSock socket.
+static int32_t sockClose(void *pContext, int32_t handle)
+{
+    (void) pContext;
+    return uSockClose(handle);
+}
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+// The socket of uDnsServerTable().
+static const uDnsServerPrivateSock_t gSock = {
+    .pOpen = sockOpen,
+    .pReceiveFrom = sockReceiveFrom,
+    .pSendTo = sockSendTo,
+    .pClose = sockClose
+};
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: PRIVATE TO THE DNS SERVER
+ * -------------------------------------------------------------- */
+
+int32_t uDnsServerPrivateRun(const uDnsServerPrivateSock_t *pSock,
+                             void *pContext,
+                             uDeviceHandle_t deviceHandle,
+                             const uDnsServerEntry_t *pTable,
+                             size_t numEntries,
+                             uDnsKeepGoingCallback_t cb)
+{
+    int32_t errorCode;
+    uDnsServerLookup_t lookup;
+    uPortSemaphoreHandle_t semaphoreHandle = NULL;
+    uint8_t *pBuffer = NULL;
+    uSockAddress_t remoteAddr;
+    int32_t sock = -1;
+    int32_t size;
+    size_t length;
+    bool keepGoing = true;
+
+    errorCode = lookupCreate(pTable, numEntries, &lookup);
+    if (errorCode == 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pBuffer = (uint8_t *) pUPortMalloc(U_DNS_SERVER_MESSAGE_MAX_LENGTH_BYTES);
+        if (pBuffer != NULL) {
+            errorCode = uPortSemaphoreCreate(&semaphoreHandle, 0, 1);
         }
     }
-    return uSockClose(sock);
+    if (errorCode == 0) {
+        sock = pSock->pOpen(pContext, U_DNS_SERVER_PRIVATE_PORT,
+                            dataCallback, semaphoreHandle);
+        if (sock < 0) {
+            uPortLog("U_DNS: Failed to create DNS server socket: %d\n", sock);
+            errorCode = sock;
+        }
+    }
+    if (errorCode == 0) {
+        uPortLog("U_DNS: server started\n");
+        while (keepGoing) {
+            // Answer everything that has arrived
+            while ((size = pSock->pReceiveFrom(pContext, sock, &remoteAddr, pBuffer,
+                                               U_DNS_SERVER_MESSAGE_MAX_LENGTH_BYTES)) > 0) {
+                length = answer(&lookup, pBuffer, size, U_DNS_SERVER_MESSAGE_MAX_LENGTH_BYTES);
+                if (length > 0) {
+                    pSock->pSendTo(pContext, sock, &remoteAddr, pBuffer, length);
+                }
+            }
+            // Wait for more; if a query arrived since the last
+            // receive the semaphore has already been given
+            uPortSemaphoreTryTake(semaphoreHandle, U_DNS_SERVER_KEEP_GOING_CHECK_MS);
+            keepGoing = (cb == NULL) || cb(deviceHandle);
+        }
+        errorCode = pSock->pClose(pContext, sock);
+    }
+
+    if (semaphoreHandle != NULL) {
+        uPortSemaphoreDelete(semaphoreHandle);
+    }
+    uPortFree(pBuffer);
+    lookupFree(&lookup);
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+int32_t uDnsServer(uDeviceHandle_t deviceHandle,
+                   const char *pIpAddr,
+                   uDnsKeepGoingCallback_t cb)
+{
+    uDnsServerEntry_t entry = {.pName = "*", .pIpAddress = pIpAddr};
+    return uDnsServerTable(deviceHandle, &entry, 1, cb);
+}
+
+int32_t uDnsServerTable(uDeviceHandle_t deviceHandle,
+                        const uDnsServerEntry_t *pTable,
+                        size_t numEntries,
+                        uDnsKeepGoingCallback_t cb)
+{
+    uDnsServerSock_t sock = {0};
+
+    sock.deviceHandle = deviceHandle;
+    return uDnsServerPrivateRun(&gSock, &sock, deviceHandle,
+                                pTable, numEntries, cb);
 }
+
+// End of file
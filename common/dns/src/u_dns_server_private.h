@@ -0,0 +1,102 @@
+/*
+ * Copyright 2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_DNS_SERVER_PRIVATE_H_
+#define _U_DNS_SERVER_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_sock.h"
+
+/** @file
+ * @brief Functions private to the DNS server, exposed so that the
+ * server can be tested over something other than a real socket.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The UDP port that a DNS server listens on.
+ */
+#define U_DNS_SERVER_PRIVATE_PORT 53
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The datagram socket that a DNS server runs on: uDnsServerTable()
+ * uses one made of uSock calls on the device.
+ */
+typedef struct {
+    /** Open the socket, bind it to port, make it non-blocking and
+     * arrange for pCallback to be called with pCallbackParam when
+     * data arrives; return a handle for the other functions, else
+     * negative error code. */
+    int32_t (*pOpen)(void *pContext, uint16_t port,
+                     void (*pCallback)(void *), void *pCallbackParam);
+    /** Receive a datagram without blocking; return its length,
+     * else negative if there is none. */
+    int32_t (*pReceiveFrom)(void *pContext, int32_t handle,
+                            uSockAddress_t *pRemoteAddress,
+                            void *pData, size_t dataSizeBytes);
+    /** Send a datagram; return the number of bytes sent, else
+     * negative error code. */
+    int32_t (*pSendTo)(void *pContext, int32_t handle,
+                       const uSockAddress_t *pRemoteAddress,
+                       const void *pData, size_t dataSizeBytes);
+    /** Close the socket; return zero on success else negative
+     * error code. */
+    int32_t (*pClose)(void *pContext, int32_t handle);
+} uDnsServerPrivateSock_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Run a DNS server on the given socket; this is what
+ * uDnsServerTable() does with a uSock socket on the device.
+ *
+ * @param[in] pSock    the socket functions; cannot be NULL.
+ * @param[in] pContext passed to the socket functions.
+ * @param deviceHandle passed to cb.
+ * @param[in] pTable   the table, as for uDnsServerTable().
+ * @param numEntries   the number of entries in pTable.
+ * @param cb           the keep-going callback, as for
+ *                     uDnsServerTable().
+ * @return             zero on exit else negative error code.
+ */
+int32_t uDnsServerPrivateRun(const uDnsServerPrivateSock_t *pSock,
+                             void *pContext,
+                             uDeviceHandle_t deviceHandle,
+                             const uDnsServerEntry_t *pTable,
+                             size_t numEntries,
+                             uDnsKeepGoingCallback_t cb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_DNS_SERVER_PRIVATE_H_
+
+// End of file
@@ -0,0 +1,1264 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the DNS server: these should pass on all platforms.
+ * No network device is needed: the server is run over an in-process
+ * loopback which stands in for a UDP socket, the test acting as
+ * the clients.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memcmp()/memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_hex_bin_convert.h"
+
+#include "u_at_client.h"
+
+#include "u_device.h"
+
+#include "u_sock_errno.h"
+#include "u_sock.h"
+
+#include "u_cell_module_type.h"
+#include "u_cell.h"
+#include "u_cell_sock.h"
+
+#include "u_dns_server.h"
+#include "u_dns_server_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_DNS_SERVER_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_DNS_SERVER_TEST_DATAGRAM_MAX_LENGTH_BYTES
+/** The longest datagram that the loopback carries; the queries
+ * and answers of this test are all shorter.
+ */
+# define U_DNS_SERVER_TEST_DATAGRAM_MAX_LENGTH_BYTES 256
+#endif
+
+#ifndef U_DNS_SERVER_TEST_QUEUE_LENGTH
+/** The number of datagrams that the loopback can hold in each
+ * direction; also the size of a burst of queries in the benchmark,
+ * which is what a phone joining an access point sends.
+ */
+# define U_DNS_SERVER_TEST_QUEUE_LENGTH 32
+#endif
+
+#ifndef U_DNS_SERVER_TEST_TASK_STACK_SIZE_BYTES
+/** The stack size of the task that runs the DNS server.
+ */
+# define U_DNS_SERVER_TEST_TASK_STACK_SIZE_BYTES (1024 * 4)
+#endif
+
+#ifndef U_DNS_SERVER_TEST_TASK_PRIORITY
+/** The priority of the task that runs the DNS server.
+ */
+# define U_DNS_SERVER_TEST_TASK_PRIORITY (U_CFG_OS_PRIORITY_MIN + 2)
+#endif
+
+#ifndef U_DNS_SERVER_TEST_ANSWER_TIMEOUT_MS
+/** How long to wait for an answer from the DNS server.
+ */
+# define U_DNS_SERVER_TEST_ANSWER_TIMEOUT_MS 1000
+#endif
+
+#ifndef U_DNS_SERVER_TEST_BENCHMARK_NUM_NAMES
+/** The number of names in the table of the benchmark.
+ */
+# define U_DNS_SERVER_TEST_BENCHMARK_NUM_NAMES 256
+#endif
+
+#ifndef U_DNS_SERVER_TEST_BENCHMARK_NUM_QUERIES
+/** The number of queries made by the benchmark.
+ */
+# define U_DNS_SERVER_TEST_BENCHMARK_NUM_QUERIES 20000
+#endif
+
+#ifndef U_DNS_SERVER_TEST_BENCHMARK_MIN_QPS
+/** The number of queries per second below which the benchmark
+ * fails: far below what it should achieve but far above the ten
+ * per second of a DNS server which polls its socket every 100 ms.
+ */
+# define U_DNS_SERVER_TEST_BENCHMARK_MIN_QPS 500
+#endif
+
+#ifndef U_DNS_SERVER_TEST_USOCK_NUM_QUERIES
+/** The number of queries made, one after the other, of the DNS
+ * server running on a uSock socket of a simulated cellular module.
+ */
+# define U_DNS_SERVER_TEST_USOCK_NUM_QUERIES 20
+#endif
+
+#ifndef U_DNS_SERVER_TEST_USOCK_QUERY_GAP_MS
+/** The gap between an answer and the next query over uSock: long
+ * enough that the DNS server has finished with the answer and gone
+ * back to waiting.
+ */
+# define U_DNS_SERVER_TEST_USOCK_QUERY_GAP_MS 200
+#endif
+
+#ifndef U_DNS_SERVER_TEST_SIM_BUFFER_LENGTH_BYTES
+/** The size of the receive buffer of the simulated cellular module:
+ * room for an AT+USOST carrying an answer in hex.
+ */
+# define U_DNS_SERVER_TEST_SIM_BUFFER_LENGTH_BYTES 1024
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A datagram in the loopback.
+ */
+typedef struct {
+    uSockAddress_t address;
+    size_t length;
+    uint8_t data[U_DNS_SERVER_TEST_DATAGRAM_MAX_LENGTH_BYTES];
+} uDnsServerTestDatagram_t;
+
+/** A queue of datagrams in the loopback.
+ */
+typedef struct {
+    uDnsServerTestDatagram_t datagram[U_DNS_SERVER_TEST_QUEUE_LENGTH];
+    size_t readIndex;
+    size_t numDatagrams;
+} uDnsServerTestQueue_t;
+
+/** The loopback: the DNS server reads what the test writes to
+ * toServer and writes to toClient.
+ */
+typedef struct {
+    uPortMutexHandle_t mutexHandle;
+    uPortSemaphoreHandle_t clientSemaphoreHandle;
+    uDnsServerTestQueue_t toServer;
+    uDnsServerTestQueue_t toClient;
+    bool open;
+    void (*pCallback)(void *);
+    void *pCallbackParam;
+} uDnsServerTestLoopback_t;
+
+/** What to run the DNS server with.
+ */
+typedef struct {
+    const uDnsServerEntry_t *pTable;
+    size_t numEntries;
+} uDnsServerTestRun_t;
+
+/** An answer from the DNS server, decoded.
+ */
+typedef struct {
+    uint16_t id;
+    uint16_t flags;
+    size_t numQuestions;
+    size_t numAnswers;
+    size_t numAdditional;
+    uint16_t answerType;     /**< of the first answer. */
+    size_t addressLength;    /**< of the first answer. */
+    uint8_t address[16];     /**< of the first answer. */
+} uDnsServerTestAnswer_t;
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** A cellular module, simulated on the other end of a back to back
+ * UART, with one UDP socket in hex mode: the test gives it a query
+ * to indicate with +UUSORF, it hands that over in response to
+ * AT+USORF and keeps what arrives with AT+USOST.
+ */
+typedef struct {
+    int32_t uartHandle;
+    volatile bool stop;        /**< set this to stop the simulator task. */
+    volatile bool stopped;     /**< set by the simulator task when it has stopped. */
+    volatile bool sockOpen;    /**< set by the simulator task on AT+USOCR. */
+    char rxBuffer[U_DNS_SERVER_TEST_SIM_BUFFER_LENGTH_BYTES];
+    size_t rxLength;
+    uint8_t query[U_DNS_SERVER_TEST_DATAGRAM_MAX_LENGTH_BYTES];
+    /** Set this, after filling in query, to have the simulator
+     * indicate the query; set back to zero when it has been read. */
+    volatile size_t queryLength;
+    bool queryIndicated;
+    uint8_t answer[U_DNS_SERVER_TEST_DATAGRAM_MAX_LENGTH_BYTES];
+    volatile size_t answerLength;
+    volatile size_t numAnswers; /**< incremented after answer is filled in. */
+    /** The number of times the module has been asked for data
+     * when there was none: each one is a uSock read which waits
+     * for #U_SOCK_RECEIVE_POLL_INTERVAL_MS. */
+    volatile size_t numEmptyReads;
+} uDnsServerTestSim_t;
+#endif
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The loopback.
+ */
+static uDnsServerTestLoopback_t *gpLoopback = NULL;
+
+/** Flag to keep the DNS server going.
+ */
+static volatile bool gKeepGoing = false;
+
+/** Set when the task running the DNS server has exited.
+ */
+static volatile bool gServerExited = true;
+
+/** The value the DNS server returned.
+ */
+static volatile int32_t gServerErrorCode = 0;
+
+/** The table the DNS server is tested with.
+ */
+static const uDnsServerEntry_t gTable[] = {
+    {"setup.example.com", "192.168.4.1"},
+    {"setup.example.com", "fe80:0:0:0:0:0:0:1"},
+    {"Connectivitycheck.GStatic.com.", "10.0.0.3"},
+    {"*.portal.com", "10.0.0.2"},
+    {"*.b.portal.com", "10.0.0.4"}
+};
+
+/** A table with only a catch-all wildcard, as uDnsServer() uses.
+ */
+static const uDnsServerEntry_t gTableCatchAll[] = {
+    {"*", "8.8.8.8"}
+};
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Handle of UART A.
+ */
+static int32_t gUartAHandle = -1;
+
+/** The simulated cellular module, on UART B.
+ */
+static uDnsServerTestSim_t *gpSim = NULL;
+
+/** The simulated cellular module as a device.
+ */
+static uDeviceHandle_t gDevHandle = NULL;
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE LOOPBACK
+ * -------------------------------------------------------------- */
+
+// Add a datagram to a queue; the loopback must be locked.
+static bool queuePush(uDnsServerTestQueue_t *pQueue,
+                      const uSockAddress_t *pAddress,
+                      const void *pData, size_t length)
+{
+    bool success = false;
+    uDnsServerTestDatagram_t *pDatagram;
+    size_t x;
+
+    if ((pQueue->numDatagrams < U_DNS_SERVER_TEST_QUEUE_LENGTH) &&
+        (length <= U_DNS_SERVER_TEST_DATAGRAM_MAX_LENGTH_BYTES)) {
+        x = (pQueue->readIndex + pQueue->numDatagrams) % U_DNS_SERVER_TEST_QUEUE_LENGTH;
+        pDatagram = &(pQueue->datagram[x]);
+        pDatagram->address = *pAddress;
+        pDatagram->length = length;
+        memcpy(pDatagram->data, pData, length);
+        pQueue->numDatagrams++;
+        success = true;
+    }
+
+    return success;
+}
+
+// Take a datagram from a queue, returning its length or
+// -U_SOCK_EWOULDBLOCK; the loopback must be locked.
+static int32_t queuePop(uDnsServerTestQueue_t *pQueue,
+                        uSockAddress_t *pAddress,
+                        void *pData, size_t size)
+{
+    int32_t sizeOrError = -U_SOCK_EWOULDBLOCK;
+    uDnsServerTestDatagram_t *pDatagram;
+
+    if (pQueue->numDatagrams > 0) {
+        pDatagram = &(pQueue->datagram[pQueue->readIndex]);
+        if (size > pDatagram->length) {
+            size = pDatagram->length;
+        }
+        if (pAddress != NULL) {
+            *pAddress = pDatagram->address;
+        }
+        memcpy(pData, pDatagram->data, size);
+        sizeOrError = (int32_t) size;
+        pQueue->readIndex = (pQueue->readIndex + 1) % U_DNS_SERVER_TEST_QUEUE_LENGTH;
+        pQueue->numDatagrams--;
+    }
+
+    return sizeOrError;
+}
+
+// Open the loopback, the DNS server end.
+static int32_t loopbackOpen(void *pContext, uint16_t port,
+                            void (*pCallback)(void *), void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_BUSY;
+    uDnsServerTestLoopback_t *pLoopback = (uDnsServerTestLoopback_t *) pContext;
+
+    U_PORT_MUTEX_LOCK(pLoopback->mutexHandle);
+    if ((port == U_DNS_SERVER_PRIVATE_PORT) && !pLoopback->open) {
+        pLoopback->open = true;
+        pLoopback->pCallback = pCallback;
+        pLoopback->pCallbackParam = pCallbackParam;
+        errorCode = 0;
+    }
+    U_PORT_MUTEX_UNLOCK(pLoopback->mutexHandle);
+
+    return errorCode;
+}
+
+// Receive from the loopback, the DNS server end.
+static int32_t loopbackReceiveFrom(void *pContext, int32_t handle,
+                                   uSockAddress_t *pRemoteAddress,
+                                   void *pData, size_t dataSizeBytes)
+{
+    int32_t sizeOrError;
+    uDnsServerTestLoopback_t *pLoopback = (uDnsServerTestLoopback_t *) pContext;
+
+    (void) handle;
+    U_PORT_MUTEX_LOCK(pLoopback->mutexHandle);
+    sizeOrError = queuePop(&(pLoopback->toServer), pRemoteAddress,
+                           pData, dataSizeBytes);
+    U_PORT_MUTEX_UNLOCK(pLoopback->mutexHandle);
+
+    return sizeOrError;
+}
+
+// Send to the loopback, the DNS server end.
+static int32_t loopbackSendTo(void *pContext, int32_t handle,
+                              const uSockAddress_t *pRemoteAddress,
+                              const void *pData, size_t dataSizeBytes)
+{
+    int32_t sizeOrError = -U_SOCK_ENOBUFS;
+    uDnsServerTestLoopback_t *pLoopback = (uDnsServerTestLoopback_t *) pContext;
+
+    (void) handle;
+    U_PORT_MUTEX_LOCK(pLoopback->mutexHandle);
+    if (queuePush(&(pLoopback->toClient), pRemoteAddress, pData, dataSizeBytes)) {
+        sizeOrError = (int32_t) dataSizeBytes;
+    }
+    U_PORT_MUTEX_UNLOCK(pLoopback->mutexHandle);
+    uPortSemaphoreGive(pLoopback->clientSemaphoreHandle);
+
+    return sizeOrError;
+}
+
+// Close the loopback, the DNS server end.
+static int32_t loopbackClose(void *pContext, int32_t handle)
+{
+    uDnsServerTestLoopback_t *pLoopback = (uDnsServerTestLoopback_t *) pContext;
+
+    (void) handle;
+    U_PORT_MUTEX_LOCK(pLoopback->mutexHandle);
+    pLoopback->open = false;
+    pLoopback->pCallback = NULL;
+    U_PORT_MUTEX_UNLOCK(pLoopback->mutexHandle);
+
+    return 0;
+}
+
+/** The loopback as a DNS server socket.
+ */
+static const uDnsServerPrivateSock_t gLoopbackSock = {
+    .pOpen = loopbackOpen,
+    .pReceiveFrom = loopbackReceiveFrom,
+    .pSendTo = loopbackSendTo,
+    .pClose = loopbackClose
+};
+
+// Send a datagram to the DNS server, from the client with the
+// given port number, calling the data callback as a socket would.
+static bool clientSend(uDnsServerTestLoopback_t *pLoopback, uint16_t port,
+                       const uint8_t *pData, size_t length)
+{
+    bool success;
+    uSockAddress_t address = {0};
+    void (*pCallback)(void *);
+    void *pCallbackParam;
+
+    address.ipAddress.address.ipv4 = 0xc0a80402; // 192.168.4.2
+    address.port = port;
+    U_PORT_MUTEX_LOCK(pLoopback->mutexHandle);
+    success = queuePush(&(pLoopback->toServer), &address, pData, length);
+    pCallback = pLoopback->pCallback;
+    pCallbackParam = pLoopback->pCallbackParam;
+    U_PORT_MUTEX_UNLOCK(pLoopback->mutexHandle);
+    if (success && (pCallback != NULL)) {
+        pCallback(pCallbackParam);
+    }
+
+    return success;
+}
+
+// Receive a datagram from the DNS server, waiting up to timeoutMs.
+static int32_t clientReceive(uDnsServerTestLoopback_t *pLoopback,
+                             uSockAddress_t *pAddress, uint8_t *pData,
+                             size_t size, int32_t timeoutMs)
+{
+    int32_t sizeOrError = -U_SOCK_EWOULDBLOCK;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    do {
+        U_PORT_MUTEX_LOCK(pLoopback->mutexHandle);
+        sizeOrError = queuePop(&(pLoopback->toClient), pAddress, pData, size);
+        U_PORT_MUTEX_UNLOCK(pLoopback->mutexHandle);
+        if (sizeOrError < 0) {
+            uPortSemaphoreTryTake(pLoopback->clientSemaphoreHandle, 10);
+        }
+    } while ((sizeOrError < 0) &&
+             (uPortGetTickTimeMs() - startTimeMs < timeoutMs));
+
+    return sizeOrError;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE DNS SERVER
+ * -------------------------------------------------------------- */
+
+// The keep-going callback of the DNS server.
+static bool keepGoingCallback(uDeviceHandle_t deviceHandle)
+{
+    (void) deviceHandle;
+    return gKeepGoing;
+}
+
+// The task that runs the DNS server.
+static void serverTask(void *pParameters)
+{
+    uDnsServerTestRun_t *pRun = (uDnsServerTestRun_t *) pParameters;
+
+    gServerErrorCode = uDnsServerPrivateRun(&gLoopbackSock, gpLoopback, NULL,
+                                            pRun->pTable, pRun->numEntries,
+                                            keepGoingCallback);
+    gServerExited = true;
+    uPortTaskDelete(NULL);
+}
+
+// Start the DNS server on the loopback, waiting until it is open.
+static bool serverStart(uDnsServerTestRun_t *pRun)
+{
+    uPortTaskHandle_t taskHandle;
+    bool open = false;
+
+    gKeepGoing = true;
+    gServerExited = false;
+    if (uPortTaskCreate(serverTask, "dnsServerTest",
+                        U_DNS_SERVER_TEST_TASK_STACK_SIZE_BYTES,
+                        pRun, U_DNS_SERVER_TEST_TASK_PRIORITY,
+                        &taskHandle) == 0) {
+        for (size_t x = 0; (x < 100) && !open && !gServerExited; x++) {
+            uPortTaskBlock(10);
+            U_PORT_MUTEX_LOCK(gpLoopback->mutexHandle);
+            open = gpLoopback->open;
+            U_PORT_MUTEX_UNLOCK(gpLoopback->mutexHandle);
+        }
+    } else {
+        gServerExited = true;
+    }
+
+    return open;
+}
+
+// Stop the DNS server and wait for its task to exit.
+static void serverStop()
+{
+    gKeepGoing = false;
+    while (!gServerExited) {
+        uPortTaskBlock(10);
+    }
+    // Let the task be deleted
+    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+}
+
+// Create the loopback.
+static bool loopbackCreate()
+{
+    bool success = false;
+
+    gpLoopback = (uDnsServerTestLoopback_t *) pUPortMalloc(sizeof(*gpLoopback));
+    if (gpLoopback != NULL) {
+        memset(gpLoopback, 0, sizeof(*gpLoopback));
+        if (uPortMutexCreate(&(gpLoopback->mutexHandle)) == 0) {
+            if (uPortSemaphoreCreate(&(gpLoopback->clientSemaphoreHandle), 0, 1) == 0) {
+                success = true;
+            } else {
+                uPortMutexDelete(gpLoopback->mutexHandle);
+            }
+        }
+        if (!success) {
+            uPortFree(gpLoopback);
+            gpLoopback = NULL;
+        }
+    }
+
+    return success;
+}
+
+// Delete the loopback.
+static void loopbackDelete()
+{
+    if (gpLoopback != NULL) {
+        uPortSemaphoreDelete(gpLoopback->clientSemaphoreHandle);
+        uPortMutexDelete(gpLoopback->mutexHandle);
+        uPortFree(gpLoopback);
+        gpLoopback = NULL;
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: DNS MESSAGES
+ * -------------------------------------------------------------- */
+
+// Write a 16-bit value in network byte order.
+static uint8_t *pPut16(uint8_t *pData, uint16_t value)
+{
+    *pData++ = (uint8_t) (value >> 8);
+    *pData++ = (uint8_t) value;
+    return pData;
+}
+
+// Read a 16-bit value in network byte order.
+static uint16_t get16(const uint8_t *pData)
+{
+    return (uint16_t) ((((uint16_t) *pData) << 8) | *(pData + 1));
+}
+
+// Make a DNS query, with an EDNS OPT record if edns is true,
+// returning its length.
+static size_t makeQuery(uint8_t *pBuffer, uint16_t id, uint16_t flags,
+                        const char *pName, uint16_t type, bool edns)
+{
+    uint8_t *pData = pBuffer;
+    uint8_t *pLabel;
+
+    pData = pPut16(pData, id);
+    pData = pPut16(pData, flags);
+    pData = pPut16(pData, 1);
+    pData = pPut16(pData, 0);
+    pData = pPut16(pData, 0);
+    pData = pPut16(pData, edns ? 1 : 0);
+    while (*pName != 0) {
+        pLabel = pData;
+        pData++;
+        while ((*pName != 0) && (*pName != '.')) {
+            *pData++ = (uint8_t) *pName++;
+        }
+        *pLabel = (uint8_t) (pData - pLabel - 1);
+        if (*pName == '.') {
+            pName++;
+        }
+    }
+    *pData++ = 0;
+    pData = pPut16(pData, type);
+    pData = pPut16(pData, 1); // IN
+    if (edns) {
+        // Root name, type OPT, UDP payload size 1232, no flags, no data
+        *pData++ = 0;
+        pData = pPut16(pData, 41);
+        pData = pPut16(pData, 1232);
+        pData = pPut16(pData, 0);
+        pData = pPut16(pData, 0);
+        pData = pPut16(pData, 0);
+    }
+
+    return pData - pBuffer;
+}
+
+// Decode a DNS answer, returning true if it is well formed.
+static bool decodeAnswer(const uint8_t *pBuffer, size_t length,
+                         uDnsServerTestAnswer_t *pAnswer)
+{
+    bool success = false;
+    size_t offset = 12;
+
+    memset(pAnswer, 0, sizeof(*pAnswer));
+    if (length >= 12) {
+        pAnswer->id = get16(pBuffer);
+        pAnswer->flags = get16(pBuffer + 2);
+        pAnswer->numQuestions = get16(pBuffer + 4);
+        pAnswer->numAnswers = get16(pBuffer + 6);
+        pAnswer->numAdditional = get16(pBuffer + 10);
+        success = true;
+        if (pAnswer->numQuestions > 0) {
+            while ((offset < length) && (pBuffer[offset] != 0)) {
+                offset += pBuffer[offset] + 1;
+            }
+            offset += 5;
+        }
+        if (pAnswer->numAnswers > 0) {
+            // Name (must be a pointer to the question), type,
+            // class, TTL, length, address
+            success = (offset + 12 <= length) && (get16(pBuffer + offset) == 0xc00c);
+            if (success) {
+                pAnswer->answerType = get16(pBuffer + offset + 2);
+                pAnswer->addressLength = get16(pBuffer + offset + 10);
+                success = (pAnswer->addressLength <= sizeof(pAnswer->address)) &&
+                          (offset + 12 + pAnswer->addressLength <= length);
+                if (success) {
+                    memcpy(pAnswer->address, pBuffer + offset + 12, pAnswer->addressLength);
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+// Send a query to the DNS server and get the answer, returning
+// false if there is none.
+static bool ask(const char *pName, uint16_t type, bool edns,
+                uDnsServerTestAnswer_t *pAnswer)
+{
+    uint8_t buffer[U_DNS_SERVER_TEST_DATAGRAM_MAX_LENGTH_BYTES];
+    size_t length;
+    int32_t size;
+    uSockAddress_t address;
+
+    length = makeQuery(buffer, 0x1234, 0x0100, pName, type, edns);
+    size = -1;
+    if (clientSend(gpLoopback, 5353, buffer, length)) {
+        size = clientReceive(gpLoopback, &address, buffer, sizeof(buffer),
+                             U_DNS_SERVER_TEST_ANSWER_TIMEOUT_MS);
+    }
+
+    return (size > 0) && (address.port == 5353) &&
+           decodeAnswer(buffer, size, pAnswer) && (pAnswer->id == 0x1234);
+}
+
+// Check that an answer has the given response code and, if
+// pAddress is not NULL, that its first record is of the given
+// type with the given address.
+static bool answerIs(const uDnsServerTestAnswer_t *pAnswer, uint16_t rcode,
+                     size_t numAnswers, uint16_t type,
+                     const uint8_t *pAddress, size_t addressLength)
+{
+    bool success = ((pAnswer->flags & 0x800F) == (0x8000 | rcode)) &&
+                   (pAnswer->numAnswers == numAnswers) &&
+                   (pAnswer->numAdditional == 0);
+    if (success && (pAddress != NULL)) {
+        success = (pAnswer->answerType == type) &&
+                  (pAnswer->addressLength == addressLength) &&
+                  (memcmp(pAnswer->address, pAddress, addressLength) == 0);
+    }
+    return success;
+}
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE SIMULATED CELLULAR MODULE
+ * -------------------------------------------------------------- */
+
+// Handle an AT command line arriving at the simulated module,
+// writing any information response to pBuffer and returning
+// its length.
+static int32_t simCommand(uDnsServerTestSim_t *pSim, const char *pLine,
+                          char *pBuffer, size_t bufferSize)
+{
+    int32_t x = 0;
+    int sockHandle;
+    int length;
+    const char *pHex;
+    size_t hexLength;
+
+    if (strstr(pLine, "AT+USOCR") != NULL) {
+        x = snprintf(pBuffer, bufferSize, "\r\n+USOCR: 0\r\n");
+        pSim->sockOpen = true;
+    } else if (sscanf(pLine, "AT+USORF=%d,%d", &sockHandle, &length) == 2) {
+        if (pSim->queryLength == 0) {
+            pSim->numEmptyReads++;
+        }
+        if (length == 0) {
+            // Just asking how much there is
+            x = snprintf(pBuffer, bufferSize, "\r\n+USORF: %d,%d\r\n",
+                         sockHandle, (int) pSim->queryLength);
+        } else if (pSim->queryLength > 0) {
+            x = snprintf(pBuffer, bufferSize, "\r\n+USORF: %d,\"10.0.0.9\",5353,%d,\"",
+                         sockHandle, (int) pSim->queryLength);
+            x += (int32_t) uBinToHex((const char *) pSim->query, pSim->queryLength,
+                                     pBuffer + x);
+            x += snprintf(pBuffer + x, bufferSize - x, "\"\r\n");
+            pSim->queryIndicated = false;
+            pSim->queryLength = 0;
+        } else {
+            x = snprintf(pBuffer, bufferSize, "\r\n+USORF: %d,\"\",0,0,\"\"\r\n",
+                         sockHandle);
+        }
+    } else if (sscanf(pLine, "AT+USOST=%d,", &sockHandle) == 1) {
+        // The data is the last parameter, a quoted hex string
+        pHex = strrchr(pLine, ',');
+        if ((pHex != NULL) && (*(pHex + 1) == '"')) {
+            pHex += 2;
+            hexLength = strlen(pHex);
+            if ((hexLength > 0) && (pHex[hexLength - 1] == '"')) {
+                hexLength--;
+            }
+            if (hexLength / 2 <= sizeof(pSim->answer)) {
+                pSim->answerLength = uHexToBin(pHex, hexLength, (char *) pSim->answer);
+                x = snprintf(pBuffer, bufferSize, "\r\n+USOST: %d,%d\r\n",
+                             sockHandle, (int) pSim->answerLength);
+                pSim->numAnswers++;
+            }
+        }
+    }
+
+    return x;
+}
+
+// Task that pretends to be a cellular module on the other end of
+// UART B, see uDnsServerTestSim_t.
+static void simTask(void *pParameter)
+{
+    uDnsServerTestSim_t *pSim = (uDnsServerTestSim_t *) pParameter;
+    char buffer[(U_DNS_SERVER_TEST_DATAGRAM_MAX_LENGTH_BYTES * 2) + 64];
+    int32_t x;
+    char *pEnd;
+
+    while (!pSim->stop) {
+        x = uPortUartRead(pSim->uartHandle, pSim->rxBuffer + pSim->rxLength,
+                          sizeof(pSim->rxBuffer) - pSim->rxLength - 1);
+        if (x > 0) {
+            pSim->rxLength += x;
+        }
+        // Respond to whole AT command lines
+        while ((pEnd = (char *) memchr(pSim->rxBuffer, '\r', pSim->rxLength)) != NULL) {
+            *pEnd = 0;
+            x = simCommand(pSim, pSim->rxBuffer, buffer, sizeof(buffer));
+            if (x > 0) {
+                uPortUartWrite(pSim->uartHandle, buffer, x);
+            }
+            uPortUartWrite(pSim->uartHandle, "\r\nOK\r\n", 6);
+            pSim->rxLength -= pEnd + 1 - pSim->rxBuffer;
+            memmove(pSim->rxBuffer, pEnd + 1, pSim->rxLength);
+        }
+        if (pSim->rxLength == sizeof(pSim->rxBuffer) - 1) {
+            pSim->rxLength = 0;
+        }
+        // Indicate a new query
+        if ((pSim->queryLength > 0) && !pSim->queryIndicated) {
+            pSim->queryIndicated = true;
+            x = snprintf(buffer, sizeof(buffer), "\r\n+UUSORF: 0,%d\r\n",
+                         (int) pSim->queryLength);
+            uPortUartWrite(pSim->uartHandle, buffer, x);
+        }
+        uPortTaskBlock(1);
+    }
+
+    pSim->stopped = true;
+    uPortTaskDelete(NULL);
+}
+
+// The task that runs the DNS server on the simulated cellular module.
+static void uSockServerTask(void *pParameters)
+{
+    uDnsServerTestRun_t *pRun = (uDnsServerTestRun_t *) pParameters;
+
+    gServerErrorCode = uDnsServerTable(gDevHandle, pRun->pTable, pRun->numEntries,
+                                       keepGoingCallback);
+    gServerExited = true;
+    uPortTaskDelete(NULL);
+}
+
+// Stop the simulated cellular module and close the UARTs.
+static void simStop()
+{
+    if (gpSim != NULL) {
+        gpSim->stop = true;
+        while (!gpSim->stopped) {
+            uPortTaskBlock(10);
+        }
+        // Let the task go away
+        uPortTaskBlock(100);
+        uPortUartClose(gpSim->uartHandle);
+        uPortFree(gpSim);
+        gpSim = NULL;
+    }
+    if (gUartAHandle >= 0) {
+        uPortUartClose(gUartAHandle);
+        gUartAHandle = -1;
+    }
+}
+#endif
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test the answers of the DNS server: names, wildcards, A, AAAA,
+ * NXDOMAIN and malformed queries.
+ *
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the
+ * U_PORT_TEST_FUNCTION() macro.
+ */
+U_PORT_TEST_FUNCTION("[dnsServer]", "dnsServerTable")
+{
+    int32_t resourceCount;
+    uDnsServerTestRun_t run;
+    uDnsServerTestAnswer_t answer;
+    uint8_t buffer[U_DNS_SERVER_TEST_DATAGRAM_MAX_LENGTH_BYTES];
+    size_t length;
+    const uint8_t setupV4[] = {192, 168, 4, 1};
+    const uint8_t setupV6[] = {0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+    const uint8_t checkV4[] = {10, 0, 0, 3};
+    const uint8_t portalV4[] = {10, 0, 0, 2};
+    const uint8_t bPortalV4[] = {10, 0, 0, 4};
+    const uint8_t catchAllV4[] = {8, 8, 8, 8};
+    const uDnsServerEntry_t badTable[] = {{"setup.example.com", "not an address"}};
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(loopbackCreate());
+
+    // A table with a bad address is rejected
+    U_PORT_TEST_ASSERT(uDnsServerPrivateRun(&gLoopbackSock, gpLoopback, NULL,
+                                            badTable, 1, keepGoingCallback) < 0);
+    U_PORT_TEST_ASSERT(uDnsServerPrivateRun(&gLoopbackSock, gpLoopback, NULL,
+                                            NULL, 0, keepGoingCallback) < 0);
+
+    run.pTable = gTable;
+    run.numEntries = sizeof(gTable) / sizeof(gTable[0]);
+    U_TEST_PRINT_LINE("testing a table of %d name(s).", (int) run.numEntries);
+    U_PORT_TEST_ASSERT(serverStart(&run));
+
+    // A name with both an IPv4 and an IPv6 address
+    U_PORT_TEST_ASSERT(ask("setup.example.com", 1, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 1, 1, setupV4, sizeof(setupV4)));
+    U_PORT_TEST_ASSERT((answer.flags & 0x0500) == 0x0500); // AA and RD
+    U_PORT_TEST_ASSERT(ask("setup.example.com", 28, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 1, 28, setupV6, sizeof(setupV6)));
+    U_PORT_TEST_ASSERT(ask("setup.example.com", 255, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 2, 0, NULL, 0));
+    // Case is ignored, in the table and the query, and so is
+    // a trailing dot in the table
+    U_PORT_TEST_ASSERT(ask("SETUP.Example.com", 1, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 1, 1, setupV4, sizeof(setupV4)));
+    U_PORT_TEST_ASSERT(ask("connectivitycheck.gstatic.com", 1, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 1, 1, checkV4, sizeof(checkV4)));
+    // A name with only an IPv4 address asked for IPv6, or for
+    // a type there is never an answer for, has no records
+    U_PORT_TEST_ASSERT(ask("connectivitycheck.gstatic.com", 28, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 0, 0, NULL, 0));
+    U_PORT_TEST_ASSERT(ask("setup.example.com", 65, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 0, 0, NULL, 0));
+    // Wildcards: the most specific wins and a domain is not
+    // matched by its own wildcard
+    U_PORT_TEST_ASSERT(ask("www.portal.com", 1, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 1, 1, portalV4, sizeof(portalV4)));
+    U_PORT_TEST_ASSERT(ask("x.y.a.portal.com", 1, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 1, 1, portalV4, sizeof(portalV4)));
+    U_PORT_TEST_ASSERT(ask("x.y.b.portal.com", 1, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 1, 1, bPortalV4, sizeof(bPortalV4)));
+    U_PORT_TEST_ASSERT(ask("portal.com", 1, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 3, 0, 0, NULL, 0));
+    // Names that are not in the table
+    U_PORT_TEST_ASSERT(ask("example.com", 1, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 3, 0, 0, NULL, 0));
+    U_PORT_TEST_ASSERT(ask("www.u-blox.com", 28, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 3, 0, 0, NULL, 0));
+    // A query with an EDNS OPT record, as phones send, is answered
+    // without one
+    U_PORT_TEST_ASSERT(ask("setup.example.com", 1, true, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 1, 1, setupV4, sizeof(setupV4)));
+
+    // A label that runs off the end is a format error
+    length = makeQuery(buffer, 0x1234, 0x0100, "setup.example.com", 1, false);
+    buffer[12] = 60;
+    U_PORT_TEST_ASSERT(clientSend(gpLoopback, 5353, buffer, length - 10));
+    U_PORT_TEST_ASSERT(clientReceive(gpLoopback, NULL, buffer, sizeof(buffer),
+                                     U_DNS_SERVER_TEST_ANSWER_TIMEOUT_MS) == 12);
+    U_PORT_TEST_ASSERT(decodeAnswer(buffer, 12, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 1, 0, 0, NULL, 0));
+    // An opcode other than QUERY is not implemented
+    length = makeQuery(buffer, 0x1234, 0x1000, "setup.example.com", 1, false);
+    U_PORT_TEST_ASSERT(clientSend(gpLoopback, 5353, buffer, length));
+    U_PORT_TEST_ASSERT(clientReceive(gpLoopback, NULL, buffer, sizeof(buffer),
+                                     U_DNS_SERVER_TEST_ANSWER_TIMEOUT_MS) == 12);
+    U_PORT_TEST_ASSERT(decodeAnswer(buffer, 12, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 4, 0, 0, NULL, 0));
+    // A response is never answered
+    length = makeQuery(buffer, 0x1234, 0x8000, "setup.example.com", 1, false);
+    U_PORT_TEST_ASSERT(clientSend(gpLoopback, 5353, buffer, length));
+    U_PORT_TEST_ASSERT(clientReceive(gpLoopback, NULL, buffer, sizeof(buffer), 200) < 0);
+
+    serverStop();
+    U_PORT_TEST_ASSERT(gServerErrorCode == 0);
+
+    // A catch-all, as uDnsServer() uses
+    run.pTable = gTableCatchAll;
+    run.numEntries = 1;
+    U_TEST_PRINT_LINE("testing a catch-all wildcard.");
+    U_PORT_TEST_ASSERT(serverStart(&run));
+    U_PORT_TEST_ASSERT(ask("www.u-blox.com", 1, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 1, 1, catchAllV4, sizeof(catchAllV4)));
+    U_PORT_TEST_ASSERT(ask("com", 1, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 1, 1, catchAllV4, sizeof(catchAllV4)));
+    U_PORT_TEST_ASSERT(ask("www.u-blox.com", 28, false, &answer));
+    U_PORT_TEST_ASSERT(answerIs(&answer, 0, 0, 0, NULL, 0));
+    serverStop();
+    U_PORT_TEST_ASSERT(gServerErrorCode == 0);
+
+    loopbackDelete();
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Measure how many queries per second the DNS server answers
+ * when they arrive in bursts, as they do from a phone joining an
+ * access point.
+ */
+U_PORT_TEST_FUNCTION("[dnsServer]", "dnsServerBenchmark")
+{
+    int32_t resourceCount;
+    uDnsServerTestRun_t run;
+    uDnsServerEntry_t *pTable;
+    char *pNames;
+    uint8_t buffer[U_DNS_SERVER_TEST_DATAGRAM_MAX_LENGTH_BYTES];
+    char name[32];
+    size_t length;
+    size_t numSent = 0;
+    size_t numAnswered = 0;
+    size_t numGood = 0;
+    size_t burst;
+    size_t x;
+    uint16_t id;
+    int32_t size;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t qps;
+    uDnsServerTestAnswer_t answer;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(loopbackCreate());
+
+    // A table of names host<n>.example.com, each with the address
+    // 10.0.<n / 256>.<n % 256>, plus a catch-all
+    pTable = (uDnsServerEntry_t *) pUPortMalloc((U_DNS_SERVER_TEST_BENCHMARK_NUM_NAMES + 1) *
+                                                sizeof(uDnsServerEntry_t));
+    U_PORT_TEST_ASSERT(pTable != NULL);
+    pNames = (char *) pUPortMalloc((U_DNS_SERVER_TEST_BENCHMARK_NUM_NAMES + 1) * 2 *
+                                   sizeof(name));
+    U_PORT_TEST_ASSERT(pNames != NULL);
+    for (x = 0; x < U_DNS_SERVER_TEST_BENCHMARK_NUM_NAMES; x++) {
+        pTable[x].pName = pNames + (x * 2 * sizeof(name));
+        pTable[x].pIpAddress = pTable[x].pName + sizeof(name);
+        snprintf((char *) pTable[x].pName, sizeof(name), "host%d.example.com", (int) x);
+        snprintf((char *) pTable[x].pIpAddress, sizeof(name), "10.0.%d.%d",
+                 (int) (x >> 8), (int) (x & 0xFF));
+    }
+    pTable[U_DNS_SERVER_TEST_BENCHMARK_NUM_NAMES].pName = "*";
+    pTable[U_DNS_SERVER_TEST_BENCHMARK_NUM_NAMES].pIpAddress = "10.255.255.255";
+    run.pTable = pTable;
+    run.numEntries = U_DNS_SERVER_TEST_BENCHMARK_NUM_NAMES + 1;
+    U_PORT_TEST_ASSERT(serverStart(&run));
+
+    U_TEST_PRINT_LINE("%d queries in bursts of %d, table of %d name(s).",
+                      U_DNS_SERVER_TEST_BENCHMARK_NUM_QUERIES,
+                      U_DNS_SERVER_TEST_QUEUE_LENGTH, (int) run.numEntries);
+    startTimeMs = uPortGetTickTimeMs();
+    while (numSent < U_DNS_SERVER_TEST_BENCHMARK_NUM_QUERIES) {
+        // A burst of queries, one in eight for a name not in the
+        // table, which the catch-all answers
+        burst = 0;
+        while ((burst < U_DNS_SERVER_TEST_QUEUE_LENGTH) &&
+               (numSent < U_DNS_SERVER_TEST_BENCHMARK_NUM_QUERIES)) {
+            id = (uint16_t) numSent;
+            if ((numSent & 7) == 7) {
+                snprintf(name, sizeof(name), "other%d.example.org", (int) numSent);
+            } else {
+                snprintf(name, sizeof(name), "host%d.example.com",
+                         (int) (numSent % U_DNS_SERVER_TEST_BENCHMARK_NUM_NAMES));
+            }
+            length = makeQuery(buffer, id, 0x0100, name, 1, true);
+            U_PORT_TEST_ASSERT(clientSend(gpLoopback, 5353, buffer, length));
+            numSent++;
+            burst++;
+        }
+        // Collect the answers
+        while (burst > 0) {
+            size = clientReceive(gpLoopback, NULL, buffer, sizeof(buffer),
+                                 U_DNS_SERVER_TEST_ANSWER_TIMEOUT_MS);
+            if (size <= 0) {
+                break;
+            }
+            numAnswered++;
+            burst--;
+            if (decodeAnswer(buffer, size, &answer) &&
+                (answer.numAnswers == 1) && (answer.addressLength == 4)) {
+                x = answer.id % U_DNS_SERVER_TEST_BENCHMARK_NUM_NAMES;
+                if ((answer.id & 7) == 7) {
+                    if (answer.address[1] == 255) {
+                        numGood++;
+                    }
+                } else if ((answer.address[2] == (x >> 8)) &&
+                           (answer.address[3] == (x & 0xFF))) {
+                    numGood++;
+                }
+            }
+        }
+        U_PORT_TEST_ASSERT(burst == 0);
+    }
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    if (durationMs < 1) {
+        durationMs = 1;
+    }
+    qps = (int32_t) ((((int64_t) numAnswered) * 1000) / durationMs);
+    U_TEST_PRINT_LINE("%d of %d queries answered, %d correctly, in %d ms: %d queries per second.",
+                      (int) numAnswered, (int) numSent, (int) numGood, durationMs, qps);
+
+    serverStop();
+    U_PORT_TEST_ASSERT(gServerErrorCode == 0);
+    uPortFree(pNames);
+    uPortFree(pTable);
+    loopbackDelete();
+    uPortDeinit();
+
+    U_PORT_TEST_ASSERT(numAnswered == numSent);
+    U_PORT_TEST_ASSERT(numGood == numSent);
+    U_PORT_TEST_ASSERT(qps >= U_DNS_SERVER_TEST_BENCHMARK_MIN_QPS);
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Run the DNS server as uDnsServerTable() does, on a uSock socket,
+ * here of a cellular module simulated on the other end of a back
+ * to back UART, and check that queries made one after the other
+ * are answered without reads of the socket that find nothing, each
+ * of which would wait for the poll interval of a non-blocking uSock
+ * read.
+ */
+U_PORT_TEST_FUNCTION("[dnsServer]", "dnsServerUSock")
+{
+    int32_t resourceCount;
+    uDnsServerTestRun_t run;
+    uDnsServerTestAnswer_t answer;
+    uAtClientHandle_t atClientHandle;
+    uPortTaskHandle_t taskHandle;
+    size_t numAnswers;
+    size_t numGood = 0;
+    size_t numEmptyReads;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t queryTimeMs;
+    int32_t totalTimeMs = 0;
+    int32_t worstTimeMs = 0;
+    const uint8_t portalV4[] = {10, 0, 0, 2};
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    gpSim = (uDnsServerTestSim_t *) pUPortMalloc(sizeof(*gpSim));
+    U_PORT_TEST_ASSERT(gpSim != NULL);
+    memset(gpSim, 0, sizeof(*gpSim));
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+    gpSim->uartHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                      U_CFG_TEST_BAUD_RATE,
+                                      NULL,
+                                      U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                      U_CFG_TEST_PIN_UART_B_TXD,
+                                      U_CFG_TEST_PIN_UART_B_RXD,
+                                      U_CFG_TEST_PIN_UART_B_CTS,
+                                      U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gpSim->uartHandle >= 0);
+    U_PORT_TEST_ASSERT(uPortTaskCreate(simTask, "dnsSimTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       gpSim, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+
+    // uDeviceInit() rather than uCellInit() since uSock initialises
+    // the Wi-Fi sockets layer too
+    U_PORT_TEST_ASSERT(uDeviceInit() == 0);
+    atClientHandle = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                  NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    U_PORT_TEST_ASSERT(uCellAdd(U_CELL_MODULE_TYPE_SARA_R5, atClientHandle,
+                                -1, -1, -1, false, &gDevHandle) == 0);
+    U_PORT_TEST_ASSERT(uCellSockInit() == 0);
+    U_PORT_TEST_ASSERT(uCellSockInitInstance(gDevHandle) == 0);
+    // Hex mode, so that AT+USOST doesn't wait for a prompt
+    U_PORT_TEST_ASSERT(uCellSockHexModeOn(gDevHandle) == 0);
+
+    run.pTable = gTable;
+    run.numEntries = sizeof(gTable) / sizeof(gTable[0]);
+    gKeepGoing = true;
+    gServerExited = false;
+    U_PORT_TEST_ASSERT(uPortTaskCreate(uSockServerTask, "dnsServerTest",
+                                       U_DNS_SERVER_TEST_TASK_STACK_SIZE_BYTES,
+                                       &run, U_DNS_SERVER_TEST_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    startTimeMs = uPortGetTickTimeMs();
+    while (!gpSim->sockOpen && !gServerExited &&
+           (uPortGetTickTimeMs() - startTimeMs < 5000)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gpSim->sockOpen);
+    // Let the server settle into waiting for a query
+    uPortTaskBlock(U_SOCK_RECEIVE_POLL_INTERVAL_MS * 2);
+
+    U_TEST_PRINT_LINE("%d queries, one after the other, over uSock on a"
+                      " simulated cellular module.", U_DNS_SERVER_TEST_USOCK_NUM_QUERIES);
+    numEmptyReads = gpSim->numEmptyReads;
+    durationMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < U_DNS_SERVER_TEST_USOCK_NUM_QUERIES; x++) {
+        uPortTaskBlock(U_DNS_SERVER_TEST_USOCK_QUERY_GAP_MS);
+        numAnswers = gpSim->numAnswers;
+        startTimeMs = uPortGetTickTimeMs();
+        gpSim->queryLength = makeQuery(gpSim->query, (uint16_t) x, 0x0100,
+                                       "www.portal.com", 1, false);
+        while ((gpSim->numAnswers == numAnswers) &&
+               (uPortGetTickTimeMs() - startTimeMs < U_DNS_SERVER_TEST_ANSWER_TIMEOUT_MS)) {
+            uPortTaskBlock(1);
+        }
+        queryTimeMs = uPortGetTickTimeMs() - startTimeMs;
+        totalTimeMs += queryTimeMs;
+        if (queryTimeMs > worstTimeMs) {
+            worstTimeMs = queryTimeMs;
+        }
+        if ((gpSim->numAnswers != numAnswers) &&
+            decodeAnswer(gpSim->answer, gpSim->answerLength, &answer) &&
+            (answer.id == (uint16_t) x) &&
+            answerIs(&answer, 0, 1, 1, portalV4, sizeof(portalV4))) {
+            numGood++;
+        }
+    }
+    durationMs = uPortGetTickTimeMs() - durationMs;
+    numEmptyReads = gpSim->numEmptyReads - numEmptyReads;
+    U_TEST_PRINT_LINE("%d of %d queries answered correctly, average %d ms, worst %d ms,"
+                      " %d read(s) of the socket found nothing (each of which waits %d ms).",
+                      (int) numGood, U_DNS_SERVER_TEST_USOCK_NUM_QUERIES,
+                      totalTimeMs / U_DNS_SERVER_TEST_USOCK_NUM_QUERIES, worstTimeMs,
+                      (int) numEmptyReads, U_SOCK_RECEIVE_POLL_INTERVAL_MS);
+
+    serverStop();
+    U_PORT_TEST_ASSERT(gServerErrorCode == 0);
+    U_PORT_TEST_ASSERT(numGood == U_DNS_SERVER_TEST_USOCK_NUM_QUERIES);
+    // Reading after each answer to see if there is more, which is
+    // what the DNS server used to do, would find nothing every time;
+    // the only reads allowed to find nothing are the sweeps
+    U_PORT_TEST_ASSERT(numEmptyReads <= (size_t) (durationMs / U_DNS_SERVER_SWEEP_INTERVAL_MS) + 1);
+
+    uSockDeinit();
+    uCellSockDeinit();
+    uDeviceDeinit();
+    gDevHandle = NULL;
+    simStop();
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+#endif
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[dnsServer]", "dnsServerCleanUp")
+{
+    if (!gServerExited) {
+        serverStop();
+    }
+    loopbackDelete();
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+    uSockDeinit();
+    uCellSockDeinit();
+    uDeviceDeinit();
+    gDevHandle = NULL;
+    simStop();
+#endif
+    uPortDeinit();
+    // Printed for information: asserting happens in the postamble
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+}
+
+// End of file
@@ -72,10 +72,40 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_NETWORK_BEARERS_MAX_NUM
+/** The maximum number of bearers that may be given to
+ * uNetworkBearerPolicyStart().
+ */
+# define U_NETWORK_BEARERS_MAX_NUM 4
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The state of a network interface on a device, as reported
+ * by uNetworkInterfaceGetState() and to the callback of
+ * uNetworkInterfaceUpStart().
+ */
+typedef enum {
+    U_NETWORK_STATE_DOWN = 0, /**< the network has never been brought
+                                   up or has been taken down. */
+    U_NETWORK_STATE_STARTING, /**< the network is being brought up by
+                                   uNetworkInterfaceUpStart(); while in
+                                   this state uNetworkInterfaceUp() and
+                                   uNetworkSetStatusCallback() for the
+                                   network, and uDeviceClose() for the
+                                   device, will return
+                                   #U_ERROR_COMMON_BUSY, while
+                                   uNetworkInterfaceDown() cancels the
+                                   bring-up. */
+    U_NETWORK_STATE_UP,       /**< the network was brought up
+                                   successfully. */
+    U_NETWORK_STATE_FAILED,   /**< the last attempt to bring the
+                                   network up failed. */
+    U_NETWORK_STATE_MAX_NUM
+} uNetworkState_t;
+
 /** Network status information for BLE.
  */
 typedef struct {
@@ -165,6 +195,59 @@ typedef struct {
     void *pCallbackParameter;
 } uNetworkStatusCallbackData_t;
 
+/** Function signature for the callback of uNetworkInterfaceUpStart(),
+ * called as the bring-up of a network progresses: once with
+ * #U_NETWORK_STATE_STARTING when the bring-up begins and then once
+ * with #U_NETWORK_STATE_UP or #U_NETWORK_STATE_FAILED when it is
+ * done.  The same rules apply as for #uNetworkStatusCallback_t:
+ * do NOT call ubxlib APIs from the callback.
+ *
+ * @param devHandle   the handle of the device.
+ * @param netType     the network type.
+ * @param state       the new state of the network.
+ * @param errorCode   the outcome of the bring-up, zero on success
+ *                    else negative error code; always zero for
+ *                    #U_NETWORK_STATE_STARTING.
+ * @param pParameter  the value of pCallbackParameter as passed to
+ *                    uNetworkInterfaceUpStart().
+ */
+typedef void (*uNetworkStateCallback_t) (uDeviceHandle_t devHandle,
+                                         uNetworkType_t netType,
+                                         uNetworkState_t state,
+                                         int32_t errorCode,
+                                         void *pParameter);
+
+/** A bearer, one entry in the list given to
+ * uNetworkBearerPolicyStart().
+ */
+typedef struct {
+    uDeviceHandle_t devHandle; /**< the handle of the device carrying
+                                    the network. */
+    uNetworkType_t netType;    /**< the network type, which must be one
+                                    that supports a status callback,
+                                    i.e. not #U_NETWORK_TYPE_GNSS. */
+    const void *pCfg;          /**< the network configuration, as would
+                                    be passed to uNetworkInterfaceUp();
+                                    the same rules apply, i.e. this
+                                    must be a true constant. */
+} uNetworkBearer_t;
+
+/** Function signature for the callback of uNetworkBearerPolicyStart(),
+ * called when the active bearer changes.  The same rules apply as
+ * for #uNetworkStatusCallback_t: do NOT call ubxlib APIs from the
+ * callback.
+ *
+ * @param devHandle   the handle of the device carrying the bearer
+ *                    that is now active, NULL if no bearer is up.
+ * @param netType     the network type of the bearer that is now
+ *                    active, #U_NETWORK_TYPE_NONE if no bearer is up.
+ * @param pParameter  the value of pCallbackParameter as passed to
+ *                    uNetworkBearerPolicyStart().
+ */
+typedef void (*uNetworkBearerCallback_t) (uDeviceHandle_t devHandle,
+                                          uNetworkType_t netType,
+                                          void *pParameter);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -225,6 +308,16 @@ int32_t uNetworkInterfaceUp(uDeviceHandle_t devHandle, uNetworkType_t netType,
  * status callback has been set with uNetworkSetStatusCallback(),
  * this will cancel it.
  *
+ * If the network is being brought up by uNetworkInterfaceUpStart()
+ * (or by the bearer policy) this function does not wait: it asks
+ * for the bring-up to be abandoned and returns success.  The
+ * bring-up stops as soon as it can (for cellular at the next call
+ * of the keep-going callback, for Wi-Fi within a second or so),
+ * takes the network down again and then the callback of
+ * uNetworkInterfaceUpStart() is called with #U_NETWORK_STATE_DOWN
+ * and #U_ERROR_COMMON_CANCELLED; until then the state of the network
+ * remains #U_NETWORK_STATE_STARTING.
+ *
  * Note: for a Wi-Fi network, this function uses the
  * uWifiSetConnectionStatusCallback() callback.
  *
@@ -303,6 +396,136 @@ int32_t uNetworkSetStatusCallback(uDeviceHandle_t devHandle,
                                   uNetworkStatusCallback_t pCallback,
                                   void *pCallbackParameter);
 
+/** Start bringing up the given network interface on a device
+ * without blocking: the book-keeping is done, under the device API
+ * lock, before this function returns, the bring-up itself, which
+ * may take minutes in the case of a cellular network, is then carried
+ * out in a task of the network API with the device API lock NOT held,
+ * so that other device and network API calls can go ahead in the
+ * meantime.  Up to U_NETWORK_UP_TASKS_MAX_NUM (by default
+ * #U_NETWORK_BEARERS_MAX_NUM) bring-ups are carried out at once,
+ * each in its own task; any more wait their turn.
+ *
+ * While the bring-up is in progress the state of the network (see
+ * uNetworkInterfaceGetState()) is #U_NETWORK_STATE_STARTING and
+ * uNetworkInterfaceUp() and uNetworkSetStatusCallback() will return
+ * #U_ERROR_COMMON_BUSY for that network, as will uDeviceClose() for
+ * that device; uNetworkInterfaceDown() may be called to cancel the
+ * bring-up.  Once it is done the network can be used exactly as if
+ * uNetworkInterfaceUp() had been called; any status callback
+ * previously set with uNetworkSetStatusCallback() remains in place.
+ *
+ * @param devHandle          the handle of the device carrying the
+ *                           network.
+ * @param netType            which of the network interfaces to bring
+ *                           up.
+ * @param[in] pCfg           a pointer to the configuration for the
+ *                           given network type; the same rules apply
+ *                           as for uNetworkInterfaceUp().
+ * @param[in] pCallback      a callback that will be told of the
+ *                           progress of the bring-up; may be NULL,
+ *                           in which case uNetworkInterfaceGetState()
+ *                           may be polled instead.
+ * @param[in] pCallbackParameter a pointer to be passed to pCallback
+ *                           as its last parameter; may be NULL.
+ * @return                   zero if the bring-up has been started,
+ *                           else negative error code.
+ */
+int32_t uNetworkInterfaceUpStart(uDeviceHandle_t devHandle,
+                                 uNetworkType_t netType,
+                                 const void *pCfg,
+                                 uNetworkStateCallback_t pCallback,
+                                 void *pCallbackParameter);
+
+/** Get the state of the given network interface on a device.  The
+ * state is #U_NETWORK_STATE_UP if the network was brought up
+ * successfully by uNetworkInterfaceUp() or uNetworkInterfaceUpStart();
+ * it does NOT follow the fortunes of the network after that, use
+ * uNetworkSetStatusCallback() for that.
+ *
+ * @param devHandle the handle of the device.
+ * @param netType   the network type.
+ * @return          the state of the network, a value from
+ *                  #uNetworkState_t, else negative error code.
+ */
+int32_t uNetworkInterfaceGetState(uDeviceHandle_t devHandle,
+                                  uNetworkType_t netType);
+
+/** Start a multi-bearer policy: pBearers is a list of networks in
+ * order of preference (e.g. Wi-Fi first, cellular second) and the
+ * "active" bearer is the most preferred one that is up.  The bearers
+ * are brought up, and kept up, in the tasks used by
+ * uNetworkInterfaceUpStart(), each bearer in a task of its own where
+ * U_NETWORK_UP_TASKS_MAX_NUM allows, so that a slow bearer does not
+ * hold up the others; when the active bearer is lost (as
+ * reported by its network status callback) the next one that is up
+ * becomes active and, when a more preferred bearer comes back, it
+ * becomes active again; pCallback is called on every change.
+ *
+ * If preWarm is true all of the bearers are brought up at the start,
+ * so that the standby bearers are ready to take over at once; this
+ * costs power but cuts the time to switch bearers from that of a
+ * network bring-up (seconds to minutes) to that of an event queue
+ * hop.  If preWarm is false a bearer is only brought up when all of
+ * the more preferred bearers have failed.
+ *
+ * Only one policy may be active at a time.  The policy puts its own
+ * network status callback in front of any that the application has
+ * set for a bearer with uNetworkSetStatusCallback(), and calls the
+ * application's callback from its own; uNetworkSetStatusCallback()
+ * may be called as normal while the policy is active and the
+ * application's callback is put back by uNetworkBearerPolicyStop().
+ * Cellular bearers recover by themselves
+ * after a loss of service; other bearers that are lost are brought
+ * up again by the policy, an attempt being made each time the state
+ * of any bearer changes.
+ *
+ * @param[in] pBearers           the list of bearers, most preferred
+ *                               first; a copy is taken.
+ * @param numBearers             the number of entries at pBearers,
+ *                               at most #U_NETWORK_BEARERS_MAX_NUM.
+ * @param preWarm                if true, bring all of the bearers up,
+ *                               else only bring a bearer up when all
+ *                               of the more preferred ones are down.
+ * @param[in] pCallback          called when the active bearer changes;
+ *                               may be NULL.
+ * @param[in] pCallbackParameter a pointer to be passed to pCallback as
+ *                               its last parameter; may be NULL.
+ * @return                       zero on success else negative error
+ *                               code.
+ */
+int32_t uNetworkBearerPolicyStart(const uNetworkBearer_t *pBearers,
+                                  size_t numBearers, bool preWarm,
+                                  uNetworkBearerCallback_t pCallback,
+                                  void *pCallbackParameter);
+
+/** Get the active bearer of the policy started with
+ * uNetworkBearerPolicyStart().
+ *
+ * @param[out] pDevHandle a place to put the handle of the device
+ *                        carrying the active bearer; may be NULL.
+ * @param[out] pNetType   a place to put the network type of the
+ *                        active bearer; may be NULL.
+ * @return                the index of the active bearer in the list
+ *                        passed to uNetworkBearerPolicyStart(), else
+ *                        negative error code, e.g.
+ *                        #U_ERROR_COMMON_NOT_FOUND if no bearer is up.
+ */
+int32_t uNetworkBearerGetActive(uDeviceHandle_t *pDevHandle,
+                                uNetworkType_t *pNetType);
+
+/** Stop the policy started with uNetworkBearerPolicyStart().  The
+ * network status callbacks of the bearers are returned to those set
+ * by the application, if any.
+ *
+ * @param takeDown if true then all of the bearers are also taken
+ *                 down, any bring-up still in progress being
+ *                 cancelled as described for uNetworkInterfaceDown(),
+ *                 else they are left as they are.
+ * @return         zero on success else negative error code.
+ */
+int32_t uNetworkBearerPolicyStop(bool takeDown);
+
 #ifdef __cplusplus
 }
 #endif
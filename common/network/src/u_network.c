@@ -39,13 +39,18 @@
 
 #include "u_network_shared.h"
 
+#include "u_cfg_os_platform_specific.h" // U_CFG_OS_APP_TASK_PRIORITY
+
 #include "u_port_os.h"
 #include "u_port_heap.h"
+#include "u_port_event_queue.h"
 #include "u_port_board_cfg.h"
 
 #include "u_location.h"
 #include "u_location_shared.h"
 
+#include "u_sock.h" // uSockDnsCacheFlush()
+
 #include "u_network.h"
 #include "u_network_config_ble.h"
 #include "u_network_config_cell.h"
@@ -60,10 +65,116 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_NETWORK_TASK_STACK_SIZE_BYTES
+/** The stack size of the tasks in which uNetworkInterfaceUpStart()
+ * and the bearer policy bring networks up, the bearer policy does
+ * its work and the callbacks of both are called.
+ */
+# define U_NETWORK_TASK_STACK_SIZE_BYTES 3072
+#endif
+
+#ifndef U_NETWORK_TASK_PRIORITY
+/** The priority of the tasks in which uNetworkInterfaceUpStart()
+ * and the bearer policy bring networks up and the bearer policy
+ * does its work.
+ */
+# define U_NETWORK_TASK_PRIORITY U_CFG_OS_APP_TASK_PRIORITY
+#endif
+
+#ifndef U_NETWORK_QUEUE_LENGTH
+/** The number of events that may be queued for each of the network
+ * API tasks before the sender blocks.
+ */
+# define U_NETWORK_QUEUE_LENGTH 4
+#endif
+
+#ifndef U_NETWORK_UP_TASKS_MAX_NUM
+/** The maximum number of tasks in which networks are brought up,
+ * i.e. the number of bring-ups that may be in progress at once;
+ * the tasks are created as they are needed and remain until
+ * uDeviceDeinit() is called.
+ */
+# define U_NETWORK_UP_TASKS_MAX_NUM U_NETWORK_BEARERS_MAX_NUM
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The things that can be done in the network event queues.
+ */
+typedef enum {
+    U_NETWORK_EVENT_UP,             /**< a bring-up, performed in one
+                                         of the bring-up event queues. */
+    U_NETWORK_EVENT_BEARER_EVALUATE /**< a bearer has changed state,
+                                         re-evaluate the bearer policy;
+                                         performed in the network event
+                                         queue. */
+} uNetworkEventType_t;
+
+/** An event passed through the network event queues.
+ */
+typedef struct {
+    uNetworkEventType_t type;
+    uDeviceHandle_t devHandle;
+    uNetworkType_t netType;
+    uNetworkStateCallback_t pCallback;
+    void *pCallbackParameter;
+    size_t upQueue;            /**< the index into gUpQueue[] of the
+                                    bring-up event queue this event was
+                                    sent to. */
+    int32_t bearerIndex;       /**< for a bring-up by the bearer policy
+                                    the index of the bearer, else -1. */
+    uint32_t bearerGeneration; /**< the generation of the bearer policy
+                                    that asked for the bring-up. */
+} uNetworkEvent_t;
+
+/** A bring-up event queue.
+ */
+typedef struct {
+    bool isOpen;
+    int32_t handle;
+    size_t numQueued; /**< the number of bring-ups sent to the
+                           event queue that are not yet done. */
+} uNetworkUpQueue_t;
+
+/** A bearer of the bearer policy and what we know of it.
+ */
+typedef struct {
+    uNetworkBearer_t bearer;
+    bool starting;        /**< true while the policy is bringing the
+                               bearer up. */
+    bool broughtUp;       /**< true once the policy has brought the
+                               bearer up. */
+    bool linkUp;          /**< true if the bearer is up, as last
+                               reported by its status callback. */
+    bool callbackInstalled; /**< true if bearerStatusCallback() has been
+                                 set as the status callback of the
+                                 bearer, the callback of the application,
+                                 if any, being kept below. */
+    uNetworkStatusCallback_t pUserCallback;
+    void *pUserCallbackParameter;
+} uNetworkBearerEntry_t;
+
+/** The bearer policy.
+ */
+typedef struct {
+    bool active; /**< true between uNetworkBearerPolicyStart() and
+                      uNetworkBearerPolicyStop(). */
+    uint32_t generation; /**< incremented by each
+                              uNetworkBearerPolicyStart(), so that a
+                              bring-up can tell if the policy that
+                              asked for it has gone. */
+    bool preWarm;
+    uNetworkBearerEntry_t entry[U_NETWORK_BEARERS_MAX_NUM];
+    size_t numBearers;
+    int32_t activeIndex; /**< index of the active bearer, -1 if none. */
+    uNetworkBearerCallback_t pCallback;
+    void *pCallbackParameter;
+    bool evaluatePending; /**< an evaluate event is in the queue. */
+    bool busy; /**< the event queue task is working on the policy. */
+} uNetworkBearerPolicy_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -78,12 +189,48 @@ static const size_t gNetworkCfgSize[] = {
     sizeof(uNetworkCfgGnss_t)  // U_NETWORK_TYPE_GNSS
 };
 
+/** Handle of the event queue in which the bearer policy does its
+ * work, opened on first use and protected by the device API lock.
+ */
+static int32_t gEventQueueHandle = -1;
+
+/** The event queues in which networks are brought up, each opened
+ * when it is first needed, so that one long bring-up does not hold
+ * up another; protected by the device API lock.
+ */
+static uNetworkUpQueue_t gUpQueue[U_NETWORK_UP_TASKS_MAX_NUM] = {0};
+
+/** The bearer policy, protected by the device API lock; the
+ * linkUp, evaluatePending and busy fields are instead protected by
+ * gBearerPolicyMutex, since network status callbacks cannot take
+ * the device API lock, and anything written under the device API
+ * lock that bearerStatusCallback() reads is written with
+ * gBearerPolicyMutex held as well.
+ */
+static uNetworkBearerPolicy_t gBearerPolicy = {0};
+
+/** Mutex protecting the parts of gBearerPolicy that network status
+ * callbacks touch: it may be taken with the device API lock held
+ * but not the other way around and it is never held across a
+ * bring-up, a send to an event queue or a call to the application.
+ * Created with the network event queue.
+ */
+static uPortMutexHandle_t gBearerPolicyMutex = NULL;
+
+/** Given by the network event queue task when it has finished
+ * working on the bearer policy, for uNetworkBearerPolicyStop()
+ * to wait on.  Created with the network event queue.
+ */
+static uPortSemaphoreHandle_t gBearerPolicyIdleSemaphore = NULL;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
 // Bring a network up or down.
-// This must be called between uDeviceLock() and uDeviceUnlock().
+// This must be called between uDeviceLock() and uDeviceUnlock()
+// or, when bringing a network up, while the network is in state
+// U_NETWORK_STATE_STARTING, which keeps everyone else off it.
 static int32_t networkInterfaceChangeState(uDeviceHandle_t devHandle,
                                            uNetworkType_t netType,
                                            const void *pNetworkCfg,
@@ -168,10 +315,622 @@ static bool cfgEnsureMemory(uDeviceNetworkData_t *pNetworkData,
     return success;
 }
 
+// Do the book-keeping for bringing a network up: find or allocate
+// the network data for netType on the device and store the
+// configuration there.  On success *ppNetworkData is populated.
+// This must be called between uDeviceLock() and uDeviceUnlock().
+static int32_t upPrepare(uDeviceHandle_t devHandle, uNetworkType_t netType,
+                         const void *pCfg,
+                         uDeviceNetworkData_t **ppNetworkData)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uDeviceInstance_t *pDeviceInstance;
+    uDeviceNetworkData_t *pNetworkData;
+
+    if ((uDeviceGetInstance(devHandle, &pDeviceInstance) == 0) &&
+        (netType >= U_NETWORK_TYPE_NONE) &&
+        (netType < U_NETWORK_TYPE_MAX_NUM)) {
+        pNetworkData = pUNetworkGetNetworkData(pDeviceInstance, netType);
+        if (pNetworkData == NULL) {
+            // No network of this type has yet been brought up on
+            // this device
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pNetworkData = pUNetworkGetNetworkData(pDeviceInstance, U_NETWORK_TYPE_NONE);
+        }
+        if (pNetworkData != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_BUSY;
+            if (pNetworkData->state != (int32_t) U_NETWORK_STATE_STARTING) {
+                pNetworkData->networkType = (int32_t) netType;
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                // We potentially want to change the configuration,
+                // so allocate memory to store it here
+                // This memory is free'd when the device is closed
+                if (cfgEnsureMemory(pNetworkData, pCfg)) {
+                    // Allow the network configuration from the board
+                    // configuration of the platform to override what
+                    // we were given; only used by Zephyr
+                    errorCode = uPortBoardCfgNetwork(devHandle, netType,
+                                                     pNetworkData->pCfg);
+                    if (errorCode == 0) {
+                        *ppNetworkData = pNetworkData;
+                    }
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Set the status callback of a network: the guts of
+// uNetworkSetStatusCallback().
+// This must be called between uDeviceLock() and uDeviceUnlock().
+static int32_t statusCallbackSet(uDeviceHandle_t devHandle,
+                                 uNetworkType_t netType,
+                                 uNetworkStatusCallback_t pCallback,
+                                 void *pCallbackParameter)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uDeviceInstance_t *pInstance;
+    uDeviceNetworkData_t *pNetworkData;
+    uNetworkStatusCallbackData_t *pStatusCallbackData;
+
+    if ((uDeviceGetInstance(devHandle, &pInstance) == 0) &&
+        (netType >= U_NETWORK_TYPE_NONE) &&
+        (netType < U_NETWORK_TYPE_MAX_NUM)) {
+        // If pNetworkData is NULL then this network has not
+        // been brought up
+        pNetworkData = pUNetworkGetNetworkData(pInstance, netType);
+        if ((pNetworkData != NULL) &&
+            (pNetworkData->state == (int32_t) U_NETWORK_STATE_STARTING)) {
+            errorCode = (int32_t) U_ERROR_COMMON_BUSY;
+        } else if (pNetworkData != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            // Allocate space for the status callback data
+            // and attach it to the network data block;
+            // the various callback functions can then
+            // obtain it from there with a call to
+            // pUNetworkGetNetworkData()
+            if (pNetworkData->pStatusCallbackData == NULL) {
+                pNetworkData->pStatusCallbackData = pUPortMalloc(sizeof(uNetworkStatusCallbackData_t));
+            }
+            pStatusCallbackData = (uNetworkStatusCallbackData_t *) pNetworkData->pStatusCallbackData;
+            if (pStatusCallbackData != NULL) {
+                pStatusCallbackData->pCallback = pCallback;
+                pStatusCallbackData->pCallbackParameter = pCallbackParameter;
+                errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+                switch (netType) {
+                    case U_NETWORK_TYPE_BLE:
+                        errorCode = uNetworkSetStatusCallbackBle(devHandle);
+                        break;
+                    case U_NETWORK_TYPE_CELL:
+                        errorCode = uNetworkSetStatusCallbackCell(devHandle);
+                        break;
+                    case U_NETWORK_TYPE_WIFI:
+                        errorCode = uNetworkSetStatusCallbackWifi(devHandle);
+                        break;
+                    case U_NETWORK_TYPE_GNSS:
+                        // Not relevant to GNSS
+                        break;
+                    default:
+                        break;
+                }
+                if (errorCode != 0) {
+                    uPortFree(pNetworkData->pStatusCallbackData);
+                    pNetworkData->pStatusCallbackData = NULL;
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the bearer policy entry for a network, NULL if the network
+// is not a bearer of an active policy.
+// This must be called between uDeviceLock() and uDeviceUnlock().
+static uNetworkBearerEntry_t *pBearerEntryGet(uDeviceHandle_t devHandle,
+                                              uNetworkType_t netType)
+{
+    uNetworkBearerEntry_t *pEntry = NULL;
+
+    for (size_t x = 0; gBearerPolicy.active && (x < gBearerPolicy.numBearers) &&
+         (pEntry == NULL); x++) {
+        if ((gBearerPolicy.entry[x].bearer.devHandle == devHandle) &&
+            (gBearerPolicy.entry[x].bearer.netType == netType)) {
+            pEntry = &(gBearerPolicy.entry[x]);
+        }
+    }
+
+    return pEntry;
+}
+
+// Bring up a network that upPrepare() has been called for and that
+// has been put into state U_NETWORK_STATE_STARTING, WITHOUT holding
+// the device API lock during the bring-up itself.  If
+// uNetworkInterfaceDown() is called meanwhile the network is taken
+// down again, U_ERROR_COMMON_CANCELLED is returned and the network
+// ends up in state U_NETWORK_STATE_DOWN.
+// This must NOT be called between uDeviceLock() and uDeviceUnlock().
+static int32_t upRun(uDeviceHandle_t devHandle, uNetworkType_t netType)
+{
+    int32_t errorCode = uDeviceLock();
+    uDeviceInstance_t *pDeviceInstance;
+    uDeviceNetworkData_t *pNetworkData = NULL;
+    const void *pCfg = NULL;
+    bool cancelled = false;
+    bool done = false;
+
+    if (errorCode == 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (uDeviceGetInstance(devHandle, &pDeviceInstance) == 0) {
+            pNetworkData = pUNetworkGetNetworkData(pDeviceInstance, netType);
+            if (pNetworkData != NULL) {
+                // The configuration can't go away while we're in
+                // state U_NETWORK_STATE_STARTING since the device
+                // can't be closed
+                pCfg = pNetworkData->pCfg;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+        uDeviceUnlock();
+
+        if (errorCode == 0) {
+            errorCode = networkInterfaceChangeState(devHandle, netType,
+                                                    pCfg, true);
+            while (!done && (uDeviceLock() == 0)) {
+                if (pNetworkData->cancel) {
+                    // uNetworkInterfaceDown() has been called: take
+                    // the network down again, still in state
+                    // U_NETWORK_STATE_STARTING so that nobody
+                    // else touches it, then check again
+                    pNetworkData->cancel = false;
+                    uDeviceUnlock();
+                    networkInterfaceChangeState(devHandle, netType,
+                                                pCfg, false);
+                    errorCode = (int32_t) U_ERROR_COMMON_CANCELLED;
+                    cancelled = true;
+                } else {
+                    pNetworkData->state = (errorCode == 0) ? (int32_t) U_NETWORK_STATE_UP :
+                                          (int32_t) U_NETWORK_STATE_FAILED;
+                    if (cancelled) {
+                        // Tidy up as uNetworkInterfaceDown() would have
+                        pNetworkData->state = (int32_t) U_NETWORK_STATE_DOWN;
+                        uSockDnsCacheFlush(devHandle);
+                        uPortFree(pNetworkData->pStatusCallbackData);
+                        pNetworkData->pStatusCallbackData = NULL;
+                    }
+                    uDeviceUnlock();
+                    done = true;
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Pick the least busy of the open bring-up event queues and count
+// a bring-up against it; returns the index into gUpQueue[] or
+// negative error code.  upQueuesEnsure() opens the queues.
+// This must be called between uDeviceLock() and uDeviceUnlock().
+static int32_t upQueueGet()
+{
+    int32_t errorCodeOrIndex = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+
+    for (size_t x = 0; x < sizeof(gUpQueue) / sizeof(gUpQueue[0]); x++) {
+        if (gUpQueue[x].isOpen &&
+            ((errorCodeOrIndex < 0) ||
+             (gUpQueue[x].numQueued < gUpQueue[errorCodeOrIndex].numQueued))) {
+            errorCodeOrIndex = (int32_t) x;
+        }
+    }
+    if (errorCodeOrIndex >= 0) {
+        gUpQueue[errorCodeOrIndex].numQueued++;
+    }
+
+    return errorCodeOrIndex;
+}
+
+// Send a bring-up event to the bring-up event queue that
+// upQueueGet() picked for it, undoing the book-keeping of
+// upQueueGet() and upPrepare() if that fails.
+// This must NOT be called between uDeviceLock() and uDeviceUnlock(),
+// since the send may block until the event queue task, which needs
+// the lock, has room.
+static int32_t upQueueSend(uNetworkEvent_t *pEvent,
+                           uDeviceNetworkData_t *pNetworkData)
+{
+    int32_t errorCode = uPortEventQueueSend(gUpQueue[pEvent->upQueue].handle,
+                                            pEvent, sizeof(*pEvent));
+
+    if ((errorCode != 0) && (uDeviceLock() == 0)) {
+        gUpQueue[pEvent->upQueue].numQueued--;
+        pNetworkData->state = (int32_t) U_NETWORK_STATE_FAILED;
+        pNetworkData->cancel = false;
+        uDeviceUnlock();
+    }
+
+    return errorCode;
+}
+
+// Queue a re-evaluation of the bearer policy unless one is already
+// queued; this may be called from a network status callback, hence
+// does not lock the device API.  Network status callbacks are run
+// in task context, not from interrupts, so a normal send is fine
+// (uPortEventQueueSendIrq() is not supported on all platforms).
+// This must NOT be called with gBearerPolicyMutex locked, since
+// the send may block until the network event queue task, which
+// needs the mutex, has room.
+static void bearerEvaluateQueue()
+{
+    uNetworkEvent_t event;
+    int32_t eventQueueHandle = gEventQueueHandle;
+    bool send = false;
+
+    if ((gBearerPolicyMutex != NULL) && (eventQueueHandle >= 0)) {
+        U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+        if (gBearerPolicy.active && !gBearerPolicy.evaluatePending) {
+            gBearerPolicy.evaluatePending = true;
+            send = true;
+        }
+        U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+        if (send) {
+            memset(&event, 0, sizeof(event));
+            event.type = U_NETWORK_EVENT_BEARER_EVALUATE;
+            event.bearerIndex = -1;
+            if (uPortEventQueueSend(eventQueueHandle, &event, sizeof(event)) != 0) {
+                U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+                gBearerPolicy.evaluatePending = false;
+                U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+            }
+        }
+    }
+}
+
+// Network status callback for the bearers of the bearer policy;
+// notes what has happened, hands over to the event queue and then
+// calls the status callback the application has set, if any.
+static void bearerStatusCallback(uDeviceHandle_t devHandle,
+                                 uNetworkType_t netType,
+                                 bool isUp,
+                                 uNetworkStatus_t *pStatus,
+                                 void *pParameter)
+{
+    uNetworkBearerEntry_t *pEntry;
+    uNetworkStatusCallback_t pUserCallback = NULL;
+    void *pUserCallbackParameter = NULL;
+
+    (void) pParameter;
+
+    if (gBearerPolicyMutex != NULL) {
+        U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+        for (size_t x = 0; x < gBearerPolicy.numBearers; x++) {
+            pEntry = &(gBearerPolicy.entry[x]);
+            if ((pEntry->bearer.devHandle == devHandle) &&
+                (pEntry->bearer.netType == netType)) {
+                pEntry->linkUp = isUp;
+                pUserCallback = pEntry->pUserCallback;
+                pUserCallbackParameter = pEntry->pUserCallbackParameter;
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+    }
+    bearerEvaluateQueue();
+
+    if (pUserCallback != NULL) {
+        pUserCallback(devHandle, netType, isUp, pStatus, pUserCallbackParameter);
+    }
+}
+
+// Work out which bearer should be active and, if that is a change,
+// tell the user.
+// This must NOT be called between uDeviceLock() and uDeviceUnlock().
+static void bearerSelect()
+{
+    int32_t activeIndex = -1;
+    bool changed = false;
+    uDeviceHandle_t devHandle = NULL;
+    uNetworkType_t netType = U_NETWORK_TYPE_NONE;
+    uNetworkBearerCallback_t pCallback = NULL;
+    void *pCallbackParameter = NULL;
+
+    if (uDeviceLock() == 0) {
+        if (gBearerPolicy.active) {
+            U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+            for (size_t x = 0; (x < gBearerPolicy.numBearers) && (activeIndex < 0); x++) {
+                if (gBearerPolicy.entry[x].linkUp) {
+                    activeIndex = (int32_t) x;
+                    devHandle = gBearerPolicy.entry[x].bearer.devHandle;
+                    netType = gBearerPolicy.entry[x].bearer.netType;
+                }
+            }
+            U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+            if (activeIndex != gBearerPolicy.activeIndex) {
+                gBearerPolicy.activeIndex = activeIndex;
+                pCallback = gBearerPolicy.pCallback;
+                pCallbackParameter = gBearerPolicy.pCallbackParameter;
+                changed = true;
+            }
+        }
+        uDeviceUnlock();
+    }
+
+    // Call the user outside the lock
+    if (changed && (pCallback != NULL)) {
+        pCallback(devHandle, netType, pCallbackParameter);
+    }
+}
+
+// Start bringing up the given bearer of the bearer policy, if it
+// needs it, in a bring-up event queue of its own, so that a slow
+// bearer does not hold up the others.
+// This must NOT be called between uDeviceLock() and uDeviceUnlock().
+static void bearerUpStart(size_t index)
+{
+    bool needed = false;
+    uNetworkEvent_t event;
+    uDeviceNetworkData_t *pNetworkData = NULL;
+    uNetworkBearerEntry_t *pEntry = &(gBearerPolicy.entry[index]);
+    int32_t upQueue = -1;
+
+    memset(&event, 0, sizeof(event));
+    if (uDeviceLock() == 0) {
+        if (gBearerPolicy.active && !pEntry->starting &&
+            // Cellular looks after itself once it has been brought up
+            (!pEntry->broughtUp || (pEntry->bearer.netType != U_NETWORK_TYPE_CELL))) {
+            // Without pre-warming, a bearer is only needed if it
+            // and all of the more preferred ones are down
+            U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+            needed = !pEntry->linkUp;
+            for (size_t x = 0; (x < index) && needed && !gBearerPolicy.preWarm; x++) {
+                if (gBearerPolicy.entry[x].linkUp) {
+                    needed = false;
+                }
+            }
+            U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+            if (needed &&
+                (upPrepare(pEntry->bearer.devHandle, pEntry->bearer.netType,
+                           pEntry->bearer.pCfg, &pNetworkData) == 0)) {
+                upQueue = upQueueGet();
+                if (upQueue >= 0) {
+                    pNetworkData->state = (int32_t) U_NETWORK_STATE_STARTING;
+                    pEntry->starting = true;
+                    event.type = U_NETWORK_EVENT_UP;
+                    event.devHandle = pEntry->bearer.devHandle;
+                    event.netType = pEntry->bearer.netType;
+                    event.upQueue = (size_t) upQueue;
+                    event.bearerIndex = (int32_t) index;
+                    event.bearerGeneration = gBearerPolicy.generation;
+                }
+            }
+        }
+        uDeviceUnlock();
+    }
+
+    if ((upQueue >= 0) && (upQueueSend(&event, pNetworkData) != 0) &&
+        (uDeviceLock() == 0)) {
+        if (gBearerPolicy.generation == event.bearerGeneration) {
+            pEntry->starting = false;
+        }
+        uDeviceUnlock();
+    }
+}
+
+// Called in the bring-up event queue when a bring-up of a bearer
+// of the bearer policy is done: if it worked, put our status
+// callback in front of that of the application and have the
+// policy re-evaluated.
+// This must NOT be called between uDeviceLock() and uDeviceUnlock().
+static void bearerUpDone(const uNetworkEvent_t *pEvent, int32_t errorCode)
+{
+    uNetworkBearerEntry_t *pEntry;
+    uDeviceInstance_t *pInstance;
+    uDeviceNetworkData_t *pNetworkData;
+    uNetworkStatusCallbackData_t *pStatusCallbackData;
+    bool evaluate = false;
+
+    if (uDeviceLock() == 0) {
+        // Nothing to do if the policy that asked for the
+        // bring-up has since been stopped
+        if (gBearerPolicy.active &&
+            (gBearerPolicy.generation == pEvent->bearerGeneration)) {
+            pEntry = &(gBearerPolicy.entry[pEvent->bearerIndex]);
+            pEntry->starting = false;
+            if ((errorCode == 0) &&
+                (uDeviceGetInstance(pEvent->devHandle, &pInstance) == 0)) {
+                pEntry->broughtUp = true;
+                U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+                pEntry->linkUp = true;
+                if (!pEntry->callbackInstalled) {
+                    // Keep any status callback the application has set
+                    pNetworkData = pUNetworkGetNetworkData(pInstance, pEvent->netType);
+                    if ((pNetworkData != NULL) && (pNetworkData->pStatusCallbackData != NULL)) {
+                        pStatusCallbackData = (uNetworkStatusCallbackData_t *)
+                                              pNetworkData->pStatusCallbackData;
+                        pEntry->pUserCallback = pStatusCallbackData->pCallback;
+                        pEntry->pUserCallbackParameter = pStatusCallbackData->pCallbackParameter;
+                    }
+                }
+                U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+                pEntry->callbackInstalled = (statusCallbackSet(pEvent->devHandle,
+                                                               pEvent->netType,
+                                                               bearerStatusCallback,
+                                                               NULL) == 0);
+                evaluate = true;
+            }
+        }
+        uDeviceUnlock();
+    }
+
+    // A failed bring-up is retried the next time the state
+    // of a bearer changes
+    if (evaluate) {
+        bearerEvaluateQueue();
+    }
+}
+
+// Re-evaluate the bearer policy: switch at once to the best bearer
+// that is up, then start bringing up any bearers that need it;
+// bearerUpDone() asks for another evaluation when a bring-up works.
+static void bearerEvaluate()
+{
+    size_t numBearers = 0;
+    bool busy = false;
+
+    if (uDeviceLock() == 0) {
+        U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+        gBearerPolicy.evaluatePending = false;
+        gBearerPolicy.busy = gBearerPolicy.active;
+        busy = gBearerPolicy.busy;
+        U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+        numBearers = gBearerPolicy.numBearers;
+        uDeviceUnlock();
+    }
+
+    if (busy) {
+        bearerSelect();
+        for (size_t x = 0; x < numBearers; x++) {
+            bearerUpStart(x);
+        }
+        U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+        gBearerPolicy.busy = false;
+        U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+        uPortSemaphoreGive(gBearerPolicyIdleSemaphore);
+    }
+}
+
+// Event queue handler for the network API, used by both the
+// network event queue and the bring-up event queues.
+static void eventHandler(void *pParam, size_t paramLength)
+{
+    uNetworkEvent_t *pEvent = (uNetworkEvent_t *) pParam;
+    int32_t errorCode;
+    uNetworkState_t state = U_NETWORK_STATE_FAILED;
+
+    (void) paramLength;
+
+    switch (pEvent->type) {
+        case U_NETWORK_EVENT_UP:
+            if (pEvent->pCallback != NULL) {
+                pEvent->pCallback(pEvent->devHandle, pEvent->netType,
+                                  U_NETWORK_STATE_STARTING, 0,
+                                  pEvent->pCallbackParameter);
+            }
+            errorCode = upRun(pEvent->devHandle, pEvent->netType);
+            if (errorCode == 0) {
+                state = U_NETWORK_STATE_UP;
+            } else if (errorCode == (int32_t) U_ERROR_COMMON_CANCELLED) {
+                state = U_NETWORK_STATE_DOWN;
+            }
+            if (pEvent->bearerIndex >= 0) {
+                bearerUpDone(pEvent, errorCode);
+            }
+            if (uDeviceLock() == 0) {
+                gUpQueue[pEvent->upQueue].numQueued--;
+                uDeviceUnlock();
+            }
+            if (pEvent->pCallback != NULL) {
+                pEvent->pCallback(pEvent->devHandle, pEvent->netType,
+                                  state, errorCode,
+                                  pEvent->pCallbackParameter);
+            }
+            break;
+        case U_NETWORK_EVENT_BEARER_EVALUATE:
+            bearerEvaluate();
+            break;
+        default:
+            break;
+    }
+}
+
+// Open bring-up event queues, as far as U_NETWORK_UP_TASKS_MAX_NUM
+// allows, until at least numIdle of them have nothing to do.
+// This must be called between uDeviceLock() and uDeviceUnlock().
+static void upQueuesEnsure(size_t numIdle)
+{
+    size_t numIdleNow = 0;
+    uNetworkUpQueue_t *pUpQueue;
+
+    for (size_t x = 0; x < sizeof(gUpQueue) / sizeof(gUpQueue[0]); x++) {
+        if (gUpQueue[x].isOpen && (gUpQueue[x].numQueued == 0)) {
+            numIdleNow++;
+        }
+    }
+    for (size_t x = 0; (x < sizeof(gUpQueue) / sizeof(gUpQueue[0])) &&
+         (numIdleNow < numIdle); x++) {
+        pUpQueue = &(gUpQueue[x]);
+        if (!pUpQueue->isOpen) {
+            pUpQueue->handle = uPortEventQueueOpen(eventHandler, "networkUp",
+                                                   sizeof(uNetworkEvent_t),
+                                                   U_NETWORK_TASK_STACK_SIZE_BYTES,
+                                                   U_NETWORK_TASK_PRIORITY,
+                                                   U_NETWORK_QUEUE_LENGTH);
+            if (pUpQueue->handle >= 0) {
+                pUpQueue->isOpen = true;
+                pUpQueue->numQueued = 0;
+                numIdleNow++;
+            }
+        }
+    }
+}
+
+// Get the handle of the network event queue, opening it, and
+// creating the bearer policy mutex and semaphore, if necessary.
+// This must be called between uDeviceLock() and uDeviceUnlock().
+static int32_t eventQueueGet()
+{
+    if ((gBearerPolicyMutex == NULL) &&
+        (uPortMutexCreate(&gBearerPolicyMutex) != 0)) {
+        gBearerPolicyMutex = NULL;
+    }
+    if ((gBearerPolicyIdleSemaphore == NULL) &&
+        (uPortSemaphoreCreate(&gBearerPolicyIdleSemaphore, 0, 1) != 0)) {
+        gBearerPolicyIdleSemaphore = NULL;
+    }
+    if ((gEventQueueHandle < 0) && (gBearerPolicyMutex != NULL) &&
+        (gBearerPolicyIdleSemaphore != NULL)) {
+        gEventQueueHandle = uPortEventQueueOpen(eventHandler, "network",
+                                                sizeof(uNetworkEvent_t),
+                                                U_NETWORK_TASK_STACK_SIZE_BYTES,
+                                                U_NETWORK_TASK_PRIORITY,
+                                                U_NETWORK_QUEUE_LENGTH);
+    }
+
+    return gEventQueueHandle;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Close the network event queues and forget any bearer policy.
+void uNetworkAsyncDeinit()
+{
+    int32_t eventQueueHandle = gEventQueueHandle;
+
+    gBearerPolicy.active = false;
+    gEventQueueHandle = -1;
+    if (eventQueueHandle >= 0) {
+        uPortEventQueueClose(eventQueueHandle);
+    }
+    for (size_t x = 0; x < sizeof(gUpQueue) / sizeof(gUpQueue[0]); x++) {
+        if (gUpQueue[x].isOpen) {
+            uPortEventQueueClose(gUpQueue[x].handle);
+        }
+    }
+    memset(gUpQueue, 0, sizeof(gUpQueue));
+    memset(&gBearerPolicy, 0, sizeof(gBearerPolicy));
+    if (gBearerPolicyIdleSemaphore != NULL) {
+        uPortSemaphoreDelete(gBearerPolicyIdleSemaphore);
+        gBearerPolicyIdleSemaphore = NULL;
+    }
+    if (gBearerPolicyMutex != NULL) {
+        uPortMutexDelete(gBearerPolicyMutex);
+        gBearerPolicyMutex = NULL;
+    }
+}
+
 int32_t uNetworkInterfaceUp(uDeviceHandle_t devHandle,
                             uNetworkType_t netType,
                             const void *pCfg)
@@ -190,46 +949,94 @@ int32_t uNetworkInterfaceUp(uDeviceHandle_t devHandle,
 
     // Lock the API
     int32_t errorCode = uDeviceLock();
-    uDeviceInstance_t *pDeviceInstance;
     uDeviceNetworkData_t *pNetworkData;
 
     if (errorCode == 0) {
-        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        if ((uDeviceGetInstance(devHandle, &pDeviceInstance) == 0) &&
-            (netType >= U_NETWORK_TYPE_NONE) &&
-            (netType < U_NETWORK_TYPE_MAX_NUM)) {
-            pNetworkData = pUNetworkGetNetworkData(pDeviceInstance, netType);
-            if (pNetworkData == NULL) {
-                // No network of this type has yet been brought up on
-                // this device
-                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                pNetworkData = pUNetworkGetNetworkData(pDeviceInstance, U_NETWORK_TYPE_NONE);
+        errorCode = upPrepare(devHandle, netType, pCfg, &pNetworkData);
+        if (errorCode == 0) {
+            errorCode = networkInterfaceChangeState(devHandle, netType,
+                                                    pNetworkData->pCfg,
+                                                    true);
+            pNetworkData->state = (errorCode == 0) ? (int32_t) U_NETWORK_STATE_UP :
+                                  (int32_t) U_NETWORK_STATE_FAILED;
+        }
+        // ...and done
+        uDeviceUnlock();
+    }
+
+    return errorCode;
+}
+
+// Start bringing up a network interface without blocking.
+int32_t uNetworkInterfaceUpStart(uDeviceHandle_t devHandle,
+                                 uNetworkType_t netType,
+                                 const void *pCfg,
+                                 uNetworkStateCallback_t pCallback,
+                                 void *pCallbackParameter)
+{
+    // Lock the API
+    int32_t errorCode = uDeviceLock();
+    int32_t upQueue = -1;
+    uDeviceNetworkData_t *pNetworkData = NULL;
+    uNetworkEvent_t event;
+
+    if (errorCode == 0) {
+        errorCode = upPrepare(devHandle, netType, pCfg, &pNetworkData);
+        if (errorCode == 0) {
+            // Start another bring-up task if all are busy
+            upQueuesEnsure(1);
+            errorCode = upQueueGet();
+            if (errorCode >= 0) {
+                upQueue = errorCode;
+                // Nobody else may touch the network from now until
+                // the event queue task is done with it
+                pNetworkData->state = (int32_t) U_NETWORK_STATE_STARTING;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
             }
+        }
+        uDeviceUnlock();
+
+        if (errorCode == 0) {
+            memset(&event, 0, sizeof(event));
+            event.type = U_NETWORK_EVENT_UP;
+            event.devHandle = devHandle;
+            event.netType = netType;
+            event.pCallback = pCallback;
+            event.pCallbackParameter = pCallbackParameter;
+            event.upQueue = (size_t) upQueue;
+            event.bearerIndex = -1;
+            errorCode = upQueueSend(&event, pNetworkData);
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the state of a network interface.
+int32_t uNetworkInterfaceGetState(uDeviceHandle_t devHandle,
+                                  uNetworkType_t netType)
+{
+    // Lock the API
+    int32_t errorCodeOrState = uDeviceLock();
+    uDeviceInstance_t *pInstance;
+    uDeviceNetworkData_t *pNetworkData;
+
+    if (errorCodeOrState == 0) {
+        errorCodeOrState = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((uDeviceGetInstance(devHandle, &pInstance) == 0) &&
+            (netType > U_NETWORK_TYPE_NONE) &&
+            (netType < U_NETWORK_TYPE_MAX_NUM)) {
+            errorCodeOrState = (int32_t) U_NETWORK_STATE_DOWN;
+            pNetworkData = pUNetworkGetNetworkData(pInstance, netType);
             if (pNetworkData != NULL) {
-                pNetworkData->networkType = (int32_t) netType;
-                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                // We potentially want to change the configuration,
-                // so allocate memory to store it here
-                // This memory is free'd when the device is closed
-                if (cfgEnsureMemory(pNetworkData, pCfg)) {
-                    // Allow the network configuration from the board
-                    // configuration of the platform to override what
-                    // we were given; only used by Zephyr
-                    errorCode = uPortBoardCfgNetwork(devHandle, netType,
-                                                     pNetworkData->pCfg);
-                    if (errorCode == 0) {
-                        errorCode = networkInterfaceChangeState(devHandle, netType,
-                                                                pNetworkData->pCfg,
-                                                                true);
-                    }
-                }
+                errorCodeOrState = pNetworkData->state;
             }
         }
         // ...and done
         uDeviceUnlock();
     }
 
-    return errorCode;
+    return errorCodeOrState;
 }
 
 int32_t uNetworkInterfaceDown(uDeviceHandle_t devHandle, uNetworkType_t netType)
@@ -249,11 +1056,23 @@ int32_t uNetworkInterfaceDown(uDeviceHandle_t devHandle, uNetworkType_t netType)
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
             pNetworkData = pUNetworkGetNetworkData(pInstance, netType);
             if (pNetworkData != NULL) {
-                errorCode = networkInterfaceChangeState(devHandle, netType,
-                                                        pNetworkData->pCfg,
-                                                        false);
-                uPortFree(pNetworkData->pStatusCallbackData);
-                pNetworkData->pStatusCallbackData = NULL;
+                if (pNetworkData->state == (int32_t) U_NETWORK_STATE_STARTING) {
+                    // Ask the bring-up to stop; it will take the
+                    // network down again itself
+                    pNetworkData->cancel = true;
+                } else {
+                    errorCode = networkInterfaceChangeState(devHandle, netType,
+                                                            pNetworkData->pCfg,
+                                                            false);
+                    if (errorCode == 0) {
+                        pNetworkData->state = (int32_t) U_NETWORK_STATE_DOWN;
+                        // Addresses looked up over the network
+                        // may not hold next time it comes up
+                        uSockDnsCacheFlush(devHandle);
+                    }
+                    uPortFree(pNetworkData->pStatusCallbackData);
+                    pNetworkData->pStatusCallbackData = NULL;
+                }
             }
         }
         // ...and done
@@ -268,61 +1087,183 @@ int32_t uNetworkSetStatusCallback(uDeviceHandle_t devHandle,
                                   uNetworkType_t netType,
                                   uNetworkStatusCallback_t pCallback,
                                   void *pCallbackParameter)
+{
+    // Lock the API
+    int32_t errorCode = uDeviceLock();
+    uNetworkBearerEntry_t *pEntry;
+
+    if (errorCode == 0) {
+        pEntry = pBearerEntryGet(devHandle, netType);
+        if ((pEntry != NULL) && pEntry->callbackInstalled) {
+            // The bearer policy's callback is in the way: it
+            // will call this one
+            U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+            pEntry->pUserCallback = pCallback;
+            pEntry->pUserCallbackParameter = pCallbackParameter;
+            U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+        } else {
+            errorCode = statusCallbackSet(devHandle, netType, pCallback,
+                                          pCallbackParameter);
+        }
+        // ...and done
+        uDeviceUnlock();
+    }
+
+    return errorCode;
+}
+
+// Start a multi-bearer policy.
+int32_t uNetworkBearerPolicyStart(const uNetworkBearer_t *pBearers,
+                                  size_t numBearers, bool preWarm,
+                                  uNetworkBearerCallback_t pCallback,
+                                  void *pCallbackParameter)
 {
     // Lock the API
     int32_t errorCode = uDeviceLock();
     uDeviceInstance_t *pInstance;
-    uDeviceNetworkData_t *pNetworkData;
-    uNetworkStatusCallbackData_t *pStatusCallbackData;
+    uint32_t generation;
+    bool busy = false;
 
     if (errorCode == 0) {
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        if ((uDeviceGetInstance(devHandle, &pInstance) == 0) &&
-            (netType >= U_NETWORK_TYPE_NONE) &&
-            (netType < U_NETWORK_TYPE_MAX_NUM)) {
-            // If pNetworkData is NULL then this network has not
-            // been brought up
-            pNetworkData = pUNetworkGetNetworkData(pInstance, netType);
-            if (pNetworkData != NULL) {
-                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                // Allocate space for the status callback data
-                // and attach it to the network data block;
-                // the various callback functions can then
-                // obtain it from there with a call to
-                // pUNetworkGetNetworkData()
-                if (pNetworkData->pStatusCallbackData == NULL) {
-                    pNetworkData->pStatusCallbackData = pUPortMalloc(sizeof(uNetworkStatusCallbackData_t));
+        if ((pBearers != NULL) && (numBearers > 0) &&
+            (numBearers <= U_NETWORK_BEARERS_MAX_NUM)) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            for (size_t x = 0; (x < numBearers) && (errorCode == 0); x++) {
+                if ((uDeviceGetInstance(pBearers[x].devHandle, &pInstance) != 0) ||
+                    (pBearers[x].netType <= U_NETWORK_TYPE_NONE) ||
+                    (pBearers[x].netType >= U_NETWORK_TYPE_MAX_NUM) ||
+                    (pBearers[x].netType == U_NETWORK_TYPE_GNSS)) {
+                    errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
                 }
-                pStatusCallbackData = (uNetworkStatusCallbackData_t *) pNetworkData->pStatusCallbackData;
-                if (pStatusCallbackData != NULL) {
-                    pStatusCallbackData->pCallback = pCallback;
-                    pStatusCallbackData->pCallbackParameter = pCallbackParameter;
-                    errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
-                    switch (netType) {
-                        case U_NETWORK_TYPE_BLE:
-                            errorCode = uNetworkSetStatusCallbackBle(devHandle);
-                            break;
-                        case U_NETWORK_TYPE_CELL:
-                            errorCode = uNetworkSetStatusCallbackCell(devHandle);
-                            break;
-                        case U_NETWORK_TYPE_WIFI:
-                            errorCode = uNetworkSetStatusCallbackWifi(devHandle);
-                            break;
-                        case U_NETWORK_TYPE_GNSS:
-                            // Not relevant to GNSS
-                            break;
-                        default:
-                            break;
-                    }
-                    if (errorCode != 0) {
-                        uPortFree(pNetworkData->pStatusCallbackData);
-                        pNetworkData->pStatusCallbackData = NULL;
+            }
+            if (errorCode == 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_BUSY;
+                if (gBearerPolicyMutex != NULL) {
+                    U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+                    busy = gBearerPolicy.busy;
+                    U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+                }
+                if (!gBearerPolicy.active && !busy) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    // A bring-up task for each bearer, if allowed,
+                    // so that they can all come up at once
+                    upQueuesEnsure(numBearers);
+                    // Bring-up event queues are opened in order and
+                    // only closed by uDeviceDeinit(), so if any are
+                    // open the first one is
+                    if ((eventQueueGet() >= 0) && gUpQueue[0].isOpen) {
+                        U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+                        generation = gBearerPolicy.generation + 1;
+                        memset(&gBearerPolicy, 0, sizeof(gBearerPolicy));
+                        gBearerPolicy.generation = generation;
+                        for (size_t x = 0; x < numBearers; x++) {
+                            gBearerPolicy.entry[x].bearer = pBearers[x];
+                        }
+                        gBearerPolicy.numBearers = numBearers;
+                        gBearerPolicy.preWarm = preWarm;
+                        gBearerPolicy.activeIndex = -1;
+                        gBearerPolicy.pCallback = pCallback;
+                        gBearerPolicy.pCallbackParameter = pCallbackParameter;
+                        gBearerPolicy.active = true;
+                        U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                     }
                 }
             }
         }
         // ...and done
         uDeviceUnlock();
+
+        if (errorCode == 0) {
+            // Off we go
+            bearerEvaluateQueue();
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the active bearer.
+int32_t uNetworkBearerGetActive(uDeviceHandle_t *pDevHandle,
+                                uNetworkType_t *pNetType)
+{
+    // Lock the API
+    int32_t errorCodeOrIndex = uDeviceLock();
+
+    if (errorCodeOrIndex == 0) {
+        errorCodeOrIndex = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        if (gBearerPolicy.active && (gBearerPolicy.activeIndex >= 0)) {
+            errorCodeOrIndex = gBearerPolicy.activeIndex;
+            if (pDevHandle != NULL) {
+                *pDevHandle = gBearerPolicy.entry[errorCodeOrIndex].bearer.devHandle;
+            }
+            if (pNetType != NULL) {
+                *pNetType = gBearerPolicy.entry[errorCodeOrIndex].bearer.netType;
+            }
+        }
+        // ...and done
+        uDeviceUnlock();
+    }
+
+    return errorCodeOrIndex;
+}
+
+// Stop the multi-bearer policy.
+int32_t uNetworkBearerPolicyStop(bool takeDown)
+{
+    // Lock the API
+    int32_t errorCode = uDeviceLock();
+    uNetworkBearerEntry_t entry[U_NETWORK_BEARERS_MAX_NUM];
+    size_t numBearers = 0;
+    int32_t eventQueueHandle;
+    bool busy = false;
+
+    if (errorCode == 0) {
+        if (gBearerPolicy.active) {
+            // From here on a bring-up that completes for the
+            // policy will leave the status callbacks alone
+            U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+            gBearerPolicy.active = false;
+            numBearers = gBearerPolicy.numBearers;
+            memcpy(entry, gBearerPolicy.entry, numBearers * sizeof(entry[0]));
+            U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+        }
+        eventQueueHandle = gEventQueueHandle;
+        // ...and done
+        uDeviceUnlock();
+
+        // Wait for the event queue task to finish anything it is
+        // doing for the policy, unless we are being called from it;
+        // the semaphore may have been given for an earlier
+        // evaluation, hence the loop
+        if ((eventQueueHandle >= 0) && !uPortEventQueueIsTask(eventQueueHandle)) {
+            do {
+                U_PORT_MUTEX_LOCK(gBearerPolicyMutex);
+                busy = gBearerPolicy.busy;
+                U_PORT_MUTEX_UNLOCK(gBearerPolicyMutex);
+                if (busy) {
+                    uPortSemaphoreTake(gBearerPolicyIdleSemaphore);
+                }
+            } while (busy);
+        }
+
+        // Give the bearers back the status callbacks of the application
+        if (uDeviceLock() == 0) {
+            for (size_t x = 0; x < numBearers; x++) {
+                if (entry[x].callbackInstalled) {
+                    statusCallbackSet(entry[x].bearer.devHandle, entry[x].bearer.netType,
+                                      entry[x].pUserCallback,
+                                      entry[x].pUserCallbackParameter);
+                }
+            }
+            uDeviceUnlock();
+        }
+
+        for (size_t x = 0; (x < numBearers) && takeDown; x++) {
+            // This cancels any bring-up that is still going on
+            uNetworkInterfaceDown(entry[x].bearer.devHandle, entry[x].bearer.netType);
+        }
     }
 
     return errorCode;
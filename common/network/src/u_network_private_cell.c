@@ -73,18 +73,26 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
-// Call-back for connect/disconnect timeout.
+// Call-back for connect/disconnect timeout; also stops a bring-up
+// that uNetworkInterfaceDown() has asked to be abandoned.
 static bool keepGoingCallback(uDeviceHandle_t devHandle)
 {
     uDeviceCellContext_t *pContext;
     uDeviceInstance_t *pDevInstance = NULL;
+    uDeviceNetworkData_t *pNetworkData;
     bool keepGoing = false;
 
     if (uDeviceGetInstance(devHandle, &pDevInstance) == 0) {
         pContext = (uDeviceCellContext_t *) pDevInstance->pContext;
-        if ((pContext == NULL) ||
-            (uPortGetTickTimeMs() < pContext->stopTimeMs)) {
-            keepGoing = true;
+        pNetworkData = pUNetworkGetNetworkData(pDevInstance, U_NETWORK_TYPE_CELL);
+        if ((pNetworkData == NULL) || !pNetworkData->cancel) {
+            if (pContext == NULL) {
+                keepGoing = true;
+            } else if (pContext->pKeepGoingCallback != NULL) {
+                keepGoing = pContext->pKeepGoingCallback(devHandle);
+            } else if (uPortGetTickTimeMs() < pContext->stopTimeMs) {
+                keepGoing = true;
+            }
         }
     }
 
@@ -156,17 +164,16 @@ int32_t uNetworkPrivateChangeStateCell(uDeviceHandle_t devHandle,
     uDeviceCellContext_t *pContext;
     uDeviceInstance_t *pDevInstance;
     int32_t errorCode = uDeviceGetInstance(devHandle, &pDevInstance);
-    bool (*pKeepGoingCallback)(uDeviceHandle_t devHandle) = keepGoingCallback;
 
     if (errorCode == 0) {
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         pContext = (uDeviceCellContext_t *) pDevInstance->pContext;
         if ((pCfg != NULL) && (pCfg->version == 0) &&
             (pCfg->type == U_NETWORK_TYPE_CELL) && (pContext != NULL)) {
-            if (pCfg->pKeepGoingCallback != NULL) {
-                // The user has given us a keep-going callback, so use it
-                pKeepGoingCallback = pCfg->pKeepGoingCallback;
-            } else {
+            // If the user has given us a keep-going callback then
+            // keepGoingCallback() will call it
+            pContext->pKeepGoingCallback = pCfg->pKeepGoingCallback;
+            if (pCfg->pKeepGoingCallback == NULL) {
                 // Set the stop time for the connect/disconnect calls
                 pContext->stopTimeMs = uPortGetTickTimeMs() +
                                        (((int64_t) pCfg->timeoutSeconds) * 1000);
@@ -188,11 +195,11 @@ int32_t uNetworkPrivateChangeStateCell(uDeviceHandle_t devHandle,
                                                 pCfg->pApn,
                                                 pCfg->pUsername,
                                                 pCfg->pPassword,
-                                                pKeepGoingCallback);
+                                                keepGoingCallback);
                 }
             } else {
                 // Disconnect
-                errorCode = uCellNetDisconnect(devHandle, pKeepGoingCallback);
+                errorCode = uCellNetDisconnect(devHandle, keepGoingCallback);
             }
         }
     }
@@ -237,6 +237,18 @@ static void wifiNetworkStatusCallback(uDeviceHandle_t devHandle,
     }
 }
 
+// Return true if uNetworkInterfaceDown() has asked for the
+// bring-up of the Wi-Fi network on this device to be abandoned.
+static bool cancelRequested(uDeviceHandle_t devHandle)
+{
+    uDeviceNetworkData_t *pNetworkData;
+
+    pNetworkData = pUNetworkGetNetworkData(U_DEVICE_INSTANCE(devHandle),
+                                           U_NETWORK_TYPE_WIFI);
+
+    return (pNetworkData != NULL) && pNetworkData->cancel;
+}
+
 static inline void statusQueueClear(const uPortQueueHandle_t queueHandle)
 {
     int32_t result;
@@ -262,11 +274,15 @@ static inline int32_t statusQueueWaitForWifiDisabled(const uPortQueueHandle_t qu
     return (int32_t) U_ERROR_COMMON_TIMEOUT;
 }
 
-static inline int32_t statusQueueWaitForWifiConnected(const uPortQueueHandle_t queueHandle,
+static inline int32_t statusQueueWaitForWifiConnected(uDeviceHandle_t devHandle,
+                                                      const uPortQueueHandle_t queueHandle,
                                                       int32_t timeoutSec)
 {
     int32_t startTime = (int32_t)uPortGetTickTimeMs();
     while ((int32_t)uPortGetTickTimeMs() - startTime < timeoutSec * 1000) {
+        if (cancelRequested(devHandle)) {
+            return (int32_t) U_ERROR_COMMON_CANCELLED;
+        }
         uStatusMessage_t msg;
         int32_t errorCode = uPortQueueTryReceive(queueHandle, 1000, &msg);
         if ((errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) &&
@@ -277,7 +293,8 @@ static inline int32_t statusQueueWaitForWifiConnected(const uPortQueueHandle_t q
     return (int32_t) U_ERROR_COMMON_TIMEOUT;
 }
 
-static inline int32_t statusQueueWaitForNetworkUp(const uPortQueueHandle_t queueHandle,
+static inline int32_t statusQueueWaitForNetworkUp(uDeviceHandle_t devHandle,
+                                                  const uPortQueueHandle_t queueHandle,
                                                   int32_t timeoutSec)
 {
     static const uint32_t desiredNetStatusMask =
@@ -285,6 +302,9 @@ static inline int32_t statusQueueWaitForNetworkUp(const uPortQueueHandle_t queue
     uint32_t lastNetStatusMask = 0;
     int32_t startTime = (int32_t)uPortGetTickTimeMs();
     while ((int32_t)uPortGetTickTimeMs() - startTime < timeoutSec * 1000) {
+        if (cancelRequested(devHandle)) {
+            return (int32_t) U_ERROR_COMMON_CANCELLED;
+        }
         uStatusMessage_t msg;
         int32_t errorCode = uPortQueueTryReceive(queueHandle, 1000, &msg);
         if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
@@ -392,10 +412,10 @@ int32_t uNetworkPrivateChangeStateWifi(uDeviceHandle_t devHandle,
             if (errorCode == 0) {
                 // Wait until the network layer is up before return
                 if (isSta) {
-                    errorCode = statusQueueWaitForWifiConnected(queueHandle, 20);
+                    errorCode = statusQueueWaitForWifiConnected(devHandle, queueHandle, 20);
                 }
                 if (errorCode == 0) {
-                    errorCode = statusQueueWaitForNetworkUp(queueHandle,
+                    errorCode = statusQueueWaitForNetworkUp(devHandle, queueHandle,
                                                             U_NETWORK_PRIVATE_WIFI_NETWORK_TIMEOUT_SEC);
                 }
             }
@@ -159,4 +159,20 @@ void uNetworkCfgFree(uDeviceHandle_t devHandle)
     }
 }
 
+// Check whether any network on the device is being brought up.
+bool uNetworkIsStarting(uDeviceHandle_t devHandle)
+{
+    bool isStarting = false;
+    uDeviceInstance_t *pInstance;
+
+    if (uDeviceGetInstance(devHandle, &pInstance) == 0) {
+        for (size_t x = 0; (x < sizeof(pInstance->networkData) /
+                            sizeof(pInstance->networkData[0])) && !isStarting; x++) {
+            isStarting = (pInstance->networkData[x].state == (int32_t) U_NETWORK_STATE_STARTING);
+        }
+    }
+
+    return isStarting;
+}
+
 // End of file
@@ -75,6 +75,22 @@ uDeviceNetworkData_t *pUNetworkGetNetworkData(uDeviceInstance_t *pInstance,
  */
 void uNetworkCfgFree(uDeviceHandle_t devHandle);
 
+/** Check whether any network on the given device is being brought
+ * up by uNetworkInterfaceUpStart(); this must be called between
+ * uDeviceLock() and uDeviceUnlock().
+ *
+ * @param devHandle  the handle of the device.
+ * @return           true if a network on the device is in state
+ *                   #U_NETWORK_STATE_STARTING.
+ */
+bool uNetworkIsStarting(uDeviceHandle_t devHandle);
+
+/** Close the event queue used by uNetworkInterfaceUpStart() and
+ * the bearer policy and forget any bearer policy; only
+ * uDeviceDeinit() should call this.
+ */
+void uNetworkAsyncDeinit(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -82,6 +82,14 @@
 #include "u_location.h"                  // In order to prove that we can do something
 #include "u_location_test_shared_cfg.h"  // with an "up" network that supports location
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+# include "u_port_uart.h"
+# include "u_at_client.h"
+# include "u_cell_module_type.h"
+# include "u_cell.h"                  // For the buffer lengths
+# include "u_network_config_cell.h"
+#endif
+
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
@@ -110,10 +118,58 @@
  */
 #define U_TEST_PRINT_LINE_X(format, ...) uPortLog(U_TEST_PREFIX_X format "\n", ##__VA_ARGS__)
 
+#ifndef U_NETWORK_TEST_UP_ASYNC_DELAY_MS
+/** How long the simulated module of the networkUpAsync test
+ * takes to answer AT+CFUN=1, i.e. how long the bring-up is kept
+ * in state #U_NETWORK_STATE_STARTING at the least.
+ */
+# define U_NETWORK_TEST_UP_ASYNC_DELAY_MS 2000
+#endif
+
+#ifndef U_NETWORK_TEST_UP_ASYNC_MAX_LATENCY_MS
+/** The maximum time that an API call may take in the
+ * networkUpAsync test while a bring-up is in progress.
+ */
+# define U_NETWORK_TEST_UP_ASYNC_MAX_LATENCY_MS 100
+#endif
+
+#ifndef U_NETWORK_TEST_UART_C
+/** A third UART which, with #U_NETWORK_TEST_UART_D, forms a
+ * second looped-back pair like #U_CFG_TEST_UART_A and
+ * #U_CFG_TEST_UART_B, used by the networkBearerFailover test to
+ * simulate a second cellular module; -1 if there is no such pair.
+ */
+# define U_NETWORK_TEST_UART_C -1
+#endif
+
+#ifndef U_NETWORK_TEST_UART_D
+/** The UART at the far end of #U_NETWORK_TEST_UART_C.
+ */
+# define U_NETWORK_TEST_UART_D -1
+#endif
+
+#ifndef U_NETWORK_TEST_FAILOVER_DELAY_MS
+/** How long the simulated module of the preferred bearer in the
+ * networkBearerFailover test takes to answer AT+CFUN=1, which
+ * must be long enough for the other bearer to be up first.
+ */
+# define U_NETWORK_TEST_FAILOVER_DELAY_MS 5000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** A cellular module simulated on a UART.
+ */
+typedef struct {
+    int32_t uartHandle;
+    uAtClientHandle_t atHandle;
+    int32_t upDelayMs; /**< how long to take to answer AT+CFUN=1. */
+} uNetworkTestSim_t;
+#endif
+
 /** A type to hold all of the parameters passed to the network
  * status callback.
  */
@@ -214,6 +270,79 @@ static uNetworkCfgWifi_t gNetworkCfgWifiNetStatus = {
 static uNetworkStatusCallbackParameters_t gNetworkStatusCallbackParameters[U_NETWORK_TYPE_MAX_NUM];
 #endif
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** The responses of the cellular module simulated by the
+ * networkUpAsync test, the command being matched on its start;
+ * anything not in here gets "OK".
+ */
+static const char *const gpSimResponse[][2] = {
+    {"+CGMM", "\r\nSARA-R510M8S\r\n\r\nOK\r\n"},
+    {"+CGMR", "\r\n03.15\r\n\r\nOK\r\n"},
+    {"+CGSN", "\r\n351234567890123\r\n\r\nOK\r\n"},
+    {"+CIMI", "\r\n234150123456789\r\n\r\nOK\r\n"},
+    {"+CCID", "\r\n+CCID: 89441000300012345678\r\n\r\nOK\r\n"},
+    {"+CPIN?", "\r\n+CPIN: READY\r\n\r\nOK\r\n"},
+    {"+CFUN?", "\r\n+CFUN: 1,0\r\n\r\nOK\r\n"},
+    {"+CEREG?", "\r\n+CEREG: 4,1\r\n\r\nOK\r\n"},
+    {"+CREG?", "\r\n+CREG: 2,0\r\n\r\nOK\r\n"},
+    {"+CGREG?", "\r\n+CGREG: 2,0\r\n\r\nOK\r\n"},
+    {"+CGATT?", "\r\n+CGATT: 1\r\n\r\nOK\r\n"},
+    {"+CGACT?", "\r\n+CGACT: 1,1\r\n\r\nOK\r\n"},
+    {"+COPS?", "\r\n+COPS: 0,0,\"Sim\",7\r\n\r\nOK\r\n"},
+    {"+CGDCONT?", "\r\n+CGDCONT: 1,\"IP\",\"internet\",\"10.0.0.1\",0,0\r\n\r\nOK\r\n"},
+    {"+UMNOPROF?", "\r\n+UMNOPROF: 100\r\n\r\nOK\r\n"},
+    {"+URAT?", "\r\n+URAT: 7\r\n\r\nOK\r\n"},
+    {"+UPSV?", "\r\n+UPSV: 0\r\n\r\nOK\r\n"},
+    {"+CPSMS?", "\r\n+CPSMS: 0\r\n\r\nOK\r\n"},
+    {"+UPSDA", "\r\nOK\r\n\r\n+UUPSDA: 0,\"10.0.0.1\"\r\n"}
+};
+
+/** The cellular module simulated on UART B.
+ */
+static uNetworkTestSim_t gSimB = {-1, NULL, 0};
+
+# if (U_NETWORK_TEST_UART_C >= 0) && (U_NETWORK_TEST_UART_D >= 0)
+/** The cellular module simulated on UART D.
+ */
+static uNetworkTestSim_t gSimD = {-1, NULL, 0};
+# endif
+
+/** The states passed to upAsyncStateCallback(), in order.
+ */
+static volatile uNetworkState_t gUpAsyncState[4];
+
+/** The number of calls to upAsyncStateCallback().
+ */
+static volatile size_t gUpAsyncNumStates = 0;
+
+/** The error code passed to upAsyncStateCallback() with
+ * the final state.
+ */
+static volatile int32_t gUpAsyncErrorCode = 1;
+
+/** The device handle passed to upAsyncBearerCallback().
+ */
+static volatile uDeviceHandle_t gBearerDevHandle = NULL;
+
+/** The number of calls to upAsyncBearerCallback().
+ */
+static volatile int32_t gBearerNumCalls = 0;
+
+/** The time of the last call to upAsyncBearerCallback().
+ */
+static volatile int32_t gBearerCallTimeMs = 0;
+
+# if (U_NETWORK_TEST_UART_C >= 0) && (U_NETWORK_TEST_UART_D >= 0)
+/** The number of calls to upAsyncStatusCallback().
+ */
+static volatile int32_t gStatusNumCalls = 0;
+
+/** The isUp parameter of the last call to upAsyncStatusCallback().
+ */
+static volatile bool gStatusIsUp = false;
+# endif
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -460,6 +589,209 @@ static int32_t openSocketAndUseIt(uDeviceHandle_t devHandle, uNetworkType_t netT
     return errorCodeOrSize;
 }
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+// Pretend to be a SARA-R5 cellular module: this is set as a URC
+// handler on the AT client of a uNetworkTestSim_t, pParameter, and
+// so gets every "AT" command sent by the cellular device at the
+// other end of the UART, answering from gpSimResponse[]; AT+CFUN=1
+// is answered slowly so that the test has time to poke at things
+// while the network is coming up.
+static void simUrc(uAtClientHandle_t atHandle, void *pParameter)
+{
+    uNetworkTestSim_t *pSim = (uNetworkTestSim_t *) pParameter;
+    char buffer[64];
+    char c = 0;
+    size_t length = 0;
+    const char *pResponse = "\r\nOK\r\n";
+
+    // Read the rest of the command up to the \r
+    uAtClientIgnoreStopTag(atHandle);
+    while ((c != '\r') && (uAtClientReadBytes(atHandle, &c, 1, true) == 1)) {
+        if ((c != '\r') && (length < sizeof(buffer) - 1)) {
+            buffer[length] = c;
+            length++;
+        }
+    }
+    buffer[length] = 0;
+
+    for (size_t x = 0; x < sizeof(gpSimResponse) / sizeof(gpSimResponse[0]); x++) {
+        if (strncmp(buffer, gpSimResponse[x][0], strlen(gpSimResponse[x][0])) == 0) {
+            pResponse = gpSimResponse[x][1];
+        }
+    }
+    if (strcmp(buffer, "+CFUN=1") == 0) {
+        uPortTaskBlock(pSim->upDelayMs);
+    }
+    uPortUartWrite(pSim->uartHandle, pResponse, strlen(pResponse));
+}
+
+// Start a simulated cellular module on the given UART.
+static bool simOpen(uNetworkTestSim_t *pSim, int32_t uart,
+                    int32_t pinTxd, int32_t pinRxd,
+                    int32_t pinCts, int32_t pinRts,
+                    int32_t upDelayMs)
+{
+    pSim->upDelayMs = upDelayMs;
+    pSim->atHandle = NULL;
+    pSim->uartHandle = uPortUartOpen(uart, U_CFG_TEST_BAUD_RATE, NULL,
+                                     U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                     pinTxd, pinRxd, pinCts, pinRts);
+    if (pSim->uartHandle >= 0) {
+        pSim->atHandle = uAtClientAdd(pSim->uartHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                      NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+    }
+    if (pSim->atHandle != NULL) {
+        // The simulated module answers AT+CFUN=1 in URC context,
+        // slowly, so give it plenty of time
+        uAtClientTimeoutUrcSet(pSim->atHandle, upDelayMs + 5000);
+        if (uAtClientSetUrcHandler(pSim->atHandle, "AT", simUrc, pSim) != 0) {
+            uAtClientRemove(pSim->atHandle);
+            pSim->atHandle = NULL;
+        }
+    }
+
+    return (pSim->atHandle != NULL);
+}
+
+// Stop a simulated cellular module.
+static void simClose(uNetworkTestSim_t *pSim)
+{
+    if (pSim->atHandle != NULL) {
+        uAtClientRemove(pSim->atHandle);
+        pSim->atHandle = NULL;
+    }
+    if (pSim->uartHandle >= 0) {
+        uPortUartClose(pSim->uartHandle);
+        pSim->uartHandle = -1;
+    }
+}
+
+// Have a simulated cellular module send a URC.
+static void simUrcSend(uNetworkTestSim_t *pSim, const char *pUrc)
+{
+    uPortUartWrite(pSim->uartHandle, pUrc, strlen(pUrc));
+}
+
+// Open a cellular device talking to a simulated module.
+static int32_t simDeviceOpen(int32_t uart,
+                             int32_t pinTxd, int32_t pinRxd,
+                             int32_t pinCts, int32_t pinRts,
+                             uDeviceHandle_t *pDevHandle)
+{
+    uDeviceCfg_t deviceCfg;
+
+    memset(&deviceCfg, 0, sizeof(deviceCfg));
+    deviceCfg.deviceType = U_DEVICE_TYPE_CELL;
+    deviceCfg.deviceCfg.cfgCell.moduleType = U_CELL_MODULE_TYPE_SARA_R5;
+    deviceCfg.deviceCfg.cfgCell.pinEnablePower = -1;
+    deviceCfg.deviceCfg.cfgCell.pinPwrOn = -1;
+    deviceCfg.deviceCfg.cfgCell.pinVInt = -1;
+    deviceCfg.deviceCfg.cfgCell.pinDtrPowerSaving = -1;
+    deviceCfg.transportType = U_DEVICE_TRANSPORT_TYPE_UART;
+    deviceCfg.transportCfg.cfgUart.uart = uart;
+    deviceCfg.transportCfg.cfgUart.baudRate = U_CFG_TEST_BAUD_RATE;
+    deviceCfg.transportCfg.cfgUart.pinTxd = pinTxd;
+    deviceCfg.transportCfg.cfgUart.pinRxd = pinRxd;
+    deviceCfg.transportCfg.cfgUart.pinCts = pinCts;
+    deviceCfg.transportCfg.cfgUart.pinRts = pinRts;
+
+    return uDeviceOpen(&deviceCfg, pDevHandle);
+}
+
+// Callback for uNetworkInterfaceUpStart().
+static void upAsyncStateCallback(uDeviceHandle_t devHandle,
+                                 uNetworkType_t netType,
+                                 uNetworkState_t state,
+                                 int32_t errorCode,
+                                 void *pParameter)
+{
+    (void) devHandle;
+    (void) netType;
+    (void) pParameter;
+
+    if (gUpAsyncNumStates < sizeof(gUpAsyncState) / sizeof(gUpAsyncState[0])) {
+        gUpAsyncState[gUpAsyncNumStates] = state;
+    }
+    if (state != U_NETWORK_STATE_STARTING) {
+        gUpAsyncErrorCode = errorCode;
+    }
+    gUpAsyncNumStates++;
+}
+
+// Callback for uNetworkBearerPolicyStart().
+static void upAsyncBearerCallback(uDeviceHandle_t devHandle,
+                                  uNetworkType_t netType,
+                                  void *pParameter)
+{
+    (void) netType;
+    (void) pParameter;
+
+    gBearerDevHandle = devHandle;
+    gBearerCallTimeMs = uPortGetTickTimeMs();
+    gBearerNumCalls++;
+}
+
+# if (U_NETWORK_TEST_UART_C >= 0) && (U_NETWORK_TEST_UART_D >= 0)
+// Network status callback for the bearer policy tests.
+static void upAsyncStatusCallback(uDeviceHandle_t devHandle,
+                                  uNetworkType_t netType,
+                                  bool isUp,
+                                  uNetworkStatus_t *pStatus,
+                                  void *pParameter)
+{
+    (void) devHandle;
+    (void) netType;
+    (void) pStatus;
+    (void) pParameter;
+
+    gStatusIsUp = isUp;
+    gStatusNumCalls++;
+}
+
+// Wait for the number of calls to upAsyncStatusCallback() to
+// reach the given value, returning true if it did.
+static bool waitStatusNumCalls(int32_t numCalls, int32_t timeoutMs)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((gStatusNumCalls < numCalls) &&
+           (uPortGetTickTimeMs() - startTimeMs < timeoutMs)) {
+        uPortTaskBlock(10);
+    }
+
+    return (gStatusNumCalls >= numCalls);
+}
+# endif
+
+// Wait for the number of calls to upAsyncStateCallback() to
+// reach the given value, returning true if it did.
+static bool waitUpAsyncNumStates(size_t numStates, int32_t timeoutMs)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((gUpAsyncNumStates < numStates) &&
+           (uPortGetTickTimeMs() - startTimeMs < timeoutMs)) {
+        uPortTaskBlock(10);
+    }
+
+    return (gUpAsyncNumStates >= numStates);
+}
+
+// Wait for the number of calls to upAsyncBearerCallback() to
+// reach the given value, returning true if it did.
+static bool waitBearerNumCalls(int32_t numCalls, int32_t timeoutMs)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((gBearerNumCalls < numCalls) &&
+           (uPortGetTickTimeMs() - startTimeMs < timeoutMs)) {
+        uPortTaskBlock(10);
+    }
+
+    return (gBearerNumCalls >= numCalls);
+}
+#endif
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -1265,6 +1597,305 @@ U_PORT_TEST_FUNCTION("[network]", "networkOutage")
 
 #endif // #if defined(U_CFG_TEST_NET_STATUS_SHORT_RANGE) || defined (U_CFG_TEST_NET_STATUS_CELL)
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Test asynchronous bring-up and the bearer policy using a cellular
+ * device on UART A talking to a cellular module simulated on UART B:
+ * check that uNetworkInterfaceUpStart() returns at once, that the
+ * network is protected while it is starting without the device API
+ * being held up, that the bearer policy follows the loss and
+ * return of a bearer, timing how quickly it reacts, and that a
+ * bring-up can be cancelled.
+ */
+U_PORT_TEST_FUNCTION("[network]", "networkUpAsync")
+{
+    uNetworkCfgCell_t networkCfg;
+    uNetworkBearer_t bearer;
+    uDeviceHandle_t devHandle = NULL;
+    uDeviceHandle_t activeDevHandle = NULL;
+    uNetworkType_t activeNetType = U_NETWORK_TYPE_NONE;
+    int32_t resourceCount;
+    int32_t startTimeMs;
+    int32_t timeMs;
+    int32_t maxLatencyMs = 0;
+    size_t numCalls = 0;
+    int32_t x;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uDeviceInit() == 0);
+
+# ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+# endif
+    // Set up the simulated module on UART B
+    U_PORT_TEST_ASSERT(simOpen(&gSimB, U_CFG_TEST_UART_B,
+                               U_CFG_TEST_PIN_UART_B_TXD, U_CFG_TEST_PIN_UART_B_RXD,
+                               U_CFG_TEST_PIN_UART_B_CTS, U_CFG_TEST_PIN_UART_B_RTS,
+                               U_NETWORK_TEST_UP_ASYNC_DELAY_MS));
+
+    // Open a cellular device on UART A
+    U_TEST_PRINT_LINE("opening a cellular device talking to a simulated module...");
+    U_PORT_TEST_ASSERT(simDeviceOpen(U_CFG_TEST_UART_A,
+                                     U_CFG_TEST_PIN_UART_A_TXD, U_CFG_TEST_PIN_UART_A_RXD,
+                                     U_CFG_TEST_PIN_UART_A_CTS, U_CFG_TEST_PIN_UART_A_RTS,
+                                     &devHandle) == 0);
+    U_PORT_TEST_ASSERT(uNetworkInterfaceGetState(devHandle,
+                                                 U_NETWORK_TYPE_CELL) == (int32_t) U_NETWORK_STATE_DOWN);
+
+    memset(&networkCfg, 0, sizeof(networkCfg));
+    networkCfg.type = U_NETWORK_TYPE_CELL;
+    networkCfg.pApn = "internet";
+    networkCfg.timeoutSeconds = 30;
+
+    // Start the bring-up: this should return immediately
+    gUpAsyncNumStates = 0;
+    gUpAsyncErrorCode = 1;
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uNetworkInterfaceUpStart(devHandle, U_NETWORK_TYPE_CELL,
+                                                &networkCfg, upAsyncStateCallback,
+                                                NULL) == 0);
+    timeMs = uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("uNetworkInterfaceUpStart() returned in %d ms.", timeMs);
+    U_PORT_TEST_ASSERT(timeMs < U_NETWORK_TEST_UP_ASYNC_MAX_LATENCY_MS);
+
+    // While it is starting, the network and the device must be
+    // protected but the API must remain responsive
+    while ((gUpAsyncNumStates < 2) &&
+           (uPortGetTickTimeMs() - startTimeMs < (networkCfg.timeoutSeconds + 10) * 1000)) {
+        timeMs = uPortGetTickTimeMs();
+        x = uNetworkInterfaceGetState(devHandle, U_NETWORK_TYPE_CELL);
+        if (x == (int32_t) U_NETWORK_STATE_STARTING) {
+            U_PORT_TEST_ASSERT(uNetworkSetStatusCallback(devHandle, U_NETWORK_TYPE_CELL,
+                                                         NULL, NULL) == (int32_t) U_ERROR_COMMON_BUSY);
+            U_PORT_TEST_ASSERT(uNetworkInterfaceUp(devHandle, U_NETWORK_TYPE_CELL,
+                                                   &networkCfg) == (int32_t) U_ERROR_COMMON_BUSY);
+            U_PORT_TEST_ASSERT(uDeviceClose(devHandle, false) == (int32_t) U_ERROR_COMMON_BUSY);
+            timeMs = uPortGetTickTimeMs() - timeMs;
+            if (timeMs > maxLatencyMs) {
+                maxLatencyMs = timeMs;
+            }
+            numCalls++;
+        }
+        uPortTaskBlock(50);
+    }
+    U_TEST_PRINT_LINE("bring-up took %d ms, error code %d; %d round(s) of"
+                      " calls meanwhile took at most %d ms.",
+                      uPortGetTickTimeMs() - startTimeMs, gUpAsyncErrorCode,
+                      numCalls, maxLatencyMs);
+    U_PORT_TEST_ASSERT(gUpAsyncNumStates == 2);
+    U_PORT_TEST_ASSERT(gUpAsyncState[0] == U_NETWORK_STATE_STARTING);
+    U_PORT_TEST_ASSERT(gUpAsyncState[1] == U_NETWORK_STATE_UP);
+    U_PORT_TEST_ASSERT(gUpAsyncErrorCode == 0);
+    U_PORT_TEST_ASSERT(numCalls > 0);
+    U_PORT_TEST_ASSERT(maxLatencyMs < U_NETWORK_TEST_UP_ASYNC_MAX_LATENCY_MS);
+    U_PORT_TEST_ASSERT(uNetworkInterfaceGetState(devHandle,
+                                                 U_NETWORK_TYPE_CELL) == (int32_t) U_NETWORK_STATE_UP);
+
+    // Now hand the network to the bearer policy and check that it
+    // becomes the active bearer
+    bearer.devHandle = devHandle;
+    bearer.netType = U_NETWORK_TYPE_CELL;
+    bearer.pCfg = &networkCfg;
+    gBearerNumCalls = 0;
+    U_PORT_TEST_ASSERT(uNetworkBearerPolicyStart(&bearer, 1, true,
+                                                 upAsyncBearerCallback, NULL) == 0);
+    U_PORT_TEST_ASSERT(waitBearerNumCalls(1, (networkCfg.timeoutSeconds + 10) * 1000));
+    U_PORT_TEST_ASSERT(gBearerDevHandle == devHandle);
+    U_PORT_TEST_ASSERT(uNetworkBearerGetActive(&activeDevHandle, &activeNetType) == 0);
+    U_PORT_TEST_ASSERT(activeDevHandle == devHandle);
+    U_PORT_TEST_ASSERT(activeNetType == U_NETWORK_TYPE_CELL);
+
+    // Have the simulated module lose service and then get it back
+    startTimeMs = uPortGetTickTimeMs();
+    simUrcSend(&gSimB, "\r\n+CEREG: 0\r\n");
+    U_PORT_TEST_ASSERT(waitBearerNumCalls(2, 5000));
+    U_TEST_PRINT_LINE("loss of bearer reported %d ms after the URC was sent.",
+                      gBearerCallTimeMs - startTimeMs);
+    U_PORT_TEST_ASSERT(gBearerDevHandle == NULL);
+    U_PORT_TEST_ASSERT(uNetworkBearerGetActive(NULL, NULL) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+    startTimeMs = uPortGetTickTimeMs();
+    simUrcSend(&gSimB, "\r\n+CEREG: 1\r\n");
+    U_PORT_TEST_ASSERT(waitBearerNumCalls(3, 5000));
+    U_TEST_PRINT_LINE("return of bearer reported %d ms after the URC was sent.",
+                      gBearerCallTimeMs - startTimeMs);
+    U_PORT_TEST_ASSERT(gBearerDevHandle == devHandle);
+    U_PORT_TEST_ASSERT(uNetworkBearerGetActive(NULL, NULL) == 0);
+
+    // Stop the policy, taking the network down
+    U_PORT_TEST_ASSERT(uNetworkBearerPolicyStop(true) == 0);
+    U_PORT_TEST_ASSERT(uNetworkBearerGetActive(NULL, NULL) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+    U_PORT_TEST_ASSERT(uNetworkInterfaceGetState(devHandle,
+                                                 U_NETWORK_TYPE_CELL) == (int32_t) U_NETWORK_STATE_DOWN);
+
+    // Start a bring-up again and cancel it while it is starting
+    gUpAsyncNumStates = 0;
+    gUpAsyncErrorCode = 1;
+    U_PORT_TEST_ASSERT(uNetworkInterfaceUpStart(devHandle, U_NETWORK_TYPE_CELL,
+                                                &networkCfg, upAsyncStateCallback,
+                                                NULL) == 0);
+    U_PORT_TEST_ASSERT(uNetworkInterfaceGetState(devHandle,
+                                                 U_NETWORK_TYPE_CELL) == (int32_t) U_NETWORK_STATE_STARTING);
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uNetworkInterfaceDown(devHandle, U_NETWORK_TYPE_CELL) == 0);
+    U_PORT_TEST_ASSERT(waitUpAsyncNumStates(2, (networkCfg.timeoutSeconds + 10) * 1000));
+    U_TEST_PRINT_LINE("cancelled bring-up ended %d ms after uNetworkInterfaceDown(),"
+                      " error code %d.", uPortGetTickTimeMs() - startTimeMs,
+                      gUpAsyncErrorCode);
+    U_PORT_TEST_ASSERT(gUpAsyncState[1] == U_NETWORK_STATE_DOWN);
+    U_PORT_TEST_ASSERT(gUpAsyncErrorCode == (int32_t) U_ERROR_COMMON_CANCELLED);
+    U_PORT_TEST_ASSERT(uNetworkInterfaceGetState(devHandle,
+                                                 U_NETWORK_TYPE_CELL) == (int32_t) U_NETWORK_STATE_DOWN);
+
+    U_PORT_TEST_ASSERT(uDeviceClose(devHandle, false) == 0);
+    simClose(&gSimB);
+    uDeviceDeinit();
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+# if (U_NETWORK_TEST_UART_C >= 0) && (U_NETWORK_TEST_UART_D >= 0)
+/** Test the bearer policy with two bearers, each a cellular device
+ * talking to a simulated module, one on UART A/B, the other on
+ * UART C/D: with pre-warming, check that the less preferred bearer,
+ * which comes up quickly, is active before the more preferred one,
+ * which comes up slowly, that the policy fails over to it when the
+ * preferred bearer loses service and switches back when service
+ * returns, and that a network status callback set by the
+ * application is called alongside that of the policy and is put
+ * back when the policy is stopped.
+ */
+U_PORT_TEST_FUNCTION("[network]", "networkBearerFailover")
+{
+    uNetworkCfgCell_t networkCfg;
+    uNetworkBearer_t bearer[2];
+    uDeviceHandle_t devHandle[2] = {NULL, NULL};
+    int32_t resourceCount;
+    int32_t startTimeMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uDeviceInit() == 0);
+
+#  ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#  endif
+    // The preferred bearer is slow to come up, the other is not
+    U_PORT_TEST_ASSERT(simOpen(&gSimB, U_CFG_TEST_UART_B,
+                               U_CFG_TEST_PIN_UART_B_TXD, U_CFG_TEST_PIN_UART_B_RXD,
+                               U_CFG_TEST_PIN_UART_B_CTS, U_CFG_TEST_PIN_UART_B_RTS,
+                               U_NETWORK_TEST_FAILOVER_DELAY_MS));
+    U_PORT_TEST_ASSERT(simOpen(&gSimD, U_NETWORK_TEST_UART_D, -1, -1, -1, -1, 0));
+    U_TEST_PRINT_LINE("opening two cellular devices talking to simulated modules...");
+    U_PORT_TEST_ASSERT(simDeviceOpen(U_CFG_TEST_UART_A,
+                                     U_CFG_TEST_PIN_UART_A_TXD, U_CFG_TEST_PIN_UART_A_RXD,
+                                     U_CFG_TEST_PIN_UART_A_CTS, U_CFG_TEST_PIN_UART_A_RTS,
+                                     &(devHandle[0])) == 0);
+    U_PORT_TEST_ASSERT(simDeviceOpen(U_NETWORK_TEST_UART_C, -1, -1, -1, -1,
+                                     &(devHandle[1])) == 0);
+
+    memset(&networkCfg, 0, sizeof(networkCfg));
+    networkCfg.type = U_NETWORK_TYPE_CELL;
+    networkCfg.pApn = "internet";
+    networkCfg.timeoutSeconds = 30;
+    for (size_t x = 0; x < sizeof(bearer) / sizeof(bearer[0]); x++) {
+        bearer[x].devHandle = devHandle[x];
+        bearer[x].netType = U_NETWORK_TYPE_CELL;
+        bearer[x].pCfg = &networkCfg;
+    }
+
+    // Start the policy with pre-warming: the bring-up of the
+    // preferred bearer must not hold up the other one
+    gBearerNumCalls = 0;
+    gBearerDevHandle = NULL;
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uNetworkBearerPolicyStart(bearer, 2, true,
+                                                 upAsyncBearerCallback, NULL) == 0);
+    U_PORT_TEST_ASSERT(waitBearerNumCalls(1, (networkCfg.timeoutSeconds + 10) * 1000));
+    U_TEST_PRINT_LINE("second bearer active %d ms after the policy was started.",
+                      gBearerCallTimeMs - startTimeMs);
+    U_PORT_TEST_ASSERT(gBearerDevHandle == devHandle[1]);
+    U_PORT_TEST_ASSERT(uNetworkInterfaceGetState(devHandle[0],
+                                                 U_NETWORK_TYPE_CELL) == (int32_t) U_NETWORK_STATE_STARTING);
+    U_PORT_TEST_ASSERT(waitBearerNumCalls(2, (networkCfg.timeoutSeconds + 10) * 1000));
+    U_TEST_PRINT_LINE("preferred bearer active %d ms after the policy was started.",
+                      gBearerCallTimeMs - startTimeMs);
+    U_PORT_TEST_ASSERT(gBearerDevHandle == devHandle[0]);
+    U_PORT_TEST_ASSERT(uNetworkBearerGetActive(NULL, NULL) == 0);
+
+    // The application may set a status callback of its own
+    gStatusNumCalls = 0;
+    U_PORT_TEST_ASSERT(uNetworkSetStatusCallback(devHandle[0], U_NETWORK_TYPE_CELL,
+                                                 upAsyncStatusCallback, NULL) == 0);
+
+    // Have the preferred bearer lose service: the policy should
+    // fail over and the application should hear about it
+    startTimeMs = uPortGetTickTimeMs();
+    simUrcSend(&gSimB, "\r\n+CEREG: 0\r\n");
+    U_PORT_TEST_ASSERT(waitBearerNumCalls(3, 5000));
+    U_TEST_PRINT_LINE("failover reported %d ms after the URC was sent.",
+                      gBearerCallTimeMs - startTimeMs);
+    U_PORT_TEST_ASSERT(gBearerDevHandle == devHandle[1]);
+    U_PORT_TEST_ASSERT(uNetworkBearerGetActive(NULL, NULL) == 1);
+    U_PORT_TEST_ASSERT(waitStatusNumCalls(1, 5000));
+    U_PORT_TEST_ASSERT(!gStatusIsUp);
+
+    // ...and get it back
+    startTimeMs = uPortGetTickTimeMs();
+    simUrcSend(&gSimB, "\r\n+CEREG: 1\r\n");
+    U_PORT_TEST_ASSERT(waitBearerNumCalls(4, 5000));
+    U_TEST_PRINT_LINE("switch back reported %d ms after the URC was sent.",
+                      gBearerCallTimeMs - startTimeMs);
+    U_PORT_TEST_ASSERT(gBearerDevHandle == devHandle[0]);
+    U_PORT_TEST_ASSERT(waitStatusNumCalls(2, 5000));
+    U_PORT_TEST_ASSERT(gStatusIsUp);
+
+    // Stop the policy, leaving the bearers up: the status callback
+    // of the application should remain and the policy's go
+    U_PORT_TEST_ASSERT(uNetworkBearerPolicyStop(false) == 0);
+    simUrcSend(&gSimB, "\r\n+CEREG: 0\r\n");
+    U_PORT_TEST_ASSERT(waitStatusNumCalls(3, 5000));
+    U_PORT_TEST_ASSERT(!gStatusIsUp);
+    U_PORT_TEST_ASSERT(gBearerNumCalls == 4);
+
+    for (size_t x = 0; x < sizeof(devHandle) / sizeof(devHandle[0]); x++) {
+        U_PORT_TEST_ASSERT(uNetworkInterfaceDown(devHandle[x], U_NETWORK_TYPE_CELL) == 0);
+        U_PORT_TEST_ASSERT(uDeviceClose(devHandle[x], false) == 0);
+    }
+    simClose(&gSimD);
+    simClose(&gSimB);
+    uDeviceDeinit();
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+# endif
+#endif
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
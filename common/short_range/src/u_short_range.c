@@ -916,6 +916,8 @@ void uShortRangeClose(uDeviceHandle_t devHandle)
         uAtClientRemove(pInstance->atHandle);
         // Unlink any geofences and free the fence context
         uGeofenceContextFree((uGeofenceContext_t **) &pInstance->pFenceContext);
+        // Free what the Wifi API knows of the station configuration
+        uPortFree(pInstance->pWifiStaContext);
         uPortUartClose(pInstance->uartHandle);
         removeShortRangeInstance(pInstance);
         uDeviceDestroyInstance(U_DEVICE_INSTANCE(devHandle));
@@ -177,6 +177,8 @@ typedef struct uShortRangePrivateInstance_t {
     uPortMutexHandle_t locMutex;
     volatile void *pLocContext;
     void *pFenceContext; /**< Storage for a uGeofenceContext_t. */
+    void *pWifiStaContext; /**< Storage for what the Wifi API knows
+                                of the station configuration. */
     struct uShortRangePrivateInstance_t *pNext;
 #ifdef U_UCONNECT_GEN2
     uShortRangeUCxContext_t *pUcxContext;
@@ -43,9 +43,7 @@
 #include "u_error_common.h"
 
 #include "u_port.h"
-#if defined U_CFG_TEST_SHORT_RANGE_MODULE_TYPE
-#include "u_port_os.h"
-#endif
+#include "u_port_os.h"   // Required by u_short_range_test_private.h
 #include "u_at_client.h"
 #include "u_short_range_module_type.h"
 #include "u_short_range.h"
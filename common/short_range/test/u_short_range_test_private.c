@@ -31,16 +31,21 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memset()
+#include "string.h"    // memset(), memchr(), strlen()
+#include "stdio.h"     // snprintf()
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
 #include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
 
 #include "u_error_common.h"
 
 #include "u_port.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_uart.h"
 
 #include "u_at_client.h"
 
@@ -64,6 +69,15 @@
  */
 #define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
 
+/** The EDM framing used by the simulated module, see
+ * u_short_range_edm.c.
+ */
+#define U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_HEAD         0xAA
+#define U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_TAIL         0x55
+#define U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_AT_EVENT     0x41
+#define U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_AT_REQUEST   0x44
+#define U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_AT_RESPONSE  0x45
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -76,6 +90,148 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && \
+    !defined(U_CFG_BLE_MODULE_INTERNAL)
+
+// Send a string to the host in an EDM frame of the given type.
+static void simSend(uShortRangeTestPrivateSim_t *pSim, uint8_t type,
+                    const char *pString)
+{
+    size_t length = strlen(pString);
+
+    if (length > U_SHORT_RANGE_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES) {
+        length = U_SHORT_RANGE_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES;
+    }
+    U_PORT_MUTEX_LOCK(pSim->txMutex);
+    pSim->txBuffer[0] = U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_HEAD;
+    pSim->txBuffer[1] = (uint8_t) (((length + 2) >> 8) & 0x0F);
+    pSim->txBuffer[2] = (uint8_t) ((length + 2) & 0xFF);
+    pSim->txBuffer[3] = 0;
+    pSim->txBuffer[4] = type;
+    memcpy(pSim->txBuffer + 5, pString, length);
+    pSim->txBuffer[5 + length] = U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_TAIL;
+    uPortUartWrite(pSim->uartHandle, pSim->txBuffer, length + 6);
+    U_PORT_MUTEX_UNLOCK(pSim->txMutex);
+}
+
+// Handle the payload of an EDM AT request: AT commands may
+// be split across several requests; more is true if further
+// data from the host has already been received.
+static void simHandleAtRequest(uShortRangeTestPrivateSim_t *pSim,
+                               const uint8_t *pPayload, size_t length,
+                               bool more)
+{
+    const char *pResponse;
+    char model[32];
+
+    for (size_t x = 0; x < length; x++) {
+        if (pPayload[x] == '\r') {
+            pSim->command[pSim->commandLength] = 0;
+            if (more || (x + 1 < length)) {
+                // The host didn't wait for this response
+                pSim->numCommandsAhead++;
+            }
+            if (strstr(pSim->command, "AT+GMM") != NULL) {
+                snprintf(model, sizeof(model), "\r\n%s\r\nOK\r\n",
+                         (pSim->pModel != NULL) ? pSim->pModel : "NINA-B3");
+                pResponse = model;
+            } else {
+                pResponse = pSim->pCommandCallback(pSim->command,
+                                                   pSim->pCommandCallbackParameter);
+            }
+            if (pResponse == NULL) {
+                pResponse = "\r\nOK\r\n";
+            }
+            simSend(pSim, U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_AT_RESPONSE, pResponse);
+            pSim->commandLength = 0;
+        } else if ((pPayload[x] != '\n') &&
+                   (pSim->commandLength < sizeof(pSim->command) - 1)) {
+            pSim->command[pSim->commandLength] = (char) pPayload[x];
+            pSim->commandLength++;
+        }
+    }
+}
+
+// Task that pretends to be a short range module on the other end
+// of UART B.
+static void simTask(void *pParameter)
+{
+    uShortRangeTestPrivateSim_t *pSim = (uShortRangeTestPrivateSim_t *) pParameter;
+    int32_t x;
+    size_t frameLength;
+    uint8_t *pStart;
+
+    while (!pSim->stop) {
+        x = 0;
+        if (!pSim->hold) {
+            x = uPortUartRead(pSim->uartHandle, pSim->rxBuffer + pSim->rxLength,
+                              sizeof(pSim->rxBuffer) - pSim->rxLength);
+        }
+        if (x > 0) {
+            pSim->rxLength += x;
+        }
+        if (!pSim->edmMode) {
+            // Look for the command that switches to EDM
+            for (size_t y = 0; (y + 4 <= pSim->rxLength) && !pSim->edmMode; y++) {
+                if (memcmp(pSim->rxBuffer + y, "ATO2", 4) == 0) {
+                    // Keep anything after it, it will be EDM
+                    pSim->edmMode = true;
+                    pSim->rxLength -= y + 4;
+                    memmove(pSim->rxBuffer, pSim->rxBuffer + y + 4, pSim->rxLength);
+                }
+            }
+            if (pSim->rxLength == sizeof(pSim->rxBuffer)) {
+                pSim->rxLength = 0;
+            }
+        } else {
+            // Throw away anything before a frame head, e.g. a
+            // repeated raw "ATO2", then process whole frames
+            do {
+                x = 0;
+                pStart = (uint8_t *) memchr(pSim->rxBuffer,
+                                            U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_HEAD,
+                                            pSim->rxLength);
+                if (pStart == NULL) {
+                    pSim->rxLength = 0;
+                } else {
+                    pSim->rxLength -= pStart - pSim->rxBuffer;
+                    memmove(pSim->rxBuffer, pStart, pSim->rxLength);
+                    if (pSim->rxLength >= 3) {
+                        frameLength = (((size_t) (pSim->rxBuffer[1] & 0x0F)) << 8) +
+                                      pSim->rxBuffer[2] + 4;
+                        if (frameLength > sizeof(pSim->rxBuffer)) {
+                            // Not a frame, skip the head
+                            frameLength = 1;
+                        } else if (pSim->rxLength >= frameLength) {
+                            if ((pSim->rxBuffer[frameLength - 1] ==
+                                 U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_TAIL) &&
+                                (pSim->rxBuffer[4] ==
+                                 U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_AT_REQUEST)) {
+                                simHandleAtRequest(pSim, pSim->rxBuffer + 5, frameLength - 6,
+                                                   pSim->rxLength > frameLength);
+                            }
+                        } else {
+                            frameLength = 0;
+                        }
+                        if (frameLength > 0) {
+                            pSim->rxLength -= frameLength;
+                            memmove(pSim->rxBuffer, pSim->rxBuffer + frameLength,
+                                    pSim->rxLength);
+                            x = 1;
+                        }
+                    }
+                }
+            } while (x > 0);
+        }
+        uPortTaskBlock(1);
+    }
+
+    pSim->stopped = true;
+    uPortTaskDelete(NULL);
+}
+
+#endif // #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && ...
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -178,4 +334,93 @@ void uShortRangeTestPrivateCleanup(uShortRangeTestPrivate_t *pParameters)
     uPortDeinit();
 }
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && \
+    !defined(U_CFG_BLE_MODULE_INTERNAL)
+
+// Start a simulated module on UART B.
+uShortRangeTestPrivateSim_t *pUShortRangeTestPrivateSimStart(uShortRangeTestPrivateSimCommand_t
+                                                             pCommandCallback,
+                                                             void *pParameter)
+{
+    uShortRangeTestPrivateSim_t *pSim;
+    uPortTaskHandle_t taskHandle;
+    bool success = false;
+
+    pSim = (uShortRangeTestPrivateSim_t *) pUPortMalloc(sizeof(*pSim));
+    if (pSim != NULL) {
+        memset(pSim, 0, sizeof(*pSim));
+        pSim->pCommandCallback = pCommandCallback;
+        pSim->pCommandCallbackParameter = pParameter;
+#ifdef U_CFG_TEST_UART_PREFIX
+        uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX));
+#endif
+        pSim->uartHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                         U_CFG_TEST_BAUD_RATE,
+                                         NULL,
+                                         U_SHORT_RANGE_UART_BUFFER_LENGTH_BYTES,
+                                         U_CFG_TEST_PIN_UART_B_TXD,
+                                         U_CFG_TEST_PIN_UART_B_RXD,
+                                         U_CFG_TEST_PIN_UART_B_CTS,
+                                         U_CFG_TEST_PIN_UART_B_RTS);
+        if (pSim->uartHandle >= 0) {
+            if (uPortMutexCreate(&pSim->txMutex) == 0) {
+                success = (uPortTaskCreate(simTask, "simTask",
+                                           U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                           pSim, U_CFG_TEST_OS_TASK_PRIORITY,
+                                           &taskHandle) == 0);
+                if (!success) {
+                    uPortMutexDelete(pSim->txMutex);
+                }
+            }
+            if (!success) {
+                uPortUartClose(pSim->uartHandle);
+            }
+        }
+        if (!success) {
+            uPortFree(pSim);
+            pSim = NULL;
+        }
+    }
+
+    return pSim;
+}
+
+// Send a URC from a simulated module.
+void uShortRangeTestPrivateSimSendEvent(uShortRangeTestPrivateSim_t *pSim,
+                                        const char *pUrc)
+{
+    char buffer[U_SHORT_RANGE_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES];
+
+    snprintf(buffer, sizeof(buffer), "\r\n%s\r\n", pUrc);
+    simSend(pSim, U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_AT_EVENT, buffer);
+}
+
+// Send part of a response from a simulated module.
+void uShortRangeTestPrivateSimSendResponse(uShortRangeTestPrivateSim_t *pSim,
+                                           const char *pLine)
+{
+    char buffer[U_SHORT_RANGE_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES];
+
+    snprintf(buffer, sizeof(buffer), "\r\n%s\r\n", pLine);
+    simSend(pSim, U_SHORT_RANGE_TEST_PRIVATE_SIM_EDM_AT_RESPONSE, buffer);
+}
+
+// Stop a simulated module.
+void uShortRangeTestPrivateSimStop(uShortRangeTestPrivateSim_t *pSim)
+{
+    if (pSim != NULL) {
+        pSim->stop = true;
+        while (!pSim->stopped) {
+            uPortTaskBlock(10);
+        }
+        // Let the task go away
+        uPortTaskBlock(100);
+        uPortUartClose(pSim->uartHandle);
+        uPortMutexDelete(pSim->txMutex);
+        uPortFree(pSim);
+    }
+}
+
+#endif // #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && ...
+
 // End of file
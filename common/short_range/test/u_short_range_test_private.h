@@ -35,6 +35,21 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_SHORT_RANGE_TEST_PRIVATE_SIM_RX_BUFFER_LENGTH_BYTES
+/** The size of the receive buffer of the simulated module: must
+ * be large enough for an EDM frame carrying a chunk of AT command.
+ */
+# define U_SHORT_RANGE_TEST_PRIVATE_SIM_RX_BUFFER_LENGTH_BYTES 1024
+#endif
+
+#ifndef U_SHORT_RANGE_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES
+/** The size of the buffers in the simulated module that an AT
+ * command is reassembled into and that a response or event is
+ * framed in: enough for a GATT value of 244 bytes, hex encoded.
+ */
+# define U_SHORT_RANGE_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES 576
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -48,6 +63,39 @@ typedef struct {
     uDeviceHandle_t devHandle;  /**< The handle returned by uShortRangeOpenUart(). */
 } uShortRangeTestPrivate_t;
 
+/** Callback with which a test handles an AT command received by
+ * the simulated module, see pUShortRangeTestPrivateSimStart().
+ *
+ * @param[in] pCommand   the AT command, without the line ending.
+ * @param[in] pParameter the parameter given to pUShortRangeTestPrivateSimStart().
+ * @return               the complete response, with line endings,
+ *                       or NULL for a plain "OK".
+ */
+typedef const char *(*uShortRangeTestPrivateSimCommand_t)(const char *pCommand,
+                                                          void *pParameter);
+
+/** The state of a simulated short range module.
+ */
+typedef struct {
+    int32_t uartHandle;
+    uPortMutexHandle_t txMutex; /**< so that events and responses don't collide. */
+    volatile bool stop;         /**< set this to stop the simulator task. */
+    volatile bool stopped;      /**< set by the simulator task when it has stopped. */
+    volatile bool hold;         /**< set this to stop the simulator reading the UART. */
+    volatile size_t numCommandsAhead; /**< the number of AT commands that arrived
+                                           before the response to the previous
+                                           command had been sent. */
+    bool edmMode;
+    const char *pModel;         /**< the answer to "AT+GMM", "NINA-B3" if NULL. */
+    uShortRangeTestPrivateSimCommand_t pCommandCallback;
+    void *pCommandCallbackParameter;
+    uint8_t rxBuffer[U_SHORT_RANGE_TEST_PRIVATE_SIM_RX_BUFFER_LENGTH_BYTES];
+    size_t rxLength;
+    char command[U_SHORT_RANGE_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES];
+    size_t commandLength;
+    uint8_t txBuffer[U_SHORT_RANGE_TEST_PRIVATE_SIM_LINE_LENGTH_BYTES + 6];
+} uShortRangeTestPrivateSim_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -95,6 +143,51 @@ void uShortRangeTestPrivatePostamble(uShortRangeTestPrivate_t *pParameters);
 //                                         is not defined
 void uShortRangeTestPrivateCleanup(uShortRangeTestPrivate_t *pParameters);
 
+/** Start a simulated NINA-B3 on UART B, for the host on the other
+ * end of UART A, where no real module is available: it waits for
+ * "ATO2", which puts it into EDM mode, and from then on passes the
+ * AT commands carried in EDM frames to pCommandCallback and sends
+ * back the response.  "AT+GMM" is answered by the simulator itself,
+ * with pModel if that is set, so that another module type may be
+ * simulated by setting pModel before the device is opened.
+ * Only available where U_CFG_TEST_UART_A and U_CFG_TEST_UART_B are
+ * both set.
+ *
+ * @param[in] pCommandCallback  the command callback, cannot be NULL.
+ * @param[in] pParameter        parameter passed to pCommandCallback.
+ * @return                      the simulator or NULL on failure.
+ */
+uShortRangeTestPrivateSim_t *pUShortRangeTestPrivateSimStart(uShortRangeTestPrivateSimCommand_t
+                                                             pCommandCallback,
+                                                             void *pParameter);
+
+/** Send an AT event, i.e. a URC, from a simulated module.
+ *
+ * @param[in] pSim   the simulator.
+ * @param[in] pUrc   the URC, without line endings, e.g.
+ *                   "+UUBTACLD:0".
+ */
+void uShortRangeTestPrivateSimSendEvent(uShortRangeTestPrivateSim_t *pSim,
+                                        const char *pUrc);
+
+/** Send part of the response to an AT command from a simulated
+ * module, for a command callback that streams lines of a response
+ * (e.g. with delays between them) before returning the rest of it.
+ * May only be called from the command callback.
+ *
+ * @param[in] pSim   the simulator.
+ * @param[in] pLine  the line, without line endings, e.g.
+ *                   "+UWSCAN:0012F28A8E3D,1,\"ssid\",6,-60,18,8,8".
+ */
+void uShortRangeTestPrivateSimSendResponse(uShortRangeTestPrivateSim_t *pSim,
+                                           const char *pLine);
+
+/** Stop a simulated module and free it.
+ *
+ * @param[in] pSim   the simulator, may be NULL.
+ */
+void uShortRangeTestPrivateSimStop(uShortRangeTestPrivateSim_t *pSim);
+
 #ifdef __cplusplus
 }
 #endif
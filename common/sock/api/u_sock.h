@@ -84,6 +84,45 @@ extern "C" {
 # define U_SOCK_CLOSE_TIMEOUT_SECONDS 60
 #endif
 
+#ifndef U_SOCK_DNS_CACHE_NUM_ENTRIES
+/** The number of host names for which the DNS cache of each
+ * device remembers the outcome of a look-up; when the cache
+ * is full the least recently used entry is replaced.
+ */
+# define U_SOCK_DNS_CACHE_NUM_ENTRIES 8
+#endif
+
+#ifndef U_SOCK_DNS_HOST_NAME_MAX_LENGTH_BYTES
+/** The longest host name, not including the terminator, that
+ * will be stored in the DNS cache (look-ups of longer host names
+ * always go to the module) and the longest host name that may
+ * be passed to uSockGetHostByNameAsync().  Note that the latter
+ * is passed through an event queue, the parameter length of
+ * which is limited to #U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES.
+ */
+# define U_SOCK_DNS_HOST_NAME_MAX_LENGTH_BYTES 64
+#endif
+
+#ifndef U_SOCK_DNS_CACHE_MAX_AGE_SECONDS
+/** The time for which a successful DNS look-up is remembered
+ * once uSockDnsCacheSet() has created a DNS cache for a device,
+ * until uSockDnsCacheSet() sets something else.  The modules do
+ * not report the time-to-live of a DNS record, hence this takes
+ * its place.  Without a call to uSockDnsCacheSet() nothing is
+ * cached.
+ */
+# define U_SOCK_DNS_CACHE_MAX_AGE_SECONDS 0
+#endif
+
+#ifndef U_SOCK_DNS_CACHE_NEGATIVE_MAX_AGE_SECONDS
+/** As #U_SOCK_DNS_CACHE_MAX_AGE_SECONDS but for a failed DNS
+ * look-up, i.e. one where the module reported that the host could
+ * not be found.  Failures for other reasons (e.g. a time-out or
+ * no memory) are never remembered.
+ */
+# define U_SOCK_DNS_CACHE_NEGATIVE_MAX_AGE_SECONDS 0
+#endif
+
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS: SOCKET OPTIONS FOR SOCKET LEVEL (-1)
  * -------------------------------------------------------------- */
@@ -431,7 +470,8 @@ int32_t uSockClose(uSockDescriptor_t descriptor);
  * waiting for the far end to close WILL be cleaned-up by this
  * function and so no callback registered by
  * uSockRegisterCallbackClosed() will be triggered when the
- * remote server finally closes the connection.
+ * remote server finally closes the connection.  The DNS caches,
+ * and their settings, are also freed.
  */
 void uSockCleanUp();
 
@@ -440,7 +480,9 @@ void uSockCleanUp();
  * sockets to be shut down in an organised way, with all sockets
  * closed locally, it can be done by calling this function.
  * It is different from uSockCleanUp() in that all sockets,
- * whatever their state, are closed locally.
+ * whatever their state, are closed locally.  As with
+ * uSockCleanUp(), the DNS caches and their settings are also
+ * freed.
  */
 void uSockDeinit();
 
@@ -782,6 +824,12 @@ int32_t uSockGetLocalAddress(uSockDescriptor_t descriptor,
  * straight away without any external action, hence this also
  * implements "get host by address".
  *
+ * If uSockDnsCacheSet() has been called for the device, the
+ * outcome of a look-up is remembered in a DNS cache and, if
+ * several tasks look up the same host name at the same time, only
+ * one request is sent to the module, the others waiting for its
+ * answer.  By default there is no caching.
+ *
  * @param devHandle      the handle of the underlying network to
  *                       use for host name look-up.
  * @param pHostName      a string representing the host to search
@@ -797,6 +845,83 @@ int32_t uSockGetLocalAddress(uSockDescriptor_t descriptor,
 int32_t uSockGetHostByName(uDeviceHandle_t devHandle, const char *pHostName,
                            uSockIpAddress_t *pHostIpAddress);
 
+/** As uSockGetHostByName() but non-blocking: the look-up is
+ * carried out in a task of the sockets layer and pCallback is
+ * called from that task when it is done.  Look-ups queued in this
+ * way are performed one at a time, in the order they were queued.
+ *
+ * @param devHandle          the handle of the underlying network
+ *                           to use for host name look-up.
+ * @param pHostName          a string representing the host to
+ *                           search for, no more than
+ *                           #U_SOCK_DNS_HOST_NAME_MAX_LENGTH_BYTES
+ *                           long;
+ *                           a copy is taken so this need not
+ *                           remain valid after the call returns.
+ * @param pCallback          the callback, cannot be NULL; the
+ *                           parameters are the device handle, the
+ *                           host name, zero on success else a
+ *                           negated value from u_sock_errno.h, a
+ *                           pointer to the IP address of the host
+ *                           (NULL on failure) and pCallbackParameter.
+ *                           None of the pointers remain valid after
+ *                           the callback has returned.
+ * @param pCallbackParameter a parameter that will be passed to
+ *                           pCallback.
+ * @return                   zero if the look-up has been queued,
+ *                           else negative error code (and errno
+ *                           will also be set to a value from
+ *                           u_sock_errno.h).
+ */
+int32_t uSockGetHostByNameAsync(uDeviceHandle_t devHandle,
+                                const char *pHostName,
+                                void (*pCallback) (uDeviceHandle_t,
+                                                   const char *,
+                                                   int32_t,
+                                                   const uSockIpAddress_t *,
+                                                   void *),
+                                void *pCallbackParameter);
+
+/** Set how long the outcome of a DNS look-up is remembered in the
+ * DNS cache of a device, creating the cache if there isn't one.
+ * Entries already in the cache are judged against the new times.
+ * The cache is flushed when a network of the device is taken down
+ * with uNetworkInterfaceDown() and it is freed, along with these
+ * settings, by uDeviceClose(), uSockCleanUp() and uSockDeinit().
+ *
+ * @param devHandle             the handle of a cellular or
+ *                              short-range device.
+ * @param maxAgeSeconds         how long to remember a successful
+ *                              look-up for; use zero to not
+ *                              remember successful look-ups.
+ * @param negativeMaxAgeSeconds how long to remember that a host
+ *                              could not be found for; use zero
+ *                              to not remember failed look-ups.
+ * @return                      zero on success else negative error
+ *                              code (and errno will also be set to
+ *                              a value from u_sock_errno.h).
+ */
+int32_t uSockDnsCacheSet(uDeviceHandle_t devHandle,
+                         int32_t maxAgeSeconds,
+                         int32_t negativeMaxAgeSeconds);
+
+/** Forget everything in the DNS cache of a device, e.g. because
+ * the application knows that an address has changed.  A look-up
+ * that is in progress when this is called completes but its
+ * outcome is not remembered.
+ *
+ * @param devHandle the handle of the device, use NULL to flush
+ *                  the DNS caches of all devices.
+ */
+void uSockDnsCacheFlush(uDeviceHandle_t devHandle);
+
+/** Free the DNS cache of a device and forget its settings; this
+ * is called by uDeviceClose(), the application need not call it.
+ *
+ * @param devHandle the handle of the device.
+ */
+void uSockDnsCacheFree(uDeviceHandle_t devHandle);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: ADDRESS CONVERSION
  * -------------------------------------------------------------- */
@@ -319,6 +319,7 @@
 #include "sys/time.h"      // mktime() and struct timeval in most cases
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
 
 #include "u_error_common.h"
 
@@ -332,6 +333,7 @@
 #include "u_port_os.h"
 #include "u_port_heap.h"
 #include "u_port_debug.h"
+#include "u_port_event_queue.h"
 
 #include "u_sock.h"
 #include "u_sock_security.h"
@@ -356,6 +358,27 @@
 # define U_SOCK_NUM_STATIC_SOCKETS     7
 #endif
 
+#ifndef U_SOCK_DNS_TASK_STACK_SIZE_BYTES
+/** The stack size of the task in which uSockGetHostByNameAsync()
+ * performs look-ups and calls the user's callback.
+ */
+# define U_SOCK_DNS_TASK_STACK_SIZE_BYTES 2304
+#endif
+
+#ifndef U_SOCK_DNS_TASK_PRIORITY
+/** The priority of the task in which uSockGetHostByNameAsync()
+ * performs look-ups and calls the user's callback.
+ */
+# define U_SOCK_DNS_TASK_PRIORITY U_CFG_OS_APP_TASK_PRIORITY
+#endif
+
+#ifndef U_SOCK_DNS_QUEUE_LENGTH
+/** The number of uSockGetHostByNameAsync() look-ups that may be
+ * queued before uSockGetHostByNameAsync() blocks.
+ */
+# define U_SOCK_DNS_QUEUE_LENGTH 4
+#endif
+
 /** Increment a socket descriptor.
  */
 #define U_SOCK_INC_DESCRIPTOR(d)  (d)++;         \
@@ -416,6 +439,59 @@ typedef struct uSockContainer_t {
     bool isStatic; // At end to optimise structure packing
 } uSockContainer_t;
 
+/** An entry in a DNS cache.
+ */
+typedef struct {
+    char hostName[U_SOCK_DNS_HOST_NAME_MAX_LENGTH_BYTES + 1]; /**< empty if the
+                                                                   entry is unused. */
+    uSockIpAddress_t ipAddress;
+    int32_t errnoLocal;       /**< the outcome of the last look-up,
+                                   a value from the U_SOCK_Exxx list. */
+    int32_t resolvedTimeMs;   /**< when the last look-up completed. */
+    int32_t lastUsedTimeMs;   /**< for least-recently-used replacement. */
+    int32_t numLookUps;       /**< incremented each time a look-up
+                                   completes, so that a task waiting
+                                   for a pending look-up can tell
+                                   that it is done. */
+    bool cacheable;           /**< false if the outcome of the last
+                                   look-up should not be remembered. */
+    bool pending;             /**< true while a look-up is in progress. */
+    bool flushed;             /**< set if the cache is flushed while
+                                   a look-up is in progress, so that
+                                   its outcome is not remembered. */
+} uSockDnsCacheEntry_t;
+
+/** The DNS cache of a device.
+ */
+typedef struct uSockDnsCache_t {
+    uDeviceHandle_t devHandle;
+    int32_t maxAgeSeconds;
+    int32_t negativeMaxAgeSeconds;
+    uSockDnsCacheEntry_t entry[U_SOCK_DNS_CACHE_NUM_ENTRIES];
+    uPortSemaphoreHandle_t semaphore; /**< tasks waiting for a look-up
+                                           by another task block on this. */
+    size_t numWaiting;                /**< the number of tasks that are
+                                           using semaphore. */
+    size_t numToWake;                 /**< the number of those that have
+                                           not yet been given semaphore. */
+    bool removed;                     /**< set when the cache has been
+                                           taken out of the list while
+                                           numWaiting was non-zero; the
+                                           last waiter out frees it. */
+    struct uSockDnsCache_t *pNext;
+} uSockDnsCache_t;
+
+/** A look-up requested by uSockGetHostByNameAsync(), passed
+ * through the DNS event queue.
+ */
+typedef struct {
+    uDeviceHandle_t devHandle;
+    void (*pCallback) (uDeviceHandle_t, const char *, int32_t,
+                       const uSockIpAddress_t *, void *);
+    void *pCallbackParameter;
+    char hostName[U_SOCK_DNS_HOST_NAME_MAX_LENGTH_BYTES + 1];
+} uSockDnsAsync_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -444,6 +520,19 @@ static uSockDescriptor_t gNextDescriptor = 0;
  */
 static uSockContainer_t gStaticContainers[U_SOCK_NUM_STATIC_SOCKETS];
 
+/** Mutex to protect the DNS caches and the DNS event queue handle.
+ */
+static uPortMutexHandle_t gMutexDns = NULL;
+
+/** Root of the list of DNS caches, one per device.
+ */
+static uSockDnsCache_t *gpDnsCacheListHead = NULL;
+
+/** Handle of the event queue in which uSockGetHostByNameAsync()
+ * look-ups are performed, opened on first use.
+ */
+static int32_t gDnsEventQueueHandle = -1;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -473,6 +562,13 @@ static int32_t init()
             uPortOsResourcePerpetualAdd(U_PORT_OS_RESOURCE_TYPE_MUTEX);
         }
     }
+    if ((errorCode == 0) && (gMutexDns == NULL)) {
+        errorCode = uPortMutexCreate(&gMutexDns);
+        if (errorCode == 0) {
+            // Mark this as a perpetual mutex for accounting purposes
+            uPortOsResourcePerpetualAdd(U_PORT_OS_RESOURCE_TYPE_MUTEX);
+        }
+    }
 
     if (errorCode == 0) {
         errnoLocal = U_SOCK_ENONE;
@@ -1069,6 +1165,333 @@ static void printSocketOption(const void *pOptionValue,
 #endif
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: DNS
+ * -------------------------------------------------------------- */
+
+// Do a DNS look-up through the underlying cell/wifi socket
+// layer, returning a value from the U_SOCK_Exxx list.
+static int32_t dnsLookUp(uDeviceHandle_t devHandle,
+                         const char *pHostName,
+                         uSockIpAddress_t *pHostIpAddress)
+{
+    int32_t errnoLocal = U_SOCK_ENOSYS;
+    int32_t devType = uDeviceGetDeviceType(devHandle);
+
+    // uXxxSockGetHostByName() returns a negated
+    // value from the U_SOCK_Exxx list.
+    if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
+        errnoLocal = -uCellSockGetHostByName(devHandle,
+                                             pHostName,
+                                             pHostIpAddress);
+    } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
+        errnoLocal = -uWifiSockGetHostByName(devHandle,
+                                             pHostName,
+                                             pHostIpAddress);
+    }
+
+    return errnoLocal;
+}
+
+// Find the DNS cache of a device, creating it if requested;
+// devHandle must have been checked to be a valid cellular or
+// short-range device before create is set.
+// gMutexDns must be locked.
+static uSockDnsCache_t *pDnsCacheGet(uDeviceHandle_t devHandle,
+                                     bool create)
+{
+    uSockDnsCache_t *pCache = gpDnsCacheListHead;
+
+    while ((pCache != NULL) && (pCache->devHandle != devHandle)) {
+        pCache = pCache->pNext;
+    }
+
+    if ((pCache == NULL) && create) {
+        pCache = (uSockDnsCache_t *) pUPortMalloc(sizeof(*pCache));
+        if (pCache != NULL) {
+            memset(pCache, 0, sizeof(*pCache));
+            if (uPortSemaphoreCreate(&(pCache->semaphore), 0, INT_MAX) == 0) {
+                pCache->devHandle = devHandle;
+                pCache->maxAgeSeconds = U_SOCK_DNS_CACHE_MAX_AGE_SECONDS;
+                pCache->negativeMaxAgeSeconds = U_SOCK_DNS_CACHE_NEGATIVE_MAX_AGE_SECONDS;
+                pCache->pNext = gpDnsCacheListHead;
+                gpDnsCacheListHead = pCache;
+            } else {
+                uPortFree(pCache);
+                pCache = NULL;
+            }
+        }
+    }
+
+    return pCache;
+}
+
+// Wake up all of the tasks waiting for a look-up in a DNS
+// cache to complete; they will each check whether it is the
+// one they want.  gMutexDns must be locked.
+static void dnsCacheWake(uSockDnsCache_t *pCache)
+{
+    for (; pCache->numToWake > 0; pCache->numToWake--) {
+        uPortSemaphoreGive(pCache->semaphore);
+    }
+}
+
+// Free a DNS cache that has been taken out of the list or, if
+// there are tasks waiting on it, wake them up and leave the
+// last of them to free it.  gMutexDns must be locked.
+static void dnsCacheFree(uSockDnsCache_t *pCache)
+{
+    if (pCache->numWaiting == 0) {
+        uPortSemaphoreDelete(pCache->semaphore);
+        uPortFree(pCache);
+    } else {
+        pCache->removed = true;
+        dnsCacheWake(pCache);
+    }
+}
+
+// Find the entry for a host name in a DNS cache; gMutexDns
+// must be locked.
+static uSockDnsCacheEntry_t *pDnsCacheEntryFind(uSockDnsCache_t *pCache,
+                                                const char *pHostName)
+{
+    uSockDnsCacheEntry_t *pEntry = NULL;
+
+    if (pCache != NULL) {
+        for (size_t x = 0; (x < sizeof(pCache->entry) /
+                            sizeof(pCache->entry[0])) && (pEntry == NULL); x++) {
+            if ((pCache->entry[x].hostName[0] != 0) &&
+                (strcmp(pCache->entry[x].hostName, pHostName) == 0)) {
+                pEntry = &(pCache->entry[x]);
+            }
+        }
+    }
+
+    return pEntry;
+}
+
+// Claim an entry in a DNS cache for a new look-up of a host name,
+// using a free entry or else replacing the least recently used
+// one; returns NULL if every entry has a look-up in progress.
+// gMutexDns must be locked.
+static uSockDnsCacheEntry_t *pDnsCacheEntryClaim(uSockDnsCache_t *pCache,
+                                                 const char *pHostName)
+{
+    uSockDnsCacheEntry_t *pEntry = NULL;
+    uSockDnsCacheEntry_t *pTmp;
+
+    for (size_t x = 0; x < sizeof(pCache->entry) / sizeof(pCache->entry[0]); x++) {
+        pTmp = &(pCache->entry[x]);
+        if (!pTmp->pending) {
+            if (pTmp->hostName[0] == 0) {
+                pEntry = pTmp;
+                break;
+            }
+            if ((pEntry == NULL) ||
+                (pTmp->lastUsedTimeMs - pEntry->lastUsedTimeMs < 0)) {
+                pEntry = pTmp;
+            }
+        }
+    }
+
+    if (pEntry != NULL) {
+        memset(pEntry, 0, sizeof(*pEntry));
+        strncpy(pEntry->hostName, pHostName, sizeof(pEntry->hostName) - 1);
+    }
+
+    return pEntry;
+}
+
+// Return true if the outcome of the last look-up in a DNS
+// cache entry may be used; gMutexDns must be locked.
+static bool dnsCacheEntryIsFresh(const uSockDnsCache_t *pCache,
+                                 const uSockDnsCacheEntry_t *pEntry)
+{
+    int32_t maxAgeSeconds = pCache->maxAgeSeconds;
+
+    if (pEntry->errnoLocal != U_SOCK_ENONE) {
+        maxAgeSeconds = pCache->negativeMaxAgeSeconds;
+    }
+
+    return !pEntry->pending && pEntry->cacheable &&
+           (uPortGetTickTimeMs() - pEntry->resolvedTimeMs < maxAgeSeconds * 1000);
+}
+
+// Get the IP address of a host name, from the DNS cache of the
+// device if possible, else from the module; if another task is
+// already asking the module about the same host name, wait for
+// its answer rather than asking again.  Returns a value from
+// the U_SOCK_Exxx list.
+static int32_t getHostByName(uDeviceHandle_t devHandle,
+                             const char *pHostName,
+                             uSockIpAddress_t *pHostIpAddress)
+{
+    int32_t errnoLocal = U_SOCK_ENONE;
+    uSockDnsCache_t *pCache;
+    uSockDnsCacheEntry_t *pEntry;
+    uSockAddress_t address;
+    int32_t numLookUps = -1;
+    uSockDnsCache_t *pWaitCache;
+    bool lookUp = false;
+    bool done = false;
+
+    memset(&address, 0, sizeof(address));
+    if (uSockStringToAddress(pHostName, &address) == 0) {
+        // Already an IP address, nothing to look up
+        done = true;
+    }
+
+    while (!done) {
+        pEntry = NULL;
+        pWaitCache = NULL;
+
+        U_PORT_MUTEX_LOCK(gMutexDns);
+
+        lookUp = true;
+        // A device only has a cache if uSockDnsCacheSet() has
+        // been called for it
+        pCache = pDnsCacheGet(devHandle, false);
+        if ((pCache != NULL) &&
+            ((pCache->maxAgeSeconds > 0) || (pCache->negativeMaxAgeSeconds > 0)) &&
+            (strlen(pHostName) < sizeof(pCache->entry[0].hostName))) {
+            pEntry = pDnsCacheEntryFind(pCache, pHostName);
+            if (pEntry != NULL) {
+                if (pEntry->pending) {
+                    // Someone else is asking the module: wait for
+                    // them, remembering where they have got to
+                    lookUp = false;
+                    pWaitCache = pCache;
+                    pWaitCache->numWaiting++;
+                    pWaitCache->numToWake++;
+                    numLookUps = pEntry->numLookUps;
+                    pEntry = NULL;
+                } else if (dnsCacheEntryIsFresh(pCache, pEntry) ||
+                           ((numLookUps >= 0) && (pEntry->numLookUps != numLookUps))) {
+                    // Either we have a usable answer or the look-up
+                    // we were waiting for has completed: take its
+                    // outcome even if it is not one to remember
+                    lookUp = false;
+                    done = true;
+                    errnoLocal = pEntry->errnoLocal;
+                    address.ipAddress = pEntry->ipAddress;
+                    pEntry->lastUsedTimeMs = uPortGetTickTimeMs();
+                    pEntry = NULL;
+                }
+            } else {
+                pEntry = pDnsCacheEntryClaim(pCache, pHostName);
+            }
+            if (pEntry != NULL) {
+                // We are going to ask the module
+                pEntry->pending = true;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutexDns);
+
+        if (lookUp) {
+            errnoLocal = dnsLookUp(devHandle, pHostName, &(address.ipAddress));
+            if (pEntry != NULL) {
+
+                U_PORT_MUTEX_LOCK(gMutexDns);
+
+                // Find the entry again: the cache may have
+                // been flushed or freed while we were out
+                pCache = pDnsCacheGet(devHandle, false);
+                pEntry = pDnsCacheEntryFind(pCache, pHostName);
+                if ((pEntry != NULL) && pEntry->pending) {
+                    pEntry->errnoLocal = errnoLocal;
+                    pEntry->ipAddress = address.ipAddress;
+                    pEntry->resolvedTimeMs = uPortGetTickTimeMs();
+                    pEntry->lastUsedTimeMs = pEntry->resolvedTimeMs;
+                    // Only remember success or the module telling
+                    // us that the host could not be found
+                    pEntry->cacheable = !pEntry->flushed &&
+                                        ((errnoLocal == U_SOCK_ENONE) ||
+                                         (errnoLocal == U_SOCK_ENXIO) ||
+                                         (errnoLocal == U_SOCK_EHOSTUNREACH));
+                    pEntry->flushed = false;
+                    pEntry->numLookUps++;
+                    pEntry->pending = false;
+                    dnsCacheWake(pCache);
+                }
+
+                U_PORT_MUTEX_UNLOCK(gMutexDns);
+            }
+            done = true;
+        } else if (pWaitCache != NULL) {
+            uPortSemaphoreTake(pWaitCache->semaphore);
+
+            U_PORT_MUTEX_LOCK(gMutexDns);
+
+            pWaitCache->numWaiting--;
+            if (pWaitCache->removed && (pWaitCache->numWaiting == 0)) {
+                // The cache was freed while we waited
+                // and we are the last one out
+                dnsCacheFree(pWaitCache);
+            }
+
+            U_PORT_MUTEX_UNLOCK(gMutexDns);
+        }
+    }
+
+    if ((errnoLocal == U_SOCK_ENONE) && (pHostIpAddress != NULL)) {
+        *pHostIpAddress = address.ipAddress;
+    }
+
+    return errnoLocal;
+}
+
+// Event queue handler for uSockGetHostByNameAsync().
+static void dnsEventHandler(void *pParam, size_t paramLength)
+{
+    uSockDnsAsync_t *pAsync = (uSockDnsAsync_t *) pParam;
+    uSockIpAddress_t ipAddress;
+    int32_t errnoLocal;
+
+    (void) paramLength;
+
+    memset(&ipAddress, 0, sizeof(ipAddress));
+    errnoLocal = getHostByName(pAsync->devHandle, pAsync->hostName, &ipAddress);
+    pAsync->pCallback(pAsync->devHandle, pAsync->hostName, -errnoLocal,
+                      (errnoLocal == U_SOCK_ENONE) ? &ipAddress : NULL,
+                      pAsync->pCallbackParameter);
+}
+
+// Close the DNS event queue and free the DNS caches.
+static void dnsDeinit()
+{
+    uSockDnsCache_t *pCache;
+    int32_t eventQueueHandle;
+
+    if (gMutexDns != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutexDns);
+
+        eventQueueHandle = gDnsEventQueueHandle;
+        gDnsEventQueueHandle = -1;
+
+        U_PORT_MUTEX_UNLOCK(gMutexDns);
+
+        // Close the event queue outside the lock as
+        // any look-up it is doing will need it
+        if (eventQueueHandle >= 0) {
+            uPortEventQueueClose(eventQueueHandle);
+        }
+
+        U_PORT_MUTEX_LOCK(gMutexDns);
+
+        while (gpDnsCacheListHead != NULL) {
+            pCache = gpDnsCacheListHead;
+            gpDnsCacheListHead = pCache->pNext;
+            // Anyone waiting will find no cache
+            // and do their own look-up
+            dnsCacheFree(pCache);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutexDns);
+    }
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: Creating
  * -------------------------------------------------------------- */
@@ -1535,6 +1958,9 @@ void uSockCleanUp()
 
         U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
+
+    // Free the DNS caches also
+    dnsDeinit();
 }
 
 // Close all sockets and free resource.
@@ -1603,6 +2029,9 @@ void uSockDeinit()
 
         U_PORT_MUTEX_UNLOCK(gMutexContainer);
     }
+
+    // Free the DNS caches whatever the state
+    dnsDeinit();
 }
 
 /* ----------------------------------------------------------------
@@ -2773,28 +3202,117 @@ int32_t uSockGetHostByName(uDeviceHandle_t devHandle,
     if (errnoLocal == U_SOCK_ENONE) {
         errnoLocal = U_SOCK_EINVAL;
         // Check parameters
-        if ((pHostName != NULL) && (pHostIpAddress != NULL)) {
+        if (pHostName != NULL) {
+            // No need to lock gMutexContainer: the DNS look-up
+            // doesn't touch any sockets and holding it would
+            // stall all other socket calls for the duration
+            errnoLocal = getHostByName(devHandle, pHostName,
+                                       pHostIpAddress);
+        }
+    }
 
-            U_PORT_MUTEX_LOCK(gMutexContainer);
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCode = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
 
-            int32_t devType = uDeviceGetDeviceType(devHandle);
+    return errorCode;
+}
 
-            // Talk to the underlying cell/wifi
-            // socket layer to do the DNS look-up.
-            // uXxxSockGetHostByName() returns a negated
-            // value from the U_SOCK_Exxx list.
-            errnoLocal = U_SOCK_ENOSYS;
-            if (devType == (int32_t) U_DEVICE_TYPE_CELL) {
-                errnoLocal = -uCellSockGetHostByName(devHandle,
-                                                     pHostName,
-                                                     pHostIpAddress);
-            } else if (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE) {
-                errnoLocal = -uWifiSockGetHostByName(devHandle,
-                                                     pHostName,
-                                                     pHostIpAddress);
+// Get the IP address of the given host name without blocking.
+int32_t uSockGetHostByNameAsync(uDeviceHandle_t devHandle,
+                                const char *pHostName,
+                                void (*pCallback) (uDeviceHandle_t,
+                                                   const char *,
+                                                   int32_t,
+                                                   const uSockIpAddress_t *,
+                                                   void *),
+                                void *pCallbackParameter)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+    int32_t eventQueueHandle;
+    uSockDnsAsync_t async;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = U_SOCK_EINVAL;
+        // Check parameters
+        if ((pHostName != NULL) && (pCallback != NULL) &&
+            (strlen(pHostName) < sizeof(async.hostName))) {
+            memset(&async, 0, sizeof(async));
+            async.devHandle = devHandle;
+            async.pCallback = pCallback;
+            async.pCallbackParameter = pCallbackParameter;
+            strncpy(async.hostName, pHostName, sizeof(async.hostName) - 1);
+
+            U_PORT_MUTEX_LOCK(gMutexDns);
+
+            errnoLocal = U_SOCK_ENOMEM;
+            if (gDnsEventQueueHandle < 0) {
+                gDnsEventQueueHandle = uPortEventQueueOpen(dnsEventHandler,
+                                                           "sockDns",
+                                                           sizeof(uSockDnsAsync_t),
+                                                           U_SOCK_DNS_TASK_STACK_SIZE_BYTES,
+                                                           U_SOCK_DNS_TASK_PRIORITY,
+                                                           U_SOCK_DNS_QUEUE_LENGTH);
             }
+            eventQueueHandle = gDnsEventQueueHandle;
 
-            U_PORT_MUTEX_UNLOCK(gMutexContainer);
+            U_PORT_MUTEX_UNLOCK(gMutexDns);
+
+            // Send outside the lock since this may block
+            // until the DNS task has room
+            if ((eventQueueHandle >= 0) &&
+                (uPortEventQueueSend(eventQueueHandle, &async,
+                                     sizeof(async)) == 0)) {
+                errnoLocal = U_SOCK_ENONE;
+            }
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        errorCode = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return errorCode;
+}
+
+// Set how long DNS look-ups are remembered for.
+int32_t uSockDnsCacheSet(uDeviceHandle_t devHandle,
+                         int32_t maxAgeSeconds,
+                         int32_t negativeMaxAgeSeconds)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+    int32_t devType;
+    uSockDnsCache_t *pCache;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = U_SOCK_EINVAL;
+        // Check parameters, keeping the ages in range
+        // of a millisecond tick count
+        devType = uDeviceGetDeviceType(devHandle);
+        if (((devType == (int32_t) U_DEVICE_TYPE_CELL) ||
+             (devType == (int32_t) U_DEVICE_TYPE_SHORT_RANGE)) &&
+            (maxAgeSeconds >= 0) && (maxAgeSeconds <= INT_MAX / 1000) &&
+            (negativeMaxAgeSeconds >= 0) && (negativeMaxAgeSeconds <= INT_MAX / 1000)) {
+
+            U_PORT_MUTEX_LOCK(gMutexDns);
+
+            errnoLocal = U_SOCK_ENOMEM;
+            pCache = pDnsCacheGet(devHandle, true);
+            if (pCache != NULL) {
+                pCache->maxAgeSeconds = maxAgeSeconds;
+                pCache->negativeMaxAgeSeconds = negativeMaxAgeSeconds;
+                errnoLocal = U_SOCK_ENONE;
+            }
+
+            U_PORT_MUTEX_UNLOCK(gMutexDns);
         }
     }
 
@@ -2807,6 +3325,66 @@ int32_t uSockGetHostByName(uDeviceHandle_t devHandle,
     return errorCode;
 }
 
+// Forget the contents of a DNS cache.
+void uSockDnsCacheFlush(uDeviceHandle_t devHandle)
+{
+    uSockDnsCache_t *pCache;
+    uSockDnsCacheEntry_t *pEntry;
+
+    if (gMutexDns != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutexDns);
+
+        for (pCache = gpDnsCacheListHead; pCache != NULL; pCache = pCache->pNext) {
+            if ((devHandle == NULL) || (pCache->devHandle == devHandle)) {
+                for (size_t x = 0; x < sizeof(pCache->entry) / sizeof(pCache->entry[0]); x++) {
+                    pEntry = &(pCache->entry[x]);
+                    if (pEntry->pending) {
+                        // Let the look-up complete, and anyone
+                        // waiting for it be told the outcome,
+                        // but don't remember it
+                        pEntry->flushed = true;
+                    } else {
+                        pEntry->hostName[0] = 0;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutexDns);
+    }
+}
+
+// Free the DNS cache of a device.
+void uSockDnsCacheFree(uDeviceHandle_t devHandle)
+{
+    uSockDnsCache_t *pCache;
+    uSockDnsCache_t *pPrevious = NULL;
+
+    if (gMutexDns != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutexDns);
+
+        pCache = gpDnsCacheListHead;
+        while ((pCache != NULL) && (pCache->devHandle != devHandle)) {
+            pPrevious = pCache;
+            pCache = pCache->pNext;
+        }
+        if (pCache != NULL) {
+            if (pPrevious != NULL) {
+                pPrevious->pNext = pCache->pNext;
+            } else {
+                gpDnsCacheListHead = pCache->pNext;
+            }
+            // Anyone waiting will find no cache and
+            // do their own look-up
+            dnsCacheFree(pCache);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutexDns);
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: ADDRESS CONVERSION
  * -------------------------------------------------------------- */
@@ -2934,6 +3512,10 @@ void uSockFree()
         uPortMutexDelete(gMutexCallbacks);
         gMutexCallbacks = NULL;
     }
+    if (gMutexDns != NULL) {
+        uPortMutexDelete(gMutexDns);
+        gMutexDns = NULL;
+    }
 }
 
 // End of file
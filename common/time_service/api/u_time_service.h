@@ -0,0 +1,334 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_TIME_SERVICE_H_
+#define _U_TIME_SERVICE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+
+/** \addtogroup time-service Time Service
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the time service, which disciplines
+ * a host clock to UTC using a pulse-per-second (PPS) signal, e.g. the
+ * time pulse output of a GNSS chip or the timing pulse of a cellular
+ * module running CellTime, and so can give UTC to a precision far
+ * better than that of any message-based time source.
+ *
+ * The edge of each pulse is timestamped with the host clock (see
+ * uPortPpsGetTimeNs()) and is paired with a report of the UTC time
+ * of that pulse; a GNSS chip sends UBX-TIM-TP, giving the time of
+ * the NEXT pulse, a cellular module sends +UUTIME, giving the time
+ * of the LAST pulse.  Each pair is a sample of the host clock against
+ * UTC which is fed into a proportional-integral servo that tracks
+ * both the offset and the drift of the host clock; uTimeServiceNowNs()
+ * then returns UTC at any moment, interpolated with the host clock.
+ *
+ * There is a single time service; the application calls
+ * uTimeServiceStart() and then either lets the service capture the
+ * pulse itself, through the port PPS API (see u_port_pps.h), or feeds
+ * it the edges with uTimeServicePpsEdge().  The reports of UTC come
+ * from uTimeServiceGnssStart(), uTimeServiceCellStart() or the
+ * application calling uTimeServicePulseTime().
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_TIME_SERVICE_KP_PER_MILLE_DEFAULT
+/** The default proportional gain of the servo in parts per
+ * thousand, used if kpPerMille in #uTimeServiceConfig_t is zero:
+ * the fraction of each measured offset that is corrected at once.
+ */
+# define U_TIME_SERVICE_KP_PER_MILLE_DEFAULT 500
+#endif
+
+#ifndef U_TIME_SERVICE_KI_PER_MILLE_DEFAULT
+/** The default integral gain of the servo in parts per thousand,
+ * used if kiPerMille in #uTimeServiceConfig_t is zero: the fraction
+ * of each measured offset that is taken into the drift estimate.
+ */
+# define U_TIME_SERVICE_KI_PER_MILLE_DEFAULT 100
+#endif
+
+#ifndef U_TIME_SERVICE_STEP_THRESHOLD_NS_DEFAULT
+/** The default step threshold in nanoseconds, used if
+ * stepThresholdNs in #uTimeServiceConfig_t is zero: if a sample
+ * is further than this from the estimate of the servo the servo
+ * is reset to that sample rather than slewed towards it.
+ */
+# define U_TIME_SERVICE_STEP_THRESHOLD_NS_DEFAULT 1000000
+#endif
+
+#ifndef U_TIME_SERVICE_LOCK_THRESHOLD_NS_DEFAULT
+/** The default lock threshold in nanoseconds, used if
+ * lockThresholdNs in #uTimeServiceConfig_t is zero: the servo is
+ * locked once #U_TIME_SERVICE_LOCK_COUNT samples in a row are within
+ * this of its estimate.
+ */
+# define U_TIME_SERVICE_LOCK_THRESHOLD_NS_DEFAULT 100000
+#endif
+
+#ifndef U_TIME_SERVICE_LOCK_COUNT
+/** The number of samples in a row that must be within the lock
+ * threshold for the servo to be locked.
+ */
+# define U_TIME_SERVICE_LOCK_COUNT 4
+#endif
+
+#ifndef U_TIME_SERVICE_PAIRING_WINDOW_MS
+/** The longest time that may separate a pulse edge and the report
+ * of its UTC time for the two to be paired: a report of the NEXT
+ * pulse must arrive no longer than this before the edge, a report
+ * of the LAST pulse no longer than this after the edge.  Should
+ * be longer than the period of the pulse, which is usually one
+ * second.
+ */
+# define U_TIME_SERVICE_PAIRING_WINDOW_MS 1200
+#endif
+
+#ifndef U_TIME_SERVICE_GNSS_LEAP_SECONDS
+/** The number of leap seconds between GPS time and UTC, used when
+ * a GNSS chip reports the time of its time pulse in GPS time
+ * rather than UTC.  Better is to configure the time pulse of the
+ * GNSS chip to be aligned to UTC, e.g. by setting the key ID
+ * U_GNSS_CFG_VAL_KEY_ID_TP_TIMEGRID_TP1_E1 to zero, since then
+ * the GNSS chip looks after leap seconds itself.
+ */
+# define U_TIME_SERVICE_GNSS_LEAP_SECONDS 18
+#endif
+
+/** The default configuration for uTimeServiceStart(): the host clock
+ * is uPortPpsGetTimeNs(), no PPS input is opened, the application
+ * calling uTimeServicePpsEdge(), and the servo uses the default gains
+ * and thresholds.
+ */
+#define U_TIME_SERVICE_CONFIG_DEFAULT {NULL, NULL, -1, -1, 0, 0, 0, 0}
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Which pulse a report of UTC time refers to.
+ */
+typedef enum {
+    U_TIME_SERVICE_PULSE_REPORT_NEXT = 0, /**< the report is of the UTC
+                                               time of the next pulse,
+                                               as for UBX-TIM-TP from a
+                                               GNSS chip. */
+    U_TIME_SERVICE_PULSE_REPORT_LAST = 1  /**< the report is of the UTC
+                                               time of the pulse that has
+                                               just occurred, as for
+                                               +UUTIME from a cellular
+                                               module. */
+} uTimeServicePulseReport_t;
+
+/** The configuration of the time service; initialise with
+ * #U_TIME_SERVICE_CONFIG_DEFAULT and then change what is needed.
+ */
+typedef struct {
+    int64_t (*pClockNs)(void); /**< the host clock to discipline, which
+                                    must be the clock of the edge
+                                    timestamps passed to
+                                    uTimeServicePpsEdge(); use NULL for
+                                    uPortPpsGetTimeNs(). */
+    const char *pPpsDevice;    /**< the PPS device to open with
+                                    uPortPpsOpen(), e.g. "/dev/pps0" on
+                                    Linux, NULL to use ppsPin; must
+                                    remain valid until uTimeServiceStop()
+                                    is called. */
+    int32_t ppsPin;            /**< the GPIO pin to capture edges on
+                                    with uPortPpsOpen(), -1 if
+                                    pPpsDevice is not NULL or if the
+                                    application will call
+                                    uTimeServicePpsEdge() itself. */
+    int32_t ppsPinIndex;       /**< the GPIO chip that ppsPin is on, -1
+                                    for the default. */
+    int32_t kpPerMille;        /**< the proportional gain of the servo,
+                                    zero for
+                                    #U_TIME_SERVICE_KP_PER_MILLE_DEFAULT. */
+    int32_t kiPerMille;        /**< the integral gain of the servo,
+                                    zero for
+                                    #U_TIME_SERVICE_KI_PER_MILLE_DEFAULT. */
+    int64_t stepThresholdNs;   /**< the step threshold, zero for
+                                    #U_TIME_SERVICE_STEP_THRESHOLD_NS_DEFAULT. */
+    int64_t lockThresholdNs;   /**< the lock threshold, zero for
+                                    #U_TIME_SERVICE_LOCK_THRESHOLD_NS_DEFAULT. */
+} uTimeServiceConfig_t;
+
+/** Statistics of the time service, see uTimeServiceGetStats().
+ */
+typedef struct {
+    bool locked;            /**< true if the servo is locked. */
+    size_t edges;           /**< the number of pulse edges received. */
+    size_t reports;         /**< the number of reports of UTC time
+                                 received. */
+    size_t samples;         /**< the number of samples fed to the servo,
+                                 i.e. of edges that were paired with a
+                                 report, plus any passed to
+                                 uTimeServiceSample(). */
+    size_t unpaired;        /**< the number of edges and reports that
+                                 could not be paired. */
+    size_t steps;           /**< the number of times the servo has
+                                 been reset to a sample, including
+                                 the first. */
+    int64_t offsetNs;       /**< the offset of the last sample from the
+                                 estimate of the servo, i.e. the error
+                                 of uTimeServiceNowNs() at that moment. */
+    int32_t driftPpb;       /**< the estimated rate of the host clock
+                                 relative to UTC in parts per billion,
+                                 positive if the host clock is slow. */
+    int64_t jitterNs;       /**< a running average of the magnitude of
+                                 offsetNs. */
+    int32_t convergenceMs;  /**< the host time from the last step of the
+                                 servo to lock, -1 if not locked. */
+} uTimeServiceStats_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Start the time service.  If the configuration has a PPS device
+ * or pin then the edges of the pulse are captured with uPortPpsOpen().
+ * If the time service is already running it is restarted.
+ *
+ * @param[in] pConfig  the configuration, NULL for
+ *                     #U_TIME_SERVICE_CONFIG_DEFAULT.
+ * @return             zero on success else negative error code.
+ */
+int32_t uTimeServiceStart(const uTimeServiceConfig_t *pConfig);
+
+/** Stop the time service, including any PPS capture and any GNSS
+ * or cellular reporting started with uTimeServiceGnssStart() or
+ * uTimeServiceCellStart().  Must not be called at the same time as
+ * any other time service function.
+ */
+void uTimeServiceStop(void);
+
+/** Report the edge of a pulse; use this if the application captures
+ * the edges itself, rather than the time service capturing them
+ * through the port PPS API.  Must be called from task context,
+ * not from an interrupt.
+ *
+ * @param hostNs  the time of the edge according to the host clock.
+ * @return        zero on success else negative error code.
+ */
+int32_t uTimeServicePpsEdge(int64_t hostNs);
+
+/** Report the UTC time of a pulse; use this if the application
+ * obtains the time of the pulses itself, rather than through
+ * uTimeServiceGnssStart() or uTimeServiceCellStart().
+ *
+ * @param utcNs   the UTC time of the pulse in nanoseconds since
+ *                midnight on 1st January 1970.
+ * @param report  which pulse utcNs is the time of.
+ * @return        zero on success else negative error code.
+ */
+int32_t uTimeServicePulseTime(int64_t utcNs,
+                              uTimeServicePulseReport_t report);
+
+/** Feed a sample that is already paired directly to the servo,
+ * e.g. from a timing source that timestamps its own pulses.
+ *
+ * @param hostNs  the time of the sample according to the host clock.
+ * @param utcNs   the UTC time of the sample in nanoseconds since
+ *                midnight on 1st January 1970.
+ * @return        zero on success else negative error code.
+ */
+int32_t uTimeServiceSample(int64_t hostNs, int64_t utcNs);
+
+/** Convert a time of the host clock to UTC, e.g. to timestamp an
+ * event that was captured with the host clock.
+ *
+ * @param hostNs  the time according to the host clock.
+ * @return        the UTC time in nanoseconds since midnight on 1st
+ *                January 1970, else negative error code, e.g. if
+ *                the time service has had no samples yet.
+ */
+int64_t uTimeServiceHostToUtcNs(int64_t hostNs);
+
+/** Get UTC now; check the locked field of #uTimeServiceStats_t
+ * to find out whether this is to be trusted.
+ *
+ * @return the UTC time in nanoseconds since midnight on 1st January
+ *         1970, else negative error code, e.g. if the time service
+ *         has had no samples yet.
+ */
+int64_t uTimeServiceNowNs(void);
+
+/** Get the statistics of the time service.
+ *
+ * @param[out] pStats  a place to put the statistics; cannot be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uTimeServiceGetStats(uTimeServiceStats_t *pStats);
+
+/** Take the UTC time of each pulse from the UBX-TIM-TP messages of
+ * a GNSS chip, which must be configured to emit them (e.g. with
+ * the key ID U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_TIM_TP_X_U1 where X is
+ * the interface); the time pulse output of the GNSS chip is the
+ * PPS input.  Only one GNSS device may be used at a time and the
+ * transport must be a streaming one (UART, I2C, SPI, Virtual
+ * Serial).
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @return            zero on success else negative error code.
+ */
+int32_t uTimeServiceGnssStart(uDeviceHandle_t gnssHandle);
+
+/** Stop taking the time of the pulses from a GNSS chip.
+ */
+void uTimeServiceGnssStop(void);
+
+/** Take the UTC time of each pulse from the +UUTIME indications of
+ * a cellular module; the application must set CellTime going with
+ * uCellTimeEnable() and the timing pulse output of the cellular
+ * module is the PPS input.  This replaces any callback set with
+ * uCellTimeSetCallback().  Note that if CellTime is synchronised
+ * to the cellular network, rather than to GNSS, its time is relative
+ * (see #uCellTime_t) and the offset passed to uCellTimeEnable() must
+ * be used to align it with UTC.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            zero on success else negative error code.
+ */
+int32_t uTimeServiceCellStart(uDeviceHandle_t cellHandle);
+
+/** Stop taking the time of the pulses from a cellular module.
+ */
+void uTimeServiceCellStop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_TIME_SERVICE_H_
+
+// End of file
@@ -0,0 +1,463 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the time service: pairing of pulse edges
+ * with reports of their UTC time and the servo that disciplines the
+ * host clock.
+ *
+ * The servo keeps an anchor, a host time and the UTC time that goes
+ * with it, plus the rate of UTC relative to the host clock in parts
+ * per trillion; UTC at any host time is the anchor UTC plus the host
+ * time elapsed since the anchor, corrected by the rate.  The first
+ * sample (or the first after a step) sets the anchor, the second
+ * gives a first estimate of the rate and from then on each sample
+ * is compared with the estimate: a proportional part of the error
+ * is applied to the anchor at once while an integral part is taken
+ * into the rate.  All of the arithmetic is 64-bit integer so that no
+ * floating point is required.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_pps.h"
+
+#include "u_time_service.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The weight of the newest sample in the running average of the
+ * magnitude of the offset, as a divisor.
+ */
+#define U_TIME_SERVICE_JITTER_AVERAGE_DIVISOR 8
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The state of the time service.
+ */
+typedef struct {
+    int64_t (*pClockNs)(void);
+    int32_t ppsHandle;         /**< the handle of the PPS input, -1 if
+                                    there is none. */
+    int32_t kpPerMille;
+    int32_t kiPerMille;
+    int64_t stepThresholdNs;
+    int64_t lockThresholdNs;
+    // The servo
+    size_t samplesSinceStep;   /**< zero if there is no anchor. */
+    int64_t anchorHostNs;
+    int64_t anchorUtcNs;
+    int64_t ratePpt;           /**< the rate of UTC relative to the host
+                                    clock, minus one, in parts per
+                                    trillion. */
+    int64_t stepHostNs;        /**< the host time of the last step. */
+    size_t inLockCount;        /**< the number of samples in a row
+                                    within the lock threshold. */
+    // Pairing
+    bool edgePending;          /**< true if edgeHostNs has yet to be
+                                    paired with a report. */
+    int64_t edgeHostNs;
+    bool reportNextPending;    /**< true if a report of the next pulse
+                                    has yet to be paired with an edge. */
+    int64_t reportNextUtcNs;
+    int64_t reportNextHostNs;  /**< when the report arrived. */
+    uTimeServiceStats_t stats;
+} uTimeServiceContext_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Mutex to protect the time service, NULL if the time service
+ * is not running.
+ */
+static uPortMutexHandle_t gMutex = NULL;
+
+/** The state of the time service.
+ */
+static uTimeServiceContext_t gContext;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Return the magnitude of a value.
+static int64_t magnitude(int64_t value)
+{
+    return (value < 0) ? -value : value;
+}
+
+// Return the correction in nanoseconds for a host time interval
+// at a rate in parts per trillion; the interval is split so that
+// hours between samples cannot cause an overflow.
+static int64_t rateCorrection(int64_t intervalNs, int64_t ratePpt)
+{
+    return (((intervalNs / 1000000) * ratePpt) / 1000000) +
+           (((intervalNs % 1000000) * ratePpt) / 1000000000000LL);
+}
+
+// Estimate UTC at a host time; gMutex must be locked and there
+// must be an anchor.
+static int64_t estimate(const uTimeServiceContext_t *pContext, int64_t hostNs)
+{
+    int64_t intervalNs = hostNs - pContext->anchorHostNs;
+
+    return pContext->anchorUtcNs + intervalNs +
+           rateCorrection(intervalNs, pContext->ratePpt);
+}
+
+// Reset the servo to a sample, keeping the rate; gMutex must
+// be locked.
+static void step(uTimeServiceContext_t *pContext,
+                 int64_t hostNs, int64_t utcNs)
+{
+    pContext->anchorHostNs = hostNs;
+    pContext->anchorUtcNs = utcNs;
+    pContext->samplesSinceStep = 1;
+    pContext->stepHostNs = hostNs;
+    pContext->inLockCount = 0;
+    pContext->stats.steps++;
+    pContext->stats.locked = false;
+    pContext->stats.convergenceMs = -1;
+}
+
+// Feed a sample to the servo; gMutex must be locked.
+static int32_t sample(uTimeServiceContext_t *pContext,
+                      int64_t hostNs, int64_t utcNs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uTimeServiceStats_t *pStats = &(pContext->stats);
+    int64_t intervalNs = hostNs - pContext->anchorHostNs;
+    int64_t predictedNs;
+    int64_t errorNs;
+    int64_t ratePpt;
+
+    if (pContext->samplesSinceStep == 0) {
+        step(pContext, hostNs, utcNs);
+        pStats->samples++;
+    } else if (intervalNs < 1000) {
+        // Not after the anchor: a stale or repeated sample
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    } else {
+        pStats->samples++;
+        predictedNs = estimate(pContext, hostNs);
+        errorNs = utcNs - predictedNs;
+        pStats->offsetNs = errorNs;
+        if (magnitude(errorNs) > pContext->stepThresholdNs) {
+            step(pContext, hostNs, utcNs);
+        } else {
+            // The rate error over the interval in parts per trillion;
+            // the interval in microseconds keeps this within 64 bits
+            ratePpt = (errorNs * 1000000000) / (intervalNs / 1000);
+            if (pContext->samplesSinceStep == 1) {
+                // Two samples give a first estimate of the rate
+                pContext->ratePpt += ratePpt;
+                pContext->anchorUtcNs = utcNs;
+            } else {
+                pContext->ratePpt += (ratePpt * pContext->kiPerMille) / 1000;
+                pContext->anchorUtcNs = predictedNs +
+                                        ((errorNs * pContext->kpPerMille) / 1000);
+            }
+            pContext->anchorHostNs = hostNs;
+            pContext->samplesSinceStep++;
+            pStats->jitterNs += (magnitude(errorNs) - pStats->jitterNs) /
+                                U_TIME_SERVICE_JITTER_AVERAGE_DIVISOR;
+            if (magnitude(errorNs) <= pContext->lockThresholdNs) {
+                pContext->inLockCount++;
+                if (!pStats->locked &&
+                    (pContext->inLockCount >= U_TIME_SERVICE_LOCK_COUNT)) {
+                    pStats->locked = true;
+                    pStats->convergenceMs = (int32_t) ((hostNs - pContext->stepHostNs) /
+                                                       1000000);
+                }
+            } else {
+                pContext->inLockCount = 0;
+            }
+        }
+        pStats->driftPpb = (int32_t) (pContext->ratePpt / 1000);
+    }
+
+    return errorCode;
+}
+
+// Callback for the edges captured by the port PPS API.
+static void ppsCallback(int32_t ppsHandle, int64_t timestampNs,
+                        void *pCallbackParam)
+{
+    (void) ppsHandle;
+    (void) pCallbackParam;
+
+    uTimeServicePpsEdge(timestampNs);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Start the time service.
+int32_t uTimeServiceStart(const uTimeServiceConfig_t *pConfig)
+{
+    int32_t errorCode;
+    uTimeServiceConfig_t config = U_TIME_SERVICE_CONFIG_DEFAULT;
+    int32_t ppsHandle = -1;
+
+    if (pConfig != NULL) {
+        config = *pConfig;
+    }
+
+    uTimeServiceStop();
+
+    errorCode = uPortMutexCreate(&gMutex);
+    if (errorCode == 0) {
+        memset(&gContext, 0, sizeof(gContext));
+        gContext.pClockNs = config.pClockNs;
+        if (gContext.pClockNs == NULL) {
+            gContext.pClockNs = uPortPpsGetTimeNs;
+        }
+        gContext.ppsHandle = -1;
+        gContext.kpPerMille = config.kpPerMille;
+        if (gContext.kpPerMille <= 0) {
+            gContext.kpPerMille = U_TIME_SERVICE_KP_PER_MILLE_DEFAULT;
+        }
+        gContext.kiPerMille = config.kiPerMille;
+        if (gContext.kiPerMille <= 0) {
+            gContext.kiPerMille = U_TIME_SERVICE_KI_PER_MILLE_DEFAULT;
+        }
+        gContext.stepThresholdNs = config.stepThresholdNs;
+        if (gContext.stepThresholdNs <= 0) {
+            gContext.stepThresholdNs = U_TIME_SERVICE_STEP_THRESHOLD_NS_DEFAULT;
+        }
+        gContext.lockThresholdNs = config.lockThresholdNs;
+        if (gContext.lockThresholdNs <= 0) {
+            gContext.lockThresholdNs = U_TIME_SERVICE_LOCK_THRESHOLD_NS_DEFAULT;
+        }
+        gContext.stats.convergenceMs = -1;
+        if ((config.pPpsDevice != NULL) || (config.ppsPin >= 0)) {
+            // Not holding the mutex: ppsCallback() may be called
+            // before uPortPpsOpen() has returned
+            ppsHandle = uPortPpsOpen(config.pPpsDevice, config.ppsPin,
+                                     config.ppsPinIndex, ppsCallback, NULL);
+            if (ppsHandle >= 0) {
+                U_PORT_MUTEX_LOCK(gMutex);
+                gContext.ppsHandle = ppsHandle;
+                U_PORT_MUTEX_UNLOCK(gMutex);
+            } else {
+                errorCode = ppsHandle;
+                uPortMutexDelete(gMutex);
+                gMutex = NULL;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Stop the time service.
+void uTimeServiceStop()
+{
+    int32_t ppsHandle;
+
+    if (gMutex != NULL) {
+        // Stop everything that might call in before deleting the
+        // mutex; none of this can be done with the mutex locked as
+        // the callbacks concerned may be waiting on it
+        uTimeServiceGnssStop();
+        uTimeServiceCellStop();
+        U_PORT_MUTEX_LOCK(gMutex);
+        ppsHandle = gContext.ppsHandle;
+        gContext.ppsHandle = -1;
+        U_PORT_MUTEX_UNLOCK(gMutex);
+        if (ppsHandle >= 0) {
+            uPortPpsClose(ppsHandle);
+        }
+        uPortMutexDelete(gMutex);
+        gMutex = NULL;
+    }
+}
+
+// Report the edge of a pulse.
+int32_t uTimeServicePpsEdge(int64_t hostNs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        gContext.stats.edges++;
+        if (gContext.reportNextPending && (hostNs >= gContext.reportNextHostNs) &&
+            (hostNs - gContext.reportNextHostNs > U_TIME_SERVICE_PAIRING_WINDOW_MS * 1000000LL)) {
+            // Too old to be for this pulse
+            gContext.stats.unpaired++;
+            gContext.reportNextPending = false;
+        }
+        if (gContext.reportNextPending && (hostNs >= gContext.reportNextHostNs)) {
+            // The report of this pulse arrived before it
+            errorCode = sample(&gContext, hostNs, gContext.reportNextUtcNs);
+            gContext.reportNextPending = false;
+        } else {
+            // Either no report has arrived yet or the one that has
+            // arrived is for a later pulse (e.g. the edge was delivered
+            // late): wait for a report of the last pulse
+            if (gContext.edgePending) {
+                gContext.stats.unpaired++;
+            }
+            gContext.edgePending = true;
+            gContext.edgeHostNs = hostNs;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Report the UTC time of a pulse.
+int32_t uTimeServicePulseTime(int64_t utcNs,
+                              uTimeServicePulseReport_t report)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    int64_t nowNs;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        gContext.stats.reports++;
+        nowNs = gContext.pClockNs();
+        if (report == U_TIME_SERVICE_PULSE_REPORT_NEXT) {
+            if (gContext.reportNextPending) {
+                gContext.stats.unpaired++;
+            }
+            gContext.reportNextPending = true;
+            gContext.reportNextUtcNs = utcNs;
+            gContext.reportNextHostNs = nowNs;
+        } else if (gContext.edgePending &&
+                   (nowNs - gContext.edgeHostNs <= U_TIME_SERVICE_PAIRING_WINDOW_MS * 1000000LL)) {
+            errorCode = sample(&gContext, gContext.edgeHostNs, utcNs);
+            gContext.edgePending = false;
+        } else {
+            gContext.stats.unpaired++;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Feed a sample to the servo.
+int32_t uTimeServiceSample(int64_t hostNs, int64_t utcNs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = sample(&gContext, hostNs, utcNs);
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Convert a host time to UTC.
+int64_t uTimeServiceHostToUtcNs(int64_t hostNs)
+{
+    int64_t errorCodeOrUtcNs = (int64_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCodeOrUtcNs = (int64_t) U_ERROR_COMMON_EMPTY;
+        if (gContext.samplesSinceStep > 0) {
+            errorCodeOrUtcNs = estimate(&gContext, hostNs);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCodeOrUtcNs;
+}
+
+// Get UTC now.
+int64_t uTimeServiceNowNs()
+{
+    int64_t errorCodeOrUtcNs = (int64_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCodeOrUtcNs = (int64_t) U_ERROR_COMMON_EMPTY;
+        if (gContext.samplesSinceStep > 0) {
+            errorCodeOrUtcNs = estimate(&gContext, gContext.pClockNs());
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCodeOrUtcNs;
+}
+
+// Get the statistics of the time service.
+int32_t uTimeServiceGetStats(uTimeServiceStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pStats != NULL) {
+            *pStats = gContext.stats;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// End of file
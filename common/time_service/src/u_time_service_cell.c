@@ -0,0 +1,113 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the cellular part of the time service:
+ * the UTC time of each timing pulse is taken from +UUTIME.  If
+ * cellular is not included in the build the functions of the
+ * cellular API used here are provided by u_time_service_stub_cell.c.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_error_common.h"
+
+#include "u_device.h"
+#include "u_at_client.h"
+#include "u_cell_module_type.h"
+#include "u_cell.h"
+#include "u_cell_net.h"     // Required by u_cell_time.h
+#include "u_cell_time.h"
+
+#include "u_time_service.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The cellular device that +UUTIME is being received from, NULL
+ * if there is none.
+ */
+static uDeviceHandle_t gCellHandle = NULL;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Callback for +UUTIME, which gives the time of the timing pulse
+// that has just been emitted.
+static void timeCallback(uDeviceHandle_t cellHandle, uCellTime_t *pTime,
+                         void *pCallbackParameter)
+{
+    (void) cellHandle;
+    (void) pCallbackParameter;
+
+    if ((pTime != NULL) && (pTime->timeNanoseconds >= 0)) {
+        uTimeServicePulseTime(pTime->timeNanoseconds,
+                              U_TIME_SERVICE_PULSE_REPORT_LAST);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Take the time of the pulses from +UUTIME.
+int32_t uTimeServiceCellStart(uDeviceHandle_t cellHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (cellHandle != NULL) {
+        uTimeServiceCellStop();
+        errorCode = uCellTimeSetCallback(cellHandle, timeCallback, NULL);
+        if (errorCode == 0) {
+            gCellHandle = cellHandle;
+        }
+    }
+
+    return errorCode;
+}
+
+// Stop taking the time of the pulses from +UUTIME.
+void uTimeServiceCellStop()
+{
+    if (gCellHandle != NULL) {
+        uCellTimeSetCallback(gCellHandle, NULL, NULL);
+        gCellHandle = NULL;
+    }
+}
+
+// End of file
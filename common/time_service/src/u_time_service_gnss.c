@@ -0,0 +1,182 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the GNSS part of the time service: the
+ * UTC time of each time pulse is taken from UBX-TIM-TP.  If GNSS is
+ * not included in the build the functions of the GNSS API used here
+ * are provided by u_time_service_stub_gnss.c.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_error_common.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_device.h"
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss_msg.h"
+#include "u_gnss_dec.h"
+
+#include "u_time_service.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The GPS epoch, midnight on 6th January 1980, as Unix time.
+ */
+#define U_TIME_SERVICE_GPS_EPOCH_UNIX_SECONDS 315964800LL
+
+/** The number of seconds in a week.
+ */
+#define U_TIME_SERVICE_SECONDS_PER_WEEK 604800LL
+
+/** The mask for the GNSS time reference in the refInfo field of
+ * #uGnssDecUbxTimTp_t.
+ */
+#define U_TIME_SERVICE_TIM_TP_REF_INFO_GNSS_MASK 0x0f
+
+/** The value of the GNSS time reference in the refInfo field of
+ * #uGnssDecUbxTimTp_t for GPS time.
+ */
+#define U_TIME_SERVICE_TIM_TP_REF_INFO_GNSS_GPS 0
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The GNSS device that UBX-TIM-TP is being received from, NULL
+ * if there is none.
+ */
+static uDeviceHandle_t gGnssHandle = NULL;
+
+/** The handle returned by uGnssMsgReceiveStart().
+ */
+static int32_t gAsyncHandle = -1;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Convert UBX-TIM-TP to the UTC time of the next time pulse,
+// returning a negative error code if the time base is a GNSS
+// other than GPS, for which this code knows no offset.
+static int64_t timTpToUtcNs(const uGnssDecUbxTimTp_t *pTimTp)
+{
+    int64_t errorCodeOrUtcNs = (int64_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    int64_t seconds = U_TIME_SERVICE_GPS_EPOCH_UNIX_SECONDS +
+                      (pTimTp->week * U_TIME_SERVICE_SECONDS_PER_WEEK);
+    bool utc = ((pTimTp->flags & (1 << U_GNSS_DEC_UBX_TIM_TP_FLAGS_TIME_BASE)) != 0);
+
+    if (utc || ((pTimTp->refInfo & U_TIME_SERVICE_TIM_TP_REF_INFO_GNSS_MASK) ==
+                U_TIME_SERVICE_TIM_TP_REF_INFO_GNSS_GPS)) {
+        if (!utc) {
+            seconds -= U_TIME_SERVICE_GNSS_LEAP_SECONDS;
+        }
+        // towSubMS is in units of 2^-32 milliseconds
+        errorCodeOrUtcNs = (seconds * 1000000000) +
+                           (((int64_t) pTimTp->towMS) * 1000000) +
+                           ((((int64_t) pTimTp->towSubMS) * 1000000) >> 32);
+    }
+
+    return errorCodeOrUtcNs;
+}
+
+// The message receive callback for UBX-TIM-TP.
+static void messageCallback(uDeviceHandle_t gnssHandle,
+                            const uGnssMessageId_t *pMessageId,
+                            int32_t errorCodeOrLength,
+                            void *pCallbackParam)
+{
+    char buffer[U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES + U_GNSS_DEC_UBX_TIM_TP_BODY_MIN_LENGTH];
+    uGnssDecUnion_t body;
+    int32_t length;
+    int64_t utcNs;
+
+    (void) pMessageId;
+    (void) pCallbackParam;
+
+    if (errorCodeOrLength == (int32_t) sizeof(buffer)) {
+        length = uGnssMsgReceiveCallbackRead(gnssHandle, buffer, sizeof(buffer));
+        if ((length == (int32_t) sizeof(buffer)) &&
+            (uGnssDecUbx(buffer, length, &body, sizeof(body)) ==
+             U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_TIM_TP_MESSAGE_CLASS,
+                                U_GNSS_DEC_UBX_TIM_TP_MESSAGE_ID))) {
+            utcNs = timTpToUtcNs(&(body.ubxTimTp));
+            if (utcNs >= 0) {
+                uTimeServicePulseTime(utcNs, U_TIME_SERVICE_PULSE_REPORT_NEXT);
+            }
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Take the time of the pulses from UBX-TIM-TP.
+int32_t uTimeServiceGnssStart(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssMessageId_t messageId = {.type = U_GNSS_PROTOCOL_UBX,
+                                  .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_TIM_TP_MESSAGE_CLASS,
+                                                               U_GNSS_DEC_UBX_TIM_TP_MESSAGE_ID)
+                                 };
+
+    if (gnssHandle != NULL) {
+        uTimeServiceGnssStop();
+        errorCodeOrHandle = uGnssMsgReceiveStart(gnssHandle, &messageId,
+                                                 messageCallback, NULL);
+        if (errorCodeOrHandle >= 0) {
+            gGnssHandle = gnssHandle;
+            gAsyncHandle = errorCodeOrHandle;
+            errorCodeOrHandle = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCodeOrHandle;
+}
+
+// Stop taking the time of the pulses from UBX-TIM-TP.
+void uTimeServiceGnssStop()
+{
+    if (gGnssHandle != NULL) {
+        uGnssMsgReceiveStop(gGnssHandle, gAsyncHandle);
+        gGnssHandle = NULL;
+        gAsyncHandle = -1;
+    }
+}
+
+// End of file
@@ -0,0 +1,383 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the time service.  No hardware is required: the
+ * host clock is simulated, as is a pulse-per-second signal from a
+ * host clock that drifts against UTC, with jitter injected into the
+ * timestamp of each edge, and the tests measure how long the servo
+ * takes to lock and how far it is from the truth once it has.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_time_service.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The base string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX_BASE "U_TIME_SERVICE_TEST"
+
+/** The string to put at the start of all prints from this test
+ * that do not require an iteration on the end.
+ */
+#define U_TEST_PREFIX U_TEST_PREFIX_BASE ": "
+
+/** Print a whole line, with terminator, prefixed for this test
+ * file, no iteration version.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The number of pulses to simulate.
+ */
+#define U_TIME_SERVICE_TEST_NUM_PULSES 120
+
+/** The number of pulses at the end of the simulation over which
+ * the steady-state error is measured.
+ */
+#define U_TIME_SERVICE_TEST_NUM_PULSES_STEADY_STATE 60
+
+/** The maximum jitter, either way, injected into the timestamp of
+ * each edge: typical of a GPIO interrupt on a Linux host.
+ */
+#define U_TIME_SERVICE_TEST_JITTER_NS 2000
+
+/** The time the simulated servo must lock within.
+ */
+#define U_TIME_SERVICE_TEST_CONVERGENCE_MAX_MS 20000
+
+/** The largest error allowed in the steady state.
+ */
+#define U_TIME_SERVICE_TEST_STEADY_STATE_ERROR_MAX_NS (U_TIME_SERVICE_TEST_JITTER_NS * 3)
+
+/** The largest error allowed in the drift estimate in the steady
+ * state, in parts per billion.
+ */
+#define U_TIME_SERVICE_TEST_DRIFT_ERROR_MAX_PPB 500
+
+/** UTC at the start of the simulation: some time in 2024.
+ */
+#define U_TIME_SERVICE_TEST_UTC_START_NS 1718000000000000000LL
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A simulated host clock.
+ */
+typedef struct {
+    int64_t startNs;  /**< the host time at the start of the simulation. */
+    int64_t driftPpt; /**< the rate of UTC relative to the host clock,
+                           minus one, in parts per trillion. */
+} uTimeServiceTestHost_t;
+
+/** The outcome of a simulation.
+ */
+typedef struct {
+    int64_t errorMaxNs; /**< the largest error in the steady state. */
+    int64_t errorSumNs; /**< the sum of the magnitudes of the errors
+                             in the steady state. */
+    uTimeServiceStats_t stats;
+} uTimeServiceTestResult_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The current time of the simulated host clock.
+ */
+static int64_t gHostNowNs = 0;
+
+/** The state of the pseudo-random number generator.
+ */
+static uint32_t gRandom = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// The simulated host clock.
+static int64_t hostClockNs(void)
+{
+    return gHostNowNs;
+}
+
+// Return a pseudo-random number in the range -range to +range;
+// deterministic so that a failure can be reproduced.
+static int32_t randomPlusMinus(int32_t range)
+{
+    gRandom = (gRandom * 1103515245UL) + 12345;
+    return (int32_t) ((gRandom >> 8) % ((uint32_t) (range * 2) + 1)) - range;
+}
+
+// Return the true UTC time at a host time.
+static int64_t utcTrueNs(const uTimeServiceTestHost_t *pHost, int64_t hostNs)
+{
+    int64_t elapsedNs = hostNs - pHost->startNs;
+
+    return U_TIME_SERVICE_TEST_UTC_START_NS + elapsedNs +
+           (((elapsedNs / 1000) * pHost->driftPpt) / 1000000000);
+}
+
+// Run a simulation: each second there is a pulse, timestamped by
+// the host with jitter, and a report of the UTC time of the pulse,
+// arriving reportDelayMs before the pulse for a report of the next
+// pulse or reportDelayMs after the pulse for a report of the last
+// pulse.  Between pulses the error of uTimeServiceNowNs() is
+// measured against the truth.
+static void simulate(const uTimeServiceTestHost_t *pHost,
+                     uTimeServicePulseReport_t report,
+                     int32_t reportDelayMs,
+                     uTimeServiceTestResult_t *pResult)
+{
+    int64_t pulseHostNs;
+    int64_t errorNs;
+
+    pResult->errorMaxNs = 0;
+    pResult->errorSumNs = 0;
+    for (size_t x = 0; x < U_TIME_SERVICE_TEST_NUM_PULSES; x++) {
+        pulseHostNs = pHost->startNs + (((int64_t) x + 1) * 1000000000);
+        if (report == U_TIME_SERVICE_PULSE_REPORT_NEXT) {
+            gHostNowNs = pulseHostNs - (reportDelayMs * 1000000LL);
+            U_PORT_TEST_ASSERT(uTimeServicePulseTime(utcTrueNs(pHost, pulseHostNs),
+                                                     report) == 0);
+        }
+        // The edge is delivered shortly after it occurred
+        gHostNowNs = pulseHostNs + 50000;
+        U_PORT_TEST_ASSERT(uTimeServicePpsEdge(pulseHostNs +
+                                               randomPlusMinus(U_TIME_SERVICE_TEST_JITTER_NS)) == 0);
+        if (report == U_TIME_SERVICE_PULSE_REPORT_LAST) {
+            gHostNowNs = pulseHostNs + (reportDelayMs * 1000000LL);
+            U_PORT_TEST_ASSERT(uTimeServicePulseTime(utcTrueNs(pHost, pulseHostNs),
+                                                     report) == 0);
+        }
+        // Measure the error at some moment before the next pulse
+        gHostNowNs = pulseHostNs + 300000000 + (randomPlusMinus(200000) * 1000LL);
+        errorNs = uTimeServiceNowNs() - utcTrueNs(pHost, gHostNowNs);
+        if (errorNs < 0) {
+            errorNs = -errorNs;
+        }
+        if (x >= U_TIME_SERVICE_TEST_NUM_PULSES - U_TIME_SERVICE_TEST_NUM_PULSES_STEADY_STATE) {
+            pResult->errorSumNs += errorNs;
+            if (errorNs > pResult->errorMaxNs) {
+                pResult->errorMaxNs = errorNs;
+            }
+        }
+    }
+    U_PORT_TEST_ASSERT(uTimeServiceGetStats(&(pResult->stats)) == 0);
+}
+
+// Print and check the outcome of a simulation.
+static void checkResult(const uTimeServiceTestHost_t *pHost,
+                        const uTimeServiceTestResult_t *pResult)
+{
+    const uTimeServiceStats_t *pStats = &(pResult->stats);
+    int32_t driftErrorPpb = pStats->driftPpb - (int32_t) (pHost->driftPpt / 1000);
+
+    U_TEST_PRINT_LINE("%d edge(s), %d report(s), %d sample(s), %d unpaired,"
+                      " %d step(s).", (int32_t) pStats->edges,
+                      (int32_t) pStats->reports, (int32_t) pStats->samples,
+                      (int32_t) pStats->unpaired, (int32_t) pStats->steps);
+    U_TEST_PRINT_LINE("locked %s after %d ms, drift %d ppb (truth %d ppb),"
+                      " jitter %d ns.", pStats->locked ? "true" : "false",
+                      pStats->convergenceMs, pStats->driftPpb,
+                      (int32_t) (pHost->driftPpt / 1000),
+                      (int32_t) pStats->jitterNs);
+    U_TEST_PRINT_LINE("steady-state error over %d second(s): average %d ns,"
+                      " worst case %d ns (injected jitter +/-%d ns).",
+                      U_TIME_SERVICE_TEST_NUM_PULSES_STEADY_STATE,
+                      (int32_t) (pResult->errorSumNs / U_TIME_SERVICE_TEST_NUM_PULSES_STEADY_STATE),
+                      (int32_t) pResult->errorMaxNs, U_TIME_SERVICE_TEST_JITTER_NS);
+    U_PORT_TEST_ASSERT(pStats->locked);
+    U_PORT_TEST_ASSERT(pStats->convergenceMs >= 0);
+    U_PORT_TEST_ASSERT(pStats->convergenceMs <= U_TIME_SERVICE_TEST_CONVERGENCE_MAX_MS);
+    U_PORT_TEST_ASSERT(pResult->errorMaxNs <= U_TIME_SERVICE_TEST_STEADY_STATE_ERROR_MAX_NS);
+    U_PORT_TEST_ASSERT((driftErrorPpb <= U_TIME_SERVICE_TEST_DRIFT_ERROR_MAX_PPB) &&
+                       (driftErrorPpb >= -U_TIME_SERVICE_TEST_DRIFT_ERROR_MAX_PPB));
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test the servo with reports of the next pulse, as from
+ * UBX-TIM-TP, and then check that a mis-paired sample steps the
+ * servo, after which it locks again.
+ */
+U_PORT_TEST_FUNCTION("[timeService]", "timeServiceNext")
+{
+    int32_t resourceCount;
+    uTimeServiceConfig_t config = U_TIME_SERVICE_CONFIG_DEFAULT;
+    uTimeServiceTestHost_t host = {.startNs = 5000000000LL, .driftPpt = 37000000};
+    uTimeServiceTestResult_t result;
+    uTimeServiceStats_t stats;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Nothing works before the time service is started
+    U_PORT_TEST_ASSERT(uTimeServicePpsEdge(0) == (int32_t) U_ERROR_COMMON_NOT_INITIALISED);
+    U_PORT_TEST_ASSERT(uTimeServiceNowNs() == (int64_t) U_ERROR_COMMON_NOT_INITIALISED);
+    U_PORT_TEST_ASSERT(uTimeServiceGetStats(&stats) == (int32_t) U_ERROR_COMMON_NOT_INITIALISED);
+
+    gRandom = 1;
+    gHostNowNs = host.startNs;
+    config.pClockNs = hostClockNs;
+    U_PORT_TEST_ASSERT(uTimeServiceStart(&config) == 0);
+    U_PORT_TEST_ASSERT(uTimeServiceNowNs() == (int64_t) U_ERROR_COMMON_EMPTY);
+    U_PORT_TEST_ASSERT(uTimeServiceGetStats(&stats) == 0);
+    U_PORT_TEST_ASSERT(!stats.locked);
+    U_PORT_TEST_ASSERT(stats.convergenceMs < 0);
+    U_PORT_TEST_ASSERT(uTimeServiceGnssStart(NULL) < 0);
+    U_PORT_TEST_ASSERT(uTimeServiceCellStart(NULL) < 0);
+
+    U_TEST_PRINT_LINE("host clock %d ppb slow, report of the next pulse"
+                      " 900 ms before it.", (int32_t) (host.driftPpt / 1000));
+    simulate(&host, U_TIME_SERVICE_PULSE_REPORT_NEXT, 900, &result);
+    checkResult(&host, &result);
+    U_PORT_TEST_ASSERT(result.stats.edges == U_TIME_SERVICE_TEST_NUM_PULSES);
+    U_PORT_TEST_ASSERT(result.stats.reports == U_TIME_SERVICE_TEST_NUM_PULSES);
+    U_PORT_TEST_ASSERT(result.stats.samples == U_TIME_SERVICE_TEST_NUM_PULSES);
+    U_PORT_TEST_ASSERT(result.stats.unpaired == 0);
+    U_PORT_TEST_ASSERT(result.stats.steps == 1);
+
+    // A sample a whole second out, as if an edge had been
+    // paired with the wrong report, steps the servo
+    gHostNowNs += 1000000000;
+    U_PORT_TEST_ASSERT(uTimeServiceSample(gHostNowNs,
+                                          utcTrueNs(&host, gHostNowNs) + 1000000000) == 0);
+    U_PORT_TEST_ASSERT(uTimeServiceGetStats(&stats) == 0);
+    U_PORT_TEST_ASSERT(!stats.locked);
+    U_PORT_TEST_ASSERT(stats.steps == 2);
+    // A report with no edge is unpaired
+    U_PORT_TEST_ASSERT(uTimeServicePulseTime(0, U_TIME_SERVICE_PULSE_REPORT_LAST) == 0);
+    U_PORT_TEST_ASSERT(uTimeServiceGetStats(&stats) == 0);
+    U_PORT_TEST_ASSERT(stats.unpaired == 1);
+
+    // Carry on from there: the servo must come back
+    U_TEST_PRINT_LINE("after a step of one second.");
+    host.startNs = gHostNowNs;
+    host.driftPpt = 37000000;
+    U_PORT_TEST_ASSERT(uTimeServiceStart(&config) == 0);
+    U_PORT_TEST_ASSERT(uTimeServiceSample(gHostNowNs,
+                                          utcTrueNs(&host, gHostNowNs) + 1000000000) == 0);
+    simulate(&host, U_TIME_SERVICE_PULSE_REPORT_NEXT, 900, &result);
+    checkResult(&host, &result);
+    U_PORT_TEST_ASSERT(result.stats.steps == 2);
+
+    uTimeServiceStop();
+    U_PORT_TEST_ASSERT(uTimeServiceNowNs() == (int64_t) U_ERROR_COMMON_NOT_INITIALISED);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test the servo with reports of the last pulse, as from +UUTIME,
+ * with a host clock that is fast and a larger error at the start.
+ */
+U_PORT_TEST_FUNCTION("[timeService]", "timeServiceLast")
+{
+    int32_t resourceCount;
+    uTimeServiceConfig_t config = U_TIME_SERVICE_CONFIG_DEFAULT;
+    uTimeServiceTestHost_t host = {.startNs = 123456789012LL, .driftPpt = -95000000};
+    uTimeServiceTestResult_t result;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    gRandom = 2;
+    gHostNowNs = host.startNs;
+    config.pClockNs = hostClockNs;
+    U_PORT_TEST_ASSERT(uTimeServiceStart(&config) == 0);
+
+    U_TEST_PRINT_LINE("host clock %d ppb fast, report of the last pulse"
+                      " 150 ms after it.", (int32_t) (-host.driftPpt / 1000));
+    simulate(&host, U_TIME_SERVICE_PULSE_REPORT_LAST, 150, &result);
+    checkResult(&host, &result);
+    U_PORT_TEST_ASSERT(result.stats.samples == U_TIME_SERVICE_TEST_NUM_PULSES);
+    U_PORT_TEST_ASSERT(result.stats.unpaired == 0);
+
+    uTimeServiceStop();
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[timeService]", "timeServiceCleanUp")
+{
+    uTimeServiceStop();
+    uPortDeinit();
+}
+
+// End of file
@@ -43,6 +43,18 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A broken-down UTC date and time, as used by
+ * uTimeToSecondsUtcBatch().
+ */
+typedef struct {
+    int32_t year;   /**< the year, e.g. 2024. */
+    int32_t month;  /**< the month, 1 to 12. */
+    int32_t day;    /**< the day of the month, 1 to 31. */
+    int32_t hour;   /**< the hour, 0 to 23. */
+    int32_t minute; /**< the minute, 0 to 59. */
+    int32_t second; /**< the second, 0 to 60. */
+} uTimeDateTime_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -82,6 +94,64 @@ int64_t uTimeMonthsToSecondsUtc(int32_t monthsUtc);
  */
 int32_t uTimeSecondsToMonthsUtc(int64_t secondsUtc);
 
+/** Return the number of days since 1st January 1970 of the given
+ * date; any date in the proleptic Gregorian calendar will work,
+ * dates before 1970 giving a negative result.  This is a
+ * closed-form calculation, it does not loop.
+ *
+ * @param year  the year, e.g. 2024.
+ * @param month the month, 1 to 12; values outside this range are
+ *              carried into the year.
+ * @param day   the day of the month, counting from 1; values
+ *              outside the month are carried into the months
+ *              either side.
+ * @return      the number of days since 1970.
+ */
+int32_t uTimeDaysFromDate(int32_t year, int32_t month, int32_t day);
+
+/** The inverse of uTimeDaysFromDate(): the date of a day number.
+ *
+ * @param days        the number of days since 1st January 1970,
+ *                    may be negative.
+ * @param[out] pYear  a place to put the year, may be NULL.
+ * @param[out] pMonth a place to put the month, 1 to 12, may be NULL.
+ * @param[out] pDay   a place to put the day of the month,
+ *                    counting from 1, may be NULL.
+ */
+void uTimeDateFromDays(int32_t days, int32_t *pYear,
+                       int32_t *pMonth, int32_t *pDay);
+
+/** Convert a UTC date and time to the number of seconds since
+ * 1970, in the same way as mktime64() but without the need to
+ * fill in a struct tm.  Out-of-range values are carried as
+ * described for uTimeDaysFromDate(); hour, minute and second
+ * simply add up.
+ *
+ * @param year   the year, e.g. 2024.
+ * @param month  the month, 1 to 12.
+ * @param day    the day of the month, counting from 1.
+ * @param hour   the hour, 0 to 23.
+ * @param minute the minute, 0 to 59.
+ * @param second the second, 0 to 60.
+ * @return       the number of seconds since 1970.
+ */
+int64_t uTimeToSecondsUtc(int32_t year, int32_t month, int32_t day,
+                          int32_t hour, int32_t minute, int32_t second);
+
+/** Convert an array of UTC dates and times to seconds since 1970,
+ * as uTimeToSecondsUtc(); the loop has no branches or table
+ * look-ups and so may be vectorised by the compiler, useful when
+ * converting logged data in bulk.
+ *
+ * @param[in] pDateTime    a pointer to count dates/times; cannot
+ *                         be NULL unless count is zero.
+ * @param[out] pSecondsUtc a pointer to storage for count results;
+ *                         cannot be NULL unless count is zero.
+ * @param count            the number of dates/times to convert.
+ */
+void uTimeToSecondsUtcBatch(const uTimeDateTime_t *pDateTime,
+                            int64_t *pSecondsUtc, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
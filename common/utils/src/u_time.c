@@ -28,6 +28,7 @@
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
+#include "stddef.h"    // size_t
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 
@@ -41,21 +42,62 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The number of seconds in a day.
+ */
+#define U_TIME_SECONDS_PER_DAY (3600 * 24)
+
+/** The number of days in a 400 year cycle of the Gregorian
+ * calendar.
+ */
+#define U_TIME_DAYS_PER_ERA 146097
+
+/** The number of days from 1st March of the year 0 (which is
+ * where the calculations below count from, since it puts the
+ * leap day at the end of the year) to 1st January 1970.
+ */
+#define U_TIME_DAYS_TO_1970 719468
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
 
-static const char gDaysInMonth[] = {31, 28, 31, 30, 31, 30, 31,
-                                    31, 30, 31, 30, 31
-                                   };
-static const char gDaysInMonthLeapYear[] = {31, 29, 31, 30, 31, 30,
-                                            31, 31, 30, 31, 30, 31
-                                           };
-
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Floor division by a positive divisor, i.e. rounding towards
+// minus infinity rather than towards zero, without a branch.
+static inline int32_t floorDiv(int32_t dividend, int32_t divisor)
+{
+    return (dividend - ((dividend < 0) * (divisor - 1))) / divisor;
+}
+
+// The days since 1970 of a date; this is the "days from civil"
+// algorithm of Howard Hinnant, with the month first normalised.
+// Deliberately branch-free so that uTimeToSecondsUtcBatch()
+// can be vectorised.
+static inline int32_t daysFromDate(int32_t year, int32_t month, int32_t day)
+{
+    int32_t era;
+    int32_t yearOfEra;
+    int32_t dayOfYear;
+    int32_t dayOfEra;
+
+    // Carry any out of range month into the year, leaving month 0 to 11
+    month--;
+    year += floorDiv(month, 12);
+    month -= floorDiv(month, 12) * 12;
+    // Count years from March so that the leap day is at the end
+    year -= (month < 2);
+    era = floorDiv(year, 400);
+    yearOfEra = year - (era * 400);
+    // Month 0 is now March
+    dayOfYear = (((153 * ((month + 10) % 12)) + 2) / 5) + day - 1;
+    dayOfEra = (yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100) + dayOfYear;
+
+    return (era * U_TIME_DAYS_PER_ERA) + dayOfEra - U_TIME_DAYS_TO_1970;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -75,12 +117,8 @@ int64_t uTimeMonthsToSecondsUtc(int32_t monthsUtc)
 {
     int64_t secondsUtc = 0;
 
-    for (int32_t x = 0; x < monthsUtc; x++) {
-        if (uTimeIsLeapYear((x / 12) + 1970)) {
-            secondsUtc += gDaysInMonthLeapYear[x % 12] * 3600 * 24;
-        } else {
-            secondsUtc += gDaysInMonth[x % 12] * 3600 * 24;
-        }
+    if (monthsUtc > 0) {
+        secondsUtc = ((int64_t) daysFromDate(1970, monthsUtc + 1, 1)) * U_TIME_SECONDS_PER_DAY;
     }
 
     return secondsUtc;
@@ -89,28 +127,71 @@ int64_t uTimeMonthsToSecondsUtc(int32_t monthsUtc)
 int32_t uTimeSecondsToMonthsUtc(int64_t secondsUtc)
 {
     int32_t monthsUtc = 0;
-    int32_t year = 0;
-    int32_t month = 0;
-    int32_t x;
-
-    while (secondsUtc > 0) {
-        if (uTimeIsLeapYear(year + 1970)) {
-            x = gDaysInMonthLeapYear[month] * 3600 * 24;
-        } else {
-            x = gDaysInMonth[month] * 3600 * 24;
-        }
-        if (secondsUtc >= x) {
-            monthsUtc++;
-            month++;
-        }
-        secondsUtc -= x;
-        if (month == 12) {
-            month = 0;
-            year++;
-        }
+    int32_t year;
+    int32_t month;
+
+    if (secondsUtc > 0) {
+        uTimeDateFromDays((int32_t) (secondsUtc / U_TIME_SECONDS_PER_DAY),
+                          &year, &month, NULL);
+        monthsUtc = ((year - 1970) * 12) + month - 1;
     }
 
     return monthsUtc;
 }
 
+int32_t uTimeDaysFromDate(int32_t year, int32_t month, int32_t day)
+{
+    return daysFromDate(year, month, day);
+}
+
+// The "civil from days" algorithm of Howard Hinnant.
+void uTimeDateFromDays(int32_t days, int32_t *pYear,
+                       int32_t *pMonth, int32_t *pDay)
+{
+    int32_t era;
+    int32_t dayOfEra;
+    int32_t yearOfEra;
+    int32_t dayOfYear;
+    int32_t monthFromMarch;
+    int32_t month;
+
+    days += U_TIME_DAYS_TO_1970;
+    era = floorDiv(days, U_TIME_DAYS_PER_ERA);
+    dayOfEra = days - (era * U_TIME_DAYS_PER_ERA);
+    yearOfEra = (dayOfEra - (dayOfEra / 1460) + (dayOfEra / 36524) -
+                 (dayOfEra / (U_TIME_DAYS_PER_ERA - 1))) / 365;
+    dayOfYear = dayOfEra - ((yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100));
+    monthFromMarch = ((dayOfYear * 5) + 2) / 153;
+    month = ((monthFromMarch + 2) % 12) + 1;
+    if (pYear != NULL) {
+        *pYear = yearOfEra + (era * 400) + (month <= 2);
+    }
+    if (pMonth != NULL) {
+        *pMonth = month;
+    }
+    if (pDay != NULL) {
+        *pDay = dayOfYear - (((153 * monthFromMarch) + 2) / 5) + 1;
+    }
+}
+
+int64_t uTimeToSecondsUtc(int32_t year, int32_t month, int32_t day,
+                          int32_t hour, int32_t minute, int32_t second)
+{
+    return (((int64_t) daysFromDate(year, month, day)) * U_TIME_SECONDS_PER_DAY) +
+           (((int64_t) hour) * 3600) + (((int64_t) minute) * 60) + second;
+}
+
+void uTimeToSecondsUtcBatch(const uTimeDateTime_t *pDateTime,
+                            int64_t *pSecondsUtc, size_t count)
+{
+    for (size_t x = 0; x < count; x++) {
+        *(pSecondsUtc + x) = uTimeToSecondsUtc((pDateTime + x)->year,
+                                               (pDateTime + x)->month,
+                                               (pDateTime + x)->day,
+                                               (pDateTime + x)->hour,
+                                               (pDateTime + x)->minute,
+                                               (pDateTime + x)->second);
+    }
+}
+
 // End of file
@@ -0,0 +1,340 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the time API.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "time.h"      // struct tm
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* gmtime_r() in some cases. */
+#include "u_port_clib_mktime64.h"
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_time.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_TIME_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The last year covered by the timeExhaustive test.
+ */
+#define U_TIME_TEST_LAST_YEAR 2100
+
+#ifndef U_TIME_TEST_BENCHMARK_NUM_CONVERSIONS
+/** The number of conversions to time in the timeBenchmark test.
+ */
+# define U_TIME_TEST_BENCHMARK_NUM_CONVERSIONS 10000
+#endif
+
+/** The number of dates converted in one go by the batch part of
+ * the timeBenchmark test.
+ */
+#define U_TIME_TEST_BENCHMARK_BATCH_SIZE 100
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Days in each month, for the reference implementation.
+ */
+static const char gDaysInMonth[] = {31, 28, 31, 30, 31, 30, 31,
+                                    31, 30, 31, 30, 31
+                                   };
+
+/** Days in each month of a leap year, for the reference
+ * implementation.
+ */
+static const char gDaysInMonthLeapYear[] = {31, 29, 31, 30, 31, 30,
+                                            31, 31, 30, 31, 30, 31
+                                           };
+
+/** Somewhere for the benchmark to put its results so that the
+ * compiler can't optimise the conversions away.
+ */
+static volatile int64_t gSink = 0;
+
+/** Dates for the batch part of the benchmark.
+ */
+static uTimeDateTime_t gDateTime[U_TIME_TEST_BENCHMARK_BATCH_SIZE];
+
+/** Results of the batch part of the benchmark.
+ */
+static int64_t gSecondsUtc[U_TIME_TEST_BENCHMARK_BATCH_SIZE];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// The original, looping, implementation of
+// uTimeMonthsToSecondsUtc(), used as a reference.
+static int64_t refMonthsToSecondsUtc(int32_t monthsUtc)
+{
+    int64_t secondsUtc = 0;
+
+    for (int32_t x = 0; x < monthsUtc; x++) {
+        if (uTimeIsLeapYear((x / 12) + 1970)) {
+            secondsUtc += gDaysInMonthLeapYear[x % 12] * 3600 * 24;
+        } else {
+            secondsUtc += gDaysInMonth[x % 12] * 3600 * 24;
+        }
+    }
+
+    return secondsUtc;
+}
+
+// The original, looping, implementation of
+// uTimeSecondsToMonthsUtc(), used as a reference.
+static int32_t refSecondsToMonthsUtc(int64_t secondsUtc)
+{
+    int32_t monthsUtc = 0;
+    int32_t year = 0;
+    int32_t month = 0;
+    int32_t x;
+
+    while (secondsUtc > 0) {
+        if (uTimeIsLeapYear(year + 1970)) {
+            x = gDaysInMonthLeapYear[month] * 3600 * 24;
+        } else {
+            x = gDaysInMonth[month] * 3600 * 24;
+        }
+        if (secondsUtc >= x) {
+            monthsUtc++;
+            month++;
+        }
+        secondsUtc -= x;
+        if (month == 12) {
+            month = 0;
+            year++;
+        }
+    }
+
+    return monthsUtc;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Check every month and every day from 1970 to 2100 against the
+ * original looping implementations.
+ */
+U_PORT_TEST_FUNCTION("[time]", "timeExhaustive")
+{
+    int32_t numMonths = (U_TIME_TEST_LAST_YEAR - 1970 + 1) * 12;
+    int64_t monthStartSeconds = 0;
+    int32_t daysInMonth;
+    int32_t days = 0;
+    int32_t year;
+    int32_t month;
+    int32_t day;
+    int64_t t;
+    int32_t resourceCount;
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_TEST_PRINT_LINE("checking every day from 1970 to %d...", U_TIME_TEST_LAST_YEAR);
+
+    // Months before 1970 and zero seconds behave as before
+    U_PORT_TEST_ASSERT(uTimeMonthsToSecondsUtc(-1) == refMonthsToSecondsUtc(-1));
+    U_PORT_TEST_ASSERT(uTimeSecondsToMonthsUtc(-1) == refSecondsToMonthsUtc(-1));
+    U_PORT_TEST_ASSERT(uTimeSecondsToMonthsUtc(0) == refSecondsToMonthsUtc(0));
+
+    for (int32_t m = 0; m < numMonths; m++) {
+        // Step the reference forward incrementally, rather than
+        // calling it for every month, else this would take forever
+        U_PORT_TEST_ASSERT(uTimeMonthsToSecondsUtc(m) == monthStartSeconds);
+        if ((m % 60) == 0) {
+            // Spot-check the incremental approach against the reference
+            U_PORT_TEST_ASSERT(refMonthsToSecondsUtc(m) == monthStartSeconds);
+            U_PORT_TEST_ASSERT(refSecondsToMonthsUtc(monthStartSeconds) == m);
+            if (m > 0) {
+                U_PORT_TEST_ASSERT(refSecondsToMonthsUtc(monthStartSeconds - 1) == m - 1);
+            }
+        }
+        year = 1970 + (m / 12);
+        month = (m % 12) + 1;
+        if (uTimeIsLeapYear(year)) {
+            daysInMonth = gDaysInMonthLeapYear[m % 12];
+        } else {
+            daysInMonth = gDaysInMonth[m % 12];
+        }
+        for (int32_t d = 1; d <= daysInMonth; d++) {
+            t = monthStartSeconds + (((int64_t) d - 1) * 3600 * 24);
+            // Seconds to months at the start, middle and end of each day
+            U_PORT_TEST_ASSERT(uTimeSecondsToMonthsUtc(t) == m);
+            U_PORT_TEST_ASSERT(uTimeSecondsToMonthsUtc(t + (3600 * 12)) == m);
+            U_PORT_TEST_ASSERT(uTimeSecondsToMonthsUtc(t + (3600 * 24) - 1) == m);
+            // Day counts both ways
+            U_PORT_TEST_ASSERT(uTimeDaysFromDate(year, month, d) == days);
+            uTimeDateFromDays(days, &year, &month, &day);
+            U_PORT_TEST_ASSERT(year == 1970 + (m / 12));
+            U_PORT_TEST_ASSERT(month == (m % 12) + 1);
+            U_PORT_TEST_ASSERT(day == d);
+            // The direct API
+            U_PORT_TEST_ASSERT(uTimeToSecondsUtc(year, month, d, 23, 59, 59) ==
+                               t + (3600 * 24) - 1);
+            days++;
+        }
+        monthStartSeconds += ((int64_t) daysInMonth) * 3600 * 24;
+    }
+
+    // Carrying of out-of-range values
+    U_PORT_TEST_ASSERT(uTimeToSecondsUtc(2023, 13, 1, 0, 0, 0) ==
+                       uTimeToSecondsUtc(2024, 1, 1, 0, 0, 0));
+    U_PORT_TEST_ASSERT(uTimeToSecondsUtc(2024, 0, 1, 0, 0, 0) ==
+                       uTimeToSecondsUtc(2023, 12, 1, 0, 0, 0));
+    U_PORT_TEST_ASSERT(uTimeToSecondsUtc(2024, 3, 0, 0, 0, 0) ==
+                       uTimeToSecondsUtc(2024, 2, 29, 0, 0, 0));
+    U_PORT_TEST_ASSERT(uTimeToSecondsUtc(2024, 2, 28, 24, 0, 0) ==
+                       uTimeToSecondsUtc(2024, 2, 29, 0, 0, 0));
+    // ...and dates before 1970
+    U_PORT_TEST_ASSERT(uTimeDaysFromDate(1969, 12, 31) == -1);
+    U_PORT_TEST_ASSERT(uTimeDaysFromDate(1900, 3, 1) == -25508);
+    uTimeDateFromDays(-25508, &year, &month, &day);
+    U_PORT_TEST_ASSERT((year == 1900) && (month == 3) && (day == 1));
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Compare the conversion rate of the closed-form functions with
+ * that of the original looping implementations.
+ */
+U_PORT_TEST_FUNCTION("[time]", "timeBenchmark")
+{
+    // 2024-06-15 12:34:56
+    int32_t months = ((2024 - 1970) * 12) + 5;
+    int64_t secondsUtc = 1718454896LL;
+    int32_t startTimeMs;
+    int32_t refTimeMs;
+    int32_t timeMs;
+    int32_t batchTimeMs;
+    int32_t resourceCount;
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uTimeToSecondsUtc(2024, 6, 15, 12, 34, 56) == secondsUtc);
+
+    // Months to seconds
+    startTimeMs = uPortGetTickTimeMs();
+    for (int32_t x = 0; x < U_TIME_TEST_BENCHMARK_NUM_CONVERSIONS; x++) {
+        gSink += refMonthsToSecondsUtc(months - (x & 0x0F));
+    }
+    refTimeMs = uPortGetTickTimeMs() - startTimeMs;
+    startTimeMs = uPortGetTickTimeMs();
+    for (int32_t x = 0; x < U_TIME_TEST_BENCHMARK_NUM_CONVERSIONS; x++) {
+        gSink += uTimeMonthsToSecondsUtc(months - (x & 0x0F));
+    }
+    timeMs = uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("%d months-to-seconds conversions took %d ms looping,"
+                      " %d ms closed-form.", U_TIME_TEST_BENCHMARK_NUM_CONVERSIONS,
+                      refTimeMs, timeMs);
+    U_PORT_TEST_ASSERT(timeMs <= refTimeMs);
+
+    // Seconds to months
+    startTimeMs = uPortGetTickTimeMs();
+    for (int32_t x = 0; x < U_TIME_TEST_BENCHMARK_NUM_CONVERSIONS; x++) {
+        gSink += refSecondsToMonthsUtc(secondsUtc - (x * 3600));
+    }
+    refTimeMs = uPortGetTickTimeMs() - startTimeMs;
+    startTimeMs = uPortGetTickTimeMs();
+    for (int32_t x = 0; x < U_TIME_TEST_BENCHMARK_NUM_CONVERSIONS; x++) {
+        gSink += uTimeSecondsToMonthsUtc(secondsUtc - (x * 3600));
+    }
+    timeMs = uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("%d seconds-to-months conversions took %d ms looping,"
+                      " %d ms closed-form.", U_TIME_TEST_BENCHMARK_NUM_CONVERSIONS,
+                      refTimeMs, timeMs);
+    U_PORT_TEST_ASSERT(timeMs <= refTimeMs);
+
+    // Date/time to seconds, one at a time and in batches
+    for (size_t x = 0; x < U_TIME_TEST_BENCHMARK_BATCH_SIZE; x++) {
+        gDateTime[x].year = 2024;
+        gDateTime[x].month = 6;
+        gDateTime[x].day = 15;
+        gDateTime[x].hour = 12;
+        gDateTime[x].minute = 34;
+        gDateTime[x].second = (int32_t) (56 + x);
+    }
+    startTimeMs = uPortGetTickTimeMs();
+    for (int32_t x = 0; x < U_TIME_TEST_BENCHMARK_NUM_CONVERSIONS; x++) {
+        gSink += uTimeToSecondsUtc(2024, 6, 15, 12, 34, 56 + (x & 0x3F));
+    }
+    timeMs = uPortGetTickTimeMs() - startTimeMs;
+    startTimeMs = uPortGetTickTimeMs();
+    for (int32_t x = 0; x < U_TIME_TEST_BENCHMARK_NUM_CONVERSIONS;
+         x += U_TIME_TEST_BENCHMARK_BATCH_SIZE) {
+        uTimeToSecondsUtcBatch(gDateTime, gSecondsUtc, U_TIME_TEST_BENCHMARK_BATCH_SIZE);
+        gSink += gSecondsUtc[x % U_TIME_TEST_BENCHMARK_BATCH_SIZE];
+    }
+    batchTimeMs = uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("%d date/time-to-seconds conversions took %d ms singly,"
+                      " %d ms in batches of %d.", U_TIME_TEST_BENCHMARK_NUM_CONVERSIONS,
+                      timeMs, batchTimeMs, U_TIME_TEST_BENCHMARK_BATCH_SIZE);
+    for (size_t x = 0; x < U_TIME_TEST_BENCHMARK_BATCH_SIZE; x++) {
+        U_PORT_TEST_ASSERT(gSecondsUtc[x] == secondsUtc + (int64_t) x);
+    }
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+// End of file
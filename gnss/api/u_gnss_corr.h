@@ -0,0 +1,221 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_CORR_H_
+#define _U_GNSS_CORR_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the correction-data pump of the
+ * GNSS API: RTCM3 or SPARTN messages, received by the application
+ * from the network (e.g. from an NTRIP caster over a socket or
+ * from a PointPerfect MQTT broker), are pushed into a bounded
+ * per-instance queue from any task and written to the GNSS chip
+ * by a dedicated task.  The writer takes only the transport of the
+ * GNSS instance, not the GNSS API as a whole, and lets go of the
+ * transport between bursts, so that correction data and the
+ * application's own configuration/position traffic interleave
+ * rather than one blocking the other.  This API is only available
+ * for streaming transports (UART, I2C, SPI, Virtual Serial).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_CORR_QUEUE_LENGTH_BYTES
+/** The default size of the correction-data queue, used if
+ * zero is passed to uGnssCorrStart(); each queued message
+ * occupies its own length plus
+ * #U_GNSS_CORR_QUEUE_OVERHEAD_BYTES.
+ */
+# define U_GNSS_CORR_QUEUE_LENGTH_BYTES 4096
+#endif
+
+/** The number of bytes of queue used, in addition to the
+ * message itself, by each message in the correction-data queue.
+ */
+#define U_GNSS_CORR_QUEUE_OVERHEAD_BYTES 6
+
+/** The largest message that can be pushed: a SPARTN message,
+ * which is bigger than the largest RTCM3 message (1029 bytes).
+ */
+#define U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES (4 + 8 + 1024 + 64 + 4)
+
+#ifndef U_GNSS_CORR_BURST_LENGTH_BYTES
+/** The number of bytes that the correction-data writer will
+ * send to the GNSS chip back to back before yielding, allowing
+ * other users of the transport in; it always sends at least
+ * one whole message.
+ */
+# define U_GNSS_CORR_BURST_LENGTH_BYTES 1024
+#endif
+
+#ifndef U_GNSS_CORR_TASK_STACK_SIZE_BYTES
+/** The stack size of the correction-data writer task.
+ */
+# define U_GNSS_CORR_TASK_STACK_SIZE_BYTES 2048
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The handle of a correction-data pump, as returned by
+ * uGnssCorrStart().
+ */
+typedef void *uGnssCorrHandle_t;
+
+/** Statistics of the correction-data pump, see uGnssCorrGetStats().
+ */
+typedef struct {
+    size_t messagesQueued;   /**< the number of messages accepted into the queue. */
+    size_t messagesSent;     /**< the number of messages written to the GNSS chip. */
+    size_t messagesDropped;  /**< the number of valid messages lost because the
+                                  queue was full. */
+    size_t bytesRejected;    /**< the number of bytes pushed that were not part
+                                  of a valid RTCM3 or SPARTN message. */
+    size_t bytesSent;        /**< the number of bytes written to the GNSS chip. */
+    size_t sendErrors;       /**< the number of messages the transport failed
+                                  to write in full. */
+    size_t queueLengthBytes; /**< the number of bytes currently queued. */
+    size_t queueHighWaterBytes; /**< the most bytes that have been queued. */
+    int32_t ageLastMs;       /**< the time between the last message being pushed
+                                  and it having been written to the GNSS chip. */
+    int32_t ageAverageMs;    /**< the average of ageLastMs. */
+    int32_t ageMaxMs;        /**< the worst case of ageLastMs. */
+    int32_t throughputBytesPerSecond; /**< bytesSent divided by the time since
+                                           uGnssCorrStart() was called. */
+} uGnssCorrStats_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Check whether a buffer begins with a complete and valid RTCM3
+ * or SPARTN message; RTCM3 messages are CRC-24Q checked and SPARTN
+ * messages are checked with uSpartnValidate().  This is what
+ * uGnssCorrPush() uses to find messages; it is exposed in case the
+ * application wishes to check messages for itself.
+ *
+ * @param[in] pBuffer  a pointer to the data; cannot be NULL.
+ * @param size         the amount of data at pBuffer.
+ * @return             the length of the message at the start of
+ *                     pBuffer, #U_ERROR_COMMON_TIMEOUT if pBuffer
+ *                     begins with what may be a message but it is
+ *                     not yet complete, else negative error code.
+ */
+int32_t uGnssCorrMessageCheck(const char *pBuffer, size_t size);
+
+/** Start the correction-data pump for a GNSS instance.  If the
+ * pump is already running it is restarted, losing anything queued,
+ * with the new settings, and the handle of the old pump is no
+ * longer valid.  The statistics are reset.
+ *
+ * The handle returned is passed to uGnssCorrPush() and
+ * uGnssCorrGetStats(), which then touch only the pump and not the
+ * GNSS API as a whole, so that pushing corrections from a busy
+ * callback never waits on, say, a long GNSS configuration
+ * exchange.  The handle remains valid until the pump is stopped,
+ * by uGnssCorrStop(), by uGnssRemove()/uGnssDeinit() or by starting
+ * it again: the application must make sure that no call using
+ * the handle is in progress, or made, from that point on, e.g. by
+ * closing the socket or MQTT subscription that feeds it first.
+ *
+ * @param gnssHandle        the handle of the GNSS instance.
+ * @param queueLengthBytes  the size of the queue; use zero for
+ *                          #U_GNSS_CORR_QUEUE_LENGTH_BYTES.  Must
+ *                          be large enough to contain a message of
+ *                          #U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES plus
+ *                          #U_GNSS_CORR_QUEUE_OVERHEAD_BYTES.
+ * @param dropOldest        what to do when a message is pushed and
+ *                          the queue is full: if true the oldest
+ *                          messages are dropped to make room, which
+ *                          is usually the right thing for corrections
+ *                          as old ones are of decreasing value, else
+ *                          the pushed message is dropped.
+ * @param[out] pCorrHandle  a place to put the handle of the pump;
+ *                          cannot be NULL.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uGnssCorrStart(uDeviceHandle_t gnssHandle,
+                       size_t queueLengthBytes, bool dropOldest,
+                       uGnssCorrHandle_t *pCorrHandle);
+
+/** Push correction data into the queue of a correction-data pump;
+ * may be called from any task, e.g. a socket data callback or an
+ * MQTT message callback.  The data may contain any number of RTCM3 and/or
+ * SPARTN messages; each message is validated and queued separately,
+ * anything between messages is discarded.  If the data ends with
+ * the start of a message, that message is left alone and the
+ * return value will be less than size: the application should keep
+ * the remainder and push it again, at the front of the data that
+ * follows, which means that data read from a stream, e.g. TCP, can
+ * be pushed as it arrives.  This function does not block on the
+ * transport or on the GNSS API, only on the queue of the pump.
+ *
+ * @param corrHandle   the handle of the pump, as returned by
+ *                     uGnssCorrStart().
+ * @param[in] pBuffer  the correction data; cannot be NULL.
+ * @param size         the amount of data at pBuffer.
+ * @return             on success the number of bytes of pBuffer
+ *                     consumed, else negative error code.  Note that
+ *                     messages dropped because the queue is full
+ *                     still count as consumed; see messagesDropped
+ *                     in #uGnssCorrStats_t.
+ */
+int32_t uGnssCorrPush(uGnssCorrHandle_t corrHandle,
+                      const char *pBuffer, size_t size);
+
+/** Get the statistics of a correction-data pump.
+ *
+ * @param corrHandle   the handle of the pump, as returned by
+ *                     uGnssCorrStart().
+ * @param[out] pStats  a place to put the statistics; cannot be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssCorrGetStats(uGnssCorrHandle_t corrHandle,
+                          uGnssCorrStats_t *pStats);
+
+/** Stop the correction-data pump of a GNSS instance; anything
+ * queued is lost and the handle of the pump is no longer valid.
+ * Also done by uGnssRemove().
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ */
+void uGnssCorrStop(uDeviceHandle_t gnssHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_CORR_H_
+
+// End of file
@@ -24,6 +24,12 @@
 
 #include "u_gnss_dec_ubx_nav_pvt.h"
 #include "u_gnss_dec_ubx_nav_hpposllh.h"
+#include "u_gnss_dec_ubx_nav_dop.h"
+#include "u_gnss_dec_ubx_nav_status.h"
+#include "u_gnss_dec_ubx_nav_cov.h"
+#include "u_gnss_dec_ubx_nav_sat.h"
+#include "u_gnss_dec_ubx_tim_tp.h"
+#include "u_gnss_dec_nmea.h"
 
 /** \addtogroup _GNSS
  *  @{
@@ -58,6 +64,18 @@ extern "C" {
 typedef union {
     uGnssDecUbxNavPvt_t           ubxNavPvt;      /**< UBX-NAV-PVT. */
     uGnssDecUbxNavHpposllh_t      ubxNavHpposllh; /**< UBX-NAV-HPPOSLLH. */
+    uGnssDecUbxNavDop_t           ubxNavDop;      /**< UBX-NAV-DOP. */
+    uGnssDecUbxNavStatus_t        ubxNavStatus;   /**< UBX-NAV-STATUS. */
+    uGnssDecUbxNavCov_t           ubxNavCov;      /**< UBX-NAV-COV. */
+    uGnssDecUbxNavSat_t           ubxNavSat;      /**< UBX-NAV-SAT. */
+    uGnssDecUbxTimTp_t            ubxTimTp;       /**< UBX-TIM-TP. */
+    uGnssDecNmeaGga_t             nmeaGga;        /**< NMEA GGA, any talker. */
+    uGnssDecNmeaRmc_t             nmeaRmc;        /**< NMEA RMC, any talker. */
+    uGnssDecNmeaGsa_t             nmeaGsa;        /**< NMEA GSA, any talker. */
+    uGnssDecNmeaGsv_t             nmeaGsv;        /**< NMEA GSV, any talker. */
+    uGnssDecNmeaGst_t             nmeaGst;        /**< NMEA GST, any talker. */
+    uGnssDecNmeaVtg_t             nmeaVtg;        /**< NMEA VTG, any talker. */
+    uGnssDecNmeaZda_t             nmeaZda;        /**< NMEA ZDA, any talker. */
 } uGnssDecUnion_t;
 
 /** The result of attempting to decode a message, returned by
@@ -155,12 +173,18 @@ typedef int32_t (uGnssDecFunction_t) (uGnssMessageId_t *pId,
  * and must include all headers; no checking of checksums etc. on the
  * end of a known message is performed, hence they may be omitted.
  *
- * Currently only a very limited set of messages (actually just
- * UBX-NAV-PVT and UBX-NAV-HPPOSLLH, the latter useful if you wish
- * to use a high precision GNSS (HPG) device to its full extent) are
- * supported; see the top of the file u_gnss_dec.c for instructions
- * on how to add more decoders, or use uGnssDecSetCallback() to
- * hook-in your own decoders at run-time.
+ * Currently only a limited set of messages (UBX-NAV-PVT,
+ * UBX-NAV-HPPOSLLH, the latter useful if you wish to use a high
+ * precision GNSS (HPG) device to its full extent, UBX-NAV-DOP,
+ * UBX-NAV-STATUS, UBX-NAV-COV, UBX-NAV-SAT and UBX-TIM-TP, plus the NMEA
+ * sentences GGA, RMC, GSA, GSV, GST, VTG and ZDA from any talker)
+ * are supported; for NMEA sentences, which arrive at a high rate,
+ * consider using uGnssDecNmea() instead, and for UBX messages
+ * uGnssDecUbx(), neither of which allocate memory.  See the top of
+ * the file u_gnss_dec.c for instructions on how to add more
+ * decoders, or use uGnssDecSetCallback() to
+ * hook-in your own decoders at run-time; a hooked-in decoder is
+ * given the first go at NMEA sentences.
  *
  * If only a partial decode is possible then the errorCode field of
  * the returned structure will be negative but the protocol type
@@ -186,6 +210,36 @@ typedef int32_t (uGnssDecFunction_t) (uGnssMessageId_t *pId,
  */
 uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size);
 
+/** Decode one of the UBX messages known to pUGnssDecAlloc() into
+ * a structure provided by the caller: no memory is allocated.  As
+ * for pUGnssDecAlloc(), the message must begin at the start of
+ * pBuffer, must include the header and the checksum bytes may be
+ * omitted; the checksum is not checked.
+ *
+ * @param[in] pBuffer   the buffer containing the UBX message to be
+ *                      decoded; cannot be NULL.
+ * @param size          the amount of data at pBuffer.
+ * @param[out] pBody    a place to put the decoded message body,
+ *                      e.g. a pointer to a #uGnssDecUbxNavPvt_t,
+ *                      cast to #uGnssDecUnion_t, if pBuffer contains
+ *                      a UBX-NAV-PVT message; cannot be NULL.
+ * @param bodySize      the amount of storage at pBody, which must
+ *                      be at least the size of the structure for
+ *                      the message that is in pBuffer;
+ *                      sizeof(uGnssDecUnion_t) is always enough.
+ * @return              on success the message class and ID, as
+ *                      returned by U_GNSS_UBX_MESSAGE(), so that
+ *                      the caller can tell which structure pBody
+ *                      now contains, else #U_ERROR_COMMON_NOT_SUPPORTED
+ *                      if pBuffer does not contain a UBX message
+ *                      known to this code, #U_ERROR_COMMON_TRUNCATED
+ *                      if the message was incomplete or
+ *                      #U_ERROR_COMMON_INVALID_PARAMETER if bodySize
+ *                      is too small.
+ */
+int32_t uGnssDecUbx(const char *pBuffer, size_t size,
+                    uGnssDecUnion_t *pBody, size_t bodySize);
+
 /** Free the memory returned by pUGnssDecAlloc().
  *
  * @param[in] pDec the pointer returned by pUGnssDecAlloc(); may
@@ -210,9 +264,12 @@ int32_t uGnssDecGetIdList(const uGnssMessageId_t **ppIdList);
  * uGnssDecSetCallback() should not be called while
  * pUGnssDecAlloc() may be acting.
  *
- * Note that the callback is called only after the built-in
- * decoders have all failed to work, hence it cannot override
- * them.
+ * Note that, for UBX and RTCM messages, the callback is called only
+ * after the built-in decoders have all failed to work, hence it
+ * cannot override them.  For NMEA sentences the callback is called
+ * _first_, so that a decoder you had hooked-in before the built-in
+ * NMEA decoders were added continues to be used; if it fails, and
+ * leaves the body pointer as NULL, the built-in decoders are tried.
  *
  * @param[in] pCallback      your message decode callback, use
  *                           NULL to remove an existing callback.
@@ -0,0 +1,353 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_NMEA_H_
+#define _U_GNSS_DEC_NMEA_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of the NMEA sentences
+ * that can be decoded: GGA, RMC, GSA, GSV, GST, VTG and ZDA, from
+ * any talker (GP, GL, GA, GB, GQ, GI, GN, BD, etc.).  Unlike the UBX
+ * messages, which each have their own header file, the NMEA
+ * sentences are kept together since they share the same field
+ * conventions and the same tokeniser.
+ *
+ * The sentences may be decoded with pUGnssDecAlloc(), like any
+ * other message, or, where allocating memory for each sentence
+ * is not desirable (NMEA sentences arrive at a high rate), with
+ * uGnssDecNmea(), which decodes into a structure provided by the
+ * caller.  Either way the fields are tokenised in a single pass,
+ * without copying, and numbers are converted to fixed-point
+ * integers; no floating point is involved.  A field that is empty
+ * in the sentence, or beyond the end of a sentence from an earlier
+ * version of NMEA, is set to #U_GNSS_DEC_NMEA_NOT_PRESENT (or
+ * #U_GNSS_DEC_NMEA_NOT_PRESENT_INT16 for satellite fields, or zero
+ * for character fields).  Fractional digits beyond the resolution
+ * of a field are truncated.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The value of an int32_t field of a decoded NMEA sentence
+ * which was not present in the sentence.
+ */
+#define U_GNSS_DEC_NMEA_NOT_PRESENT INT32_MIN
+
+/** The value of an int16_t field of a decoded NMEA sentence
+ * which was not present in the sentence.
+ */
+#define U_GNSS_DEC_NMEA_NOT_PRESENT_INT16 INT16_MIN
+
+/** The maximum number of satellite IDs in an NMEA GSA sentence.
+ */
+#define U_GNSS_DEC_NMEA_GSA_NUM_SV 12
+
+/** The maximum number of satellites in an NMEA GSV sentence.
+ */
+#define U_GNSS_DEC_NMEA_GSV_NUM_SAT 4
+
+#ifndef U_GNSS_DEC_NMEA_SAT_TABLE_NUM_SAT
+/** The number of satellites that #uGnssDecNmeaSatTable_t can
+ * hold, across all talkers/signals.
+ */
+# define U_GNSS_DEC_NMEA_SAT_TABLE_NUM_SAT 64
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The NMEA sentences that can be decoded.
+ */
+typedef enum {
+    U_GNSS_DEC_NMEA_SENTENCE_GGA,
+    U_GNSS_DEC_NMEA_SENTENCE_RMC,
+    U_GNSS_DEC_NMEA_SENTENCE_GSA,
+    U_GNSS_DEC_NMEA_SENTENCE_GSV,
+    U_GNSS_DEC_NMEA_SENTENCE_GST,
+    U_GNSS_DEC_NMEA_SENTENCE_VTG,
+    U_GNSS_DEC_NMEA_SENTENCE_ZDA,
+    U_GNSS_DEC_NMEA_SENTENCE_MAX_NUM
+} uGnssDecNmeaSentence_t;
+
+/** NMEA GGA sentence: global positioning system fix data.
+ */
+typedef struct {
+    char talker[3];                     /**< the talker ID, e.g. "GP", null-terminated. */
+    int32_t timeOfDayMs;                /**< UTC time of day in milliseconds. */
+    int32_t latitudeX1e7;               /**< latitude in degrees times 1e7,
+                                             negative for south. */
+    int32_t longitudeX1e7;              /**< longitude in degrees times 1e7,
+                                             negative for west. */
+    int32_t quality;                    /**< the quality indicator: 0 for no fix,
+                                             1 for autonomous, 2 for differential,
+                                             4 for RTK fixed, 5 for RTK float,
+                                             6 for dead reckoning. */
+    int32_t numSv;                      /**< the number of satellites used. */
+    int32_t hdopX100;                   /**< horizontal dilution of precision
+                                             times 100. */
+    int32_t altitudeMillimetres;        /**< altitude above mean sea level in
+                                             millimetres. */
+    int32_t geoidSeparationMillimetres; /**< the difference between the ellipsoid
+                                             and mean sea level in millimetres. */
+    int32_t diffAgeMs;                  /**< the age of differential corrections
+                                             in milliseconds. */
+    int32_t diffStation;                /**< the ID of the station providing
+                                             differential corrections. */
+} uGnssDecNmeaGga_t;
+
+/** NMEA RMC sentence: recommended minimum data.
+ */
+typedef struct {
+    char talker[3];                     /**< the talker ID, e.g. "GP", null-terminated. */
+    int32_t timeOfDayMs;                /**< UTC time of day in milliseconds. */
+    char status;                        /**< 'A' for data valid, 'V' for a
+                                             receiver warning. */
+    int32_t latitudeX1e7;               /**< latitude in degrees times 1e7,
+                                             negative for south. */
+    int32_t longitudeX1e7;              /**< longitude in degrees times 1e7,
+                                             negative for west. */
+    int32_t speedMillimetresPerSecond;  /**< speed over ground in millimetres
+                                             per second, converted from knots. */
+    int32_t courseX1e2;                 /**< course over ground in degrees
+                                             times 100. */
+    int32_t year;                       /**< the UTC year, four digits; two-digit
+                                             years less than 80 are taken to
+                                             be 20xx, the rest 19xx. */
+    int32_t month;                      /**< the UTC month, 1 to 12. */
+    int32_t day;                        /**< the UTC day of the month, 1 to 31. */
+    int32_t magneticVariationX1e2;      /**< magnetic variation in degrees times
+                                             100, negative for west. */
+    char posMode;                       /**< the mode indicator, e.g. 'A' for
+                                             autonomous, 'D' for differential,
+                                             'N' for no fix; NMEA 2.3 onwards. */
+    char navStatus;                     /**< the navigational status, 'V' since the
+                                             equipment does not provide it;
+                                             NMEA 4.1 onwards. */
+} uGnssDecNmeaRmc_t;
+
+/** NMEA GSA sentence: DOP and active satellites.
+ */
+typedef struct {
+    char talker[3];                     /**< the talker ID, e.g. "GP", null-terminated. */
+    char opMode;                        /**< 'M' for manual, 'A' for automatic
+                                             2D/3D selection. */
+    int32_t navMode;                    /**< 1 for no fix, 2 for 2D, 3 for 3D. */
+    int32_t numSv;                      /**< the number of entries in svId. */
+    int16_t svId[U_GNSS_DEC_NMEA_GSA_NUM_SV]; /**< the IDs of the satellites
+                                                   used, empty fields skipped. */
+    int32_t pdopX100;                   /**< position dilution of precision
+                                             times 100. */
+    int32_t hdopX100;                   /**< horizontal dilution of precision
+                                             times 100. */
+    int32_t vdopX100;                   /**< vertical dilution of precision
+                                             times 100. */
+    int32_t systemId;                   /**< the NMEA GNSS system ID; NMEA 4.1
+                                             onwards. */
+} uGnssDecNmeaGsa_t;
+
+/** A satellite, as reported in a GSV sentence; any field that
+ * is not present is #U_GNSS_DEC_NMEA_NOT_PRESENT_INT16, e.g.
+ * cnoDbHz will be not present for a satellite that is not
+ * being tracked.
+ */
+typedef struct {
+    int16_t svId;               /**< the satellite ID. */
+    int16_t elevationDegrees;   /**< the elevation in degrees. */
+    int16_t azimuthDegrees;     /**< the azimuth in degrees. */
+    int16_t cnoDbHz;            /**< carrier to noise ratio in dBHz. */
+} uGnssDecNmeaGsvSat_t;
+
+/** NMEA GSV sentence: satellites in view; a set of these, one for
+ * each group of four satellites, is emitted by each talker (and for
+ * each signal from NMEA 4.1 onwards).  To assemble a set into a
+ * single table, see uGnssDecNmeaGsvAssemble().
+ */
+typedef struct {
+    char talker[3];                     /**< the talker ID, e.g. "GP", null-terminated. */
+    int32_t numMessages;                /**< the number of sentences in the set. */
+    int32_t messageNumber;              /**< the number of this sentence in the
+                                             set, counting from 1. */
+    int32_t numSvInView;                /**< the number of satellites in view. */
+    int32_t numSat;                     /**< the number of entries in sat. */
+    uGnssDecNmeaGsvSat_t sat[U_GNSS_DEC_NMEA_GSV_NUM_SAT]; /**< the satellites. */
+    int32_t signalId;                   /**< the NMEA signal ID; NMEA 4.1
+                                             onwards. */
+} uGnssDecNmeaGsv_t;
+
+/** NMEA GST sentence: pseudorange error statistics.
+ */
+typedef struct {
+    char talker[3];                     /**< the talker ID, e.g. "GP", null-terminated. */
+    int32_t timeOfDayMs;                /**< UTC time of day in milliseconds. */
+    int32_t rangeRmsMillimetres;        /**< RMS value of the standard deviation
+                                             of the ranges in millimetres. */
+    int32_t stdMajorMillimetres;        /**< standard deviation of the semi-major
+                                             axis in millimetres. */
+    int32_t stdMinorMillimetres;        /**< standard deviation of the semi-minor
+                                             axis in millimetres. */
+    int32_t orientationX1e2;            /**< orientation of the semi-major axis
+                                             in degrees times 100. */
+    int32_t stdLatitudeMillimetres;     /**< standard deviation of latitude
+                                             error in millimetres. */
+    int32_t stdLongitudeMillimetres;    /**< standard deviation of longitude
+                                             error in millimetres. */
+    int32_t stdAltitudeMillimetres;     /**< standard deviation of altitude
+                                             error in millimetres. */
+} uGnssDecNmeaGst_t;
+
+/** NMEA VTG sentence: course over ground and ground speed.
+ */
+typedef struct {
+    char talker[3];                     /**< the talker ID, e.g. "GP", null-terminated. */
+    int32_t courseTrueX1e2;             /**< course over ground (true) in degrees
+                                             times 100. */
+    int32_t courseMagneticX1e2;         /**< course over ground (magnetic) in
+                                             degrees times 100. */
+    int32_t speedMillimetresPerSecond;  /**< speed over ground in millimetres per
+                                             second, converted from the km/h
+                                             field or, if that is not present,
+                                             from the knots field. */
+    char posMode;                       /**< the mode indicator, e.g. 'A' for
+                                             autonomous; NMEA 2.3 onwards. */
+} uGnssDecNmeaVtg_t;
+
+/** NMEA ZDA sentence: time and date.
+ */
+typedef struct {
+    char talker[3];                     /**< the talker ID, e.g. "GP", null-terminated. */
+    int32_t timeOfDayMs;                /**< UTC time of day in milliseconds. */
+    int32_t day;                        /**< the UTC day of the month, 1 to 31. */
+    int32_t month;                      /**< the UTC month, 1 to 12. */
+    int32_t year;                       /**< the UTC year, four digits. */
+    int32_t localZoneHours;             /**< the local time zone offset in hours. */
+    int32_t localZoneMinutes;           /**< the local time zone offset in
+                                             minutes. */
+} uGnssDecNmeaZda_t;
+
+/** A decoded NMEA sentence, as populated by uGnssDecNmea().
+ */
+typedef struct {
+    uGnssDecNmeaSentence_t sentence; /**< which member of body is populated. */
+    union {
+        uGnssDecNmeaGga_t gga;
+        uGnssDecNmeaRmc_t rmc;
+        uGnssDecNmeaGsa_t gsa;
+        uGnssDecNmeaGsv_t gsv;
+        uGnssDecNmeaGst_t gst;
+        uGnssDecNmeaVtg_t vtg;
+        uGnssDecNmeaZda_t zda;
+    } body;                          /**< the decoded sentence. */
+} uGnssDecNmea_t;
+
+/** An entry in #uGnssDecNmeaSatTable_t.
+ */
+typedef struct {
+    char talker[3];             /**< the talker ID of the GSV set the satellite
+                                     came from, e.g. "GL", null-terminated. */
+    int16_t signalId;           /**< the NMEA signal ID, -1 if the GSV
+                                     sentence did not include one. */
+    uGnssDecNmeaGsvSat_t sat;   /**< the satellite. */
+} uGnssDecNmeaSatTableEntry_t;
+
+/** A table of satellites assembled from sets of GSV sentences by
+ * uGnssDecNmeaGsvAssemble(); zero it before first use.
+ */
+typedef struct {
+    size_t numSat;                   /**< the number of valid entries in sat. */
+    uGnssDecNmeaSatTableEntry_t sat[U_GNSS_DEC_NMEA_SAT_TABLE_NUM_SAT]; /**< the
+                                                                             satellites. */
+    // Assembly state: hands off
+    char talker[3];                  /**< the talker of the set being assembled. */
+    int32_t signalId;                /**< the signal ID of the set being assembled. */
+    int32_t numMessages;             /**< the length of the set being assembled. */
+    int32_t nextMessageNumber;       /**< the next sentence expected, 0 if none. */
+    size_t setStart;                 /**< the index in sat where the set began. */
+} uGnssDecNmeaSatTable_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: HELPERS
+ * -------------------------------------------------------------- */
+
+/** Decode an NMEA sentence into a structure provided by the caller;
+ * no memory is allocated.  The sentence must begin with the '$'
+ * and may or may not include the "*hh" checksum and the CR/LF on
+ * the end; the checksum is not checked (uGnssMsgReceive() and
+ * the callback of uGnssMsgReceiveStart() will already have done
+ * that).
+ *
+ * @param[in] pBuffer  the NMEA sentence; cannot be NULL.
+ * @param size         the number of characters at pBuffer.
+ * @param[out] pNmea   a place to put the decoded sentence; cannot
+ *                     be NULL.
+ * @return             zero on success, #U_ERROR_COMMON_NOT_SUPPORTED
+ *                     if the sentence is not one of those in
+ *                     #uGnssDecNmeaSentence_t (or is not NMEA),
+ *                     #U_ERROR_COMMON_TRUNCATED if the sentence has
+ *                     too few fields or #U_ERROR_COMMON_BAD_DATA if
+ *                     one or more fields could not be converted, in
+ *                     which case the remaining fields are still
+ *                     populated.
+ */
+int32_t uGnssDecNmea(const char *pBuffer, size_t size,
+                     uGnssDecNmea_t *pNmea);
+
+/** Assemble a set of GSV sentences into a table of satellites;
+ * call this with each GSV sentence as it arrives.  Sets from all
+ * talkers/signals of an epoch are accumulated in the table; the
+ * table is emptied when the first sentence of a set arrives for a
+ * talker/signal which is already in the table, i.e. at the start
+ * of the next epoch.  If the table fills up further satellites
+ * are ignored.
+ *
+ * @param[in,out] pTable  the satellite table, zeroed before first
+ *                        use; cannot be NULL.
+ * @param[in] pGsv        a decoded GSV sentence; cannot be NULL.
+ * @return                the number of satellites in the table if
+ *                        pGsv completed a set, #U_ERROR_COMMON_BUSY
+ *                        if more sentences of the set are to come,
+ *                        #U_ERROR_COMMON_PROTOCOL_ERROR if pGsv was out
+ *                        of sequence, in which case any partial set
+ *                        is removed from the table, else negative
+ *                        error code.
+ */
+int32_t uGnssDecNmeaGsvAssemble(uGnssDecNmeaSatTable_t *pTable,
+                                const uGnssDecNmeaGsv_t *pGsv);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_NMEA_H_
+
+// End of file
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_UBX_TIM_TP_H_
+#define _U_GNSS_DEC_UBX_TIM_TP_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of a UBX-TIM-TP
+ * message, which gives the time of the NEXT time pulse.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The message class of a UBX-TIM-TP message.
+ */
+#define U_GNSS_DEC_UBX_TIM_TP_MESSAGE_CLASS 0x0d
+
+/** The message ID of a UBX-TIM-TP message.
+ */
+#define U_GNSS_DEC_UBX_TIM_TP_MESSAGE_ID 0x01
+
+/** The minimum length of the body of a UBX-TIM-TP message.
+ */
+#define U_GNSS_DEC_UBX_TIM_TP_BODY_MIN_LENGTH 16
+
+/** Bit mask for the #U_GNSS_DEC_UBX_TIM_TP_FLAGS_RAIM
+ * field of #uGnssDecUbxTimTpFlags_t.
+ */
+#define U_GNSS_DEC_UBX_TIM_TP_FLAGS_RAIM_MASK (0x03 << U_GNSS_DEC_UBX_TIM_TP_FLAGS_RAIM)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Bit fields of the "flags" field of #uGnssDecUbxTimTp_t; use
+ * these to mask specific bits, e.g.
+ *
+ * `if (flags & (1 << U_GNSS_DEC_UBX_TIM_TP_FLAGS_TIME_BASE)) {`
+ *
+ * ...would determine if the time is UTC rather than GNSS time.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_TIM_TP_FLAGS_TIME_BASE = 0,     /**< set if towMS/week
+                                                        are UTC, clear if
+                                                        they are GNSS time. */
+    U_GNSS_DEC_UBX_TIM_TP_FLAGS_UTC = 1,           /**< UTC is available. */
+    U_GNSS_DEC_UBX_TIM_TP_FLAGS_RAIM = 2,          /**< not a single bit,
+                                                        the start of a 2-bit
+                                                        field, use
+                                                        #U_GNSS_DEC_UBX_TIM_TP_FLAGS_RAIM_MASK
+                                                        to mask it and this
+                                                        to shift it down:
+                                                        0 means RAIM information
+                                                        is not available, 1
+                                                        not active and 2
+                                                        active. */
+    U_GNSS_DEC_UBX_TIM_TP_FLAGS_Q_ERR_INVALID = 4  /**< qErr is not valid. */
+} uGnssDecUbxTimTpFlags_t;
+
+/** UBX-TIM-TP message structure; the naming and type of each
+ * element follows that of the interface manual.
+ */
+typedef struct {
+    uint32_t towMS;    /**< time of week of the next time pulse,
+                            rounded down to a millisecond, in the
+                            time base given by flags. */
+    uint32_t towSubMS; /**< the sub-millisecond part of the time of
+                            week of the next time pulse, in units of
+                            2^-32 milliseconds. */
+    int32_t qErr;      /**< the quantisation error of the time pulse
+                            in picoseconds. */
+    uint16_t week;     /**< the week number of the next time pulse,
+                            in the time base given by flags. */
+    uint8_t flags;     /**< see #uGnssDecUbxTimTpFlags_t. */
+    uint8_t refInfo;   /**< the time reference information: the
+                            GNSS used for GNSS time in the lower four
+                            bits, the UTC standard in the upper
+                            four bits. */
+} uGnssDecUbxTimTp_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_UBX_TIM_TP_H_
+
+// End of file
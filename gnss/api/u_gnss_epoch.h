@@ -0,0 +1,235 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_EPOCH_H_
+#define _U_GNSS_EPOCH_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_gnss_dec_ubx_nav_pvt.h"
+#include "u_gnss_dec_ubx_nav_hpposllh.h"
+#include "u_gnss_dec_ubx_nav_dop.h"
+#include "u_gnss_dec_ubx_nav_status.h"
+#include "u_gnss_dec_ubx_nav_cov.h"
+#include "u_gnss_dec_ubx_nav_sat.h"
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the navigation-epoch assembler
+ * of the GNSS API.  A GNSS chip emits the NAV messages of a fix
+ * (UBX-NAV-PVT, UBX-NAV-COV, UBX-NAV-SAT, etc.) one after the other,
+ * all carrying the same iTOW, followed by UBX-NAV-EOE ("end of
+ * epoch"); the assembler collects a chosen set of these messages,
+ * decodes them as they arrive into a snapshot keyed by iTOW and,
+ * when the epoch closes, hands the application that one snapshot
+ * through a single callback, so that the application need not
+ * register a callback per message and stitch the results together
+ * itself.  The snapshots are double-buffered, allocated once when
+ * the assembler is started: nothing is allocated per epoch.
+ *
+ * The assembler does not configure the GNSS chip: the application
+ * should switch on the output of the wanted messages and of
+ * UBX-NAV-EOE (e.g. with uGnssCfgValSet() and the
+ * U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_NAV_XXX_YYY keys).  If UBX-NAV-EOE
+ * is not switched on an epoch is closed when the first message of
+ * the next epoch arrives or when the timeout expires, whichever
+ * comes first.  This API is only available for streaming transports
+ * (UART, I2C, SPI, Virtual Serial).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_EPOCH_TIMEOUT_MS
+/** The default time, measured from the arrival of the first message
+ * of an epoch, after which an epoch for which UBX-NAV-EOE has not
+ * arrived is closed, used if zero is passed to uGnssEpochStart().
+ * This should be less than the navigation period of the GNSS chip.
+ */
+# define U_GNSS_EPOCH_TIMEOUT_MS 500
+#endif
+
+#ifndef U_GNSS_EPOCH_TASK_STACK_SIZE_BYTES
+/** The stack size of the epoch delivery task, the task in which
+ * the callback passed to uGnssEpochStart() is called.
+ */
+# define U_GNSS_EPOCH_TASK_STACK_SIZE_BYTES 2048
+#endif
+
+/** Convert a #uGnssEpochMessage_t into a bit for the messageBitmap
+ * parameter of uGnssEpochStart().
+ */
+#define U_GNSS_EPOCH_MESSAGE_BIT(message) (1UL << (message))
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The messages that the assembler can collect.
+ */
+typedef enum {
+    U_GNSS_EPOCH_MESSAGE_NAV_PVT = 0,
+    U_GNSS_EPOCH_MESSAGE_NAV_HPPOSLLH = 1,
+    U_GNSS_EPOCH_MESSAGE_NAV_DOP = 2,
+    U_GNSS_EPOCH_MESSAGE_NAV_STATUS = 3,
+    U_GNSS_EPOCH_MESSAGE_NAV_COV = 4,
+    U_GNSS_EPOCH_MESSAGE_NAV_SAT = 5,
+    U_GNSS_EPOCH_MESSAGE_MAX_NUM
+} uGnssEpochMessage_t;
+
+/** What closed an epoch.
+ */
+typedef enum {
+    U_GNSS_EPOCH_CLOSED_BY_EOE = 0,       /**< UBX-NAV-EOE arrived: the
+                                               normal case. */
+    U_GNSS_EPOCH_CLOSED_BY_TIMEOUT = 1,   /**< UBX-NAV-EOE did not arrive
+                                               within the timeout. */
+    U_GNSS_EPOCH_CLOSED_BY_NEXT_EPOCH = 2 /**< a message of a later epoch
+                                               arrived before UBX-NAV-EOE. */
+} uGnssEpochClosedBy_t;
+
+/** One navigation epoch, as passed to the callback of
+ * uGnssEpochStart().  Only the members whose bit is set in
+ * messageBitmap contain anything; the rest are zeroed.
+ */
+typedef struct {
+    uint32_t iTOW;          /**< GPS time of week of the navigation
+                                 epoch in milliseconds. */
+    uint32_t messageBitmap; /**< the messages present, a bit-map of
+                                 U_GNSS_EPOCH_MESSAGE_BIT(). */
+    bool complete;          /**< true if all of the messages asked for
+                                 in uGnssEpochStart() are present. */
+    uGnssEpochClosedBy_t closedBy; /**< what closed the epoch. */
+    int32_t openTimeMs;     /**< uPortGetTickTimeMs() when the first
+                                 message of the epoch arrived. */
+    int32_t closeTimeMs;    /**< uPortGetTickTimeMs() when the epoch
+                                 was closed. */
+    uGnssDecUbxNavPvt_t navPvt;
+    uGnssDecUbxNavHpposllh_t navHpposllh;
+    uGnssDecUbxNavDop_t navDop;
+    uGnssDecUbxNavStatus_t navStatus;
+    uGnssDecUbxNavCov_t navCov;
+    uGnssDecUbxNavSat_t navSat;
+} uGnssEpoch_t;
+
+/** The callback that receives each navigation epoch.
+ *
+ * @param gnssHandle      the handle of the GNSS instance.
+ * @param[in] pEpoch      the epoch; this is only valid for the
+ *                        duration of the callback, copy out anything
+ *                        that is needed afterwards.
+ * @param pCallbackParam  the pCallbackParam passed to
+ *                        uGnssEpochStart().
+ */
+typedef void (*uGnssEpochCallback_t)(uDeviceHandle_t gnssHandle,
+                                     const uGnssEpoch_t *pEpoch,
+                                     void *pCallbackParam);
+
+/** Statistics of the navigation-epoch assembler, see
+ * uGnssEpochGetStats().
+ */
+typedef struct {
+    size_t epochsDelivered;  /**< the number of epochs passed to the
+                                  callback. */
+    size_t epochsIncomplete; /**< of epochsDelivered, the number that
+                                  were missing one or more messages. */
+    size_t epochsTimedOut;   /**< of epochsDelivered, the number that
+                                  were closed by the timeout. */
+    size_t epochsDropped;    /**< the number of epochs lost because the
+                                  callback was still busy with the
+                                  previous one when they closed. */
+    size_t messagesLate;     /**< the number of messages discarded
+                                  because their epoch had already
+                                  been closed. */
+    int32_t latencyLastMs;   /**< the time between the last epoch
+                                  being closed (e.g. by the arrival
+                                  of UBX-NAV-EOE) and the callback
+                                  being called. */
+    int32_t latencyAverageMs; /**< the average of latencyLastMs. */
+    int32_t latencyMaxMs;    /**< the worst case of latencyLastMs. */
+} uGnssEpochStats_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Start the navigation-epoch assembler for a GNSS instance.  If
+ * the assembler is already running it is restarted with the new
+ * settings.  The statistics are reset.
+ *
+ * pCallback is called from a task of its own, hence the GNSS
+ * message receive task carries on while it runs; however, like a
+ * message receive callback, it must NOT call any GNSS API functions:
+ * if it needs to, it should pass the epoch to a task of the
+ * application.  If pCallback is still busy with one epoch when the
+ * next closes the latter is dropped, see epochsDropped in
+ * #uGnssEpochStats_t.
+ *
+ * @param gnssHandle      the handle of the GNSS instance.
+ * @param messageBitmap   the messages to collect, a bit-map of
+ *                        U_GNSS_EPOCH_MESSAGE_BIT(); cannot be zero.
+ * @param timeoutMs       the epoch timeout, see
+ *                        #U_GNSS_EPOCH_TIMEOUT_MS, which is used if
+ *                        this is zero.
+ * @param pCallback       the callback to receive each epoch; cannot
+ *                        be NULL.
+ * @param pCallbackParam  a parameter that will be passed to pCallback.
+ * @return                zero on success else negative error code.
+ */
+int32_t uGnssEpochStart(uDeviceHandle_t gnssHandle,
+                        uint32_t messageBitmap, int32_t timeoutMs,
+                        uGnssEpochCallback_t pCallback,
+                        void *pCallbackParam);
+
+/** Get the statistics of the navigation-epoch assembler of a GNSS
+ * instance.
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @param[out] pStats  a place to put the statistics; cannot be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssEpochGetStats(uDeviceHandle_t gnssHandle,
+                           uGnssEpochStats_t *pStats);
+
+/** Stop the navigation-epoch assembler of a GNSS instance; an
+ * epoch that is being collected is lost.  Once this function has
+ * returned the callback will not be called again.  Also done by
+ * uGnssRemove().  Must not be called from the callback.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ */
+void uGnssEpochStop(uDeviceHandle_t gnssHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_EPOCH_H_
+
+// End of file
@@ -162,6 +162,10 @@ static void deleteGnssInstance(uGnssPrivateInstance_t *pInstance)
             uGnssPrivateCleanUpPosTask(pInstance);
             // Stop and clean up streamed position
             uGnssPrivateCleanUpStreamedPos(pInstance);
+            // Stop any correction-data pump
+            uGnssPrivateCleanUpCorr(pInstance);
+            // Stop any navigation-epoch assembler
+            uGnssPrivateCleanUpEpoch(pInstance);
             // Stop asynchronus message receive from happening
             uGnssPrivateStopMsgReceive(pInstance);
             // Free the SPI buffer, if there is one
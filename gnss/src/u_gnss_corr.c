@@ -0,0 +1,533 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the correction-data pump of the GNSS API.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy(), memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_spi.h"
+
+#include "u_at_client.h" // Required by u_gnss_private.h
+
+#include "u_ringbuffer.h"
+
+#include "u_spartn.h"
+#include "u_spartn_crc.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss_private.h"
+#include "u_gnss_corr.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_CORR_TASK_PRIORITY
+/** The priority of the correction-data writer task; the same as
+ * the GNSS asynchronous message receive task.
+ */
+# define U_GNSS_CORR_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
+/** The first byte of an RTCM3 message.
+ */
+#define U_GNSS_CORR_RTCM_PREAMBLE 0xD3
+
+/** The first byte of a SPARTN message (TF001).
+ */
+#define U_GNSS_CORR_SPARTN_PREAMBLE 0x73
+
+/** The number of bytes of an RTCM3 message that are not body:
+ * preamble, two bytes of length and three bytes of CRC.
+ */
+#define U_GNSS_CORR_RTCM_OVERHEAD_BYTES 6
+
+#if U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES != U_SPARTN_MESSAGE_LENGTH_MAX_BYTES
+# error U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES must be the same as U_SPARTN_MESSAGE_LENGTH_MAX_BYTES
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The header in front of each message in the queue; it is
+ * written/read byte-wise so no packing issues.
+ */
+typedef struct {
+    uint16_t length;
+    int32_t timeMs;
+} uGnssCorrHeader_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Encode the queue header of a message.
+static void headerEncode(char *pBuffer, uint16_t length, int32_t timeMs)
+{
+    memcpy(pBuffer, &length, sizeof(length));
+    memcpy(pBuffer + sizeof(length), &timeMs, sizeof(timeMs));
+}
+
+// Decode the queue header of a message.
+static void headerDecode(const char *pBuffer, uGnssCorrHeader_t *pHeader)
+{
+    memcpy(&(pHeader->length), pBuffer, sizeof(pHeader->length));
+    memcpy(&(pHeader->timeMs), pBuffer + sizeof(pHeader->length),
+           sizeof(pHeader->timeMs));
+}
+
+// Check for a complete, CRC-correct RTCM3 message at the start of
+// a buffer; the RTCM3 CRC is CRC-24Q, the same as that of SPARTN.
+static int32_t rtcmCheck(const char *pBuffer, size_t size)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+    const uint8_t *pData = (const uint8_t *) pBuffer;
+    size_t length;
+    uint32_t crc;
+
+    if ((size > 1) && ((pData[1] & 0xFC) != 0)) {
+        // The six bits after the preamble are reserved as zero
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    } else if (size > 2) {
+        length = (((size_t) (pData[1] & 0x03)) << 8) + pData[2] + U_GNSS_CORR_RTCM_OVERHEAD_BYTES;
+        if (size >= length) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            crc = uSpartnCrc24(pBuffer, length - 3);
+            if ((pData[length - 3] == (uint8_t) (crc >> 16)) &&
+                (pData[length - 2] == (uint8_t) (crc >> 8)) &&
+                (pData[length - 1] == (uint8_t) crc)) {
+                errorCodeOrLength = (int32_t) length;
+            }
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Check for a complete, CRC-correct SPARTN message at the start
+// of a buffer.
+static int32_t spartnCheck(const char *pBuffer, size_t size)
+{
+    int32_t errorCodeOrLength;
+    const char *pMessage = NULL;
+
+    errorCodeOrLength = uSpartnDetect(pBuffer, size, &pMessage);
+    if (errorCodeOrLength > 0) {
+        if ((pMessage != pBuffer) ||
+            (errorCodeOrLength > U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES)) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        } else if ((size_t) errorCodeOrLength > size) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        } else if (uSpartnValidate(pBuffer, errorCodeOrLength,
+                                   &pMessage) != errorCodeOrLength) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        }
+    } else if (errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT) {
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    }
+
+    return errorCodeOrLength;
+}
+
+// Add a message to the queue, dropping something if there is
+// no room; pCorr->mutexHandle must be locked.
+static void queueAdd(uGnssPrivateCorr_t *pCorr, const char *pMessage,
+                     size_t length)
+{
+    char buffer[U_GNSS_CORR_QUEUE_OVERHEAD_BYTES];
+    uGnssCorrHeader_t header;
+    size_t queueLength;
+
+    if (pCorr->dropOldest) {
+        while ((uRingBufferAvailableSize(&(pCorr->queue)) < length + sizeof(buffer)) &&
+               (uRingBufferRead(&(pCorr->queue), buffer, sizeof(buffer)) == sizeof(buffer))) {
+            headerDecode(buffer, &header);
+            uRingBufferRead(&(pCorr->queue), NULL, header.length);
+            pCorr->messagesDropped++;
+        }
+    }
+    if (uRingBufferAvailableSize(&(pCorr->queue)) >= length + sizeof(buffer)) {
+        headerEncode(buffer, (uint16_t) length, uPortGetTickTimeMs());
+        uRingBufferAdd(&(pCorr->queue), buffer, sizeof(buffer));
+        uRingBufferAdd(&(pCorr->queue), pMessage, length);
+        pCorr->messagesQueued++;
+        queueLength = uRingBufferDataSize(&(pCorr->queue));
+        if (queueLength > pCorr->queueHighWaterBytes) {
+            pCorr->queueHighWaterBytes = queueLength;
+        }
+    } else {
+        pCorr->messagesDropped++;
+    }
+}
+
+// Write a message to the GNSS chip, taking only the transport
+// mutex; SPI is done in one go rather than in chunks since we
+// have a receive buffer of our own.
+static int32_t sendMessage(uGnssPrivateInstance_t *pInstance,
+                           uGnssPrivateCorr_t *pCorr, size_t length)
+{
+    int32_t errorCodeOrLength;
+
+    if (pCorr->pSpiBuffer != NULL) {
+
+        U_PORT_MUTEX_LOCK(pInstance->transportMutex);
+
+        errorCodeOrLength = uPortSpiControllerSendReceiveBlock(pInstance->transportHandle.spi,
+                                                               pCorr->pMessage, length,
+                                                               pCorr->pSpiBuffer, length);
+        if (errorCodeOrLength > 0) {
+            // Keep anything that the GNSS chip sent at the same time
+            uGnssPrivateSpiAddReceivedData(pInstance, pCorr->pSpiBuffer,
+                                           errorCodeOrLength);
+        }
+
+        U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
+
+    } else {
+        errorCodeOrLength = uGnssPrivateSendOnlyStreamRaw(pInstance, pCorr->pMessage,
+                                                          length);
+    }
+
+    return errorCodeOrLength;
+}
+
+// The writer task: waits to be woken, then sends everything in the
+// queue, a message at a time, yielding every
+// U_GNSS_CORR_BURST_LENGTH_BYTES to let other users of the transport
+// in.  It never locks gUGnssPrivateMutex: uGnssPrivateCleanUpCorr(),
+// which is called with gUGnssPrivateMutex locked, waits for it to exit.
+static void writerTask(void *pParameter)
+{
+    uGnssPrivateInstance_t *pInstance = (uGnssPrivateInstance_t *) pParameter;
+    uGnssPrivateCorr_t *pCorr = pInstance->pCorr;
+    char buffer[U_GNSS_CORR_QUEUE_OVERHEAD_BYTES];
+    uGnssCorrHeader_t header;
+    size_t burstLength = 0;
+    int32_t x;
+    bool gotOne;
+
+    U_PORT_MUTEX_LOCK(pCorr->taskRunningMutexHandle);
+    pCorr->taskRunning = true;
+
+    while (!pCorr->taskStop) {
+        uPortSemaphoreTake(pCorr->wakeSemaphoreHandle);
+        gotOne = true;
+        while (gotOne && !pCorr->taskStop) {
+            gotOne = false;
+
+            U_PORT_MUTEX_LOCK(pCorr->mutexHandle);
+
+            if (uRingBufferRead(&(pCorr->queue), buffer, sizeof(buffer)) == sizeof(buffer)) {
+                headerDecode(buffer, &header);
+                gotOne = (uRingBufferRead(&(pCorr->queue), pCorr->pMessage,
+                                          header.length) == header.length);
+            }
+
+            U_PORT_MUTEX_UNLOCK(pCorr->mutexHandle);
+
+            if (gotOne) {
+                x = sendMessage(pInstance, pCorr, header.length);
+
+                U_PORT_MUTEX_LOCK(pCorr->mutexHandle);
+
+                if (x == header.length) {
+                    pCorr->messagesSent++;
+                    pCorr->bytesSent += x;
+                    pCorr->ageLastMs = uPortGetTickTimeMs() - header.timeMs;
+                    pCorr->ageTotalMs += pCorr->ageLastMs;
+                    if (pCorr->ageLastMs > pCorr->ageMaxMs) {
+                        pCorr->ageMaxMs = pCorr->ageLastMs;
+                    }
+                } else {
+                    pCorr->sendErrors++;
+                }
+
+                U_PORT_MUTEX_UNLOCK(pCorr->mutexHandle);
+
+                burstLength += header.length;
+                if (burstLength >= U_GNSS_CORR_BURST_LENGTH_BYTES) {
+                    // Let anyone waiting on the transport in
+                    burstLength = 0;
+                    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                }
+            } else {
+                burstLength = 0;
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pCorr->taskRunningMutexHandle);
+
+    uPortTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Check for a complete and valid correction message.
+int32_t uGnssCorrMessageCheck(const char *pBuffer, size_t size)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pBuffer != NULL) {
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        if (size > 0) {
+            switch ((uint8_t) *pBuffer) {
+                case U_GNSS_CORR_RTCM_PREAMBLE:
+                    errorCodeOrLength = rtcmCheck(pBuffer, size);
+                    break;
+                case U_GNSS_CORR_SPARTN_PREAMBLE:
+                    errorCodeOrLength = spartnCheck(pBuffer, size);
+                    break;
+                default:
+                    errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+                    break;
+            }
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Start the correction-data pump.
+int32_t uGnssCorrStart(uDeviceHandle_t gnssHandle,
+                       size_t queueLengthBytes, bool dropOldest,
+                       uGnssCorrHandle_t *pCorrHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateCorr_t *pCorr;
+    int32_t streamType;
+
+    if (queueLengthBytes == 0) {
+        queueLengthBytes = U_GNSS_CORR_QUEUE_LENGTH_BYTES;
+    }
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        // +1 since a ring buffer holds one less than its linear buffer
+        if ((pInstance != NULL) && (pCorrHandle != NULL) &&
+            (queueLengthBytes >= U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES +
+             U_GNSS_CORR_QUEUE_OVERHEAD_BYTES + 1)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            streamType = uGnssPrivateGetStreamType(pInstance->transportType);
+            if (streamType >= 0) {
+                // Get rid of any existing pump
+                uGnssPrivateCleanUpCorr(pInstance);
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pCorr = (uGnssPrivateCorr_t *) pUPortMalloc(sizeof(*pCorr));
+                if (pCorr != NULL) {
+                    memset(pCorr, 0, sizeof(*pCorr));
+                    pCorr->dropOldest = dropOldest;
+                    pCorr->pLinearBuffer = (char *) pUPortMalloc(queueLengthBytes);
+                    pCorr->pMessage = (char *) pUPortMalloc(U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES);
+                    if (streamType == (int32_t) U_GNSS_PRIVATE_STREAM_TYPE_SPI) {
+                        pCorr->pSpiBuffer = (char *) pUPortMalloc(U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES);
+                    }
+                    if ((pCorr->pLinearBuffer != NULL) && (pCorr->pMessage != NULL) &&
+                        ((streamType != (int32_t) U_GNSS_PRIVATE_STREAM_TYPE_SPI) ||
+                         (pCorr->pSpiBuffer != NULL)) &&
+                        (uRingBufferCreate(&(pCorr->queue), pCorr->pLinearBuffer,
+                                           queueLengthBytes) == 0)) {
+                        errorCode = uPortMutexCreate(&(pCorr->mutexHandle));
+                        if (errorCode == 0) {
+                            errorCode = uPortMutexCreate(&(pCorr->taskRunningMutexHandle));
+                            if (errorCode == 0) {
+                                errorCode = uPortSemaphoreCreate(&(pCorr->wakeSemaphoreHandle),
+                                                                 0, 1);
+                                if (errorCode == 0) {
+                                    pCorr->startTimeMs = uPortGetTickTimeMs();
+                                    pInstance->pCorr = pCorr;
+                                    errorCode = uPortTaskCreate(writerTask, "gnssCorr",
+                                                                U_GNSS_CORR_TASK_STACK_SIZE_BYTES,
+                                                                pInstance, U_GNSS_CORR_TASK_PRIORITY,
+                                                                &(pCorr->taskHandle));
+                                    if (errorCode == 0) {
+                                        // Wait for the task to be running so that
+                                        // uGnssPrivateCleanUpCorr() can rely on
+                                        // taskRunningMutexHandle
+                                        while (!pCorr->taskRunning) {
+                                            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                                        }
+                                        *pCorrHandle = (uGnssCorrHandle_t) pCorr;
+                                    } else {
+                                        pInstance->pCorr = NULL;
+                                        uPortSemaphoreDelete(pCorr->wakeSemaphoreHandle);
+                                    }
+                                }
+                                if (errorCode != 0) {
+                                    uPortMutexDelete(pCorr->taskRunningMutexHandle);
+                                }
+                            }
+                            if (errorCode != 0) {
+                                uPortMutexDelete(pCorr->mutexHandle);
+                            }
+                        }
+                        if (errorCode != 0) {
+                            uRingBufferDelete(&(pCorr->queue));
+                        }
+                    }
+                    if (pInstance->pCorr == NULL) {
+                        // Clean up on error
+                        uPortFree(pCorr->pLinearBuffer);
+                        uPortFree(pCorr->pMessage);
+                        uPortFree(pCorr->pSpiBuffer);
+                        uPortFree(pCorr);
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Push correction data into the queue.
+int32_t uGnssCorrPush(uGnssCorrHandle_t corrHandle,
+                      const char *pBuffer, size_t size)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssPrivateCorr_t *pCorr = (uGnssPrivateCorr_t *) corrHandle;
+    size_t offset = 0;
+    bool queued = false;
+    int32_t x = 0;
+
+    // Only the pump is locked, not the GNSS API: the handle
+    // is valid until the pump is stopped
+    if ((pCorr != NULL) && (pBuffer != NULL)) {
+
+        U_PORT_MUTEX_LOCK(pCorr->mutexHandle);
+
+        while ((offset < size) && (x != (int32_t) U_ERROR_COMMON_TIMEOUT)) {
+            x = uGnssCorrMessageCheck(pBuffer + offset, size - offset);
+            if (x > 0) {
+                queueAdd(pCorr, pBuffer + offset, x);
+                offset += x;
+                queued = true;
+            } else if (x != (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                // Not a message: move on a byte
+                pCorr->bytesRejected++;
+                offset++;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(pCorr->mutexHandle);
+
+        if (queued) {
+            uPortSemaphoreGive(pCorr->wakeSemaphoreHandle);
+        }
+        errorCodeOrLength = (int32_t) offset;
+    }
+
+    return errorCodeOrLength;
+}
+
+// Get the statistics of the correction-data pump.
+int32_t uGnssCorrGetStats(uGnssCorrHandle_t corrHandle,
+                          uGnssCorrStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssPrivateCorr_t *pCorr = (uGnssPrivateCorr_t *) corrHandle;
+    int32_t elapsedMs;
+
+    if ((pCorr != NULL) && (pStats != NULL)) {
+
+        U_PORT_MUTEX_LOCK(pCorr->mutexHandle);
+
+        memset(pStats, 0, sizeof(*pStats));
+        pStats->messagesQueued = pCorr->messagesQueued;
+        pStats->messagesSent = pCorr->messagesSent;
+        pStats->messagesDropped = pCorr->messagesDropped;
+        pStats->bytesRejected = pCorr->bytesRejected;
+        pStats->bytesSent = pCorr->bytesSent;
+        pStats->sendErrors = pCorr->sendErrors;
+        pStats->queueLengthBytes = uRingBufferDataSize(&(pCorr->queue));
+        pStats->queueHighWaterBytes = pCorr->queueHighWaterBytes;
+        pStats->ageLastMs = pCorr->ageLastMs;
+        pStats->ageMaxMs = pCorr->ageMaxMs;
+        if (pCorr->messagesSent > 0) {
+            pStats->ageAverageMs = (int32_t) (pCorr->ageTotalMs /
+                                              (int64_t) pCorr->messagesSent);
+        }
+        elapsedMs = uPortGetTickTimeMs() - pCorr->startTimeMs;
+        if (elapsedMs > 0) {
+            pStats->throughputBytesPerSecond = (int32_t) (((int64_t) pCorr->bytesSent * 1000) /
+                                                          elapsedMs);
+        }
+
+        U_PORT_MUTEX_UNLOCK(pCorr->mutexHandle);
+
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Stop the correction-data pump.
+void uGnssCorrStop(uDeviceHandle_t gnssHandle)
+{
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            uGnssPrivateCleanUpCorr(pInstance);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+}
+
+// End of file
@@ -49,12 +49,16 @@
  *
  * 3. Create the static decode function for the message here,
  * following the naming pattern, e.g. for UBX-XXX-YYY the function
- * would be named ubxXxxYyyAlloc(); the function  must have the
- * function signature of #uGnssDecKnownFunction_t.
+ * would be named ubxXxxYyyDecode(); the function must have the
+ * function signature of #uGnssDecUbxFunction_t: it decodes into
+ * storage provided by the caller, which is what allows
+ * uGnssDecUbx() to work without allocating memory.
  *
- * 4. Add the static function to the gpFunctionList array and add
- * its message ID to the gIdList array, making sure to put it in the
- * same position in both.
+ * 4. Add the static function, with its message ID, minimum body
+ * length and structure size, to the gUbxDecoderList array, then
+ * add its message ID to the gIdList array and ubxAlloc() to the
+ * gpFunctionList array, making sure to put them in the same position
+ * in both of the latter.
  *
  * 5. If in step (1) you chose to include helper functions, add a
  * .c file in this src directory, of the same name as the .h file,
@@ -67,11 +71,19 @@
  * function if there are any (again, see the handling of UBX-NAV-PVT
  * for an example).
  *
- * Obviously it would be possible to add NMEA messages, or RTCM messages,
- * in the same way, just replacing "ubx" with "nmea" or "rtcm", but note
- * that this code does not use NMEA or RTCM messages and we want to avoid
- * code bloat, hence the uGnssDecSetCallback() hook to allow a customer
- * to add their own decoders at run-time.
+ * NMEA sentences are handled a little differently: they share a
+ * single header file, u_gnss_dec_nmea.h, and a single decoder,
+ * uGnssDecNmea() in u_gnss_dec_nmea.c, which populates a structure
+ * provided by the caller; nmeaAlloc() here just allocates memory
+ * for the result.  To add a new NMEA sentence, add it to
+ * #uGnssDecNmeaSentence_t, write its decode function in
+ * u_gnss_dec_nmea.c and add its ID, with "??" as the talker, to
+ * gIdList below, with nmeaAlloc() in the same position in
+ * gpFunctionList.  Otherwise, RTCM messages could be added in the
+ * same way as UBX messages, just replacing "ubx" with "rtcm", but
+ * note that we want to avoid code bloat, hence the
+ * uGnssDecSetCallback() hook to allow a customer to add their own
+ * decoders at run-time.
  */
 
 #ifdef U_CFG_OVERRIDE
@@ -81,7 +93,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memset()
+#include "string.h"    // memset(), memcpy()
 
 #include "u_error_common.h"
 
@@ -134,6 +146,32 @@ typedef int32_t (uGnssDecKnownFunction_t) (const char *pBuffer,
                                            size_t size,
                                            uGnssDecUnion_t **ppBody);
 
+/** Function that decodes the body of a known UBX message into
+ * storage provided by the caller.
+ *
+ * @param[in] pBody      the message body, i.e. with the UBX header
+ *                       removed, so that the offsets in the interface
+ *                       manual may be used directly.
+ * @param length         the length of the message body, which will
+ *                       be at least the minimum body length of the
+ *                       message.
+ * @param[out] pDecoded  a place to put the decoded message body;
+ *                       will never be NULL and will always be big
+ *                       enough for the message structure.
+ */
+typedef void (uGnssDecUbxFunction_t) (const char *pBody, size_t length,
+                                      uGnssDecUnion_t *pDecoded);
+
+/** A UBX message that is known to this code.
+ */
+typedef struct {
+    uint16_t id;          /**< the message class and ID, as formed by
+                               U_GNSS_UBX_MESSAGE(). */
+    size_t bodyMinLength; /**< the minimum length of the message body. */
+    size_t decodedSize;   /**< the size of the decoded message structure. */
+    uGnssDecUbxFunction_t *pFunction; /**< the decode function. */
+} uGnssDecUbxDecoder_t;
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES: MISC
  * -------------------------------------------------------------- */
@@ -159,7 +197,35 @@ static const uGnssMessageId_t gIdList[] = {
     {
         .type = U_GNSS_PROTOCOL_UBX,
         .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_ID)
-    }
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_COV_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_COV_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_TIM_TP_MESSAGE_CLASS, U_GNSS_DEC_UBX_TIM_TP_MESSAGE_ID)
+    },
+    // For NMEA, "??" matches any talker
+    {.type = U_GNSS_PROTOCOL_NMEA, .id.pNmea = "??GGA"},
+    {.type = U_GNSS_PROTOCOL_NMEA, .id.pNmea = "??RMC"},
+    {.type = U_GNSS_PROTOCOL_NMEA, .id.pNmea = "??GSA"},
+    {.type = U_GNSS_PROTOCOL_NMEA, .id.pNmea = "??GSV"},
+    {.type = U_GNSS_PROTOCOL_NMEA, .id.pNmea = "??GST"},
+    {.type = U_GNSS_PROTOCOL_NMEA, .id.pNmea = "??VTG"},
+    {.type = U_GNSS_PROTOCOL_NMEA, .id.pNmea = "??ZDA"}
 };
 
 // MORE STATIC VARIABLES after the message decoders...
@@ -168,113 +234,316 @@ static const uGnssMessageId_t gIdList[] = {
  * STATIC FUNCTIONS: MESSAGE DECODERS
  * -------------------------------------------------------------- */
 
+// Note: since the UBX messages will have been checked for integrity
+// before they get here, no attempt is made to range-check the
+// fields: it is better to trust that the module emitted stuff
+// correctly, it knows more about this than we do.
+
 // Decode a UBX-NAV-PVT message.
-static int32_t ubxNavPvtAlloc(const char *pBuffer, size_t size,
-                              uGnssDecUnion_t **ppBody)
+static void ubxNavPvtDecode(const char *pBody, size_t length,
+                            uGnssDecUnion_t *pDecoded)
+{
+    uGnssDecUbxNavPvt_t *pPvt = &(pDecoded->ubxNavPvt);
+
+    (void) length;
+
+    pPvt->iTOW = uUbxProtocolUint32Decode(pBody + 0);
+    pPvt->year = uUbxProtocolUint16Decode(pBody + 4);
+    pPvt->month = (uint8_t) *(pBody + 6); // *NOPAD* stop AStyle making * look like a multiply
+    pPvt->day = (uint8_t) *(pBody + 7); // *NOPAD*
+    pPvt->hour = (uint8_t) *(pBody + 8); // *NOPAD*
+    pPvt->min = (uint8_t) *(pBody + 9); // *NOPAD*
+    pPvt->sec = (uint8_t) *(pBody + 10); // *NOPAD*
+    pPvt->valid = (uint8_t) *(pBody + 11); // *NOPAD*
+    pPvt->tAcc = uUbxProtocolUint32Decode(pBody + 12);
+    pPvt->nano = (int32_t) uUbxProtocolUint32Decode(pBody + 16);
+    pPvt->fixType = (uGnssDecUbxNavPvtFixType_t) *(pBody + 20); // *NOPAD*
+    pPvt->flags = (uint8_t) *(pBody + 21); // *NOPAD*
+    pPvt->flags2 = (uint8_t) *(pBody + 22); // *NOPAD*
+    pPvt->numSV = (uint8_t) *(pBody + 23); // *NOPAD*
+    pPvt->lon = (int32_t) uUbxProtocolUint32Decode(pBody + 24);
+    pPvt->lat = (int32_t) uUbxProtocolUint32Decode(pBody + 28);
+    pPvt->height = (int32_t) uUbxProtocolUint32Decode(pBody + 32);
+    pPvt->hMSL = (int32_t) uUbxProtocolUint32Decode(pBody + 36);
+    pPvt->hAcc = uUbxProtocolUint32Decode(pBody + 40);
+    pPvt->vAcc = uUbxProtocolUint32Decode(pBody + 44);
+    pPvt->velN = (int32_t) uUbxProtocolUint32Decode(pBody + 48);
+    pPvt->velE = (int32_t) uUbxProtocolUint32Decode(pBody + 52);
+    pPvt->velD = (int32_t) uUbxProtocolUint32Decode(pBody + 56);
+    pPvt->gSpeed = (int32_t) uUbxProtocolUint32Decode(pBody + 60);
+    pPvt->headMot = (int32_t) uUbxProtocolUint32Decode(pBody + 64);
+    pPvt->sAcc = uUbxProtocolUint32Decode(pBody + 68);
+    pPvt->headAcc = uUbxProtocolUint32Decode(pBody + 72);
+    pPvt->pDOP = uUbxProtocolUint16Decode(pBody + 76);
+    pPvt->flags3 = uUbxProtocolUint16Decode(pBody + 78);
+    // 4 reserved bytes here
+    pPvt->headVeh = (int32_t) uUbxProtocolUint32Decode(pBody + 84);
+    pPvt->magDec = (int16_t) uUbxProtocolUint16Decode(pBody + 88);
+    pPvt->magAcc = (int16_t) uUbxProtocolUint16Decode(pBody + 90);
+}
+
+// Decode a UBX-NAV-HPPOSLLH message.
+static void ubxNavHpposllhDecode(const char *pBody, size_t length,
+                                 uGnssDecUnion_t *pDecoded)
+{
+    uGnssDecUbxNavHpposllh_t *pHpposllh = &(pDecoded->ubxNavHpposllh);
+
+    (void) length;
+
+    pHpposllh->version = (uint8_t) *(pBody + 0); // *NOPAD* stop AStyle making * look like a multiply
+    // 2 reserved bytes here
+    pHpposllh->flags = (uint8_t) *(pBody + 3); // *NOPAD*
+    pHpposllh->iTOW = uUbxProtocolUint32Decode(pBody + 4);
+    pHpposllh->lon = (int32_t) uUbxProtocolUint32Decode(pBody + 8);
+    pHpposllh->lat = (int32_t) uUbxProtocolUint32Decode(pBody + 12);
+    pHpposllh->height = (int32_t) uUbxProtocolUint32Decode(pBody + 16);
+    pHpposllh->hMSL = (int32_t) uUbxProtocolUint32Decode(pBody + 20);
+    pHpposllh->lonHp = (int8_t) *(pBody + 24); // *NOPAD*
+    pHpposllh->latHp = (int8_t) *(pBody + 25); // *NOPAD*
+    pHpposllh->heightHp = (int8_t) *(pBody + 26); // *NOPAD*
+    pHpposllh->hMSLHp = (int8_t) *(pBody + 27); // *NOPAD*
+    pHpposllh->hAcc = uUbxProtocolUint32Decode(pBody + 28);
+    pHpposllh->vAcc = uUbxProtocolUint32Decode(pBody + 32);
+}
+
+// Decode a UBX-NAV-DOP message.
+static void ubxNavDopDecode(const char *pBody, size_t length,
+                            uGnssDecUnion_t *pDecoded)
+{
+    uGnssDecUbxNavDop_t *pDop = &(pDecoded->ubxNavDop);
+
+    (void) length;
+
+    pDop->iTOW = uUbxProtocolUint32Decode(pBody + 0);
+    pDop->gDOP = uUbxProtocolUint16Decode(pBody + 4);
+    pDop->pDOP = uUbxProtocolUint16Decode(pBody + 6);
+    pDop->tDOP = uUbxProtocolUint16Decode(pBody + 8);
+    pDop->vDOP = uUbxProtocolUint16Decode(pBody + 10);
+    pDop->hDOP = uUbxProtocolUint16Decode(pBody + 12);
+    pDop->nDOP = uUbxProtocolUint16Decode(pBody + 14);
+    pDop->eDOP = uUbxProtocolUint16Decode(pBody + 16);
+}
+
+// Decode a UBX-NAV-STATUS message.
+static void ubxNavStatusDecode(const char *pBody, size_t length,
+                               uGnssDecUnion_t *pDecoded)
+{
+    uGnssDecUbxNavStatus_t *pStatus = &(pDecoded->ubxNavStatus);
+
+    (void) length;
+
+    pStatus->iTOW = uUbxProtocolUint32Decode(pBody + 0);
+    pStatus->gpsFix = (uGnssDecUbxNavStatusGpsFix_t) *(pBody + 4); // *NOPAD* stop AStyle making * look like a multiply
+    pStatus->flags = (uint8_t) *(pBody + 5); // *NOPAD*
+    pStatus->fixStat = (uint8_t) *(pBody + 6); // *NOPAD*
+    pStatus->flags2 = (uint8_t) *(pBody + 7); // *NOPAD*
+    pStatus->ttff = uUbxProtocolUint32Decode(pBody + 8);
+    pStatus->msss = uUbxProtocolUint32Decode(pBody + 12);
+}
+
+// Decode a UBX-NAV-COV message; the floats are simply copied.
+static void ubxNavCovDecode(const char *pBody, size_t length,
+                            uGnssDecUnion_t *pDecoded)
+{
+    uGnssDecUbxNavCov_t *pCov = &(pDecoded->ubxNavCov);
+    float *pCovariance[] = {&(pCov->posCovNN), &(pCov->posCovNE), &(pCov->posCovND),
+                            &(pCov->posCovEE), &(pCov->posCovED), &(pCov->posCovDD),
+                            &(pCov->velCovNN), &(pCov->velCovNE), &(pCov->velCovND),
+                            &(pCov->velCovEE), &(pCov->velCovED), &(pCov->velCovDD)
+                           };
+    uint32_t x;
+
+    (void) length;
+
+    pCov->iTOW = uUbxProtocolUint32Decode(pBody + 0);
+    pCov->version = (uint8_t) *(pBody + 4); // *NOPAD* stop AStyle making * look like a multiply
+    pCov->posCovValid = (uint8_t) *(pBody + 5); // *NOPAD*
+    pCov->velCovValid = (uint8_t) *(pBody + 6); // *NOPAD*
+    // 9 reserved bytes here
+    for (size_t y = 0; y < sizeof(pCovariance) / sizeof(pCovariance[0]); y++) {
+        x = uUbxProtocolUint32Decode(pBody + 16 + (y * 4));
+        memcpy(pCovariance[y], &x, sizeof(x));
+    }
+}
+
+// Decode a UBX-NAV-SAT message.
+static void ubxNavSatDecode(const char *pBody, size_t length,
+                            uGnssDecUnion_t *pDecoded)
 {
-    int32_t errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-    uGnssDecUbxNavPvt_t *pBody;
+    uGnssDecUbxNavSat_t *pSat = &(pDecoded->ubxNavSat);
+    uGnssDecUbxNavSatSv_t *pSv;
+    size_t numSvs;
+
+    pSat->iTOW = uUbxProtocolUint32Decode(pBody + 0);
+    pSat->version = (uint8_t) *(pBody + 4); // *NOPAD* stop AStyle making * look like a multiply
+    numSvs = (uint8_t) *(pBody + 5); // *NOPAD*
+    // 2 reserved bytes here
+    // Don't trust numSvs beyond what we have room for or were given
+    if (numSvs > U_GNSS_DEC_UBX_NAV_SAT_MAX_NUM_SVS) {
+        numSvs = U_GNSS_DEC_UBX_NAV_SAT_MAX_NUM_SVS;
+    }
+    if (numSvs > (length - U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH) / U_GNSS_DEC_UBX_NAV_SAT_SV_LENGTH) {
+        numSvs = (length - U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH) / U_GNSS_DEC_UBX_NAV_SAT_SV_LENGTH;
+    }
+    pSat->numSvs = (uint8_t) numSvs;
+    pBody += U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH;
+    for (size_t x = 0; x < numSvs; x++) {
+        pSv = &(pSat->sv[x]);
+        pSv->gnssId = (uint8_t) *(pBody + 0); // *NOPAD*
+        pSv->svId = (uint8_t) *(pBody + 1); // *NOPAD*
+        pSv->cno = (uint8_t) *(pBody + 2); // *NOPAD*
+        pSv->elev = (int8_t) *(pBody + 3); // *NOPAD*
+        pSv->azim = (int16_t) uUbxProtocolUint16Decode(pBody + 4);
+        pSv->prRes = (int16_t) uUbxProtocolUint16Decode(pBody + 6);
+        pSv->flags = uUbxProtocolUint32Decode(pBody + 8);
+        pBody += U_GNSS_DEC_UBX_NAV_SAT_SV_LENGTH;
+    }
+}
+
+// Decode a UBX-TIM-TP message.
+static void ubxTimTpDecode(const char *pBody, size_t length,
+                           uGnssDecUnion_t *pDecoded)
+{
+    uGnssDecUbxTimTp_t *pTimTp = &(pDecoded->ubxTimTp);
+
+    (void) length;
+
+    pTimTp->towMS = uUbxProtocolUint32Decode(pBody + 0);
+    pTimTp->towSubMS = uUbxProtocolUint32Decode(pBody + 4);
+    pTimTp->qErr = (int32_t) uUbxProtocolUint32Decode(pBody + 8);
+    pTimTp->week = uUbxProtocolUint16Decode(pBody + 12);
+    pTimTp->flags = (uint8_t) *(pBody + 14); // *NOPAD* stop AStyle making * look like a multiply
+    pTimTp->refInfo = (uint8_t) *(pBody + 15); // *NOPAD*
+}
+
+/* ----------------------------------------------------------------
+ * STATIC VARIABLES: UBX DECODER LIST
+ * -------------------------------------------------------------- */
+
+/** The UBX messages that can be decoded, in any order.
+ */
+static const uGnssDecUbxDecoder_t gUbxDecoderList[] = {
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_PVT_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_PVT_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_PVT_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavPvt_t), ubxNavPvtDecode
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_HPPOSLLH_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavHpposllh_t), ubxNavHpposllhDecode
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_DOP_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavDop_t), ubxNavDopDecode
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_STATUS_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavStatus_t), ubxNavStatusDecode
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_COV_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_COV_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_COV_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavCov_t), ubxNavCovDecode
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavSat_t), ubxNavSatDecode
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_TIM_TP_MESSAGE_CLASS, U_GNSS_DEC_UBX_TIM_TP_MESSAGE_ID),
+        U_GNSS_DEC_UBX_TIM_TP_BODY_MIN_LENGTH, sizeof(uGnssDecUbxTimTp_t), ubxTimTpDecode
+    }
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: MISC
+ * -------------------------------------------------------------- */
+
+// Find the decoder for the UBX message at the start of pBuffer,
+// checking that the message is long enough for it; returns NULL,
+// with *pErrorCode set, on failure, else *pLength is set to the
+// length of the message body.
+static const uGnssDecUbxDecoder_t *pUbxDecoderGet(const char *pBuffer,
+                                                  size_t size,
+                                                  size_t *pLength,
+                                                  int32_t *pErrorCode)
+{
+    const uGnssDecUbxDecoder_t *pDecoder = NULL;
+    const uint8_t *pBufferUint8 = (const uint8_t *) pBuffer; // To avoid problems with signed char compares
+    uint16_t id;
+
+    *pErrorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    if ((size >= 2) && (*pBufferUint8 == 0xB5) && (*(pBufferUint8 + 1) == 0x62)) {
+        *pErrorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
+        if (size >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES) {
+            *pErrorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            id = U_GNSS_UBX_MESSAGE(*(pBufferUint8 + 2), *(pBufferUint8 + 3));
+            for (size_t x = 0; (pDecoder == NULL) &&
+                 (x < sizeof(gUbxDecoderList) / sizeof(gUbxDecoderList[0])); x++) {
+                if (gUbxDecoderList[x].id == id) {
+                    pDecoder = &(gUbxDecoderList[x]);
+                }
+            }
+            if (pDecoder != NULL) {
+                // Allow the checksum bytes to be omitted
+                *pLength = *(pBufferUint8 + 4) + ((size_t) *(pBufferUint8 + 5) << 8); // *NOPAD*
+                if ((*pLength < pDecoder->bodyMinLength) ||
+                    (size < *pLength + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES)) {
+                    *pErrorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
+                    pDecoder = NULL;
+                }
+            }
+        }
+    }
+
+    return pDecoder;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: ALLOCATING DECODERS
+ * -------------------------------------------------------------- */
+
+// Decode any of the UBX messages in gUbxDecoderList.
+static int32_t ubxAlloc(const char *pBuffer, size_t size,
+                        uGnssDecUnion_t **ppBody)
+{
+    int32_t errorCode;
+    const uGnssDecUbxDecoder_t *pDecoder;
+    size_t length = 0;
 
     // No need to check pBuffer or ppBody for NULLity,
     // we will never give this function NULL for those.
-    if (size >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES + U_GNSS_DEC_UBX_NAV_PVT_BODY_MIN_LENGTH) {
-        // Move past the header so that we can use payload offsets
-        // throughout, matching the offsets in the interface manual
-        pBuffer += U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
+    pDecoder = pUbxDecoderGet(pBuffer, size, &length, &errorCode);
+    if (pDecoder != NULL) {
         errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-        pBody = (uGnssDecUbxNavPvt_t *) pUPortMalloc(sizeof(uGnssDecUbxNavPvt_t));
-        if (pBody != NULL) {
-            memset(pBody, 0, sizeof(*pBody));
-            // All good now, unless we hit a field we can't decode,
-            // in which case we _could_ set U_ERROR_COMMON_BAD_DATA,
-            // but, since this message will have been checked for
-            // integrity before it gets here, it is better to trust
-            // that the module emitted stuff correctly: it knows
-            // more about this than we do
+        *ppBody = (uGnssDecUnion_t *) pUPortMalloc(pDecoder->decodedSize);
+        if (*ppBody != NULL) {
+            memset(*ppBody, 0, pDecoder->decodedSize);
+            pDecoder->pFunction(pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES,
+                                length, *ppBody);
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-            pBody->iTOW = (int32_t) uUbxProtocolUint32Decode(pBuffer + 0);
-            pBody->year = uUbxProtocolUint16Decode(pBuffer + 4);
-            pBody->month = (uint8_t) *(pBuffer + 6); // *NOPAD* stop AStyle making * look like a multiply
-            pBody->day = (uint8_t) *(pBuffer + 7); // *NOPAD*
-            pBody->hour = (uint8_t) *(pBuffer + 8); // *NOPAD*
-            pBody->min = (uint8_t) *(pBuffer + 9); // *NOPAD*
-            pBody->sec = (uint8_t) *(pBuffer + 10); // *NOPAD*
-            pBody->valid = (uint8_t) *(pBuffer + 11); // *NOPAD*
-            pBody->tAcc = uUbxProtocolUint32Decode(pBuffer + 12);
-            pBody->nano = (int32_t) uUbxProtocolUint32Decode(pBuffer + 16);
-            pBody->fixType = (uGnssDecUbxNavPvtFixType_t) *(pBuffer + 20); // *NOPAD*
-            pBody->flags = (uint8_t) *(pBuffer + 21); // *NOPAD*
-            pBody->flags2 = (uint8_t) *(pBuffer + 22); // *NOPAD*
-            pBody->numSV = (uint8_t) *(pBuffer + 23); // *NOPAD*
-            pBody->lon = (int32_t) uUbxProtocolUint32Decode(pBuffer + 24);
-            pBody->lat = (int32_t) uUbxProtocolUint32Decode(pBuffer + 28);
-            pBody->height = (int32_t) uUbxProtocolUint32Decode(pBuffer + 32);
-            pBody->hMSL = (int32_t) uUbxProtocolUint32Decode(pBuffer + 36);
-            pBody->hAcc = uUbxProtocolUint32Decode(pBuffer + 40);
-            pBody->vAcc = uUbxProtocolUint32Decode(pBuffer + 44);
-            pBody->velN = (int32_t) uUbxProtocolUint32Decode(pBuffer + 48);
-            pBody->velE = (int32_t) uUbxProtocolUint32Decode(pBuffer + 52);
-            pBody->velD = (int32_t) uUbxProtocolUint32Decode(pBuffer + 56);
-            pBody->gSpeed = (int32_t) uUbxProtocolUint32Decode(pBuffer + 60);
-            pBody->headMot = (int32_t) uUbxProtocolUint32Decode(pBuffer + 64);
-            pBody->sAcc = uUbxProtocolUint32Decode(pBuffer + 68);
-            pBody->headAcc = uUbxProtocolUint32Decode(pBuffer + 72);
-            pBody->pDOP = uUbxProtocolUint16Decode(pBuffer + 76);
-            pBody->flags3 = uUbxProtocolUint16Decode(pBuffer + 78);
-            // 4 reserved bytes here
-            pBody->headVeh = (int32_t) uUbxProtocolUint32Decode(pBuffer + 84);
-            pBody->magDec = (int16_t) uUbxProtocolUint16Decode(pBuffer + 88);
-            pBody->magAcc = (int16_t) uUbxProtocolUint16Decode(pBuffer + 90);
-
-            // Populate the pointer that was passed in
-            *ppBody = (uGnssDecUnion_t *) pBody;
         }
     }
 
     return errorCode;
 }
 
-// Decode a UBX-NAV-HPPOSLLH message.
-static int32_t ubxNavHpposllhAlloc(const char *pBuffer, size_t size,
-                                   uGnssDecUnion_t **ppBody)
+// Decode any of the NMEA sentences known to uGnssDecNmea().
+static int32_t nmeaAlloc(const char *pBuffer, size_t size,
+                         uGnssDecUnion_t **ppBody)
 {
-    int32_t errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-    uGnssDecUbxNavHpposllh_t *pBody;
+    int32_t errorCode;
+    uGnssDecNmea_t nmea;
 
     // No need to check pBuffer or ppBody for NULLity,
     // we will never give this function NULL for those.
-    if (size >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES + U_GNSS_DEC_UBX_NAV_HPPOSLLH_BODY_MIN_LENGTH) {
-        // Move past the header so that we can use payload offsets
-        // throughout, matching the offsets in the interface manual
-        pBuffer += U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
-        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-        pBody = (uGnssDecUbxNavHpposllh_t *) pUPortMalloc(sizeof(uGnssDecUbxNavHpposllh_t));
-        if (pBody != NULL) {
-            memset(pBody, 0, sizeof(*pBody));
-            // All good now, unless we hit a field we can't decode,
-            // in which case we _could_ set U_ERROR_COMMON_BAD_DATA,
-            // but, since this message will have been checked for
-            // integrity before it gets here, it is better to trust
-            // that the module emitted stuff correctly: it knows
-            // more about this than we do
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-            pBody->version = (uint8_t) *(pBuffer + 0); // *NOPAD* stop AStyle making * look like a multiply
-            // 2 reserved bytes here
-            pBody->flags = (uint8_t) *(pBuffer + 3); // *NOPAD*
-            pBody->iTOW = (int32_t) uUbxProtocolUint32Decode(pBuffer + 4);
-            pBody->lon = (int32_t) uUbxProtocolUint32Decode(pBuffer + 8);
-            pBody->lat = (int32_t) uUbxProtocolUint32Decode(pBuffer + 12);
-            pBody->height = (int32_t) uUbxProtocolUint32Decode(pBuffer + 16);
-            pBody->hMSL = (int32_t) uUbxProtocolUint32Decode(pBuffer + 20);
-            pBody->lonHp = (int8_t) *(pBuffer + 24); // *NOPAD*
-            pBody->latHp = (int8_t) *(pBuffer + 25); // *NOPAD*
-            pBody->heightHp = (int8_t) *(pBuffer + 26); // *NOPAD*
-            pBody->hMSLHp = (int8_t) *(pBuffer + 27); // *NOPAD*
-            pBody->hAcc = uUbxProtocolUint32Decode(pBuffer + 28);
-            pBody->vAcc = uUbxProtocolUint32Decode(pBuffer + 32);
-
-            // Populate the pointer that was passed in
-            *ppBody = (uGnssDecUnion_t *) pBody;
+    errorCode = uGnssDecNmea(pBuffer, size, &nmea);
+    if ((errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) ||
+        (errorCode == (int32_t) U_ERROR_COMMON_BAD_DATA)) {
+        // A decode was made, even if not a complete one
+        *ppBody = (uGnssDecUnion_t *) pUPortMalloc(sizeof(nmea.body));
+        if (*ppBody != NULL) {
+            memcpy(*ppBody, &(nmea.body), sizeof(nmea.body));
+        } else {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
         }
     }
 
@@ -290,8 +559,20 @@ static int32_t ubxNavHpposllhAlloc(const char *pBuffer, size_t size,
  * must contain the same number of elements.
  */
 static uGnssDecKnownFunction_t *gpFunctionList[] = {
-    ubxNavPvtAlloc,
-    ubxNavHpposllhAlloc
+    ubxAlloc,  // UBX-NAV-PVT
+    ubxAlloc,  // UBX-NAV-HPPOSLLH
+    ubxAlloc,  // UBX-NAV-DOP
+    ubxAlloc,  // UBX-NAV-STATUS
+    ubxAlloc,  // UBX-NAV-COV
+    ubxAlloc,  // UBX-NAV-SAT
+    ubxAlloc,  // UBX-TIM-TP
+    nmeaAlloc, // GGA
+    nmeaAlloc, // RMC
+    nmeaAlloc, // GSA
+    nmeaAlloc, // GSV
+    nmeaAlloc, // GST
+    nmeaAlloc, // VTG
+    nmeaAlloc  // ZDA
 };
 
 /* ----------------------------------------------------------------
@@ -304,6 +585,7 @@ uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size)
     uGnssDec_t *pDec = NULL;
     uint8_t *pBufferUint8 = (uint8_t *) pBuffer; // To avoid problems with signed char compares
     uGnssDecKnownFunction_t *pFunction = NULL;
+    bool userTried = false;
     size_t x;
     size_t y;
 
@@ -372,7 +654,20 @@ uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size)
                     }
                 }
             }
-            if (pDec->errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            if ((pDec->errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) &&
+                (pDec->id.type == U_GNSS_PROTOCOL_NMEA) && (gpCallback != NULL)) {
+                // The built-in NMEA decoders arrived after the user callback,
+                // so a user decoder keeps first go at NMEA sentences
+                userTried = true;
+                pDec->errorCode = gpCallback(&(pDec->id), pBuffer, size, &(pDec->pBody), gpCallbackParam);
+                if ((pDec->errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
+                    (pDec->pBody == NULL)) {
+                    // The user didn't want it, fall back to our own decoders
+                    pDec->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            }
+            if ((pDec->errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) &&
+                (pDec->pBody == NULL)) {
                 // Got a known protocol, an ID and a valid length, see if we have
                 // a decoder for this message ID
                 pDec->errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
@@ -387,7 +682,7 @@ uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size)
                 }
             }
             if ((pDec->errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
-                (gpCallback != NULL)) {
+                (gpCallback != NULL) && !userTried) {
                 // Couldn't decode the message: let the user callback try
                 pDec->errorCode = gpCallback(&(pDec->id), pBuffer, size, &(pDec->pBody), gpCallbackParam);
             }
@@ -397,6 +692,30 @@ uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size)
     return pDec;
 }
 
+// Decode a known UBX message without allocating memory.
+int32_t uGnssDecUbx(const char *pBuffer, size_t size,
+                    uGnssDecUnion_t *pBody, size_t bodySize)
+{
+    int32_t errorCodeOrId = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const uGnssDecUbxDecoder_t *pDecoder;
+    size_t length = 0;
+
+    if ((pBuffer != NULL) && (pBody != NULL)) {
+        pDecoder = pUbxDecoderGet(pBuffer, size, &length, &errorCodeOrId);
+        if (pDecoder != NULL) {
+            errorCodeOrId = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            if (bodySize >= pDecoder->decodedSize) {
+                memset(pBody, 0, pDecoder->decodedSize);
+                pDecoder->pFunction(pBuffer + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES,
+                                    length, pBody);
+                errorCodeOrId = (int32_t) pDecoder->id;
+            }
+        }
+    }
+
+    return errorCodeOrId;
+}
+
 // Free the memory returned by pUGnssDecAlloc().
 void uGnssDecFree(uGnssDec_t *pDec)
 {
@@ -0,0 +1,678 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief This file contains the NMEA sentence decoders of the
+ * uGnssDec API.  The decoders walk the sentence once, field by
+ * field, in place; numbers are converted straight to scaled
+ * integers as the digits go past.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_error_common.h"
+
+#include "u_gnss_dec_nmea.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The length of the address field of an NMEA sentence, e.g.
+ * "$GPGGA", not including the comma that follows.
+ */
+#define U_GNSS_DEC_NMEA_ADDRESS_LENGTH 6
+
+/** The number of decimal digits that can be accumulated in an
+ * int64_t without overflow.
+ */
+#define U_GNSS_DEC_NMEA_DIGITS_MAX 18
+
+/** The minimum number of fields, after the address field, of a
+ * GGA sentence.
+ */
+#define U_GNSS_DEC_NMEA_GGA_NUM_FIELDS_MIN 14
+
+/** The minimum number of fields, after the address field, of an
+ * RMC sentence (i.e. NMEA 2.1, without the mode indicator).
+ */
+#define U_GNSS_DEC_NMEA_RMC_NUM_FIELDS_MIN 11
+
+/** The minimum number of fields, after the address field, of a
+ * GSA sentence.
+ */
+#define U_GNSS_DEC_NMEA_GSA_NUM_FIELDS_MIN (2 + U_GNSS_DEC_NMEA_GSA_NUM_SV + 3)
+
+/** The minimum number of fields, after the address field, of a
+ * GSV sentence (which is what is sent when no satellites are
+ * in view).
+ */
+#define U_GNSS_DEC_NMEA_GSV_NUM_FIELDS_MIN 3
+
+/** The minimum number of fields, after the address field, of a
+ * GST sentence.
+ */
+#define U_GNSS_DEC_NMEA_GST_NUM_FIELDS_MIN 8
+
+/** The minimum number of fields, after the address field, of a
+ * VTG sentence.
+ */
+#define U_GNSS_DEC_NMEA_VTG_NUM_FIELDS_MIN 8
+
+/** The minimum number of fields, after the address field, of a
+ * ZDA sentence.
+ */
+#define U_GNSS_DEC_NMEA_ZDA_NUM_FIELDS_MIN 6
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A cursor on the fields of an NMEA sentence.
+ */
+typedef struct {
+    const char *pNext;  /**< the start of the next field, NULL when
+                             there are no more. */
+    const char *pEnd;   /**< the end of the buffer. */
+    size_t numFields;   /**< the number of fields read. */
+    int32_t errorCode;  /**< set to #U_ERROR_COMMON_BAD_DATA if
+                             any field could not be converted. */
+} uGnssDecNmeaCursor_t;
+
+/* ----------------------------------------------------------------
+ * STATIC VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The sentence formatters, in the order of #uGnssDecNmeaSentence_t.
+ */
+static const char gFormatter[][3] = {"GGA", "RMC", "GSA", "GSV", "GST", "VTG", "ZDA"};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: TOKENISING AND CONVERSION
+ * -------------------------------------------------------------- */
+
+// Get the next field: returns its length, -1 if there are no
+// more fields; the checksum and line ending, if present, are
+// not fields.
+static int32_t fieldNext(uGnssDecNmeaCursor_t *pCursor, const char **ppField)
+{
+    int32_t length = -1;
+    const char *pChar = pCursor->pNext;
+
+    if (pChar != NULL) {
+        *ppField = pChar;
+        while ((pChar < pCursor->pEnd) && (*pChar != ',') && (*pChar != '*') &&
+               (*pChar != '\r') && (*pChar != '\n')) {
+            pChar++;
+        }
+        length = (int32_t) (pChar - *ppField);
+        pCursor->pNext = NULL;
+        if ((pChar < pCursor->pEnd) && (*pChar == ',')) {
+            pCursor->pNext = pChar + 1;
+        }
+        pCursor->numFields++;
+    }
+
+    return length;
+}
+
+// Convert a decimal number to a scaled integer with the given
+// number of decimal places, truncating any further digits;
+// returns U_ERROR_COMMON_EMPTY if there is nothing to convert.
+static int32_t fixedDecode(const char *pField, int32_t length,
+                           int32_t decimals, int64_t *pValue)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_EMPTY;
+    int64_t value = 0;
+    int32_t digits = 0;
+    int32_t places = -1;
+    bool negative = false;
+
+    if (length > 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if ((*pField == '-') || (*pField == '+')) {
+            negative = (*pField == '-');
+            pField++;
+            length--;
+        }
+        for (; (length > 0) && (errorCode == 0); length--, pField++) {
+            if ((*pField >= '0') && (*pField <= '9')) {
+                if (digits >= U_GNSS_DEC_NMEA_DIGITS_MAX) {
+                    errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+                } else if (places < decimals) {
+                    value = (value * 10) + (*pField - '0');
+                    digits++;
+                    if (places >= 0) {
+                        places++;
+                    }
+                }
+            } else if ((*pField == '.') && (places < 0)) {
+                places = 0;
+            } else {
+                errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+            }
+        }
+        if (digits == 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+        }
+        if (places < 0) {
+            places = 0;
+        }
+        for (; places < decimals; places++) {
+            value *= 10;
+            digits++;
+        }
+        if (digits > U_GNSS_DEC_NMEA_DIGITS_MAX) {
+            errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+        }
+        if (negative) {
+            value = -value;
+        }
+        *pValue = value;
+    }
+
+    return errorCode;
+}
+
+// Convert a field that has been read to a scaled int32_t.
+static void fixedConvert(uGnssDecNmeaCursor_t *pCursor, const char *pField,
+                         int32_t length, int32_t decimals, int32_t *pValue)
+{
+    int64_t value;
+    int32_t errorCode;
+
+    *pValue = U_GNSS_DEC_NMEA_NOT_PRESENT;
+    if (length > 0) {
+        errorCode = fixedDecode(pField, length, decimals, &value);
+        if ((errorCode == 0) && (value > INT32_MIN) && (value <= INT32_MAX)) {
+            *pValue = (int32_t) value;
+        } else {
+            pCursor->errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+        }
+    }
+}
+
+// Read the next field as a scaled int32_t.
+static void fieldFixed(uGnssDecNmeaCursor_t *pCursor, int32_t decimals,
+                       int32_t *pValue)
+{
+    const char *pField = NULL;
+    int32_t length = fieldNext(pCursor, &pField);
+
+    fixedConvert(pCursor, pField, length, decimals, pValue);
+}
+
+// Convert a field that has been read to an int16_t, for the
+// satellite fields.
+static void int16Convert(uGnssDecNmeaCursor_t *pCursor, const char *pField,
+                         int32_t length, int16_t *pValue)
+{
+    int32_t value;
+
+    fixedConvert(pCursor, pField, length, 0, &value);
+    *pValue = U_GNSS_DEC_NMEA_NOT_PRESENT_INT16;
+    if (value != U_GNSS_DEC_NMEA_NOT_PRESENT) {
+        if ((value > INT16_MIN) && (value <= INT16_MAX)) {
+            *pValue = (int16_t) value;
+        } else {
+            pCursor->errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+        }
+    }
+}
+
+// Read the next field as an int16_t.
+static void fieldInt16(uGnssDecNmeaCursor_t *pCursor, int16_t *pValue)
+{
+    const char *pField = NULL;
+    int32_t length = fieldNext(pCursor, &pField);
+
+    int16Convert(pCursor, pField, length, pValue);
+}
+
+// Convert a field that has been read, a single hex digit, as
+// used for the NMEA 4.1 signal ID.
+static void hexConvert(uGnssDecNmeaCursor_t *pCursor, const char *pField,
+                       int32_t length, int32_t *pValue)
+{
+    *pValue = U_GNSS_DEC_NMEA_NOT_PRESENT;
+    if (length == 1) {
+        if ((*pField >= '0') && (*pField <= '9')) {
+            *pValue = *pField - '0';
+        } else if ((*pField >= 'A') && (*pField <= 'F')) {
+            *pValue = *pField - 'A' + 10;
+        }
+    }
+    if ((length > 0) && (*pValue == U_GNSS_DEC_NMEA_NOT_PRESENT)) {
+        pCursor->errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+    }
+}
+
+// Read the next field as a single character.
+static void fieldChar(uGnssDecNmeaCursor_t *pCursor, char *pValue)
+{
+    const char *pField = NULL;
+
+    *pValue = 0;
+    if (fieldNext(pCursor, &pField) > 0) {
+        *pValue = *pField;
+    }
+}
+
+// Skip a field, e.g. a units field.
+static void fieldSkip(uGnssDecNmeaCursor_t *pCursor)
+{
+    const char *pField;
+
+    fieldNext(pCursor, &pField);
+}
+
+// Read the next field as a time, hhmmss.sss, returning the
+// time of day in milliseconds.
+static void fieldTime(uGnssDecNmeaCursor_t *pCursor, int32_t *pTimeOfDayMs)
+{
+    int32_t value;
+    int32_t hours;
+    int32_t minutes;
+    int32_t secondsMs;
+
+    fieldFixed(pCursor, 3, &value);
+    *pTimeOfDayMs = U_GNSS_DEC_NMEA_NOT_PRESENT;
+    if (value != U_GNSS_DEC_NMEA_NOT_PRESENT) {
+        hours = value / 10000000;
+        minutes = (value / 100000) % 100;
+        secondsMs = value % 100000;
+        // Allow 60 seconds for a leap second
+        if ((value >= 0) && (hours < 24) && (minutes < 60) && (secondsMs < 61000)) {
+            *pTimeOfDayMs = (hours * 3600000) + (minutes * 60000) + secondsMs;
+        } else {
+            pCursor->errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+        }
+    }
+}
+
+// Read the next two fields as a latitude or longitude, (d)ddmm.mmmm
+// followed by a hemisphere, returning degrees times 1e7.
+static void fieldLatLon(uGnssDecNmeaCursor_t *pCursor, int32_t *pValueX1e7)
+{
+    const char *pField = NULL;
+    int32_t length = fieldNext(pCursor, &pField);
+    int64_t value;
+    int64_t minutesX1e7;
+    char hemisphere;
+
+    *pValueX1e7 = U_GNSS_DEC_NMEA_NOT_PRESENT;
+    if (length > 0) {
+        if ((fixedDecode(pField, length, 7, &value) == 0) && (value >= 0)) {
+            // Split into degrees and minutes
+            minutesX1e7 = value % 1000000000;
+            value = (value / 1000000000) * 10000000;
+            if ((minutesX1e7 < 600000000) && (value <= 1800000000)) {
+                *pValueX1e7 = (int32_t) (value + ((minutesX1e7 + 30) / 60));
+            } else {
+                pCursor->errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+            }
+        } else {
+            pCursor->errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+        }
+    }
+    fieldChar(pCursor, &hemisphere);
+    if ((*pValueX1e7 != U_GNSS_DEC_NMEA_NOT_PRESENT) &&
+        ((hemisphere == 'S') || (hemisphere == 'W'))) {
+        *pValueX1e7 = -*pValueX1e7;
+    }
+}
+
+// Read the next field as a speed in knots or km/h times 1000
+// and return it in millimetres per second.
+static void fieldSpeed(uGnssDecNmeaCursor_t *pCursor, bool knotsNotKmh,
+                       int32_t *pMillimetresPerSecond)
+{
+    int32_t value;
+
+    fieldFixed(pCursor, 3, &value);
+    *pMillimetresPerSecond = value;
+    if (value != U_GNSS_DEC_NMEA_NOT_PRESENT) {
+        if (knotsNotKmh) {
+            // 1 knot is 1852 metres per hour
+            *pMillimetresPerSecond = (int32_t) ((((int64_t) value) * 1852 + 1800) / 3600);
+        } else {
+            *pMillimetresPerSecond = (int32_t) ((((int64_t) value) * 10 + 18) / 36);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: SENTENCE DECODERS
+ * -------------------------------------------------------------- */
+
+// Decode the fields of a GGA sentence.
+static size_t ggaDecode(uGnssDecNmeaCursor_t *pCursor, uGnssDecNmeaGga_t *pGga)
+{
+    fieldTime(pCursor, &(pGga->timeOfDayMs));
+    fieldLatLon(pCursor, &(pGga->latitudeX1e7));
+    fieldLatLon(pCursor, &(pGga->longitudeX1e7));
+    fieldFixed(pCursor, 0, &(pGga->quality));
+    fieldFixed(pCursor, 0, &(pGga->numSv));
+    fieldFixed(pCursor, 2, &(pGga->hdopX100));
+    fieldFixed(pCursor, 3, &(pGga->altitudeMillimetres));
+    fieldSkip(pCursor);
+    fieldFixed(pCursor, 3, &(pGga->geoidSeparationMillimetres));
+    fieldSkip(pCursor);
+    fieldFixed(pCursor, 3, &(pGga->diffAgeMs));
+    fieldFixed(pCursor, 0, &(pGga->diffStation));
+
+    return U_GNSS_DEC_NMEA_GGA_NUM_FIELDS_MIN;
+}
+
+// Decode the fields of an RMC sentence.
+static size_t rmcDecode(uGnssDecNmeaCursor_t *pCursor, uGnssDecNmeaRmc_t *pRmc)
+{
+    int32_t date;
+    char hemisphere;
+
+    fieldTime(pCursor, &(pRmc->timeOfDayMs));
+    fieldChar(pCursor, &(pRmc->status));
+    fieldLatLon(pCursor, &(pRmc->latitudeX1e7));
+    fieldLatLon(pCursor, &(pRmc->longitudeX1e7));
+    fieldSpeed(pCursor, true, &(pRmc->speedMillimetresPerSecond));
+    fieldFixed(pCursor, 2, &(pRmc->courseX1e2));
+    fieldFixed(pCursor, 0, &date);
+    pRmc->day = U_GNSS_DEC_NMEA_NOT_PRESENT;
+    pRmc->month = U_GNSS_DEC_NMEA_NOT_PRESENT;
+    pRmc->year = U_GNSS_DEC_NMEA_NOT_PRESENT;
+    if (date != U_GNSS_DEC_NMEA_NOT_PRESENT) {
+        // ddmmyy
+        pRmc->day = date / 10000;
+        pRmc->month = (date / 100) % 100;
+        pRmc->year = date % 100;
+        pRmc->year += (pRmc->year < 80) ? 2000 : 1900;
+        if ((date < 0) || (pRmc->day < 1) || (pRmc->day > 31) ||
+            (pRmc->month < 1) || (pRmc->month > 12)) {
+            pCursor->errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+        }
+    }
+    fieldFixed(pCursor, 2, &(pRmc->magneticVariationX1e2));
+    fieldChar(pCursor, &hemisphere);
+    if ((pRmc->magneticVariationX1e2 != U_GNSS_DEC_NMEA_NOT_PRESENT) &&
+        (hemisphere == 'W')) {
+        pRmc->magneticVariationX1e2 = -pRmc->magneticVariationX1e2;
+    }
+    fieldChar(pCursor, &(pRmc->posMode));
+    fieldChar(pCursor, &(pRmc->navStatus));
+
+    return U_GNSS_DEC_NMEA_RMC_NUM_FIELDS_MIN;
+}
+
+// Decode the fields of a GSA sentence.
+static size_t gsaDecode(uGnssDecNmeaCursor_t *pCursor, uGnssDecNmeaGsa_t *pGsa)
+{
+    int16_t svId;
+
+    fieldChar(pCursor, &(pGsa->opMode));
+    fieldFixed(pCursor, 0, &(pGsa->navMode));
+    pGsa->numSv = 0;
+    for (size_t x = 0; x < U_GNSS_DEC_NMEA_GSA_NUM_SV; x++) {
+        fieldInt16(pCursor, &svId);
+        if (svId != U_GNSS_DEC_NMEA_NOT_PRESENT_INT16) {
+            pGsa->svId[pGsa->numSv] = svId;
+            pGsa->numSv++;
+        }
+    }
+    fieldFixed(pCursor, 2, &(pGsa->pdopX100));
+    fieldFixed(pCursor, 2, &(pGsa->hdopX100));
+    fieldFixed(pCursor, 2, &(pGsa->vdopX100));
+    fieldFixed(pCursor, 0, &(pGsa->systemId));
+
+    return U_GNSS_DEC_NMEA_GSA_NUM_FIELDS_MIN;
+}
+
+// Decode the fields of a GSV sentence; there may be up to four
+// groups of four satellite fields and then, from NMEA 4.1, a
+// single signal ID field, so a field at the start of a group
+// which turns out to be the last field is the signal ID.
+static size_t gsvDecode(uGnssDecNmeaCursor_t *pCursor, uGnssDecNmeaGsv_t *pGsv)
+{
+    uGnssDecNmeaGsvSat_t *pSat;
+    const char *pField = NULL;
+    int32_t length;
+
+    fieldFixed(pCursor, 0, &(pGsv->numMessages));
+    fieldFixed(pCursor, 0, &(pGsv->messageNumber));
+    fieldFixed(pCursor, 0, &(pGsv->numSvInView));
+    pGsv->numSat = 0;
+    pGsv->signalId = U_GNSS_DEC_NMEA_NOT_PRESENT;
+    while (pCursor->pNext != NULL) {
+        length = fieldNext(pCursor, &pField);
+        if ((pCursor->pNext == NULL) || (pGsv->numSat >= U_GNSS_DEC_NMEA_GSV_NUM_SAT)) {
+            hexConvert(pCursor, pField, length, &(pGsv->signalId));
+        } else {
+            pSat = &(pGsv->sat[pGsv->numSat]);
+            int16Convert(pCursor, pField, length, &(pSat->svId));
+            fieldInt16(pCursor, &(pSat->elevationDegrees));
+            fieldInt16(pCursor, &(pSat->azimuthDegrees));
+            fieldInt16(pCursor, &(pSat->cnoDbHz));
+            pGsv->numSat++;
+        }
+    }
+
+    return U_GNSS_DEC_NMEA_GSV_NUM_FIELDS_MIN;
+}
+
+// Decode the fields of a GST sentence.
+static size_t gstDecode(uGnssDecNmeaCursor_t *pCursor, uGnssDecNmeaGst_t *pGst)
+{
+    fieldTime(pCursor, &(pGst->timeOfDayMs));
+    fieldFixed(pCursor, 3, &(pGst->rangeRmsMillimetres));
+    fieldFixed(pCursor, 3, &(pGst->stdMajorMillimetres));
+    fieldFixed(pCursor, 3, &(pGst->stdMinorMillimetres));
+    fieldFixed(pCursor, 2, &(pGst->orientationX1e2));
+    fieldFixed(pCursor, 3, &(pGst->stdLatitudeMillimetres));
+    fieldFixed(pCursor, 3, &(pGst->stdLongitudeMillimetres));
+    fieldFixed(pCursor, 3, &(pGst->stdAltitudeMillimetres));
+
+    return U_GNSS_DEC_NMEA_GST_NUM_FIELDS_MIN;
+}
+
+// Decode the fields of a VTG sentence.
+static size_t vtgDecode(uGnssDecNmeaCursor_t *pCursor, uGnssDecNmeaVtg_t *pVtg)
+{
+    int32_t speedKmh;
+
+    fieldFixed(pCursor, 2, &(pVtg->courseTrueX1e2));
+    fieldSkip(pCursor);
+    fieldFixed(pCursor, 2, &(pVtg->courseMagneticX1e2));
+    fieldSkip(pCursor);
+    fieldSpeed(pCursor, true, &(pVtg->speedMillimetresPerSecond));
+    fieldSkip(pCursor);
+    fieldSpeed(pCursor, false, &speedKmh);
+    if (speedKmh != U_GNSS_DEC_NMEA_NOT_PRESENT) {
+        // km/h has the better resolution
+        pVtg->speedMillimetresPerSecond = speedKmh;
+    }
+    fieldSkip(pCursor);
+    fieldChar(pCursor, &(pVtg->posMode));
+
+    return U_GNSS_DEC_NMEA_VTG_NUM_FIELDS_MIN;
+}
+
+// Decode the fields of a ZDA sentence.
+static size_t zdaDecode(uGnssDecNmeaCursor_t *pCursor, uGnssDecNmeaZda_t *pZda)
+{
+    fieldTime(pCursor, &(pZda->timeOfDayMs));
+    fieldFixed(pCursor, 0, &(pZda->day));
+    fieldFixed(pCursor, 0, &(pZda->month));
+    fieldFixed(pCursor, 0, &(pZda->year));
+    fieldFixed(pCursor, 0, &(pZda->localZoneHours));
+    fieldFixed(pCursor, 0, &(pZda->localZoneMinutes));
+
+    return U_GNSS_DEC_NMEA_ZDA_NUM_FIELDS_MIN;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Decode an NMEA sentence into a structure provided by the caller.
+int32_t uGnssDecNmea(const char *pBuffer, size_t size,
+                     uGnssDecNmea_t *pNmea)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssDecNmeaCursor_t cursor;
+    char *pTalker = NULL;
+    size_t numFieldsMin = 0;
+    size_t x;
+
+    if ((pBuffer != NULL) && (pNmea != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        // The address field is "$", a two letter talker ID and the
+        // formatter; proprietary sentences, "$P...", are not supported
+        if ((size > U_GNSS_DEC_NMEA_ADDRESS_LENGTH) && (*pBuffer == '$') &&
+            (*(pBuffer + 1) >= 'A') && (*(pBuffer + 1) <= 'Z') && (*(pBuffer + 1) != 'P') &&
+            (*(pBuffer + 2) >= 'A') && (*(pBuffer + 2) <= 'Z') &&
+            (*(pBuffer + U_GNSS_DEC_NMEA_ADDRESS_LENGTH) == ',')) {
+            for (x = 0; (x < sizeof(gFormatter) / sizeof(gFormatter[0])) &&
+                 (memcmp(pBuffer + 3, gFormatter[x], sizeof(gFormatter[x])) != 0); x++) {
+            }
+            if (x < sizeof(gFormatter) / sizeof(gFormatter[0])) {
+                memset(pNmea, 0, sizeof(*pNmea));
+                pNmea->sentence = (uGnssDecNmeaSentence_t) x;
+                memset(&cursor, 0, sizeof(cursor));
+                cursor.pNext = pBuffer + U_GNSS_DEC_NMEA_ADDRESS_LENGTH + 1;
+                cursor.pEnd = pBuffer + size;
+                switch (pNmea->sentence) {
+                    case U_GNSS_DEC_NMEA_SENTENCE_GGA:
+                        pTalker = pNmea->body.gga.talker;
+                        numFieldsMin = ggaDecode(&cursor, &(pNmea->body.gga));
+                        break;
+                    case U_GNSS_DEC_NMEA_SENTENCE_RMC:
+                        pTalker = pNmea->body.rmc.talker;
+                        numFieldsMin = rmcDecode(&cursor, &(pNmea->body.rmc));
+                        break;
+                    case U_GNSS_DEC_NMEA_SENTENCE_GSA:
+                        pTalker = pNmea->body.gsa.talker;
+                        numFieldsMin = gsaDecode(&cursor, &(pNmea->body.gsa));
+                        break;
+                    case U_GNSS_DEC_NMEA_SENTENCE_GSV:
+                        pTalker = pNmea->body.gsv.talker;
+                        numFieldsMin = gsvDecode(&cursor, &(pNmea->body.gsv));
+                        break;
+                    case U_GNSS_DEC_NMEA_SENTENCE_GST:
+                        pTalker = pNmea->body.gst.talker;
+                        numFieldsMin = gstDecode(&cursor, &(pNmea->body.gst));
+                        break;
+                    case U_GNSS_DEC_NMEA_SENTENCE_VTG:
+                        pTalker = pNmea->body.vtg.talker;
+                        numFieldsMin = vtgDecode(&cursor, &(pNmea->body.vtg));
+                        break;
+                    case U_GNSS_DEC_NMEA_SENTENCE_ZDA:
+                        pTalker = pNmea->body.zda.talker;
+                        numFieldsMin = zdaDecode(&cursor, &(pNmea->body.zda));
+                        break;
+                    default:
+                        break;
+                }
+                if (pTalker != NULL) {
+                    // Null terminator is already there from the memset()
+                    *pTalker = *(pBuffer + 1);
+                    *(pTalker + 1) = *(pBuffer + 2);
+                }
+                errorCode = cursor.errorCode;
+                if (cursor.numFields < numFieldsMin) {
+                    errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Assemble a set of GSV sentences into a table of satellites.
+int32_t uGnssDecNmeaGsvAssemble(uGnssDecNmeaSatTable_t *pTable,
+                                const uGnssDecNmeaGsv_t *pGsv)
+{
+    int32_t errorCodeOrNumSat = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssDecNmeaSatTableEntry_t *pEntry;
+    int32_t signalId;
+
+    if ((pTable != NULL) && (pGsv != NULL)) {
+        errorCodeOrNumSat = (int32_t) U_ERROR_COMMON_PROTOCOL_ERROR;
+        signalId = pGsv->signalId;
+        if (signalId == U_GNSS_DEC_NMEA_NOT_PRESENT) {
+            signalId = -1;
+        }
+        if ((pGsv->messageNumber == 1) && (pGsv->numMessages >= 1)) {
+            // Start of a set: lose any incomplete set and, if this
+            // talker/signal has already been seen, begin a new table
+            if (pTable->nextMessageNumber > 0) {
+                pTable->numSat = pTable->setStart;
+            }
+            for (size_t x = 0; x < pTable->numSat; x++) {
+                pEntry = &(pTable->sat[x]);
+                if ((pEntry->signalId == signalId) &&
+                    (memcmp(pEntry->talker, pGsv->talker, sizeof(pEntry->talker)) == 0)) {
+                    pTable->numSat = 0;
+                }
+            }
+            memcpy(pTable->talker, pGsv->talker, sizeof(pTable->talker));
+            pTable->signalId = signalId;
+            pTable->numMessages = pGsv->numMessages;
+            pTable->nextMessageNumber = 1;
+            pTable->setStart = pTable->numSat;
+        }
+        if ((pTable->nextMessageNumber > 0) &&
+            (pGsv->messageNumber == pTable->nextMessageNumber) &&
+            (pGsv->numMessages == pTable->numMessages) &&
+            (signalId == pTable->signalId) &&
+            (memcmp(pGsv->talker, pTable->talker, sizeof(pTable->talker)) == 0)) {
+            for (int32_t x = 0; (x < pGsv->numSat) &&
+                 (pTable->numSat < U_GNSS_DEC_NMEA_SAT_TABLE_NUM_SAT); x++) {
+                pEntry = &(pTable->sat[pTable->numSat]);
+                memcpy(pEntry->talker, pGsv->talker, sizeof(pEntry->talker));
+                pEntry->signalId = (int16_t) signalId;
+                pEntry->sat = pGsv->sat[x];
+                pTable->numSat++;
+            }
+            pTable->nextMessageNumber++;
+            errorCodeOrNumSat = (int32_t) U_ERROR_COMMON_BUSY;
+            if (pGsv->messageNumber >= pTable->numMessages) {
+                pTable->nextMessageNumber = 0;
+                errorCodeOrNumSat = (int32_t) pTable->numSat;
+            }
+        } else if (pTable->nextMessageNumber > 0) {
+            // Out of sequence, lose the incomplete set
+            pTable->numSat = pTable->setStart;
+            pTable->nextMessageNumber = 0;
+        }
+    }
+
+    return errorCodeOrNumSat;
+}
+
+// End of file
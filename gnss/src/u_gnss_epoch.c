@@ -0,0 +1,575 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the navigation-epoch assembler of the
+ * GNSS API.
+ *
+ * Messages are captured with a single asynchronous message receiver
+ * for the whole UBX-NAV class; the message receive callback decodes
+ * each wanted message straight into the snapshot being filled and,
+ * when an epoch closes, swaps to the other snapshot and wakes the
+ * delivery task, which calls the application's callback.  Keeping
+ * the application's callback out of the message receive task means
+ * that a slow callback cannot hold up the reading of messages from
+ * the GNSS chip.  The delivery task also times out epochs for which
+ * UBX-NAV-EOE does not arrive; port timers are not used for this
+ * since they are not available on all platforms.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+
+#include "u_at_client.h" // Required by u_gnss_private.h
+
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss_private.h"
+#include "u_gnss_msg.h"
+#include "u_gnss_msg_private.h"
+#include "u_gnss_dec.h"
+#include "u_gnss_epoch.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_EPOCH_TASK_PRIORITY
+/** The priority of the epoch delivery task; the same as the GNSS
+ * asynchronous message receive task.
+ */
+# define U_GNSS_EPOCH_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
+/** The message class of all of the messages of an epoch.
+ */
+#define U_GNSS_EPOCH_UBX_NAV_MESSAGE_CLASS 0x01
+
+/** The message ID of UBX-NAV-EOE.
+ */
+#define U_GNSS_EPOCH_UBX_NAV_EOE_MESSAGE_ID 0x61
+
+/** The number of milliseconds in a GPS week, at which iTOW wraps.
+ */
+#define U_GNSS_EPOCH_WEEK_MS 604800000UL
+
+/** The body length of a UBX-NAV-PVT message.
+ */
+#define U_GNSS_EPOCH_UBX_NAV_PVT_BODY_LENGTH 92
+
+/** The length of a UBX-NAV-SAT message carrying
+ * #U_GNSS_DEC_UBX_NAV_SAT_MAX_NUM_SVS satellites.
+ */
+#define U_GNSS_EPOCH_UBX_NAV_SAT_LENGTH_MAX_BYTES (U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES +       \
+                                                  U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH +     \
+                                                  (U_GNSS_DEC_UBX_NAV_SAT_MAX_NUM_SVS *        \
+                                                   U_GNSS_DEC_UBX_NAV_SAT_SV_LENGTH))
+
+/** The size of the buffer that messages are read into: the longest
+ * of UBX-NAV-PVT and UBX-NAV-SAT, anything longer, i.e. UBX-NAV-SAT
+ * with more satellites than can be stored, is truncated.
+ */
+#if U_GNSS_EPOCH_UBX_NAV_SAT_LENGTH_MAX_BYTES > (U_GNSS_EPOCH_UBX_NAV_PVT_BODY_LENGTH + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES)
+# define U_GNSS_EPOCH_MESSAGE_LENGTH_MAX_BYTES U_GNSS_EPOCH_UBX_NAV_SAT_LENGTH_MAX_BYTES
+#else
+# define U_GNSS_EPOCH_MESSAGE_LENGTH_MAX_BYTES (U_GNSS_EPOCH_UBX_NAV_PVT_BODY_LENGTH + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES)
+#endif
+
+/** The index in gMessageList[] of UBX-NAV-EOE.
+ */
+#define U_GNSS_EPOCH_MESSAGE_INDEX_EOE ((int32_t) U_GNSS_EPOCH_MESSAGE_MAX_NUM)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Where each message of an epoch goes.
+ */
+typedef struct {
+    uint8_t id;          /**< the UBX message ID, class UBX-NAV. */
+    size_t iTowOffset;   /**< the offset of iTOW in the message body. */
+    size_t offset;       /**< the offset of the decoded message in uGnssEpoch_t. */
+    size_t size;         /**< the size of the decoded message. */
+} uGnssEpochMessageInfo_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The messages of an epoch, indexed by uGnssEpochMessage_t, with
+ * UBX-NAV-EOE on the end.
+ */
+static const uGnssEpochMessageInfo_t gMessageList[] = {
+    {
+        U_GNSS_DEC_UBX_NAV_PVT_MESSAGE_ID, 0,
+        offsetof(uGnssEpoch_t, navPvt), sizeof(uGnssDecUbxNavPvt_t)
+    },
+    {
+        U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_ID, 4,
+        offsetof(uGnssEpoch_t, navHpposllh), sizeof(uGnssDecUbxNavHpposllh_t)
+    },
+    {
+        U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_ID, 0,
+        offsetof(uGnssEpoch_t, navDop), sizeof(uGnssDecUbxNavDop_t)
+    },
+    {
+        U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_ID, 0,
+        offsetof(uGnssEpoch_t, navStatus), sizeof(uGnssDecUbxNavStatus_t)
+    },
+    {
+        U_GNSS_DEC_UBX_NAV_COV_MESSAGE_ID, 0,
+        offsetof(uGnssEpoch_t, navCov), sizeof(uGnssDecUbxNavCov_t)
+    },
+    {
+        U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_ID, 0,
+        offsetof(uGnssEpoch_t, navSat), sizeof(uGnssDecUbxNavSat_t)
+    },
+    {U_GNSS_EPOCH_UBX_NAV_EOE_MESSAGE_ID, 0, 0, 0}
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Return the index in gMessageList[] of a UBX-NAV message ID, -1
+// if it is not one of ours.
+static int32_t messageIndexGet(uint16_t ubxMessageId)
+{
+    int32_t index = -1;
+
+    if ((ubxMessageId >> 8) == U_GNSS_EPOCH_UBX_NAV_MESSAGE_CLASS) {
+        for (size_t x = 0; (x < sizeof(gMessageList) / sizeof(gMessageList[0])) &&
+             (index < 0); x++) {
+            if (gMessageList[x].id == (uint8_t) ubxMessageId) {
+                index = (int32_t) x;
+            }
+        }
+    }
+
+    return index;
+}
+
+// Return true if iTOW a is later than iTOW b, allowing for the
+// week wrap.
+static bool iTowIsLater(uint32_t a, uint32_t b)
+{
+    uint32_t difference = (a + U_GNSS_EPOCH_WEEK_MS - b) % U_GNSS_EPOCH_WEEK_MS;
+
+    return (difference > 0) && (difference < U_GNSS_EPOCH_WEEK_MS / 2);
+}
+
+// Get a pointer to one of the two snapshots.
+static uGnssEpoch_t *pSnapshotGet(const uGnssPrivateEpoch_t *pEpoch,
+                                  size_t index)
+{
+    return ((uGnssEpoch_t *) pEpoch->pSnapshot) + index;
+}
+
+// Close the epoch being filled, handing it to the delivery task if
+// that is free, else dropping it; returns true if the delivery task
+// has something to do.  pEpoch->mutexHandle must be locked.
+static bool epochClose(uGnssPrivateEpoch_t *pEpoch,
+                       uGnssEpochClosedBy_t closedBy)
+{
+    bool handedOver = false;
+    uGnssEpoch_t *pSnapshot = pSnapshotGet(pEpoch, pEpoch->fillIndex);
+
+    pEpoch->fillOpen = false;
+    pEpoch->lastValid = true;
+    pEpoch->lastITOW = pSnapshot->iTOW;
+    if (pEpoch->deliverIndex < 0) {
+        pSnapshot->closedBy = closedBy;
+        pSnapshot->closeTimeMs = uPortGetTickTimeMs();
+        pSnapshot->complete = (pSnapshot->messageBitmap == pEpoch->messageBitmap);
+        pEpoch->deliverIndex = (int32_t) pEpoch->fillIndex;
+        pEpoch->fillIndex = (pEpoch->fillIndex + 1) % 2;
+        handedOver = true;
+    } else {
+        // The callback is still busy with the previous epoch
+        pEpoch->epochsDropped++;
+    }
+
+    return handedOver;
+}
+
+// The message receive callback, called for every UBX-NAV message:
+// reads the message, works out which epoch it belongs to and
+// decodes it into the snapshot being filled.
+static void messageCallback(uDeviceHandle_t gnssHandle,
+                            const uGnssMessageId_t *pMessageId,
+                            int32_t errorCodeOrLength,
+                            void *pCallbackParam)
+{
+    uGnssPrivateEpoch_t *pEpoch = (uGnssPrivateEpoch_t *) pCallbackParam;
+    uGnssEpoch_t *pSnapshot;
+    int32_t index = -1;
+    int32_t length = errorCodeOrLength;
+    uint32_t iTOW;
+    bool wakeUp = false;
+
+    if ((errorCodeOrLength > 0) && (pMessageId->type == U_GNSS_PROTOCOL_UBX)) {
+        index = messageIndexGet(pMessageId->id.ubx);
+    }
+    if ((index == U_GNSS_EPOCH_MESSAGE_INDEX_EOE) ||
+        ((index >= 0) && ((pEpoch->messageBitmap & U_GNSS_EPOCH_MESSAGE_BIT(index)) != 0))) {
+        if (length > U_GNSS_EPOCH_MESSAGE_LENGTH_MAX_BYTES) {
+            length = U_GNSS_EPOCH_MESSAGE_LENGTH_MAX_BYTES;
+        }
+        length = uGnssMsgReceiveCallbackRead(gnssHandle, pEpoch->pMessage, length);
+        if ((length >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES) && (length < errorCodeOrLength)) {
+            // Truncated (a UBX-NAV-SAT message with more satellites
+            // than we can store): make the header match what we have
+            // so that the decoder takes the satellites that are there
+            pEpoch->pMessage[4] = (char) (length - U_UBX_PROTOCOL_HEADER_LENGTH_BYTES);
+            pEpoch->pMessage[5] = (char) ((length - U_UBX_PROTOCOL_HEADER_LENGTH_BYTES) >> 8);
+        }
+        if (length >= (int32_t) (U_UBX_PROTOCOL_HEADER_LENGTH_BYTES +
+                                 gMessageList[index].iTowOffset + sizeof(iTOW))) {
+            iTOW = uUbxProtocolUint32Decode(pEpoch->pMessage + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES +
+                                            gMessageList[index].iTowOffset);
+
+            U_PORT_MUTEX_LOCK(pEpoch->mutexHandle);
+
+            pSnapshot = pSnapshotGet(pEpoch, pEpoch->fillIndex);
+            if (pEpoch->fillOpen && iTowIsLater(iTOW, pSnapshot->iTOW)) {
+                // The first message of a new epoch: UBX-NAV-EOE for
+                // the open one must have been lost or is not enabled
+                wakeUp = epochClose(pEpoch, U_GNSS_EPOCH_CLOSED_BY_NEXT_EPOCH);
+                pSnapshot = pSnapshotGet(pEpoch, pEpoch->fillIndex);
+            }
+            if ((pEpoch->fillOpen && (iTOW != pSnapshot->iTOW)) ||
+                (!pEpoch->fillOpen && pEpoch->lastValid && !iTowIsLater(iTOW, pEpoch->lastITOW))) {
+                // A message of an epoch that has already been closed
+                if (index != U_GNSS_EPOCH_MESSAGE_INDEX_EOE) {
+                    pEpoch->messagesLate++;
+                }
+            } else if (index == U_GNSS_EPOCH_MESSAGE_INDEX_EOE) {
+                if (pEpoch->fillOpen) {
+                    wakeUp = epochClose(pEpoch, U_GNSS_EPOCH_CLOSED_BY_EOE) || wakeUp;
+                } else {
+                    // None of our messages were in this epoch but
+                    // any that turn up now are still late
+                    pEpoch->lastValid = true;
+                    pEpoch->lastITOW = iTOW;
+                }
+            } else {
+                if (!pEpoch->fillOpen) {
+                    memset(pSnapshot, 0, sizeof(*pSnapshot));
+                    pSnapshot->iTOW = iTOW;
+                    pSnapshot->openTimeMs = uPortGetTickTimeMs();
+                    pEpoch->fillOpen = true;
+                    // Wake the delivery task so that it starts
+                    // timing the epoch
+                    wakeUp = true;
+                }
+                if (uGnssDecUbx(pEpoch->pMessage, length,
+                                (uGnssDecUnion_t *) (((char *) pSnapshot) + gMessageList[index].offset),
+                                gMessageList[index].size) >= 0) {
+                    pSnapshot->messageBitmap |= U_GNSS_EPOCH_MESSAGE_BIT(index);
+                }
+            }
+
+            U_PORT_MUTEX_UNLOCK(pEpoch->mutexHandle);
+
+            if (wakeUp) {
+                uPortSemaphoreGive(pEpoch->wakeSemaphoreHandle);
+            }
+        }
+    }
+}
+
+// The delivery task: waits to be woken, or for the open epoch to
+// time out, and calls the application's callback with any closed
+// epoch.  It never locks gUGnssPrivateMutex:
+// uGnssPrivateCleanUpEpoch(), which is called with gUGnssPrivateMutex
+// locked, waits for it to exit.
+static void deliveryTask(void *pParameter)
+{
+    uGnssPrivateEpoch_t *pEpoch = (uGnssPrivateEpoch_t *) pParameter;
+    uGnssEpoch_t *pSnapshot;
+    int32_t waitMs;
+    int32_t index;
+    int32_t latencyMs;
+
+    U_PORT_MUTEX_LOCK(pEpoch->taskRunningMutexHandle);
+    pEpoch->taskRunning = true;
+
+    while (!pEpoch->taskStop) {
+
+        U_PORT_MUTEX_LOCK(pEpoch->mutexHandle);
+
+        waitMs = -1;
+        if (pEpoch->fillOpen) {
+            pSnapshot = pSnapshotGet(pEpoch, pEpoch->fillIndex);
+            waitMs = pEpoch->timeoutMs - (uPortGetTickTimeMs() - pSnapshot->openTimeMs);
+            if (waitMs < 0) {
+                waitMs = 0;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(pEpoch->mutexHandle);
+
+        if (waitMs >= 0) {
+            uPortSemaphoreTryTake(pEpoch->wakeSemaphoreHandle, waitMs);
+        } else {
+            uPortSemaphoreTake(pEpoch->wakeSemaphoreHandle);
+        }
+
+        U_PORT_MUTEX_LOCK(pEpoch->mutexHandle);
+
+        // Only time out the open epoch once any epoch already
+        // closed has been delivered, otherwise it would be dropped
+        if ((pEpoch->deliverIndex < 0) && pEpoch->fillOpen) {
+            pSnapshot = pSnapshotGet(pEpoch, pEpoch->fillIndex);
+            if (uPortGetTickTimeMs() - pSnapshot->openTimeMs >= pEpoch->timeoutMs) {
+                epochClose(pEpoch, U_GNSS_EPOCH_CLOSED_BY_TIMEOUT);
+            }
+        }
+        index = pEpoch->deliverIndex;
+
+        U_PORT_MUTEX_UNLOCK(pEpoch->mutexHandle);
+
+        if ((index >= 0) && !pEpoch->taskStop) {
+            // The message receive callback won't touch this
+            // snapshot until deliverIndex is reset
+            pSnapshot = pSnapshotGet(pEpoch, index);
+            latencyMs = uPortGetTickTimeMs() - pSnapshot->closeTimeMs;
+            ((uGnssEpochCallback_t) pEpoch->pCallback)(pEpoch->gnssHandle, pSnapshot,
+                                                       pEpoch->pCallbackParam);
+
+            U_PORT_MUTEX_LOCK(pEpoch->mutexHandle);
+
+            pEpoch->epochsDelivered++;
+            if (!pSnapshot->complete) {
+                pEpoch->epochsIncomplete++;
+            }
+            if (pSnapshot->closedBy == U_GNSS_EPOCH_CLOSED_BY_TIMEOUT) {
+                pEpoch->epochsTimedOut++;
+            }
+            pEpoch->latencyLastMs = latencyMs;
+            pEpoch->latencyTotalMs += latencyMs;
+            if (latencyMs > pEpoch->latencyMaxMs) {
+                pEpoch->latencyMaxMs = latencyMs;
+            }
+            pEpoch->deliverIndex = -1;
+
+            U_PORT_MUTEX_UNLOCK(pEpoch->mutexHandle);
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pEpoch->taskRunningMutexHandle);
+
+    uPortTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Start the navigation-epoch assembler.
+int32_t uGnssEpochStart(uDeviceHandle_t gnssHandle,
+                        uint32_t messageBitmap, int32_t timeoutMs,
+                        uGnssEpochCallback_t pCallback,
+                        void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateEpoch_t *pEpoch;
+    uGnssPrivateMessageId_t privateMessageId = {.type = U_GNSS_PROTOCOL_UBX,
+                                                .id = {.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_EPOCH_UBX_NAV_MESSAGE_CLASS,
+                                                                                 U_GNSS_UBX_MESSAGE_ID_ALL)}
+                                               };
+
+    if (timeoutMs == 0) {
+        timeoutMs = U_GNSS_EPOCH_TIMEOUT_MS;
+    }
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pCallback != NULL) && (timeoutMs > 0) &&
+            (messageBitmap != 0) &&
+            ((messageBitmap >> U_GNSS_EPOCH_MESSAGE_MAX_NUM) == 0)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (uGnssPrivateGetStreamType(pInstance->transportType) >= 0) {
+                // Get rid of any existing assembler
+                uGnssPrivateCleanUpEpoch(pInstance);
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                pEpoch = (uGnssPrivateEpoch_t *) pUPortMalloc(sizeof(*pEpoch));
+                if (pEpoch != NULL) {
+                    memset(pEpoch, 0, sizeof(*pEpoch));
+                    pEpoch->gnssHandle = gnssHandle;
+                    pEpoch->asyncHandle = -1;
+                    pEpoch->pCallback = (void *) pCallback;
+                    pEpoch->pCallbackParam = pCallbackParam;
+                    pEpoch->messageBitmap = messageBitmap;
+                    pEpoch->timeoutMs = timeoutMs;
+                    pEpoch->deliverIndex = -1;
+                    pEpoch->pMessage = (char *) pUPortMalloc(U_GNSS_EPOCH_MESSAGE_LENGTH_MAX_BYTES);
+                    pEpoch->pSnapshot = pUPortMalloc(sizeof(uGnssEpoch_t) * 2);
+                    if ((pEpoch->pMessage != NULL) && (pEpoch->pSnapshot != NULL)) {
+                        errorCode = uPortMutexCreate(&(pEpoch->mutexHandle));
+                        if (errorCode == 0) {
+                            errorCode = uPortMutexCreate(&(pEpoch->taskRunningMutexHandle));
+                            if (errorCode == 0) {
+                                errorCode = uPortSemaphoreCreate(&(pEpoch->wakeSemaphoreHandle),
+                                                                 0, 1);
+                                if (errorCode == 0) {
+                                    errorCode = uPortTaskCreate(deliveryTask, "gnssEpoch",
+                                                                U_GNSS_EPOCH_TASK_STACK_SIZE_BYTES,
+                                                                pEpoch, U_GNSS_EPOCH_TASK_PRIORITY,
+                                                                &(pEpoch->taskHandle));
+                                    if (errorCode == 0) {
+                                        // Wait for the task to be running so that
+                                        // uGnssPrivateCleanUpEpoch() can rely on
+                                        // taskRunningMutexHandle
+                                        while (!pEpoch->taskRunning) {
+                                            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                                        }
+                                    } else {
+                                        uPortSemaphoreDelete(pEpoch->wakeSemaphoreHandle);
+                                    }
+                                }
+                                if (errorCode != 0) {
+                                    uPortMutexDelete(pEpoch->taskRunningMutexHandle);
+                                }
+                            }
+                            if (errorCode != 0) {
+                                uPortMutexDelete(pEpoch->mutexHandle);
+                            }
+                        }
+                    }
+                    if (errorCode == 0) {
+                        // From here on uGnssPrivateCleanUpEpoch() does
+                        // the tidying up
+                        pInstance->pEpoch = pEpoch;
+                        errorCode = uGnssMsgPrivateReceiveStart(pInstance,
+                                                                &privateMessageId,
+                                                                messageCallback,
+                                                                pEpoch);
+                        if (errorCode >= 0) {
+                            pEpoch->asyncHandle = errorCode;
+                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                        } else {
+                            uGnssPrivateCleanUpEpoch(pInstance);
+                        }
+                    } else {
+                        // Clean up on error
+                        uPortFree(pEpoch->pMessage);
+                        uPortFree(pEpoch->pSnapshot);
+                        uPortFree(pEpoch);
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the statistics of the navigation-epoch assembler.
+int32_t uGnssEpochGetStats(uDeviceHandle_t gnssHandle,
+                           uGnssEpochStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateEpoch_t *pEpoch;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pStats != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+            pEpoch = pInstance->pEpoch;
+            if (pEpoch != NULL) {
+
+                U_PORT_MUTEX_LOCK(pEpoch->mutexHandle);
+
+                memset(pStats, 0, sizeof(*pStats));
+                pStats->epochsDelivered = pEpoch->epochsDelivered;
+                pStats->epochsIncomplete = pEpoch->epochsIncomplete;
+                pStats->epochsTimedOut = pEpoch->epochsTimedOut;
+                pStats->epochsDropped = pEpoch->epochsDropped;
+                pStats->messagesLate = pEpoch->messagesLate;
+                pStats->latencyLastMs = pEpoch->latencyLastMs;
+                pStats->latencyMaxMs = pEpoch->latencyMaxMs;
+                if (pEpoch->epochsDelivered > 0) {
+                    pStats->latencyAverageMs = (int32_t) (pEpoch->latencyTotalMs /
+                                                          (int64_t) pEpoch->epochsDelivered);
+                }
+
+                U_PORT_MUTEX_UNLOCK(pEpoch->mutexHandle);
+
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Stop the navigation-epoch assembler.
+void uGnssEpochStop(uDeviceHandle_t gnssHandle)
+{
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            uGnssPrivateCleanUpEpoch(pInstance);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+}
+
+// End of file
@@ -149,8 +149,6 @@ static int32_t posDecode(char *pMessage,
                          int32_t *pSvs, int64_t *pTimeUtc, bool printIt)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
-    int32_t months;
-    int32_t year;
     int32_t y;
     int64_t t = -1;
 
@@ -158,22 +156,12 @@ static int32_t posDecode(char *pMessage,
         // Time and date are valid; we don't indicate
         // success based on this but we report it anyway
         // if it is valid
-        t = 0;
-        // Year is 1999-2099, so need to adjust to get year since 1970
-        year = ((int32_t) uUbxProtocolUint16Decode(pMessage + 4) - 1999) + 29;
-        // Month (1 to 12), so take away 1 to make it zero-based
-        months = *(pMessage + 6) - 1;
-        months += year * 12;
-        // Work out the number of seconds due to the year/month count
-        t += uTimeMonthsToSecondsUtc(months);
-        // Day (1 to 31)
-        t += ((int32_t) * (pMessage + 7) - 1) * 3600 * 24;
-        // Hour (0 to 23)
-        t += ((int32_t) * (pMessage + 8)) * 3600;
-        // Minute (0 to 59)
-        t += ((int32_t) * (pMessage + 9)) * 60;
-        // Second (0 to 60)
-        t += *(pMessage + 10);
+        // Year (1999 to 2099), month (1 to 12), day (1 to 31),
+        // hour (0 to 23), minute (0 to 59), second (0 to 60)
+        t = uTimeToSecondsUtc((int32_t) uUbxProtocolUint16Decode(pMessage + 4),
+                              *(pMessage + 6), *(pMessage + 7),
+                              *(pMessage + 8), *(pMessage + 9),
+                              *(pMessage + 10));
         if (printIt) {
             uPortLog("U_GNSS_POS: UTC time = %d.\n", (int32_t) t);
         }
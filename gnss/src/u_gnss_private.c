@@ -780,6 +780,12 @@ static int32_t parseUbx(uParseHandle_t parseHandle, void *pUserParam)
     cka += by;
     ckb += cka;
     l += (((uint16_t) by) << 8);
+    if (l + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES > U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES) {
+        // A message this long could never fit into the ring buffer,
+        // so waiting for it would stall parsing for good: this must
+        // be a corrupted header
+        return U_ERROR_COMMON_NOT_FOUND;
+    }
     if (l > uRingBufferBytesAvailableUnprotected(parseHandle)) {
         return U_ERROR_COMMON_TIMEOUT;
     }
@@ -954,6 +960,10 @@ static int32_t parseRtcm(uParseHandle_t parseHandle, void *pUserParam)
     // Length includes the two-byte message ID and the message
     // body, i.e. up to the start of the 3-byte CRC, i.e.
     // the total message length - 6.
+    if (l < 2) {
+        // Too short to contain a message ID
+        return U_ERROR_COMMON_NOT_FOUND;
+    }
     if (l > uRingBufferBytesAvailableUnprotected(parseHandle) + 3) {
         return U_ERROR_COMMON_TIMEOUT;
     }
@@ -974,11 +984,15 @@ static int32_t parseRtcm(uParseHandle_t parseHandle, void *pUserParam)
         uRingBufferGetByteUnprotected(parseHandle, &by);
         crc = RTCM_CRC(crc, by);
     }
-    // Compare CRC
-    for (int32_t x = 2; (x >= 0) && uRingBufferGetByteUnprotected(parseHandle, &by); x--) {
-        if (by != (uint8_t) (crc >> (8 * x))) {
+    // Compare CRC; a mismatch means this is not an RTCM message,
+    // waiting for more data would not change that
+    for (int32_t x = 2; x >= 0; x--) {
+        if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
             return U_ERROR_COMMON_TIMEOUT;
         }
+        if (by != (uint8_t) (crc >> (8 * x))) {
+            return U_ERROR_COMMON_NOT_FOUND;
+        }
     }
     // We can only claim this as an RTCM-format message if
     // there was nothing that needed discarding first.
@@ -1668,6 +1682,61 @@ void uGnssPrivateCleanUpPosTask(uGnssPrivateInstance_t *pInstance)
     }
 }
 
+// Shut down and free memory from a correction-data pump.
+void uGnssPrivateCleanUpCorr(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPrivateCorr_t *pCorr;
+
+    if ((pInstance != NULL) && (pInstance->pCorr != NULL)) {
+        pCorr = pInstance->pCorr;
+        // Make the writer task exit and wait for it to do so
+        pCorr->taskStop = true;
+        uPortSemaphoreGive(pCorr->wakeSemaphoreHandle);
+        U_PORT_MUTEX_LOCK(pCorr->taskRunningMutexHandle);
+        U_PORT_MUTEX_UNLOCK(pCorr->taskRunningMutexHandle);
+        // Let it actually go
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        uPortMutexDelete(pCorr->taskRunningMutexHandle);
+        uPortSemaphoreDelete(pCorr->wakeSemaphoreHandle);
+        uPortMutexDelete(pCorr->mutexHandle);
+        uRingBufferDelete(&(pCorr->queue));
+        uPortFree(pCorr->pLinearBuffer);
+        uPortFree(pCorr->pMessage);
+        uPortFree(pCorr->pSpiBuffer);
+        uPortFree(pCorr);
+        pInstance->pCorr = NULL;
+    }
+}
+
+// Shut down and free memory from a navigation-epoch assembler.
+void uGnssPrivateCleanUpEpoch(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPrivateEpoch_t *pEpoch;
+
+    if ((pInstance != NULL) && (pInstance->pEpoch != NULL)) {
+        pEpoch = pInstance->pEpoch;
+        // Stop messages arriving first: once this returns the
+        // message receive callback is no longer running
+        if (pEpoch->asyncHandle >= 0) {
+            uGnssMsgPrivateReceiveStop(pInstance, pEpoch->asyncHandle);
+        }
+        // Make the delivery task exit and wait for it to do so
+        pEpoch->taskStop = true;
+        uPortSemaphoreGive(pEpoch->wakeSemaphoreHandle);
+        U_PORT_MUTEX_LOCK(pEpoch->taskRunningMutexHandle);
+        U_PORT_MUTEX_UNLOCK(pEpoch->taskRunningMutexHandle);
+        // Let it actually go
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        uPortMutexDelete(pEpoch->taskRunningMutexHandle);
+        uPortSemaphoreDelete(pEpoch->wakeSemaphoreHandle);
+        uPortMutexDelete(pEpoch->mutexHandle);
+        uPortFree(pEpoch->pMessage);
+        uPortFree(pEpoch->pSnapshot);
+        uPortFree(pEpoch);
+        pInstance->pEpoch = NULL;
+    }
+}
+
 // Shut down and free memory from a running streamed position.
 void uGnssPrivateCleanUpStreamedPos(uGnssPrivateInstance_t *pInstance)
 {
@@ -227,6 +227,67 @@ typedef struct {
     int32_t errorCode;
 } uGnssPrivateMga_t;
 
+/** The correction-data pump, see u_gnss_corr.c.
+ */
+typedef struct {
+    uPortTaskHandle_t taskHandle;
+    uPortMutexHandle_t taskRunningMutexHandle; /**< held by the writer task while it runs. */
+    volatile bool taskRunning;
+    volatile bool taskStop;
+    uPortSemaphoreHandle_t wakeSemaphoreHandle; /**< given to wake the writer task. */
+    uPortMutexHandle_t mutexHandle; /**< protects the queue and the statistics. */
+    uRingBuffer_t queue;
+    char *pLinearBuffer;
+    char *pMessage;   /**< where the writer task puts the message it is sending. */
+    char *pSpiBuffer; /**< for what is received while sending, SPI only. */
+    bool dropOldest;
+    int32_t startTimeMs;
+    size_t messagesQueued;
+    size_t messagesSent;
+    size_t messagesDropped;
+    size_t bytesRejected;
+    size_t bytesSent;
+    size_t sendErrors;
+    size_t queueHighWaterBytes;
+    int32_t ageLastMs;
+    int32_t ageMaxMs;
+    int64_t ageTotalMs;
+} uGnssPrivateCorr_t;
+
+/** The navigation-epoch assembler, see u_gnss_epoch.c.
+ */
+typedef struct {
+    uDeviceHandle_t gnssHandle; /**< the handle passed to uGnssEpochStart(). */
+    int32_t asyncHandle; /**< the handle of the message receiver, -1 if there isn't one. */
+    uPortTaskHandle_t taskHandle;
+    uPortMutexHandle_t taskRunningMutexHandle; /**< held by the delivery task while it runs. */
+    volatile bool taskRunning;
+    volatile bool taskStop;
+    uPortSemaphoreHandle_t wakeSemaphoreHandle; /**< given to wake the delivery task. */
+    uPortMutexHandle_t mutexHandle; /**< protects the snapshots and the statistics. */
+    void *pCallback; /**< stored as a void * to avoid bringing the types
+                          of u_gnss_epoch.h into everything. */
+    void *pCallbackParam;
+    uint32_t messageBitmap;
+    int32_t timeoutMs;
+    char *pMessage;  /**< where the message receive callback reads messages. */
+    void *pSnapshot; /**< two uGnssEpoch_t, one being filled while the
+                          other is delivered. */
+    size_t fillIndex;
+    bool fillOpen;
+    int32_t deliverIndex; /**< the snapshot waiting to be or being delivered, -1 if none. */
+    bool lastValid;
+    uint32_t lastITOW; /**< the iTOW of the last epoch closed. */
+    size_t epochsDelivered;
+    size_t epochsIncomplete;
+    size_t epochsTimedOut;
+    size_t epochsDropped;
+    size_t messagesLate;
+    int32_t latencyLastMs;
+    int32_t latencyMaxMs;
+    int64_t latencyTotalMs;
+} uGnssPrivateEpoch_t;
+
 /** Definition of a GNSS instance.
  * Note: a pointer to this structure is passed to the asynchronous
  * "get position" function (posGetTask()) which does NOT lock the
@@ -273,6 +334,8 @@ typedef struct uGnssPrivateInstance_t {
     uGnssRrlpMode_t rrlpMode; /**< The type of MEASX to use with RRLP capture. */
     uGnssPrivateMga_t *pMga; /**< Storage for AssistNow. */
     void *pFenceContext; /**< Storage for a uGeofenceContext_t. */
+    uGnssPrivateCorr_t *pCorr; /**< The correction-data pump, if started. */
+    uGnssPrivateEpoch_t *pEpoch; /**< The navigation-epoch assembler, if started. */
     struct uGnssPrivateInstance_t *pNext;
 } uGnssPrivateInstance_t;
 // *INDENT-ON*
@@ -501,6 +564,24 @@ void uGnssPrivateCleanUpPosTask(uGnssPrivateInstance_t *pInstance);
  */
 void uGnssPrivateCleanUpStreamedPos(uGnssPrivateInstance_t *pInstance);
 
+/** Stop the correction-data pump, if there is one, and free its
+ * memory; the writer task does not lock gUGnssPrivateMutex.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot  be NULL.
+ */
+void uGnssPrivateCleanUpCorr(uGnssPrivateInstance_t *pInstance);
+
+/** Stop the navigation-epoch assembler, if there is one, and free
+ * its memory; the delivery task does not lock gUGnssPrivateMutex.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot  be NULL.
+ */
+void uGnssPrivateCleanUpEpoch(uGnssPrivateInstance_t *pInstance);
+
 /** Check whether a GNSS chip that we are using via a cellular module
  * is on-board the cellular module, in which case the AT+GPIOC
  * comands are not used.
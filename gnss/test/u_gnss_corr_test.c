@@ -0,0 +1,607 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the correction-data pump of the GNSS API.  No GNSS
+ * chip is required: the GNSS instance is on UART A and the "GNSS chip"
+ * is a sink task on UART B which checks and times what arrives.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()/memcpy()/memmove()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_at_client.h" // Required by u_gnss_private.h
+
+#include "u_ringbuffer.h"
+
+#include "u_spartn_crc.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_msg.h"
+#include "u_gnss_corr.h"
+#include "u_gnss_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The base string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX_BASE "U_GNSS_CORR_TEST"
+
+/** The string to put at the start of all prints from this test
+ * that do not require an iteration on the end.
+ */
+#define U_TEST_PREFIX U_TEST_PREFIX_BASE ": "
+
+/** Print a whole line, with terminator, prefixed for this test
+ * file, no iteration version.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_GNSS_CORR_TEST_NUM_MESSAGES
+/** The number of RTCM3 messages the producer sends in the
+ * gnssCorrBenchmark test.
+ */
+# define U_GNSS_CORR_TEST_NUM_MESSAGES 2000
+#endif
+
+#ifndef U_GNSS_CORR_TEST_EPOCH_MESSAGES
+/** The number of RTCM3 messages the producer sends in one go,
+ * like the burst of messages an NTRIP caster sends each epoch.
+ */
+# define U_GNSS_CORR_TEST_EPOCH_MESSAGES 10
+#endif
+
+#ifndef U_GNSS_CORR_TEST_EPOCH_PERIOD_MS
+/** The time between the bursts of messages from the producer.
+ */
+# define U_GNSS_CORR_TEST_EPOCH_PERIOD_MS 20
+#endif
+
+#ifndef U_GNSS_CORR_TEST_COMMAND_PERIOD_MS
+/** The time between the "commands" the gnssCorrBenchmark test
+ * sends to the GNSS chip while corrections are flowing.
+ */
+# define U_GNSS_CORR_TEST_COMMAND_PERIOD_MS 10
+#endif
+
+#ifndef U_GNSS_CORR_TEST_SINK_BUFFER_LENGTH_BYTES
+/** The size of the buffer of the sink.
+ */
+# define U_GNSS_CORR_TEST_SINK_BUFFER_LENGTH_BYTES 2048
+#endif
+
+/** The length of the UBX-MON-VER poll used as a command.
+ */
+#define U_GNSS_CORR_TEST_COMMAND_LENGTH_BYTES 8
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** The state of the sink, pretending to be a GNSS chip on UART B.
+ */
+typedef struct {
+    int32_t uartHandle;
+    volatile bool stop;     /**< set this to stop the sink task. */
+    volatile bool stopped;  /**< set by the sink task when it has stopped. */
+    char buffer[U_GNSS_CORR_TEST_SINK_BUFFER_LENGTH_BYTES];
+    size_t length;
+    volatile size_t messages;    /**< the number of valid RTCM3 messages received. */
+    volatile size_t otherBytes;  /**< the number of bytes that were not RTCM3. */
+    volatile int32_t lastSequence; /**< the sequence number of the last message. */
+    volatile int32_t totalLatencyMs;
+    volatile int32_t maxLatencyMs;
+} uGnssCorrTestSink_t;
+#endif
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Handle of UART A, on which the GNSS instance is.
+ */
+static int32_t gUartAHandle = -1;
+
+/** The sink, on UART B.
+ */
+static uGnssCorrTestSink_t *gpSink = NULL;
+
+/** The GNSS handle.
+ */
+static uDeviceHandle_t gGnssHandle = NULL;
+
+/** The handle of the correction-data pump.
+ */
+static uGnssCorrHandle_t gCorrHandle = NULL;
+
+/** Set by the producer task when it has finished.
+ */
+static volatile bool gProducerDone = false;
+#endif
+
+/** UBX-MON-VER poll, used as a command in the gnssCorrBenchmark test.
+ */
+static const char gCommand[U_GNSS_CORR_TEST_COMMAND_LENGTH_BYTES] = {0xb5, 0x62, 0x0a, 0x04,
+                                                                     0x00, 0x00, 0x0e, 0x34
+                                                                    };
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Encode an RTCM3 message, type 1005 for the sake of it, of the
+// given body length (at least 10), carrying a sequence number and
+// a time-stamp; returns the length of the encoded message.
+static size_t rtcmEncode(char *pBuffer, size_t bodyLength,
+                         int32_t sequence, int32_t timeMs)
+{
+    uint32_t crc;
+
+    pBuffer[0] = (char) 0xD3;
+    pBuffer[1] = (char) ((bodyLength >> 8) & 0x03);
+    pBuffer[2] = (char) bodyLength;
+    pBuffer[3] = (char) 0x3E;
+    pBuffer[4] = (char) 0xD0;
+    memcpy(pBuffer + 5, &sequence, sizeof(sequence));
+    memcpy(pBuffer + 9, &timeMs, sizeof(timeMs));
+    for (size_t x = 13; x < bodyLength + 3; x++) {
+        pBuffer[x] = (char) x;
+    }
+    crc = uSpartnCrc24(pBuffer, bodyLength + 3);
+    pBuffer[bodyLength + 3] = (char) (crc >> 16);
+    pBuffer[bodyLength + 4] = (char) (crc >> 8);
+    pBuffer[bodyLength + 5] = (char) crc;
+
+    return bodyLength + 6;
+}
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+// Task that pretends to be a GNSS chip on UART B: it counts the
+// RTCM3 messages that arrive, timing them from the time-stamp
+// the producer put in them, and counts anything else.
+static void sinkTask(void *pParameter)
+{
+    uGnssCorrTestSink_t *pSink = (uGnssCorrTestSink_t *) pParameter;
+    int32_t x;
+    int32_t y;
+    int32_t timeMs;
+    size_t offset;
+
+    while (!pSink->stop) {
+        x = uPortUartRead(pSink->uartHandle, pSink->buffer + pSink->length,
+                          sizeof(pSink->buffer) - pSink->length);
+        if (x > 0) {
+            pSink->length += x;
+            offset = 0;
+            x = 0;
+            while ((offset < pSink->length) && (x != (int32_t) U_ERROR_COMMON_TIMEOUT)) {
+                x = uGnssCorrMessageCheck(pSink->buffer + offset,
+                                          pSink->length - offset);
+                if (x > 0) {
+                    memcpy(&y, pSink->buffer + offset + 5, sizeof(y));
+                    memcpy(&timeMs, pSink->buffer + offset + 9, sizeof(timeMs));
+                    pSink->lastSequence = y;
+                    timeMs = uPortGetTickTimeMs() - timeMs;
+                    pSink->totalLatencyMs += timeMs;
+                    if (timeMs > pSink->maxLatencyMs) {
+                        pSink->maxLatencyMs = timeMs;
+                    }
+                    pSink->messages++;
+                    offset += x;
+                } else if (x != (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                    pSink->otherBytes++;
+                    offset++;
+                }
+            }
+            pSink->length -= offset;
+            memmove(pSink->buffer, pSink->buffer + offset, pSink->length);
+            if (pSink->length == sizeof(pSink->buffer)) {
+                pSink->length = 0;
+            }
+        } else {
+            uPortTaskBlock(1);
+        }
+    }
+
+    pSink->stopped = true;
+    uPortTaskDelete(NULL);
+}
+
+// Task that pretends to be a stream of corrections from the network:
+// a burst of RTCM3 messages of varying length every
+// U_GNSS_CORR_TEST_EPOCH_PERIOD_MS, pushed in chunks that do not
+// line up with the message boundaries, as they would from a TCP
+// socket.
+static void producerTask(void *pParameter)
+{
+    char *pBuffer = (char *) pParameter;
+    size_t length = 0;
+    size_t chunk;
+    int32_t x;
+    int32_t sequence = 0;
+
+    while (sequence < U_GNSS_CORR_TEST_NUM_MESSAGES) {
+        for (size_t y = 0; (y < U_GNSS_CORR_TEST_EPOCH_MESSAGES) &&
+             (sequence < U_GNSS_CORR_TEST_NUM_MESSAGES); y++) {
+            length += rtcmEncode(pBuffer + length, 20 + ((sequence * 37) % 200),
+                                 sequence, uPortGetTickTimeMs());
+            sequence++;
+        }
+        // Push in chunks of 100 bytes, keeping what is not consumed
+        while (length > 0) {
+            chunk = length;
+            if (chunk > 100) {
+                chunk = 100;
+            }
+            x = uGnssCorrPush(gCorrHandle, pBuffer, chunk);
+            if ((x <= 0) && (chunk == length)) {
+                // Nothing more to be done
+                break;
+            }
+            if (x > 0) {
+                length -= x;
+                memmove(pBuffer, pBuffer + x, length);
+            } else {
+                // Push a bigger chunk to complete the message
+                x = uGnssCorrPush(gCorrHandle, pBuffer, length);
+                if (x > 0) {
+                    length -= x;
+                    memmove(pBuffer, pBuffer + x, length);
+                }
+            }
+        }
+        uPortTaskBlock(U_GNSS_CORR_TEST_EPOCH_PERIOD_MS);
+    }
+
+    gProducerDone = true;
+    uPortTaskDelete(NULL);
+}
+
+// Open the UARTs, start the sink and add a GNSS instance.
+static void openAll()
+{
+    uPortTaskHandle_t taskHandle;
+    uGnssTransportHandle_t transportHandle;
+
+    gpSink = (uGnssCorrTestSink_t *) pUPortMalloc(sizeof(*gpSink));
+    U_PORT_TEST_ASSERT(gpSink != NULL);
+    memset(gpSink, 0, sizeof(*gpSink));
+    gpSink->lastSequence = -1;
+
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+    gpSink->uartHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                       U_CFG_TEST_BAUD_RATE,
+                                       NULL,
+                                       U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                       U_CFG_TEST_PIN_UART_B_TXD,
+                                       U_CFG_TEST_PIN_UART_B_RXD,
+                                       U_CFG_TEST_PIN_UART_B_CTS,
+                                       U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gpSink->uartHandle >= 0);
+    U_PORT_TEST_ASSERT(uPortTaskCreate(sinkTask, "sinkTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       gpSink, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+    transportHandle.uart = gUartAHandle;
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M9, U_GNSS_TRANSPORT_UART,
+                                transportHandle, -1, false, &gGnssHandle) == 0);
+}
+
+// Undo openAll().
+static void closeAll()
+{
+    uGnssDeinit();
+    gGnssHandle = NULL;
+    gCorrHandle = NULL;
+    if (gpSink != NULL) {
+        gpSink->stop = true;
+        while (!gpSink->stopped) {
+            uPortTaskBlock(10);
+        }
+        uPortUartClose(gpSink->uartHandle);
+        uPortFree(gpSink);
+        gpSink = NULL;
+    }
+    if (gUartAHandle >= 0) {
+        uPortUartClose(gUartAHandle);
+        gUartAHandle = -1;
+    }
+}
+
+// Wait for the pump to have sent everything it has.
+static void waitEmpty(uGnssCorrStats_t *pStats)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    do {
+        uPortTaskBlock(50);
+        U_PORT_TEST_ASSERT(uGnssCorrGetStats(gCorrHandle, pStats) == 0);
+    } while ((pStats->queueLengthBytes > 0) &&
+             (uPortGetTickTimeMs() - startTimeMs < 10000));
+    // Let the sink catch up
+    uPortTaskBlock(200);
+}
+
+// Push a run of messages while the transport is held, so that
+// the queue overflows, then let them go; the GNSS API is held
+// too, as it would be during a long exchange with the GNSS chip,
+// which pushing must not wait for.  Returns the number of messages
+// pushed.
+static int32_t overflow(int32_t numMessages)
+{
+    uGnssPrivateInstance_t *pInstance;
+    char buffer[U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES];
+    size_t length;
+
+    pInstance = pUGnssPrivateGetInstance(gGnssHandle);
+    U_PORT_TEST_ASSERT(pInstance != NULL);
+
+    U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+    U_PORT_MUTEX_LOCK(pInstance->transportMutex);
+
+    for (int32_t x = 0; x < numMessages; x++) {
+        length = rtcmEncode(buffer, 200, x, uPortGetTickTimeMs());
+        U_PORT_TEST_ASSERT(uGnssCorrPush(gCorrHandle, buffer, length) == length);
+    }
+
+    U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
+    U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+
+    return numMessages;
+}
+#endif
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test the message checking of the correction-data pump.
+ */
+U_PORT_TEST_FUNCTION("[gnssCorr]", "gnssCorrMessageCheck")
+{
+    char buffer[300];
+    size_t length;
+
+    length = rtcmEncode(buffer, 100, 1, 0);
+    U_PORT_TEST_ASSERT(length == 106);
+    U_PORT_TEST_ASSERT(uGnssCorrMessageCheck(buffer, length) == length);
+    U_PORT_TEST_ASSERT(uGnssCorrMessageCheck(buffer, length + 10) == length);
+    // Incomplete
+    U_PORT_TEST_ASSERT(uGnssCorrMessageCheck(buffer, 1) == (int32_t) U_ERROR_COMMON_TIMEOUT);
+    U_PORT_TEST_ASSERT(uGnssCorrMessageCheck(buffer,
+                                             length - 1) == (int32_t) U_ERROR_COMMON_TIMEOUT);
+    // Corrupt
+    buffer[50]++;
+    U_PORT_TEST_ASSERT(uGnssCorrMessageCheck(buffer, length) < 0);
+    U_PORT_TEST_ASSERT(uGnssCorrMessageCheck(buffer,
+                                             length) != (int32_t) U_ERROR_COMMON_TIMEOUT);
+    buffer[50]--;
+    buffer[1] = 0x10;
+    U_PORT_TEST_ASSERT(uGnssCorrMessageCheck(buffer, length) < 0);
+    // Not RTCM3 or SPARTN at all
+    U_PORT_TEST_ASSERT(uGnssCorrMessageCheck(gCommand, sizeof(gCommand)) < 0);
+    U_PORT_TEST_ASSERT(uGnssCorrMessageCheck(NULL, 0) < 0);
+}
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Benchmark the correction-data pump: a producer pushes bursts of
+ * RTCM3 messages, as a TCP stream, while commands are sent to the
+ * "GNSS chip" with uGnssMsgSend(); the sink checks that everything
+ * arrives, intact and not interleaved, and the latency of both the
+ * corrections and the commands is reported.  Then the overflow
+ * policies are checked.
+ */
+U_PORT_TEST_FUNCTION("[gnssCorr]", "gnssCorrBenchmark")
+{
+    int32_t resourceCount;
+    uPortTaskHandle_t taskHandle;
+    uGnssCorrStats_t stats;
+    char *pProducerBuffer;
+    int32_t startTimeMs;
+    int32_t latencyMs;
+    int32_t maxCommandLatencyMs = 0;
+    int32_t totalCommandLatencyMs = 0;
+    size_t numCommands = 0;
+    size_t numMessages;
+    int32_t x;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    openAll();
+
+    // No pump, so these should fail
+    U_PORT_TEST_ASSERT(uGnssCorrPush(NULL, gCommand, sizeof(gCommand)) < 0);
+    U_PORT_TEST_ASSERT(uGnssCorrGetStats(NULL, &stats) < 0);
+    // Queue too small
+    U_PORT_TEST_ASSERT(uGnssCorrStart(gGnssHandle, U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES,
+                                      true, &gCorrHandle) < 0);
+    U_PORT_TEST_ASSERT(gCorrHandle == NULL);
+    // No handle
+    U_PORT_TEST_ASSERT(uGnssCorrStart(gGnssHandle, 0, true, NULL) < 0);
+
+    U_PORT_TEST_ASSERT(uGnssCorrStart(gGnssHandle, 0, true, &gCorrHandle) == 0);
+    U_PORT_TEST_ASSERT(gCorrHandle != NULL);
+    // Enough room for a burst plus a chunk of 100 bytes
+    pProducerBuffer = (char *) pUPortMalloc(U_GNSS_CORR_TEST_EPOCH_MESSAGES * 256 + 100);
+    U_PORT_TEST_ASSERT(pProducerBuffer != NULL);
+    gProducerDone = false;
+    U_TEST_PRINT_LINE("pumping %d RTCM3 message(s), %d every %d ms, while"
+                      " sending a command every %d ms...", U_GNSS_CORR_TEST_NUM_MESSAGES,
+                      U_GNSS_CORR_TEST_EPOCH_MESSAGES, U_GNSS_CORR_TEST_EPOCH_PERIOD_MS,
+                      U_GNSS_CORR_TEST_COMMAND_PERIOD_MS);
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uPortTaskCreate(producerTask, "producerTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       pProducerBuffer, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    while (!gProducerDone && (uPortGetTickTimeMs() - startTimeMs < 60000)) {
+        latencyMs = uPortGetTickTimeMs();
+        x = uGnssMsgSend(gGnssHandle, gCommand, sizeof(gCommand));
+        latencyMs = uPortGetTickTimeMs() - latencyMs;
+        U_PORT_TEST_ASSERT(x == sizeof(gCommand));
+        totalCommandLatencyMs += latencyMs;
+        if (latencyMs > maxCommandLatencyMs) {
+            maxCommandLatencyMs = latencyMs;
+        }
+        numCommands++;
+        uPortTaskBlock(U_GNSS_CORR_TEST_COMMAND_PERIOD_MS);
+    }
+    U_PORT_TEST_ASSERT(gProducerDone);
+    // Let the producer task go away
+    uPortTaskBlock(100);
+    uPortFree(pProducerBuffer);
+    waitEmpty(&stats);
+
+    U_TEST_PRINT_LINE("%d message(s) queued, %d sent (%d byte(s), %d byte(s)/s),"
+                      " %d dropped, %d byte(s) rejected, %d send error(s), queue"
+                      " high-water mark %d byte(s).", stats.messagesQueued,
+                      stats.messagesSent, stats.bytesSent, stats.throughputBytesPerSecond,
+                      stats.messagesDropped, stats.bytesRejected, stats.sendErrors,
+                      stats.queueHighWaterBytes);
+    U_TEST_PRINT_LINE("age at injection average %d ms, worst %d ms; push to"
+                      " receipt average %d ms, worst %d ms.", stats.ageAverageMs,
+                      stats.ageMaxMs, gpSink->totalLatencyMs / (int32_t) gpSink->messages,
+                      gpSink->maxLatencyMs);
+    U_TEST_PRINT_LINE("%d command(s) sent alongside, uGnssMsgSend() time average"
+                      " %d ms, worst %d ms.", numCommands,
+                      totalCommandLatencyMs / (int32_t) numCommands, maxCommandLatencyMs);
+    U_PORT_TEST_ASSERT(stats.messagesQueued == U_GNSS_CORR_TEST_NUM_MESSAGES);
+    U_PORT_TEST_ASSERT(stats.messagesSent == U_GNSS_CORR_TEST_NUM_MESSAGES);
+    U_PORT_TEST_ASSERT(stats.messagesDropped == 0);
+    U_PORT_TEST_ASSERT(stats.bytesRejected == 0);
+    U_PORT_TEST_ASSERT(stats.sendErrors == 0);
+    U_PORT_TEST_ASSERT(gpSink->messages == U_GNSS_CORR_TEST_NUM_MESSAGES);
+    U_PORT_TEST_ASSERT(gpSink->lastSequence == U_GNSS_CORR_TEST_NUM_MESSAGES - 1);
+    // Commands must have arrived whole, between messages
+    U_PORT_TEST_ASSERT(gpSink->otherBytes == numCommands * sizeof(gCommand));
+
+    // Now overflow the smallest queue, dropping the oldest: the
+    // last message to arrive should be the last one pushed
+    U_PORT_TEST_ASSERT(uGnssCorrStart(gGnssHandle, U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES +
+                                      U_GNSS_CORR_QUEUE_OVERHEAD_BYTES + 1, true,
+                                      &gCorrHandle) == 0);
+    gpSink->messages = 0;
+    numMessages = overflow(20);
+    waitEmpty(&stats);
+    U_TEST_PRINT_LINE("drop-oldest: %d message(s) pushed, %d dropped, %d sent,"
+                      " last received %d.", numMessages, stats.messagesDropped,
+                      stats.messagesSent, gpSink->lastSequence);
+    U_PORT_TEST_ASSERT(stats.messagesDropped > 0);
+    U_PORT_TEST_ASSERT(stats.messagesSent + stats.messagesDropped == numMessages);
+    U_PORT_TEST_ASSERT(gpSink->messages == stats.messagesSent);
+    U_PORT_TEST_ASSERT(gpSink->lastSequence == (int32_t) numMessages - 1);
+
+    // ...and dropping the newest: the last message to arrive
+    // should be the last one that fitted
+    U_PORT_TEST_ASSERT(uGnssCorrStart(gGnssHandle, U_GNSS_CORR_MESSAGE_LENGTH_MAX_BYTES +
+                                      U_GNSS_CORR_QUEUE_OVERHEAD_BYTES + 1, false,
+                                      &gCorrHandle) == 0);
+    gpSink->messages = 0;
+    numMessages = overflow(20);
+    waitEmpty(&stats);
+    U_TEST_PRINT_LINE("drop-newest: %d message(s) pushed, %d dropped, %d sent,"
+                      " last received %d.", numMessages, stats.messagesDropped,
+                      stats.messagesSent, gpSink->lastSequence);
+    U_PORT_TEST_ASSERT(stats.messagesDropped > 0);
+    U_PORT_TEST_ASSERT(stats.messagesSent + stats.messagesDropped == numMessages);
+    U_PORT_TEST_ASSERT(gpSink->messages == stats.messagesSent);
+    U_PORT_TEST_ASSERT(gpSink->lastSequence == (int32_t) stats.messagesSent - 1);
+
+    uGnssCorrStop(gGnssHandle);
+    gCorrHandle = NULL;
+
+    // Leave the last pump running to check that
+    // uGnssDeinit() gets rid of it
+    U_PORT_TEST_ASSERT(uGnssCorrStart(gGnssHandle, 0, true, &gCorrHandle) == 0);
+    closeAll();
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[gnssCorr]", "gnssCorrCleanUp")
+{
+    closeAll();
+    uPortDeinit();
+}
+#endif
+
+// End of file
@@ -36,8 +36,9 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "stdlib.h"    // strtol(), strtod()
 #include "string.h"    // memset()
-#include "stdio.h"     // snprintf()
+#include "stdio.h"     // snprintf(), sscanf()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -102,6 +103,12 @@
 # define U_GNSS_DEC_TEST_HEX_DUMP_WIDTH 16
 #endif
 
+#ifndef U_GNSS_DEC_TEST_NMEA_BENCHMARK_MS
+/** How long to run each half of the NMEA decode benchmark for.
+ */
+# define U_GNSS_DEC_TEST_NMEA_BENCHMARK_MS 1000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -224,13 +231,347 @@ static const uGnssDecTestDataKnown_t gUbxNavHpposllh[] = {
     }
 };
 
+/** Decoded test data for UBX-NAV-DOP, to be used by gUbxNavDop (item 0).
+ */
+static const uGnssDecUbxNavDop_t gUbxNavDopDecoded0 = {
+    477230000 /* iTOW */, 215 /* gDOP */, 118 /* pDOP */, 111 /* tDOP */,
+    96 /* vDOP */, 69 /* hDOP */, 45 /* nDOP */, 52 /* eDOP */
+};
+
+/** Array of test data for UBX-NAV-DOP.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavDop[] = {
+    {
+        {
+            "\xb5\x62\x01\x04\x12\x00\xb0\xf3\x71\x1c\xd7\x00\x76\x00\x6f\x00"
+            "\x60\x00\x45\x00\x2d\x00\x34\x00\x09\x63", 26
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0104, NULL
+        },
+        (void *) &gUbxNavDopDecoded0
+    }
+};
+
+/** Decoded test data for UBX-NAV-STATUS, to be used by gUbxNavStatus (item 0).
+ */
+static const uGnssDecUbxNavStatus_t gUbxNavStatusDecoded0 = {
+    477230000 /* iTOW */, U_GNSS_DEC_UBX_NAV_STATUS_GPS_FIX_3D /* gpsFix */,
+    0x0d /* flags */, 0x01 /* fixStat */, 0x48 /* flags2 */,
+    28345 /* ttff */, 1234567 /* msss */
+};
+
+/** Array of test data for UBX-NAV-STATUS.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavStatus[] = {
+    {
+        {
+            "\xb5\x62\x01\x03\x10\x00\xb0\xf3\x71\x1c\x03\x0d\x01\x48\xb9\x6e"
+            "\x00\x00\x87\xd6\x12\x00\x33\x15", 24
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0103, NULL
+        },
+        (void *) &gUbxNavStatusDecoded0
+    }
+};
+
+/** Decoded test data for UBX-NAV-COV, to be used by gUbxNavCov (item 0);
+ * values chosen to be exact in binary floating point.
+ */
+static const uGnssDecUbxNavCov_t gUbxNavCovDecoded0 = {
+    477230000 /* iTOW */, 0 /* version */, 1 /* posCovValid */,
+    1 /* velCovValid */, 0.8125f /* posCovNN */, -0.0625f /* posCovNE */,
+    0.125f /* posCovND */, 0.5f /* posCovEE */, 0.25f /* posCovED */,
+    2.0f /* posCovDD */, 0.0078125f /* velCovNN */, 0.0f /* velCovNE */,
+    -0.00390625f /* velCovND */, 0.0078125f /* velCovEE */,
+    0.001953125f /* velCovED */, 0.015625f /* velCovDD */
+};
+
+/** Array of test data for UBX-NAV-COV.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavCov[] = {
+    {
+        {
+            "\xb5\x62\x01\x36\x40\x00\xb0\xf3\x71\x1c\x00\x01\x01\x00\x00\x00"
+            "\x00\x00\x00\x00\x00\x00\x00\x00\x50\x3f\x00\x00\x80\xbd\x00\x00"
+            "\x00\x3e\x00\x00\x00\x3f\x00\x00\x80\x3e\x00\x00\x00\x40\x00\x00"
+            "\x00\x3c\x00\x00\x00\x00\x00\x00\x80\xbb\x00\x00\x00\x3c\x00\x00"
+            "\x00\x3b\x00\x00\x80\x3c\x9a\x2f", 72
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0136, NULL
+        },
+        (void *) &gUbxNavCovDecoded0
+    }
+};
+
+/** Decoded test data for UBX-NAV-SAT, to be used by gUbxNavSat (item 0).
+ */
+static const uGnssDecUbxNavSat_t gUbxNavSatDecoded0 = {
+    477230000 /* iTOW */, 1 /* version */, 3 /* numSvs */,
+    {
+        // gnssId, svId, cno, elev, azim, prRes, flags
+        {0, 5, 44, 67, 278, -12, 0x191f},
+        {2, 11, 40, 30, 240, 3, 0x1917},
+        {6, 1, 0, 0, 0, 0, 0x11}
+    }
+};
+
+/** Array of test data for UBX-NAV-SAT.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavSat[] = {
+    {
+        {
+            "\xb5\x62\x01\x35\x2c\x00\xb0\xf3\x71\x1c\x01\x03\x00\x00\x00\x05"
+            "\x2c\x43\x16\x01\xf4\xff\x1f\x19\x00\x00\x02\x0b\x28\x1e\xf0\x00"
+            "\x03\x00\x17\x19\x00\x00\x06\x01\x00\x00\x00\x00\x00\x00\x11\x00"
+            "\x00\x00\xda\x99", 52
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0135, NULL
+        },
+        (void *) &gUbxNavSatDecoded0
+    }
+};
+
+/** Decoded test data for UBX-TIM-TP, to be used by gUbxTimTp (item 0).
+ */
+static const uGnssDecUbxTimTp_t gUbxTimTpDecoded0 = {
+    477231000 /* towMS */, 0x80000000 /* towSubMS */, -1234 /* qErr */,
+    2280 /* week */, 0x03 /* flags */, 0x00 /* refInfo */
+};
+
+/** Array of test data for UBX-TIM-TP.
+ */
+static const uGnssDecTestDataKnown_t gUbxTimTp[] = {
+    {
+        {
+            "\xb5\x62\x0d\x01\x10\x00\x98\xf7\x71\x1c\x00\x00\x00\x80\x2e\xfb"
+            "\xff\xff\xe8\x08\x03\x00\xd4\x4a", 24
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0d01, NULL
+        },
+        (void *) &gUbxTimTpDecoded0
+    }
+};
+
+/** Decoded test data for NMEA GGA, to be used by gNmeaGga (item 0).
+ */
+static const uGnssDecNmeaGga_t gNmeaGgaDecoded0 = {
+    "GN" /* talker */, 34070000 /* timeOfDayMs */, 533613367 /* latitudeX1e7 */,
+    -65056200 /* longitudeX1e7 */, 2 /* quality */, 12 /* numSv */,
+    62 /* hdopX100 */, 61700 /* altitudeMillimetres */,
+    55200 /* geoidSeparationMillimetres */, 1000 /* diffAgeMs */,
+    0 /* diffStation */
+};
+
+/** Array of test data for NMEA GGA.
+ */
+static const uGnssDecTestDataKnown_t gNmeaGga[] = {
+    {
+        {"$GNGGA,092750.00,5321.68020,N,00630.33720,W,2,12,0.62,61.7,M,55.2,M,1.0,0000*49", 79},
+        {U_GNSS_PROTOCOL_NMEA, 0, "GNGGA"},
+        (void *) &gNmeaGgaDecoded0
+    }
+};
+
+/** Decoded test data for NMEA RMC, to be used by gNmeaRmc (item 0).
+ */
+static const uGnssDecNmeaRmc_t gNmeaRmcDecoded0 = {
+    "GN" /* talker */, 34070000 /* timeOfDayMs */, 'A' /* status */,
+    533613367 /* latitudeX1e7 */, -65056200 /* longitudeX1e7 */,
+    6 /* speedMillimetresPerSecond */, U_GNSS_DEC_NMEA_NOT_PRESENT /* courseX1e2 */,
+    2023 /* year */, 8 /* month */, 11 /* day */,
+    U_GNSS_DEC_NMEA_NOT_PRESENT /* magneticVariationX1e2 */, 'D' /* posMode */,
+    'V' /* navStatus */
+};
+
+/** Array of test data for NMEA RMC.
+ */
+static const uGnssDecTestDataKnown_t gNmeaRmc[] = {
+    {
+        {"$GNRMC,092750.00,A,5321.68020,N,00630.33720,W,0.012,,110823,,,D,V*09", 68},
+        {U_GNSS_PROTOCOL_NMEA, 0, "GNRMC"},
+        (void *) &gNmeaRmcDecoded0
+    }
+};
+
+/** Decoded test data for NMEA GSA, to be used by gNmeaGsa (item 0).
+ */
+static const uGnssDecNmeaGsa_t gNmeaGsaDecoded0 = {
+    "GN" /* talker */, 'A' /* opMode */, 3 /* navMode */, 8 /* numSv */,
+    {10, 7, 5, 2, 29, 4, 8, 13, 0, 0, 0, 0} /* svId */, 172 /* pdopX100 */,
+    103 /* hdopX100 */, 138 /* vdopX100 */, 1 /* systemId */
+};
+
+/** Array of test data for NMEA GSA.
+ */
+static const uGnssDecTestDataKnown_t gNmeaGsa[] = {
+    {
+        {"$GNGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38,1*09", 58},
+        {U_GNSS_PROTOCOL_NMEA, 0, "GNGSA"},
+        (void *) &gNmeaGsaDecoded0
+    }
+};
+
+/** Decoded test data for NMEA GSV, to be used by gNmeaGsv (item 0).
+ */
+static const uGnssDecNmeaGsv_t gNmeaGsvDecoded0 = {
+    "GP" /* talker */, 3 /* numMessages */, 1 /* messageNumber */,
+    10 /* numSvInView */, 4 /* numSat */,
+    {{2, 34, 126, 44}, {4, 12, 45, 38}, {5, 67, 278, 47}, {7, 22, 310, 40}} /* sat */,
+    1 /* signalId */
+};
+
+/** Array of test data for NMEA GSV.
+ */
+static const uGnssDecTestDataKnown_t gNmeaGsv[] = {
+    {
+        {"$GPGSV,3,1,10,02,34,126,44,04,12,045,38,05,67,278,47,07,22,310,40,1*61", 70},
+        {U_GNSS_PROTOCOL_NMEA, 0, "GPGSV"},
+        (void *) &gNmeaGsvDecoded0
+    }
+};
+
+/** Decoded test data for NMEA GST, to be used by gNmeaGst (item 0).
+ */
+static const uGnssDecNmeaGst_t gNmeaGstDecoded0 = {
+    "GN" /* talker */, 34070000 /* timeOfDayMs */, 870 /* rangeRmsMillimetres */,
+    1200 /* stdMajorMillimetres */, 800 /* stdMinorMillimetres */,
+    4530 /* orientationX1e2 */, 950 /* stdLatitudeMillimetres */,
+    720 /* stdLongitudeMillimetres */, 1500 /* stdAltitudeMillimetres */
+};
+
+/** Array of test data for NMEA GST.
+ */
+static const uGnssDecTestDataKnown_t gNmeaGst[] = {
+    {
+        {"$GNGST,092750.00,0.87,1.2,0.8,45.3,0.95,0.72,1.5*4B", 51},
+        {U_GNSS_PROTOCOL_NMEA, 0, "GNGST"},
+        (void *) &gNmeaGstDecoded0
+    }
+};
+
+/** Decoded test data for NMEA VTG, to be used by gNmeaVtg (item 0).
+ */
+static const uGnssDecNmeaVtg_t gNmeaVtgDecoded0 = {
+    "GN" /* talker */, U_GNSS_DEC_NMEA_NOT_PRESENT /* courseTrueX1e2 */,
+    U_GNSS_DEC_NMEA_NOT_PRESENT /* courseMagneticX1e2 */,
+    6 /* speedMillimetresPerSecond */, 'D' /* posMode */
+};
+
+/** Array of test data for NMEA VTG.
+ */
+static const uGnssDecTestDataKnown_t gNmeaVtg[] = {
+    {
+        {"$GNVTG,,T,,M,0.012,N,0.022,K,D*3B", 33},
+        {U_GNSS_PROTOCOL_NMEA, 0, "GNVTG"},
+        (void *) &gNmeaVtgDecoded0
+    }
+};
+
+/** Decoded test data for NMEA ZDA, to be used by gNmeaZda (item 0).
+ */
+static const uGnssDecNmeaZda_t gNmeaZdaDecoded0 = {
+    "GN" /* talker */, 34070000 /* timeOfDayMs */, 11 /* day */, 8 /* month */,
+    2023 /* year */, 0 /* localZoneHours */, 0 /* localZoneMinutes */
+};
+
+/** Array of test data for NMEA ZDA.
+ */
+static const uGnssDecTestDataKnown_t gNmeaZda[] = {
+    {
+        {"$GNZDA,092750.00,11,08,2023,00,00*7A", 36},
+        {U_GNSS_PROTOCOL_NMEA, 0, "GNZDA"},
+        (void *) &gNmeaZdaDecoded0
+    }
+};
+
 /** Array of arrays of test vectors for all known message types.
  */
 static const uGnssDecTestDataKnownSet_t gTestDataKnownSet[] = {
     {gUbxNavPvt, sizeof(gUbxNavPvt) / sizeof(gUbxNavPvt[0]), sizeof(gUbxNavPvtDecoded0)},
-    {gUbxNavHpposllh, sizeof(gUbxNavHpposllh) / sizeof(gUbxNavHpposllh[0]), sizeof(gUbxNavHpposllhDecoded0)}
+    {gUbxNavHpposllh, sizeof(gUbxNavHpposllh) / sizeof(gUbxNavHpposllh[0]), sizeof(gUbxNavHpposllhDecoded0)},
+    {gUbxNavDop, sizeof(gUbxNavDop) / sizeof(gUbxNavDop[0]), sizeof(gUbxNavDopDecoded0)},
+    {gUbxNavStatus, sizeof(gUbxNavStatus) / sizeof(gUbxNavStatus[0]), sizeof(gUbxNavStatusDecoded0)},
+    {gUbxNavCov, sizeof(gUbxNavCov) / sizeof(gUbxNavCov[0]), sizeof(gUbxNavCovDecoded0)},
+    {gUbxNavSat, sizeof(gUbxNavSat) / sizeof(gUbxNavSat[0]), sizeof(gUbxNavSatDecoded0)},
+    {gUbxTimTp, sizeof(gUbxTimTp) / sizeof(gUbxTimTp[0]), sizeof(gUbxTimTpDecoded0)},
+    {gNmeaGga, sizeof(gNmeaGga) / sizeof(gNmeaGga[0]), sizeof(gNmeaGgaDecoded0)},
+    {gNmeaRmc, sizeof(gNmeaRmc) / sizeof(gNmeaRmc[0]), sizeof(gNmeaRmcDecoded0)},
+    {gNmeaGsa, sizeof(gNmeaGsa) / sizeof(gNmeaGsa[0]), sizeof(gNmeaGsaDecoded0)},
+    {gNmeaGsv, sizeof(gNmeaGsv) / sizeof(gNmeaGsv[0]), sizeof(gNmeaGsvDecoded0)},
+    {gNmeaGst, sizeof(gNmeaGst) / sizeof(gNmeaGst[0]), sizeof(gNmeaGstDecoded0)},
+    {gNmeaVtg, sizeof(gNmeaVtg) / sizeof(gNmeaVtg[0]), sizeof(gNmeaVtgDecoded0)},
+    {gNmeaZda, sizeof(gNmeaZda) / sizeof(gNmeaZda[0]), sizeof(gNmeaZdaDecoded0)}
 };
 
+/** A recorded log of NMEA sentences: an epoch from a multi-GNSS
+ * receiver with NMEA 4.11 output, which uses the "GN" talker for
+ * the combined solution and the GP, GL, GA, GB, GQ and GI talkers
+ * for the satellites of each system, followed by sentences from
+ * single-system/older NMEA version receivers (GP, BD, GL, GA, GQ).
+ */
+static const char *const gNmeaLog[] = {
+    "$GNRMC,092750.00,A,5321.68020,N,00630.33720,W,0.012,,110823,,,D,V*09\r\n",
+    "$GNVTG,,T,,M,0.012,N,0.022,K,D*3B\r\n",
+    "$GNGGA,092750.00,5321.68020,N,00630.33720,W,2,12,0.62,61.7,M,55.2,M,1.0,0000*49\r\n",
+    "$GNGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38,1*09\r\n",
+    "$GNGSA,A,3,65,66,81,,,,,,,,,,1.72,1.03,1.38,2*04\r\n",
+    "$GNGSA,A,3,04,11,19,,,,,,,,,,1.72,1.03,1.38,3*03\r\n",
+    "$GNGSA,A,3,21,22,,,,,,,,,,,1.72,1.03,1.38,4*0B\r\n",
+    "$GPGSV,3,1,10,02,34,126,44,04,12,045,38,05,67,278,47,07,22,310,40,1*61\r\n",
+    "$GPGSV,3,2,10,08,10,183,35,10,45,092,45,13,29,234,41,29,55,058,46,1*66\r\n",
+    "$GPGSV,3,3,10,15,05,320,,18,02,011,,1*6E\r\n",
+    "$GPGSV,1,1,03,05,67,278,42,07,22,310,36,29,55,058,40,6*5D\r\n",
+    "$GLGSV,1,1,03,65,40,100,39,66,70,200,42,81,20,300,33,1*4C\r\n",
+    "$GAGSV,1,1,03,04,50,130,44,11,30,240,40,19,15,060,36,7*4D\r\n",
+    "$GBGSV,1,1,02,21,60,150,45,22,40,210,41,B*05\r\n",
+    "$GQGSV,1,1,01,01,80,120,43,1*59\r\n",
+    "$GIGSV,1,1,01,03,30,100,38,1*46\r\n",
+    "$GNGST,092750.00,0.87,1.2,0.8,45.3,0.95,0.72,1.5*4B\r\n",
+    "$GNZDA,092750.00,11,08,2023,00,00*7A\r\n",
+    "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*76\r\n",
+    "$GPRMC,225446,A,4916.45,N,12311.12,W,000.5,054.7,191194,020.3,E*68\r\n",
+    "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n",
+    "$GPGSV,1,1,00*79\r\n",
+    "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n",
+    "$GPZDA,201530.00,04,07,2002,00,00*60\r\n",
+    "$BDGGA,000001.00,0000.00001,S,18000.00000,E,6,04,99.99,-12.3,M,0.0,M,,*47\r\n",
+    "$BDGSV,1,1,02,21,60,150,45,22,40,210,41*68\r\n",
+    "$GLGST,172814.0,0.006,0.023,0.020,273.6,0.023,0.020,0.031*76\r\n",
+    "$GAVTG,359.99,T,,M,,N,,K,N*2C\r\n",
+    "$GQRMC,235959.99,V,,,,,,,311299,,,N,V*06\r\n"
+};
+
+/** The sentence type of each entry in gNmeaLog.
+ */
+static const uGnssDecNmeaSentence_t gNmeaLogSentence[] = {
+    U_GNSS_DEC_NMEA_SENTENCE_RMC, U_GNSS_DEC_NMEA_SENTENCE_VTG,
+    U_GNSS_DEC_NMEA_SENTENCE_GGA, U_GNSS_DEC_NMEA_SENTENCE_GSA,
+    U_GNSS_DEC_NMEA_SENTENCE_GSA, U_GNSS_DEC_NMEA_SENTENCE_GSA,
+    U_GNSS_DEC_NMEA_SENTENCE_GSA, U_GNSS_DEC_NMEA_SENTENCE_GSV,
+    U_GNSS_DEC_NMEA_SENTENCE_GSV, U_GNSS_DEC_NMEA_SENTENCE_GSV,
+    U_GNSS_DEC_NMEA_SENTENCE_GSV, U_GNSS_DEC_NMEA_SENTENCE_GSV,
+    U_GNSS_DEC_NMEA_SENTENCE_GSV, U_GNSS_DEC_NMEA_SENTENCE_GSV,
+    U_GNSS_DEC_NMEA_SENTENCE_GSV, U_GNSS_DEC_NMEA_SENTENCE_GSV,
+    U_GNSS_DEC_NMEA_SENTENCE_GST, U_GNSS_DEC_NMEA_SENTENCE_ZDA,
+    U_GNSS_DEC_NMEA_SENTENCE_GGA, U_GNSS_DEC_NMEA_SENTENCE_RMC,
+    U_GNSS_DEC_NMEA_SENTENCE_GSA, U_GNSS_DEC_NMEA_SENTENCE_GSV,
+    U_GNSS_DEC_NMEA_SENTENCE_VTG, U_GNSS_DEC_NMEA_SENTENCE_ZDA,
+    U_GNSS_DEC_NMEA_SENTENCE_GGA, U_GNSS_DEC_NMEA_SENTENCE_GSV,
+    U_GNSS_DEC_NMEA_SENTENCE_GST, U_GNSS_DEC_NMEA_SENTENCE_VTG,
+    U_GNSS_DEC_NMEA_SENTENCE_RMC
+};
+
+/** The number of satellites in the table after each GSV sentence
+ * of the first epoch in gNmeaLog is passed to
+ * uGnssDecNmeaGsvAssemble(), -1 for #U_ERROR_COMMON_BUSY.
+ */
+static const int32_t gNmeaLogGsvNumSat[] = {-1, -1, 10, 13, 16, 19, 21, 22, 23};
+
 /** Flag to share with the user callback.
  */
 static int32_t gCallback;
@@ -511,6 +852,145 @@ static void testHelperFunctions(const uGnssMessageId_t *pId,
     // *INDENT-ON*
 }
 
+// Copy the next field of an NMEA sentence out with sscanf(),
+// the way it is commonly done, for the benchmark baseline;
+// returns the length of the field, -1 if there are no more.
+static int32_t baselineField(const char **ppSentence, char *pField)
+{
+    int32_t length = -1;
+    int32_t consumed = 0;
+
+    *pField = 0;
+    if (**ppSentence == ',') {
+        (*ppSentence)++;
+        if ((**ppSentence == ',') || (**ppSentence == '*')) {
+            length = 0;
+        } else if (sscanf(*ppSentence, "%15[^,*]%n", pField, (int *) &consumed) == 1) {
+            length = consumed;
+            *ppSentence += consumed;
+        }
+    }
+
+    return length;
+}
+
+// Convert a latitude/longitude with strtod() for the benchmark
+// baseline.
+static int32_t baselineLatLon(const char *pField, const char *pHemisphere)
+{
+    double value = strtod(pField, NULL);
+    int32_t degrees = (int32_t) (value / 100);
+
+    value = degrees + ((value - (degrees * 100)) / 60);
+    if ((*pHemisphere == 'S') || (*pHemisphere == 'W')) {
+        value = -value;
+    }
+
+    return (int32_t) ((value * 1e7) + ((value < 0) ? -0.5 : 0.5));
+}
+
+// Decode a GGA or RMC sentence the way it is commonly done, with
+// sscanf(), strtol() and strtod(), as a baseline for the benchmark;
+// only a few fields are converted, all of them are copied.
+static int32_t baselineDecode(const char *pSentence, uGnssDecNmea_t *pNmea)
+{
+    int32_t errorCode = -1;
+    char field[16];
+    char latitude[16] = {0};
+    char longitude[16] = {0};
+    char formatter[4] = {0};
+    int32_t x;
+    int32_t numFields = 0;
+    int32_t timeOfDayMs = 0;
+    int32_t latitudeX1e7;
+    int32_t longitudeX1e7;
+    long hhmmss;
+
+    if (sscanf(pSentence, "$%*2c%3c", formatter) == 1) {
+        pSentence += 6;
+        errorCode = 0;
+        if (strcmp(formatter, "GGA") == 0) {
+            pNmea->sentence = U_GNSS_DEC_NMEA_SENTENCE_GGA;
+            while ((x = baselineField(&pSentence, field)) >= 0) {
+                switch (numFields) {
+                    case 0:
+                        hhmmss = strtol(field, NULL, 10);
+                        timeOfDayMs = (int32_t) ((hhmmss / 10000) * 3600000 + ((hhmmss / 100) % 100) * 60000 +
+                                                 (int32_t) (strtod(field + 4, NULL) * 1000 + 0.5));
+                        break;
+                    case 1:
+                        strncpy(latitude, field, sizeof(latitude) - 1);
+                        break;
+                    case 2:
+                        latitudeX1e7 = baselineLatLon(latitude, field);
+                        break;
+                    case 3:
+                        strncpy(longitude, field, sizeof(longitude) - 1);
+                        break;
+                    case 4:
+                        longitudeX1e7 = baselineLatLon(longitude, field);
+                        break;
+                    case 6:
+                        pNmea->body.gga.numSv = strtol(field, NULL, 10);
+                        break;
+                    case 7:
+                        pNmea->body.gga.hdopX100 = (int32_t) (strtod(field, NULL) * 100 + 0.5);
+                        break;
+                    case 8:
+                        pNmea->body.gga.altitudeMillimetres = (int32_t) (strtod(field, NULL) * 1000);
+                        break;
+                    default:
+                        break;
+                }
+                numFields++;
+            }
+            pNmea->body.gga.timeOfDayMs = timeOfDayMs;
+            pNmea->body.gga.latitudeX1e7 = latitudeX1e7;
+            pNmea->body.gga.longitudeX1e7 = longitudeX1e7;
+        } else if (strcmp(formatter, "RMC") == 0) {
+            pNmea->sentence = U_GNSS_DEC_NMEA_SENTENCE_RMC;
+            while ((x = baselineField(&pSentence, field)) >= 0) {
+                switch (numFields) {
+                    case 0:
+                        hhmmss = strtol(field, NULL, 10);
+                        timeOfDayMs = (int32_t) ((hhmmss / 10000) * 3600000 + ((hhmmss / 100) % 100) * 60000 +
+                                                 (int32_t) (strtod(field + 4, NULL) * 1000 + 0.5));
+                        break;
+                    case 2:
+                        strncpy(latitude, field, sizeof(latitude) - 1);
+                        break;
+                    case 3:
+                        latitudeX1e7 = baselineLatLon(latitude, field);
+                        break;
+                    case 4:
+                        strncpy(longitude, field, sizeof(longitude) - 1);
+                        break;
+                    case 5:
+                        longitudeX1e7 = baselineLatLon(longitude, field);
+                        break;
+                    case 6:
+                        pNmea->body.rmc.speedMillimetresPerSecond = (int32_t) (strtod(field, NULL) * 514.444);
+                        break;
+                    case 8:
+                        x = strtol(field, NULL, 10);
+                        pNmea->body.rmc.day = x / 10000;
+                        pNmea->body.rmc.month = (x / 100) % 100;
+                        pNmea->body.rmc.year = 2000 + (x % 100);
+                        break;
+                    default:
+                        break;
+                }
+                numFields++;
+            }
+            pNmea->body.rmc.timeOfDayMs = timeOfDayMs;
+            pNmea->body.rmc.latitudeX1e7 = latitudeX1e7;
+            pNmea->body.rmc.longitudeX1e7 = longitudeX1e7;
+        }
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -607,11 +1087,20 @@ U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecCallback")
                 if (pTestData->id.type == U_GNSS_PROTOCOL_MAX_NUM) {
                     // Fantasy protocol is only known by the callback
                     U_PORT_TEST_ASSERT(pDec->errorCode == (int32_t) U_ERROR_COMMON_UNKNOWN);
+                    U_PORT_TEST_ASSERT(pDec->pBody == NULL);
+                } else if (pTestData->id.type == U_GNSS_PROTOCOL_NMEA) {
+                    // Without the callback these NMEA sentences go to the
+                    // built-in decoders, which return a body if they
+                    // managed a decode
+                    U_PORT_TEST_ASSERT(pDec->errorCode != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+                    U_PORT_TEST_ASSERT((pDec->pBody != NULL) ==
+                                       ((pDec->errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) ||
+                                        (pDec->errorCode == (int32_t) U_ERROR_COMMON_BAD_DATA)));
                 } else {
                     // All the other protocol types are known but not supported unless the callback is in town
                     U_PORT_TEST_ASSERT(pDec->errorCode == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+                    U_PORT_TEST_ASSERT(pDec->pBody == NULL);
                 }
-                U_PORT_TEST_ASSERT(pDec->pBody == NULL);
             }
 
             // Free the structure once more
@@ -634,6 +1123,7 @@ U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecKnown")
     uGnssDec_t *pDec;
     const uGnssDecTestDataKnown_t *pTestData = NULL;
     size_t decodedStructureSize;
+    uGnssDecUnion_t body;
     char prefix[64]; // Just for printing
 
     // Get the initial resource count
@@ -695,6 +1185,17 @@ U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecKnown")
                 // Callouts to spot-tests for any helper functions
                 testHelperFunctions(&(pDec->id), pDec->pBody, &(pTestData->raw));
             }
+            if (pTestData->id.type == U_GNSS_PROTOCOL_UBX) {
+                // Do the same again without memory allocation
+                memset(&body, 0xFF, sizeof(body));
+                U_PORT_TEST_ASSERT(uGnssDecUbx(pTestData->raw.p, pTestData->raw.length - gCrcLength[pTestData->id.type],
+                                               &body, decodedStructureSize) == pTestData->id.idUbxOrRtcm);
+                U_PORT_TEST_ASSERT(memcmp(&body, pTestData->pDecoded, decodedStructureSize) == 0);
+                U_PORT_TEST_ASSERT(uGnssDecUbx(pTestData->raw.p, pTestData->raw.length, &body,
+                                               decodedStructureSize - 1) == (int32_t) U_ERROR_COMMON_INVALID_PARAMETER);
+                U_PORT_TEST_ASSERT(uGnssDecUbx(pTestData->raw.p, pTestData->raw.length - 3, &body,
+                                               sizeof(body)) == (int32_t) U_ERROR_COMMON_TRUNCATED);
+            }
             // Free the structure once more
             uGnssDecFree(pDec);
         }
@@ -707,4 +1208,246 @@ U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecKnown")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Conformance test of the allocation-free NMEA decoders: decode
+ * a recorded log covering all of the supported sentences and a
+ * good range of talker IDs, spot-check the values, assemble the
+ * GSV sentences into a satellite table and check the error cases.
+ */
+U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecNmea")
+{
+    int32_t resourceCount;
+    uGnssDecNmea_t nmea;
+    uGnssDecNmeaSatTable_t *pTable;
+    const char *pSentence;
+    size_t y = 0;
+    int32_t x;
+
+    // Get the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    pTable = (uGnssDecNmeaSatTable_t *) pUPortMalloc(sizeof(*pTable));
+    U_PORT_TEST_ASSERT(pTable != NULL);
+    memset(pTable, 0, sizeof(*pTable));
+
+    U_PORT_TEST_ASSERT(sizeof(gNmeaLog) / sizeof(gNmeaLog[0]) ==
+                       sizeof(gNmeaLogSentence) / sizeof(gNmeaLogSentence[0]));
+    for (size_t z = 0; z < sizeof(gNmeaLog) / sizeof(gNmeaLog[0]); z++) {
+        pSentence = gNmeaLog[z];
+        memset(&nmea, 0xFF, sizeof(nmea));
+        x = uGnssDecNmea(pSentence, strlen(pSentence), &nmea);
+        U_TEST_PRINT_LINE_X("%.*s: %d.", z, (int) strlen(pSentence) - 2, pSentence, x);
+        U_PORT_TEST_ASSERT(x == 0);
+        U_PORT_TEST_ASSERT(nmea.sentence == gNmeaLogSentence[z]);
+        // The talker is always the first member
+        U_PORT_TEST_ASSERT(strncmp(nmea.body.gga.talker, pSentence + 1, 2) == 0);
+        U_PORT_TEST_ASSERT(nmea.body.gga.talker[2] == 0);
+        if ((nmea.sentence == U_GNSS_DEC_NMEA_SENTENCE_GSV) &&
+            (y < sizeof(gNmeaLogGsvNumSat) / sizeof(gNmeaLogGsvNumSat[0]))) {
+            // Assemble the GSV sentences of the first epoch
+            x = uGnssDecNmeaGsvAssemble(pTable, &(nmea.body.gsv));
+            U_TEST_PRINT_LINE_X("satellite table assembly returned %d.", z, x);
+            if (gNmeaLogGsvNumSat[y] < 0) {
+                U_PORT_TEST_ASSERT(x == (int32_t) U_ERROR_COMMON_BUSY);
+            } else {
+                U_PORT_TEST_ASSERT(x == gNmeaLogGsvNumSat[y]);
+                U_PORT_TEST_ASSERT(pTable->numSat == (size_t) x);
+            }
+            y++;
+        }
+    }
+
+    // Spot-check the satellite table
+    U_PORT_TEST_ASSERT(strcmp(pTable->sat[8].talker, "GP") == 0);
+    U_PORT_TEST_ASSERT(pTable->sat[8].signalId == 1);
+    U_PORT_TEST_ASSERT(pTable->sat[8].sat.svId == 15);
+    U_PORT_TEST_ASSERT(pTable->sat[8].sat.azimuthDegrees == 320);
+    U_PORT_TEST_ASSERT(pTable->sat[8].sat.cnoDbHz == U_GNSS_DEC_NMEA_NOT_PRESENT_INT16);
+    U_PORT_TEST_ASSERT(pTable->sat[11].signalId == 6);
+    U_PORT_TEST_ASSERT(pTable->sat[11].sat.cnoDbHz == 36);
+    U_PORT_TEST_ASSERT(strcmp(pTable->sat[19].talker, "GB") == 0);
+    U_PORT_TEST_ASSERT(pTable->sat[19].signalId == 11);
+    U_PORT_TEST_ASSERT(strcmp(pTable->sat[22].talker, "GI") == 0);
+    U_PORT_TEST_ASSERT(pTable->sat[22].sat.elevationDegrees == 30);
+    // The start of the next GP set begins a new table, a sentence
+    // out of sequence loses the partial set
+    U_PORT_TEST_ASSERT(uGnssDecNmea(gNmeaLog[7], strlen(gNmeaLog[7]), &nmea) == 0);
+    U_PORT_TEST_ASSERT(uGnssDecNmeaGsvAssemble(pTable, &(nmea.body.gsv)) == (int32_t) U_ERROR_COMMON_BUSY);
+    U_PORT_TEST_ASSERT(pTable->numSat == 4);
+    U_PORT_TEST_ASSERT(uGnssDecNmea(gNmeaLog[9], strlen(gNmeaLog[9]), &nmea) == 0);
+    U_PORT_TEST_ASSERT(uGnssDecNmeaGsvAssemble(pTable,
+                                               &(nmea.body.gsv)) == (int32_t) U_ERROR_COMMON_PROTOCOL_ERROR);
+    U_PORT_TEST_ASSERT(pTable->numSat == 0);
+    uPortFree(pTable);
+
+    // Spot-check values from the other talkers and NMEA versions
+    pSentence = gNmeaLog[19];
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence), &nmea) == 0);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.timeOfDayMs == 82486000);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.latitudeX1e7 == 492741667);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.longitudeX1e7 == -1231853333);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.speedMillimetresPerSecond == 257);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.courseX1e2 == 5470);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.year == 1994);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.magneticVariationX1e2 == 2030);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.posMode == 0);
+    pSentence = gNmeaLog[21];
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence), &nmea) == 0);
+    U_PORT_TEST_ASSERT(nmea.body.gsv.numSat == 0);
+    U_PORT_TEST_ASSERT(nmea.body.gsv.signalId == U_GNSS_DEC_NMEA_NOT_PRESENT);
+    pSentence = gNmeaLog[22];
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence), &nmea) == 0);
+    U_PORT_TEST_ASSERT(nmea.body.vtg.courseMagneticX1e2 == 3440);
+    U_PORT_TEST_ASSERT(nmea.body.vtg.speedMillimetresPerSecond == 2833);
+    U_PORT_TEST_ASSERT(nmea.body.vtg.posMode == 0);
+    pSentence = gNmeaLog[24];
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence), &nmea) == 0);
+    U_PORT_TEST_ASSERT(nmea.body.gga.timeOfDayMs == 1000);
+    U_PORT_TEST_ASSERT(nmea.body.gga.latitudeX1e7 == -2);
+    U_PORT_TEST_ASSERT(nmea.body.gga.longitudeX1e7 == 1800000000);
+    U_PORT_TEST_ASSERT(nmea.body.gga.quality == 6);
+    U_PORT_TEST_ASSERT(nmea.body.gga.hdopX100 == 9999);
+    U_PORT_TEST_ASSERT(nmea.body.gga.altitudeMillimetres == -12300);
+    U_PORT_TEST_ASSERT(nmea.body.gga.diffAgeMs == U_GNSS_DEC_NMEA_NOT_PRESENT);
+    pSentence = gNmeaLog[25];
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence), &nmea) == 0);
+    U_PORT_TEST_ASSERT(nmea.body.gsv.numSat == 2);
+    U_PORT_TEST_ASSERT(nmea.body.gsv.sat[1].cnoDbHz == 41);
+    U_PORT_TEST_ASSERT(nmea.body.gsv.signalId == U_GNSS_DEC_NMEA_NOT_PRESENT);
+    pSentence = gNmeaLog[26];
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence), &nmea) == 0);
+    U_PORT_TEST_ASSERT(nmea.body.gst.timeOfDayMs == 62894000);
+    U_PORT_TEST_ASSERT(nmea.body.gst.rangeRmsMillimetres == 6);
+    U_PORT_TEST_ASSERT(nmea.body.gst.orientationX1e2 == 27360);
+    U_PORT_TEST_ASSERT(nmea.body.gst.stdAltitudeMillimetres == 31);
+    pSentence = gNmeaLog[27];
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence), &nmea) == 0);
+    U_PORT_TEST_ASSERT(nmea.body.vtg.courseTrueX1e2 == 35999);
+    U_PORT_TEST_ASSERT(nmea.body.vtg.speedMillimetresPerSecond == U_GNSS_DEC_NMEA_NOT_PRESENT);
+    pSentence = gNmeaLog[28];
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence), &nmea) == 0);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.timeOfDayMs == 86399990);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.status == 'V');
+    U_PORT_TEST_ASSERT(nmea.body.rmc.latitudeX1e7 == U_GNSS_DEC_NMEA_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.year == 1999);
+    U_PORT_TEST_ASSERT(nmea.body.rmc.navStatus == 'V');
+
+    // Error cases
+    pSentence = "$GPGLL,4916.45,N,12311.12,W,225444,A,*1D";
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence),
+                                    &nmea) == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+    pSentence = "$PUBX,00,081350.00,4717.113210,N*2C";
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence),
+                                    &nmea) == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+    pSentence = "$GPGGA,092750.000,5321.6802,N";
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence),
+                                    &nmea) == (int32_t) U_ERROR_COMMON_TRUNCATED);
+    pSentence = "$GPGGA,0927x0.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,";
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence),
+                                    &nmea) == (int32_t) U_ERROR_COMMON_BAD_DATA);
+    U_PORT_TEST_ASSERT(nmea.body.gga.timeOfDayMs == U_GNSS_DEC_NMEA_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(nmea.body.gga.latitudeX1e7 == 533613367);
+    pSentence = "$GPGGA,092750.000,5361.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,";
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence),
+                                    &nmea) == (int32_t) U_ERROR_COMMON_BAD_DATA);
+    U_PORT_TEST_ASSERT(nmea.body.gga.latitudeX1e7 == U_GNSS_DEC_NMEA_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(nmea.body.gga.longitudeX1e7 == -65056200);
+    pSentence = "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,99999999999999999999,M,55.2,M,,";
+    U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, strlen(pSentence),
+                                    &nmea) == (int32_t) U_ERROR_COMMON_BAD_DATA);
+    U_PORT_TEST_ASSERT(nmea.body.gga.altitudeMillimetres == U_GNSS_DEC_NMEA_NOT_PRESENT);
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Benchmark of uGnssDecNmea() against decoding with sscanf(),
+ * strtol() and strtod(), on the GGA and RMC sentences of the
+ * recorded log; the results of the two are also compared.
+ */
+U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecNmeaBenchmark")
+{
+    uGnssDecNmea_t nmea;
+    uGnssDecNmea_t baseline;
+    const char *pSentence;
+    size_t length[sizeof(gNmeaLog) / sizeof(gNmeaLog[0])];
+    int32_t count;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t rate[2];
+
+    for (size_t x = 0; x < sizeof(gNmeaLog) / sizeof(gNmeaLog[0]); x++) {
+        length[x] = strlen(gNmeaLog[x]);
+    }
+
+    // First, check that the two agree
+    for (size_t x = 0; x < sizeof(gNmeaLog) / sizeof(gNmeaLog[0]); x++) {
+        pSentence = gNmeaLog[x];
+        if (gNmeaLogSentence[x] == U_GNSS_DEC_NMEA_SENTENCE_GGA) {
+            memset(&baseline, 0, sizeof(baseline));
+            U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, length[x], &nmea) == 0);
+            U_PORT_TEST_ASSERT(baselineDecode(pSentence, &baseline) == 0);
+            U_PORT_TEST_ASSERT(baseline.sentence == nmea.sentence);
+            U_PORT_TEST_ASSERT(baseline.body.gga.timeOfDayMs == nmea.body.gga.timeOfDayMs);
+            U_PORT_TEST_ASSERT(baseline.body.gga.latitudeX1e7 - nmea.body.gga.latitudeX1e7 <= 1);
+            U_PORT_TEST_ASSERT(baseline.body.gga.latitudeX1e7 - nmea.body.gga.latitudeX1e7 >= -1);
+            U_PORT_TEST_ASSERT(baseline.body.gga.longitudeX1e7 - nmea.body.gga.longitudeX1e7 <= 1);
+            U_PORT_TEST_ASSERT(baseline.body.gga.longitudeX1e7 - nmea.body.gga.longitudeX1e7 >= -1);
+            U_PORT_TEST_ASSERT(baseline.body.gga.numSv == nmea.body.gga.numSv);
+            U_PORT_TEST_ASSERT(baseline.body.gga.hdopX100 == nmea.body.gga.hdopX100);
+        }
+        if (gNmeaLogSentence[x] == U_GNSS_DEC_NMEA_SENTENCE_RMC) {
+            memset(&baseline, 0, sizeof(baseline));
+            U_PORT_TEST_ASSERT(uGnssDecNmea(pSentence, length[x], &nmea) == 0);
+            U_PORT_TEST_ASSERT(baselineDecode(pSentence, &baseline) == 0);
+            U_PORT_TEST_ASSERT(baseline.sentence == nmea.sentence);
+            U_PORT_TEST_ASSERT(baseline.body.rmc.timeOfDayMs == nmea.body.rmc.timeOfDayMs);
+            if (nmea.body.rmc.status == 'A') {
+                // The baseline doesn't handle empty position fields
+                U_PORT_TEST_ASSERT(baseline.body.rmc.latitudeX1e7 - nmea.body.rmc.latitudeX1e7 <= 1);
+                U_PORT_TEST_ASSERT(baseline.body.rmc.latitudeX1e7 - nmea.body.rmc.latitudeX1e7 >= -1);
+            }
+            U_PORT_TEST_ASSERT(baseline.body.rmc.day == nmea.body.rmc.day);
+        }
+    }
+
+    // Now time them both on the same sentences
+    for (size_t y = 0; y < 2; y++) {
+        count = 0;
+        startTimeMs = uPortGetTickTimeMs();
+        do {
+            for (size_t x = 0; x < sizeof(gNmeaLog) / sizeof(gNmeaLog[0]); x++) {
+                if ((gNmeaLogSentence[x] == U_GNSS_DEC_NMEA_SENTENCE_GGA) ||
+                    (gNmeaLogSentence[x] == U_GNSS_DEC_NMEA_SENTENCE_RMC)) {
+                    if (y == 0) {
+                        uGnssDecNmea(gNmeaLog[x], length[x], &nmea);
+                    } else {
+                        baselineDecode(gNmeaLog[x], &baseline);
+                    }
+                    count++;
+                }
+            }
+            durationMs = uPortGetTickTimeMs() - startTimeMs;
+        } while (durationMs < U_GNSS_DEC_TEST_NMEA_BENCHMARK_MS);
+        rate[y] = (int32_t) (((int64_t) count) * 1000 / durationMs);
+    }
+    U_TEST_PRINT_LINE("GGA/RMC decode: uGnssDecNmea() %d sentences/second,"
+                      " sscanf() baseline %d sentences/second.", rate[0], rate[1]);
+    // And the whole log with uGnssDecNmea()
+    count = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    do {
+        for (size_t x = 0; x < sizeof(gNmeaLog) / sizeof(gNmeaLog[0]); x++) {
+            uGnssDecNmea(gNmeaLog[x], length[x], &nmea);
+            count++;
+        }
+        durationMs = uPortGetTickTimeMs() - startTimeMs;
+    } while (durationMs < U_GNSS_DEC_TEST_NMEA_BENCHMARK_MS);
+    U_TEST_PRINT_LINE("all sentences: uGnssDecNmea() %d sentences/second.",
+                      (int32_t) (((int64_t) count) * 1000 / durationMs));
+    U_PORT_TEST_ASSERT(rate[0] > rate[1]);
+}
+
 // End of file
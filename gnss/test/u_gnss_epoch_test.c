@@ -0,0 +1,688 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the navigation-epoch assembler of the GNSS API.
+ * No GNSS chip is required: the GNSS instance is on UART A and the
+ * test writes streams of UBX-NAV messages, as a GNSS chip would
+ * emit them, to UART B.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_epoch.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The base string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX_BASE "U_GNSS_EPOCH_TEST"
+
+/** The string to put at the start of all prints from this test
+ * that do not require an iteration on the end.
+ */
+#define U_TEST_PREFIX U_TEST_PREFIX_BASE ": "
+
+/** Print a whole line, with terminator, prefixed for this test
+ * file, no iteration version.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_GNSS_EPOCH_TEST_TIMEOUT_MS
+/** The epoch timeout to use.
+ */
+# define U_GNSS_EPOCH_TEST_TIMEOUT_MS 200
+#endif
+
+#ifndef U_GNSS_EPOCH_TEST_NUM_EPOCHS
+/** The number of epochs to send when measuring latency.
+ */
+# define U_GNSS_EPOCH_TEST_NUM_EPOCHS 50
+#endif
+
+#ifndef U_GNSS_EPOCH_TEST_PERIOD_MS
+/** The time between epochs when measuring latency.
+ */
+# define U_GNSS_EPOCH_TEST_PERIOD_MS 50
+#endif
+
+/** The number of epochs that are recorded.
+ */
+#define U_GNSS_EPOCH_TEST_MAX_NUM_RECORDS 16
+
+/** The number of satellites in each UBX-NAV-SAT message.
+ */
+#define U_GNSS_EPOCH_TEST_NUM_SVS 3
+
+/** The messages that the tests ask for: everything except
+ * UBX-NAV-HPPOSLLH, which is sent but should be ignored.
+ */
+#define U_GNSS_EPOCH_TEST_MESSAGES (U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_PVT) |    \
+                                    U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_DOP) |    \
+                                    U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_STATUS) | \
+                                    U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_COV) |    \
+                                    U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_SAT))
+
+/** Marks UBX-NAV-EOE in a #uGnssEpochTestStep_t.
+ */
+#define U_GNSS_EPOCH_TEST_EOE -1
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** One message of a stream.
+ */
+typedef struct {
+    int32_t message; /**< a uGnssEpochMessage_t or #U_GNSS_EPOCH_TEST_EOE. */
+    uint32_t iTOW;
+} uGnssEpochTestStep_t;
+
+/** What the callback saw of an epoch.
+ */
+typedef struct {
+    uint32_t iTOW;
+    uint32_t messageBitmap;
+    bool complete;
+    uGnssEpochClosedBy_t closedBy;
+    bool contentsOk; /**< true if every message present had the expected contents. */
+    int32_t durationMs; /**< closeTimeMs - openTimeMs. */
+} uGnssEpochTestRecord_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Handle of UART A, on which the GNSS instance is.
+ */
+static int32_t gUartAHandle = -1;
+
+/** Handle of UART B, to which the "GNSS chip" writes.
+ */
+static int32_t gUartBHandle = -1;
+
+/** The GNSS handle.
+ */
+static uDeviceHandle_t gGnssHandle = NULL;
+
+/** Something to pass to the callback as a parameter.
+ */
+static int32_t gCallbackParam = 0;
+
+/** The epochs the callback has seen.
+ */
+static uGnssEpochTestRecord_t gRecord[U_GNSS_EPOCH_TEST_MAX_NUM_RECORDS];
+
+/** The number of times the callback has been called.
+ */
+static volatile size_t gNumCallbacks = 0;
+
+/** The number of times the callback was called with the wrong
+ * parameters.
+ */
+static volatile size_t gNumBadCallbacks = 0;
+
+/** How long the callback should take.
+ */
+static volatile int32_t gCallbackDelayMs = 0;
+
+/** The time at which UBX-NAV-EOE was last written, -1 for none.
+ */
+static volatile int32_t gEoeWriteTimeMs = -1;
+
+/** The latency from the UBX-NAV-EOE write to the callback.
+ */
+static volatile int32_t gLatencyTotalMs = 0;
+static volatile int32_t gLatencyMaxMs = 0;
+static volatile size_t gLatencyCount = 0;
+
+/** A complete epoch in the usual order, with UBX-NAV-HPPOSLLH,
+ * which is not asked for, included.
+ */
+static const uGnssEpochTestStep_t gStreamComplete[] = {
+    {U_GNSS_EPOCH_MESSAGE_NAV_PVT, 1000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_HPPOSLLH, 1000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_DOP, 1000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_STATUS, 1000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_COV, 1000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_SAT, 1000},
+    {U_GNSS_EPOCH_TEST_EOE, 1000}
+};
+
+/** A complete epoch with the messages in a different order.
+ */
+static const uGnssEpochTestStep_t gStreamReordered[] = {
+    {U_GNSS_EPOCH_MESSAGE_NAV_SAT, 2000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_COV, 2000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_PVT, 2000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_STATUS, 2000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_DOP, 2000},
+    {U_GNSS_EPOCH_TEST_EOE, 2000}
+};
+
+/** An epoch with messages missing.
+ */
+static const uGnssEpochTestStep_t gStreamMissing[] = {
+    {U_GNSS_EPOCH_MESSAGE_NAV_DOP, 3000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_HPPOSLLH, 3000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_PVT, 3000},
+    {U_GNSS_EPOCH_TEST_EOE, 3000}
+};
+
+/** A complete epoch without UBX-NAV-EOE, followed by the
+ * first message of the next epoch.
+ */
+static const uGnssEpochTestStep_t gStreamNoEoe[] = {
+    {U_GNSS_EPOCH_MESSAGE_NAV_PVT, 4000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_DOP, 4000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_STATUS, 4000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_COV, 4000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_SAT, 4000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_PVT, 5000}
+};
+
+/** The end of the epoch begun by gStreamNoEoe[].
+ */
+static const uGnssEpochTestStep_t gStreamNoEoeEnd[] = {
+    {U_GNSS_EPOCH_TEST_EOE, 5000}
+};
+
+/** A complete epoch followed by two late messages, one from that
+ * epoch and one from the one before, and then the next epoch.
+ */
+static const uGnssEpochTestStep_t gStreamLate[] = {
+    {U_GNSS_EPOCH_MESSAGE_NAV_PVT, 6000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_DOP, 6000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_STATUS, 6000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_COV, 6000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_SAT, 6000},
+    {U_GNSS_EPOCH_TEST_EOE, 6000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_DOP, 6000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_PVT, 5000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_PVT, 7000},
+    {U_GNSS_EPOCH_TEST_EOE, 7000}
+};
+
+/** The start of an epoch that never ends.
+ */
+static const uGnssEpochTestStep_t gStreamTimeout[] = {
+    {U_GNSS_EPOCH_MESSAGE_NAV_PVT, 8000},
+    {U_GNSS_EPOCH_MESSAGE_NAV_DOP, 8000}
+};
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+// Put a little-endian uint32_t into a buffer.
+static void uint32Put(char *pBuffer, uint32_t value)
+{
+    for (size_t x = 0; x < sizeof(value); x++) {
+        *pBuffer = (char) (value >> (x * 8));
+        pBuffer++;
+    }
+}
+
+// Encode a UBX-NAV message with the given iTOW and contents that
+// contentsCheck() recognises; returns the length of the message.
+static size_t messageEncode(char *pBuffer, int32_t message, uint32_t iTOW)
+{
+    char body[92] = {0};
+    int32_t id = 0x61; // UBX-NAV-EOE
+    size_t length = 4;
+    size_t iTowOffset = 0;
+
+    switch (message) {
+        case U_GNSS_EPOCH_MESSAGE_NAV_PVT:
+            id = U_GNSS_DEC_UBX_NAV_PVT_MESSAGE_ID;
+            length = 92;
+            body[23] = 7; // numSV
+            break;
+        case U_GNSS_EPOCH_MESSAGE_NAV_HPPOSLLH:
+            id = U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_ID;
+            length = U_GNSS_DEC_UBX_NAV_HPPOSLLH_BODY_MIN_LENGTH;
+            iTowOffset = 4;
+            break;
+        case U_GNSS_EPOCH_MESSAGE_NAV_DOP:
+            id = U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_ID;
+            length = U_GNSS_DEC_UBX_NAV_DOP_BODY_MIN_LENGTH;
+            // pDOP
+            body[6] = (char) (iTOW / 1000);
+            break;
+        case U_GNSS_EPOCH_MESSAGE_NAV_STATUS:
+            id = U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_ID;
+            length = U_GNSS_DEC_UBX_NAV_STATUS_BODY_MIN_LENGTH;
+            body[4] = 3; // gpsFix
+            break;
+        case U_GNSS_EPOCH_MESSAGE_NAV_COV:
+            id = U_GNSS_DEC_UBX_NAV_COV_MESSAGE_ID;
+            length = U_GNSS_DEC_UBX_NAV_COV_BODY_MIN_LENGTH;
+            body[5] = 1; // posCovValid
+            break;
+        case U_GNSS_EPOCH_MESSAGE_NAV_SAT:
+            id = U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_ID;
+            length = U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH +
+                     (U_GNSS_EPOCH_TEST_NUM_SVS * U_GNSS_DEC_UBX_NAV_SAT_SV_LENGTH);
+            body[4] = 1; // version
+            body[5] = U_GNSS_EPOCH_TEST_NUM_SVS;
+            for (size_t x = 0; x < U_GNSS_EPOCH_TEST_NUM_SVS; x++) {
+                // svId
+                body[U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH +
+                                                            (x * U_GNSS_DEC_UBX_NAV_SAT_SV_LENGTH) + 1] = (char) (x + 1);
+            }
+            break;
+        default:
+            break;
+    }
+    uint32Put(body + iTowOffset, iTOW);
+
+    return (size_t) uUbxProtocolEncode(0x01, id, body, length, pBuffer);
+}
+
+// Check that the messages of an epoch contain what messageEncode()
+// put in them.
+static bool contentsCheck(const uGnssEpoch_t *pEpoch)
+{
+    bool ok = true;
+    uint32_t bitmap = pEpoch->messageBitmap;
+
+    if (bitmap & U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_PVT)) {
+        ok = ok && (pEpoch->navPvt.iTOW == pEpoch->iTOW) && (pEpoch->navPvt.numSV == 7);
+    }
+    if (bitmap & U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_DOP)) {
+        ok = ok && (pEpoch->navDop.iTOW == pEpoch->iTOW) &&
+             (pEpoch->navDop.pDOP == (uint8_t) (pEpoch->iTOW / 1000));
+    }
+    if (bitmap & U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_STATUS)) {
+        ok = ok && (pEpoch->navStatus.iTOW == pEpoch->iTOW) &&
+             (pEpoch->navStatus.gpsFix == U_GNSS_DEC_UBX_NAV_STATUS_GPS_FIX_3D);
+    }
+    if (bitmap & U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_COV)) {
+        ok = ok && (pEpoch->navCov.iTOW == pEpoch->iTOW) && pEpoch->navCov.posCovValid;
+    }
+    if (bitmap & U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_SAT)) {
+        ok = ok && (pEpoch->navSat.iTOW == pEpoch->iTOW) &&
+             (pEpoch->navSat.numSvs == U_GNSS_EPOCH_TEST_NUM_SVS);
+        for (size_t x = 0; ok && (x < U_GNSS_EPOCH_TEST_NUM_SVS); x++) {
+            ok = (pEpoch->navSat.sv[x].svId == x + 1);
+        }
+    }
+
+    return ok;
+}
+
+// The epoch callback: records what it is given.
+static void epochCallback(uDeviceHandle_t gnssHandle,
+                          const uGnssEpoch_t *pEpoch,
+                          void *pCallbackParam)
+{
+    uGnssEpochTestRecord_t *pRecord;
+    int32_t latencyMs;
+    int32_t delayMs = gCallbackDelayMs;
+
+    if ((gnssHandle != gGnssHandle) || (pCallbackParam != &gCallbackParam) ||
+        (pEpoch == NULL)) {
+        gNumBadCallbacks++;
+    } else {
+        if (gEoeWriteTimeMs >= 0) {
+            latencyMs = uPortGetTickTimeMs() - gEoeWriteTimeMs;
+            gEoeWriteTimeMs = -1;
+            gLatencyTotalMs += latencyMs;
+            if (latencyMs > gLatencyMaxMs) {
+                gLatencyMaxMs = latencyMs;
+            }
+            gLatencyCount++;
+        }
+        if (gNumCallbacks < U_GNSS_EPOCH_TEST_MAX_NUM_RECORDS) {
+            pRecord = &(gRecord[gNumCallbacks]);
+            pRecord->iTOW = pEpoch->iTOW;
+            pRecord->messageBitmap = pEpoch->messageBitmap;
+            pRecord->complete = pEpoch->complete;
+            pRecord->closedBy = pEpoch->closedBy;
+            pRecord->contentsOk = contentsCheck(pEpoch);
+            pRecord->durationMs = pEpoch->closeTimeMs - pEpoch->openTimeMs;
+        }
+        gNumCallbacks++;
+        if (delayMs > 0) {
+            uPortTaskBlock(delayMs);
+        }
+    }
+}
+
+// Write a stream of messages to UART B, as the GNSS chip would.
+static void streamSend(const uGnssEpochTestStep_t *pStep, size_t numSteps)
+{
+    char buffer[92 + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    size_t length;
+
+    for (size_t x = 0; x < numSteps; x++) {
+        length = messageEncode(buffer, pStep->message, pStep->iTOW);
+        if (pStep->message == U_GNSS_EPOCH_TEST_EOE) {
+            gEoeWriteTimeMs = uPortGetTickTimeMs();
+        }
+        U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, buffer, length) == length);
+        pStep++;
+    }
+}
+
+// Wait for the callback to have been called a number of times.
+static bool waitCallbacks(size_t numCallbacks, int32_t timeoutMs)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((gNumCallbacks < numCallbacks) &&
+           (uPortGetTickTimeMs() - startTimeMs < timeoutMs)) {
+        uPortTaskBlock(10);
+    }
+
+    return (gNumCallbacks >= numCallbacks);
+}
+
+// Check a record.
+static void recordCheck(size_t index, uint32_t iTOW, uint32_t messageBitmap,
+                        uGnssEpochClosedBy_t closedBy)
+{
+    const uGnssEpochTestRecord_t *pRecord = &(gRecord[index]);
+
+    U_TEST_PRINT_LINE("epoch %d: iTOW %d, messages 0x%02x%s, closed by %d, %d ms.",
+                      index, (int32_t) pRecord->iTOW, (int32_t) pRecord->messageBitmap,
+                      pRecord->complete ? " (complete)" : "", pRecord->closedBy,
+                      pRecord->durationMs);
+    U_PORT_TEST_ASSERT(pRecord->iTOW == iTOW);
+    U_PORT_TEST_ASSERT(pRecord->messageBitmap == messageBitmap);
+    U_PORT_TEST_ASSERT(pRecord->complete == (messageBitmap == U_GNSS_EPOCH_TEST_MESSAGES));
+    U_PORT_TEST_ASSERT(pRecord->closedBy == closedBy);
+    U_PORT_TEST_ASSERT(pRecord->contentsOk);
+}
+
+// Open the UARTs and add a GNSS instance.
+static void openAll()
+{
+    uGnssTransportHandle_t transportHandle;
+
+#ifdef U_CFG_TEST_UART_PREFIX
+    U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+#endif
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+    transportHandle.uart = gUartAHandle;
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M9, U_GNSS_TRANSPORT_UART,
+                                transportHandle, -1, false, &gGnssHandle) == 0);
+}
+
+// Undo openAll().
+static void closeAll()
+{
+    uGnssDeinit();
+    gGnssHandle = NULL;
+    if (gUartBHandle >= 0) {
+        uPortUartClose(gUartBHandle);
+        gUartBHandle = -1;
+    }
+    if (gUartAHandle >= 0) {
+        uPortUartClose(gUartAHandle);
+        gUartAHandle = -1;
+    }
+}
+#endif
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Test the navigation-epoch assembler with recorded streams of
+ * UBX-NAV messages: complete epochs, reordered and missing
+ * messages, a missing UBX-NAV-EOE, late messages, a timeout and a
+ * slow callback, then measure the delivery latency after
+ * UBX-NAV-EOE.
+ */
+U_PORT_TEST_FUNCTION("[gnssEpoch]", "gnssEpochStreams")
+{
+    int32_t resourceCount;
+    uGnssEpochStats_t stats;
+    uint32_t iTOW;
+    size_t numCallbacks;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    openAll();
+    memset(gRecord, 0, sizeof(gRecord));
+    gNumCallbacks = 0;
+    gNumBadCallbacks = 0;
+    gCallbackDelayMs = 0;
+    gEoeWriteTimeMs = -1;
+
+    // Not started, so this should fail
+    U_PORT_TEST_ASSERT(uGnssEpochGetStats(gGnssHandle, &stats) < 0);
+    // Bad parameters
+    U_PORT_TEST_ASSERT(uGnssEpochStart(gGnssHandle, 0, 0, epochCallback, &gCallbackParam) < 0);
+    U_PORT_TEST_ASSERT(uGnssEpochStart(gGnssHandle,
+                                       U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_MAX_NUM),
+                                       0, epochCallback, &gCallbackParam) < 0);
+    U_PORT_TEST_ASSERT(uGnssEpochStart(gGnssHandle, U_GNSS_EPOCH_TEST_MESSAGES,
+                                       0, NULL, &gCallbackParam) < 0);
+    U_PORT_TEST_ASSERT(uGnssEpochStart(gGnssHandle, U_GNSS_EPOCH_TEST_MESSAGES,
+                                       U_GNSS_EPOCH_TEST_TIMEOUT_MS, epochCallback,
+                                       &gCallbackParam) == 0);
+
+    // A complete epoch, with a message that was not asked for
+    streamSend(gStreamComplete, sizeof(gStreamComplete) / sizeof(gStreamComplete[0]));
+    U_PORT_TEST_ASSERT(waitCallbacks(1, 1000));
+    recordCheck(0, 1000, U_GNSS_EPOCH_TEST_MESSAGES, U_GNSS_EPOCH_CLOSED_BY_EOE);
+
+    // Reordered
+    streamSend(gStreamReordered, sizeof(gStreamReordered) / sizeof(gStreamReordered[0]));
+    U_PORT_TEST_ASSERT(waitCallbacks(2, 1000));
+    recordCheck(1, 2000, U_GNSS_EPOCH_TEST_MESSAGES, U_GNSS_EPOCH_CLOSED_BY_EOE);
+
+    // Missing messages
+    streamSend(gStreamMissing, sizeof(gStreamMissing) / sizeof(gStreamMissing[0]));
+    U_PORT_TEST_ASSERT(waitCallbacks(3, 1000));
+    recordCheck(2, 3000, U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_PVT) |
+                U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_DOP),
+                U_GNSS_EPOCH_CLOSED_BY_EOE);
+
+    // No UBX-NAV-EOE: closed by the first message of the next
+    // epoch, which is then closed by its UBX-NAV-EOE
+    streamSend(gStreamNoEoe, sizeof(gStreamNoEoe) / sizeof(gStreamNoEoe[0]));
+    U_PORT_TEST_ASSERT(waitCallbacks(4, 1000));
+    recordCheck(3, 4000, U_GNSS_EPOCH_TEST_MESSAGES, U_GNSS_EPOCH_CLOSED_BY_NEXT_EPOCH);
+    streamSend(gStreamNoEoeEnd, sizeof(gStreamNoEoeEnd) / sizeof(gStreamNoEoeEnd[0]));
+    U_PORT_TEST_ASSERT(waitCallbacks(5, 1000));
+    recordCheck(4, 5000, U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_PVT),
+                U_GNSS_EPOCH_CLOSED_BY_EOE);
+
+    // Late messages are discarded
+    streamSend(gStreamLate, 6);
+    U_PORT_TEST_ASSERT(waitCallbacks(6, 1000));
+    streamSend(gStreamLate + 6, (sizeof(gStreamLate) / sizeof(gStreamLate[0])) - 6);
+    U_PORT_TEST_ASSERT(waitCallbacks(7, 1000));
+    recordCheck(5, 6000, U_GNSS_EPOCH_TEST_MESSAGES, U_GNSS_EPOCH_CLOSED_BY_EOE);
+    recordCheck(6, 7000, U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_PVT),
+                U_GNSS_EPOCH_CLOSED_BY_EOE);
+
+    // Timeout
+    streamSend(gStreamTimeout, sizeof(gStreamTimeout) / sizeof(gStreamTimeout[0]));
+    U_PORT_TEST_ASSERT(waitCallbacks(8, U_GNSS_EPOCH_TEST_TIMEOUT_MS + 1000));
+    recordCheck(7, 8000, U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_PVT) |
+                U_GNSS_EPOCH_MESSAGE_BIT(U_GNSS_EPOCH_MESSAGE_NAV_DOP),
+                U_GNSS_EPOCH_CLOSED_BY_TIMEOUT);
+    U_PORT_TEST_ASSERT(gRecord[7].durationMs >= U_GNSS_EPOCH_TEST_TIMEOUT_MS);
+
+    U_PORT_TEST_ASSERT(uGnssEpochGetStats(gGnssHandle, &stats) == 0);
+    U_TEST_PRINT_LINE("%d epoch(s) delivered, %d incomplete, %d timed out,"
+                      " %d dropped, %d late message(s).", stats.epochsDelivered,
+                      stats.epochsIncomplete, stats.epochsTimedOut,
+                      stats.epochsDropped, stats.messagesLate);
+    U_PORT_TEST_ASSERT(stats.epochsDelivered == 8);
+    U_PORT_TEST_ASSERT(stats.epochsIncomplete == 4);
+    U_PORT_TEST_ASSERT(stats.epochsTimedOut == 1);
+    U_PORT_TEST_ASSERT(stats.epochsDropped == 0);
+    U_PORT_TEST_ASSERT(stats.messagesLate == 2);
+
+    // A callback that is still busy when the next epoch closes
+    // causes that epoch to be dropped
+    gCallbackDelayMs = 1000;
+    iTOW = 9000;
+    for (size_t x = 0; x < 3; x++) {
+        for (size_t y = 0; y < sizeof(gStreamComplete) / sizeof(gStreamComplete[0]); y++) {
+            uGnssEpochTestStep_t step = gStreamComplete[y];
+            step.iTOW = iTOW;
+            streamSend(&step, 1);
+        }
+        if (x == 0) {
+            // Wait for the callback to be busy with the first
+            U_PORT_TEST_ASSERT(waitCallbacks(9, 1000));
+            gCallbackDelayMs = 0;
+        }
+        iTOW += 1000;
+    }
+    uPortTaskBlock(2000);
+    U_PORT_TEST_ASSERT(uGnssEpochGetStats(gGnssHandle, &stats) == 0);
+    U_TEST_PRINT_LINE("slow callback: %d epoch(s) delivered, %d dropped.",
+                      stats.epochsDelivered, stats.epochsDropped);
+    U_PORT_TEST_ASSERT(stats.epochsDelivered == 9);
+    U_PORT_TEST_ASSERT(stats.epochsDropped == 2);
+
+    // Measure latency: restarting resets the statistics
+    U_PORT_TEST_ASSERT(uGnssEpochStart(gGnssHandle, U_GNSS_EPOCH_TEST_MESSAGES,
+                                       U_GNSS_EPOCH_TEST_TIMEOUT_MS, epochCallback,
+                                       &gCallbackParam) == 0);
+    U_PORT_TEST_ASSERT(uGnssEpochGetStats(gGnssHandle, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.epochsDelivered == 0);
+    gLatencyTotalMs = 0;
+    gLatencyMaxMs = 0;
+    gLatencyCount = 0;
+    numCallbacks = gNumCallbacks;
+    iTOW = 100000;
+    for (size_t x = 0; x < U_GNSS_EPOCH_TEST_NUM_EPOCHS; x++) {
+        for (size_t y = 0; y < sizeof(gStreamReordered) / sizeof(gStreamReordered[0]); y++) {
+            uGnssEpochTestStep_t step = gStreamReordered[y];
+            step.iTOW = iTOW;
+            streamSend(&step, 1);
+        }
+        U_PORT_TEST_ASSERT(waitCallbacks(numCallbacks + x + 1, 1000));
+        iTOW += 1000;
+        uPortTaskBlock(U_GNSS_EPOCH_TEST_PERIOD_MS);
+    }
+    U_PORT_TEST_ASSERT(uGnssEpochGetStats(gGnssHandle, &stats) == 0);
+    U_TEST_PRINT_LINE("%d epoch(s) delivered; latency from UBX-NAV-EOE written"
+                      " to callback average %d ms, worst %d ms; from epoch closed"
+                      " to callback average %d ms, worst %d ms.", stats.epochsDelivered,
+                      gLatencyTotalMs / (int32_t) gLatencyCount, gLatencyMaxMs,
+                      stats.latencyAverageMs, stats.latencyMaxMs);
+    U_PORT_TEST_ASSERT(stats.epochsDelivered == U_GNSS_EPOCH_TEST_NUM_EPOCHS);
+    U_PORT_TEST_ASSERT(stats.epochsIncomplete == 0);
+    U_PORT_TEST_ASSERT(stats.epochsDropped == 0);
+    U_PORT_TEST_ASSERT(gLatencyCount == U_GNSS_EPOCH_TEST_NUM_EPOCHS);
+    U_PORT_TEST_ASSERT(gNumBadCallbacks == 0);
+
+    uGnssEpochStop(gGnssHandle);
+    U_PORT_TEST_ASSERT(uGnssEpochGetStats(gGnssHandle, &stats) < 0);
+
+    // Leave one running to check that uGnssDeinit() gets rid of it
+    U_PORT_TEST_ASSERT(uGnssEpochStart(gGnssHandle, U_GNSS_EPOCH_TEST_MESSAGES,
+                                       0, epochCallback, &gCallbackParam) == 0);
+    closeAll();
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[gnssEpoch]", "gnssEpochCleanUp")
+{
+    closeAll();
+    uPortDeinit();
+}
+#endif
+
+// End of file
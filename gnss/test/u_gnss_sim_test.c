@@ -0,0 +1,655 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests and benchmarks of the GNSS API against the simulated
+ * GNSS chip of u_gnss_test_sim.h, so no GNSS chip is required: the
+ * simulator answers polls and configuration messages, its fault
+ * injection is survived, and, for each transport, the end-to-end
+ * latency of the messages of a navigation epoch and the CPU time
+ * per message are measured at a nominal and at a stress load.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), strncmp(), strstr()
+#include "time.h"      // clock()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+#include "u_port_pps.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_cfg.h"
+#include "u_gnss_cfg_val_key.h"
+#include "u_gnss_info.h"
+#include "u_gnss_msg.h"
+
+#include "u_gnss_test_sim.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The base string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX_BASE "U_GNSS_SIM_TEST"
+
+/** The string to put at the start of all prints from this test
+ * that do not require an iteration on the end.
+ */
+#define U_TEST_PREFIX U_TEST_PREFIX_BASE ": "
+
+/** Print a whole line, with terminator, prefixed for this test
+ * file, no iteration version.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_GNSS_SIM_TEST_DURATION_MS
+/** How long each benchmark runs for.
+ */
+# define U_GNSS_SIM_TEST_DURATION_MS 3000
+#endif
+
+#ifndef U_GNSS_SIM_TEST_DRAIN_TIMEOUT_MS
+/** The longest time to wait, once the simulator has stopped
+ * emitting epochs, for what it emitted to be delivered.
+ */
+# define U_GNSS_SIM_TEST_DRAIN_TIMEOUT_MS 5000
+#endif
+
+#ifndef U_GNSS_SIM_TEST_I2C_BYTES_PER_SECOND
+/** The byte rate of a 400 kHz I2C bus, nine clocks per byte.
+ */
+# define U_GNSS_SIM_TEST_I2C_BYTES_PER_SECOND (400000 / 9)
+#endif
+
+#ifndef U_GNSS_SIM_TEST_SPI_BYTES_PER_SECOND
+/** The byte rate of a 5 MHz SPI bus.
+ */
+# define U_GNSS_SIM_TEST_SPI_BYTES_PER_SECOND (5000000 / 8)
+#endif
+
+/** The messages of the nominal load.
+ */
+#define U_GNSS_SIM_TEST_STREAMS_NOMINAL (U_GNSS_TEST_SIM_STREAM_BIT(U_GNSS_TEST_SIM_STREAM_UBX_NAV_PVT) | \
+                                         U_GNSS_TEST_SIM_STREAM_BIT(U_GNSS_TEST_SIM_STREAM_NMEA_GGA) |   \
+                                         U_GNSS_TEST_SIM_STREAM_BIT(U_GNSS_TEST_SIM_STREAM_RTCM_1005) |  \
+                                         U_GNSS_TEST_SIM_STREAM_BIT(U_GNSS_TEST_SIM_STREAM_UBX_NAV_EOE))
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A transport to benchmark.
+ */
+typedef struct {
+    const char *pName;
+    uGnssTestSimTransport_t transport;
+    int32_t busBytesPerSecond;
+    size_t fillBytes;
+} uGnssSimTestTransport_t;
+
+/** A load to benchmark.
+ */
+typedef struct {
+    const char *pName;
+    int32_t rateHz;
+    uint32_t streamBitmap;
+    size_t numSvs;
+    bool lossless; /**< true if every message must be delivered. */
+} uGnssSimTestLoad_t;
+
+/** What the message callback has seen.
+ */
+typedef struct {
+    size_t received[U_GNSS_TEST_SIM_STREAM_MAX_NUM];
+    size_t receivedTotal;
+    size_t unknown;         /**< stretches of data that the GNSS API
+                                 could not decode, e.g. fill bytes. */
+    size_t unmatched;       /**< messages not written by the simulator. */
+    size_t latencyCount;
+    int64_t latencyTotalNs;
+    int64_t latencyMaxNs;
+} uGnssSimTestResult_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Handle of UART A, on which the GNSS instance is for the UART
+ * transport.
+ */
+static int32_t gUartAHandle = -1;
+
+/** Handle of UART B, to which the simulator writes.
+ */
+static int32_t gUartBHandle = -1;
+#endif
+
+/** The GNSS handle.
+ */
+static uDeviceHandle_t gGnssHandle = NULL;
+
+/** The virtual serial device, if open.
+ */
+static uDeviceSerial_t *gpDeviceSerial = NULL;
+
+/** What the message callback has seen.
+ */
+static uGnssSimTestResult_t gResult;
+
+/** The transports to benchmark.
+ */
+static const uGnssSimTestTransport_t gTransport[] = {
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+    {"UART", U_GNSS_TEST_SIM_TRANSPORT_UART, 0, 0},
+#endif
+    {"in-process", U_GNSS_TEST_SIM_TRANSPORT_VIRTUAL_SERIAL, 0, 0},
+    {"I2C 400 kHz", U_GNSS_TEST_SIM_TRANSPORT_VIRTUAL_SERIAL, U_GNSS_SIM_TEST_I2C_BYTES_PER_SECOND, 0},
+    {"SPI 5 MHz", U_GNSS_TEST_SIM_TRANSPORT_VIRTUAL_SERIAL, U_GNSS_SIM_TEST_SPI_BYTES_PER_SECOND, 32}
+};
+
+/** The loads to benchmark.
+ */
+static const uGnssSimTestLoad_t gLoad[] = {
+    {"nominal", 5, U_GNSS_SIM_TEST_STREAMS_NOMINAL, 12, true},
+    {"stress", U_GNSS_TEST_SIM_RATE_MAX_HZ, U_GNSS_TEST_SIM_STREAMS_ALL, 32, false}
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Convert the hhmmss.ss of an NMEA message into milliseconds.
+static uint32_t nmeaTimeMs(const char *pTime)
+{
+    uint32_t timeMs = 0;
+    const int32_t multiplier[] = {36000000, 3600000, 600000, 60000, 10000,
+                                  1000, 0, 100, 10
+                                 };
+
+    for (size_t x = 0; x < sizeof(multiplier) / sizeof(multiplier[0]); x++) {
+        if ((pTime[x] >= '0') && (pTime[x] <= '9')) {
+            timeMs += (uint32_t) ((pTime[x] - '0') * multiplier[x]);
+        }
+    }
+
+    return timeMs;
+}
+
+// The message callback: works out which message of which epoch
+// has arrived and, from the simulator's record of when that was
+// written, the latency.
+static void messageCallback(uDeviceHandle_t gnssHandle,
+                            const uGnssMessageId_t *pMessageId,
+                            int32_t errorCodeOrLength,
+                            void *pCallbackParam)
+{
+    uGnssSimTestResult_t *pResult = (uGnssSimTestResult_t *) pCallbackParam;
+    int64_t nowNs = uPortPpsGetTimeNs();
+    char buffer[32] = {0};
+    int32_t stream = -1;
+    uint32_t iTOW = 0;
+    uint64_t bits;
+    double rcvTow;
+    int64_t writeTimeNs;
+
+    if ((errorCodeOrLength > 0) && (pResult != NULL)) {
+        uGnssMsgReceiveCallbackRead(gnssHandle, buffer, sizeof(buffer));
+        switch (pMessageId->type) {
+            case U_GNSS_PROTOCOL_UBX:
+                iTOW = uUbxProtocolUint32Decode(buffer + 6);
+                switch (pMessageId->id.ubx) {
+                    case 0x0107:
+                        stream = U_GNSS_TEST_SIM_STREAM_UBX_NAV_PVT;
+                        break;
+                    case 0x0135:
+                        stream = U_GNSS_TEST_SIM_STREAM_UBX_NAV_SAT;
+                        break;
+                    case 0x0161:
+                        stream = U_GNSS_TEST_SIM_STREAM_UBX_NAV_EOE;
+                        break;
+                    case 0x0215:
+                        stream = U_GNSS_TEST_SIM_STREAM_UBX_RXM_RAWX;
+                        bits = uUbxProtocolUint64Decode(buffer + 6);
+                        memcpy(&rcvTow, &bits, sizeof(rcvTow));
+                        iTOW = (uint32_t) ((rcvTow * 1000) + 0.5);
+                        break;
+                    default:
+                        break;
+                }
+                break;
+            case U_GNSS_PROTOCOL_NMEA:
+                if (strstr(buffer, "$GNGGA,") == buffer) {
+                    stream = U_GNSS_TEST_SIM_STREAM_NMEA_GGA;
+                } else if (strstr(buffer, "$GNRMC,") == buffer) {
+                    stream = U_GNSS_TEST_SIM_STREAM_NMEA_RMC;
+                }
+                iTOW = nmeaTimeMs(buffer + 7);
+                break;
+            case U_GNSS_PROTOCOL_RTCM:
+                if (pMessageId->id.rtcm == 1005) {
+                    stream = U_GNSS_TEST_SIM_STREAM_RTCM_1005;
+                }
+                break;
+            default:
+                break;
+        }
+        if (pMessageId->type == U_GNSS_PROTOCOL_UNKNOWN) {
+            pResult->unknown++;
+        } else if (stream >= 0) {
+            pResult->receivedTotal++;
+            pResult->received[stream]++;
+            if (stream != U_GNSS_TEST_SIM_STREAM_RTCM_1005) {
+                // RTCM 1005 carries no time
+                writeTimeNs = uGnssTestSimGetWriteTimeNs((uGnssTestSimStream_t) stream, iTOW);
+                if (writeTimeNs >= 0) {
+                    pResult->latencyTotalNs += nowNs - writeTimeNs;
+                    if (nowNs - writeTimeNs > pResult->latencyMaxNs) {
+                        pResult->latencyMaxNs = nowNs - writeTimeNs;
+                    }
+                    pResult->latencyCount++;
+                } else {
+                    pResult->unmatched++;
+                }
+            }
+        } else {
+            pResult->receivedTotal++;
+            pResult->unmatched++;
+        }
+    }
+}
+
+// Start the simulator and add a GNSS instance talking to it.
+static void simOpen(const uGnssTestSimConfig_t *pConfig)
+{
+    uGnssTransportType_t transportType = U_GNSS_TRANSPORT_VIRTUAL_SERIAL;
+    uGnssTransportHandle_t transportHandle;
+    uGnssTestSimConfig_t config = *pConfig;
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+    if (config.transport == U_GNSS_TEST_SIM_TRANSPORT_UART) {
+# ifdef U_CFG_TEST_UART_PREFIX
+        U_PORT_TEST_ASSERT(uPortUartPrefix(U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)) == 0);
+# endif
+        gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                     U_CFG_TEST_BAUD_RATE,
+                                     NULL,
+                                     U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                     U_CFG_TEST_PIN_UART_A_TXD,
+                                     U_CFG_TEST_PIN_UART_A_RXD,
+                                     U_CFG_TEST_PIN_UART_A_CTS,
+                                     U_CFG_TEST_PIN_UART_A_RTS);
+        U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+        gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                     U_CFG_TEST_BAUD_RATE,
+                                     NULL,
+                                     U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                     U_CFG_TEST_PIN_UART_B_TXD,
+                                     U_CFG_TEST_PIN_UART_B_RXD,
+                                     U_CFG_TEST_PIN_UART_B_CTS,
+                                     U_CFG_TEST_PIN_UART_B_RTS);
+        U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+        config.uartHandle = gUartBHandle;
+        transportType = U_GNSS_TRANSPORT_UART;
+        transportHandle.uart = gUartAHandle;
+    }
+#endif
+
+    U_PORT_TEST_ASSERT(uGnssTestSimStart(&config) == 0);
+    if (transportType == U_GNSS_TRANSPORT_VIRTUAL_SERIAL) {
+        gpDeviceSerial = pGnssTestSimDeviceSerial();
+        U_PORT_TEST_ASSERT(gpDeviceSerial != NULL);
+        U_PORT_TEST_ASSERT(gpDeviceSerial->open(gpDeviceSerial, NULL, 0) == 0);
+        transportHandle.pDeviceSerial = gpDeviceSerial;
+    }
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M9, transportType,
+                                transportHandle, -1, false, &gGnssHandle) == 0);
+    uGnssSetUbxMessagePrint(gGnssHandle, false);
+}
+
+// Undo simOpen().
+static void simClose()
+{
+    if (gGnssHandle != NULL) {
+        uGnssMsgReceiveStopAll(gGnssHandle);
+        uGnssRemove(gGnssHandle);
+        gGnssHandle = NULL;
+    }
+    gpDeviceSerial = NULL;
+    uGnssTestSimStop();
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+    if (gUartBHandle >= 0) {
+        uPortUartClose(gUartBHandle);
+        gUartBHandle = -1;
+    }
+    if (gUartAHandle >= 0) {
+        uPortUartClose(gUartAHandle);
+        gUartAHandle = -1;
+    }
+#endif
+}
+
+// Receive everything for the given time, then stop the simulator
+// emitting epochs and wait for what it has emitted to be delivered.
+static void receive(int32_t durationMs)
+{
+    uGnssMessageId_t messageId = {0};
+    int32_t startTimeMs;
+    int32_t lastChangeTimeMs;
+    size_t receivedTotal;
+    int32_t handle;
+
+    memset(&gResult, 0, sizeof(gResult));
+    messageId.type = U_GNSS_PROTOCOL_ALL;
+    handle = uGnssMsgReceiveStart(gGnssHandle, &messageId,
+                                  messageCallback, &gResult);
+    U_PORT_TEST_ASSERT(handle >= 0);
+    uPortTaskBlock(durationMs);
+    U_PORT_TEST_ASSERT(uGnssTestSimSetRate(0) == 0);
+    startTimeMs = uPortGetTickTimeMs();
+    lastChangeTimeMs = startTimeMs;
+    receivedTotal = gResult.receivedTotal;
+    while ((uPortGetTickTimeMs() - lastChangeTimeMs < 500) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_GNSS_SIM_TEST_DRAIN_TIMEOUT_MS)) {
+        uPortTaskBlock(50);
+        if (gResult.receivedTotal != receivedTotal) {
+            receivedTotal = gResult.receivedTotal;
+            lastChangeTimeMs = uPortGetTickTimeMs();
+        }
+    }
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gGnssHandle, handle) == 0);
+}
+
+// Run one benchmark.
+static void benchmark(const uGnssSimTestTransport_t *pTransport,
+                      const uGnssSimTestLoad_t *pLoad)
+{
+    uGnssTestSimConfig_t config = {0};
+    uGnssTestSimStats_t stats;
+    size_t emitted = 0;
+    clock_t cpuStart;
+    clock_t cpuEnd;
+    int32_t cpuPerMessageUs = -1;
+    int32_t latencyAverageUs = -1;
+
+    config.transport = pTransport->transport;
+    config.uartHandle = -1;
+    config.busBytesPerSecond = pTransport->busBytesPerSecond;
+    config.fillBytes = pTransport->fillBytes;
+    config.rateHz = pLoad->rateHz;
+    config.streamBitmap = pLoad->streamBitmap;
+    config.numSvs = pLoad->numSvs;
+    simOpen(&config);
+
+    cpuStart = clock();
+    receive(U_GNSS_SIM_TEST_DURATION_MS);
+    cpuEnd = clock();
+
+    U_PORT_TEST_ASSERT(uGnssTestSimGetStats(&stats) == 0);
+    for (size_t x = 0; x < U_GNSS_TEST_SIM_STREAM_MAX_NUM; x++) {
+        emitted += stats.messages[x];
+    }
+    if (gResult.latencyCount > 0) {
+        latencyAverageUs = (int32_t) ((gResult.latencyTotalNs / gResult.latencyCount) / 1000);
+    }
+    if ((cpuStart != (clock_t) -1) && (cpuEnd != (clock_t) -1) &&
+        (gResult.receivedTotal > 0)) {
+        // Note: this is the CPU time of everything, including the
+        // simulator, divided by the number of messages delivered
+        cpuPerMessageUs = (int32_t) ((((int64_t) (cpuEnd - cpuStart)) * 1000000 / CLOCKS_PER_SEC) /
+                                     (int64_t) gResult.receivedTotal);
+    }
+    U_TEST_PRINT_LINE("%s, %s load (%d Hz, %d SVs): %d of %d message(s) delivered,"
+                      " %d byte(s) lost before the GNSS API.", pTransport->pName,
+                      pLoad->pName, pLoad->rateHz, pLoad->numSvs, gResult.receivedTotal,
+                      emitted, stats.bytesLost);
+    U_TEST_PRINT_LINE("%s, %s load: latency average %d us, worst %d us, CPU %d us"
+                      " per message (-1 means not available).", pTransport->pName,
+                      pLoad->pName, latencyAverageUs,
+                      (int32_t) (gResult.latencyMaxNs / 1000), cpuPerMessageUs);
+
+    simClose();
+
+    // The GNSS API checks every message so, whatever the load,
+    // nothing it delivers should be other than was sent
+    U_PORT_TEST_ASSERT(gResult.unmatched == 0);
+    U_PORT_TEST_ASSERT(gResult.receivedTotal > 0);
+    if (pLoad->lossless) {
+        U_PORT_TEST_ASSERT(gResult.receivedTotal == emitted);
+        for (size_t x = 0; x < U_GNSS_TEST_SIM_STREAM_MAX_NUM; x++) {
+            U_PORT_TEST_ASSERT(gResult.received[x] == stats.messages[x]);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Check that the simulator answers polls and configuration
+ * messages as the GNSS API expects.
+ */
+U_PORT_TEST_FUNCTION("[gnssSim]", "gnssSimCommands")
+{
+    int32_t resourceCount;
+    uGnssTestSimConfig_t config = {0};
+    uGnssTestSimStats_t stats;
+    char buffer[64];
+    uint8_t value8 = 0;
+    uint16_t value16 = 0;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+
+    config.transport = U_GNSS_TEST_SIM_TRANSPORT_VIRTUAL_SERIAL;
+    config.uartHandle = -1;
+    simOpen(&config);
+
+    // A poll
+    U_PORT_TEST_ASSERT(uGnssInfoGetFirmwareVersionStr(gGnssHandle, buffer,
+                                                      sizeof(buffer)) > 0);
+    U_TEST_PRINT_LINE("firmware version \"%s\".", buffer);
+    U_PORT_TEST_ASSERT(strstr(buffer, "SPG 5.10") != NULL);
+
+    // Set two values of different sizes and read them back
+    U_PORT_TEST_ASSERT(uGnssCfgValSet(gGnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_DYNMODEL_E1, 4,
+                                      U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                      U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+    U_PORT_TEST_ASSERT(uGnssCfgValSet(gGnssHandle, U_GNSS_CFG_VAL_KEY_ID_RATE_MEAS_U2, 40,
+                                      U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                      U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+    U_PORT_TEST_ASSERT(uGnssCfgValGet(gGnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_DYNMODEL_E1,
+                                      &value8, sizeof(value8),
+                                      U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+    U_PORT_TEST_ASSERT(value8 == 4);
+    U_PORT_TEST_ASSERT(uGnssCfgValGet(gGnssHandle, U_GNSS_CFG_VAL_KEY_ID_RATE_MEAS_U2,
+                                      &value16, sizeof(value16),
+                                      U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+    U_PORT_TEST_ASSERT(value16 == 40);
+
+    U_PORT_TEST_ASSERT(uGnssTestSimGetStats(&stats) == 0);
+    U_TEST_PRINT_LINE("%d command(s), %d poll(s), %d ack(s), %d nak(s).",
+                      stats.commands, stats.polls, stats.acks, stats.naks);
+    U_PORT_TEST_ASSERT(stats.polls == 1);
+    U_PORT_TEST_ASSERT(stats.acks == 4);
+    U_PORT_TEST_ASSERT(stats.naks == 0);
+    simClose();
+
+    // Now with every configuration message refused
+    config.nakCfg = true;
+    simOpen(&config);
+    U_PORT_TEST_ASSERT(uGnssCfgValSet(gGnssHandle, U_GNSS_CFG_VAL_KEY_ID_NAVSPG_DYNMODEL_E1, 4,
+                                      U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                      U_GNSS_CFG_VAL_LAYER_RAM) < 0);
+    U_PORT_TEST_ASSERT(uGnssTestSimGetStats(&stats) == 0);
+    U_PORT_TEST_ASSERT(stats.naks == 1);
+    simClose();
+
+    uGnssDeinit();
+    uPortDeinit();
+
+    // Check for resource leaks
+    U_PORT_TEST_ASSERT(uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true));
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Inject faults: corrupted and truncated messages, fill bytes
+ * and stalls; the GNSS API should deliver every intact message
+ * and nothing else.
+ */
+U_PORT_TEST_FUNCTION("[gnssSim]", "gnssSimFaults")
+{
+    int32_t resourceCount;
+    uGnssTestSimConfig_t config = {0};
+    uGnssTestSimStats_t stats;
+    size_t emitted = 0;
+    size_t damaged;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+
+    config.transport = U_GNSS_TEST_SIM_TRANSPORT_VIRTUAL_SERIAL;
+    config.uartHandle = -1;
+    config.rateHz = 5;
+    config.streamBitmap = U_GNSS_SIM_TEST_STREAMS_NOMINAL;
+    config.numSvs = 12;
+    config.corruptPerMille = 50;
+    config.truncatePerMille = 50;
+    config.fillBytes = 64;
+    config.stallPerMille = 50;
+    config.stallMs = 500;
+    config.seed = 95;
+    simOpen(&config);
+
+    receive(U_GNSS_SIM_TEST_DURATION_MS * 2);
+
+    U_PORT_TEST_ASSERT(uGnssTestSimGetStats(&stats) == 0);
+    for (size_t x = 0; x < U_GNSS_TEST_SIM_STREAM_MAX_NUM; x++) {
+        emitted += stats.messages[x];
+    }
+    damaged = stats.corrupted + stats.truncated;
+    U_TEST_PRINT_LINE("%d epoch(s), %d message(s) of which %d corrupted and %d truncated,"
+                      " %d stall(s); %d message(s) delivered, %d undecodable stretch(es).",
+                      stats.epochs, emitted, stats.corrupted, stats.truncated, stats.stalls,
+                      gResult.receivedTotal, gResult.unknown);
+    simClose();
+
+    U_PORT_TEST_ASSERT(damaged > 0);
+    U_PORT_TEST_ASSERT(gResult.unmatched == 0);
+    // A damaged message may take the one after it down with it,
+    // e.g. if its length field was hit, but no more than that
+    U_PORT_TEST_ASSERT(gResult.receivedTotal <= emitted - damaged);
+    U_PORT_TEST_ASSERT(gResult.receivedTotal >= emitted - (damaged * 2));
+
+    uGnssDeinit();
+    uPortDeinit();
+
+    // Check for resource leaks
+    U_PORT_TEST_ASSERT(uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true));
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Benchmark each transport at a nominal load, where everything
+ * must be delivered, and at a stress load: 25 Hz with large
+ * messages, where what is delivered is reported.
+ */
+U_PORT_TEST_FUNCTION("[gnssSim]", "gnssSimBenchmark")
+{
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+
+    for (size_t x = 0; x < sizeof(gTransport) / sizeof(gTransport[0]); x++) {
+        for (size_t y = 0; y < sizeof(gLoad) / sizeof(gLoad[0]); y++) {
+            benchmark(&(gTransport[x]), &(gLoad[y]));
+        }
+    }
+
+    uGnssDeinit();
+    uPortDeinit();
+
+    // Check for resource leaks
+    U_PORT_TEST_ASSERT(uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true));
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[gnssSim]", "gnssSimCleanUp")
+{
+    simClose();
+    uGnssDeinit();
+    uPortDeinit();
+}
+
+// End of file
@@ -0,0 +1,1184 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief A simulated GNSS chip, for GNSS API testing without any
+ * GNSS hardware; see u_gnss_test_sim.h.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), memcpy(), memmove()
+#include "stdio.h"     // snprintf()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_uart.h"
+#include "u_port_pps.h"
+
+#include "u_ringbuffer.h"
+
+#include "u_ubx_protocol.h"
+#include "u_spartn_crc.h"
+
+#include "u_device_serial.h"
+
+#include "u_gnss_test_sim.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The length of the body of UBX-RXM-RAWX, the longest message.
+ */
+#define U_GNSS_TEST_SIM_RAWX_BODY_LENGTH_BYTES(numSvs) (16 + (32 * (numSvs)))
+
+/** The length of the buffer in which messages are assembled.
+ */
+#define U_GNSS_TEST_SIM_MESSAGE_LENGTH_BYTES (U_GNSS_TEST_SIM_RAWX_BODY_LENGTH_BYTES(U_GNSS_TEST_SIM_NUM_SVS_MAX) + \
+                                              U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES)
+
+/** The length of the buffer in which received commands are
+ * assembled.
+ */
+#define U_GNSS_TEST_SIM_COMMAND_LENGTH_BYTES 1024
+
+/** The length of UBX-MON-VER as sent by the simulator.
+ */
+#define U_GNSS_TEST_SIM_MON_VER_BODY_LENGTH_BYTES (30 + 10 + (30 * 3))
+
+/** The iTOW of the first epoch; less than a day so that the UTC
+ * time of day of the NMEA messages is the same as iTOW.
+ */
+#define U_GNSS_TEST_SIM_ITOW_START_MS 3600000
+
+/** The number of milliseconds in a day.
+ */
+#define U_GNSS_TEST_SIM_MS_PER_DAY (1000UL * 60 * 60 * 24)
+
+/** The longest time that the simulator task blocks for.
+ */
+#define U_GNSS_TEST_SIM_TASK_BLOCK_MAX_MS 5
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A timing record.
+ */
+typedef struct {
+    uint32_t iTOW;
+    uGnssTestSimStream_t stream;
+    int64_t timeNs;
+} uGnssTestSimRecord_t;
+
+/** A configuration value set with UBX-CFG-VALSET.
+ */
+typedef struct {
+    uint32_t keyId;
+    uint64_t value;
+} uGnssTestSimValue_t;
+
+/** The state of the simulator.
+ */
+typedef struct {
+    uGnssTestSimConfig_t config;
+    uPortMutexHandle_t mutex;
+    uPortTaskHandle_t taskHandle;
+    volatile bool taskStop;
+    volatile bool taskExited;
+    uDeviceSerial_t *pDeviceSerial;
+    bool deviceSerialOpen;
+    char *pReceiveBuffer;          /**< linear buffer of receiveRingBuffer. */
+    uRingBuffer_t receiveRingBuffer; /**< what the GNSS API reads from
+                                          the virtual serial device. */
+    int64_t busTokens;             /**< the bytes that may be read at
+                                        busBytesPerSecond. */
+    int64_t busTimeNs;             /**< when busTokens was last updated. */
+    char *pMessage;                /**< where messages are assembled. */
+    char command[U_GNSS_TEST_SIM_COMMAND_LENGTH_BYTES];
+    size_t commandLength;
+    uGnssTestSimValue_t value[U_GNSS_TEST_SIM_MAX_NUM_VALUES];
+    size_t numValues;
+    uGnssTestSimRecord_t record[U_GNSS_TEST_SIM_MAX_NUM_RECORDS];
+    size_t recordNext;
+    size_t numRecords;
+    uint32_t random;
+    uint32_t iTOW;                 /**< the iTOW of the last epoch. */
+    int64_t nextEpochNs;
+    int64_t stallEndNs;
+    uGnssTestSimStats_t stats;
+} uGnssTestSimContext_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The simulator, NULL if it is not running.
+ */
+static uGnssTestSimContext_t *gpSim = NULL;
+
+/** Fill bytes, as sent by a GNSS chip over SPI when it has nothing
+ * to send.
+ */
+static const char gFill[32] = {(char) 0xFF, (char) 0xFF, (char) 0xFF, (char) 0xFF,
+                               (char) 0xFF, (char) 0xFF, (char) 0xFF, (char) 0xFF,
+                               (char) 0xFF, (char) 0xFF, (char) 0xFF, (char) 0xFF,
+                               (char) 0xFF, (char) 0xFF, (char) 0xFF, (char) 0xFF,
+                               (char) 0xFF, (char) 0xFF, (char) 0xFF, (char) 0xFF,
+                               (char) 0xFF, (char) 0xFF, (char) 0xFF, (char) 0xFF,
+                               (char) 0xFF, (char) 0xFF, (char) 0xFF, (char) 0xFF,
+                               (char) 0xFF, (char) 0xFF, (char) 0xFF, (char) 0xFF
+                              };
+
+/** The body of UBX-MON-VER, padded out with zeroes.
+ */
+static const char *const gpMonVer[] = {"ROM SPG 5.10 (7b202e)", "000A0000",
+                                       "FWVER=SPG 5.10", "PROTVER=34.10",
+                                       "MOD=NEO-M9N-00B"
+                                      };
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: HELPERS
+ * -------------------------------------------------------------- */
+
+// Put a little-endian uint16_t into a buffer.
+static void uint16Put(char *pBuffer, uint16_t value)
+{
+    value = uUbxProtocolUint16Encode(value);
+    memcpy(pBuffer, &value, sizeof(value));
+}
+
+// Put a little-endian uint32_t into a buffer.
+static void uint32Put(char *pBuffer, uint32_t value)
+{
+    value = uUbxProtocolUint32Encode(value);
+    memcpy(pBuffer, &value, sizeof(value));
+}
+
+// Put a little-endian uint64_t into a buffer.
+static void uint64Put(char *pBuffer, uint64_t value)
+{
+    value = uUbxProtocolUint64Encode(value);
+    memcpy(pBuffer, &value, sizeof(value));
+}
+
+// Put a little-endian double into a buffer.
+static void doublePut(char *pBuffer, double value)
+{
+    uint64_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    uint64Put(pBuffer, bits);
+}
+
+// Return true with the given chance in a thousand.
+static bool chance(uGnssTestSimContext_t *pSim, int32_t perMille)
+{
+    bool yes = false;
+
+    if (perMille > 0) {
+        pSim->random = (pSim->random * 1664525UL) + 1013904223UL;
+        yes = ((int32_t) ((pSim->random >> 16) % 1000) < perMille);
+    }
+
+    return yes;
+}
+
+// Return a random number from 0 to limit - 1.
+static size_t randomBelow(uGnssTestSimContext_t *pSim, size_t limit)
+{
+    pSim->random = (pSim->random * 1664525UL) + 1013904223UL;
+
+    return (size_t) ((pSim->random >> 8) % limit);
+}
+
+// Return the number of bytes of storage of a configuration value.
+static size_t valueSize(uint32_t keyId)
+{
+    size_t size = 1;
+
+    switch ((keyId >> 28) & 0x07) {
+        case 3:
+            size = 2;
+            break;
+        case 4:
+            size = 4;
+            break;
+        case 5:
+            size = 8;
+            break;
+        default:
+            break;
+    }
+
+    return size;
+}
+
+// Find a configuration value, returning NULL if there is none.
+static uGnssTestSimValue_t *pValueFind(uGnssTestSimContext_t *pSim,
+                                       uint32_t keyId)
+{
+    uGnssTestSimValue_t *pValue = NULL;
+
+    for (size_t x = 0; (x < pSim->numValues) && (pValue == NULL); x++) {
+        if (pSim->value[x].keyId == keyId) {
+            pValue = &(pSim->value[x]);
+        }
+    }
+
+    return pValue;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: OUTPUT
+ * -------------------------------------------------------------- */
+
+// Write bytes towards the GNSS API.
+// The mutex must be locked before this is called.
+static void simWrite(uGnssTestSimContext_t *pSim, const char *pData,
+                     size_t size)
+{
+    size_t available;
+
+    if (pSim->config.transport == U_GNSS_TEST_SIM_TRANSPORT_UART) {
+        uPortUartWrite(pSim->config.uartHandle, pData, size);
+    } else {
+        available = uRingBufferAvailableSize(&(pSim->receiveRingBuffer));
+        if (available > size) {
+            available = size;
+        }
+        uRingBufferAdd(&(pSim->receiveRingBuffer), pData, available);
+        pSim->stats.bytesLost += size - available;
+    }
+    pSim->stats.bytes += size;
+}
+
+// Encode and write a UBX message.
+// The mutex must be locked before this is called.
+static void ubxWrite(uGnssTestSimContext_t *pSim, int32_t messageClass,
+                     int32_t messageId, const char *pBody, size_t bodyLength)
+{
+    char buffer[U_GNSS_TEST_SIM_MON_VER_BODY_LENGTH_BYTES + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    int32_t length;
+
+    if (bodyLength <= U_GNSS_TEST_SIM_MON_VER_BODY_LENGTH_BYTES) {
+        length = uUbxProtocolEncode(messageClass, messageId, pBody,
+                                    bodyLength, buffer);
+        if (length > 0) {
+            simWrite(pSim, buffer, (size_t) length);
+        }
+    }
+}
+
+// Write a UBX-ACK-ACK or UBX-ACK-NAK.
+// The mutex must be locked before this is called.
+static void ackWrite(uGnssTestSimContext_t *pSim, int32_t messageClass,
+                     int32_t messageId, bool ack)
+{
+    char body[2];
+
+    body[0] = (char) messageClass;
+    body[1] = (char) messageId;
+    ubxWrite(pSim, 0x05, ack ? 0x01 : 0x00, body, sizeof(body));
+    if (ack) {
+        pSim->stats.acks++;
+    } else {
+        pSim->stats.naks++;
+    }
+}
+
+// Encode a UBX message of a stream into pMessage, returning its
+// length; NMEA and RTCM are handled elsewhere.
+static size_t ubxEncode(uGnssTestSimContext_t *pSim,
+                        uGnssTestSimStream_t stream, uint32_t iTOW)
+{
+    char *pBody = pSim->pMessage + 6;
+    size_t numSvs = pSim->config.numSvs;
+    int32_t messageClass = 0x01;
+    int32_t messageId = 0x61; // UBX-NAV-EOE
+    size_t bodyLength = 4;
+    char *pItem;
+    uint8_t ca = 0;
+    uint8_t cb = 0;
+
+    // Assemble the body where it will end up in the message
+    switch (stream) {
+        case U_GNSS_TEST_SIM_STREAM_UBX_NAV_PVT:
+            messageId = 0x07;
+            bodyLength = 92;
+            memset(pBody, 0, bodyLength);
+            uint32Put(pBody, iTOW);
+            *(pBody + 11) = 0x37;  // valid: date, time, fully resolved, mag
+            *(pBody + 20) = 3;     // fixType: 3D
+            *(pBody + 21) = 0x01;  // flags: gnssFixOK
+            *(pBody + 23) = (char) numSvs;
+            uint32Put(pBody + 24, (uint32_t) -1257236); // lon: -0.1257236 degrees
+            uint32Put(pBody + 28, 522193600); // lat: 52.21936 degrees
+            uint32Put(pBody + 36, 95000); // hMSL: 95 metres
+            uint32Put(pBody + 40, 1500); // hAcc: 1.5 metres
+            break;
+        case U_GNSS_TEST_SIM_STREAM_UBX_NAV_SAT:
+            messageId = 0x35;
+            bodyLength = 8 + (12 * numSvs);
+            memset(pBody, 0, bodyLength);
+            uint32Put(pBody, iTOW);
+            *(pBody + 4) = 1; // version
+            *(pBody + 5) = (char) numSvs;
+            for (size_t x = 0; x < numSvs; x++) {
+                pItem = pBody + 8 + (12 * x);
+                *(pItem + 1) = (char) (x + 1); // svId
+                *(pItem + 2) = (char) (30 + (x % 20)); // cno
+                *(pItem + 3) = (char) (10 + x); // elev
+            }
+            break;
+        case U_GNSS_TEST_SIM_STREAM_UBX_RXM_RAWX:
+            messageClass = 0x02;
+            messageId = 0x15;
+            bodyLength = U_GNSS_TEST_SIM_RAWX_BODY_LENGTH_BYTES(numSvs);
+            memset(pBody, 0, bodyLength);
+            doublePut(pBody, ((double) iTOW) / 1000);
+            uint16Put(pBody + 8, 2336); // week
+            *(pBody + 10) = 18; // leapS
+            *(pBody + 11) = (char) numSvs;
+            *(pBody + 12) = 0x01; // recStat: leapSec
+            *(pBody + 13) = 1; // version
+            for (size_t x = 0; x < numSvs; x++) {
+                pItem = pBody + 16 + (32 * x);
+                doublePut(pItem, 2.1e7 + (x * 1.0e5)); // prMes
+                *(pItem + 21) = (char) (x + 1); // svId
+                *(pItem + 26) = (char) (30 + (x % 20)); // cno
+            }
+            break;
+        default:
+            memset(pBody, 0, bodyLength);
+            uint32Put(pBody, iTOW);
+            break;
+    }
+
+    // Add the header and the checksum around it
+    pSim->pMessage[0] = (char) 0xb5;
+    pSim->pMessage[1] = 0x62;
+    pSim->pMessage[2] = (char) messageClass;
+    pSim->pMessage[3] = (char) messageId;
+    uint16Put(pSim->pMessage + 4, (uint16_t) bodyLength);
+    for (size_t x = 2; x < bodyLength + 6; x++) {
+        ca += (uint8_t) pSim->pMessage[x];
+        cb += ca;
+    }
+    pSim->pMessage[bodyLength + 6] = (char) ca;
+    pSim->pMessage[bodyLength + 7] = (char) cb;
+
+    return bodyLength + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+}
+
+// Encode an NMEA message of a stream into pMessage, returning
+// its length.
+static size_t nmeaEncode(uGnssTestSimContext_t *pSim,
+                         uGnssTestSimStream_t stream, uint32_t iTOW)
+{
+    uint32_t timeOfDayMs = iTOW % U_GNSS_TEST_SIM_MS_PER_DAY;
+    int32_t hours = (int32_t) (timeOfDayMs / 3600000);
+    int32_t minutes = (int32_t) ((timeOfDayMs / 60000) % 60);
+    int32_t seconds = (int32_t) ((timeOfDayMs / 1000) % 60);
+    int32_t hundredths = (int32_t) ((timeOfDayMs / 10) % 100);
+    size_t length;
+    char checksum = 0;
+
+    if (stream == U_GNSS_TEST_SIM_STREAM_NMEA_GGA) {
+        length = snprintf(pSim->pMessage, U_GNSS_TEST_SIM_MESSAGE_LENGTH_BYTES,
+                          "$GNGGA,%02d%02d%02d.%02d,5213.16160,N,00007.54342,W,"
+                          "1,%02d,0.80,95.0,M,47.0,M,,*",
+                          (int) hours, (int) minutes, (int) seconds, (int) hundredths,
+                          (int) pSim->config.numSvs);
+    } else {
+        length = snprintf(pSim->pMessage, U_GNSS_TEST_SIM_MESSAGE_LENGTH_BYTES,
+                          "$GNRMC,%02d%02d%02d.%02d,A,5213.16160,N,00007.54342,W,"
+                          "0.010,,181026,,,A,V*",
+                          (int) hours, (int) minutes, (int) seconds, (int) hundredths);
+    }
+    // The checksum is over everything between '$' and '*'
+    for (size_t x = 1; x < length - 1; x++) {
+        checksum ^= pSim->pMessage[x];
+    }
+    length += snprintf(pSim->pMessage + length,
+                       U_GNSS_TEST_SIM_MESSAGE_LENGTH_BYTES - length,
+                       "%02X\r\n", (unsigned int) (uint8_t) checksum);
+
+    return length;
+}
+
+// Encode an RTCM3 1005 message (stationary reference station
+// position) into pMessage, returning its length.
+static size_t rtcmEncode(uGnssTestSimContext_t *pSim)
+{
+    char *pMessage = pSim->pMessage;
+    size_t bodyLength = 19;
+    uint32_t crc;
+
+    memset(pMessage, 0, bodyLength + 6);
+    pMessage[0] = (char) 0xD3;
+    pMessage[1] = (char) ((bodyLength >> 8) & 0x03);
+    pMessage[2] = (char) bodyLength;
+    // 12 bits of message number, 1005
+    pMessage[3] = (char) 0x3E;
+    pMessage[4] = (char) 0xD0;
+    crc = uSpartnCrc24(pMessage, bodyLength + 3);
+    pMessage[bodyLength + 3] = (char) (crc >> 16);
+    pMessage[bodyLength + 4] = (char) (crc >> 8);
+    pMessage[bodyLength + 5] = (char) crc;
+
+    return bodyLength + 6;
+}
+
+// Encode a message of a stream into pMessage, returning its length.
+static size_t streamEncode(uGnssTestSimContext_t *pSim,
+                           uGnssTestSimStream_t stream, uint32_t iTOW)
+{
+    size_t length;
+
+    switch (stream) {
+        case U_GNSS_TEST_SIM_STREAM_NMEA_GGA:
+        case U_GNSS_TEST_SIM_STREAM_NMEA_RMC:
+            length = nmeaEncode(pSim, stream, iTOW);
+            break;
+        case U_GNSS_TEST_SIM_STREAM_RTCM_1005:
+            length = rtcmEncode(pSim);
+            break;
+        default:
+            length = ubxEncode(pSim, stream, iTOW);
+            break;
+    }
+
+    return length;
+}
+
+// Add a timing record.
+// The mutex must be locked before this is called.
+static void recordAdd(uGnssTestSimContext_t *pSim,
+                      uGnssTestSimStream_t stream, uint32_t iTOW)
+{
+    uGnssTestSimRecord_t *pRecord = &(pSim->record[pSim->recordNext]);
+
+    pRecord->stream = stream;
+    pRecord->iTOW = iTOW;
+    pRecord->timeNs = uPortPpsGetTimeNs();
+    pSim->recordNext++;
+    if (pSim->recordNext >= U_GNSS_TEST_SIM_MAX_NUM_RECORDS) {
+        pSim->recordNext = 0;
+    }
+    if (pSim->numRecords < U_GNSS_TEST_SIM_MAX_NUM_RECORDS) {
+        pSim->numRecords++;
+    }
+}
+
+// Emit a navigation epoch, with any faults.
+static void epochEmit(uGnssTestSimContext_t *pSim, uint32_t iTOW)
+{
+    size_t length;
+    size_t fillBytes;
+
+    for (int32_t stream = 0; stream < (int32_t) U_GNSS_TEST_SIM_STREAM_MAX_NUM; stream++) {
+        if (pSim->config.streamBitmap & U_GNSS_TEST_SIM_STREAM_BIT(stream)) {
+
+            U_PORT_MUTEX_LOCK(pSim->mutex);
+
+            length = streamEncode(pSim, (uGnssTestSimStream_t) stream, iTOW);
+            if ((length > 1) && chance(pSim, pSim->config.truncatePerMille)) {
+                length = 1 + randomBelow(pSim, length - 1);
+                pSim->stats.truncated++;
+            } else if ((length > 1) && chance(pSim, pSim->config.corruptPerMille)) {
+                pSim->pMessage[1 + randomBelow(pSim, length - 1)] ^= 0x55;
+                pSim->stats.corrupted++;
+            }
+            simWrite(pSim, pSim->pMessage, length);
+            recordAdd(pSim, (uGnssTestSimStream_t) stream, iTOW);
+            pSim->stats.messages[stream]++;
+
+            U_PORT_MUTEX_UNLOCK(pSim->mutex);
+        }
+    }
+
+    U_PORT_MUTEX_LOCK(pSim->mutex);
+
+    fillBytes = pSim->config.fillBytes;
+    while (fillBytes > 0) {
+        length = fillBytes;
+        if (length > sizeof(gFill)) {
+            length = sizeof(gFill);
+        }
+        simWrite(pSim, gFill, length);
+        fillBytes -= length;
+    }
+    pSim->stats.epochs++;
+
+    U_PORT_MUTEX_UNLOCK(pSim->mutex);
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: INPUT
+ * -------------------------------------------------------------- */
+
+// Answer a poll, i.e. a UBX message with an empty body.
+// The mutex must be locked before this is called.
+static void pollAnswer(uGnssTestSimContext_t *pSim, int32_t messageClass,
+                       int32_t messageId)
+{
+    char body[U_GNSS_TEST_SIM_MON_VER_BODY_LENGTH_BYTES] = {0};
+    size_t offset = 0;
+    size_t length;
+    int32_t stream = -1;
+
+    if ((messageClass == 0x0a) && (messageId == 0x04)) {
+        // UBX-MON-VER
+        for (size_t x = 0; x < sizeof(gpMonVer) / sizeof(gpMonVer[0]); x++) {
+            length = strlen(gpMonVer[x]);
+            memcpy(body + offset, gpMonVer[x], length);
+            offset += (x == 1) ? 10 : 30;
+        }
+        ubxWrite(pSim, messageClass, messageId, body, sizeof(body));
+        pSim->stats.polls++;
+    } else if ((messageClass == 0x27) && (messageId == 0x03)) {
+        // UBX-SEC-UNIQID
+        body[0] = 2; // version
+        for (size_t x = 0; x < 6; x++) {
+            body[4 + x] = (char) (0xa0 + x);
+        }
+        ubxWrite(pSim, messageClass, messageId, body, 10);
+        pSim->stats.polls++;
+    } else if (messageClass == 0x06) {
+        // A legacy UBX-CFG poll: answer with zeroes and an ack
+        ubxWrite(pSim, messageClass, messageId, body, 20);
+        ackWrite(pSim, messageClass, messageId, !pSim->config.nakCfg);
+        pSim->stats.polls++;
+    } else if (messageClass == 0x01) {
+        switch (messageId) {
+            case 0x07:
+                stream = U_GNSS_TEST_SIM_STREAM_UBX_NAV_PVT;
+                break;
+            case 0x35:
+                stream = U_GNSS_TEST_SIM_STREAM_UBX_NAV_SAT;
+                break;
+            case 0x61:
+                stream = U_GNSS_TEST_SIM_STREAM_UBX_NAV_EOE;
+                break;
+            default:
+                break;
+        }
+    } else if ((messageClass == 0x02) && (messageId == 0x15)) {
+        stream = U_GNSS_TEST_SIM_STREAM_UBX_RXM_RAWX;
+    }
+    if (stream >= 0) {
+        length = ubxEncode(pSim, (uGnssTestSimStream_t) stream, pSim->iTOW);
+        simWrite(pSim, pSim->pMessage, length);
+        pSim->stats.polls++;
+    }
+}
+
+// Handle UBX-CFG-VALGET, which is answered with the values asked
+// for, zero where they have not been set, followed by an ack.
+// The mutex must be locked before this is called.
+static void valGetAnswer(uGnssTestSimContext_t *pSim, const char *pBody,
+                         size_t bodyLength)
+{
+    char body[4 + (8 * 12)];
+    size_t length = 4;
+    size_t size;
+    uint32_t keyId;
+    uGnssTestSimValue_t *pValue;
+
+    body[0] = 1; // version
+    body[1] = pBody[1]; // layer
+    body[2] = 0;
+    body[3] = 0;
+    for (size_t x = 4; (x + 4 <= bodyLength) && (length + 12 <= sizeof(body)); x += 4) {
+        keyId = uUbxProtocolUint32Decode(pBody + x);
+        size = valueSize(keyId);
+        uint32Put(body + length, keyId);
+        length += 4;
+        pValue = pValueFind(pSim, keyId);
+        uint64Put(body + length, (pValue != NULL) ? pValue->value : 0);
+        length += size;
+    }
+    if (!pSim->config.nakCfg) {
+        ubxWrite(pSim, 0x06, 0x8b, body, length);
+    }
+    ackWrite(pSim, 0x06, 0x8b, !pSim->config.nakCfg);
+}
+
+// Handle UBX-CFG-VALSET or UBX-CFG-VALDEL.
+// The mutex must be locked before this is called.
+static void valSetOrDel(uGnssTestSimContext_t *pSim, const char *pBody,
+                        size_t bodyLength, bool set)
+{
+    size_t x = 4;
+    size_t size;
+    uint32_t keyId;
+    uint64_t value;
+    uGnssTestSimValue_t *pValue;
+
+    while ((x + 4 <= bodyLength) && !pSim->config.nakCfg) {
+        keyId = uUbxProtocolUint32Decode(pBody + x);
+        x += 4;
+        pValue = pValueFind(pSim, keyId);
+        if (set) {
+            size = valueSize(keyId);
+            value = 0;
+            for (size_t y = 0; (y < size) && (x + y < bodyLength); y++) {
+                value |= ((uint64_t) (uint8_t) pBody[x + y]) << (y * 8);
+            }
+            x += size;
+            if ((pValue == NULL) && (pSim->numValues < U_GNSS_TEST_SIM_MAX_NUM_VALUES)) {
+                pValue = &(pSim->value[pSim->numValues]);
+                pValue->keyId = keyId;
+                pSim->numValues++;
+            }
+            if (pValue != NULL) {
+                pValue->value = value;
+            }
+        } else if (pValue != NULL) {
+            pSim->numValues--;
+            *pValue = pSim->value[pSim->numValues];
+        }
+    }
+    ackWrite(pSim, 0x06, set ? 0x8a : 0x8c, !pSim->config.nakCfg);
+}
+
+// Handle a complete UBX message from the GNSS API.
+// The mutex must be locked before this is called.
+static void commandHandle(uGnssTestSimContext_t *pSim, int32_t messageClass,
+                          int32_t messageId, const char *pBody,
+                          size_t bodyLength)
+{
+    char body[8] = {0};
+
+    pSim->stats.commands++;
+    if (bodyLength == 0) {
+        pollAnswer(pSim, messageClass, messageId);
+    } else if (messageClass == 0x06) {
+        switch (messageId) {
+            case 0x8a:
+                valSetOrDel(pSim, pBody, bodyLength, true);
+                break;
+            case 0x8b:
+                valGetAnswer(pSim, pBody, bodyLength);
+                break;
+            case 0x8c:
+                valSetOrDel(pSim, pBody, bodyLength, false);
+                break;
+            default:
+                ackWrite(pSim, messageClass, messageId, !pSim->config.nakCfg);
+                break;
+        }
+    } else if ((messageClass == 0x13) && (messageId != 0x60)) {
+        // UBX-MGA-XXX: answer with UBX-MGA-ACK-DATA0
+        body[0] = 1; // type: accepted
+        body[3] = (char) messageId;
+        memcpy(body + 4, pBody, bodyLength < 4 ? bodyLength : 4);
+        ubxWrite(pSim, 0x13, 0x60, body, sizeof(body));
+        pSim->stats.mgaAcks++;
+    }
+}
+
+// Add bytes from the GNSS API to the command buffer and handle
+// any complete UBX messages in it; anything else is discarded.
+// The mutex must be locked before this is called.
+static void commandAdd(uGnssTestSimContext_t *pSim, const char *pData,
+                       size_t size)
+{
+    char *pCommand = pSim->command;
+    size_t offset = 0;
+    size_t length;
+    size_t bodyLength;
+    int32_t messageClass;
+    int32_t messageId;
+
+    while (size > 0) {
+        length = sizeof(pSim->command) - pSim->commandLength;
+        if (length > size) {
+            length = size;
+        }
+        memcpy(pCommand + pSim->commandLength, pData, length);
+        pSim->commandLength += length;
+        pData += length;
+        size -= length;
+        offset = 0;
+        while (offset < pSim->commandLength) {
+            if (((uint8_t) pCommand[offset] != 0xb5) ||
+                ((offset + 1 < pSim->commandLength) &&
+                 ((uint8_t) pCommand[offset + 1] != 0x62))) {
+                // Not the start of a UBX message
+                offset++;
+            } else if (offset + 6 > pSim->commandLength) {
+                // Need more of the header
+                break;
+            } else {
+                bodyLength = uUbxProtocolUint16Decode(pCommand + offset + 4);
+                length = bodyLength + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+                if (length > sizeof(pSim->command)) {
+                    // Can't be a real one
+                    offset++;
+                } else if (offset + length > pSim->commandLength) {
+                    // Need more of the message
+                    break;
+                } else if (uUbxProtocolDecode(pCommand + offset, length,
+                                              &messageClass, &messageId,
+                                              NULL, 0, NULL) == (int32_t) bodyLength) {
+                    commandHandle(pSim, messageClass, messageId,
+                                  pCommand + offset + 6, bodyLength);
+                    offset += length;
+                } else {
+                    offset++;
+                }
+            }
+        }
+        // Keep what is left for next time
+        memmove(pCommand, pCommand + offset, pSim->commandLength - offset);
+        pSim->commandLength -= offset;
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE TASK
+ * -------------------------------------------------------------- */
+
+// The simulator task: emits the navigation epochs and, on a UART,
+// reads what the GNSS API sends.
+static void simTask(void *pParam)
+{
+    uGnssTestSimContext_t *pSim = (uGnssTestSimContext_t *) pParam;
+    int64_t periodNs;
+    int64_t nowNs;
+    int32_t blockMs;
+    int32_t length;
+    char buffer[128];
+
+    while (!pSim->taskStop) {
+        if (pSim->config.transport == U_GNSS_TEST_SIM_TRANSPORT_UART) {
+            do {
+                length = uPortUartRead(pSim->config.uartHandle, buffer, sizeof(buffer));
+                if (length > 0) {
+
+                    U_PORT_MUTEX_LOCK(pSim->mutex);
+
+                    commandAdd(pSim, buffer, (size_t) length);
+
+                    U_PORT_MUTEX_UNLOCK(pSim->mutex);
+                }
+            } while (length == sizeof(buffer));
+        }
+        blockMs = U_GNSS_TEST_SIM_TASK_BLOCK_MAX_MS;
+
+        U_PORT_MUTEX_LOCK(pSim->mutex);
+
+        periodNs = 0;
+        if (pSim->config.rateHz > 0) {
+            periodNs = 1000000000LL / pSim->config.rateHz;
+        }
+
+        U_PORT_MUTEX_UNLOCK(pSim->mutex);
+
+        if (periodNs > 0) {
+            nowNs = uPortPpsGetTimeNs();
+            if (nowNs >= pSim->nextEpochNs) {
+                pSim->iTOW += (uint32_t) (periodNs / 1000000);
+                if (nowNs >= pSim->stallEndNs) {
+                    if (chance(pSim, pSim->config.stallPerMille)) {
+                        pSim->stallEndNs = nowNs + (((int64_t) pSim->config.stallMs) * 1000000);
+                        pSim->stats.stalls++;
+                    } else {
+                        epochEmit(pSim, pSim->iTOW);
+                    }
+                }
+                pSim->nextEpochNs += periodNs;
+                if (nowNs - pSim->nextEpochNs > periodNs) {
+                    // Fallen too far behind, catch up
+                    pSim->nextEpochNs = nowNs + periodNs;
+                }
+                nowNs = uPortPpsGetTimeNs();
+            }
+            if ((pSim->nextEpochNs - nowNs) / 1000000 < blockMs) {
+                blockMs = (int32_t) ((pSim->nextEpochNs - nowNs) / 1000000);
+            }
+        }
+        if (blockMs < 1) {
+            blockMs = 1;
+        }
+        uPortTaskBlock(blockMs);
+    }
+
+    pSim->taskExited = true;
+    uPortTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE VIRTUAL SERIAL DEVICE
+ * -------------------------------------------------------------- */
+
+// Return how many of the bytes waiting may be read given the bus
+// rate, updating the bus tokens.
+// The mutex must be locked before this is called.
+static size_t busLimit(uGnssTestSimContext_t *pSim, size_t size)
+{
+    int64_t nowNs;
+    int64_t tokens;
+
+    if (pSim->config.busBytesPerSecond > 0) {
+        nowNs = uPortPpsGetTimeNs();
+        tokens = ((nowNs - pSim->busTimeNs) * pSim->config.busBytesPerSecond) / 1000000000LL;
+        // Only move the time on by what has been converted into
+        // tokens so that nothing is lost to rounding
+        pSim->busTimeNs += (tokens * 1000000000LL) / pSim->config.busBytesPerSecond;
+        pSim->busTokens += tokens;
+        if (pSim->busTokens > U_GNSS_TEST_SIM_BUFFER_LENGTH_BYTES) {
+            pSim->busTokens = U_GNSS_TEST_SIM_BUFFER_LENGTH_BYTES;
+            pSim->busTimeNs = nowNs;
+        }
+        if ((int64_t) size > pSim->busTokens) {
+            size = (size_t) pSim->busTokens;
+        }
+    }
+
+    return size;
+}
+
+static int32_t serialOpen(struct uDeviceSerial_t *pDeviceSerial,
+                          void *pReceiveBuffer, size_t receiveBufferSizeBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssTestSimContext_t *pSim = gpSim;
+
+    (void) pDeviceSerial;
+    (void) pReceiveBuffer;
+    (void) receiveBufferSizeBytes;
+    if (pSim != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_BUSY;
+        if (!pSim->deviceSerialOpen) {
+            pSim->deviceSerialOpen = true;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+static void serialClose(struct uDeviceSerial_t *pDeviceSerial)
+{
+    (void) pDeviceSerial;
+    if (gpSim != NULL) {
+        gpSim->deviceSerialOpen = false;
+    }
+}
+
+static int32_t serialGetReceiveSize(struct uDeviceSerial_t *pDeviceSerial)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssTestSimContext_t *pSim = gpSim;
+
+    (void) pDeviceSerial;
+    if ((pSim != NULL) && pSim->deviceSerialOpen) {
+
+        U_PORT_MUTEX_LOCK(pSim->mutex);
+
+        errorCodeOrSize = (int32_t) busLimit(pSim, uRingBufferDataSize(&(pSim->receiveRingBuffer)));
+
+        U_PORT_MUTEX_UNLOCK(pSim->mutex);
+    }
+
+    return errorCodeOrSize;
+}
+
+static int32_t serialRead(struct uDeviceSerial_t *pDeviceSerial,
+                          void *pBuffer, size_t sizeBytes)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssTestSimContext_t *pSim = gpSim;
+    size_t size;
+
+    (void) pDeviceSerial;
+    if ((pSim != NULL) && pSim->deviceSerialOpen) {
+
+        U_PORT_MUTEX_LOCK(pSim->mutex);
+
+        size = busLimit(pSim, uRingBufferDataSize(&(pSim->receiveRingBuffer)));
+        if (size > sizeBytes) {
+            size = sizeBytes;
+        }
+        size = uRingBufferRead(&(pSim->receiveRingBuffer), (char *) pBuffer, size);
+        if (pSim->config.busBytesPerSecond > 0) {
+            pSim->busTokens -= (int64_t) size;
+        }
+        errorCodeOrSize = (int32_t) size;
+
+        U_PORT_MUTEX_UNLOCK(pSim->mutex);
+    }
+
+    return errorCodeOrSize;
+}
+
+static int32_t serialWrite(struct uDeviceSerial_t *pDeviceSerial,
+                           const void *pBuffer, size_t sizeBytes)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssTestSimContext_t *pSim = gpSim;
+
+    (void) pDeviceSerial;
+    if ((pSim != NULL) && pSim->deviceSerialOpen) {
+
+        U_PORT_MUTEX_LOCK(pSim->mutex);
+
+        // Like a GNSS chip on I2C or SPI, the answer is ready as
+        // soon as the command has been written
+        commandAdd(pSim, (const char *) pBuffer, sizeBytes);
+        errorCodeOrSize = (int32_t) sizeBytes;
+
+        U_PORT_MUTEX_UNLOCK(pSim->mutex);
+    }
+
+    return errorCodeOrSize;
+}
+
+// Populate the vector table of the virtual serial device.
+static void serialInit(struct uDeviceSerial_t *pDeviceSerial)
+{
+    pDeviceSerial->open = serialOpen;
+    pDeviceSerial->close = serialClose;
+    pDeviceSerial->getReceiveSize = serialGetReceiveSize;
+    pDeviceSerial->read = serialRead;
+    pDeviceSerial->write = serialWrite;
+}
+
+// Free everything of a simulator.
+static void simFree(uGnssTestSimContext_t *pSim)
+{
+    if (pSim->pDeviceSerial != NULL) {
+        uDeviceSerialDelete(pSim->pDeviceSerial);
+    }
+    if (pSim->pReceiveBuffer != NULL) {
+        uRingBufferDelete(&(pSim->receiveRingBuffer));
+        uPortFree(pSim->pReceiveBuffer);
+    }
+    if (pSim->mutex != NULL) {
+        uPortMutexDelete(pSim->mutex);
+    }
+    uPortFree(pSim->pMessage);
+    uPortFree(pSim);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Start the simulator.
+int32_t uGnssTestSimStart(const uGnssTestSimConfig_t *pConfig)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssTestSimContext_t *pSim;
+
+    if ((pConfig != NULL) && (pConfig->rateHz >= 0) &&
+        (pConfig->rateHz <= U_GNSS_TEST_SIM_RATE_MAX_HZ) &&
+        (pConfig->numSvs <= U_GNSS_TEST_SIM_NUM_SVS_MAX) &&
+        ((pConfig->transport == U_GNSS_TEST_SIM_TRANSPORT_VIRTUAL_SERIAL) ||
+         ((pConfig->transport == U_GNSS_TEST_SIM_TRANSPORT_UART) &&
+          (pConfig->uartHandle >= 0)))) {
+        errorCode = (int32_t) U_ERROR_COMMON_BUSY;
+        if (gpSim == NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pSim = (uGnssTestSimContext_t *) pUPortMalloc(sizeof(*pSim));
+            if (pSim != NULL) {
+                memset(pSim, 0, sizeof(*pSim));
+                pSim->config = *pConfig;
+                pSim->random = pConfig->seed;
+                pSim->iTOW = U_GNSS_TEST_SIM_ITOW_START_MS;
+                pSim->busTimeNs = uPortPpsGetTimeNs();
+                if (pConfig->rateHz > 0) {
+                    pSim->nextEpochNs = pSim->busTimeNs + (1000000000LL / pConfig->rateHz);
+                }
+                pSim->pMessage = (char *) pUPortMalloc(U_GNSS_TEST_SIM_MESSAGE_LENGTH_BYTES);
+                if (pSim->pMessage != NULL) {
+                    errorCode = uPortMutexCreate(&(pSim->mutex));
+                }
+                if ((errorCode == 0) &&
+                    (pConfig->transport == U_GNSS_TEST_SIM_TRANSPORT_VIRTUAL_SERIAL)) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    pSim->pReceiveBuffer = (char *) pUPortMalloc(U_GNSS_TEST_SIM_BUFFER_LENGTH_BYTES);
+                    if (pSim->pReceiveBuffer != NULL) {
+                        errorCode = uRingBufferCreate(&(pSim->receiveRingBuffer),
+                                                      pSim->pReceiveBuffer,
+                                                      U_GNSS_TEST_SIM_BUFFER_LENGTH_BYTES);
+                        if (errorCode == 0) {
+                            pSim->pDeviceSerial = pUDeviceSerialCreate(serialInit, 0);
+                            if (pSim->pDeviceSerial == NULL) {
+                                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                            }
+                        } else {
+                            uPortFree(pSim->pReceiveBuffer);
+                            pSim->pReceiveBuffer = NULL;
+                        }
+                    }
+                }
+                if (errorCode == 0) {
+                    gpSim = pSim;
+                    errorCode = uPortTaskCreate(simTask, "gnssTestSim",
+                                                U_GNSS_TEST_SIM_TASK_STACK_SIZE_BYTES,
+                                                pSim, U_GNSS_TEST_SIM_TASK_PRIORITY,
+                                                &(pSim->taskHandle));
+                    if (errorCode != 0) {
+                        gpSim = NULL;
+                    }
+                }
+                if (errorCode != 0) {
+                    simFree(pSim);
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the virtual serial device of the simulator.
+uDeviceSerial_t *pGnssTestSimDeviceSerial()
+{
+    uDeviceSerial_t *pDeviceSerial = NULL;
+
+    if (gpSim != NULL) {
+        pDeviceSerial = gpSim->pDeviceSerial;
+    }
+
+    return pDeviceSerial;
+}
+
+// Change the navigation rate of the simulator.
+int32_t uGnssTestSimSetRate(int32_t rateHz)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssTestSimContext_t *pSim = gpSim;
+
+    if (pSim != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((rateHz >= 0) && (rateHz <= U_GNSS_TEST_SIM_RATE_MAX_HZ)) {
+
+            U_PORT_MUTEX_LOCK(pSim->mutex);
+
+            if ((rateHz > 0) && (rateHz != pSim->config.rateHz)) {
+                pSim->nextEpochNs = uPortPpsGetTimeNs() + (1000000000LL / rateHz);
+            }
+            pSim->config.rateHz = rateHz;
+
+            U_PORT_MUTEX_UNLOCK(pSim->mutex);
+
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the time at which a message was written.
+int64_t uGnssTestSimGetWriteTimeNs(uGnssTestSimStream_t stream,
+                                   uint32_t iTOW)
+{
+    int64_t errorCodeOrTimeNs = (int64_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssTestSimContext_t *pSim = gpSim;
+    const uGnssTestSimRecord_t *pRecord;
+    size_t index;
+
+    if (pSim != NULL) {
+
+        U_PORT_MUTEX_LOCK(pSim->mutex);
+
+        errorCodeOrTimeNs = (int64_t) U_ERROR_COMMON_NOT_FOUND;
+        // Search backwards from the newest
+        index = pSim->recordNext;
+        for (size_t x = 0; (x < pSim->numRecords) && (errorCodeOrTimeNs < 0); x++) {
+            if (index == 0) {
+                index = U_GNSS_TEST_SIM_MAX_NUM_RECORDS;
+            }
+            index--;
+            pRecord = &(pSim->record[index]);
+            if ((pRecord->stream == stream) && (pRecord->iTOW == iTOW)) {
+                errorCodeOrTimeNs = pRecord->timeNs;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(pSim->mutex);
+    }
+
+    return errorCodeOrTimeNs;
+}
+
+// Get the statistics of the simulator.
+int32_t uGnssTestSimGetStats(uGnssTestSimStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssTestSimContext_t *pSim = gpSim;
+
+    if (pSim != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pStats != NULL) {
+
+            U_PORT_MUTEX_LOCK(pSim->mutex);
+
+            *pStats = pSim->stats;
+
+            U_PORT_MUTEX_UNLOCK(pSim->mutex);
+
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Stop the simulator.
+void uGnssTestSimStop()
+{
+    uGnssTestSimContext_t *pSim = gpSim;
+
+    if (pSim != NULL) {
+        pSim->taskStop = true;
+        while (!pSim->taskExited) {
+            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        }
+        // Let the task finish deleting itself
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        if (pSim->pDeviceSerial != NULL) {
+            pSim->pDeviceSerial->close(pSim->pDeviceSerial);
+        }
+        gpSim = NULL;
+        simFree(pSim);
+    }
+}
+
+// End of file
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_TEST_SIM_H_
+#define _U_GNSS_TEST_SIM_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device_serial.h"
+
+/** @file
+ * @brief This header file defines a simulated GNSS chip, for GNSS
+ * API testing without any GNSS hardware.  The simulator emits a
+ * navigation epoch of UBX, NMEA and RTCM messages at a configured
+ * rate and answers what it is sent as a GNSS chip would: polls
+ * (UBX messages with an empty body) with the polled message,
+ * UBX-CFG-VALSET/VALGET/VALDEL and other UBX-CFG messages with
+ * UBX-ACK-ACK (or UBX-ACK-NAK if so configured), keeping the
+ * values set in a small table so that they can be read back, and
+ * UBX-MGA messages with UBX-MGA-ACK.  Faults (corrupted and
+ * truncated messages, fill bytes, stalls) can be injected and
+ * the time at which each message was written is recorded so that
+ * the end-to-end latency of the GNSS API can be measured.
+ *
+ * The simulator talks to the GNSS API either over a UART, e.g.
+ * UART B of the looped-back pair (a PTY pair on Linux) used by
+ * the tests, with the GNSS instance on UART A, or over an
+ * in-process virtual serial device which the GNSS instance is
+ * added on with #U_GNSS_TRANSPORT_VIRTUAL_SERIAL; the latter can
+ * be limited to the byte rate of an I2C or SPI bus.
+ *
+ * Only one simulator may run at a time.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_TEST_SIM_RATE_MAX_HZ
+/** The maximum navigation rate of the simulator.
+ */
+# define U_GNSS_TEST_SIM_RATE_MAX_HZ 25
+#endif
+
+#ifndef U_GNSS_TEST_SIM_NUM_SVS_MAX
+/** The maximum number of satellites in a UBX-NAV-SAT or
+ * UBX-RXM-RAWX message; at this number a UBX-RXM-RAWX message
+ * is over 2 kbytes long.
+ */
+# define U_GNSS_TEST_SIM_NUM_SVS_MAX 64
+#endif
+
+#ifndef U_GNSS_TEST_SIM_BUFFER_LENGTH_BYTES
+/** The length of the receive buffer of the virtual serial device;
+ * bytes written by the simulator when this is full are lost, as
+ * they would be from a UART.
+ */
+# define U_GNSS_TEST_SIM_BUFFER_LENGTH_BYTES (1024 * 8)
+#endif
+
+#ifndef U_GNSS_TEST_SIM_MAX_NUM_RECORDS
+/** The number of timing records kept by the simulator; the oldest
+ * is overwritten when this is reached.
+ */
+# define U_GNSS_TEST_SIM_MAX_NUM_RECORDS 512
+#endif
+
+#ifndef U_GNSS_TEST_SIM_MAX_NUM_VALUES
+/** The number of configuration values that the simulator can
+ * store from UBX-CFG-VALSET.
+ */
+# define U_GNSS_TEST_SIM_MAX_NUM_VALUES 32
+#endif
+
+#ifndef U_GNSS_TEST_SIM_TASK_STACK_SIZE_BYTES
+/** The stack size of the simulator task.
+ */
+# define U_GNSS_TEST_SIM_TASK_STACK_SIZE_BYTES (1024 * 4)
+#endif
+
+#ifndef U_GNSS_TEST_SIM_TASK_PRIORITY
+/** The priority of the simulator task: above that of the GNSS
+ * message receive task, as a GNSS chip does not wait for its host.
+ */
+# define U_GNSS_TEST_SIM_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 4)
+#endif
+
+/** Convert a #uGnssTestSimStream_t into a bit for the streamBitmap
+ * field of #uGnssTestSimConfig_t.
+ */
+#define U_GNSS_TEST_SIM_STREAM_BIT(stream) (1UL << (stream))
+
+/** The navigation-epoch messages that the simulator can emit.
+ */
+#define U_GNSS_TEST_SIM_STREAMS_ALL ((1UL << U_GNSS_TEST_SIM_STREAM_MAX_NUM) - 1)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The messages of each navigation epoch, emitted in this order.
+ */
+typedef enum {
+    U_GNSS_TEST_SIM_STREAM_UBX_NAV_PVT = 0,
+    U_GNSS_TEST_SIM_STREAM_UBX_NAV_SAT = 1,   /**< 12 bytes per satellite. */
+    U_GNSS_TEST_SIM_STREAM_UBX_RXM_RAWX = 2,  /**< 32 bytes per satellite. */
+    U_GNSS_TEST_SIM_STREAM_NMEA_GGA = 3,
+    U_GNSS_TEST_SIM_STREAM_NMEA_RMC = 4,
+    U_GNSS_TEST_SIM_STREAM_RTCM_1005 = 5,
+    U_GNSS_TEST_SIM_STREAM_UBX_NAV_EOE = 6,
+    U_GNSS_TEST_SIM_STREAM_MAX_NUM
+} uGnssTestSimStream_t;
+
+/** How the simulator talks to the GNSS API.
+ */
+typedef enum {
+    U_GNSS_TEST_SIM_TRANSPORT_UART = 0,          /**< over a UART that the
+                                                      caller has opened. */
+    U_GNSS_TEST_SIM_TRANSPORT_VIRTUAL_SERIAL = 1 /**< in-process, see
+                                                      pGnssTestSimDeviceSerial(). */
+} uGnssTestSimTransport_t;
+
+/** The configuration of the simulator.
+ */
+typedef struct {
+    uGnssTestSimTransport_t transport;
+    int32_t uartHandle;        /**< the UART to use if transport is
+                                    #U_GNSS_TEST_SIM_TRANSPORT_UART. */
+    int32_t busBytesPerSecond; /**< if transport is
+                                    #U_GNSS_TEST_SIM_TRANSPORT_VIRTUAL_SERIAL
+                                    the rate at which data can be read,
+                                    e.g. 44444 to model a 400 kHz I2C
+                                    bus; zero for no limit. */
+    int32_t rateHz;            /**< the navigation rate, 1 to
+                                    #U_GNSS_TEST_SIM_RATE_MAX_HZ; zero
+                                    for no navigation epochs, only
+                                    answers. */
+    uint32_t streamBitmap;     /**< the messages of each epoch, a bit-map
+                                    of U_GNSS_TEST_SIM_STREAM_BIT(). */
+    size_t numSvs;             /**< the number of satellites, up to
+                                    #U_GNSS_TEST_SIM_NUM_SVS_MAX. */
+    bool nakCfg;               /**< answer UBX-CFG messages with
+                                    UBX-ACK-NAK. */
+    int32_t corruptPerMille;   /**< the chance of a message having one
+                                    byte changed. */
+    int32_t truncatePerMille;  /**< the chance of a message being cut
+                                    short. */
+    size_t fillBytes;          /**< the number of 0xFF bytes written
+                                    after each epoch, as a GNSS chip
+                                    does on SPI when it has nothing
+                                    to send. */
+    int32_t stallPerMille;     /**< the chance, per epoch, of the
+                                    simulator falling silent. */
+    int32_t stallMs;           /**< how long a stall lasts. */
+    uint32_t seed;             /**< the seed of the fault injection,
+                                    so that a run can be repeated. */
+} uGnssTestSimConfig_t;
+
+/** Statistics of the simulator, see uGnssTestSimGetStats().
+ */
+typedef struct {
+    size_t epochs;       /**< the navigation epochs emitted. */
+    size_t messages[U_GNSS_TEST_SIM_STREAM_MAX_NUM]; /**< the messages
+                                                          emitted, of
+                                                          each stream. */
+    size_t bytes;        /**< all of the bytes written. */
+    size_t bytesLost;    /**< bytes that did not fit into the receive
+                              buffer of the virtual serial device. */
+    size_t corrupted;    /**< the messages that were corrupted. */
+    size_t truncated;    /**< the messages that were truncated. */
+    size_t stalls;       /**< the number of stalls. */
+    size_t commands;     /**< the valid UBX messages received. */
+    size_t polls;        /**< of commands, the polls answered. */
+    size_t acks;         /**< the UBX-ACK-ACKs sent. */
+    size_t naks;         /**< the UBX-ACK-NAKs sent. */
+    size_t mgaAcks;      /**< the UBX-MGA-ACKs sent. */
+} uGnssTestSimStats_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Start the simulator.  If transport is
+ * #U_GNSS_TEST_SIM_TRANSPORT_VIRTUAL_SERIAL the virtual serial
+ * device is created, see pGnssTestSimDeviceSerial().
+ *
+ * @param[in] pConfig the configuration; cannot be NULL.
+ * @return            zero on success else negative error code.
+ */
+int32_t uGnssTestSimStart(const uGnssTestSimConfig_t *pConfig);
+
+/** Get the virtual serial device of the simulator, to be opened
+ * and passed to uGnssAdd() as the transport handle with
+ * #U_GNSS_TRANSPORT_VIRTUAL_SERIAL.
+ *
+ * @return  the virtual serial device or NULL if the simulator is
+ *          not running or is using a UART.
+ */
+uDeviceSerial_t *pGnssTestSimDeviceSerial();
+
+/** Change the navigation rate of the simulator, e.g. to zero to
+ * stop the navigation epochs while what has been emitted so far
+ * is read.
+ *
+ * @param rateHz the navigation rate, 0 to
+ *               #U_GNSS_TEST_SIM_RATE_MAX_HZ.
+ * @return       zero on success else negative error code.
+ */
+int32_t uGnssTestSimSetRate(int32_t rateHz);
+
+/** Get the time at which a message was written by the simulator.
+ * Messages are identified by their stream and the iTOW of their
+ * epoch; for NMEA messages this is the UTC time of day in
+ * milliseconds, which the simulator keeps equal to iTOW.
+ *
+ * @param stream the stream.
+ * @param iTOW   the iTOW of the epoch.
+ * @return       the time, as returned by uPortPpsGetTimeNs(), at
+ *               which the last byte of the message was written,
+ *               else negative error code.
+ */
+int64_t uGnssTestSimGetWriteTimeNs(uGnssTestSimStream_t stream,
+                                   uint32_t iTOW);
+
+/** Get the statistics of the simulator.
+ *
+ * @param[out] pStats a place to put the statistics; cannot be NULL.
+ * @return            zero on success else negative error code.
+ */
+int32_t uGnssTestSimGetStats(uGnssTestSimStats_t *pStats);
+
+/** Stop the simulator.  If it was using a virtual serial device
+ * the GNSS instance on that device should be removed first; the
+ * device is closed and deleted.
+ */
+void uGnssTestSimStop();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_GNSS_TEST_SIM_H_
+
+// End of file
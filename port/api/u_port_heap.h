@@ -123,6 +123,19 @@ void uPortFree(void *pMemory);
  */
 int32_t uPortHeapAllocCount();
 
+/** Get the total number of heap allocations made since start-up:
+ * unlike uPortHeapAllocCount() this is not reduced by uPortFree(),
+ * so the difference between two readings is the number of
+ * pUPortMalloc() calls made in between, used when testing to check
+ * how often something allocates.
+ *
+ * You do not need to implement this function: where it is not
+ * implemented a #U_WEAK implementation will return zero.
+ *
+ * @return   the number of pUPortMalloc() calls made.
+ */
+int32_t uPortHeapAllocTotal();
+
 /** Used ONLY for heap accounting: this function allows the
  * code to indicate that a heap allocation has been made that
  * will NEVER be free'd.
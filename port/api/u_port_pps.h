@@ -0,0 +1,131 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_PORT_PPS_H_
+#define _U_PORT_PPS_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup __port __Port
+ *  @{
+ */
+
+/** @file
+ * @brief Porting layer for capturing the edges of a pulse-per-second
+ * (PPS) signal, e.g. the time pulse output of a GNSS chip, with a
+ * timestamp from a high-resolution host clock.  This is used by the
+ * time service (common/time_service) to discipline the host clock.
+ *
+ * The default implementation, in port/u_port_pps_default.c, returns
+ * #U_ERROR_COMMON_NOT_SUPPORTED from uPortPpsOpen() and derives
+ * uPortPpsGetTimeNs() from uPortGetTickTimeMs(); on such platforms
+ * the application may capture the edges itself (e.g. with a timer
+ * capture interrupt) and pass them to the time service from task
+ * context.  The Linux implementation captures edges from a kernel
+ * PPS device (e.g. /dev/pps0) or from a GPIO line through libgpiod.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_PORT_PPS_MAX_NUM
+/** The maximum number of PPS inputs that may be open at any one
+ * time.
+ */
+# define U_PORT_PPS_MAX_NUM 2
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The callback that receives each captured PPS edge.
+ *
+ * @param ppsHandle       the handle returned by uPortPpsOpen().
+ * @param timestampNs     the time of the edge in nanoseconds, in the
+ *                        time base of uPortPpsGetTimeNs().
+ * @param pCallbackParam  the pCallbackParam passed to uPortPpsOpen().
+ */
+typedef void (*uPortPpsCallback_t)(int32_t ppsHandle,
+                                   int64_t timestampNs,
+                                   void *pCallbackParam);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Get the current time of the clock in which PPS edges are
+ * timestamped: a monotonic clock with the highest resolution
+ * available, unaffected by changes to the wall-clock time.
+ *
+ * @return the time in nanoseconds since an arbitrary start point.
+ */
+int64_t uPortPpsGetTimeNs(void);
+
+/** Start capturing the rising edges of a PPS signal.
+ *
+ * @param[in] pDevice     the name of a PPS device, e.g. "/dev/pps0"
+ *                        on Linux; use NULL to capture the edges
+ *                        on pin instead.
+ * @param pin             the GPIO pin the PPS signal is connected to,
+ *                        ignored if pDevice is not NULL.
+ * @param index           the GPIO chip that pin is on, see the index
+ *                        field of #uPortGpioConfig_t; use -1 for the
+ *                        default.
+ * @param pCallback       the callback that will be called with the
+ *                        timestamp of each edge, from a task of the
+ *                        port layer; cannot be NULL.
+ * @param pCallbackParam  a parameter that will be passed to pCallback.
+ * @return                on success a handle for the PPS input, else
+ *                        negative error code.
+ */
+int32_t uPortPpsOpen(const char *pDevice, int32_t pin, int32_t index,
+                     uPortPpsCallback_t pCallback,
+                     void *pCallbackParam);
+
+/** Stop capturing PPS edges; once this function has returned the
+ * callback will not be called again.  Must not be called from the
+ * callback.
+ *
+ * @param ppsHandle the handle returned by uPortPpsOpen().
+ */
+void uPortPpsClose(int32_t ppsHandle);
+
+/** Workaround for Espressif linker missing out files that
+ * only contain functions which also have weak alternatives
+ * (see https://www.esp32.com/viewtopic.php?f=13&t=8418&p=35899).
+ *
+ * You can ignore this function.
+ */
+void uPortPpsDefaultPrivateLink(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_PORT_PPS_H_
+
+// End of file
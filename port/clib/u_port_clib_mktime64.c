@@ -22,6 +22,7 @@
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
+#include "stddef.h"    // size_t
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 #include "time.h"      // struct tm
@@ -33,6 +33,7 @@
 #include "u_port_uart.h"
 #include "u_port_event_queue_private.h"
 #include "u_port_ppp.h"
+#include "u_port_pps.h"
 #include "u_port_ppp_private.h"
 #include "u_port_private.h"
 
@@ -119,6 +120,7 @@ int32_t uPortInit()
     // that will always be present in the build, which for the port
     // layer we choose to be here
     uPortPppDefaultPrivateLink();
+    uPortPpsDefaultPrivateLink();
 
     if (!gInitialised) {
         errorCode = uPortHeapMonitorInit(NULL, NULL, NULL);
@@ -106,6 +106,13 @@ int32_t _uPortMutexUnlock(uPortMutexHandle_t mutexHandle);
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_PORT_LINUX_CRITICAL_SECTION_ACK_TIMEOUT_MS
+/** How long uPortEnterCritical() waits for the other tasks
+ * to be suspended.
+ */
+# define U_PORT_LINUX_CRITICAL_SECTION_ACK_TIMEOUT_MS 100
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -171,6 +178,12 @@ uLinkedList_t *gpTimerList = NULL;
 // Can be enabled via U_PORT_LINUX_ENABLE_CRITICAL_SECTIONS
 uPortMutexHandle_t gMutexCriticalSection = NULL;
 
+// The number of tasks in threadSignalCallback(), i.e. suspended
+// for a critical section; a task that is still there from an
+// earlier critical section has the signal blocked but is held
+// just the same.
+static int32_t gCriticalSectionNumSuspended = 0;
+
 // Variable to keep track of OS resource usage.
 static int32_t gResourceAllocCount = 0;
 
@@ -196,9 +209,19 @@ static void msToTimeSpec(int32_t ms, struct timespec *t, bool fromNow)
 
 static void threadSignalCallback(int sig)
 {
+    int cancelState;
+    (void) sig;
+    // The signal may arrive while the task is in a system call
+    // during which it can be cancelled at any moment, e.g. the UART
+    // read task being deleted, and it must not die holding the mutex
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancelState);
+    // Let uPortEnterCritical() know that we are suspended
+    U_ATOMIC_INCREMENT(&gCriticalSectionNumSuspended);
     // Blocked wait for mutex when signal received.
     MTX_FN(uPortMutexLock(gMutexCriticalSection));
     MTX_FN(uPortMutexUnlock(gMutexCriticalSection));
+    U_ATOMIC_DECREMENT(&gCriticalSectionNumSuspended);
+    pthread_setcancelstate(cancelState, NULL);
 }
 
 // Posix threads want function returning void*
@@ -210,7 +233,8 @@ static void *taskProc(void *pParam)
     // Setup the signal used for suspending the thread.
     struct sigaction act;
     sigemptyset(&act.sa_mask);
-    act.sa_flags = 0;
+    // Restart any read() or write() that the signal interrupts
+    act.sa_flags = SA_RESTART;
     act.sa_handler = threadSignalCallback;
     sigaction(SIGUSR1, &act, NULL);
 
@@ -220,29 +244,53 @@ static void *taskProc(void *pParam)
 }
 
 #ifdef U_PORT_LINUX_ENABLE_CRITICAL_SECTIONS
+// Return true if the given clock time has passed.
+static bool timeSpecHasPassed(const struct timespec *t)
+{
+    struct timespec now = {0};
+    timespec_get(&now, TIME_UTC);
+    return (now.tv_sec > t->tv_sec) ||
+           ((now.tv_sec == t->tv_sec) && (now.tv_nsec >= t->tv_nsec));
+}
+
 // Suspend or resume all tasks but the current.
 static int32_t suspendOrResumeAllTasks(bool suspend)
 {
-    uErrorCode_t errorCode = errorCode = U_ERROR_COMMON_SUCCESS;
-    MTX_FN(uPortMutexLock(gMutexThread));
+    uErrorCode_t errorCode = U_ERROR_COMMON_SUCCESS;
+    struct timespec timeout;
+    int32_t numSignalled = 0;
     if (suspend) {
-        errorCode = MTX_FN(uPortMutexTryLock(gMutexCriticalSection, 0));
+        // Wait for any other critical section to end rather than
+        // failing: callers, e.g. the AT client, may call
+        // uPortExitCritical() without checking the return value
+        // and would then end the other task's critical section
+        errorCode = MTX_FN(uPortMutexLock(gMutexCriticalSection));
+        MTX_FN(uPortMutexLock(gMutexThread));
         uLinkedList_t *p = gpThreadList;
-        // Signal all tasks to suspend.
+        // Signal all tasks to suspend; one that can't be signalled
+        // has already exited
         while ((errorCode == U_ERROR_COMMON_SUCCESS) && (p != NULL)) {
             pthread_t threadId = (pthread_t)(p->p);
-            if (threadId != pthread_self()) {
-                if (pthread_kill(threadId, SIGUSR1) != 0) {
-                    errorCode = U_ERROR_COMMON_PLATFORM;
-                }
+            if ((threadId != pthread_self()) &&
+                (pthread_kill(threadId, SIGUSR1) == 0)) {
+                numSignalled++;
             }
             p = p->pNext;
         }
+        // Wait for them to be suspended, rather than for a fixed
+        // time, still holding gMutexThread so that none of them
+        // can be suspended while holding it
+        msToTimeSpec(U_PORT_LINUX_CRITICAL_SECTION_ACK_TIMEOUT_MS, &timeout, true);
+        while ((U_ATOMIC_GET(&gCriticalSectionNumSuspended) < numSignalled) &&
+               !timeSpecHasPassed(&timeout)) {
+            sched_yield();
+        }
+        MTX_FN(uPortMutexUnlock(gMutexThread));
     } else {
+        // Not gMutexThread: the suspended tasks can't be holding
+        // it but a task that was not yet suspended might be
         MTX_FN(uPortMutexUnlock(gMutexCriticalSection));
     }
-    MTX_FN(uPortMutexUnlock(gMutexThread));
-    uPortTaskBlock(100);
     return errorCode;
 }
 #endif
@@ -479,7 +527,11 @@ bool uPortTaskIsThis(const uPortTaskHandle_t taskHandle)
 // Block the current task for a time.
 void uPortTaskBlock(int32_t delayMs)
 {
-    usleep(delayMs * 1000);
+    struct timespec t = {0};
+    msToTimeSpec(delayMs, &t, false);
+    // Carry on for the remaining time if a signal, e.g. one
+    // suspending this task for a critical section, interrupts
+    while ((nanosleep(&t, &t) != 0) && (errno == EINTR)) {}
 }
 
 // Get the minimum free stack for a given task.
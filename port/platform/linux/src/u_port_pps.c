@@ -0,0 +1,320 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Implementation of the port PPS API on Linux.  The edges
+ * of a PPS signal are captured either from a kernel PPS device
+ * (e.g. /dev/pps0, as provided by the pps-gpio driver), which is
+ * the most accurate as the timestamp is taken in the interrupt
+ * handler, or from a GPIO line using the edge events of the gpiod
+ * library, hence libgpiod-dev must be installed.
+ *
+ * The timestamps of gpiod edge events are in CLOCK_MONOTONIC for
+ * kernels 5.7 and later, which is the clock of uPortPpsGetTimeNs();
+ * the timestamps of a PPS device are in CLOCK_REALTIME and are
+ * converted to CLOCK_MONOTONIC as they are captured.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memset()
+#include "time.h"      // clock_gettime()
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/ioctl.h"
+#include "linux/pps.h"
+#include "gpiod.h"
+
+#include "u_cfg_os_platform_specific.h"
+#include "u_error_common.h"
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_pps.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_PORT_PPS_WAIT_MS
+/** How long the capture task waits for an edge before checking
+ * whether it has been asked to exit.
+ */
+# define U_PORT_PPS_WAIT_MS 100
+#endif
+
+#ifndef U_PORT_PPS_GPIO_CHIP_NAME_BASE
+/** The base name of a GPIO chip, followed by the index, as for
+ * the port GPIO API.
+ */
+# define U_PORT_PPS_GPIO_CHIP_NAME_BASE "gpiochip"
+#endif
+
+#ifndef U_PORT_PPS_CONSUMER_NAME
+# define U_PORT_PPS_CONSUMER_NAME "ubxlib_pps"
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A PPS input.
+ */
+typedef struct {
+    int32_t fd;                    /**< the PPS device, -1 if a GPIO
+                                        line is used. */
+    struct gpiod_chip *pChip;      /**< the GPIO chip, if fd is -1. */
+    struct gpiod_line *pLine;      /**< the GPIO line, if fd is -1. */
+    uPortPpsCallback_t pCallback;
+    void *pCallbackParam;
+    uPortTaskHandle_t taskHandle;
+    volatile bool markedForDeletion;
+    volatile bool taskExited;
+} uPortPpsInstance_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The PPS inputs, the index being the handle.
+ */
+static uPortPpsInstance_t *gpInstance[U_PORT_PPS_MAX_NUM] = {0};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Convert a timespec to nanoseconds.
+static int64_t timespecToNs(const struct timespec *pTs)
+{
+    return (((int64_t) pTs->tv_sec) * 1000000000) + pTs->tv_nsec;
+}
+
+// Capture edges from a kernel PPS device; PPS_FETCH waits for
+// the next edge, returning an error if there is none within the
+// timeout.
+static void ppsDeviceLoop(int32_t ppsHandle, uPortPpsInstance_t *pInstance)
+{
+    struct pps_fdata fdata;
+    struct timespec realtime;
+    struct timespec monotonic;
+    int64_t timestampNs;
+
+    while (!pInstance->markedForDeletion) {
+        memset(&fdata, 0, sizeof(fdata));
+        fdata.timeout.nsec = U_PORT_PPS_WAIT_MS * 1000000;
+        if (ioctl(pInstance->fd, PPS_FETCH, &fdata) == 0) {
+            // The kernel timestamp is CLOCK_REALTIME: move it
+            // across to CLOCK_MONOTONIC using the current offset
+            // between the two
+            clock_gettime(CLOCK_REALTIME, &realtime);
+            clock_gettime(CLOCK_MONOTONIC, &monotonic);
+            timestampNs = (((int64_t) fdata.info.assert_tu.sec) * 1000000000) +
+                          fdata.info.assert_tu.nsec;
+            timestampNs -= timespecToNs(&realtime) - timespecToNs(&monotonic);
+            pInstance->pCallback(ppsHandle, timestampNs,
+                                 pInstance->pCallbackParam);
+        }
+    }
+}
+
+// Capture edges from a GPIO line.
+static void gpioLoop(int32_t ppsHandle, uPortPpsInstance_t *pInstance)
+{
+    struct gpiod_line_event event;
+    struct timespec timeout = {.tv_sec = 0,
+               .tv_nsec = U_PORT_PPS_WAIT_MS * 1000000
+    };
+
+    while (!pInstance->markedForDeletion) {
+        if ((gpiod_line_event_wait(pInstance->pLine, &timeout) == 1) &&
+            (gpiod_line_event_read(pInstance->pLine, &event) == 0) &&
+            (event.event_type == GPIOD_LINE_EVENT_RISING_EDGE)) {
+            pInstance->pCallback(ppsHandle, timespecToNs(&event.ts),
+                                 pInstance->pCallbackParam);
+        }
+    }
+}
+
+// The capture task.
+static void captureTask(void *pParameter)
+{
+    int32_t ppsHandle = (int32_t) (intptr_t) pParameter;
+    uPortPpsInstance_t *pInstance = gpInstance[ppsHandle];
+
+    if (pInstance->fd >= 0) {
+        ppsDeviceLoop(ppsHandle, pInstance);
+    } else {
+        gpioLoop(ppsHandle, pInstance);
+    }
+    pInstance->taskExited = true;
+}
+
+// Open the PPS device or GPIO line of an instance.
+static int32_t instanceOpen(uPortPpsInstance_t *pInstance,
+                            const char *pDevice, int32_t pin,
+                            int32_t index)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+    struct pps_kparams params;
+    int32_t mode = 0;
+    char chipName[16];
+
+    if (pDevice != NULL) {
+        pInstance->fd = open(pDevice, O_RDWR);
+        if (pInstance->fd < 0) {
+            // Capture parameters can't be set without write
+            // permission but the default is usually assert anyway
+            pInstance->fd = open(pDevice, O_RDONLY);
+        }
+        if ((pInstance->fd >= 0) &&
+            (ioctl(pInstance->fd, PPS_GETCAP, &mode) == 0)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if ((mode & PPS_CAPTUREASSERT) != 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (ioctl(pInstance->fd, PPS_GETPARAMS, &params) == 0) {
+                    params.mode |= PPS_CAPTUREASSERT;
+                    ioctl(pInstance->fd, PPS_SETPARAMS, &params);
+                }
+            }
+        }
+    } else {
+        if (index < 0) {
+            index = 0;
+        }
+        snprintf(chipName, sizeof(chipName), "%s%d",
+                 U_PORT_PPS_GPIO_CHIP_NAME_BASE, (int) index);
+        pInstance->pChip = gpiod_chip_open_by_name(chipName);
+        if (pInstance->pChip != NULL) {
+            pInstance->pLine = gpiod_chip_get_line(pInstance->pChip,
+                                                   (unsigned int) pin);
+            if ((pInstance->pLine != NULL) &&
+                (gpiod_line_request_rising_edge_events(pInstance->pLine,
+                                                       U_PORT_PPS_CONSUMER_NAME) == 0)) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            } else {
+                pInstance->pLine = NULL;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Close the PPS device or GPIO line of an instance.
+static void instanceClose(uPortPpsInstance_t *pInstance)
+{
+    if (pInstance->fd >= 0) {
+        close(pInstance->fd);
+    }
+    if (pInstance->pLine != NULL) {
+        gpiod_line_release(pInstance->pLine);
+    }
+    if (pInstance->pChip != NULL) {
+        gpiod_chip_close(pInstance->pChip);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Get the time of the clock that PPS edges are timestamped with.
+int64_t uPortPpsGetTimeNs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return timespecToNs(&ts);
+}
+
+// Start capturing the edges of a PPS signal.
+int32_t uPortPpsOpen(const char *pDevice, int32_t pin, int32_t index,
+                     uPortPpsCallback_t pCallback,
+                     void *pCallbackParam)
+{
+    int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortPpsInstance_t *pInstance;
+    int32_t ppsHandle = -1;
+
+    if ((pCallback != NULL) && ((pDevice != NULL) || (pin >= 0))) {
+        errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        for (size_t x = 0; (ppsHandle < 0) &&
+             (x < sizeof(gpInstance) / sizeof(gpInstance[0])); x++) {
+            if (gpInstance[x] == NULL) {
+                ppsHandle = (int32_t) x;
+            }
+        }
+        if (ppsHandle >= 0) {
+            pInstance = (uPortPpsInstance_t *) pUPortMalloc(sizeof(*pInstance));
+            if (pInstance != NULL) {
+                memset(pInstance, 0, sizeof(*pInstance));
+                pInstance->fd = -1;
+                pInstance->pCallback = pCallback;
+                pInstance->pCallbackParam = pCallbackParam;
+                errorCodeOrHandle = instanceOpen(pInstance, pDevice, pin, index);
+                if (errorCodeOrHandle == 0) {
+                    gpInstance[ppsHandle] = pInstance;
+                    errorCodeOrHandle = uPortTaskCreate(captureTask, "ppsCapture",
+                                                        4 * 1024,
+                                                        (void *) (intptr_t) ppsHandle,
+                                                        U_CFG_OS_PRIORITY_MAX - 1,
+                                                        &(pInstance->taskHandle));
+                    if (errorCodeOrHandle == 0) {
+                        errorCodeOrHandle = ppsHandle;
+                    } else {
+                        gpInstance[ppsHandle] = NULL;
+                    }
+                }
+                if (errorCodeOrHandle < 0) {
+                    instanceClose(pInstance);
+                    uPortFree(pInstance);
+                }
+            }
+        }
+    }
+
+    return errorCodeOrHandle;
+}
+
+// Stop capturing PPS edges.
+void uPortPpsClose(int32_t ppsHandle)
+{
+    uPortPpsInstance_t *pInstance;
+
+    if ((ppsHandle >= 0) &&
+        (ppsHandle < (int32_t) (sizeof(gpInstance) / sizeof(gpInstance[0])))) {
+        pInstance = gpInstance[ppsHandle];
+        if (pInstance != NULL) {
+            pInstance->markedForDeletion = true;
+            while (!pInstance->taskExited) {
+                uPortTaskBlock(U_CFG_OS_YIELD_MS);
+            }
+            instanceClose(pInstance);
+            gpInstance[ppsHandle] = NULL;
+            uPortFree(pInstance);
+        }
+    }
+}
+
+// End of file
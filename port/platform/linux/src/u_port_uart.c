@@ -145,6 +145,14 @@ static void eventHandler(void *pParam, size_t paramLength)
     }
 }
 
+// read() that returns zero, rather than -1, on error, so that
+// the result can be added to a buffer position.
+static size_t readNoError(int fd, void *pBuffer, size_t count)
+{
+    ssize_t length = read(fd, pBuffer, count);
+    return length > 0 ? (size_t) length : 0;
+}
+
 // Task handling incoming uart data
 static void readTask(void *pParam)
 {
@@ -176,17 +184,19 @@ static void readTask(void *pParam)
                     // Write pos ahead of read. Use the remaining area in the
                     // buffer first.
                     cnt = MIN(available, p->bufferSize - p->writePos);
-                    cnt = read(p->uartFd, p->pBuffer + p->writePos, cnt);
+                    cnt = readNoError(p->uartFd, p->pBuffer + p->writePos, cnt);
                     if (cnt > 0) {
                         available -= cnt;
                         p->writePos = (p->writePos + cnt) % p->bufferSize;
+                        // If readPos was zero we may have wrapped onto it
+                        p->bufferFull = p->writePos == readPos;
                     }
                     tot = cnt;
                 }
                 if ((available > 0) && (p->writePos < readPos)) {
                     // Read pos ahead of write.
                     cnt = MIN(available, readPos - p->writePos);
-                    cnt = read(p->uartFd, p->pBuffer + p->writePos, cnt);
+                    cnt = readNoError(p->uartFd, p->pBuffer + p->writePos, cnt);
                     if (cnt > 0) {
                         available -= cnt;
                         p->writePos = (p->writePos + cnt) % p->bufferSize;
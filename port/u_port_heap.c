@@ -128,6 +128,11 @@ typedef struct uPortHeapBlock_t {
  */
 static int32_t gHeapAllocCount = 0;
 
+/** Variable to keep track of the total number of heap allocations
+ * ever made.
+ */
+static int32_t gHeapAllocTotal = 0;
+
 /** Variable to keep track of the total number of perpetual heap
  * allocations.
  */
@@ -199,6 +204,7 @@ U_WEAK void *pUPortMalloc(size_t sizeBytes)
     void *pMalloc = malloc(sizeBytes);
     if (pMalloc != NULL) {
         gHeapAllocCount++;
+        gHeapAllocTotal++;
     }
     return pMalloc;
 }
@@ -325,6 +331,11 @@ U_WEAK int32_t uPortHeapAllocCount()
     return gHeapAllocCount;
 }
 
+U_WEAK int32_t uPortHeapAllocTotal()
+{
+    return gHeapAllocTotal;
+}
+
 U_WEAK void uPortHeapPerpetualAllocAdd()
 {
     gHeapPerpetualAllocCount++;
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Default implementations of uPortPpsOpen() and uPortPpsClose(),
+ * which simply return #U_ERROR_COMMON_NOT_SUPPORTED, and of
+ * uPortPpsGetTimeNs(), which is derived from uPortGetTickTimeMs().
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+/* ----------------------------------------------------------------
+ * INCLUDE FILES
+ * -------------------------------------------------------------- */
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_compiler.h"  // U_WEAK
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_pps.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: WORKAROUND FOR LINKER ISSUE
+ * -------------------------------------------------------------- */
+
+void uPortPpsDefaultPrivateLink()
+{
+    //dummy
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Get the time of the clock that PPS edges are timestamped with.
+U_WEAK int64_t uPortPpsGetTimeNs()
+{
+    return ((int64_t) uPortGetTickTimeMs()) * 1000000;
+}
+
+// Start capturing the edges of a PPS signal.
+U_WEAK int32_t uPortPpsOpen(const char *pDevice, int32_t pin,
+                            int32_t index,
+                            uPortPpsCallback_t pCallback,
+                            void *pCallbackParam)
+{
+    (void) pDevice;
+    (void) pin;
+    (void) index;
+    (void) pCallback;
+    (void) pCallbackParam;
+    return (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+// Stop capturing PPS edges.
+U_WEAK void uPortPpsClose(int32_t ppsHandle)
+{
+    (void) ppsHandle;
+}
+
+// End of file
@@ -109,6 +109,7 @@ u_add_module_dir(base ${UBXLIB_BASE}/common/spartn)
 u_add_module_dir(base ${UBXLIB_BASE}/common/utils)
 u_add_module_dir(base ${UBXLIB_BASE}/common/dns)
 u_add_module_dir(base ${UBXLIB_BASE}/common/geofence)
+u_add_module_dir(base ${UBXLIB_BASE}/common/time_service)
 u_add_module_dir(base ${UBXLIB_BASE}/port/platform/common/debug_utils)
 
 # Additional source directories
@@ -173,6 +174,9 @@ list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_resource.c)
 # Default uPortPppAttach()/uPortPppDetach() implementation
 list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_ppp_default.c)
 
+# Default uPortPpsOpen()/uPortPpsClose() implementation
+list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_pps_default.c)
+
 # Default uPortDeviceXxx implementation
 list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_board_cfg.c)
 
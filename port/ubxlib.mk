@@ -20,6 +20,7 @@ UBXLIB_MODULE_DIRS = \
 	${UBXLIB_BASE}/common/utils \
 	${UBXLIB_BASE}/common/dns \
 	${UBXLIB_BASE}/common/geofence \
+	${UBXLIB_BASE}/common/time_service \
 	${UBXLIB_BASE}/port/platform/common/debug_utils
 
 # Additional source directories
@@ -75,6 +76,9 @@ SRC_LIST += ${UBXLIB_BASE}/port/u_port_resource.c
 # Default uPortPppAttach()/uPortPppDetach() implementation
 UBXLIB_SRC += ${UBXLIB_BASE}/port/u_port_ppp_default.c
 
+# Default uPortPpsOpen()/uPortPpsClose() implementation
+UBXLIB_SRC += ${UBXLIB_BASE}/port/u_port_pps_default.c
+
 # Default uPortDeviceXxx implementation
 UBXLIB_SRC += ${UBXLIB_BASE}/port/u_port_board_cfg.c
 
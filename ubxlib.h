@@ -60,6 +60,7 @@
 #include <u_port_event_queue.h>
 #include <u_port_gatt.h>
 #include <u_port_gpio.h>
+#include <u_port_pps.h>
 #include <u_port_uart.h>
 #include <u_port_i2c.h>
 #include <u_port_spi.h>
@@ -108,6 +109,7 @@
 #include <u_short_range_module_type.h>
 #include <u_dns_server.h>
 #include <u_geofence.h>
+#include <u_time_service.h>
 
 // BLE/cellular/GNSS/Wi-Fi APIs
 #include <u_ble.h>
@@ -144,6 +146,12 @@
 #include <u_gnss_dec.h>
 #include <u_gnss_dec_ubx_nav_pvt.h>
 #include <u_gnss_dec_ubx_nav_hpposllh.h>
+#include <u_gnss_dec_ubx_nav_dop.h>
+#include <u_gnss_dec_ubx_nav_status.h>
+#include <u_gnss_dec_ubx_nav_cov.h>
+#include <u_gnss_dec_ubx_nav_sat.h>
+#include <u_gnss_dec_nmea.h>
+#include <u_gnss_epoch.h>
 #include <u_gnss_mga.h>
 #include <u_gnss_geofence.h>
 #include <u_gnss_util.h>
@@ -77,6 +77,19 @@ extern "C" {
 #define U_WIFI_CIPHER_MASK_AES_CCMP    (1 << 3)
 #define U_WIFI_CIPHER_MASK_UNKNOWN     0xFF /**< This will be the value for modules that doesn't support cipher masks */
 
+#ifndef U_WIFI_STATION_CONFIG_PIPELINE
+/** If this is 1 then the commands with which uWifiStationConnect()
+ * configures the station are sent one after the other, without
+ * waiting for the response to each, and the responses are then
+ * collected together.  This is 0 by default, waiting for the
+ * response to each command before sending the next, since the
+ * inter-command delay of the module is not applied between
+ * pipelined commands; set it to 1 only where the module has been
+ * shown to keep up.
+ */
+# define U_WIFI_STATION_CONFIG_PIPELINE 0
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -116,6 +129,30 @@ typedef struct {
     uint8_t grpCipherBitmask;   /**< group cipher bitmask, see U_WIFI_CIPHER_MASK_xx defines for values. */
 } uWifiScanResult_t;
 
+/** Statistics of the connection of a Wifi station, see
+ * uWifiStationGetConnectStats().  The times up to a connection
+ * are only measured if a connection status callback has been set
+ * with uWifiSetConnectionStatusCallback(), which the network API
+ * always does.
+ */
+typedef struct {
+    int32_t numAtCommands;        /**< the number of AT commands sent by
+                                       the most recent uWifiStationConnect()
+                                       or uWifiStationReconnect(). */
+    int32_t commandTimeMs;        /**< how long those AT commands took. */
+    int32_t connectToConnectedMs; /**< the time from the start of the most
+                                       recent uWifiStationConnect() or
+                                       uWifiStationReconnect() to the
+                                       connection that followed it, -1 if
+                                       there has not yet been one. */
+    int32_t disconnectToConnectedMs; /**< the time from the most recent
+                                          loss of the connection, other
+                                          than by uWifiStationDisconnect(),
+                                          to the connection that followed
+                                          it, -1 if there has not yet been
+                                          one. */
+} uWifiStationConnectStats_t;
+
 /** Scan result callback type.
  *
  * This callback will be called once for each entry found.
@@ -183,7 +220,10 @@ void uWifiDeinit();
  */
 int32_t uWifiSetHostName(uDeviceHandle_t devHandle, const char *pHostName);
 
-/** Connect to a Wifi access point
+/** Connect to a Wifi access point.  The parts of the configuration
+ * that the module already has, from a previous call, are not
+ * written again and, where the whole configuration matches that
+ * stored with uWifiStationStoreConfig(), it is loaded from there.
  *
  * @param devHandle        the handle of the wifi instance.
  * @param[in] pSsid        the Service Set Identifier
@@ -196,6 +236,37 @@ int32_t uWifiSetHostName(uDeviceHandle_t devHandle, const char *pHostName);
 int32_t uWifiStationConnect(uDeviceHandle_t devHandle, const char *pSsid,
                             uWifiAuth_t authentication, const char *pPassPhrase);
 
+/** Connect to a Wifi access point again, with the configuration
+ * passed to the most recent successful call to uWifiStationConnect(),
+ * e.g. after the connection has been lost.
+ *
+ * uWifiStationConnect() remembers the configuration it has
+ * written to the module and that which has been stored with
+ * uWifiStationStoreConfig(), writing only what has changed, or
+ * loading the stored configuration if that is quicker, hence a
+ * reconnection normally costs only a status check and the
+ * activation; this function saves the caller from keeping the
+ * configuration to pass it again.
+ *
+ * @param devHandle  the handle of the wifi instance.
+ * @return           zero on successful, #U_WIFI_ERROR_NOT_CONFIGURED
+ *                   if uWifiStationConnect() has not been called
+ *                   successfully, else negative error code.
+ *                   Note: there is no actual connection until the
+ *                   Wifi callback reports connected.
+ */
+int32_t uWifiStationReconnect(uDeviceHandle_t devHandle);
+
+/** Get the statistics of the connection of a Wifi station, e.g. to
+ * see how long it takes to recover from losing a connection.
+ *
+ * @param devHandle   the handle of the wifi instance.
+ * @param[out] pStats a place to put the statistics, cannot be NULL.
+ * @return            zero on successful, else negative error code.
+ */
+int32_t uWifiStationGetConnectStats(uDeviceHandle_t devHandle,
+                                    uWifiStationConnectStats_t *pStats);
+
 /** Disconnect from Wifi access point
  *
  * @param devHandle the handle of the wifi instance.
@@ -54,6 +54,45 @@ extern "C" {
 # define U_WIFI_CAPTIVE_PORTAL_DNS_TASK_PRIORITY (U_CFG_OS_APP_TASK_PRIORITY + 1)
 #endif
 
+#ifndef U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS
+/** The number of HTTP connections that the captive portal will
+ * serve at the same time; a connection arriving when all are in
+ * use is sent "503 Service Unavailable" and closed.
+ */
+# define U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS 4
+#endif
+
+#ifndef U_WIFI_CAPTIVE_PORTAL_HTTP_REQUEST_MAX_LENGTH_BYTES
+/** The largest HTTP request, headers plus body, that the captive
+ * portal will accept; one buffer of this size is allocated for
+ * each of #U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS.
+ */
+# define U_WIFI_CAPTIVE_PORTAL_HTTP_REQUEST_MAX_LENGTH_BYTES 1024
+#endif
+
+#ifndef U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_MAX_LENGTH_BYTES
+/** The size of the buffer that a route handler (see
+ * uWifiCaptivePortalHttpHandler_t) may write its response body
+ * into; static content given in a route is not limited by this.
+ */
+# define U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_MAX_LENGTH_BYTES 1024
+#endif
+
+#ifndef U_WIFI_CAPTIVE_PORTAL_HTTP_KEEP_ALIVE_MS
+/** How long an idle keep-alive HTTP connection is held open
+ * before the captive portal closes it.
+ */
+# define U_WIFI_CAPTIVE_PORTAL_HTTP_KEEP_ALIVE_MS 5000
+#endif
+
+#ifndef U_WIFI_CAPTIVE_PORTAL_HTTP_POLL_MS
+/** The longest the HTTP engine of the captive portal sleeps
+ * between looking for new connections and calling its keep-going
+ * callback; data arriving on an open connection wakes it at once.
+ */
+# define U_WIFI_CAPTIVE_PORTAL_HTTP_POLL_MS 100
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -66,10 +105,89 @@ extern "C" {
  */
 typedef bool (*uWifiCaptivePortalKeepGoingCallback_t)(uDeviceHandle_t deviceHandle);
 
+/** An HTTP request, as passed to a uWifiCaptivePortalHttpHandler_t;
+ * the strings are null-terminated and valid only for the duration
+ * of the call.
+ */
+typedef struct {
+    const char *pMethod;  /**< e.g. "GET" or "POST". */
+    const char *pPath;    /**< the path, without any query string,
+                               e.g. "/set_wifi". */
+    const char *pQuery;   /**< the query string, without the '?',
+                               empty if there is none. */
+    const char *pBody;    /**< the body, null-terminated, empty
+                               if there is none. */
+    size_t bodyLength;    /**< the length of pBody. */
+} uWifiCaptivePortalHttpRequest_t;
+
+/** Handler for an HTTP route, see uWifiCaptivePortalHttpRoute_t.
+ *
+ * @param[in] pRequest       the request.
+ * @param[out] pBody         a buffer for the body of the response.
+ * @param bodySize           the size of pBody, see
+ *                           #U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_MAX_LENGTH_BYTES.
+ * @param[out] pBodyLength   set this to the length of what has been
+ *                           written to pBody; zero on entry.
+ * @param[in,out] ppContentType on entry the pContentType of the route,
+ *                           may be changed to point to another constant
+ *                           string.
+ * @param[in] pParam         the pHandlerParam of the route.
+ * @return                   the HTTP status code to respond with,
+ *                           e.g. 200.
+ */
+typedef int32_t (*uWifiCaptivePortalHttpHandler_t)(const uWifiCaptivePortalHttpRequest_t
+                                                   *pRequest,
+                                                   char *pBody, size_t bodySize,
+                                                   size_t *pBodyLength,
+                                                   const char **ppContentType,
+                                                   void *pParam);
+
+/** A route served by the HTTP engine of the captive portal: a
+ * request matching pMethod and pPath is answered either by the
+ * static content given here or by calling pHandler.
+ */
+typedef struct {
+    const char *pMethod;       /**< the method, e.g. "GET"; a route
+                                    for "GET" also answers "HEAD". */
+    const char *pPath;         /**< the path, e.g. "/index.html"; a
+                                    final '*' matches any ending,
+                                    so "*" alone matches any path. */
+    const char *pContentType;  /**< the Content-Type of the response,
+                                    e.g. "text/html"; may be NULL if
+                                    there is no body. */
+    const char *pContent;      /**< static content to respond with,
+                                    used if pHandler is NULL; must
+                                    remain valid while the captive
+                                    portal runs, may be NULL for an
+                                    empty body. */
+    size_t contentLength;      /**< the length of pContent. */
+    uWifiCaptivePortalHttpHandler_t pHandler; /**< handler to call
+                                                   to build the
+                                                   response, NULL
+                                                   for static
+                                                   content. */
+    void *pHandlerParam;       /**< passed to pHandler. */
+} uWifiCaptivePortalHttpRoute_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
 
+/** Add routes to the web server of the captive portal, e.g. to
+ * serve a logo or a style-sheet, or to receive a form other than
+ * the Wi-Fi credentials; the routes are consulted in order, before
+ * the built-in ones (which serve the page at "/", the SSID list at
+ * "/get_ssid_list" and take credentials posted to "/set_wifi"),
+ * so a route here may also replace a built-in one.  Call this
+ * before uWifiCaptivePortal(); the table is not copied and so must
+ * remain valid while the captive portal runs.
+ *
+ * @param[in] pRoutes the routes, NULL to remove any previously set.
+ * @param numRoutes   the number of entries in pRoutes.
+ */
+void uWifiCaptivePortalSetRoutes(const uWifiCaptivePortalHttpRoute_t *pRoutes,
+                                 size_t numRoutes);
+
 /** Create the captive port and wait a user to select an available
  * SSID network and enter the corresponding password. Once that has been
  * done the credentials are stored in the WiFi module and it will be
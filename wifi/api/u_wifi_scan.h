@@ -0,0 +1,281 @@
+/*
+ * Copyright 2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_WIFI_SCAN_H_
+#define _U_WIFI_SCAN_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _wifi
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the background scan service of
+ * the Wi-Fi API.  uWifiStationScan() blocks its caller for the
+ * whole of a scan, which may take several seconds, and each caller
+ * (e.g. roaming logic, Wi-Fi positioning) scans afresh.  The scan
+ * service instead scans in a task of its own, periodically and/or
+ * on demand, and keeps what it finds in a cache keyed by BSSID,
+ * with the time each access point was last seen, a smoothed RSSI
+ * and per-channel statistics; consumers read the cache, saying how
+ * old an entry they are prepared to accept, without touching the
+ * module.  Each result may also be passed to a callback as it
+ * arrives, from a task where other APIs may be called.
+ *
+ * Note that the module will not accept another AT command until
+ * a scan is complete, hence an AT-based API called while a scan
+ * is in progress still waits for the scan to finish; the period
+ * of the service is measured from the end of one scan to the
+ * start of the next so that such calls always get a look-in.
+ *
+ * This header file requires u_wifi.h to be included first.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_WIFI_SCAN_MAX_NUM_ENTRIES
+/** The number of access points the cache of the scan service can
+ * hold per device; when it is full the entry seen longest ago is
+ * replaced.
+ */
+# define U_WIFI_SCAN_MAX_NUM_ENTRIES 32
+#endif
+
+#ifndef U_WIFI_SCAN_EXPIRY_MS
+/** The default time after which an access point that has not been
+ * seen is dropped from the cache, used if zero is given as
+ * expiryMs in #uWifiScanCfg_t.
+ */
+# define U_WIFI_SCAN_EXPIRY_MS 60000
+#endif
+
+#ifndef U_WIFI_SCAN_RSSI_SMOOTHING_PERCENT
+/** The weight, as a percentage, that the scan service gives a new
+ * RSSI reading when smoothing the RSSI of an access point: 100
+ * means no smoothing.
+ */
+# define U_WIFI_SCAN_RSSI_SMOOTHING_PERCENT 25
+#endif
+
+#ifndef U_WIFI_SCAN_TASK_STACK_SIZE_BYTES
+/** The stack size of the task that performs the scans.
+ */
+# define U_WIFI_SCAN_TASK_STACK_SIZE_BYTES 2304
+#endif
+
+#ifndef U_WIFI_SCAN_TASK_PRIORITY
+/** The priority of the task that performs the scans.
+ */
+# define U_WIFI_SCAN_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
+#ifndef U_WIFI_SCAN_CALLBACK_STACK_SIZE_BYTES
+/** The stack size of the task in which the callbacks of the scan
+ * service are called.
+ */
+# define U_WIFI_SCAN_CALLBACK_STACK_SIZE_BYTES 2304
+#endif
+
+#ifndef U_WIFI_SCAN_CALLBACK_PRIORITY
+/** The priority of the task in which the callbacks of the scan
+ * service are called.
+ */
+# define U_WIFI_SCAN_CALLBACK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
+#ifndef U_WIFI_SCAN_CALLBACK_QUEUE_LENGTH
+/** The number of results that may be waiting to be passed to the
+ * result callback; a result arriving when the queue is full is not
+ * passed to the callback (though it is still put in the cache),
+ * rather than holding up the scan.
+ */
+# define U_WIFI_SCAN_CALLBACK_QUEUE_LENGTH 16
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Callback that receives each result of a scan as it arrives.
+ * It is called from a task of the scan service, not while the AT
+ * lock is held, so other APIs may be called from it, though any
+ * that send an AT command will wait until the scan has finished.
+ *
+ * @param devHandle          the handle of the Wi-Fi instance.
+ * @param[in] pResult        the scan result.
+ * @param[in] pCallbackParam the pCallbackParam of #uWifiScanCfg_t.
+ */
+typedef void (*uWifiScanCallback_t) (uDeviceHandle_t devHandle,
+                                     const uWifiScanResult_t *pResult,
+                                     void *pCallbackParam);
+
+/** Callback that is called when a scan has finished, after the
+ * result callback has been called for all of its results.
+ *
+ * @param devHandle          the handle of the Wi-Fi instance.
+ * @param errorCode          zero if the scan was successful, else
+ *                           negative error code.
+ * @param numResults         the number of results of the scan.
+ * @param[in] pCallbackParam the pCallbackParam of #uWifiScanCfg_t.
+ */
+typedef void (*uWifiScanDoneCallback_t) (uDeviceHandle_t devHandle,
+                                         int32_t errorCode,
+                                         int32_t numResults,
+                                         void *pCallbackParam);
+
+/** The configuration of the scan service.
+ */
+typedef struct {
+    int32_t periodMs;         /**< the time from the end of one scan
+                                   to the start of the next; zero to
+                                   scan only when uWifiScanNow() is
+                                   called. */
+    const char *pSsid;        /**< scan for this SSID only, NULL for
+                                   any SSID; the string is copied. */
+    int32_t expiryMs;         /**< drop an access point from the cache
+                                   if it has not been seen for this
+                                   long; zero for
+                                   #U_WIFI_SCAN_EXPIRY_MS. */
+    uWifiScanCallback_t pResultCallback; /**< called for each result
+                                              as it arrives, may be
+                                              NULL. */
+    uWifiScanDoneCallback_t pDoneCallback; /**< called at the end of
+                                                each scan, may be
+                                                NULL. */
+    void *pCallbackParam;     /**< passed to the callbacks. */
+} uWifiScanCfg_t;
+
+/** An access point in the cache of the scan service.
+ */
+typedef struct {
+    uWifiScanResult_t result; /**< the most recent result for the
+                                   access point; result.rssi is the
+                                   RSSI reported in it. */
+    int32_t rssiSmoothedDbm;  /**< the RSSI of the access point,
+                                   smoothed across the scans it has
+                                   been seen in. */
+    int32_t ageMs;            /**< the time since the access point
+                                   was last seen. */
+    int32_t numSightings;     /**< the number of scans the access
+                                   point has been seen in. */
+} uWifiScanEntry_t;
+
+/** Statistics of a Wi-Fi channel, derived from the cache of the
+ * scan service.
+ */
+typedef struct {
+    int32_t channel;          /**< the channel number. */
+    int32_t numAccessPoints;  /**< the number of access points seen
+                                   on the channel. */
+    int32_t strongestRssiDbm; /**< the smoothed RSSI of the strongest
+                                   of them. */
+    int32_t averageRssiDbm;   /**< the average of their smoothed
+                                   RSSIs. */
+} uWifiScanChannelStats_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Start the scan service for a Wi-Fi instance; if periodMs in
+ * pCfg is non-zero the first scan begins straight away.  If the
+ * service is already running for this instance it is stopped,
+ * and its cache emptied, first.  The service must be stopped with
+ * uWifiScanStop() before the instance is closed.
+ *
+ * @param devHandle  the handle of the Wi-Fi instance.
+ * @param[in] pCfg   the configuration; cannot be NULL.
+ * @return           zero on success else negative error code.
+ */
+int32_t uWifiScanStart(uDeviceHandle_t devHandle, const uWifiScanCfg_t *pCfg);
+
+/** Ask the scan service to scan as soon as possible; returns
+ * immediately.  If a scan is in progress another follows it;
+ * requests made while that one is waiting to start are merged
+ * with it.
+ *
+ * @param devHandle  the handle of the Wi-Fi instance.
+ * @return           zero on success else negative error code.
+ */
+int32_t uWifiScanNow(uDeviceHandle_t devHandle);
+
+/** Get the access points in the cache of the scan service, the
+ * strongest (by smoothed RSSI) first.  This does not touch the
+ * module and so returns immediately, even while a scan is in
+ * progress.
+ *
+ * @param devHandle         the handle of the Wi-Fi instance.
+ * @param maxAgeMs          only return access points seen within
+ *                          this time; use a negative value to return
+ *                          everything in the cache.
+ * @param[out] pEntries     a place to put the entries; may be NULL
+ *                          if maxNumEntries is zero, in which case
+ *                          the number that would be returned is
+ *                          still returned.
+ * @param maxNumEntries     the number of entries pEntries can hold.
+ * @return                  on success the number of entries that
+ *                          match maxAgeMs (which may be more than
+ *                          maxNumEntries), else negative error code.
+ */
+int32_t uWifiScanGetResults(uDeviceHandle_t devHandle, int32_t maxAgeMs,
+                            uWifiScanEntry_t *pEntries, size_t maxNumEntries);
+
+/** Get statistics for each channel on which the scan service has
+ * seen access points, in order of channel number.  Like
+ * uWifiScanGetResults(), this returns immediately.
+ *
+ * @param devHandle         the handle of the Wi-Fi instance.
+ * @param maxAgeMs          only count access points seen within
+ *                          this time; use a negative value to count
+ *                          everything in the cache.
+ * @param[out] pStats       a place to put the statistics; may be
+ *                          NULL if maxNumStats is zero.
+ * @param maxNumStats       the number of entries pStats can hold.
+ * @return                  on success the number of channels (which
+ *                          may be more than maxNumStats), else
+ *                          negative error code.
+ */
+int32_t uWifiScanGetChannelStats(uDeviceHandle_t devHandle, int32_t maxAgeMs,
+                                 uWifiScanChannelStats_t *pStats,
+                                 size_t maxNumStats);
+
+/** Stop the scan service for a Wi-Fi instance, waiting for any scan
+ * in progress to finish, and free its cache.  Must not be called
+ * from one of the callbacks of the service.
+ *
+ * @param devHandle  the handle of the Wi-Fi instance.
+ */
+void uWifiScanStop(uDeviceHandle_t devHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_WIFI_SCAN_H_
+
+// End of file
@@ -265,6 +265,22 @@ int32_t uWifiStationConnect(uDeviceHandle_t devHandle, const char *pSsid,
     return errorCode;
 }
 
+int32_t uWifiStationReconnect(uDeviceHandle_t devHandle)
+{
+    (void)devHandle;
+    // The second generation of u-connectExpress keeps the
+    // connection parameters itself: not yet supported here
+    return (int32_t)U_ERROR_COMMON_NOT_IMPLEMENTED;
+}
+
+int32_t uWifiStationGetConnectStats(uDeviceHandle_t devHandle,
+                                    uWifiStationConnectStats_t *pStats)
+{
+    (void)devHandle;
+    (void)pStats;
+    return (int32_t)U_ERROR_COMMON_NOT_IMPLEMENTED;
+}
+
 int32_t uWifiStationDisconnect(uDeviceHandle_t devHandle)
 {
     int32_t errorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
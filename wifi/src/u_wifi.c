@@ -37,6 +37,7 @@
 
 #include "u_error_common.h"
 
+#include "u_port.h"
 #include "u_port_os.h"
 #include "u_port_heap.h"
 #include "u_port_debug.h"
@@ -89,6 +90,20 @@
 //lint -esym(750, LOG_TAG) Suppress LOG_TAG not referenced
 #define LOG_TAG "U_WIFI: "
 
+/** The size of buffer needed to keep a passphrase: up to 63 ASCII
+ * characters or a 64 digit hex PSK, plus a null terminator.
+ */
+#define U_WIFI_STA_PASSPHRASE_SIZE (64 + 1)
+
+/** Bits for the parts of the station configuration that
+ * uWifiStationConnect() writes, see staCfgDiff().
+ */
+#define U_WIFI_STA_CFG_WRITE_INACTIVE_ON_STARTUP (1UL << 0)
+#define U_WIFI_STA_CFG_WRITE_SSID                (1UL << 1)
+#define U_WIFI_STA_CFG_WRITE_AUTHENTICATION      (1UL << 2)
+#define U_WIFI_STA_CFG_WRITE_PASSPHRASE          (1UL << 3)
+#define U_WIFI_STA_CFG_WRITE_ALL                 0x0FUL
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -100,6 +115,7 @@ typedef struct {
     int32_t channel;
     char bssid[U_WIFI_BSSID_SIZE];
     int32_t reason;
+    int32_t timeMs;
 } uWifiConnection_t;
 
 typedef struct {
@@ -115,6 +131,47 @@ typedef enum {
     CFG_ACTION_DEACTIVATE = 4
 } uWifiCfgAction_t;
 
+/** A Wifi station configuration, as written with AT+UWSC; the
+ * passphrase is only relevant if the authentication is not open.
+ */
+typedef struct {
+    bool valid;
+    char ssid[U_WIFI_SSID_SIZE];
+    uWifiAuth_t authentication;
+    char passPhrase[U_WIFI_STA_PASSPHRASE_SIZE];
+} uWifiStaCfg_t;
+
+/** What is known of the station configuration of a module, hung
+ * off pWifiStaContext of the short range instance.
+ */
+typedef struct {
+    uWifiStaCfg_t requested;        /**< the configuration last passed to
+                                         uWifiStationConnect(), for
+                                         uWifiStationReconnect(). */
+    bool requestedIsStored;         /**< true if uWifiStationConnect()
+                                         was last asked to use the stored
+                                         configuration. */
+    uWifiStaCfg_t active;           /**< the configuration in the RAM of
+                                         the module, the one that will
+                                         be activated. */
+    int32_t activeTicksLastRestart; /**< ticksLastRestart of the instance
+                                         when active was set: if the
+                                         module has restarted since then
+                                         active is no longer valid. */
+    uWifiStaCfg_t stored;           /**< the configuration in the
+                                         persistent memory of the module,
+                                         the one CFG_ACTION_LOAD loads. */
+    uWifiStationConnectStats_t stats;
+    int32_t connectStartTimeMs;     /**< when uWifiStationConnect() last
+                                         activated the station, -1 once
+                                         connected. */
+    int32_t disconnectTimeMs;       /**< when the connection was lost,
+                                         -1 once connected again. */
+    bool disconnectRequested;       /**< true if the next disconnection
+                                         is at the request of
+                                         uWifiStationDisconnect(). */
+} uWifiStaContext_t;
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
@@ -163,36 +220,6 @@ static int32_t readWifiStaConfigString(uAtClientHandle_t atHandle,
     return retValue;
 }
 
-/** Helper function for writing a Wifi station config integer value */
-static int32_t writeWifiStaCfgInt(uAtClientHandle_t atHandle,
-                                  int32_t cfgId,
-                                  int32_t tag,
-                                  int32_t value)
-{
-    uAtClientLock(atHandle);
-    uAtClientCommandStart(atHandle, "AT+UWSC=");
-    uAtClientWriteInt(atHandle, cfgId);
-    uAtClientWriteInt(atHandle, tag);
-    uAtClientWriteInt(atHandle, value);
-    uAtClientCommandStopReadResponse(atHandle);
-    return uAtClientUnlock(atHandle);
-}
-
-/** Helper function for writing a Wifi station config string value */
-static int32_t writeWifiStaCfgStr(uAtClientHandle_t atHandle,
-                                  int32_t cfgId,
-                                  int32_t tag,
-                                  const char *pValue)
-{
-    uAtClientLock(atHandle);
-    uAtClientCommandStart(atHandle, "AT+UWSC=");
-    uAtClientWriteInt(atHandle, cfgId);
-    uAtClientWriteInt(atHandle, tag);
-    uAtClientWriteString(atHandle, pValue, true);
-    uAtClientCommandStopReadResponse(atHandle);
-    return uAtClientUnlock(atHandle);
-}
-
 /** Helper function for reading a Wifi station status string value */
 static int32_t readWifiStaStatusString(uAtClientHandle_t atHandle,
                                        int32_t statusId,
@@ -400,12 +427,38 @@ static void wifiConnectCallback(uAtClientHandle_t atHandle,
     }
 
     if (uShortRangeLock() == (int32_t)U_ERROR_COMMON_SUCCESS) {
-        const uShortRangePrivateInstance_t *pInstance;
+        uShortRangePrivateInstance_t *pInstance;
+        uWifiStaContext_t *pContext = NULL;
         pInstance = pUShortRangePrivateGetInstance(pStatus->devHandle);
+        if (pInstance) {
+            pContext = (uWifiStaContext_t *) pInstance->pWifiStaContext;
+        }
         if (pInstance && pInstance->pWifiConnectionStatusCallback) {
             pCallback = pInstance->pWifiConnectionStatusCallback;
             pCallbackParam = pInstance->pWifiConnectionStatusCallbackParameter;
         }
+        if (pContext != NULL) {
+            // Keep the connection timing
+            if (pStatus->status == U_WIFI_CON_STATUS_CONNECTED) {
+                if (pContext->connectStartTimeMs >= 0) {
+                    pContext->stats.connectToConnectedMs = pStatus->timeMs -
+                                                           pContext->connectStartTimeMs;
+                    pContext->connectStartTimeMs = -1;
+                }
+                if (pContext->disconnectTimeMs >= 0) {
+                    pContext->stats.disconnectToConnectedMs = pStatus->timeMs -
+                                                              pContext->disconnectTimeMs;
+                    pContext->disconnectTimeMs = -1;
+                }
+            } else if (pContext->disconnectRequested) {
+                pContext->disconnectRequested = false;
+                pContext->disconnectTimeMs = -1;
+            } else if (pContext->disconnectTimeMs < 0) {
+                // From the first of what may be several
+                // disconnections while trying to connect again
+                pContext->disconnectTimeMs = pStatus->timeMs;
+            }
+        }
 
         uShortRangeUnlock();
 
@@ -446,8 +499,10 @@ static void UUWLE_urc(uAtClientHandle_t atHandle,
         pStatus->channel = channel;
         memcpy(pStatus->bssid, bssid, U_WIFI_BSSID_SIZE);
         pStatus->reason = 0;
+        pStatus->timeMs = uPortGetTickTimeMs();
         //lint -e(1773) Suppress attempt to cast away volatile
-        if (uAtClientCallback(atHandle, wifiConnectCallback, pStatus) < 0) {
+        if (uAtClientCallbackPriority(atHandle, U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                                      wifiConnectCallback, pStatus) < 0) {
             uPortFree(pStatus);
         }
     }
@@ -473,7 +528,9 @@ static void UUWLD_urc(uAtClientHandle_t atHandle,
         pStatus->channel = 0;
         pStatus->bssid[0] = '\0';
         pStatus->reason = reason;
-        if (uAtClientCallback(atHandle, wifiConnectCallback, pStatus) < 0) {
+        pStatus->timeMs = uPortGetTickTimeMs();
+        if (uAtClientCallbackPriority(atHandle, U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                                      wifiConnectCallback, pStatus) < 0) {
             uPortFree(pStatus);
         }
     }
@@ -559,7 +616,8 @@ static void UUNU_urc(uAtClientHandle_t atHandle,
         if (pEvt != NULL) {
             pEvt->devHandle = (uDeviceHandle_t)pParameter;
             pEvt->interfaceId = interfaceId;
-            if (uAtClientCallback(atHandle, networkStatusCallback, pEvt) < 0) {
+            if (uAtClientCallbackPriority(atHandle, U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                                          networkStatusCallback, pEvt) < 0) {
                 uPortFree(pEvt);
             }
         }
@@ -577,13 +635,332 @@ static void UUND_urc(uAtClientHandle_t atHandle,
         if (pEvt != NULL) {
             pEvt->devHandle = (uDeviceHandle_t)pParameter;
             pEvt->interfaceId = interfaceId;
-            if (uAtClientCallback(atHandle, networkStatusCallback, pEvt) < 0) {
+            if (uAtClientCallbackPriority(atHandle, U_AT_CLIENT_CALLBACK_PRIORITY_HIGH,
+                                          networkStatusCallback, pEvt) < 0) {
                 uPortFree(pEvt);
             }
         }
     }
 }
 
+// Get what is known of the station configuration of a module,
+// creating the context if required; the active configuration is
+// forgotten if the module has restarted.
+static uWifiStaContext_t *pStaContextGet(uShortRangePrivateInstance_t *pInstance,
+                                         bool create)
+{
+    uWifiStaContext_t *pContext = (uWifiStaContext_t *) pInstance->pWifiStaContext;
+
+    if ((pContext == NULL) && create) {
+        pContext = (uWifiStaContext_t *) pUPortMalloc(sizeof(*pContext));
+        if (pContext != NULL) {
+            memset(pContext, 0, sizeof(*pContext));
+            pContext->activeTicksLastRestart = pInstance->ticksLastRestart;
+            pContext->stats.connectToConnectedMs = -1;
+            pContext->stats.disconnectToConnectedMs = -1;
+            pContext->connectStartTimeMs = -1;
+            pContext->disconnectTimeMs = -1;
+            pInstance->pWifiStaContext = pContext;
+        }
+    }
+    if ((pContext != NULL) &&
+        (pContext->activeTicksLastRestart != pInstance->ticksLastRestart)) {
+        pContext->active.valid = false;
+        pContext->activeTicksLastRestart = pInstance->ticksLastRestart;
+    }
+
+    return pContext;
+}
+
+// Fill in a station configuration, returning its validity: it is
+// not valid if there is no SSID or if something doesn't fit.
+static bool staCfgSet(uWifiStaCfg_t *pCfg, const char *pSsid,
+                      uWifiAuth_t authentication, const char *pPassPhrase)
+{
+    memset(pCfg, 0, sizeof(*pCfg));
+    pCfg->authentication = authentication;
+    if ((pSsid != NULL) && (strlen(pSsid) < sizeof(pCfg->ssid))) {
+        strncpy(pCfg->ssid, pSsid, sizeof(pCfg->ssid));
+        pCfg->valid = true;
+        if (authentication != U_WIFI_AUTH_OPEN) {
+            pCfg->valid = (pPassPhrase != NULL) &&
+                          (strlen(pPassPhrase) < sizeof(pCfg->passPhrase));
+            if (pCfg->valid) {
+                strncpy(pCfg->passPhrase, pPassPhrase, sizeof(pCfg->passPhrase));
+            }
+        }
+    }
+
+    return pCfg->valid;
+}
+
+// Work out which parts of the station configuration have to be
+// written to get from pFrom to pTo: all of them unless both are valid.
+static uint32_t staCfgDiff(const uWifiStaCfg_t *pFrom, const uWifiStaCfg_t *pTo)
+{
+    uint32_t writeBitmap = U_WIFI_STA_CFG_WRITE_ALL;
+
+    if (pFrom->valid && pTo->valid) {
+        // Anything valid has been written by uWifiStationConnect(),
+        // which always writes the "inactive on start-up" tag
+        writeBitmap = 0;
+        if (strcmp(pFrom->ssid, pTo->ssid) != 0) {
+            writeBitmap |= U_WIFI_STA_CFG_WRITE_SSID;
+        }
+        if (pFrom->authentication != pTo->authentication) {
+            writeBitmap |= U_WIFI_STA_CFG_WRITE_AUTHENTICATION;
+        }
+        if ((pTo->authentication != U_WIFI_AUTH_OPEN) &&
+            ((pFrom->authentication == U_WIFI_AUTH_OPEN) ||
+             (strcmp(pFrom->passPhrase, pTo->passPhrase) != 0))) {
+            writeBitmap |= U_WIFI_STA_CFG_WRITE_PASSPHRASE;
+        }
+    }
+    if (pTo->authentication == U_WIFI_AUTH_OPEN) {
+        writeBitmap &= ~U_WIFI_STA_CFG_WRITE_PASSPHRASE;
+    }
+
+    return writeBitmap;
+}
+
+// Count the bits set in a bitmap.
+static int32_t numBitsSet(uint32_t bitmap)
+{
+    int32_t numBits = 0;
+
+    for (; bitmap != 0; bitmap &= bitmap - 1) {
+        numBits++;
+    }
+
+    return numBits;
+}
+
+// End an AT command that configures the station: if the commands
+// are pipelined the response is collected later by
+// staResponsesGet(), otherwise it is read now.
+static void staCommandStop(uAtClientHandle_t atHandle)
+{
+    if (U_WIFI_STATION_CONFIG_PIPELINE) {
+        uAtClientCommandStop(atHandle);
+    } else {
+        uAtClientCommandStopReadResponse(atHandle);
+    }
+}
+
+// Collect the responses to numCommands station configuration
+// commands ended with staCommandStop(), returning the first error.
+// This must be called with the AT client locked.
+static int32_t staResponsesGet(uAtClientHandle_t atHandle, int32_t numCommands)
+{
+    int32_t errorCode = uAtClientErrorGet(atHandle);
+    int32_t responseErrorCode;
+    uAtClientDeviceError_t deviceError;
+
+    if (U_WIFI_STATION_CONFIG_PIPELINE && (errorCode == 0)) {
+        // The module has all of the commands by now so every one
+        // of them gets a response, which must be read whether it
+        // is OK or ERROR, else it would be taken as the response
+        // to a later command; only if there is no response at all
+        // is it pointless to wait for the rest
+        for (int32_t x = 0; x < numCommands; x++) {
+            uAtClientResponseStart(atHandle, NULL);
+            uAtClientResponseStop(atHandle);
+            responseErrorCode = uAtClientErrorGet(atHandle);
+            if (responseErrorCode != 0) {
+                uAtClientDeviceErrorGet(atHandle, &deviceError);
+                if (errorCode == 0) {
+                    errorCode = responseErrorCode;
+                }
+                uAtClientClearError(atHandle);
+                if (deviceError.type == U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR) {
+                    uAtClientFlush(atHandle);
+                    break;
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Write the parts of the station configuration given by writeBitmap
+// and/or load the stored configuration, returning the number of AT
+// commands sent in *pNumCommands.
+static int32_t staCfgWrite(uAtClientHandle_t atHandle, bool load,
+                           uint32_t writeBitmap, const char *pSsid,
+                           uWifiAuth_t authentication, const char *pPassPhrase,
+                           int32_t *pNumCommands)
+{
+    int32_t errorCode;
+    int32_t numCommands = 0;
+    int32_t x;
+
+    uAtClientLock(atHandle);
+    if (load) {
+        uAtClientCommandStart(atHandle, "AT+UWSCA=");
+        uAtClientWriteInt(atHandle, 0);
+        uAtClientWriteInt(atHandle, (int32_t) CFG_ACTION_LOAD);
+        staCommandStop(atHandle);
+        numCommands++;
+    }
+    if (writeBitmap & U_WIFI_STA_CFG_WRITE_INACTIVE_ON_STARTUP) {
+        // Set Wifi STA inactive on start up
+        uAtClientCommandStart(atHandle, "AT+UWSC=");
+        uAtClientWriteInt(atHandle, 0);
+        uAtClientWriteInt(atHandle, 0);
+        uAtClientWriteInt(atHandle, 0);
+        staCommandStop(atHandle);
+        numCommands++;
+    }
+    if (writeBitmap & U_WIFI_STA_CFG_WRITE_SSID) {
+        uAtClientCommandStart(atHandle, "AT+UWSC=");
+        uAtClientWriteInt(atHandle, 0);
+        uAtClientWriteInt(atHandle, 2);
+        uAtClientWriteString(atHandle, pSsid, true);
+        staCommandStop(atHandle);
+        numCommands++;
+    }
+    if (writeBitmap & U_WIFI_STA_CFG_WRITE_AUTHENTICATION) {
+        uAtClientCommandStart(atHandle, "AT+UWSC=");
+        uAtClientWriteInt(atHandle, 0);
+        uAtClientWriteInt(atHandle, 5);
+        uAtClientWriteInt(atHandle, (int32_t) authentication);
+        staCommandStop(atHandle);
+        numCommands++;
+    }
+    if (writeBitmap & U_WIFI_STA_CFG_WRITE_PASSPHRASE) {
+        // Set PSK/passphrase
+        uAtClientCommandStart(atHandle, "AT+UWSC=");
+        uAtClientWriteInt(atHandle, 0);
+        uAtClientWriteInt(atHandle, 8);
+        uAtClientWriteString(atHandle, pPassPhrase, true);
+        staCommandStop(atHandle);
+        numCommands++;
+    }
+    errorCode = staResponsesGet(atHandle, numCommands);
+    x = uAtClientUnlock(atHandle);
+    if (errorCode == 0) {
+        errorCode = x;
+    }
+    *pNumCommands += numCommands;
+
+    return errorCode;
+}
+
+// Connect a Wifi station; this must be called with the short range
+// API locked.  pSsid may be NULL to use the stored configuration.
+static int32_t stationConnect(uShortRangePrivateInstance_t *pInstance,
+                              const char *pSsid, uWifiAuth_t authentication,
+                              const char *pPassPhrase)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    uWifiStaContext_t *pContext = pStaContextGet(pInstance, true);
+    uWifiStaCfg_t cfg = {0};
+    uint32_t writeBitmap = U_WIFI_STA_CFG_WRITE_ALL;
+    bool load = false;
+    int32_t numCommands = 0;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+    int32_t x;
+
+    // Read connection status
+    int32_t conStatus = readWifiStaStatusInt(atHandle, 3);
+    numCommands++;
+    if (conStatus == 2) {
+        // Wifi already connected. Check if the SSID is the same
+        char ssid[32 + 1];
+        errorCode = (int32_t) U_WIFI_ERROR_ALREADY_CONNECTED;
+        int32_t tmp = readWifiStaStatusString(atHandle, 0, ssid, sizeof(ssid));
+        numCommands++;
+        if (tmp >= 0) {
+            // Always accept the current connection if no SSID specified
+            if ((pSsid == NULL) || (strcmp(ssid, pSsid) == 0)) {
+                errorCode = (int32_t) U_WIFI_ERROR_ALREADY_CONNECTED_TO_SSID;
+            }
+        }
+    }
+
+    // Configure Wifi, writing only what the module doesn't
+    // already have
+    if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+        uPortLog(LOG_TAG "Activating wifi STA mode\n");
+        if (pSsid == NULL) {
+            load = true;
+            writeBitmap = 0;
+            if (pContext != NULL) {
+                cfg = pContext->stored;
+            }
+        } else if (staCfgSet(&cfg, pSsid, authentication, pPassPhrase) &&
+                   (pContext != NULL)) {
+            writeBitmap = staCfgDiff(&(pContext->active), &cfg);
+            if ((numBitsSet(writeBitmap) > 1) &&
+                (staCfgDiff(&(pContext->stored), &cfg) == 0)) {
+                // Quicker to load the stored configuration
+                load = true;
+                writeBitmap = 0;
+            }
+        }
+        if (pContext != NULL) {
+            // Until we know otherwise
+            pContext->active.valid = false;
+        }
+        if (load || (writeBitmap != 0)) {
+            errorCode = staCfgWrite(atHandle, load, writeBitmap, pSsid,
+                                    authentication, pPassPhrase, &numCommands);
+        }
+        if (pContext != NULL) {
+            pContext->requestedIsStored = (pSsid == NULL);
+            if (pSsid != NULL) {
+                pContext->requested = cfg;
+            }
+            if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+                pContext->active = cfg;
+            }
+        }
+    }
+    if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+        // Activate wifi
+        x = uPortGetTickTimeMs();
+        errorCode = writeWifiStaCfgAction(atHandle, 0, CFG_ACTION_ACTIVATE);
+        numCommands++;
+        if (pContext != NULL) {
+            pContext->connectStartTimeMs = x;
+        }
+    }
+    if (pContext != NULL) {
+        pContext->stats.numAtCommands = numCommands;
+        pContext->stats.commandTimeMs = uPortGetTickTimeMs() - startTimeMs;
+    }
+    // For security
+    memset(&cfg, 0, sizeof(cfg));
+
+    return errorCode;
+}
+
+// Update what is known of the station configuration of a module
+// after a successful configuration action.
+static void staCfgActionDone(uShortRangePrivateInstance_t *pInstance,
+                             uWifiCfgAction_t action)
+{
+    uWifiStaContext_t *pContext = pStaContextGet(pInstance, false);
+
+    if (pContext != NULL) {
+        switch (action) {
+            case CFG_ACTION_RESET:
+                pContext->active.valid = false;
+                break;
+            case CFG_ACTION_STORE:
+                pContext->stored = pContext->active;
+                break;
+            case CFG_ACTION_LOAD:
+                pContext->active = pContext->stored;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
 static int32_t StaCfgAction(uDeviceHandle_t devHandle, int32_t op)
 {
     int32_t errorCode;
@@ -597,6 +974,9 @@ static int32_t StaCfgAction(uDeviceHandle_t devHandle, int32_t op)
     if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
         uAtClientHandle_t atHandle = pInstance->atHandle;
         errorCode = writeWifiStaCfgAction(atHandle, 0, op);
+        if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            staCfgActionDone(pInstance, (uWifiCfgAction_t) op);
+        }
     }
     uShortRangeUnlock();
     return errorCode;
@@ -730,49 +1110,73 @@ int32_t uWifiStationConnect(uDeviceHandle_t devHandle, const char *pSsid,
 
     errorCode = getInstance(devHandle, &pInstance);
     if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-        uAtClientHandle_t atHandle = pInstance->atHandle;
+        errorCode = stationConnect(pInstance, pSsid, authentication, pPassPhrase);
+    }
 
-        // Read connection status
-        int32_t conStatus = readWifiStaStatusInt(atHandle, 3);
-        if (conStatus == 2) {
-            // Wifi already connected. Check if the SSID is the same
-            char ssid[32 + 1];
-            errorCode = (int32_t) U_WIFI_ERROR_ALREADY_CONNECTED;
-            int32_t tmp = readWifiStaStatusString(atHandle, 0, ssid, sizeof(ssid));
-            if (tmp >= 0) {
-                // Always accept the current connection if no SSID specified
-                if ((pSsid == NULL) || (strcmp(ssid, pSsid) == 0)) {
-                    errorCode = (int32_t) U_WIFI_ERROR_ALREADY_CONNECTED_TO_SSID;
-                }
-            }
-        }
+    uShortRangeUnlock();
 
-        // Configure Wifi
-        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-            // Set Wifi STA inactive on start up
-            uPortLog(LOG_TAG "Activating wifi STA mode\n");
-            errorCode = writeWifiStaCfgInt(atHandle, 0, 0, 0);
-        }
-        if ((pSsid == NULL) && (conStatus != 2)) {
-            errorCode = writeWifiStaCfgAction(atHandle, 0, CFG_ACTION_LOAD);
-        } else {
-            if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-                // Set SSID
-                errorCode = writeWifiStaCfgStr(atHandle, 0, 2, pSsid);
-            }
-            if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-                // Set authentication
-                errorCode = writeWifiStaCfgInt(atHandle, 0, 5, (int32_t)authentication);
-            }
-            if ((errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) &&
-                (authentication != U_WIFI_AUTH_OPEN)) {
-                // Set PSK/passphrase
-                errorCode = writeWifiStaCfgStr(atHandle, 0, 8, pPassPhrase);
+    return errorCode;
+}
+
+int32_t uWifiStationReconnect(uDeviceHandle_t devHandle)
+{
+    int32_t errorCode;
+    uShortRangePrivateInstance_t *pInstance;
+    const uWifiStaContext_t *pContext;
+    uWifiStaCfg_t cfg;
+
+    errorCode = uShortRangeLock();
+    if (errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) {
+        return errorCode;
+    }
+
+    errorCode = getInstance(devHandle, &pInstance);
+    if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+        errorCode = (int32_t) U_WIFI_ERROR_NOT_CONFIGURED;
+        pContext = pStaContextGet(pInstance, false);
+        if (pContext != NULL) {
+            if (pContext->requestedIsStored) {
+                errorCode = stationConnect(pInstance, NULL, U_WIFI_AUTH_OPEN, NULL);
+            } else if (pContext->requested.valid) {
+                // Take a copy as stationConnect() will update requested
+                cfg = pContext->requested;
+                errorCode = stationConnect(pInstance, cfg.ssid, cfg.authentication,
+                                           cfg.passPhrase);
+                // For security
+                memset(&cfg, 0, sizeof(cfg));
             }
         }
-        if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-            // Activate wifi
-            errorCode = writeWifiStaCfgAction(atHandle, 0, CFG_ACTION_ACTIVATE);
+    }
+
+    uShortRangeUnlock();
+
+    return errorCode;
+}
+
+int32_t uWifiStationGetConnectStats(uDeviceHandle_t devHandle,
+                                    uWifiStationConnectStats_t *pStats)
+{
+    int32_t errorCode;
+    uShortRangePrivateInstance_t *pInstance;
+    const uWifiStaContext_t *pContext;
+
+    if (pStats == NULL) {
+        return (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    errorCode = uShortRangeLock();
+    if (errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) {
+        return errorCode;
+    }
+
+    errorCode = getInstance(devHandle, &pInstance);
+    if (errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+        memset(pStats, 0, sizeof(*pStats));
+        pStats->connectToConnectedMs = -1;
+        pStats->disconnectToConnectedMs = -1;
+        pContext = pStaContextGet(pInstance, false);
+        if (pContext != NULL) {
+            *pStats = pContext->stats;
         }
     }
 
@@ -797,8 +1201,17 @@ int32_t uWifiStationDisconnect(uDeviceHandle_t devHandle)
         // Read connection status
         int32_t conStatus = readWifiStaStatusInt(atHandle, 3);
         if (conStatus != 0) {
+            uWifiStaContext_t *pContext = pStaContextGet(pInstance, false);
             uPortLog(LOG_TAG "De-activating wifi STA mode\n");
+            if (pContext != NULL) {
+                // So that this doesn't count as losing the connection
+                pContext->disconnectRequested = true;
+                pContext->connectStartTimeMs = -1;
+            }
             errorCode = writeWifiStaCfgAction(atHandle, 0, CFG_ACTION_DEACTIVATE);
+            if ((pContext != NULL) && (errorCode != (int32_t) U_ERROR_COMMON_SUCCESS)) {
+                pContext->disconnectRequested = false;
+            }
         } else {
             // Wifi is already disabled
             errorCode = (int32_t) U_WIFI_ERROR_ALREADY_DISCONNECTED;
@@ -862,6 +1275,7 @@ bool uWifiStationHasStoredConfig(uDeviceHandle_t devHandle)
         uAtClientHandle_t atHandle = pInstance->atHandle;
         errorCode = writeWifiStaCfgAction(atHandle, 0, CFG_ACTION_LOAD);
         if (errorCode == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            staCfgActionDone(pInstance, CFG_ACTION_LOAD);
             char ssid[U_WIFI_SSID_SIZE] = {0};
             readWifiStaConfigString(atHandle, 0, 2, ssid, sizeof(ssid));
             has = ssid[0] != 0;
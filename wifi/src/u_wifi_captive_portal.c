@@ -34,12 +34,14 @@
 #include "string.h"
 #include "stdio.h"
 #include "limits.h"
+#include "errno.h"
 
 #include "u_error_common.h"
 
 #include "u_assert.h"
 
 #include "u_port_os.h"
+#include "u_port_heap.h"
 #include "u_cfg_sw.h"
 #include "u_port_debug.h"
 #include "u_cfg_os_platform_specific.h"
@@ -60,6 +62,7 @@
 #include "u_dns_server.h"
 
 #include "u_wifi_captive_portal.h"
+#include "u_wifi_captive_portal_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -67,14 +70,36 @@
 
 #define LOG_PREFIX "U_WIFI_CAPTIVE_PORTAL: "
 
-#ifndef U_WIFI_CAPTIVE_PORTAL_CLIENT_SOCKET_READ_DELAY_MS
-/** When waiting for a client that has connected to us, wait for
- * this many milliseconds while going around a loop reading
- * from it to make sure that we have really read everything that
- * it has sent to us.
+/** The number of built-in routes, see gBuiltInRoutes.
  */
-# define U_WIFI_CAPTIVE_PORTAL_CLIENT_SOCKET_READ_DELAY_MS 100
-#endif
+#define U_WIFI_CAPTIVE_PORTAL_NUM_BUILT_IN_ROUTES 4
+
+/** The number of connections whose data callbacks are tracked by
+ * the socket glue: the ones the HTTP engine serves plus one that
+ * it is turning away.
+ */
+#define U_WIFI_CAPTIVE_PORTAL_NUM_SOCKETS (U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS + 1)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A connection accepted by the socket glue, used to remember
+ * whether the socket has indicated data since it was last read.
+ */
+typedef struct {
+    int32_t sock; /**< the uSock descriptor, -1 if the entry is free. */
+    volatile bool dataPending; /**< set by the data/closed callback. */
+    void (*pCallback)(void *); /**< the wake-up callback of the engine. */
+    void *pCallbackParam; /**< the parameter for pCallback. */
+} uWifiCaptivePortalSock_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * ------------------------------------------------------------- */
+
+// Special for now, non exposed global for accept timeouts, see u_wifi_sock.c
+extern int32_t gUWifiSocketAcceptTimeoutS;
 
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
@@ -173,11 +198,18 @@ static const char gIndexPage[] =
 static char gSsidList[1024];
 static uDeviceHandle_t gDevHandle;
 static bool gKeepGoing = false;
+// The keep-going callback of the user
+static uWifiCaptivePortalKeepGoingCallback_t gCb = NULL;
+// Routes added by the user
+static const uWifiCaptivePortalHttpRoute_t *gpUserRoutes = NULL;
+static size_t gNumUserRoutes = 0;
 // Selected credentials
 static char gSsid[U_WIFI_SSID_SIZE];
 static char gPw[100] = {0};
 // Network configuration
 static uNetworkCfgWifi_t gNetworkCfg = {0};
+// The connections accepted by the socket glue
+static uWifiCaptivePortalSock_t gSockList[U_WIFI_CAPTIVE_PORTAL_NUM_SOCKETS];
 
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
@@ -198,35 +230,6 @@ static void scanCallback(uDeviceHandle_t devHandle, uWifiScanResult_t *pResult)
     }
 }
 
-// Send corresponding html header
-static void sendHeader(int32_t sock, const char *code,
-                       const char *type, size_t length)
-{
-    static char header[255];
-    snprintf(header, sizeof(header),
-             "HTTP/1.0 %s\r\n"
-             "Server: ubxlib\r\n"
-             "Content-type: %s\r\n"
-             "Content-Length: %d\r\n"
-             "Cache-Control: no-store, no-cache, must-revalidate\r\n"
-             "\r\n",
-             code, type, (int)length);
-    uSockWrite(sock, header, strlen(header));
-}
-
-// Send the gathered SSID list
-static void sendSsidList(int32_t sock)
-{
-    strcpy(gSsidList, "{\"SSIDList\":[");
-    uWifiStationScan(gDevHandle, NULL, scanCallback);
-    if (gSsidList[strlen(gSsidList) - 1] == ',') {
-        gSsidList[strlen(gSsidList) - 1] = 0;
-    }
-    strcat(gSsidList, "]}");
-    sendHeader(sock, "200 OK", "text/json", strlen(gSsidList));
-    uSockWrite(sock, gSsidList, strlen(gSsidList));
-}
-
 // Get a json string value, assume quoted name and value,
 // and handle escaped quotes as well.
 static void getVal(const char *txt,
@@ -254,63 +257,222 @@ static void getVal(const char *txt,
     }
 }
 
-// Set the user entered credentials
-static void updateWifi(int32_t sock, const char *params)
+// Route handler: scan and return the list of SSIDs as json.
+static int32_t handleGetSsidList(const uWifiCaptivePortalHttpRequest_t *pRequest,
+                                 char *pBody, size_t bodySize,
+                                 size_t *pBodyLength,
+                                 const char **ppContentType,
+                                 void *pParam)
 {
-    getVal(params, "ssid", gSsid, sizeof(gSsid));
-    getVal(params, "pw", gPw, sizeof(gPw));
-    sendHeader(sock, "200 OK", "text/html", 0);
+    (void) pRequest;
+    (void) ppContentType;
+    (void) pParam;
+    strcpy(gSsidList, "{\"SSIDList\":[");
+    uWifiStationScan(gDevHandle, NULL, scanCallback);
+    if (gSsidList[strlen(gSsidList) - 1] == ',') {
+        gSsidList[strlen(gSsidList) - 1] = 0;
+    }
+    strcat(gSsidList, "]}");
+    *pBodyLength = snprintf(pBody, bodySize, "%s", gSsidList);
+    return 200;
+}
+
+// Route handler: set the user entered credentials.
+static int32_t handleSetWifi(const uWifiCaptivePortalHttpRequest_t *pRequest,
+                             char *pBody, size_t bodySize,
+                             size_t *pBodyLength,
+                             const char **ppContentType,
+                             void *pParam)
+{
+    (void) pBody;
+    (void) bodySize;
+    (void) pBodyLength;
+    (void) ppContentType;
+    (void) pParam;
+    getVal(pRequest->pBody, "ssid", gSsid, sizeof(gSsid));
+    getVal(pRequest->pBody, "pw", gPw, sizeof(gPw));
     gKeepGoing = false;
+    return 200;
+}
+
+// Route handler: not found.
+static int32_t handleNotFound(const uWifiCaptivePortalHttpRequest_t *pRequest,
+                              char *pBody, size_t bodySize,
+                              size_t *pBodyLength,
+                              const char **ppContentType,
+                              void *pParam)
+{
+    (void) pRequest;
+    (void) pBody;
+    (void) bodySize;
+    (void) pBodyLength;
+    (void) ppContentType;
+    (void) pParam;
+    return 404;
 }
 
-// Handle incoming web server requests
-static void handleRequest(const char *request, int32_t sock)
+// The routes served by the captive portal after any of the user.
+static const uWifiCaptivePortalHttpRoute_t
+gBuiltInRoutes[U_WIFI_CAPTIVE_PORTAL_NUM_BUILT_IN_ROUTES] = {
+    {.pMethod = "GET", .pPath = "/get_ssid_list", .pContentType = "text/json",
+     .pHandler = handleGetSsidList},
+    {.pMethod = "POST", .pPath = "/set_wifi", .pContentType = "text/html",
+     .pHandler = handleSetWifi},
+    // Chrome will request this but none available here
+    {.pMethod = "GET", .pPath = "/favicon.ico", .pHandler = handleNotFound},
+    // Any other request just gets the main page
+    {.pMethod = "GET", .pPath = "*", .pContentType = "text/html",
+     .pContent = gIndexPage, .contentLength = sizeof(gIndexPage) - 1}
+};
+
+// Callback controlling whether the HTTP server should continue or not
+static bool httpKeepGoingCallback(uDeviceHandle_t deviceHandle)
 {
-    char method[15];
-    char url[25];
-    size_t pos = 0;
-    while ((pos < (sizeof(method) - 1)) && (*request != ' ')) {
-        method[pos++] = *(request++);
+    if (gKeepGoing && (gCb != NULL) && !gCb(deviceHandle)) {
+        gKeepGoing = false;
     }
-    method[pos] = 0;
-    bool ok = *request == ' ';
-    if (ok) {
-        while (*request == ' ') {
-            request++;
-        }
-        pos = 0;
-        while ((pos < (sizeof(url) - 1)) && *request && (*request != ' ')) {
-            url[pos++] = *(request++);
+    return gKeepGoing;
+}
+
+// Listen on a uSock socket; pContext is the device handle.
+static int32_t sockListen(void *pContext, uint16_t port, size_t backlog,
+                          void (*pCallback)(void *), void *pCallbackParam)
+{
+    uSockAddress_t localAddr;
+    int32_t sock = uSockCreate((uDeviceHandle_t) pContext,
+                               U_SOCK_TYPE_STREAM,
+                               U_SOCK_PROTOCOL_TCP);
+    (void) pCallback;
+    (void) pCallbackParam;
+    if (sock >= 0) {
+        memset(&localAddr, 0, sizeof(localAddr));
+        localAddr.port = port;
+        uSockBind(sock, &localAddr);
+        uSockListen(sock, backlog);
+        // There is no callback for a new connection: accept
+        // is polled and must not wait
+        gUWifiSocketAcceptTimeoutS = 0;
+    }
+    return sock;
+}
+
+// Find the entry in gSockList for a uSock descriptor, use -1
+// to find a free entry.
+static uWifiCaptivePortalSock_t *pSockFind(int32_t sock)
+{
+    for (size_t x = 0; x < sizeof(gSockList) / sizeof(gSockList[0]); x++) {
+        if (gSockList[x].sock == sock) {
+            return &(gSockList[x]);
         }
-        url[pos] = 0;
-        uPortLog(LOG_PREFIX "Requested url \"%s\"\n", url);
-        if (strcmp(method, "GET") == 0) {
-            if (strstr(url, "/get_ssid_list")) {
-                sendSsidList(sock);
-            } else if (strstr(url, "/favicon.ico")) {
-                // Chrome will request this but none available here
-                ok = false;
-            } else {
-                // Any other request else just gets the main page
-                const char *p = gIndexPage;
-                size_t len = strlen(p);
-                sendHeader(sock, "200 OK", "text/html", len);
-                uSockWrite(sock, p, len);
-            }
-        } else if (strcmp(method, "POST") == 0) {
-            if (strstr(url, "/set_wifi")) {
-                updateWifi(sock, request);
-            }
+    }
+    return NULL;
+}
+
+// Data or closed callback for an accepted uSock socket: note that
+// there is something to read and wake the HTTP engine.
+static void sockCallback(void *pParameter)
+{
+    uWifiCaptivePortalSock_t *pEntry = (uWifiCaptivePortalSock_t *) pParameter;
+
+    pEntry->dataPending = true;
+    pEntry->pCallback(pEntry->pCallbackParam);
+}
+
+// Accept a connection on a uSock socket.
+static int32_t sockAccept(void *pContext, int32_t listenHandle,
+                          void (*pCallback)(void *), void *pCallbackParam)
+{
+    uSockAddress_t remoteAddr;
+    char addrStr[U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES];
+    uWifiCaptivePortalSock_t *pEntry;
+    int32_t sock = uSockAccept(listenHandle, &remoteAddr);
+    (void) pContext;
+    if (sock >= 0) {
+        uSockBlockingSet(sock, false);
+        pEntry = pSockFind(-1);
+        if (pEntry != NULL) {
+            // Data may already be waiting
+            pEntry->dataPending = true;
+            pEntry->pCallback = pCallback;
+            pEntry->pCallbackParam = pCallbackParam;
+            pEntry->sock = sock;
+            uSockRegisterCallbackData(sock, sockCallback, pEntry);
+            uSockRegisterCallbackClosed(sock, sockCallback, pEntry);
         } else {
-            // Unsupported method type
-            ok = false;
+            uSockRegisterCallbackData(sock, pCallback, pCallbackParam);
+            uSockRegisterCallbackClosed(sock, pCallback, pCallbackParam);
         }
+        uSockIpAddressToString(&(remoteAddr.ipAddress), addrStr, sizeof(addrStr));
+        uPortLog(LOG_PREFIX "Connected to: %s\n", addrStr);
     }
-    if (!ok) {
-        sendHeader(sock, "404 Not Found", "text/html", 0);
+    return sock;
+}
+
+// Read from a uSock socket.  A non-blocking uSockRead() with
+// nothing to read still waits for U_SOCK_RECEIVE_POLL_INTERVAL_MS,
+// and the HTTP engine reads every connection until there is nothing
+// left, so only go to uSock when the socket has called back since
+// the last read came up short.
+static int32_t sockRead(void *pContext, int32_t handle,
+                        void *pData, size_t dataSizeBytes)
+{
+    uWifiCaptivePortalSock_t *pEntry = pSockFind(handle);
+    int32_t size = -U_SOCK_EWOULDBLOCK;
+    (void) pContext;
+    if ((pEntry == NULL) || pEntry->dataPending) {
+        if (pEntry != NULL) {
+            // Clear before reading so that a callback during the read counts
+            pEntry->dataPending = false;
+        }
+        size = uSockRead(handle, pData, dataSizeBytes);
+        if (size < 0) {
+            size = -errno;
+        } else if ((pEntry != NULL) && ((size_t) size == dataSizeBytes)) {
+            // There may be more
+            pEntry->dataPending = true;
+        }
     }
+    return size;
 }
 
+// Write all of a buffer to a uSock socket.
+static int32_t sockWrite(void *pContext, int32_t handle,
+                         const void *pData, size_t dataSizeBytes)
+{
+    const char *pTmp = (const char *) pData;
+    size_t written = 0;
+    int32_t size = 1;
+    (void) pContext;
+    while ((written < dataSizeBytes) && (size > 0)) {
+        size = uSockWrite(handle, pTmp + written, dataSizeBytes - written);
+        if (size > 0) {
+            written += size;
+        }
+    }
+    return (size < 0) ? size : (int32_t) written;
+}
+
+// Close a uSock socket.
+static int32_t sockClose(void *pContext, int32_t handle)
+{
+    uWifiCaptivePortalSock_t *pEntry = pSockFind(handle);
+    int32_t errorCode = uSockClose(handle);
+    (void) pContext;
+    if (pEntry != NULL) {
+        pEntry->sock = -1;
+    }
+    return errorCode;
+}
+
+// The sockets of the HTTP server, made of uSock calls.
+static const uWifiCaptivePortalPrivateSock_t gSock = {
+    .pListen = sockListen,
+    .pAccept = sockAccept,
+    .pRead = sockRead,
+    .pWrite = sockWrite,
+    .pClose = sockClose
+};
+
 // Callback controlling whether the DNS server should continue or not
 static bool dnsKeepGoingCallback(uDeviceHandle_t deviceHandle)
 {
@@ -329,8 +491,13 @@ static void dnsServerTask(void *pParameters)
  * FUNCTIONS
  * ------------------------------------------------------------- */
 
-// Special for now, non exposed global for accept timeouts, see u_wifi_sock.c
-extern int32_t gUWifiSocketAcceptTimeoutS;
+// Add routes of the user
+void uWifiCaptivePortalSetRoutes(const uWifiCaptivePortalHttpRoute_t *pRoutes,
+                                 size_t numRoutes)
+{
+    gpUserRoutes = pRoutes;
+    gNumUserRoutes = (pRoutes != NULL) ? numRoutes : 0;
+}
 
 // Captive portal main function
 int32_t uWifiCaptivePortal(uDeviceHandle_t deviceHandle,
@@ -374,54 +541,31 @@ int32_t uWifiCaptivePortal(uDeviceHandle_t deviceHandle,
                         U_WIFI_CAPTIVE_PORTAL_DNS_TASK_PRIORITY,
                         &dnsServer);
 
-        // Start the web server
-        int32_t sock = uSockCreate(gDevHandle,
-                                   U_SOCK_TYPE_STREAM,
-                                   U_SOCK_PROTOCOL_TCP);
-        if (sock >= 0) {
-            uSockAddress_t remoteAddr;
-            char addrStr[15];
-            remoteAddr.ipAddress.address.ipv4 = 0;
-            remoteAddr.port = 80;
-            uSockBind(sock, &remoteAddr);
-            uSockListen(sock, 1);
-            gUWifiSocketAcceptTimeoutS = 2;
-            uPortLog(LOG_PREFIX "\"%s\" started\n", pSsid ? pSsid : "Servers only");
-            while (gKeepGoing) {
-                static char request[1024];
-                // Wait for connection
-                int32_t clientSock = uSockAccept(sock, &remoteAddr);
-                if (clientSock >= 0) {
-                    uSockIpAddressToString(&(remoteAddr.ipAddress), addrStr, sizeof(addrStr));
-                    uPortLog(LOG_PREFIX "Connected to: %s\n", addrStr);
-                    // Set non-blocking: we'll do our own
-                    uSockBlockingSet(clientSock, false);
-                    int32_t cnt;
-                    size_t requestLength = 0;
-                    do {
-                        // Wait for a short while to make sure we don't miss anything
-                        uPortTaskBlock(U_WIFI_CAPTIVE_PORTAL_CLIENT_SOCKET_READ_DELAY_MS);
-                        cnt = uSockRead(clientSock, request + requestLength,
-                                        sizeof(request) - requestLength - 1);
-                        if (cnt > 0) {
-                            requestLength += cnt;
-                        }
-                    } while ((cnt > 0) && (requestLength < (sizeof(request) - 1)));
-                    if (requestLength > 0) {
-                        request[requestLength] = 0;
-                        handleRequest(request, clientSock);
-                    } else {
-                        uPortLog(LOG_PREFIX "ERROR No request\n");
-                    }
-                    uSockClose(clientSock);
-                } else if (clientSock != U_ERROR_COMMON_TIMEOUT) {
-                    uPortLog(LOG_PREFIX "ERROR Accept failed: %d\n", clientSock);
-                    gKeepGoing = false;
-                } else if (cb) {
-                    gKeepGoing = cb(gDevHandle);
-                }
+        // Start the web server, with the routes of the user first
+        size_t numRoutes = gNumUserRoutes + U_WIFI_CAPTIVE_PORTAL_NUM_BUILT_IN_ROUTES;
+        uWifiCaptivePortalHttpRoute_t *pRoutes;
+        pRoutes = (uWifiCaptivePortalHttpRoute_t *) pUPortMalloc(numRoutes * sizeof(*pRoutes));
+        if (pRoutes != NULL) {
+            if (gNumUserRoutes > 0) {
+                memcpy(pRoutes, gpUserRoutes, gNumUserRoutes * sizeof(*pRoutes));
+            }
+            memcpy(pRoutes + gNumUserRoutes, gBuiltInRoutes, sizeof(gBuiltInRoutes));
+            gCb = cb;
+            for (size_t x = 0; x < sizeof(gSockList) / sizeof(gSockList[0]); x++) {
+                gSockList[x].sock = -1;
             }
-            uSockClose(sock);
+            uPortLog(LOG_PREFIX "\"%s\" started\n", pSsid ? pSsid : "Servers only");
+            errorCode = uWifiCaptivePortalPrivateHttpRun(&gSock, (void *) gDevHandle,
+                                                         gDevHandle, pRoutes, numRoutes,
+                                                         httpKeepGoingCallback);
+            uPortFree(pRoutes);
+            gUWifiSocketAcceptTimeoutS = -1;
+        } else {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        }
+        // Make sure the DNS server exits too
+        gKeepGoing = false;
+        if (errorCode == 0) {
             // Close down the access point and try to connect and save the entered credentials
             uPortTaskBlock(1000);
             if (pSsid != NULL || strlen(gSsid) > 0) {
@@ -442,9 +586,7 @@ int32_t uWifiCaptivePortal(uDeviceHandle_t deviceHandle,
                 errorCode = U_ERROR_COMMON_NOT_INITIALISED;
             }
         } else {
-            uPortLog(LOG_PREFIX "ERROR Failed to create server socket: %d\n", sock);
             uNetworkInterfaceDown(gDevHandle, U_NETWORK_TYPE_WIFI);
-            errorCode = sock;
         }
     } else {
         uPortLog(LOG_PREFIX "ERROR Failed to start the access point: %d\n", errorCode);
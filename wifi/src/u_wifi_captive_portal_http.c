@@ -0,0 +1,668 @@
+/*
+ * Copyright 2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Implementation of the HTTP engine of the WiFi captive
+ * portal: a small HTTP/1.1 server which serves several connections
+ * at once, woken by socket callbacks, framing requests by their
+ * headers and Content-Length and keeping connections alive.
+ */
+
+#ifdef U_CFG_OVERRIDE
+#include "u_cfg_override.h"  // For a customer's configuration override
+#endif
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+#include "stddef.h"
+#include "stdint.h"
+#include "stdbool.h"
+#include "string.h"
+#include "stdio.h"
+#include "ctype.h"     // tolower(), isdigit()
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_cfg_sw.h"
+#include "u_port_debug.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_device.h"
+
+#include "u_sock_errno.h"
+
+#include "u_wifi_captive_portal.h"
+#include "u_wifi_captive_portal_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#define LOG_PREFIX "U_WIFI_CAPTIVE_PORTAL: "
+
+/** Room for the status line and headers of a response.
+ */
+#define U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_HEADER_MAX_LENGTH_BYTES 256
+
+/** The size of the buffer of a connection: a request plus a
+ * terminator.
+ */
+#define U_WIFI_CAPTIVE_PORTAL_HTTP_BUFFER_LENGTH_BYTES \
+    (U_WIFI_CAPTIVE_PORTAL_HTTP_REQUEST_MAX_LENGTH_BYTES + 1)
+
+/** The size of the response buffer: a header plus a body.
+ */
+#define U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_BUFFER_LENGTH_BYTES \
+    (U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_HEADER_MAX_LENGTH_BYTES + \
+     U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_MAX_LENGTH_BYTES)
+
+/** The backlog of the listening socket: connections beyond those
+ * being served are accepted only to be turned away, so this need
+ * not be large.
+ */
+#define U_WIFI_CAPTIVE_PORTAL_HTTP_BACKLOG 2
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A connection to the HTTP engine.
+ */
+typedef struct {
+    int32_t handle;         /**< the handle from pAccept, -1 if this
+                                 entry is free. */
+    char *pBuffer;          /**< the received data, room for
+                                 #U_WIFI_CAPTIVE_PORTAL_HTTP_REQUEST_MAX_LENGTH_BYTES
+                                 plus a terminator. */
+    size_t length;          /**< the number of bytes in pBuffer. */
+    int32_t lastActivityMs; /**< when data last arrived or the
+                                 connection was made. */
+    bool headerParsed;      /**< true once the header of the request
+                                 at the start of pBuffer has been
+                                 parsed and the fields below are
+                                 valid. */
+    size_t headerLength;    /**< the length of the header, including
+                                 the blank line that ends it. */
+    size_t contentLength;   /**< the length of the body. */
+    size_t pathOffset;      /**< where the path starts in pBuffer; the
+                                 method is at the start. */
+    size_t queryOffset;     /**< where the query starts in pBuffer, 0
+                                 if there is none. */
+    bool keepAlive;         /**< true if the connection is to be kept
+                                 open after the response. */
+} uWifiCaptivePortalHttpConnection_t;
+
+/** The state of the HTTP engine.
+ */
+typedef struct {
+    const uWifiCaptivePortalPrivateSock_t *pSock;
+    void *pContext;
+    const uWifiCaptivePortalHttpRoute_t *pRoutes;
+    size_t numRoutes;
+    char *pResponse;  /**< room for a response header followed by
+                           #U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_MAX_LENGTH_BYTES
+                           of body. */
+    uWifiCaptivePortalHttpConnection_t connection[U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS];
+} uWifiCaptivePortalHttp_t;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: HELPERS
+ * -------------------------------------------------------------- */
+
+// Return the reason phrase for an HTTP status code.
+static const char *pReason(int32_t status)
+{
+    switch (status) {
+        case 200:
+            return "OK";
+        case 204:
+            return "No Content";
+        case 400:
+            return "Bad Request";
+        case 403:
+            return "Forbidden";
+        case 404:
+            return "Not Found";
+        case 405:
+            return "Method Not Allowed";
+        case 413:
+            return "Payload Too Large";
+        case 431:
+            return "Request Header Fields Too Large";
+        case 500:
+            return "Internal Server Error";
+        case 501:
+            return "Not Implemented";
+        case 503:
+            return "Service Unavailable";
+        default:
+            break;
+    }
+    return "";
+}
+
+// Compare two strings without regard to case.
+static bool equalNoCase(const char *pA, const char *pB)
+{
+    while ((*pA != 0) && (tolower((int32_t) *pA) == tolower((int32_t) *pB))) {
+        pA++;
+        pB++;
+    }
+    return tolower((int32_t) *pA) == tolower((int32_t) *pB);
+}
+
+// Return true if the comma-separated list pList contains pToken,
+// without regard to case.
+static bool hasToken(const char *pList, const char *pToken)
+{
+    size_t tokenLength = strlen(pToken);
+    size_t x;
+
+    while (*pList != 0) {
+        while ((*pList == ' ') || (*pList == '\t') || (*pList == ',')) {
+            pList++;
+        }
+        for (x = 0; (x < tokenLength) &&
+             (tolower((int32_t) pList[x]) == tolower((int32_t) pToken[x])); x++) {
+        }
+        if ((x == tokenLength) &&
+            ((pList[x] == 0) || (pList[x] == ',') ||
+             (pList[x] == ' ') || (pList[x] == '\t'))) {
+            return true;
+        }
+        while ((*pList != 0) && (*pList != ',')) {
+            pList++;
+        }
+    }
+
+    return false;
+}
+
+// Return the offset of the blank line which ends the header in
+// pBuffer, -1 if it has not arrived yet.
+static int32_t headerEnd(const char *pBuffer, size_t length)
+{
+    for (size_t x = 0; x + 3 < length; x++) {
+        if ((pBuffer[x] == '\r') && (pBuffer[x + 1] == '\n') &&
+            (pBuffer[x + 2] == '\r') && (pBuffer[x + 3] == '\n')) {
+            return (int32_t) x;
+        }
+    }
+    return -1;
+}
+
+// Find the route for a request, NULL if there is none.
+static const uWifiCaptivePortalHttpRoute_t *pFindRoute(const uWifiCaptivePortalHttp_t *pHttp,
+                                                       const char *pMethod,
+                                                       const char *pPath)
+{
+    const uWifiCaptivePortalHttpRoute_t *pRoute;
+    bool isHead = (strcmp(pMethod, "HEAD") == 0);
+    size_t length;
+
+    for (size_t x = 0; x < pHttp->numRoutes; x++) {
+        pRoute = &(pHttp->pRoutes[x]);
+        if ((strcmp(pRoute->pMethod, pMethod) == 0) ||
+            (isHead && (strcmp(pRoute->pMethod, "GET") == 0))) {
+            length = strlen(pRoute->pPath);
+            if ((length > 0) && (pRoute->pPath[length - 1] == '*')) {
+                if (strncmp(pRoute->pPath, pPath, length - 1) == 0) {
+                    return pRoute;
+                }
+            } else if (strcmp(pRoute->pPath, pPath) == 0) {
+                return pRoute;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: REQUESTS AND RESPONSES
+ * -------------------------------------------------------------- */
+
+// Send a response; pBody may be NULL if bodyLength is zero.  Where
+// the body fits in the response buffer the header and body go in
+// a single write, which matters when each write is a round trip
+// to a module.  Returns true on success.
+static bool sendResponse(const uWifiCaptivePortalHttp_t *pHttp, int32_t handle,
+                         int32_t status, const char *pContentType,
+                         const char *pBody, size_t bodyLength,
+                         bool sendBody, bool keepAlive)
+{
+    const uWifiCaptivePortalPrivateSock_t *pSock = pHttp->pSock;
+    char *pBodyArea = pHttp->pResponse +
+                      U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_HEADER_MAX_LENGTH_BYTES;
+    char header[U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_HEADER_MAX_LENGTH_BYTES];
+    char contentType[64] = {0};
+    int32_t headerLength;
+    size_t sendLength;
+    bool success = false;
+
+    if (pContentType != NULL) {
+        snprintf(contentType, sizeof(contentType), "Content-Type: %s\r\n", pContentType);
+    }
+    headerLength = snprintf(header, sizeof(header),
+                            "HTTP/1.1 %d %s\r\n"
+                            "Server: ubxlib\r\n"
+                            "%s"
+                            "Content-Length: %d\r\n"
+                            "Cache-Control: no-store, no-cache, must-revalidate\r\n"
+                            "Connection: %s\r\n"
+                            "\r\n",
+                            (int) status, pReason(status), contentType,
+                            (int) bodyLength, keepAlive ? "keep-alive" : "close");
+    if ((headerLength > 0) && (headerLength < (int32_t) sizeof(header))) {
+        sendLength = sendBody ? bodyLength : 0;
+        if ((sendLength > 0) && (pBody != pBodyArea) &&
+            (sendLength <= U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_MAX_LENGTH_BYTES)) {
+            memcpy(pBodyArea, pBody, sendLength);
+            pBody = pBodyArea;
+        }
+        if ((sendLength == 0) || (pBody == pBodyArea)) {
+            memcpy(pBodyArea - headerLength, header, headerLength);
+            success = (pSock->pWrite(pHttp->pContext, handle, pBodyArea - headerLength,
+                                     headerLength + sendLength) ==
+                       (int32_t) (headerLength + sendLength));
+        } else {
+            success = (pSock->pWrite(pHttp->pContext, handle, header,
+                                     headerLength) == headerLength) &&
+                      (pSock->pWrite(pHttp->pContext, handle, pBody,
+                                     sendLength) == (int32_t) sendLength);
+        }
+    }
+
+    return success;
+}
+
+// Parse the header of the request at the start of the buffer of a
+// connection, which ends at headerEndOffset, in place; return zero
+// on success else the HTTP status to reject the request with.
+static int32_t parseHeader(uWifiCaptivePortalHttpConnection_t *pConnection,
+                           size_t headerEndOffset)
+{
+    char *pBuffer = pConnection->pBuffer;
+    char *pLine = pBuffer;
+    char *pNext;
+    char *pTarget;
+    char *pVersion;
+    char *pValue;
+    char *pTmp;
+    size_t contentLength = 0;
+
+    if (memchr(pBuffer, 0, headerEndOffset) != NULL) {
+        return 400;
+    }
+    pBuffer[headerEndOffset] = 0;
+    pConnection->headerLength = headerEndOffset + 4;
+
+    // The request line: method, target and version
+    pNext = strstr(pLine, "\r\n");
+    if (pNext != NULL) {
+        *pNext = 0;
+        pNext += 2;
+    }
+    pTarget = strchr(pLine, ' ');
+    if ((pTarget == NULL) || (pTarget == pLine)) {
+        return 400;
+    }
+    *pTarget++ = 0;
+    pVersion = strchr(pTarget, ' ');
+    if ((pVersion == NULL) || (*pTarget != '/')) {
+        return 400;
+    }
+    *pVersion++ = 0;
+    if ((strncmp(pVersion, "HTTP/1.", 7) != 0) || !isdigit((int32_t) pVersion[7])) {
+        return 400;
+    }
+    // HTTP/1.1 is kept alive unless asked otherwise, HTTP/1.0
+    // only if asked
+    pConnection->keepAlive = (pVersion[7] != '0');
+    pConnection->pathOffset = pTarget - pBuffer;
+    pConnection->queryOffset = 0;
+    pTmp = strchr(pTarget, '?');
+    if (pTmp != NULL) {
+        *pTmp++ = 0;
+        pConnection->queryOffset = pTmp - pBuffer;
+    }
+
+    // The header fields that matter here
+    while (pNext != NULL) {
+        pLine = pNext;
+        pNext = strstr(pLine, "\r\n");
+        if (pNext != NULL) {
+            *pNext = 0;
+            pNext += 2;
+        }
+        pValue = strchr(pLine, ':');
+        if ((pValue == NULL) || (pValue == pLine)) {
+            return 400;
+        }
+        *pValue++ = 0;
+        while ((*pValue == ' ') || (*pValue == '\t')) {
+            pValue++;
+        }
+        if (equalNoCase(pLine, "Content-Length")) {
+            if (!isdigit((int32_t) *pValue)) {
+                return 400;
+            }
+            contentLength = 0;
+            while (isdigit((int32_t) *pValue)) {
+                if (contentLength <= U_WIFI_CAPTIVE_PORTAL_HTTP_REQUEST_MAX_LENGTH_BYTES) {
+                    contentLength = (contentLength * 10) + (*pValue - '0');
+                }
+                pValue++;
+            }
+        } else if (equalNoCase(pLine, "Connection")) {
+            if (hasToken(pValue, "close")) {
+                pConnection->keepAlive = false;
+            } else if (hasToken(pValue, "keep-alive")) {
+                pConnection->keepAlive = true;
+            }
+        } else if (equalNoCase(pLine, "Transfer-Encoding")) {
+            // No chunked bodies here
+            return 501;
+        }
+    }
+
+    if (pConnection->headerLength + contentLength >
+        U_WIFI_CAPTIVE_PORTAL_HTTP_REQUEST_MAX_LENGTH_BYTES) {
+        return 413;
+    }
+    pConnection->contentLength = contentLength;
+    pConnection->headerParsed = true;
+
+    return 0;
+}
+
+// Answer the complete request at the start of the buffer of a
+// connection, whose header has been parsed; return true if the
+// response was sent.
+static bool answer(const uWifiCaptivePortalHttp_t *pHttp,
+                   uWifiCaptivePortalHttpConnection_t *pConnection)
+{
+    const uWifiCaptivePortalHttpRoute_t *pRoute;
+    uWifiCaptivePortalHttpRequest_t request;
+    char *pBuffer = pConnection->pBuffer;
+    char *pBodyArea = pHttp->pResponse +
+                      U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_HEADER_MAX_LENGTH_BYTES;
+    size_t requestLength = pConnection->headerLength + pConnection->contentLength;
+    const char *pContentType = NULL;
+    const char *pBody = NULL;
+    size_t bodyLength = 0;
+    int32_t status = 404;
+    char saved;
+
+    // Terminate the body, remembering what was there since it may
+    // be the start of a pipelined request; the buffer has room
+    saved = pBuffer[requestLength];
+    pBuffer[requestLength] = 0;
+    request.pMethod = pBuffer;
+    request.pPath = pBuffer + pConnection->pathOffset;
+    request.pQuery = (pConnection->queryOffset > 0) ? pBuffer + pConnection->queryOffset : "";
+    request.pBody = pBuffer + pConnection->headerLength;
+    request.bodyLength = pConnection->contentLength;
+
+    pRoute = pFindRoute(pHttp, request.pMethod, request.pPath);
+    if (pRoute != NULL) {
+        pContentType = pRoute->pContentType;
+        if (pRoute->pHandler != NULL) {
+            status = pRoute->pHandler(&request, pBodyArea,
+                                      U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_MAX_LENGTH_BYTES,
+                                      &bodyLength, &pContentType, pRoute->pHandlerParam);
+            if (bodyLength > U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_MAX_LENGTH_BYTES) {
+                bodyLength = U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_MAX_LENGTH_BYTES;
+            }
+            pBody = pBodyArea;
+        } else {
+            status = 200;
+            pBody = pRoute->pContent;
+            bodyLength = (pBody != NULL) ? pRoute->contentLength : 0;
+        }
+    }
+#ifdef U_WIFI_CAPTIVE_PORTAL_HTTP_DEBUG_PRINT
+    uPortLog(LOG_PREFIX "%s %s -> %d.\n", request.pMethod, request.pPath, status);
+#endif
+    pBuffer[requestLength] = saved;
+
+    return sendResponse(pHttp, pConnection->handle, status, pContentType,
+                        pBody, bodyLength, strcmp(request.pMethod, "HEAD") != 0,
+                        pConnection->keepAlive);
+}
+
+// Answer each complete request in the buffer of a connection,
+// leaving any partial request at the start; return false if the
+// connection should now be closed.
+static bool serve(const uWifiCaptivePortalHttp_t *pHttp,
+                  uWifiCaptivePortalHttpConnection_t *pConnection)
+{
+    size_t requestLength;
+    int32_t offset;
+    int32_t status;
+    bool keepOpen = true;
+
+    while (keepOpen && (pConnection->length > 0)) {
+        if (!pConnection->headerParsed) {
+            offset = headerEnd(pConnection->pBuffer, pConnection->length);
+            if (offset < 0) {
+                if (pConnection->length >= U_WIFI_CAPTIVE_PORTAL_HTTP_REQUEST_MAX_LENGTH_BYTES) {
+                    sendResponse(pHttp, pConnection->handle, 431, NULL, NULL, 0, false, false);
+                    keepOpen = false;
+                }
+                break;
+            }
+            status = parseHeader(pConnection, offset);
+            if (status != 0) {
+                sendResponse(pHttp, pConnection->handle, status, NULL, NULL, 0, false, false);
+                keepOpen = false;
+                break;
+            }
+        }
+        requestLength = pConnection->headerLength + pConnection->contentLength;
+        if (pConnection->length < requestLength) {
+            // Wait for the rest of the body
+            break;
+        }
+        keepOpen = answer(pHttp, pConnection) && pConnection->keepAlive;
+        // Move any pipelined request up to the start
+        pConnection->length -= requestLength;
+        memmove(pConnection->pBuffer, pConnection->pBuffer + requestLength,
+                pConnection->length);
+        pConnection->headerParsed = false;
+    }
+
+    return keepOpen;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: CONNECTIONS
+ * -------------------------------------------------------------- */
+
+// Called by the sockets to wake up the engine.
+static void wakeCallback(void *pParameter)
+{
+    uPortSemaphoreGive((uPortSemaphoreHandle_t) pParameter);
+}
+
+// Take a new connection, turning it away if there is no room.
+static void connectionOpen(uWifiCaptivePortalHttp_t *pHttp, int32_t handle)
+{
+    uWifiCaptivePortalHttpConnection_t *pConnection;
+
+    for (size_t x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS; x++) {
+        pConnection = &(pHttp->connection[x]);
+        if (pConnection->handle < 0) {
+            pConnection->handle = handle;
+            pConnection->length = 0;
+            pConnection->headerParsed = false;
+            pConnection->lastActivityMs = uPortGetTickTimeMs();
+            return;
+        }
+    }
+
+    sendResponse(pHttp, handle, 503, NULL, NULL, 0, false, false);
+    pHttp->pSock->pClose(pHttp->pContext, handle);
+}
+
+// Close a connection.
+static void connectionClose(uWifiCaptivePortalHttp_t *pHttp,
+                            uWifiCaptivePortalHttpConnection_t *pConnection)
+{
+    pHttp->pSock->pClose(pHttp->pContext, pConnection->handle);
+    pConnection->handle = -1;
+    pConnection->length = 0;
+    pConnection->headerParsed = false;
+}
+
+// Read what has arrived on a connection and answer what can be
+// answered, closing the connection if it has gone, if it should
+// not be kept or if it has been idle for too long; return true
+// if anything arrived.
+static bool connectionService(uWifiCaptivePortalHttp_t *pHttp,
+                              uWifiCaptivePortalHttpConnection_t *pConnection)
+{
+    const uWifiCaptivePortalPrivateSock_t *pSock = pHttp->pSock;
+    int32_t nowMs = uPortGetTickTimeMs();
+    int32_t size = -U_SOCK_EWOULDBLOCK;
+    bool dataArrived = false;
+    bool keepOpen;
+
+    while (pConnection->length < U_WIFI_CAPTIVE_PORTAL_HTTP_REQUEST_MAX_LENGTH_BYTES) {
+        size = pSock->pRead(pHttp->pContext, pConnection->handle,
+                            pConnection->pBuffer + pConnection->length,
+                            U_WIFI_CAPTIVE_PORTAL_HTTP_REQUEST_MAX_LENGTH_BYTES -
+                            pConnection->length);
+        if (size <= 0) {
+            break;
+        }
+        pConnection->length += size;
+        pConnection->lastActivityMs = nowMs;
+        dataArrived = true;
+    }
+
+    // Answer whatever arrived, even if the connection has since gone
+    keepOpen = serve(pHttp, pConnection);
+    if (!keepOpen || ((size < 0) && (size != -U_SOCK_EWOULDBLOCK)) ||
+        (nowMs - pConnection->lastActivityMs > U_WIFI_CAPTIVE_PORTAL_HTTP_KEEP_ALIVE_MS)) {
+        connectionClose(pHttp, pConnection);
+    }
+
+    return dataArrived;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: PRIVATE TO THE CAPTIVE PORTAL
+ * -------------------------------------------------------------- */
+
+int32_t uWifiCaptivePortalPrivateHttpRun(const uWifiCaptivePortalPrivateSock_t *pSock,
+                                         void *pContext,
+                                         uDeviceHandle_t deviceHandle,
+                                         const uWifiCaptivePortalHttpRoute_t *pRoutes,
+                                         size_t numRoutes,
+                                         uWifiCaptivePortalKeepGoingCallback_t cb)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uWifiCaptivePortalHttp_t *pHttp;
+    uWifiCaptivePortalHttpConnection_t *pConnection;
+    uPortSemaphoreHandle_t semaphoreHandle = NULL;
+    char *pBuffers = NULL;
+    int32_t listenHandle = -1;
+    int32_t handle;
+    bool busy;
+    bool keepGoing = true;
+
+    // All of the memory is allocated up-front: one buffer per
+    // connection, each with room for a terminator, and one for
+    // a response
+    pHttp = (uWifiCaptivePortalHttp_t *) pUPortMalloc(sizeof(*pHttp));
+    if (pHttp != NULL) {
+        memset(pHttp, 0, sizeof(*pHttp));
+        pBuffers = (char *) pUPortMalloc((U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS *
+                                          U_WIFI_CAPTIVE_PORTAL_HTTP_BUFFER_LENGTH_BYTES) +
+                                         U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_BUFFER_LENGTH_BYTES);
+        if (pBuffers != NULL) {
+            errorCode = uPortSemaphoreCreate(&semaphoreHandle, 0, 1);
+        }
+    }
+    if (errorCode == 0) {
+        pHttp->pSock = pSock;
+        pHttp->pContext = pContext;
+        pHttp->pRoutes = pRoutes;
+        pHttp->numRoutes = (pRoutes != NULL) ? numRoutes : 0;
+        for (size_t x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS; x++) {
+            pHttp->connection[x].handle = -1;
+            pHttp->connection[x].pBuffer = pBuffers +
+                                           (x * U_WIFI_CAPTIVE_PORTAL_HTTP_BUFFER_LENGTH_BYTES);
+        }
+        pHttp->pResponse = pBuffers + (U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS *
+                                       U_WIFI_CAPTIVE_PORTAL_HTTP_BUFFER_LENGTH_BYTES);
+        listenHandle = pSock->pListen(pContext, U_WIFI_CAPTIVE_PORTAL_PRIVATE_HTTP_PORT,
+                                      U_WIFI_CAPTIVE_PORTAL_HTTP_BACKLOG,
+                                      wakeCallback, semaphoreHandle);
+        if (listenHandle < 0) {
+            uPortLog(LOG_PREFIX "ERROR Failed to create server socket: %d\n", listenHandle);
+            errorCode = listenHandle;
+        }
+    }
+
+    if (errorCode == 0) {
+        while (keepGoing) {
+            busy = false;
+            // Take any new connections
+            while ((handle = pSock->pAccept(pContext, listenHandle,
+                                            wakeCallback, semaphoreHandle)) >= 0) {
+                connectionOpen(pHttp, handle);
+                busy = true;
+            }
+            // Serve the ones we have
+            for (size_t x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS; x++) {
+                pConnection = &(pHttp->connection[x]);
+                if ((pConnection->handle >= 0) && connectionService(pHttp, pConnection)) {
+                    busy = true;
+                }
+            }
+            // If nothing happened, wait to be woken; if something
+            // did there may be more already, so just go around again
+            uPortSemaphoreTryTake(semaphoreHandle, busy ? 0 : U_WIFI_CAPTIVE_PORTAL_HTTP_POLL_MS);
+            keepGoing = (cb == NULL) || cb(deviceHandle);
+        }
+        for (size_t x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS; x++) {
+            pConnection = &(pHttp->connection[x]);
+            if (pConnection->handle >= 0) {
+                connectionClose(pHttp, pConnection);
+            }
+        }
+        errorCode = pSock->pClose(pContext, listenHandle);
+    }
+
+    if (semaphoreHandle != NULL) {
+        uPortSemaphoreDelete(semaphoreHandle);
+    }
+    uPortFree(pBuffers);
+    uPortFree(pHttp);
+
+    return errorCode;
+}
+
+// End of file
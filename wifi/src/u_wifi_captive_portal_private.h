@@ -0,0 +1,113 @@
+/*
+ * Copyright 2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_WIFI_CAPTIVE_PORTAL_PRIVATE_H_
+#define _U_WIFI_CAPTIVE_PORTAL_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief Functions private to the captive portal, exposed so that
+ * its HTTP engine can be tested over something other than a real
+ * socket.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The TCP port that the web server of the captive portal listens on.
+ */
+#define U_WIFI_CAPTIVE_PORTAL_PRIVATE_HTTP_PORT 80
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The stream sockets that the HTTP engine of the captive portal
+ * runs on: uWifiCaptivePortal() uses ones made of uSock calls on
+ * the device.  pCallback, wherever it is given, wakes the engine
+ * up; it may be called from any task.
+ */
+typedef struct {
+    /** Open a listening socket on port with the given backlog,
+     * arranging for pCallback to be called with pCallbackParam
+     * when a connection arrives if that is possible; return a
+     * handle for pAccept, else negative error code. */
+    int32_t (*pListen)(void *pContext, uint16_t port, size_t backlog,
+                       void (*pCallback)(void *), void *pCallbackParam);
+    /** Accept a connection without blocking, arranging for
+     * pCallback to be called with pCallbackParam when data arrives
+     * on it or it is closed by the far end; return a handle for the
+     * connection, else negative if there is none waiting. */
+    int32_t (*pAccept)(void *pContext, int32_t listenHandle,
+                       void (*pCallback)(void *), void *pCallbackParam);
+    /** Read from a connection without blocking; return the number
+     * of bytes read, -#U_SOCK_EWOULDBLOCK if there is nothing to
+     * read yet, any other negative value if the connection has gone. */
+    int32_t (*pRead)(void *pContext, int32_t handle,
+                     void *pData, size_t dataSizeBytes);
+    /** Write all of the given data to a connection; return the
+     * number of bytes written, else negative error code. */
+    int32_t (*pWrite)(void *pContext, int32_t handle,
+                      const void *pData, size_t dataSizeBytes);
+    /** Close a connection or the listening socket; return zero on
+     * success else negative error code. */
+    int32_t (*pClose)(void *pContext, int32_t handle);
+} uWifiCaptivePortalPrivateSock_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Run the HTTP engine of the captive portal: connections are
+ * served concurrently, up to
+ * #U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS of them, requests
+ * are framed by their headers and any Content-Length, pipelined
+ * requests are answered in order and connections are kept alive
+ * as the client asks.  Returns when cb returns false.
+ *
+ * @param[in] pSock    the socket functions; cannot be NULL.
+ * @param[in] pContext passed to the socket functions.
+ * @param deviceHandle passed to cb.
+ * @param[in] pRoutes  the routes to serve, consulted in order; a
+ *                     request matching none is answered with 404.
+ * @param numRoutes    the number of entries in pRoutes.
+ * @param cb           the keep-going callback, NULL to keep going
+ *                     forever.
+ * @return             zero on exit else negative error code.
+ */
+int32_t uWifiCaptivePortalPrivateHttpRun(const uWifiCaptivePortalPrivateSock_t *pSock,
+                                         void *pContext,
+                                         uDeviceHandle_t deviceHandle,
+                                         const uWifiCaptivePortalHttpRoute_t *pRoutes,
+                                         size_t numRoutes,
+                                         uWifiCaptivePortalKeepGoingCallback_t cb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_WIFI_CAPTIVE_PORTAL_PRIVATE_H_
+
+// End of file
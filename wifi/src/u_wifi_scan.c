@@ -0,0 +1,625 @@
+/*
+ * Copyright 2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the background scan service of the
+ * Wi-Fi API.  The scans themselves are done with uWifiStationScan(),
+ * which holds the AT lock, but not the short range lock, for the
+ * duration of a scan: the module will not accept another AT command
+ * until its response to AT+UWSCAN has ended, so the AT lock cannot
+ * be given up between result lines.  What this code does is keep
+ * everything else out from under that lock: results go into the
+ * cache under a mutex of this file and are passed to the result
+ * callback from an event queue, so that a consumer never waits on
+ * the module to read the cache and may call other APIs from the
+ * callback.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), memcmp(), strncpy()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_event_queue.h"
+
+#include "u_device.h"
+
+#include "u_wifi.h"
+#include "u_wifi_scan.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The smoothed RSSI is kept in units of 1/16th dBm so that small
+ * changes are not lost to integer arithmetic.
+ */
+#define U_WIFI_SCAN_RSSI_SCALE 16
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** An entry in the cache of access points.
+ */
+typedef struct {
+    bool inUse;
+    uWifiScanResult_t result; /**< the most recent result. */
+    int32_t rssiSmoothed;     /**< in units of 1/#U_WIFI_SCAN_RSSI_SCALE dBm. */
+    int32_t lastSeenMs;       /**< uPortGetTickTimeMs() when last seen. */
+    int32_t numSightings;
+} uWifiScanCacheEntry_t;
+
+/** The types of event passed to the callback task.
+ */
+typedef enum {
+    U_WIFI_SCAN_EVENT_RESULT,
+    U_WIFI_SCAN_EVENT_DONE
+} uWifiScanEventType_t;
+
+/** The scan service for one Wi-Fi instance.
+ */
+typedef struct uWifiScanContext_t {
+    uDeviceHandle_t devHandle;
+    uWifiScanCfg_t cfg;          /**< with pSsid pointing at ssid. */
+    char ssid[U_WIFI_SSID_SIZE];
+    uPortSemaphoreHandle_t wakeSemaphoreHandle;
+    uPortMutexHandle_t taskRunningMutexHandle;
+    uPortTaskHandle_t taskHandle;
+    volatile bool taskRunning;
+    volatile bool taskStop;
+    int32_t eventQueueHandle;    /**< negative if there are no callbacks. */
+    int32_t numResults;          /**< the results of the scan in progress. */
+    uWifiScanCacheEntry_t cache[U_WIFI_SCAN_MAX_NUM_ENTRIES];
+    struct uWifiScanContext_t *pNext;
+} uWifiScanContext_t;
+
+/** An event passed to the callback task.
+ */
+typedef struct {
+    uWifiScanContext_t *pContext;
+    uWifiScanEventType_t type;
+    int32_t errorCode;           /**< only for #U_WIFI_SCAN_EVENT_DONE. */
+    int32_t numResults;          /**< only for #U_WIFI_SCAN_EVENT_DONE. */
+    uWifiScanResult_t result;    /**< only for #U_WIFI_SCAN_EVENT_RESULT. */
+} uWifiScanEvent_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Mutex protecting the list of scan services and their caches;
+ * created when the first scan service is started and deleted when
+ * the last one is stopped.
+ */
+static uPortMutexHandle_t gMutex = NULL;
+
+/** Root of the list of scan services.
+ */
+static uWifiScanContext_t *gpContextList = NULL;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Find the scan service for a device: gMutex must be locked.
+static uWifiScanContext_t *pContextGet(uDeviceHandle_t devHandle)
+{
+    uWifiScanContext_t *pContext = gpContextList;
+
+    while ((pContext != NULL) && (pContext->devHandle != devHandle)) {
+        pContext = pContext->pNext;
+    }
+
+    return pContext;
+}
+
+// Take the scan service for a device out of the list and return
+// it: gMutex must be locked.
+static uWifiScanContext_t *pContextRemove(uDeviceHandle_t devHandle)
+{
+    uWifiScanContext_t *pContext = NULL;
+    uWifiScanContext_t **ppThis = &gpContextList;
+
+    while ((*ppThis != NULL) && ((*ppThis)->devHandle != devHandle)) {
+        ppThis = &((*ppThis)->pNext);
+    }
+    if (*ppThis != NULL) {
+        pContext = *ppThis;
+        *ppThis = pContext->pNext;
+    }
+
+    return pContext;
+}
+
+// Convert a smoothed RSSI into dBm, rounding to nearest.
+static int32_t rssiDbm(int32_t rssiSmoothed)
+{
+    if (rssiSmoothed < 0) {
+        return -((-rssiSmoothed + (U_WIFI_SCAN_RSSI_SCALE / 2)) / U_WIFI_SCAN_RSSI_SCALE);
+    }
+    return (rssiSmoothed + (U_WIFI_SCAN_RSSI_SCALE / 2)) / U_WIFI_SCAN_RSSI_SCALE;
+}
+
+// Put a result into the cache: gMutex must be locked.
+static void cacheUpdate(uWifiScanContext_t *pContext,
+                        const uWifiScanResult_t *pResult, int32_t nowMs)
+{
+    uWifiScanCacheEntry_t *pEntry = NULL;
+    uWifiScanCacheEntry_t *pSpare = NULL;
+    uWifiScanCacheEntry_t *pThis;
+    int32_t rssi = pResult->rssi * U_WIFI_SCAN_RSSI_SCALE;
+
+    for (size_t x = 0; (x < U_WIFI_SCAN_MAX_NUM_ENTRIES) && (pEntry == NULL); x++) {
+        pThis = &(pContext->cache[x]);
+        if (!pThis->inUse) {
+            if ((pSpare == NULL) || pSpare->inUse) {
+                pSpare = pThis;
+            }
+        } else if (memcmp(pThis->result.bssid, pResult->bssid,
+                          sizeof(pResult->bssid)) == 0) {
+            pEntry = pThis;
+        } else if ((pSpare == NULL) ||
+                   (pSpare->inUse && (pThis->lastSeenMs - pSpare->lastSeenMs < 0))) {
+            // The one seen longest ago is the one to replace
+            pSpare = pThis;
+        }
+    }
+
+    if (pEntry == NULL) {
+        pEntry = pSpare;
+        memset(pEntry, 0, sizeof(*pEntry));
+        pEntry->inUse = true;
+        pEntry->rssiSmoothed = rssi;
+    } else {
+        pEntry->rssiSmoothed += ((rssi - pEntry->rssiSmoothed) *
+                                 U_WIFI_SCAN_RSSI_SMOOTHING_PERCENT) / 100;
+    }
+    pEntry->result = *pResult;
+    pEntry->lastSeenMs = nowMs;
+    pEntry->numSightings++;
+}
+
+// Drop what has not been seen for too long from the cache: gMutex
+// must be locked.
+static void cacheExpire(uWifiScanContext_t *pContext, int32_t nowMs)
+{
+    uWifiScanCacheEntry_t *pEntry;
+
+    for (size_t x = 0; x < U_WIFI_SCAN_MAX_NUM_ENTRIES; x++) {
+        pEntry = &(pContext->cache[x]);
+        if (pEntry->inUse && (nowMs - pEntry->lastSeenMs > pContext->cfg.expiryMs)) {
+            pEntry->inUse = false;
+        }
+    }
+}
+
+// Callback for uWifiStationScan(), called in the scan task with
+// the AT lock held, so it does no more than it has to.
+static void scanCallback(uDeviceHandle_t devHandle, uWifiScanResult_t *pResult)
+{
+    uWifiScanContext_t *pContext;
+    uWifiScanEvent_t event;
+    int32_t eventQueueHandle = -1;
+
+    U_PORT_MUTEX_LOCK(gMutex);
+
+    // Not finding the service is normal if it is being stopped
+    pContext = pContextGet(devHandle);
+    if (pContext != NULL) {
+        cacheUpdate(pContext, pResult, uPortGetTickTimeMs());
+        pContext->numResults++;
+        if (pContext->cfg.pResultCallback != NULL) {
+            eventQueueHandle = pContext->eventQueueHandle;
+            memset(&event, 0, sizeof(event));
+            event.pContext = pContext;
+            event.type = U_WIFI_SCAN_EVENT_RESULT;
+            event.result = *pResult;
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(gMutex);
+
+    // Don't hold up the scan waiting for a slow callback: if the
+    // queue is full the result is only in the cache.  A platform
+    // that can't say how full its queues are just has to wait
+    if ((eventQueueHandle >= 0) && (uPortEventQueueGetFree(eventQueueHandle) != 0)) {
+        uPortEventQueueSend(eventQueueHandle, &event, sizeof(event));
+    }
+}
+
+// Event queue handler: calls the callbacks.
+static void eventHandler(void *pParam, size_t paramLength)
+{
+    uWifiScanEvent_t *pEvent = (uWifiScanEvent_t *) pParam;
+    uWifiScanContext_t *pContext = pEvent->pContext;
+
+    (void) paramLength;
+
+    if (pEvent->type == U_WIFI_SCAN_EVENT_RESULT) {
+        if (pContext->cfg.pResultCallback != NULL) {
+            pContext->cfg.pResultCallback(pContext->devHandle, &(pEvent->result),
+                                          pContext->cfg.pCallbackParam);
+        }
+    } else {
+        if (pContext->cfg.pDoneCallback != NULL) {
+            pContext->cfg.pDoneCallback(pContext->devHandle, pEvent->errorCode,
+                                        pEvent->numResults,
+                                        pContext->cfg.pCallbackParam);
+        }
+    }
+}
+
+// The task that does the scanning; uWifiScanStop() waits on
+// taskRunningMutexHandle for it to exit.
+static void scanTask(void *pParameter)
+{
+    uWifiScanContext_t *pContext = (uWifiScanContext_t *) pParameter;
+    uWifiScanEvent_t event;
+    int32_t errorCode;
+
+    U_PORT_MUTEX_LOCK(pContext->taskRunningMutexHandle);
+    pContext->taskRunning = true;
+
+    while (!pContext->taskStop) {
+        // Timing out is as good as being woken up
+        if (pContext->cfg.periodMs > 0) {
+            uPortSemaphoreTryTake(pContext->wakeSemaphoreHandle, pContext->cfg.periodMs);
+        } else {
+            uPortSemaphoreTake(pContext->wakeSemaphoreHandle);
+        }
+        if (!pContext->taskStop) {
+
+            U_PORT_MUTEX_LOCK(gMutex);
+            pContext->numResults = 0;
+            U_PORT_MUTEX_UNLOCK(gMutex);
+
+            errorCode = uWifiStationScan(pContext->devHandle, pContext->cfg.pSsid,
+                                         scanCallback);
+
+            memset(&event, 0, sizeof(event));
+            event.pContext = pContext;
+            event.type = U_WIFI_SCAN_EVENT_DONE;
+            event.errorCode = errorCode;
+
+            U_PORT_MUTEX_LOCK(gMutex);
+            cacheExpire(pContext, uPortGetTickTimeMs());
+            event.numResults = pContext->numResults;
+            U_PORT_MUTEX_UNLOCK(gMutex);
+
+            if ((pContext->eventQueueHandle >= 0) &&
+                (pContext->cfg.pDoneCallback != NULL)) {
+                uPortEventQueueSend(pContext->eventQueueHandle, &event, sizeof(event));
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pContext->taskRunningMutexHandle);
+
+    uPortTaskDelete(NULL);
+}
+
+// Free a scan service, which must no longer be in the list.
+static void contextFree(uWifiScanContext_t *pContext)
+{
+    if (pContext->taskRunning) {
+        pContext->taskStop = true;
+        uPortSemaphoreGive(pContext->wakeSemaphoreHandle);
+        // Wait for the task to exit, which it will do once any
+        // scan in progress has finished
+        U_PORT_MUTEX_LOCK(pContext->taskRunningMutexHandle);
+        U_PORT_MUTEX_UNLOCK(pContext->taskRunningMutexHandle);
+        // Let it actually go
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+    }
+    if (pContext->eventQueueHandle >= 0) {
+        uPortEventQueueClose(pContext->eventQueueHandle);
+    }
+    if (pContext->taskRunningMutexHandle != NULL) {
+        uPortMutexDelete(pContext->taskRunningMutexHandle);
+    }
+    if (pContext->wakeSemaphoreHandle != NULL) {
+        uPortSemaphoreDelete(pContext->wakeSemaphoreHandle);
+    }
+    uPortFree(pContext);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Start the scan service.
+int32_t uWifiScanStart(uDeviceHandle_t devHandle, const uWifiScanCfg_t *pCfg)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uWifiScanContext_t *pContext;
+
+    if ((devHandle != NULL) && (pCfg != NULL) && (pCfg->periodMs >= 0) &&
+        (pCfg->expiryMs >= 0) &&
+        ((pCfg->pSsid == NULL) || (strlen(pCfg->pSsid) < U_WIFI_SSID_SIZE))) {
+        // Get rid of any existing service
+        uWifiScanStop(devHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (gMutex == NULL) {
+            errorCode = uPortMutexCreate(&gMutex);
+        }
+        if (errorCode == 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pContext = (uWifiScanContext_t *) pUPortMalloc(sizeof(*pContext));
+            if (pContext != NULL) {
+                memset(pContext, 0, sizeof(*pContext));
+                pContext->devHandle = devHandle;
+                pContext->cfg = *pCfg;
+                if (pCfg->pSsid != NULL) {
+                    strncpy(pContext->ssid, pCfg->pSsid, sizeof(pContext->ssid) - 1);
+                    pContext->cfg.pSsid = pContext->ssid;
+                }
+                if (pContext->cfg.expiryMs == 0) {
+                    pContext->cfg.expiryMs = U_WIFI_SCAN_EXPIRY_MS;
+                }
+                pContext->eventQueueHandle = -1;
+                errorCode = uPortSemaphoreCreate(&(pContext->wakeSemaphoreHandle), 0, 1);
+                if (errorCode == 0) {
+                    errorCode = uPortMutexCreate(&(pContext->taskRunningMutexHandle));
+                }
+                if ((errorCode == 0) &&
+                    ((pCfg->pResultCallback != NULL) || (pCfg->pDoneCallback != NULL))) {
+                    errorCode = uPortEventQueueOpen(eventHandler, "wifiScanCallback",
+                                                    sizeof(uWifiScanEvent_t),
+                                                    U_WIFI_SCAN_CALLBACK_STACK_SIZE_BYTES,
+                                                    U_WIFI_SCAN_CALLBACK_PRIORITY,
+                                                    U_WIFI_SCAN_CALLBACK_QUEUE_LENGTH);
+                    if (errorCode >= 0) {
+                        pContext->eventQueueHandle = errorCode;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+                if (errorCode == 0) {
+                    // In the list before the task starts so that the
+                    // first scan finds it
+                    U_PORT_MUTEX_LOCK(gMutex);
+                    pContext->pNext = gpContextList;
+                    gpContextList = pContext;
+                    U_PORT_MUTEX_UNLOCK(gMutex);
+                    errorCode = uPortTaskCreate(scanTask, "wifiScan",
+                                                U_WIFI_SCAN_TASK_STACK_SIZE_BYTES,
+                                                pContext, U_WIFI_SCAN_TASK_PRIORITY,
+                                                &(pContext->taskHandle));
+                    if (errorCode == 0) {
+                        // Wait for the task to be running so that
+                        // contextFree() can rely on taskRunningMutexHandle
+                        while (!pContext->taskRunning) {
+                            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                        }
+                        if (pContext->cfg.periodMs > 0) {
+                            uPortSemaphoreGive(pContext->wakeSemaphoreHandle);
+                        }
+                    } else {
+                        U_PORT_MUTEX_LOCK(gMutex);
+                        pContextRemove(devHandle);
+                        U_PORT_MUTEX_UNLOCK(gMutex);
+                    }
+                }
+                if (errorCode != 0) {
+                    contextFree(pContext);
+                }
+            }
+            if ((errorCode != 0) && (gpContextList == NULL)) {
+                uPortMutexDelete(gMutex);
+                gMutex = NULL;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Ask for a scan now.
+int32_t uWifiScanNow(uDeviceHandle_t devHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uWifiScanContext_t *pContext;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pContext = pContextGet(devHandle);
+        if (pContext != NULL) {
+            // The semaphore has a limit of one: that's the merging
+            uPortSemaphoreGive(pContext->wakeSemaphoreHandle);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the access points in the cache.
+int32_t uWifiScanGetResults(uDeviceHandle_t devHandle, int32_t maxAgeMs,
+                            uWifiScanEntry_t *pEntries, size_t maxNumEntries)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uWifiScanContext_t *pContext;
+    const uWifiScanCacheEntry_t *pCacheEntry;
+    size_t numEntries = 0;
+    size_t position;
+    int32_t ageMs;
+    int32_t rssi;
+    int32_t nowMs;
+
+    if ((pEntries == NULL) && (maxNumEntries > 0)) {
+        return (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pContext = pContextGet(devHandle);
+        if (pContext != NULL) {
+            errorCodeOrCount = 0;
+            nowMs = uPortGetTickTimeMs();
+            for (size_t x = 0; x < U_WIFI_SCAN_MAX_NUM_ENTRIES; x++) {
+                pCacheEntry = &(pContext->cache[x]);
+                ageMs = nowMs - pCacheEntry->lastSeenMs;
+                if (pCacheEntry->inUse && ((maxAgeMs < 0) || (ageMs <= maxAgeMs))) {
+                    errorCodeOrCount++;
+                    // Insertion sort, strongest first, keeping only
+                    // as many as will fit
+                    rssi = rssiDbm(pCacheEntry->rssiSmoothed);
+                    position = 0;
+                    while ((position < numEntries) &&
+                           (pEntries[position].rssiSmoothedDbm >= rssi)) {
+                        position++;
+                    }
+                    if (position < maxNumEntries) {
+                        if (numEntries == maxNumEntries) {
+                            numEntries--;
+                        }
+                        memmove(&(pEntries[position + 1]), &(pEntries[position]),
+                                (numEntries - position) * sizeof(*pEntries));
+                        pEntries[position].result = pCacheEntry->result;
+                        pEntries[position].rssiSmoothedDbm = rssi;
+                        pEntries[position].ageMs = ageMs;
+                        pEntries[position].numSightings = pCacheEntry->numSightings;
+                        numEntries++;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCodeOrCount;
+}
+
+// Get the channel statistics from the cache.
+int32_t uWifiScanGetChannelStats(uDeviceHandle_t devHandle, int32_t maxAgeMs,
+                                 uWifiScanChannelStats_t *pStats,
+                                 size_t maxNumStats)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uWifiScanContext_t *pContext;
+    const uWifiScanCacheEntry_t *pCacheEntry;
+    // There can't be more channels than entries in the cache
+    uWifiScanChannelStats_t stats[U_WIFI_SCAN_MAX_NUM_ENTRIES];
+    size_t numStats = 0;
+    size_t position;
+    int32_t channel;
+    int32_t rssi;
+    int32_t nowMs;
+
+    if ((pStats == NULL) && (maxNumStats > 0)) {
+        return (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pContext = pContextGet(devHandle);
+        if (pContext != NULL) {
+            nowMs = uPortGetTickTimeMs();
+            for (size_t x = 0; x < U_WIFI_SCAN_MAX_NUM_ENTRIES; x++) {
+                pCacheEntry = &(pContext->cache[x]);
+                if (pCacheEntry->inUse &&
+                    ((maxAgeMs < 0) || (nowMs - pCacheEntry->lastSeenMs <= maxAgeMs))) {
+                    channel = pCacheEntry->result.channel;
+                    rssi = rssiDbm(pCacheEntry->rssiSmoothed);
+                    position = 0;
+                    while ((position < numStats) && (stats[position].channel < channel)) {
+                        position++;
+                    }
+                    if ((position == numStats) || (stats[position].channel != channel)) {
+                        memmove(&(stats[position + 1]), &(stats[position]),
+                                (numStats - position) * sizeof(stats[0]));
+                        memset(&(stats[position]), 0, sizeof(stats[0]));
+                        stats[position].channel = channel;
+                        stats[position].strongestRssiDbm = rssi;
+                        numStats++;
+                    }
+                    stats[position].numAccessPoints++;
+                    if (rssi > stats[position].strongestRssiDbm) {
+                        stats[position].strongestRssiDbm = rssi;
+                    }
+                    // Sum for now, averaged below
+                    stats[position].averageRssiDbm += rssi;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (pContext != NULL) {
+            for (size_t x = 0; x < numStats; x++) {
+                stats[x].averageRssiDbm /= stats[x].numAccessPoints;
+                if (x < maxNumStats) {
+                    pStats[x] = stats[x];
+                }
+            }
+            errorCodeOrCount = (int32_t) numStats;
+        }
+    }
+
+    return errorCodeOrCount;
+}
+
+// Stop the scan service.
+void uWifiScanStop(uDeviceHandle_t devHandle)
+{
+    uWifiScanContext_t *pContext;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+        pContext = pContextRemove(devHandle);
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (pContext != NULL) {
+            // Out of the list, so any scan in progress will now
+            // leave it alone
+            contextFree(pContext);
+            if (gpContextList == NULL) {
+                uPortMutexDelete(gMutex);
+                gMutex = NULL;
+            }
+        }
+    }
+}
+
+// End of file
@@ -85,6 +85,7 @@ typedef struct {
                              -1 if this socket is not in use. */
     int32_t clientHandle;
     bool isClient;
+    bool accepted; /**< Set once returned by uWifiSockAccept(). */
     uDeviceHandle_t devHandle; /**< The u-blox device handle.
                              -1 if this socket is not in use. */
     int32_t connHandle; /**< The connection handle that the wifi module
@@ -146,8 +147,8 @@ static uPingContext_t gPingContext;
  * -------------------------------------------------------------- */
 
 /* Workaround for WiFi captive portal. Used to control the accept()
-   timeout for now. Will be removed once a full select() implementation
-   is available.
+   timeout for now, zero meaning do not wait. Will be removed once a
+   full select() implementation is available.
 */
 int32_t gUWifiSocketAcceptTimeoutS = -1;
 
@@ -161,6 +162,7 @@ static void freeSocket(uWifiSockSocket_t *pSock)
         pSock->sockHandle = -1;
         pSock->edmChannel = -1;
         pSock->isClient = false;
+        pSock->accepted = false;
         pSock->connected = false;
         if (pSock->semaphore != NULL) {
             uPortSemaphoreDelete(pSock->semaphore);
@@ -344,6 +346,27 @@ static uWifiSockSocket_t *pFindClientSocketByPort(uDeviceHandle_t devHandle,
     return NULL;
 }
 
+// As pFindClientSocketByPort() but only a client socket not yet
+// returned by uWifiSockAccept().
+static uWifiSockSocket_t *pFindNewClientSocketByPort(uDeviceHandle_t devHandle,
+                                                     int32_t port)
+{
+    uWifiSockSocket_t *pSock;
+
+    for (int32_t index = 0; index < U_WIFI_SOCK_MAX_NUM_SOCKETS; index++) {
+        pSock = &(gSockets[index]);
+        if (pSock->sockHandle == index &&
+            pSock->devHandle == devHandle &&
+            pSock->isClient &&
+            !pSock->accepted &&
+            pSock->localPort == port) {
+            return pSock;
+        }
+    }
+
+    return NULL;
+}
+
 static uWifiSockSocket_t *pFindOrCreateClientSocket(uDeviceHandle_t devHandle,
                                                     const uShortRangeConnectDataIp_t *pConnectData)
 {
@@ -379,6 +402,7 @@ static uWifiSockSocket_t *pFindOrCreateClientSocket(uDeviceHandle_t devHandle,
         if (sockHandle >= 0) {
             pSock = &(gSockets[sockHandle]);
             pSock->isClient = true;
+            pSock->accepted = false;
             pSock->localPort = localPort;
             pSock->remotePort = remotePort;
             uPortLog("U_WIFI_SOCK: Created client socket: %d - %d - %d\n", sockHandle, localPort, remotePort);
@@ -1759,14 +1783,19 @@ int32_t uWifiSockAccept(uDeviceHandle_t devHandle,
     int32_t startTimeMs = uPortGetTickTimeMs();
     while (true) {
         uShortRangeLock();
-        uWifiSockSocket_t *pClientSock = pFindClientSocketByPort(devHandle, pServerSock->localPort);
+        uWifiSockSocket_t *pClientSock = pFindNewClientSocketByPort(devHandle, pServerSock->localPort);
+        if (pClientSock) {
+            // So that a server with several clients gets each one once
+            pClientSock->accepted = true;
+        }
         uShortRangeUnlock();
         if (pClientSock) {
             *pRemoteAddress = pClientSock->remoteAddress;
             return pClientSock->sockHandle;
         } else if (gUWifiSocketAcceptTimeoutS >= 0) {
-            if ((uPortGetTickTimeMs() - startTimeMs) / 1000 >
-                gUWifiSocketAcceptTimeoutS) {
+            if ((gUWifiSocketAcceptTimeoutS == 0) ||
+                ((uPortGetTickTimeMs() - startTimeMs) / 1000 >
+                 gUWifiSocketAcceptTimeoutS)) {
                 return U_ERROR_COMMON_TIMEOUT;
             }
         }
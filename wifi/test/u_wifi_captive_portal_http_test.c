@@ -0,0 +1,1136 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the HTTP engine of the WiFi captive portal: these
+ * should pass on all platforms.  No WiFi module is needed: the
+ * engine is run over an in-process loopback which stands in for TCP
+ * sockets, the test acting as the clients.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdlib.h"    // qsort(), atoi()
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memcmp()/memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_device.h"
+
+#include "u_sock_errno.h"
+
+#include "u_wifi_captive_portal.h"
+#include "u_wifi_captive_portal_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_WIFI_CAPTIVE_PORTAL_HTTP_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The number of connections the loopback can carry: more than the
+ * HTTP engine will serve, so that turning one away can be tested.
+ */
+#define U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_NUM_CONNECTIONS \
+    (U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS + 2)
+
+#ifndef U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_BUFFER_LENGTH_BYTES
+/** The number of bytes that the loopback can hold in each direction
+ * of a connection.
+ */
+# define U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_BUFFER_LENGTH_BYTES 4096
+#endif
+
+#ifndef U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_TASK_STACK_SIZE_BYTES
+/** The stack size of the tasks that run the HTTP engine and the
+ * clients of the load test.
+ */
+# define U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_TASK_STACK_SIZE_BYTES (1024 * 4)
+#endif
+
+#ifndef U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_TASK_PRIORITY
+/** The priority of the tasks that run the HTTP engine and the
+ * clients of the load test.
+ */
+# define U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_TASK_PRIORITY (U_CFG_OS_PRIORITY_MIN + 2)
+#endif
+
+#ifndef U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_RESPONSE_TIMEOUT_MS
+/** How long to wait for a response from the HTTP engine.
+ */
+# define U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_RESPONSE_TIMEOUT_MS 2000
+#endif
+
+#ifndef U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_LOAD_NUM_REQUESTS
+/** The number of requests that each client of the load test makes,
+ * all on one keep-alive connection.
+ */
+# define U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_LOAD_NUM_REQUESTS 500
+#endif
+
+#ifndef U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_LOAD_MAX_P90_MS
+/** The 90th percentile request latency above which the load test
+ * fails: a request should never wait for the poll interval of the
+ * engine, let alone the fixed read delay it used to pay.
+ */
+# define U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_LOAD_MAX_P90_MS (U_WIFI_CAPTIVE_PORTAL_HTTP_POLL_MS / 2)
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Bytes in one direction of a loopback connection.
+ */
+typedef struct {
+    char data[U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_BUFFER_LENGTH_BYTES];
+    size_t length;
+} uWifiCaptivePortalHttpTestStream_t;
+
+/** A connection in the loopback.
+ */
+typedef struct {
+    bool inUse;
+    bool pending;       /**< connected but not yet accepted. */
+    bool clientClosed;
+    bool serverClosed;
+    uWifiCaptivePortalHttpTestStream_t toServer;
+    uWifiCaptivePortalHttpTestStream_t toClient;
+    uPortSemaphoreHandle_t clientSemaphoreHandle;
+    void (*pCallback)(void *);
+    void *pCallbackParam;
+} uWifiCaptivePortalHttpTestConnection_t;
+
+/** The loopback: handle 0 is the listening socket, a connection
+ * has its index plus one as its handle.
+ */
+typedef struct {
+    uPortMutexHandle_t mutexHandle;
+    bool listening;
+    void (*pListenCallback)(void *);
+    void *pListenCallbackParam;
+    uWifiCaptivePortalHttpTestConnection_t
+    connection[U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_NUM_CONNECTIONS];
+} uWifiCaptivePortalHttpTestLoopback_t;
+
+/** A response from the HTTP engine, decoded.
+ */
+typedef struct {
+    int32_t status;
+    int32_t contentLength;
+    bool keepAlive;
+    char contentType[32];
+    char body[1024];
+    size_t bodyLength;
+} uWifiCaptivePortalHttpTestResponse_t;
+
+/** A client of the load test.
+ */
+typedef struct {
+    size_t index;
+    int32_t *pLatencyMs;   /**< room for
+                                #U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_LOAD_NUM_REQUESTS. */
+    size_t numGood;
+    volatile bool done;
+} uWifiCaptivePortalHttpTestClient_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The loopback.
+ */
+static uWifiCaptivePortalHttpTestLoopback_t *gpLoopback = NULL;
+
+/** Flag to keep the HTTP engine going.
+ */
+static volatile bool gKeepGoing = false;
+
+/** Set when the task running the HTTP engine has exited.
+ */
+static volatile bool gServerExited = true;
+
+/** The value the HTTP engine returned.
+ */
+static volatile int32_t gServerErrorCode = 0;
+
+/** Static content served by the tests.
+ */
+static const char gIndex[] = "<html>index</html>";
+
+/** A larger piece of static content, bigger than the response
+ * buffer of the engine, filled in by the test.
+ */
+static char gLarge[U_WIFI_CAPTIVE_PORTAL_HTTP_RESPONSE_MAX_LENGTH_BYTES + 500];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: ROUTE HANDLERS
+ * -------------------------------------------------------------- */
+
+// Handler which echoes what it was given.
+static int32_t handleEcho(const uWifiCaptivePortalHttpRequest_t *pRequest,
+                          char *pBody, size_t bodySize,
+                          size_t *pBodyLength,
+                          const char **ppContentType,
+                          void *pParam)
+{
+    *ppContentType = "text/plain";
+    *pBodyLength = snprintf(pBody, bodySize, "%s %s %s %d %s %s",
+                            pRequest->pMethod, pRequest->pPath, pRequest->pQuery,
+                            (int) pRequest->bodyLength, pRequest->pBody,
+                            (const char *) pParam);
+    return 200;
+}
+
+// Handler which creates nothing.
+static int32_t handleNoContent(const uWifiCaptivePortalHttpRequest_t *pRequest,
+                               char *pBody, size_t bodySize,
+                               size_t *pBodyLength,
+                               const char **ppContentType,
+                               void *pParam)
+{
+    (void) pRequest;
+    (void) pBody;
+    (void) bodySize;
+    (void) pBodyLength;
+    (void) ppContentType;
+    (void) pParam;
+    return 204;
+}
+
+/** The routes the HTTP engine is tested with.
+ */
+static const uWifiCaptivePortalHttpRoute_t gRoutes[] = {
+    {.pMethod = "GET", .pPath = "/", .pContentType = "text/html",
+     .pContent = gIndex, .contentLength = sizeof(gIndex) - 1},
+    {.pMethod = "GET", .pPath = "/large", .pContentType = "application/octet-stream",
+     .pContent = gLarge, .contentLength = sizeof(gLarge)},
+    {.pMethod = "POST", .pPath = "/form", .pHandler = handleEcho,
+     .pHandlerParam = "form"},
+    {.pMethod = "PUT", .pPath = "/form", .pHandler = handleNoContent},
+    {.pMethod = "GET", .pPath = "/echo/*", .pHandler = handleEcho,
+     .pHandlerParam = "prefix"}
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE LOOPBACK
+ * -------------------------------------------------------------- */
+
+// Get the connection for a handle, NULL if there is none; the
+// loopback must be locked.
+static uWifiCaptivePortalHttpTestConnection_t *pConnectionGet(int32_t handle)
+{
+    uWifiCaptivePortalHttpTestConnection_t *pConnection = NULL;
+
+    if ((handle > 0) && (handle <= U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_NUM_CONNECTIONS) &&
+        gpLoopback->connection[handle - 1].inUse) {
+        pConnection = &(gpLoopback->connection[handle - 1]);
+    }
+
+    return pConnection;
+}
+
+// Append to a stream, returning false if there is no room; the
+// loopback must be locked.
+static bool streamPush(uWifiCaptivePortalHttpTestStream_t *pStream,
+                       const void *pData, size_t length)
+{
+    bool success = false;
+
+    if (pStream->length + length <= sizeof(pStream->data)) {
+        memcpy(pStream->data + pStream->length, pData, length);
+        pStream->length += length;
+        success = true;
+    }
+
+    return success;
+}
+
+// Take from the start of a stream, returning the number of bytes
+// taken; the loopback must be locked.
+static size_t streamPop(uWifiCaptivePortalHttpTestStream_t *pStream,
+                        void *pData, size_t size)
+{
+    if (size > pStream->length) {
+        size = pStream->length;
+    }
+    memcpy(pData, pStream->data, size);
+    pStream->length -= size;
+    memmove(pStream->data, pStream->data + size, pStream->length);
+
+    return size;
+}
+
+// Listen on the loopback, the HTTP engine end.
+static int32_t loopbackListen(void *pContext, uint16_t port, size_t backlog,
+                              void (*pCallback)(void *), void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_BUSY;
+    uWifiCaptivePortalHttpTestLoopback_t *pLoopback;
+
+    pLoopback = (uWifiCaptivePortalHttpTestLoopback_t *) pContext;
+    (void) backlog;
+    U_PORT_MUTEX_LOCK(pLoopback->mutexHandle);
+    if ((port == U_WIFI_CAPTIVE_PORTAL_PRIVATE_HTTP_PORT) && !pLoopback->listening) {
+        pLoopback->listening = true;
+        pLoopback->pListenCallback = pCallback;
+        pLoopback->pListenCallbackParam = pCallbackParam;
+        errorCode = 0;
+    }
+    U_PORT_MUTEX_UNLOCK(pLoopback->mutexHandle);
+
+    return errorCode;
+}
+
+// Accept a connection on the loopback, the HTTP engine end.
+static int32_t loopbackAccept(void *pContext, int32_t listenHandle,
+                              void (*pCallback)(void *), void *pCallbackParam)
+{
+    int32_t handle = -U_SOCK_EWOULDBLOCK;
+    uWifiCaptivePortalHttpTestLoopback_t *pLoopback;
+    uWifiCaptivePortalHttpTestConnection_t *pConnection;
+
+    pLoopback = (uWifiCaptivePortalHttpTestLoopback_t *) pContext;
+    (void) listenHandle;
+    U_PORT_MUTEX_LOCK(pLoopback->mutexHandle);
+    for (size_t x = 0; (x < U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_NUM_CONNECTIONS) && (handle < 0); x++) {
+        pConnection = &(pLoopback->connection[x]);
+        if (pConnection->inUse && pConnection->pending) {
+            pConnection->pending = false;
+            pConnection->pCallback = pCallback;
+            pConnection->pCallbackParam = pCallbackParam;
+            handle = (int32_t) x + 1;
+        }
+    }
+    U_PORT_MUTEX_UNLOCK(pLoopback->mutexHandle);
+
+    return handle;
+}
+
+// Read from the loopback, the HTTP engine end.
+static int32_t loopbackRead(void *pContext, int32_t handle,
+                            void *pData, size_t dataSizeBytes)
+{
+    int32_t sizeOrError = -U_SOCK_ENOTCONN;
+    uWifiCaptivePortalHttpTestLoopback_t *pLoopback;
+    uWifiCaptivePortalHttpTestConnection_t *pConnection;
+
+    pLoopback = (uWifiCaptivePortalHttpTestLoopback_t *) pContext;
+    U_PORT_MUTEX_LOCK(pLoopback->mutexHandle);
+    pConnection = pConnectionGet(handle);
+    if ((pConnection != NULL) && !pConnection->serverClosed) {
+        if (pConnection->toServer.length > 0) {
+            sizeOrError = (int32_t) streamPop(&(pConnection->toServer), pData, dataSizeBytes);
+        } else if (!pConnection->clientClosed) {
+            sizeOrError = -U_SOCK_EWOULDBLOCK;
+        }
+    }
+    U_PORT_MUTEX_UNLOCK(pLoopback->mutexHandle);
+
+    return sizeOrError;
+}
+
+// Write to the loopback, the HTTP engine end.
+static int32_t loopbackWrite(void *pContext, int32_t handle,
+                             const void *pData, size_t dataSizeBytes)
+{
+    int32_t sizeOrError = -U_SOCK_ENOTCONN;
+    uWifiCaptivePortalHttpTestLoopback_t *pLoopback;
+    uWifiCaptivePortalHttpTestConnection_t *pConnection;
+
+    pLoopback = (uWifiCaptivePortalHttpTestLoopback_t *) pContext;
+    U_PORT_MUTEX_LOCK(pLoopback->mutexHandle);
+    pConnection = pConnectionGet(handle);
+    if ((pConnection != NULL) && !pConnection->serverClosed && !pConnection->clientClosed) {
+        sizeOrError = -U_SOCK_ENOBUFS;
+        if (streamPush(&(pConnection->toClient), pData, dataSizeBytes)) {
+            sizeOrError = (int32_t) dataSizeBytes;
+        }
+        uPortSemaphoreGive(pConnection->clientSemaphoreHandle);
+    }
+    U_PORT_MUTEX_UNLOCK(pLoopback->mutexHandle);
+
+    return sizeOrError;
+}
+
+// Free a connection once both ends are closed; the loopback must
+// be locked.
+static void connectionFreeIfClosed(uWifiCaptivePortalHttpTestConnection_t *pConnection)
+{
+    if (pConnection->clientClosed && pConnection->serverClosed) {
+        pConnection->inUse = false;
+    }
+}
+
+// Close a connection or the listening socket of the loopback, the
+// HTTP engine end.
+static int32_t loopbackClose(void *pContext, int32_t handle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uWifiCaptivePortalHttpTestLoopback_t *pLoopback;
+    uWifiCaptivePortalHttpTestConnection_t *pConnection;
+
+    pLoopback = (uWifiCaptivePortalHttpTestLoopback_t *) pContext;
+    U_PORT_MUTEX_LOCK(pLoopback->mutexHandle);
+    if (handle == 0) {
+        pLoopback->listening = false;
+        pLoopback->pListenCallback = NULL;
+        errorCode = 0;
+    } else {
+        pConnection = pConnectionGet(handle);
+        if ((pConnection != NULL) && !pConnection->serverClosed) {
+            pConnection->serverClosed = true;
+            pConnection->pCallback = NULL;
+            uPortSemaphoreGive(pConnection->clientSemaphoreHandle);
+            connectionFreeIfClosed(pConnection);
+            errorCode = 0;
+        }
+    }
+    U_PORT_MUTEX_UNLOCK(pLoopback->mutexHandle);
+
+    return errorCode;
+}
+
+/** The loopback as the sockets of the HTTP engine.
+ */
+static const uWifiCaptivePortalPrivateSock_t gLoopbackSock = {
+    .pListen = loopbackListen,
+    .pAccept = loopbackAccept,
+    .pRead = loopbackRead,
+    .pWrite = loopbackWrite,
+    .pClose = loopbackClose
+};
+
+// Connect to the HTTP engine, returning the index of the
+// connection, else negative.
+static int32_t clientConnect()
+{
+    int32_t index = -1;
+    uWifiCaptivePortalHttpTestConnection_t *pConnection;
+    void (*pCallback)(void *) = NULL;
+    void *pCallbackParam = NULL;
+
+    U_PORT_MUTEX_LOCK(gpLoopback->mutexHandle);
+    for (size_t x = 0; (x < U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_NUM_CONNECTIONS) && (index < 0); x++) {
+        pConnection = &(gpLoopback->connection[x]);
+        if (!pConnection->inUse && gpLoopback->listening) {
+            pConnection->inUse = true;
+            pConnection->pending = true;
+            pConnection->clientClosed = false;
+            pConnection->serverClosed = false;
+            pConnection->toServer.length = 0;
+            pConnection->toClient.length = 0;
+            pConnection->pCallback = NULL;
+            // Lose any give left over from a previous use
+            uPortSemaphoreTryTake(pConnection->clientSemaphoreHandle, 0);
+            pCallback = gpLoopback->pListenCallback;
+            pCallbackParam = gpLoopback->pListenCallbackParam;
+            index = (int32_t) x;
+        }
+    }
+    U_PORT_MUTEX_UNLOCK(gpLoopback->mutexHandle);
+    if (pCallback != NULL) {
+        pCallback(pCallbackParam);
+    }
+
+    return index;
+}
+
+// Send to the HTTP engine, calling the data callback as a socket
+// would.
+static bool clientSend(int32_t index, const char *pData, size_t length)
+{
+    bool success;
+    uWifiCaptivePortalHttpTestConnection_t *pConnection = &(gpLoopback->connection[index]);
+    void (*pCallback)(void *);
+    void *pCallbackParam;
+
+    U_PORT_MUTEX_LOCK(gpLoopback->mutexHandle);
+    success = !pConnection->serverClosed &&
+              streamPush(&(pConnection->toServer), pData, length);
+    pCallback = pConnection->pCallback;
+    pCallbackParam = pConnection->pCallbackParam;
+    U_PORT_MUTEX_UNLOCK(gpLoopback->mutexHandle);
+    if (success && (pCallback != NULL)) {
+        pCallback(pCallbackParam);
+    }
+
+    return success;
+}
+
+// Send a string to the HTTP engine.
+static bool clientSendString(int32_t index, const char *pString)
+{
+    return clientSend(index, pString, strlen(pString));
+}
+
+// Receive from the HTTP engine, waiting up to timeoutMs for
+// something to arrive; returns the number of bytes received,
+// -U_SOCK_EWOULDBLOCK on timeout or -U_SOCK_ENOTCONN if the
+// HTTP engine has closed the connection and there is nothing
+// more to read.
+static int32_t clientReceive(int32_t index, char *pData, size_t size,
+                             int32_t timeoutMs)
+{
+    int32_t sizeOrError;
+    uWifiCaptivePortalHttpTestConnection_t *pConnection = &(gpLoopback->connection[index]);
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    do {
+        sizeOrError = -U_SOCK_EWOULDBLOCK;
+        U_PORT_MUTEX_LOCK(gpLoopback->mutexHandle);
+        if (pConnection->toClient.length > 0) {
+            sizeOrError = (int32_t) streamPop(&(pConnection->toClient), pData, size);
+        } else if (pConnection->serverClosed) {
+            sizeOrError = -U_SOCK_ENOTCONN;
+        }
+        U_PORT_MUTEX_UNLOCK(gpLoopback->mutexHandle);
+        if (sizeOrError == -U_SOCK_EWOULDBLOCK) {
+            uPortSemaphoreTryTake(pConnection->clientSemaphoreHandle, 10);
+        }
+    } while ((sizeOrError == -U_SOCK_EWOULDBLOCK) &&
+             (uPortGetTickTimeMs() - startTimeMs < timeoutMs));
+
+    return sizeOrError;
+}
+
+// Close a connection, the client end.
+static void clientClose(int32_t index)
+{
+    uWifiCaptivePortalHttpTestConnection_t *pConnection = &(gpLoopback->connection[index]);
+    void (*pCallback)(void *);
+    void *pCallbackParam;
+
+    U_PORT_MUTEX_LOCK(gpLoopback->mutexHandle);
+    pConnection->clientClosed = true;
+    pCallback = pConnection->pCallback;
+    pCallbackParam = pConnection->pCallbackParam;
+    if (pConnection->pending) {
+        // Never accepted, just forget it
+        pConnection->serverClosed = true;
+        pConnection->pending = false;
+    }
+    connectionFreeIfClosed(pConnection);
+    U_PORT_MUTEX_UNLOCK(gpLoopback->mutexHandle);
+    if (pCallback != NULL) {
+        pCallback(pCallbackParam);
+    }
+}
+
+// Create the loopback.
+static bool loopbackCreate()
+{
+    bool success = false;
+
+    gpLoopback = (uWifiCaptivePortalHttpTestLoopback_t *) pUPortMalloc(sizeof(*gpLoopback));
+    if (gpLoopback != NULL) {
+        memset(gpLoopback, 0, sizeof(*gpLoopback));
+        if (uPortMutexCreate(&(gpLoopback->mutexHandle)) == 0) {
+            success = true;
+            for (size_t x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_NUM_CONNECTIONS; x++) {
+                if (uPortSemaphoreCreate(&(gpLoopback->connection[x].clientSemaphoreHandle),
+                                         0, 1) != 0) {
+                    success = false;
+                }
+            }
+            if (!success) {
+                for (size_t x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_NUM_CONNECTIONS; x++) {
+                    if (gpLoopback->connection[x].clientSemaphoreHandle != NULL) {
+                        uPortSemaphoreDelete(gpLoopback->connection[x].clientSemaphoreHandle);
+                    }
+                }
+                uPortMutexDelete(gpLoopback->mutexHandle);
+            }
+        }
+        if (!success) {
+            uPortFree(gpLoopback);
+            gpLoopback = NULL;
+        }
+    }
+
+    return success;
+}
+
+// Delete the loopback.
+static void loopbackDelete()
+{
+    if (gpLoopback != NULL) {
+        for (size_t x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_NUM_CONNECTIONS; x++) {
+            uPortSemaphoreDelete(gpLoopback->connection[x].clientSemaphoreHandle);
+        }
+        uPortMutexDelete(gpLoopback->mutexHandle);
+        uPortFree(gpLoopback);
+        gpLoopback = NULL;
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: THE HTTP ENGINE
+ * -------------------------------------------------------------- */
+
+// The keep-going callback of the HTTP engine.
+static bool keepGoingCallback(uDeviceHandle_t deviceHandle)
+{
+    (void) deviceHandle;
+    return gKeepGoing;
+}
+
+// The task that runs the HTTP engine.
+static void serverTask(void *pParameters)
+{
+    (void) pParameters;
+    gServerErrorCode = uWifiCaptivePortalPrivateHttpRun(&gLoopbackSock, gpLoopback, NULL,
+                                                        gRoutes,
+                                                        sizeof(gRoutes) / sizeof(gRoutes[0]),
+                                                        keepGoingCallback);
+    gServerExited = true;
+    uPortTaskDelete(NULL);
+}
+
+// Start the HTTP engine on the loopback, waiting until it listens.
+static bool serverStart()
+{
+    uPortTaskHandle_t taskHandle;
+    bool listening = false;
+
+    gKeepGoing = true;
+    gServerExited = false;
+    if (uPortTaskCreate(serverTask, "httpTest",
+                        U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_TASK_STACK_SIZE_BYTES,
+                        NULL, U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_TASK_PRIORITY,
+                        &taskHandle) == 0) {
+        for (size_t x = 0; (x < 100) && !listening && !gServerExited; x++) {
+            uPortTaskBlock(10);
+            U_PORT_MUTEX_LOCK(gpLoopback->mutexHandle);
+            listening = gpLoopback->listening;
+            U_PORT_MUTEX_UNLOCK(gpLoopback->mutexHandle);
+        }
+    } else {
+        gServerExited = true;
+    }
+
+    return listening;
+}
+
+// Stop the HTTP engine and wait for its task to exit.
+static void serverStop()
+{
+    gKeepGoing = false;
+    while (!gServerExited) {
+        uPortTaskBlock(10);
+    }
+    // Let the task be deleted
+    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: HTTP
+ * -------------------------------------------------------------- */
+
+// Find a header field in a response header, returning a pointer
+// to its value or NULL.
+static const char *pFindField(const char *pHeader, const char *pName)
+{
+    const char *pLine = strstr(pHeader, "\r\n");
+    size_t length = strlen(pName);
+
+    while ((pLine != NULL) && (pLine[2] != '\r')) {
+        pLine += 2;
+        if ((strncmp(pLine, pName, length) == 0) && (pLine[length] == ':')) {
+            pLine += length + 1;
+            while (*pLine == ' ') {
+                pLine++;
+            }
+            return pLine;
+        }
+        pLine = strstr(pLine, "\r\n");
+    }
+
+    return NULL;
+}
+
+// Read one response from the HTTP engine; a response to HEAD is
+// expected to have no body, whatever its Content-Length.
+static bool readResponse(int32_t index, bool head,
+                         uWifiCaptivePortalHttpTestResponse_t *pResponse)
+{
+    char header[512];
+    char discard[64];
+    size_t length = 0;
+    size_t remaining;
+    const char *pValue;
+    const char *pEnd = NULL;
+    size_t expected;
+    int32_t size = 0;
+
+    memset(pResponse, 0, sizeof(*pResponse));
+    // A byte at a time until the end of the header, so that
+    // nothing of a following response is taken
+    while ((pEnd == NULL) && (length < sizeof(header) - 1)) {
+        size = clientReceive(index, header + length, 1,
+                             U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_RESPONSE_TIMEOUT_MS);
+        if (size <= 0) {
+            return false;
+        }
+        length++;
+        header[length] = 0;
+        if (length >= 4) {
+            pEnd = strstr(header + length - 4, "\r\n\r\n");
+        }
+    }
+    if ((pEnd == NULL) || (strncmp(header, "HTTP/1.1 ", 9) != 0)) {
+        return false;
+    }
+    pResponse->status = atoi(header + 9);
+    pValue = pFindField(header, "Content-Length");
+    if (pValue == NULL) {
+        return false;
+    }
+    pResponse->contentLength = atoi(pValue);
+    pValue = pFindField(header, "Connection");
+    pResponse->keepAlive = (pValue != NULL) && (strncmp(pValue, "keep-alive", 10) == 0);
+    pValue = pFindField(header, "Content-Type");
+    if (pValue != NULL) {
+        for (size_t x = 0; (x < sizeof(pResponse->contentType) - 1) && (pValue[x] != '\r'); x++) {
+            pResponse->contentType[x] = pValue[x];
+        }
+    }
+    expected = head ? 0 : (size_t) pResponse->contentLength;
+    while (pResponse->bodyLength < expected) {
+        remaining = expected - pResponse->bodyLength;
+        if (pResponse->bodyLength >= sizeof(pResponse->body) - 1) {
+            // Too big to keep, count it but throw it away
+            size = clientReceive(index, discard,
+                                 (remaining < sizeof(discard)) ? remaining : sizeof(discard),
+                                 U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_RESPONSE_TIMEOUT_MS);
+        } else {
+            if (remaining > sizeof(pResponse->body) - 1 - pResponse->bodyLength) {
+                remaining = sizeof(pResponse->body) - 1 - pResponse->bodyLength;
+            }
+            size = clientReceive(index, pResponse->body + pResponse->bodyLength,
+                                 remaining, U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_RESPONSE_TIMEOUT_MS);
+        }
+        if (size <= 0) {
+            return false;
+        }
+        pResponse->bodyLength += size;
+    }
+    if (pResponse->bodyLength < sizeof(pResponse->body)) {
+        pResponse->body[pResponse->bodyLength] = 0;
+    }
+
+    return true;
+}
+
+// Send a request and read the response.
+static bool request(int32_t index, const char *pRequest,
+                    uWifiCaptivePortalHttpTestResponse_t *pResponse)
+{
+    return clientSendString(index, pRequest) &&
+           readResponse(index, strncmp(pRequest, "HEAD ", 5) == 0, pResponse);
+}
+
+// Check that the HTTP engine has closed a connection, then close
+// the client end.
+static bool closedByServer(int32_t index)
+{
+    char c;
+    bool closed = (clientReceive(index, &c, 1,
+                                 U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_RESPONSE_TIMEOUT_MS) ==
+                   -U_SOCK_ENOTCONN);
+    clientClose(index);
+    return closed;
+}
+
+// Compare two latencies for qsort().
+static int compareLatency(const void *pA, const void *pB)
+{
+    return (int) (*((const int32_t *) pA) - *((const int32_t *) pB));
+}
+
+// A client of the load test: keep-alive requests on one connection,
+// a mix of static content and form posts.
+static void clientTask(void *pParameters)
+{
+    uWifiCaptivePortalHttpTestClient_t *pClient;
+    uWifiCaptivePortalHttpTestResponse_t *pResponse;
+    char buffer[128];
+    char expected[128];
+    int32_t index;
+    int32_t startTimeMs;
+    bool good;
+
+    pClient = (uWifiCaptivePortalHttpTestClient_t *) pParameters;
+    pResponse = (uWifiCaptivePortalHttpTestResponse_t *) pUPortMalloc(sizeof(*pResponse));
+    index = clientConnect();
+    for (size_t x = 0; (pResponse != NULL) && (index >= 0) &&
+         (x < U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_LOAD_NUM_REQUESTS); x++) {
+        startTimeMs = uPortGetTickTimeMs();
+        if ((x % 3) == 2) {
+            snprintf(expected, sizeof(expected), "client=%d&request=%d",
+                     (int) pClient->index, (int) x);
+            snprintf(buffer, sizeof(buffer), "POST /form HTTP/1.1\r\n"
+                     "Host: 8.8.8.8\r\n"
+                     "Content-Length: %d\r\n\r\n%s", (int) strlen(expected), expected);
+            good = request(index, buffer, pResponse);
+            snprintf(buffer, sizeof(buffer), "POST /form  %d %s form",
+                     (int) strlen(expected), expected);
+            good = good && (pResponse->status == 200) && (strcmp(pResponse->body, buffer) == 0);
+        } else {
+            good = request(index, "GET / HTTP/1.1\r\nHost: 8.8.8.8\r\n\r\n", pResponse) &&
+                   (pResponse->status == 200) && (strcmp(pResponse->body, gIndex) == 0);
+        }
+        pClient->pLatencyMs[x] = uPortGetTickTimeMs() - startTimeMs;
+        if (good && pResponse->keepAlive) {
+            pClient->numGood++;
+        }
+    }
+    if (index >= 0) {
+        clientClose(index);
+    }
+    uPortFree(pResponse);
+    pClient->done = true;
+    uPortTaskDelete(NULL);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test the HTTP engine of the captive portal: routing, framing,
+ * keep-alive, pipelining and the rejection of what it cannot handle.
+ *
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the
+ * U_PORT_TEST_FUNCTION() macro.
+ */
+U_PORT_TEST_FUNCTION("[wifiCaptivePortalHttp]", "wifiCaptivePortalHttpRoutes")
+{
+    int32_t resourceCount;
+    uWifiCaptivePortalHttpTestResponse_t *pResponse;
+    int32_t index[U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS + 1];
+    char buffer[U_WIFI_CAPTIVE_PORTAL_HTTP_REQUEST_MAX_LENGTH_BYTES + 64];
+    int32_t startTimeMs;
+    int32_t x;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(loopbackCreate());
+    pResponse = (uWifiCaptivePortalHttpTestResponse_t *) pUPortMalloc(sizeof(*pResponse));
+    U_PORT_TEST_ASSERT(pResponse != NULL);
+    for (size_t y = 0; y < sizeof(gLarge); y++) {
+        gLarge[y] = (char) ('a' + (y % 26));
+    }
+    U_PORT_TEST_ASSERT(serverStart());
+
+    U_TEST_PRINT_LINE("static content, keep-alive and HEAD.");
+    index[0] = clientConnect();
+    U_PORT_TEST_ASSERT(index[0] >= 0);
+    U_PORT_TEST_ASSERT(request(index[0], "GET / HTTP/1.1\r\nHost: 8.8.8.8\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 200);
+    U_PORT_TEST_ASSERT(pResponse->keepAlive);
+    U_PORT_TEST_ASSERT(strcmp(pResponse->contentType, "text/html") == 0);
+    U_PORT_TEST_ASSERT(strcmp(pResponse->body, gIndex) == 0);
+    U_PORT_TEST_ASSERT(request(index[0], "HEAD / HTTP/1.1\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 200);
+    U_PORT_TEST_ASSERT(pResponse->contentLength == sizeof(gIndex) - 1);
+    // Content larger than the response buffer of the engine
+    U_PORT_TEST_ASSERT(request(index[0], "GET /large HTTP/1.1\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 200);
+    U_PORT_TEST_ASSERT(pResponse->contentLength == sizeof(gLarge));
+    U_PORT_TEST_ASSERT(pResponse->bodyLength == sizeof(gLarge));
+    U_PORT_TEST_ASSERT(memcmp(pResponse->body, gLarge, sizeof(pResponse->body) - 1) == 0);
+    // Not found, which keeps the connection
+    U_PORT_TEST_ASSERT(request(index[0], "GET /nothing HTTP/1.1\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 404);
+    U_PORT_TEST_ASSERT(pResponse->keepAlive);
+    U_PORT_TEST_ASSERT(request(index[0], "DELETE / HTTP/1.1\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 404);
+
+    U_TEST_PRINT_LINE("handlers, queries, bodies and prefixes.");
+    U_PORT_TEST_ASSERT(request(index[0], "POST /form?a=b HTTP/1.1\r\n"
+                               "content-length: 9\r\n\r\nssid=1234", pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 200);
+    U_PORT_TEST_ASSERT(strcmp(pResponse->contentType, "text/plain") == 0);
+    U_PORT_TEST_ASSERT(strcmp(pResponse->body, "POST /form a=b 9 ssid=1234 form") == 0);
+    U_PORT_TEST_ASSERT(request(index[0], "PUT /form HTTP/1.1\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 204);
+    U_PORT_TEST_ASSERT(pResponse->contentLength == 0);
+    U_PORT_TEST_ASSERT(request(index[0], "GET /echo/x/y HTTP/1.1\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT(strcmp(pResponse->body, "GET /echo/x/y  0  prefix") == 0);
+    // A request arriving in pieces, the body some while after the
+    // header, is answered once it is all there
+    U_PORT_TEST_ASSERT(clientSendString(index[0], "POST /fo"));
+    uPortTaskBlock(20);
+    U_PORT_TEST_ASSERT(clientSendString(index[0], "rm HTTP/1.1\r\nContent-Length: 5\r\n\r\nab"));
+    U_PORT_TEST_ASSERT(clientReceive(index[0], buffer, 1, 50) == -U_SOCK_EWOULDBLOCK);
+    U_PORT_TEST_ASSERT(clientSendString(index[0], "cde"));
+    U_PORT_TEST_ASSERT(readResponse(index[0], false, pResponse));
+    U_PORT_TEST_ASSERT(strcmp(pResponse->body, "POST /form  5 abcde form") == 0);
+
+    U_TEST_PRINT_LINE("pipelining.");
+    U_PORT_TEST_ASSERT(clientSendString(index[0], "GET /echo/1 HTTP/1.1\r\n\r\n"
+                                        "POST /form HTTP/1.1\r\nContent-Length: 3\r\n\r\nxyz"
+                                        "HEAD / HTTP/1.1\r\n\r\n"
+                                        "GET /echo/3 HTTP/1.1\r\n\r\n"));
+    U_PORT_TEST_ASSERT(readResponse(index[0], false, pResponse));
+    U_PORT_TEST_ASSERT(strcmp(pResponse->body, "GET /echo/1  0  prefix") == 0);
+    U_PORT_TEST_ASSERT(readResponse(index[0], false, pResponse));
+    U_PORT_TEST_ASSERT(strcmp(pResponse->body, "POST /form  3 xyz form") == 0);
+    U_PORT_TEST_ASSERT(readResponse(index[0], true, pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 200);
+    U_PORT_TEST_ASSERT(readResponse(index[0], false, pResponse));
+    U_PORT_TEST_ASSERT(strcmp(pResponse->body, "GET /echo/3  0  prefix") == 0);
+    clientClose(index[0]);
+
+    U_TEST_PRINT_LINE("closing connections.");
+    // HTTP/1.0 is closed unless kept alive, HTTP/1.1 is kept alive
+    // unless closed
+    index[0] = clientConnect();
+    U_PORT_TEST_ASSERT(request(index[0], "GET / HTTP/1.0\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT((pResponse->status == 200) && !pResponse->keepAlive);
+    U_PORT_TEST_ASSERT(closedByServer(index[0]));
+    index[0] = clientConnect();
+    U_PORT_TEST_ASSERT(request(index[0], "GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n",
+                               pResponse));
+    U_PORT_TEST_ASSERT((pResponse->status == 200) && pResponse->keepAlive);
+    U_PORT_TEST_ASSERT(request(index[0], "GET / HTTP/1.1\r\nConnection: TE, close\r\n\r\n",
+                               pResponse));
+    U_PORT_TEST_ASSERT((pResponse->status == 200) && !pResponse->keepAlive);
+    U_PORT_TEST_ASSERT(closedByServer(index[0]));
+
+    U_TEST_PRINT_LINE("bad requests.");
+    index[0] = clientConnect();
+    U_PORT_TEST_ASSERT(request(index[0], "GET\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT((pResponse->status == 400) && !pResponse->keepAlive);
+    U_PORT_TEST_ASSERT(closedByServer(index[0]));
+    index[0] = clientConnect();
+    U_PORT_TEST_ASSERT(request(index[0], "GET / HTTP/1.1\r\nNo colon\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 400);
+    U_PORT_TEST_ASSERT(closedByServer(index[0]));
+    index[0] = clientConnect();
+    U_PORT_TEST_ASSERT(request(index[0], "GET / HTTP/1.1\r\nContent-Length: x\r\n\r\n",
+                               pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 400);
+    U_PORT_TEST_ASSERT(closedByServer(index[0]));
+    index[0] = clientConnect();
+    U_PORT_TEST_ASSERT(request(index[0], "POST /form HTTP/1.1\r\n"
+                               "Transfer-Encoding: chunked\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 501);
+    U_PORT_TEST_ASSERT(closedByServer(index[0]));
+    index[0] = clientConnect();
+    snprintf(buffer, sizeof(buffer), "POST /form HTTP/1.1\r\nContent-Length: %d\r\n\r\n",
+             U_WIFI_CAPTIVE_PORTAL_HTTP_REQUEST_MAX_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(request(index[0], buffer, pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 413);
+    U_PORT_TEST_ASSERT(closedByServer(index[0]));
+    index[0] = clientConnect();
+    memset(buffer, 'x', sizeof(buffer));
+    memcpy(buffer, "GET / HTTP/1.1\r\nX-Long: ", 24);
+    buffer[sizeof(buffer) - 1] = 0;
+    U_PORT_TEST_ASSERT(request(index[0], buffer, pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 431);
+    U_PORT_TEST_ASSERT(closedByServer(index[0]));
+
+    U_TEST_PRINT_LINE("too many connections.");
+    for (x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS; x++) {
+        index[x] = clientConnect();
+        U_PORT_TEST_ASSERT(request(index[x], "GET / HTTP/1.1\r\n\r\n", pResponse));
+        U_PORT_TEST_ASSERT(pResponse->status == 200);
+    }
+    index[x] = clientConnect();
+    U_PORT_TEST_ASSERT(index[x] >= 0);
+    U_PORT_TEST_ASSERT(readResponse(index[x], false, pResponse));
+    U_PORT_TEST_ASSERT((pResponse->status == 503) && !pResponse->keepAlive);
+    U_PORT_TEST_ASSERT(closedByServer(index[x]));
+    // Once one goes, there is room again
+    clientClose(index[0]);
+    uPortTaskBlock(50);
+    index[0] = clientConnect();
+    U_PORT_TEST_ASSERT(request(index[0], "GET / HTTP/1.1\r\n\r\n", pResponse));
+    U_PORT_TEST_ASSERT(pResponse->status == 200);
+
+    U_TEST_PRINT_LINE("idle connections time out after %d ms.",
+                      U_WIFI_CAPTIVE_PORTAL_HTTP_KEEP_ALIVE_MS);
+    startTimeMs = uPortGetTickTimeMs();
+    for (x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS; x++) {
+        U_PORT_TEST_ASSERT(clientReceive(index[x], buffer, 1,
+                                         U_WIFI_CAPTIVE_PORTAL_HTTP_KEEP_ALIVE_MS * 2) ==
+                           -U_SOCK_ENOTCONN);
+        clientClose(index[x]);
+    }
+    U_PORT_TEST_ASSERT(uPortGetTickTimeMs() - startTimeMs >=
+                       U_WIFI_CAPTIVE_PORTAL_HTTP_KEEP_ALIVE_MS / 2);
+
+    serverStop();
+    U_PORT_TEST_ASSERT(gServerErrorCode == 0);
+    uPortFree(pResponse);
+    loopbackDelete();
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Load the HTTP engine with as many concurrent clients as it
+ * serves, each making keep-alive requests as fast as it can, and
+ * report the request latency percentiles.
+ */
+U_PORT_TEST_FUNCTION("[wifiCaptivePortalHttp]", "wifiCaptivePortalHttpLoad")
+{
+    int32_t resourceCount;
+    uWifiCaptivePortalHttpTestClient_t client[U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS];
+    int32_t *pLatencyMs;
+    uPortTaskHandle_t taskHandle;
+    char name[16];
+    size_t numRequests = U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS *
+                         U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_LOAD_NUM_REQUESTS;
+    size_t numGood = 0;
+    size_t numDone;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t p50;
+    int32_t p90;
+    int32_t p99;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(loopbackCreate());
+    pLatencyMs = (int32_t *) pUPortMalloc(numRequests * sizeof(int32_t));
+    U_PORT_TEST_ASSERT(pLatencyMs != NULL);
+    memset(pLatencyMs, 0, numRequests * sizeof(int32_t));
+    U_PORT_TEST_ASSERT(serverStart());
+
+    U_TEST_PRINT_LINE("%d client(s), %d keep-alive request(s) each.",
+                      U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS,
+                      U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_LOAD_NUM_REQUESTS);
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS; x++) {
+        memset(&(client[x]), 0, sizeof(client[x]));
+        client[x].index = x;
+        client[x].pLatencyMs = pLatencyMs + (x * U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_LOAD_NUM_REQUESTS);
+        snprintf(name, sizeof(name), "httpClient%d", (int) x);
+        U_PORT_TEST_ASSERT(uPortTaskCreate(clientTask, name,
+                                           U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_TASK_STACK_SIZE_BYTES,
+                                           &(client[x]),
+                                           U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_TASK_PRIORITY,
+                                           &taskHandle) == 0);
+    }
+    do {
+        uPortTaskBlock(10);
+        numDone = 0;
+        for (size_t x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS; x++) {
+            if (client[x].done) {
+                numDone++;
+            }
+        }
+    } while (numDone < U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS);
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    if (durationMs < 1) {
+        durationMs = 1;
+    }
+    // Let the tasks be deleted
+    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+
+    for (size_t x = 0; x < U_WIFI_CAPTIVE_PORTAL_HTTP_MAX_NUM_CONNECTIONS; x++) {
+        numGood += client[x].numGood;
+    }
+    qsort(pLatencyMs, numRequests, sizeof(int32_t), compareLatency);
+    p50 = pLatencyMs[(numRequests * 50) / 100];
+    p90 = pLatencyMs[(numRequests * 90) / 100];
+    p99 = pLatencyMs[(numRequests * 99) / 100];
+    U_TEST_PRINT_LINE("%d of %d request(s) answered correctly in %d ms, %d per second.",
+                      (int) numGood, (int) numRequests, durationMs,
+                      (int) ((((int64_t) numGood) * 1000) / durationMs));
+    U_TEST_PRINT_LINE("latency p50 %d ms, p90 %d ms, p99 %d ms, max %d ms.",
+                      p50, p90, p99, pLatencyMs[numRequests - 1]);
+
+    serverStop();
+    U_PORT_TEST_ASSERT(gServerErrorCode == 0);
+    uPortFree(pLatencyMs);
+    loopbackDelete();
+    uPortDeinit();
+
+    U_PORT_TEST_ASSERT(numGood == numRequests);
+    U_PORT_TEST_ASSERT(p90 <= U_WIFI_CAPTIVE_PORTAL_HTTP_TEST_LOAD_MAX_P90_MS);
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[wifiCaptivePortalHttp]", "wifiCaptivePortalHttpCleanUp")
+{
+    if (!gServerExited) {
+        serverStop();
+    }
+    loopbackDelete();
+    uPortDeinit();
+    // Printed for information: asserting happens in the postamble
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+}
+
+// End of file
@@ -0,0 +1,547 @@
+/*
+ * Copyright 2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for reconnection of a Wi-Fi station: these should
+ * pass on all platforms that have two UARTs connected back to back,
+ * no short range module is required; instead a simulated NINA-W13,
+ * which speaks EDM, keeps a station configuration in RAM and in
+ * persistent memory and counts the AT commands it is sent, is run
+ * on UART B.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdlib.h"    // atoi()
+#include "string.h"    // memset(), strstr(), strcmp()
+#include "stdio.h"     // snprintf()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_at_client.h"
+
+#include "u_device.h"
+#include "u_short_range_module_type.h"
+#include "u_short_range.h"
+#include "u_wifi.h"
+
+#include "u_short_range_test_private.h" // For the simulated module
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && \
+    !defined(U_CFG_BLE_MODULE_INTERNAL) && !defined(U_UCONNECT_GEN2)
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_WIFI_RECONNECT_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_WIFI_RECONNECT_TEST_ASSOCIATION_MS
+/** The time the simulated module takes to associate with an access
+ * point once the station is activated.
+ */
+# define U_WIFI_RECONNECT_TEST_ASSOCIATION_MS 200
+#endif
+
+#ifndef U_WIFI_RECONNECT_TEST_TIMEOUT_MS
+/** How long to wait for things to happen.
+ */
+# define U_WIFI_RECONNECT_TEST_TIMEOUT_MS 5000
+#endif
+
+/** The number of AT commands a connection that has to write the
+ * whole configuration takes: status, inactive-on-start-up, SSID,
+ * authentication, passphrase and activation.
+ */
+#define U_WIFI_RECONNECT_TEST_NUM_COMMANDS_FULL 6
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A station configuration, as the simulated module keeps it.
+ */
+typedef struct {
+    char ssid[U_WIFI_SSID_SIZE];
+    int32_t authentication;
+    char passPhrase[64 + 1];
+} uWifiReconnectTestCfg_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The simulated module.
+ */
+static uShortRangeTestPrivateSim_t *gpSim = NULL;
+
+/** The station configuration of the simulated module in RAM and
+ * in persistent memory.
+ */
+static uWifiReconnectTestCfg_t gSimCfg;
+static uWifiReconnectTestCfg_t gSimCfgStored;
+
+/** The connection status of the simulated module: 0 inactive,
+ * 1 activated but not connected, 2 connected.
+ */
+static volatile int32_t gSimStatus = 0;
+
+/** What the simulated module has been asked to do.
+ */
+static volatile int32_t gSimNumCommands = 0;
+static volatile int32_t gSimNumCfgWrites = 0;
+static volatile int32_t gSimNumLoads = 0;
+static volatile int32_t gSimNumActivates = 0;
+
+/** Buffer for the responses of the simulated module.
+ */
+static char gSimResponse[U_WIFI_SSID_SIZE + 32];
+
+/** Handle of the device.
+ */
+static uDeviceHandle_t gDevHandle = NULL;
+
+/** What the connection status callback has seen.
+ */
+static volatile int32_t gNumConnected = 0;
+static volatile int32_t gNumDisconnected = 0;
+
+/** The configuration of the simulated device.
+ */
+static uDeviceCfg_t gDeviceCfg = {
+    .deviceType = U_DEVICE_TYPE_SHORT_RANGE,
+    .deviceCfg = {
+        .cfgSho = {
+            .moduleType = U_SHORT_RANGE_MODULE_TYPE_NINA_W13
+        }
+    },
+    .transportType = U_DEVICE_TRANSPORT_TYPE_UART,
+    .transportCfg = {
+        .cfgUart = {
+            .uart = U_CFG_TEST_UART_A,
+            .baudRate = U_CFG_TEST_BAUD_RATE,
+            .pinTxd = U_CFG_TEST_PIN_UART_A_TXD,
+            .pinRxd = U_CFG_TEST_PIN_UART_A_RXD,
+            .pinCts = U_CFG_TEST_PIN_UART_A_CTS,
+            .pinRts = U_CFG_TEST_PIN_UART_A_RTS,
+#ifdef U_CFG_TEST_UART_PREFIX
+            .pPrefix = U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)
+#else
+            .pPrefix = NULL
+#endif
+        }
+    }
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Copy a string parameter of an AT command, which may be quoted.
+static void copyParameter(char *pTo, size_t size, const char *pFrom)
+{
+    size_t x = 0;
+
+    if (*pFrom == '"') {
+        pFrom++;
+    }
+    while ((*pFrom != 0) && (*pFrom != '"') && (x < size - 1)) {
+        pTo[x] = *pFrom;
+        pFrom++;
+        x++;
+    }
+    pTo[x] = 0;
+}
+
+// Handle an AT command received by the simulated module.
+static const char *simCommand(const char *pCommand, void *pParameter)
+{
+    const char *pResponse = NULL;
+    const char *pValue;
+    int32_t tag;
+
+    (void) pParameter;
+
+    gSimNumCommands++;
+    if (strstr(pCommand, "AT+UWSSTAT=3") != NULL) {
+        snprintf(gSimResponse, sizeof(gSimResponse), "\r\n+UWSSTAT:3,%d\r\nOK\r\n",
+                 (int) gSimStatus);
+        pResponse = gSimResponse;
+    } else if (strstr(pCommand, "AT+UWSSTAT=0") != NULL) {
+        snprintf(gSimResponse, sizeof(gSimResponse), "\r\n+UWSSTAT:0,\"%s\"\r\nOK\r\n",
+                 gSimCfg.ssid);
+        pResponse = gSimResponse;
+    } else if (strstr(pCommand, "AT+UWSC=0,") != NULL) {
+        pValue = strchr(pCommand, ',') + 1;
+        tag = atoi(pValue);
+        pValue = strchr(pValue, ',');
+        if (pValue == NULL) {
+            // A read; only the SSID is needed
+            snprintf(gSimResponse, sizeof(gSimResponse), "\r\n+UWSC:0,%d,\"%s\"\r\nOK\r\n",
+                     (int) tag, gSimCfg.ssid);
+            pResponse = gSimResponse;
+        } else {
+            pValue++;
+            gSimNumCfgWrites++;
+            switch (tag) {
+                case 2:
+                    copyParameter(gSimCfg.ssid, sizeof(gSimCfg.ssid), pValue);
+                    break;
+                case 5:
+                    gSimCfg.authentication = atoi(pValue);
+                    break;
+                case 8:
+                    copyParameter(gSimCfg.passPhrase, sizeof(gSimCfg.passPhrase), pValue);
+                    break;
+                default:
+                    break;
+            }
+        }
+    } else if (strstr(pCommand, "AT+UWSCA=0,") != NULL) {
+        switch (atoi(pCommand + strlen("AT+UWSCA=0,"))) {
+            case 0: // Reset
+                memset(&gSimCfg, 0, sizeof(gSimCfg));
+                break;
+            case 1: // Store
+                gSimCfgStored = gSimCfg;
+                break;
+            case 2: // Load
+                gSimCfg = gSimCfgStored;
+                gSimNumLoads++;
+                break;
+            case 3: // Activate
+                gSimStatus = 1;
+                gSimNumActivates++;
+                break;
+            case 4: // Deactivate
+                gSimStatus = 0;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return pResponse;
+}
+
+// Connection status callback.
+static void connectionCallback(uDeviceHandle_t devHandle,
+                               int32_t connId,
+                               int32_t status,
+                               int32_t channel,
+                               char *pBssid,
+                               int32_t disconnectReason,
+                               void *pCallbackParameter)
+{
+    (void) connId;
+    (void) channel;
+    (void) pBssid;
+    (void) disconnectReason;
+    (void) pCallbackParameter;
+
+    if (devHandle == gDevHandle) {
+        if (status == U_WIFI_CON_STATUS_CONNECTED) {
+            gNumConnected++;
+        } else {
+            gNumDisconnected++;
+        }
+    }
+}
+
+// Wait for a counter to reach a value.
+static bool waitFor(volatile int32_t *pCounter, int32_t value)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((*pCounter < value) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_WIFI_RECONNECT_TEST_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+
+    return (*pCounter >= value);
+}
+
+// Have the simulated module associate, as it would some time after
+// the station has been activated.
+static bool simAssociate()
+{
+    int32_t numConnected = gNumConnected;
+
+    uPortTaskBlock(U_WIFI_RECONNECT_TEST_ASSOCIATION_MS);
+    gSimStatus = 2;
+    uShortRangeTestPrivateSimSendEvent(gpSim, "+UUWLE:0,0012F28A8E01,6");
+
+    return waitFor(&gNumConnected, numConnected + 1);
+}
+
+// Have the simulated module lose its connection.
+static bool simLinkDrop()
+{
+    int32_t numDisconnected = gNumDisconnected;
+
+    gSimStatus = 1;
+    uShortRangeTestPrivateSimSendEvent(gpSim, "+UUWLD:0,2");
+
+    return waitFor(&gNumDisconnected, numDisconnected + 1);
+}
+
+// Reset the counts of the simulated module.
+static void simCountReset()
+{
+    gSimNumCommands = 0;
+    gSimNumCfgWrites = 0;
+    gSimNumLoads = 0;
+    gSimNumActivates = 0;
+}
+
+// Connect, check the number of AT commands the simulated module was
+// sent and, where the configuration was written, what it now has,
+// then have it associate; returns the number of AT commands.
+static int32_t connectAndCheck(const char *pSsid, uWifiAuth_t authentication,
+                               const char *pPassPhrase, int32_t numCfgWrites)
+{
+    uWifiStationConnectStats_t stats;
+
+    simCountReset();
+    if (pSsid != NULL) {
+        U_PORT_TEST_ASSERT(uWifiStationConnect(gDevHandle, pSsid, authentication,
+                                               pPassPhrase) == 0);
+    } else {
+        U_PORT_TEST_ASSERT(uWifiStationReconnect(gDevHandle) == 0);
+    }
+    U_PORT_TEST_ASSERT(gSimNumActivates == 1);
+    U_PORT_TEST_ASSERT(gSimNumCfgWrites == numCfgWrites);
+    if (pSsid != NULL) {
+        U_PORT_TEST_ASSERT(strcmp(gSimCfg.ssid, pSsid) == 0);
+        U_PORT_TEST_ASSERT(gSimCfg.authentication == (int32_t) authentication);
+        U_PORT_TEST_ASSERT(strcmp(gSimCfg.passPhrase, pPassPhrase) == 0);
+    }
+    U_PORT_TEST_ASSERT(uWifiStationGetConnectStats(gDevHandle, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.numAtCommands == gSimNumCommands);
+    U_PORT_TEST_ASSERT(simAssociate());
+
+    return gSimNumCommands;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Connect and reconnect a simulated module, counting the AT
+ * commands needed when the configuration is unchanged, when the
+ * password changes, when the SSID changes, when the stored
+ * configuration can be loaded and when the module has restarted,
+ * and check the disconnect to connected timing.
+ */
+U_PORT_TEST_FUNCTION("[wifiReconnect]", "wifiReconnectCached")
+{
+    int32_t resourceCount;
+    uWifiStationConnectStats_t stats;
+    int32_t numCommandsFull;
+    int32_t numCommandsUnchanged;
+    int32_t numCommandsPassword;
+    int32_t numCommandsSsid;
+    int32_t numCommandsLoad;
+    int32_t fullMs;
+    int32_t unchangedMs;
+    int32_t startTimeMs;
+    int32_t x;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    memset(&gSimCfg, 0, sizeof(gSimCfg));
+    memset(&gSimCfgStored, 0, sizeof(gSimCfgStored));
+    gSimStatus = 0;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    gpSim = pUShortRangeTestPrivateSimStart(simCommand, NULL);
+    U_PORT_TEST_ASSERT(gpSim != NULL);
+    gpSim->pModel = "NINA-W13";
+    U_PORT_TEST_ASSERT(uDeviceInit() == 0);
+
+    U_TEST_PRINT_LINE("opening a simulated NINA-W13...");
+    U_PORT_TEST_ASSERT(uDeviceOpen(&gDeviceCfg, &gDevHandle) == 0);
+    U_PORT_TEST_ASSERT(uWifiSetConnectionStatusCallback(gDevHandle,
+                                                        connectionCallback, NULL) == 0);
+
+    // Nothing to reconnect to yet
+    U_PORT_TEST_ASSERT(uWifiStationGetConnectStats(gDevHandle, NULL) < 0);
+    U_PORT_TEST_ASSERT(uWifiStationGetConnectStats(gDevHandle, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.numAtCommands == 0);
+    U_PORT_TEST_ASSERT(stats.connectToConnectedMs == -1);
+    U_PORT_TEST_ASSERT(stats.disconnectToConnectedMs == -1);
+    U_PORT_TEST_ASSERT(uWifiStationReconnect(gDevHandle) ==
+                       (int32_t) U_WIFI_ERROR_NOT_CONFIGURED);
+
+    // The first connection writes everything
+    U_TEST_PRINT_LINE("connecting...");
+    numCommandsFull = connectAndCheck("ubx-1", U_WIFI_AUTH_WPA_PSK, "password1", 4);
+    U_PORT_TEST_ASSERT(numCommandsFull == U_WIFI_RECONNECT_TEST_NUM_COMMANDS_FULL);
+    U_PORT_TEST_ASSERT(uWifiStationGetConnectStats(gDevHandle, &stats) == 0);
+    fullMs = stats.commandTimeMs;
+    U_PORT_TEST_ASSERT(stats.connectToConnectedMs >= U_WIFI_RECONNECT_TEST_ASSOCIATION_MS);
+    U_PORT_TEST_ASSERT(stats.disconnectToConnectedMs == -1);
+    // Connecting again while connected is refused, as before
+    U_PORT_TEST_ASSERT(uWifiStationConnect(gDevHandle, "ubx-1", U_WIFI_AUTH_WPA_PSK,
+                                           "password1") ==
+                       (int32_t) U_WIFI_ERROR_ALREADY_CONNECTED_TO_SSID);
+
+    // Lose the connection and reconnect without any changes
+    U_TEST_PRINT_LINE("reconnecting, unchanged...");
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(simLinkDrop());
+    numCommandsUnchanged = connectAndCheck(NULL, U_WIFI_AUTH_WPA_PSK, NULL, 0);
+    U_PORT_TEST_ASSERT(numCommandsUnchanged == 2);
+    U_PORT_TEST_ASSERT(uWifiStationGetConnectStats(gDevHandle, &stats) == 0);
+    unchangedMs = stats.commandTimeMs;
+    U_PORT_TEST_ASSERT(stats.disconnectToConnectedMs >= U_WIFI_RECONNECT_TEST_ASSOCIATION_MS);
+    U_PORT_TEST_ASSERT(stats.disconnectToConnectedMs <= uPortGetTickTimeMs() - startTimeMs);
+    U_TEST_PRINT_LINE("disconnect to connected took %d ms.", stats.disconnectToConnectedMs);
+    // The same through uWifiStationConnect()
+    U_PORT_TEST_ASSERT(simLinkDrop());
+    U_PORT_TEST_ASSERT(connectAndCheck("ubx-1", U_WIFI_AUTH_WPA_PSK, "password1", 0) == 2);
+
+    // A changed password only writes the password
+    U_TEST_PRINT_LINE("reconnecting, changed password...");
+    U_PORT_TEST_ASSERT(simLinkDrop());
+    numCommandsPassword = connectAndCheck("ubx-1", U_WIFI_AUTH_WPA_PSK, "password2", 1);
+    U_PORT_TEST_ASSERT(numCommandsPassword == 3);
+
+    // A changed SSID only writes the SSID
+    U_TEST_PRINT_LINE("reconnecting, changed SSID...");
+    U_PORT_TEST_ASSERT(simLinkDrop());
+    numCommandsSsid = connectAndCheck("ubx-2", U_WIFI_AUTH_WPA_PSK, "password2", 1);
+    U_PORT_TEST_ASSERT(numCommandsSsid == 3);
+    U_PORT_TEST_ASSERT(simLinkDrop());
+    U_PORT_TEST_ASSERT(connectAndCheck(NULL, U_WIFI_AUTH_WPA_PSK, NULL, 0) == 2);
+
+    // Store that, switch to another network, changing two things,
+    // then back: the stored configuration is loaded instead
+    U_TEST_PRINT_LINE("reconnecting, stored configuration...");
+    U_PORT_TEST_ASSERT(uWifiStationStoreConfig(gDevHandle, false) == 0);
+    U_PORT_TEST_ASSERT(strcmp(gSimCfgStored.ssid, "ubx-2") == 0);
+    U_PORT_TEST_ASSERT(simLinkDrop());
+    U_PORT_TEST_ASSERT(connectAndCheck("ubx-1", U_WIFI_AUTH_WPA_PSK, "password1", 2) == 4);
+    U_PORT_TEST_ASSERT(simLinkDrop());
+    numCommandsLoad = connectAndCheck("ubx-2", U_WIFI_AUTH_WPA_PSK, "password2", 0);
+    U_PORT_TEST_ASSERT(gSimNumLoads == 1);
+    U_PORT_TEST_ASSERT(numCommandsLoad == 3);
+
+    // After a restart of the module nothing is assumed of its RAM:
+    // the stored configuration is loaded or everything is written
+    U_TEST_PRINT_LINE("reconnecting after a module restart...");
+    U_PORT_TEST_ASSERT(simLinkDrop());
+    memset(&gSimCfg, 0, sizeof(gSimCfg));
+    uShortRangeTestPrivateSimSendEvent(gpSim, "+STARTUP");
+    uPortTaskBlock(100);
+    U_PORT_TEST_ASSERT(connectAndCheck("ubx-2", U_WIFI_AUTH_WPA_PSK, "password2", 0) == 3);
+    U_PORT_TEST_ASSERT(gSimNumLoads == 1);
+    U_PORT_TEST_ASSERT(simLinkDrop());
+    memset(&gSimCfg, 0, sizeof(gSimCfg));
+    uShortRangeTestPrivateSimSendEvent(gpSim, "+STARTUP");
+    uPortTaskBlock(100);
+    U_PORT_TEST_ASSERT(connectAndCheck("ubx-1", U_WIFI_AUTH_WPA_PSK, "password1",
+                                       4) == U_WIFI_RECONNECT_TEST_NUM_COMMANDS_FULL);
+
+    // A disconnection that was asked for is not counted as a loss
+    U_PORT_TEST_ASSERT(uWifiStationGetConnectStats(gDevHandle, &stats) == 0);
+    U_PORT_TEST_ASSERT(uWifiStationDisconnect(gDevHandle) == 0);
+    U_PORT_TEST_ASSERT(gSimStatus == 0);
+    x = gNumDisconnected;
+    uShortRangeTestPrivateSimSendEvent(gpSim, "+UUWLD:0,5");
+    U_PORT_TEST_ASSERT(waitFor(&gNumDisconnected, x + 1));
+    x = stats.disconnectToConnectedMs;
+    uPortTaskBlock(U_WIFI_RECONNECT_TEST_ASSOCIATION_MS);
+    U_PORT_TEST_ASSERT(connectAndCheck(NULL, U_WIFI_AUTH_WPA_PSK, NULL, 0) == 2);
+    U_PORT_TEST_ASSERT(uWifiStationGetConnectStats(gDevHandle, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.disconnectToConnectedMs == x);
+
+    U_TEST_PRINT_LINE("AT commands: %d for a first connection (%d ms), %d to reconnect"
+                      " unchanged (%d ms), %d with a changed password, %d with a"
+                      " changed SSID, %d loading the stored configuration.",
+                      numCommandsFull, fullMs, numCommandsUnchanged, unchangedMs,
+                      numCommandsPassword, numCommandsSsid, numCommandsLoad);
+
+    U_PORT_TEST_ASSERT(uDeviceClose(gDevHandle, false) == 0);
+    gDevHandle = NULL;
+    uDeviceDeinit();
+
+    uShortRangeTestPrivateSimStop(gpSim);
+    gpSim = NULL;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[wifiReconnect]", "wifiReconnectCleanUp")
+{
+    if (gDevHandle != NULL) {
+        uDeviceClose(gDevHandle, false);
+        gDevHandle = NULL;
+    }
+    uDeviceDeinit();
+    uShortRangeTestPrivateSimStop(gpSim);
+    gpSim = NULL;
+    uPortDeinit();
+}
+
+#endif // #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && ...
+
+// End of file
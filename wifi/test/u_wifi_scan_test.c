@@ -0,0 +1,527 @@
+/*
+ * Copyright 2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the Wi-Fi background scan service: these should
+ * pass on all platforms that have two UARTs connected back to back,
+ * no short range module is required; instead a simulated NINA-W13,
+ * which speaks EDM and streams the lines of its scan results with
+ * a delay between them, as a real module would, is run on UART B.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), strstr(), strcmp()
+#include "stdio.h"     // snprintf()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_at_client.h"
+
+#include "u_device.h"
+#include "u_short_range_module_type.h"
+#include "u_short_range.h"
+#include "u_wifi.h"
+#include "u_wifi_scan.h"
+
+#include "u_short_range_test_private.h" // For the simulated module
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && \
+    !defined(U_CFG_BLE_MODULE_INTERNAL) && !defined(U_UCONNECT_GEN2)
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_WIFI_SCAN_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_WIFI_SCAN_TEST_LINE_DELAY_MS
+/** The time the simulated module takes to produce each line of its
+ * scan results.
+ */
+# define U_WIFI_SCAN_TEST_LINE_DELAY_MS 100
+#endif
+
+#ifndef U_WIFI_SCAN_TEST_PERIOD_MS
+/** The period of the scan service when it is scanning periodically.
+ */
+# define U_WIFI_SCAN_TEST_PERIOD_MS 300
+#endif
+
+#ifndef U_WIFI_SCAN_TEST_TIMEOUT_MS
+/** How long to wait for things to happen.
+ */
+# define U_WIFI_SCAN_TEST_TIMEOUT_MS 10000
+#endif
+
+/** The number of access points the simulated module knows of.
+ */
+#define U_WIFI_SCAN_TEST_NUM_APS (sizeof(gAp) / sizeof(gAp[0]))
+
+/** The amount by which the simulated module lowers the RSSI it
+ * reports on odd-numbered scans.
+ */
+#define U_WIFI_SCAN_TEST_RSSI_DROP_DBM 8
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** An access point as the simulated module reports it.
+ */
+typedef struct {
+    const char *pBssid;
+    uint8_t bssid[U_WIFI_BSSID_SIZE];
+    const char *pSsid;
+    int32_t channel;
+    int32_t rssi;
+} uWifiScanTestAp_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The access points the simulated module knows of; the last one
+ * is only reported in the first scan after gSimNumScans is reset.
+ */
+static const uWifiScanTestAp_t gAp[] = {
+    {"0012F28A8E01", {0x00, 0x12, 0xF2, 0x8A, 0x8E, 0x01}, "ubx-1", 1, -50},
+    {"0012F28A8E02", {0x00, 0x12, 0xF2, 0x8A, 0x8E, 0x02}, "ubx-2", 1, -70},
+    {"0012F28A8E03", {0x00, 0x12, 0xF2, 0x8A, 0x8E, 0x03}, "ubx-3", 6, -60},
+    {"0012F28A8E04", {0x00, 0x12, 0xF2, 0x8A, 0x8E, 0x04}, "ubx-4", 6, -80},
+    {"0012F28A8E05", {0x00, 0x12, 0xF2, 0x8A, 0x8E, 0x05}, "ubx-5", 6, -65},
+    {"0012F28A8E06", {0x00, 0x12, 0xF2, 0x8A, 0x8E, 0x06}, "ubx-6", 11, -75},
+    {"0012F28A8E07", {0x00, 0x12, 0xF2, 0x8A, 0x8E, 0x07}, "ubx-7", 11, -55},
+    {"0012F28A8E08", {0x00, 0x12, 0xF2, 0x8A, 0x8E, 0x08}, "ubx-8", 11, -85}
+};
+
+/** The simulated module.
+ */
+static uShortRangeTestPrivateSim_t *gpSim = NULL;
+
+/** The number of scans the simulated module has done.
+ */
+static volatile int32_t gSimNumScans = 0;
+
+/** Handle of the device.
+ */
+static uDeviceHandle_t gDevHandle = NULL;
+
+/** What the callbacks of the scan service have seen.
+ */
+static volatile int32_t gNumResults = 0;
+static volatile int32_t gNumBadResults = 0;
+static volatile int32_t gFirstResultTimeMs = -1;
+static volatile int32_t gNumDone = 0;
+static volatile int32_t gDoneErrorCode = 0;
+static volatile int32_t gDoneNumResults = 0;
+static volatile int32_t gDoneTimeMs = -1;
+
+/** The number of results uWifiStationScan() has passed back.
+ */
+static volatile int32_t gNumStationScanResults = 0;
+
+/** The configuration of the simulated device.
+ */
+static uDeviceCfg_t gDeviceCfg = {
+    .deviceType = U_DEVICE_TYPE_SHORT_RANGE,
+    .deviceCfg = {
+        .cfgSho = {
+            .moduleType = U_SHORT_RANGE_MODULE_TYPE_NINA_W13
+        }
+    },
+    .transportType = U_DEVICE_TRANSPORT_TYPE_UART,
+    .transportCfg = {
+        .cfgUart = {
+            .uart = U_CFG_TEST_UART_A,
+            .baudRate = U_CFG_TEST_BAUD_RATE,
+            .pinTxd = U_CFG_TEST_PIN_UART_A_TXD,
+            .pinRxd = U_CFG_TEST_PIN_UART_A_RXD,
+            .pinCts = U_CFG_TEST_PIN_UART_A_CTS,
+            .pinRts = U_CFG_TEST_PIN_UART_A_RTS,
+#ifdef U_CFG_TEST_UART_PREFIX
+            .pPrefix = U_PORT_STRINGIFY_QUOTED(U_CFG_TEST_UART_PREFIX)
+#else
+            .pPrefix = NULL
+#endif
+        }
+    }
+};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Handle an AT command received by the simulated module: a scan
+// streams its results, one line at a time, like a real module.
+static const char *simCommand(const char *pCommand, void *pParameter)
+{
+    const char *pResponse = NULL;
+    char buffer[80];
+    int32_t rssi;
+
+    (void) pParameter;
+
+    if (strstr(pCommand, "AT+UWSCAN") != NULL) {
+        for (size_t x = 0; x < U_WIFI_SCAN_TEST_NUM_APS; x++) {
+            if ((x < U_WIFI_SCAN_TEST_NUM_APS - 1) || (gSimNumScans == 0)) {
+                uPortTaskBlock(U_WIFI_SCAN_TEST_LINE_DELAY_MS);
+                rssi = gAp[x].rssi;
+                if (gSimNumScans & 1) {
+                    rssi -= U_WIFI_SCAN_TEST_RSSI_DROP_DBM;
+                }
+                snprintf(buffer, sizeof(buffer), "+UWSCAN:%s,1,\"%s\",%d,%d,18,8,8",
+                         gAp[x].pBssid, gAp[x].pSsid, (int) gAp[x].channel, (int) rssi);
+                uShortRangeTestPrivateSimSendResponse(gpSim, buffer);
+            }
+        }
+        gSimNumScans++;
+    } else if (strstr(pCommand, "AT+CGSN") != NULL) {
+        pResponse = "\r\n0123456789\r\nOK\r\n";
+    }
+
+    return pResponse;
+}
+
+// Result callback for uWifiStationScan().
+static void stationScanCallback(uDeviceHandle_t devHandle, uWifiScanResult_t *pResult)
+{
+    (void) devHandle;
+    (void) pResult;
+
+    gNumStationScanResults++;
+}
+
+// Result callback of the scan service.
+static void resultCallback(uDeviceHandle_t devHandle,
+                           const uWifiScanResult_t *pResult,
+                           void *pCallbackParam)
+{
+    if ((devHandle == gDevHandle) && (pResult != NULL) &&
+        (pCallbackParam == (void *) &gNumResults) &&
+        (pResult->bssid[0] == 0x00) && (pResult->bssid[1] == 0x12)) {
+        if (gFirstResultTimeMs < 0) {
+            gFirstResultTimeMs = uPortGetTickTimeMs();
+        }
+        gNumResults++;
+    } else {
+        gNumBadResults++;
+    }
+}
+
+// Done callback of the scan service.
+static void doneCallback(uDeviceHandle_t devHandle, int32_t errorCode,
+                         int32_t numResults, void *pCallbackParam)
+{
+    (void) pCallbackParam;
+
+    if (devHandle == gDevHandle) {
+        gDoneErrorCode = errorCode;
+        gDoneNumResults = numResults;
+        gDoneTimeMs = uPortGetTickTimeMs();
+        gNumDone++;
+    }
+}
+
+// Wait for the scan service to have completed a number of scans.
+static bool waitForDone(int32_t numDone)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((gNumDone < numDone) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_WIFI_SCAN_TEST_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+
+    return (gNumDone >= numDone);
+}
+
+// Find an access point in the entries from the cache.
+static const uWifiScanEntry_t *pFindEntry(const uWifiScanEntry_t *pEntries,
+                                          size_t numEntries,
+                                          const uWifiScanTestAp_t *pAp)
+{
+    const uWifiScanEntry_t *pEntry = NULL;
+
+    for (size_t x = 0; (x < numEntries) && (pEntry == NULL); x++) {
+        if (memcmp(pEntries[x].result.bssid, pAp->bssid, sizeof(pAp->bssid)) == 0) {
+            pEntry = &(pEntries[x]);
+        }
+    }
+
+    return pEntry;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Run the scan service against a simulated module: check that
+ * results arrive incrementally, that the cache, its smoothing,
+ * ageing and channel statistics are right, that the cache can be
+ * read without waiting while a scan is in progress, and measure
+ * how long an AT-based API waits during a scan.
+ */
+U_PORT_TEST_FUNCTION("[wifiScan]", "wifiScanBackground")
+{
+    int32_t resourceCount;
+    uWifiScanCfg_t cfg = {0};
+    uWifiScanEntry_t entries[U_WIFI_SCAN_TEST_NUM_APS + 1];
+    uWifiScanChannelStats_t stats[4];
+    const uWifiScanEntry_t *pEntry;
+    const uWifiScanEntry_t *pEntryOld;
+    char serialNumber[U_SHORT_RANGE_SERIAL_NUMBER_LENGTH];
+    int32_t startTimeMs;
+    int32_t blockingScanMs;
+    int32_t cacheReadMs;
+    int32_t atCallMs;
+    int32_t atCallMaxMs = 0;
+    int32_t numCached;
+    int32_t x;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    // Obtain the initial resource count
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    gpSim = pUShortRangeTestPrivateSimStart(simCommand, NULL);
+    U_PORT_TEST_ASSERT(gpSim != NULL);
+    gpSim->pModel = "NINA-W13";
+    U_PORT_TEST_ASSERT(uDeviceInit() == 0);
+
+    U_TEST_PRINT_LINE("opening a simulated NINA-W13...");
+    U_PORT_TEST_ASSERT(uDeviceOpen(&gDeviceCfg, &gDevHandle) == 0);
+
+    // The service isn't running yet
+    U_PORT_TEST_ASSERT(uWifiScanNow(gDevHandle) < 0);
+    U_PORT_TEST_ASSERT(uWifiScanGetResults(gDevHandle, -1, entries, 1) < 0);
+    U_PORT_TEST_ASSERT(uWifiScanGetChannelStats(gDevHandle, -1, stats, 1) < 0);
+    uWifiScanStop(gDevHandle);
+
+    // Parameter checking
+    U_PORT_TEST_ASSERT(uWifiScanStart(NULL, &cfg) < 0);
+    U_PORT_TEST_ASSERT(uWifiScanStart(gDevHandle, NULL) < 0);
+    cfg.periodMs = -1;
+    U_PORT_TEST_ASSERT(uWifiScanStart(gDevHandle, &cfg) < 0);
+    cfg.periodMs = 0;
+
+    // The baseline: a blocking scan
+    U_TEST_PRINT_LINE("blocking scan...");
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uWifiStationScan(gDevHandle, NULL, stationScanCallback) == 0);
+    blockingScanMs = uPortGetTickTimeMs() - startTimeMs;
+    U_PORT_TEST_ASSERT(gNumStationScanResults == U_WIFI_SCAN_TEST_NUM_APS);
+
+    // Now the scan service, on demand only
+    gSimNumScans = 0;
+    cfg.pResultCallback = resultCallback;
+    cfg.pDoneCallback = doneCallback;
+    cfg.pCallbackParam = (void *) &gNumResults;
+    U_PORT_TEST_ASSERT(uWifiScanStart(gDevHandle, &cfg) == 0);
+    U_PORT_TEST_ASSERT(uWifiScanGetResults(gDevHandle, -1, NULL, 0) == 0);
+    U_PORT_TEST_ASSERT(uWifiScanGetResults(gDevHandle, -1, NULL, 1) < 0);
+    uPortTaskBlock(U_WIFI_SCAN_TEST_PERIOD_MS);
+    U_PORT_TEST_ASSERT(gNumDone == 0);
+
+    U_TEST_PRINT_LINE("background scan...");
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uWifiScanNow(gDevHandle) == 0);
+    while ((gFirstResultTimeMs < 0) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_WIFI_SCAN_TEST_TIMEOUT_MS)) {
+        uPortTaskBlock(1);
+    }
+    U_PORT_TEST_ASSERT(gFirstResultTimeMs >= 0);
+    // While the scan is in progress the cache can be read straight
+    // away and has what has been found so far in it
+    startTimeMs = uPortGetTickTimeMs();
+    numCached = uWifiScanGetResults(gDevHandle, -1, entries, U_WIFI_SCAN_TEST_NUM_APS);
+    cacheReadMs = uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("%d result(s) in the cache part-way through the scan.", numCached);
+    U_PORT_TEST_ASSERT(numCached > 0);
+    U_PORT_TEST_ASSERT(numCached < (int32_t) U_WIFI_SCAN_TEST_NUM_APS);
+    U_PORT_TEST_ASSERT(gNumDone == 0);
+    U_PORT_TEST_ASSERT(cacheReadMs < U_WIFI_SCAN_TEST_LINE_DELAY_MS);
+    // ...whereas an AT command has to wait for the scan to end
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uShortRangeGetSerialNumber(gDevHandle, serialNumber) > 0);
+    atCallMs = uPortGetTickTimeMs() - startTimeMs;
+    U_PORT_TEST_ASSERT(waitForDone(1));
+    U_PORT_TEST_ASSERT(gDoneErrorCode == 0);
+    U_PORT_TEST_ASSERT(gDoneNumResults == (int32_t) U_WIFI_SCAN_TEST_NUM_APS);
+    U_PORT_TEST_ASSERT(gNumResults == (int32_t) U_WIFI_SCAN_TEST_NUM_APS);
+    U_PORT_TEST_ASSERT(gNumBadResults == 0);
+    // The first result was delivered well before the end
+    U_TEST_PRINT_LINE("first result %d ms before the end of the scan.",
+                      gDoneTimeMs - gFirstResultTimeMs);
+    U_PORT_TEST_ASSERT(gDoneTimeMs - gFirstResultTimeMs >=
+                       (int32_t) (U_WIFI_SCAN_TEST_NUM_APS - 2) * U_WIFI_SCAN_TEST_LINE_DELAY_MS);
+    U_PORT_TEST_ASSERT(atCallMs <= blockingScanMs);
+
+    // Check the cache: strongest first
+    numCached = uWifiScanGetResults(gDevHandle, -1, entries, U_WIFI_SCAN_TEST_NUM_APS + 1);
+    U_PORT_TEST_ASSERT(numCached == (int32_t) U_WIFI_SCAN_TEST_NUM_APS);
+    for (x = 0; x < numCached; x++) {
+        if (x > 0) {
+            U_PORT_TEST_ASSERT(entries[x].rssiSmoothedDbm <= entries[x - 1].rssiSmoothedDbm);
+        }
+        U_PORT_TEST_ASSERT(entries[x].numSightings == 1);
+        U_PORT_TEST_ASSERT(entries[x].rssiSmoothedDbm == entries[x].result.rssi);
+    }
+    U_PORT_TEST_ASSERT(strcmp(entries[0].result.ssid, "ubx-1") == 0);
+    U_PORT_TEST_ASSERT(entries[0].result.channel == 1);
+    U_PORT_TEST_ASSERT(strcmp(entries[numCached - 1].result.ssid, "ubx-8") == 0);
+    // Asking for fewer gets the strongest
+    U_PORT_TEST_ASSERT(uWifiScanGetResults(gDevHandle, -1, entries, 2) == numCached);
+    U_PORT_TEST_ASSERT(entries[0].rssiSmoothedDbm == -50);
+    U_PORT_TEST_ASSERT(entries[1].rssiSmoothedDbm == -55);
+
+    // Channel statistics
+    U_PORT_TEST_ASSERT(uWifiScanGetChannelStats(gDevHandle, -1, NULL, 0) == 3);
+    U_PORT_TEST_ASSERT(uWifiScanGetChannelStats(gDevHandle, -1, stats, 4) == 3);
+    U_PORT_TEST_ASSERT((stats[0].channel == 1) && (stats[0].numAccessPoints == 2) &&
+                       (stats[0].strongestRssiDbm == -50) && (stats[0].averageRssiDbm == -60));
+    U_PORT_TEST_ASSERT((stats[1].channel == 6) && (stats[1].numAccessPoints == 3) &&
+                       (stats[1].strongestRssiDbm == -60) && (stats[1].averageRssiDbm == -68));
+    U_PORT_TEST_ASSERT((stats[2].channel == 11) && (stats[2].numAccessPoints == 3) &&
+                       (stats[2].strongestRssiDbm == -55) && (stats[2].averageRssiDbm == -71));
+
+    // A second scan, with lower RSSIs and without the last
+    // access point
+    U_PORT_TEST_ASSERT(uWifiScanNow(gDevHandle) == 0);
+    U_PORT_TEST_ASSERT(waitForDone(2));
+    U_PORT_TEST_ASSERT(gDoneNumResults == (int32_t) U_WIFI_SCAN_TEST_NUM_APS - 1);
+    numCached = uWifiScanGetResults(gDevHandle, -1, entries, U_WIFI_SCAN_TEST_NUM_APS);
+    U_PORT_TEST_ASSERT(numCached == (int32_t) U_WIFI_SCAN_TEST_NUM_APS);
+    pEntry = pFindEntry(entries, numCached, &(gAp[0]));
+    U_PORT_TEST_ASSERT(pEntry != NULL);
+    U_PORT_TEST_ASSERT(pEntry->numSightings == 2);
+    U_PORT_TEST_ASSERT(pEntry->result.rssi == gAp[0].rssi - U_WIFI_SCAN_TEST_RSSI_DROP_DBM);
+    U_PORT_TEST_ASSERT(pEntry->rssiSmoothedDbm == gAp[0].rssi -
+                       ((U_WIFI_SCAN_TEST_RSSI_DROP_DBM * U_WIFI_SCAN_RSSI_SMOOTHING_PERCENT) /
+                        100));
+    pEntryOld = pFindEntry(entries, numCached, &(gAp[U_WIFI_SCAN_TEST_NUM_APS - 1]));
+    U_PORT_TEST_ASSERT(pEntryOld != NULL);
+    U_PORT_TEST_ASSERT(pEntryOld->numSightings == 1);
+    U_TEST_PRINT_LINE("ages: newest access point %d ms, missing one %d ms.",
+                      pEntry->ageMs, pEntryOld->ageMs);
+    U_PORT_TEST_ASSERT(pEntryOld->ageMs - pEntry->ageMs >= U_WIFI_SCAN_TEST_LINE_DELAY_MS);
+    // Asking for only recent results leaves out the missing one
+    x = pEntry->ageMs + ((pEntryOld->ageMs - pEntry->ageMs) / 2);
+    numCached = uWifiScanGetResults(gDevHandle, x, entries, U_WIFI_SCAN_TEST_NUM_APS);
+    U_PORT_TEST_ASSERT(numCached == (int32_t) U_WIFI_SCAN_TEST_NUM_APS - 1);
+    U_PORT_TEST_ASSERT(pFindEntry(entries, numCached,
+                                  &(gAp[U_WIFI_SCAN_TEST_NUM_APS - 1])) == NULL);
+    U_PORT_TEST_ASSERT(uWifiScanGetChannelStats(gDevHandle, x, stats, 4) == 3);
+    U_PORT_TEST_ASSERT(stats[2].numAccessPoints == 2);
+    uWifiScanStop(gDevHandle);
+    U_PORT_TEST_ASSERT(uWifiScanGetResults(gDevHandle, -1, entries, 1) < 0);
+
+    // Periodic, while another task makes AT calls
+    U_TEST_PRINT_LINE("periodic scans...");
+    gNumDone = 0;
+    cfg.periodMs = U_WIFI_SCAN_TEST_PERIOD_MS;
+    cfg.pResultCallback = NULL;
+    U_PORT_TEST_ASSERT(uWifiScanStart(gDevHandle, &cfg) == 0);
+    startTimeMs = uPortGetTickTimeMs();
+    while ((gNumDone < 3) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_WIFI_SCAN_TEST_TIMEOUT_MS)) {
+        x = uPortGetTickTimeMs();
+        U_PORT_TEST_ASSERT(uShortRangeGetSerialNumber(gDevHandle, serialNumber) > 0);
+        x = uPortGetTickTimeMs() - x;
+        if (x > atCallMaxMs) {
+            atCallMaxMs = x;
+        }
+        uPortTaskBlock(U_WIFI_SCAN_TEST_LINE_DELAY_MS / 2);
+    }
+    U_PORT_TEST_ASSERT(gNumDone >= 3);
+    U_PORT_TEST_ASSERT(gDoneErrorCode == 0);
+    U_PORT_TEST_ASSERT(atCallMaxMs <= blockingScanMs);
+    uWifiScanStop(gDevHandle);
+
+    U_TEST_PRINT_LINE("a blocking scan took %d ms; during a background scan the cache"
+                      " was read in %d ms and an AT command took %d ms (%d ms at most"
+                      " with periodic scans).", blockingScanMs, cacheReadMs, atCallMs,
+                      atCallMaxMs);
+
+    U_PORT_TEST_ASSERT(uDeviceClose(gDevHandle, false) == 0);
+    gDevHandle = NULL;
+    uDeviceDeinit();
+
+    uShortRangeTestPrivateSimStop(gpSim);
+    gpSim = NULL;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[wifiScan]", "wifiScanCleanUp")
+{
+    if (gDevHandle != NULL) {
+        uWifiScanStop(gDevHandle);
+        uDeviceClose(gDevHandle, false);
+        gDevHandle = NULL;
+    }
+    uDeviceDeinit();
+    uShortRangeTestPrivateSimStop(gpSim);
+    gpSim = NULL;
+    uPortDeinit();
+}
+
+#endif // #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && ...
+
+// End of file